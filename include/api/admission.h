@@ -0,0 +1,64 @@
+#ifndef API_ADMISSION_H
+#define API_ADMISSION_H
+
+#include <stdint.h>
+
+// Admission control for server operations. Each class has its own queue,
+// a concurrency limit that adapts to observed latency (gradient: the limit
+// shrinks when recent service time rises above the long-run average), and
+// a queue timeout that tightens under a standing queue (CoDel: when the
+// shortest wait over an interval is above target, queued requests older
+// than the target are shed instead of run). Requests beyond the queue bound
+// are rejected at once with a retry-after hint. Not thread-safe: the server
+// calls it under its job lock.
+typedef enum {
+    ADMIT_CLASS_FAST = 0,       // session checks and single-row reads/writes
+    ADMIT_CLASS_AUTH,           // password hashing and OTP delivery
+    ADMIT_CLASS_EXPORT,         // report and profile exports
+    ADMIT_CLASS_COUNT
+} AdmitClass;
+
+typedef enum {
+    ADMIT_WAIT = 0,             // leave queued: the class is at its limit
+    ADMIT_RUN,                  // start it (counts against the limit until admissionFinish)
+    ADMIT_SHED                  // waited too long: answer "overloaded" without running it
+} AdmitDecision;
+
+typedef struct {
+    int minLimit;               // concurrency floor and ceiling for the adaptive limit
+    int maxLimit;
+    int maxQueue;               // waiting requests beyond this are rejected on arrival
+    unsigned deadlineMillis;    // longest wait in the queue when there is no standing queue
+    unsigned targetMillis;      // CoDel target delay (also the timeout while overloaded)
+    unsigned intervalMillis;    // CoDel interval over which the minimum delay is measured
+} AdmitClassConfig;
+
+typedef struct {
+    AdmitClassConfig config;
+    double limit;
+    int inflight;
+    int queued;
+    double shortMicros;         // fast EWMA of service time
+    double longMicros;          // slow EWMA of service time
+    uint64_t intervalEnd;       // CoDel bookkeeping, microseconds
+    uint64_t minDelay;
+    int overloaded;
+    unsigned long long admitted, rejected, shed, completed;
+} AdmitClassState;
+
+typedef struct {
+    AdmitClassState classes[ADMIT_CLASS_COUNT];
+} AdmissionControl;
+
+// Defaults sized to the worker pool: exports and auth never take every worker
+AdmitClassConfig admissionDefaultConfig(AdmitClass cls, int workers);
+void admissionInit(AdmissionControl *ac, const AdmitClassConfig config[ADMIT_CLASS_COUNT]);
+
+int admissionOffer(AdmissionControl *ac, AdmitClass cls);     // 1: queue it, 0: rejected
+AdmitDecision admissionPoll(AdmissionControl *ac, AdmitClass cls, uint64_t waitedMicros, uint64_t nowMicros);
+void admissionFinish(AdmissionControl *ac, AdmitClass cls, uint64_t serviceMicros);
+unsigned admissionRetryAfterMillis(const AdmissionControl *ac, AdmitClass cls);
+
+const char *admissionClassName(AdmitClass cls);
+
+#endif // API_ADMISSION_H
@@ -0,0 +1,36 @@
+#ifndef API_BATCH_H
+#define API_BATCH_H
+
+#include <stdio.h>
+#include "../config.h"
+
+// Non-interactive batch mode: runs a script of API requests (one JSON object
+// per line, same ops as ui.h) straight against the core, with no prompts.
+// Each request line gets one result line on `out`, in order. Blank lines and
+// lines starting with '#' are ignored.
+//
+// The script is a trusted local caller: session ops take "user" (an ID, or a
+// "$name" bound earlier by a signup carrying "as":"name") instead of a token.
+//
+// {"op":"begin"} ... {"op":"commit"} groups requests into one database
+// transaction. Every request in the group still runs and reports, but if any
+// fails the commit rolls the whole group back. {"op":"rollback"} discards it
+// on purpose. Files written by export are not undone.
+typedef struct {
+    int atomic;             // run the whole script as one group
+    int stopOnError;        // stop at the first failure (a group in progress is rolled back)
+} BatchOptions;
+
+typedef struct {
+    unsigned long long requests;
+    unsigned long long succeeded;
+    unsigned long long failed;
+    unsigned long long rolledBack;  // succeeded, then undone with their group
+    unsigned long long groups;
+} BatchStats;
+
+// SUCCESS when every request succeeded and every group committed, otherwise
+// the first failure's code
+ErrorCode batchRun(FILE *in, FILE *out, const BatchOptions *options, BatchStats *stats);
+
+#endif // API_BATCH_H
@@ -0,0 +1,64 @@
+#ifndef API_HTTP_H
+#define API_HTTP_H
+
+#include <stddef.h>
+#include "../config.h"
+#include "json.h"
+#include "admission.h"
+
+// HTTP/1.1 request parser: no allocation, every field points into the
+// caller's buffer, which must outlive the HttpRequest.
+#define HTTP_MAX_HEADERS 32
+
+typedef struct {
+    const char *name;
+    size_t nameLen;
+    const char *value;
+    size_t valueLen;
+} HttpHeader;
+
+typedef struct {
+    const char *method;
+    size_t methodLen;
+    const char *path;           // target without the query string
+    size_t pathLen;
+    const char *query;          // after '?', NULL when absent
+    size_t queryLen;
+    int minorVersion;           // HTTP/1.<minor>
+    HttpHeader headers[HTTP_MAX_HEADERS];
+    int headerCount;
+    size_t headerBytes;         // request line + headers + blank line
+    const char *body;
+    size_t contentLength;
+    int keepAlive;
+} HttpRequest;
+
+typedef enum {
+    HTTP_PARSE_OK = 0,
+    HTTP_PARSE_INCOMPLETE,      // need more bytes
+    HTTP_PARSE_BAD_REQUEST,     // 400
+    HTTP_PARSE_TOO_LARGE,       // over maxBytes: 413 when contentLength is set, else 431
+    HTTP_PARSE_UNSUPPORTED      // 501: Transfer-Encoding bodies
+} HttpParseResult;
+
+// Parses the request at the start of `buf`; on OK the frame is
+// headerBytes + contentLength bytes long (pipelined data may follow).
+HttpParseResult httpParseRequest(const char *buf, size_t length, size_t maxBytes, HttpRequest *req);
+const HttpHeader *httpFindHeader(const HttpRequest *req, const char *name);
+
+// ServerHandler for complete request frames: routes /api/... to the
+// operations in api/ui.h and writes a full response (status line, headers, JSON body)
+void httpHandleRequest(const char *request, size_t length, JsonWriter *out);
+
+// Complete error response with a JSON body; always Connection: close
+void httpWriteError(JsonWriter *out, int status, const char *message);
+
+// Admission class of a complete request frame, and the 503 (with Retry-After)
+// sent when admission control sheds it; keep-alive is preserved
+AdmitClass httpRequestClass(const char *request, size_t length);
+void httpWriteOverloaded(const char *request, size_t length, unsigned retryAfterMillis, JsonWriter *out);
+
+int httpStatusForError(ErrorCode code);
+const char *httpStatusText(int status);
+
+#endif // API_HTTP_H
@@ -0,0 +1,94 @@
+#ifndef API_JSON_H
+#define API_JSON_H
+
+#include <stddef.h>
+#include "../config.h"
+
+// Minimal JSON reader: parses one document into a flat token array
+// (pre-order). Strings are not copied; tokens point into the source text.
+#define JSON_MAX_TOKENS 256
+#define JSON_MAX_DEPTH  16
+
+typedef enum {
+    JSON_NONE = 0,
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_BOOL,
+    JSON_NULL
+} JsonType;
+
+typedef struct {
+    JsonType type;
+    int start;      // byte offsets into the text (strings exclude quotes)
+    int end;
+    int size;       // object: key count, array: element count
+    int next;       // token index just past this value's subtree
+} JsonToken;
+
+typedef struct {
+    const char *text;
+    size_t length;
+    int count;
+    JsonToken tokens[JSON_MAX_TOKENS];
+} JsonDoc;
+
+ErrorCode jsonParse(JsonDoc *doc, const char *text, size_t length);
+
+// Navigation: token indexes, -1 when missing
+int jsonFind(const JsonDoc *doc, int object, const char *key);
+int jsonArrayItem(const JsonDoc *doc, int array, int index);
+
+// Typed access (ERROR_INVALID_INPUT on type mismatch or overflow)
+ErrorCode jsonGetString(const JsonDoc *doc, int token, char *out, size_t size);
+ErrorCode jsonGetInt(const JsonDoc *doc, int token, int *out);
+ErrorCode jsonGetBool(const JsonDoc *doc, int token, int *out);
+ErrorCode jsonFindString(const JsonDoc *doc, int object, const char *key, char *out, size_t size);
+ErrorCode jsonFindInt(const JsonDoc *doc, int object, const char *key, int *out);
+int jsonTokenEquals(const JsonDoc *doc, int token, const char *literal);
+
+// Streaming writer into a growable, length-tracked buffer
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+    int depth;
+    int afterKey;
+    int failed;                             // allocation failure, output unusable
+    unsigned char needComma[JSON_MAX_DEPTH + 1];
+    char *attachment;                       // sent after `data` without being copied into it
+    size_t attachmentLength;
+} JsonWriter;
+
+void jwInit(JsonWriter *w);
+void jwReset(JsonWriter *w);               // keep the buffer, drop the content
+void jwFree(JsonWriter *w);
+char *jwDetach(JsonWriter *w, size_t *length);  // caller frees; writer is reset
+
+// A finished binary body (a rendered PDF) that follows the written output.
+// The writer takes ownership; jwReset/jwFree/jwDetach free an attachment
+// that was not detached first.
+void jwAttach(JsonWriter *w, char *data, size_t length);
+char *jwDetachAttachment(JsonWriter *w, size_t *length);
+
+void jwBeginObject(JsonWriter *w);
+void jwEndObject(JsonWriter *w);
+void jwBeginArray(JsonWriter *w);
+void jwEndArray(JsonWriter *w);
+void jwKey(JsonWriter *w, const char *key);
+void jwString(JsonWriter *w, const char *value);
+void jwStringN(JsonWriter *w, const char *value, size_t length);
+void jwInt(JsonWriter *w, long long value);
+void jwDouble(JsonWriter *w, double value, int decimals);
+void jwBool(JsonWriter *w, int value);
+void jwNull(JsonWriter *w);
+void jwRaw(JsonWriter *w, const char *bytes, size_t length);       // no separators
+void jwRawValue(JsonWriter *w, const char *json, size_t length);   // pre-encoded value
+
+// key + value shorthands
+void jwKeyString(JsonWriter *w, const char *key, const char *value);
+void jwKeyInt(JsonWriter *w, const char *key, long long value);
+void jwKeyBool(JsonWriter *w, const char *key, int value);
+
+#endif // API_JSON_H
@@ -0,0 +1,58 @@
+#ifndef API_SERVER_H
+#define API_SERVER_H
+
+#include <stddef.h>
+#include "../config.h"
+#include "json.h"
+#include "admission.h"
+
+// Turns one request frame into one complete response
+typedef void (*ServerHandler)(const char *request, size_t length, JsonWriter *out);
+
+typedef enum {
+    SERVER_PROTOCOL_NDJSON = 0,     // one JSON object per line (newline added by the server)
+    SERVER_PROTOCOL_HTTP            // HTTP/1.1 with keep-alive and pipelining
+} ServerProtocol;
+
+typedef struct {
+    const char *unixPath;       // listen on a UNIX socket when set ...
+    const char *host;           // ... otherwise TCP host:port
+    int port;
+    int workers;                // DB worker threads
+    int maxConnections;
+    int maxInflight;            // pipelined requests per connection before reads pause
+    size_t maxRequestBytes;     // longest accepted request line
+    ServerProtocol protocol;
+    ServerHandler handler;      // NULL: apiHandleRequest, or httpHandleRequest for HTTP
+    int processes;              // >1: prefork supervisor with this many worker processes
+    ErrorCode (*processStart)(int index);   // prefork: runs in each worker after fork (open the DB here)
+    void (*processStop)(void);              // prefork: runs in each worker before it exits
+    const AdmitClassConfig *admission;      // ADMIT_CLASS_COUNT entries; NULL: defaults sized to workers
+} ServerConfig;
+
+typedef struct {
+    unsigned long long accepted;
+    unsigned long long requests;
+    unsigned long long responses;
+    unsigned long long protocolErrors;
+    unsigned long long overloaded;  // rejected on arrival or shed from a queue
+    int openConnections;
+} ServerStats;
+
+// Every request frame (an NDJSON line or an HTTP request) gets exactly one
+// response, in request order, even when a client pipelines many requests.
+// Requests are queued per admission class (see admission.h); one the class
+// cannot take in time is answered with OVERLOADED (HTTP 503 + Retry-After)
+// instead of being run. With processes > 1, serverRun forks that many
+// event-loop processes: TCP workers each bind the port with SO_REUSEPORT,
+// UNIX-socket workers share one listener. Sessions, pending signins and
+// stats live in shared memory, and a worker that dies is restarted. The
+// caller must not hold a database connection across the fork; open it in
+// processStart instead.
+ServerConfig serverDefaultConfig(void);
+ErrorCode serverRun(const ServerConfig *config);   // blocks until serverStop()
+void serverStop(void);                             // async-signal-safe
+int serverWaitReady(int timeoutMillis);            // 1 once serverRun is accepting
+void serverGetStats(ServerStats *stats);
+
+#endif // API_SERVER_H
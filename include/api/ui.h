@@ -0,0 +1,43 @@
+#ifndef API_UI_H
+#define API_UI_H
+
+#include <stddef.h>
+#include "../config.h"
+#include "json.h"
+#include "admission.h"
+#include "../student.h"
+
+// Request/response API over the core (auth.h, database.h, student.h).
+// One JSON object in, one JSON object out, shared by every transport:
+//   {"id":7,"op":"profile","token":"..."}  -> {"id":7,"profile":{...},"ok":true}
+//   failure                                 -> {"id":7,"ok":false,"error":"NOT_FOUND","message":"..."}
+//
+// Operations: ping, signup, signin, verify_otp, resend_otp, signout, profile,
+//             data_get, data_put, export
+void apiHandleRequest(const char *request, size_t length, JsonWriter *out);
+
+// Trusted local caller (batch mode): session ops act for `userID` with no
+// token or OTP. Never reachable from a network transport.
+ErrorCode apiHandleAsUser(const char *request, size_t length, const char *userID, JsonWriter *out);
+
+// Same operations with the op and token supplied by the transport (HTTP route,
+// Authorization header); `body` holds the remaining fields, empty means {}.
+ErrorCode apiHandleOperation(const char *op, const char *token, const char *body, size_t length, JsonWriter *out);
+
+// The session user's campus report rendered in memory, for transports that
+// carry raw bytes (HTTP GET /api/report). On failure nothing is allocated and
+// the JSON error object is written to `out`.
+ErrorCode apiRenderReport(const char *token, ExportBuffer *report, JsonWriter *out);
+
+const char *apiErrorName(ErrorCode code);
+
+// Admission class of an operation name, or of an NDJSON request line
+// (unknown or malformed requests are cheap to answer: ADMIT_CLASS_FAST)
+AdmitClass apiOperationClass(const char *op);
+AdmitClass apiRequestClass(const char *request, size_t length);
+// Error response for a request that is answered without running it (the
+// request's id is echoed), and the one for a request shed by admission control
+void apiWriteError(const char *request, size_t length, ErrorCode code, const char *message, JsonWriter *out);
+void apiWriteOverloaded(const char *request, size_t length, unsigned retryAfterMillis, JsonWriter *out);
+
+#endif // API_UI_H
@@ -0,0 +1,45 @@
+#ifndef AUDIT_EVENTS_H
+#define AUDIT_EVENTS_H
+
+#include <stdint.h>
+
+// Central registry of audit event codes.
+// Codes are persisted (audit_log.action, binary audit segments): never renumber,
+// only append. Re-run the seed check in testAuditEvents.c after adding entries.
+#define AUDIT_EVENT_LIST(X)             \
+    X(NOTE,                  0)         \
+    X(USER_CREATED,          1)         \
+    X(USER_UPDATED,          2)         \
+    X(USER_REGISTERED,       3)         \
+    X(LOGIN_SUCCESS,         4)         \
+    X(LOGIN_FAILED,          5)         \
+    X(DATA_SAVED,            6)         \
+    X(ACCOUNT_LOCKED,        7)         \
+    X(ACCOUNT_UNLOCKED,      8)         \
+    X(OTP_GENERATED,         9)         \
+    X(OTP_EXPIRED,          10)         \
+    X(OTP_VERIFIED,         11)         \
+    X(OTP_INVALID,          12)         \
+    X(OTP_EMAIL_DISPATCHED, 13)         \
+    X(SESSION_CREATED,      14)         \
+    X(SESSION_EXPIRED,      15)         \
+    X(SESSION_DESTROYED,    16)         \
+    X(USER_DELETED,         17)
+
+typedef enum {
+#define AUDIT_EVENT_ENUM(name, code) EVENT_##name = code,
+    AUDIT_EVENT_LIST(AUDIT_EVENT_ENUM)
+#undef AUDIT_EVENT_ENUM
+    EVENT_COUNT
+} AuditEvent;
+
+// Perfect hash over the legacy action strings ("LOGIN_SUCCESS", ...)
+#define AUDIT_EVENT_HASH_SLOTS  64
+#define AUDIT_EVENT_HASH_SEED   16u
+
+const char *auditEventName(AuditEvent event);
+AuditEvent auditEventFromName(const char *name);   // EVENT_NOTE when unknown
+int auditEventIsKnownName(const char *name);
+uint32_t auditEventHashSeed(void);                 // seed actually in use
+
+#endif // AUDIT_EVENTS_H
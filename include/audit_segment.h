@@ -0,0 +1,51 @@
+#ifndef AUDIT_SEGMENT_H
+#define AUDIT_SEGMENT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "config.h"
+#include "audit_events.h"
+
+// Binary audit log: append-only segment files with a sparse per-block index
+#define AUDIT_DIR               LOG_DIR "audit/"
+#define AUDIT_BLOCK_RECORDS     64                  // records per index entry
+#define AUDIT_SEGMENT_MAX_BYTES (16u * 1024u * 1024u)
+#define AUDIT_DETAILS_LEN       256
+
+typedef struct {
+    uint64_t epochMicros;
+    uint64_t userHash;
+    uint16_t eventCode;
+    char userID[20];
+    char details[AUDIT_DETAILS_LEN];
+} AuditRecord;
+
+// Return 0 from the visitor to stop the scan early
+typedef int (*AuditVisitor)(const AuditRecord *record, void *ctx);
+
+typedef struct {
+    unsigned long segmentsScanned;
+    unsigned long blocksScanned;
+    unsigned long blocksSkipped;
+    unsigned long recordsMatched;
+} AuditQueryStats;
+
+// Writer
+ErrorCode auditOpen(const char *dir);
+ErrorCode auditAppend(const char *userID, uint16_t eventCode, const char *details);
+ErrorCode auditFlush(void);
+ErrorCode auditClose(void);
+int auditIsOpen(void);
+
+// Reader: all events for userID (NULL = any user) with from <= ts <= to
+ErrorCode auditQuery(const char *dir, const char *userID, uint64_t fromMicros, uint64_t toMicros,
+                     AuditVisitor visit, void *ctx, AuditQueryStats *stats);
+ErrorCode auditExportNDJSON(FILE *out, const char *dir, const char *userID,
+                            uint64_t fromMicros, uint64_t toMicros);
+
+// Helpers
+uint64_t auditUserHash(const char *userID);
+uint64_t auditNowMicros(void);
+ErrorCode auditParseTime(const char *text, uint64_t *micros);
+
+#endif // AUDIT_SEGMENT_H
@@ -12,12 +12,13 @@ typedef struct {
     char dataFields[MAX_SUBJECTS][MAX_LEN];
     char email[MAX_LEN];
     char mobile[15];
-    char passwordHash[64];
+    char passwordHash[65];      // SHA-256 hex + NUL
     char userID[20];
 } Profile;
 
 // Auth and Profile actions
 ErrorCode signup(void);
+ErrorCode registerProfile(Profile *p, const char *password);
 ErrorCode signin(void);
 ErrorCode recoverUserID(void);
 ErrorCode editProfile(const char *userID);
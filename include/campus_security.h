@@ -1,7 +1,9 @@
 #ifndef SECURITY_H
 #define SECURITY_H
 
+#include <stddef.h>
 #include "config.h"
+#include "audit_events.h"
 
 // Authentication levels
 typedef enum {
@@ -32,6 +34,9 @@ int validateSession(const char *sessionToken, Session *session);
 int updateSessionActivity(const char *sessionToken);
 int destroySession(const char *sessionToken);
 int cleanupExpiredSessions(void);
+int sessionStoreInit(void);     // map the shared session table now (before forking workers)
+int generateRandomToken(char *out, size_t size);    // 32 hex chars from the OS CSPRNG
+int randomBytes(void *out, size_t size);            // from the OS CSPRNG; 0 if unavailable
 
 // Security features
 int checkPasswordStrength(const char *password);
@@ -45,7 +50,7 @@ void decryptData(const char *encrypted, char *data, const char *key);
 void generateSecureHash(const char *input, char *hash);
 
 // Audit and monitoring
-int logSecurityEvent(const char *userID, const char *event, const char *details);
+int logSecurityEvent(const char *userID, AuditEvent event, const char *details);
 int detectSuspiciousActivity(const char *userID);
 int generateSecurityReport(const char *reportPath);
 
@@ -1,43 +1,103 @@
 #ifndef CAMPUS_UNIFIED_H
 #define CAMPUS_UNIFIED_H
 
+#include <stdio.h>
 #include <stdbool.h>
 #include <time.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "config.h"
 #include "auth.h"
 
 // Unified Campus Data Structure (Lego Bricking Approach)
+// Common fields plus one variant per campus kind; campusType selects the live one
 typedef struct {
-    // Common fields for all campus types
-    char userID[20];
-    char name[MAX_LEN];
-    char instituteName[MAX_LEN];
-    char department[50];
-    CampusType campusType;
-    
-    // School/College specific (grades/marks)
     int subjectCount;
     char subjects[MAX_SUBJECTS][MAX_LEN];
     int marks[MAX_SUBJECTS];
-    int fullMarks[MAX_SUBJECTS];  // School only
-    int credits[MAX_SUBJECTS];    // College only
-    
-    // Hospital specific (medical data)
+    int weights[MAX_SUBJECTS];    // full marks (school) or credits (college)
+} CampusGrades;
+
+typedef struct {
     char bloodPressure[20];
     char temperature[10];
     char weight[10];
     char diagnosis[MAX_LEN];
-    
-    // Hostel specific (accommodation)
+} CampusMedical;
+
+typedef struct {
     char roomNumber[10];
     char floor[10];
     char messPlan[50];
+} CampusAccommodation;
+
+typedef struct {
+    // Common fields for all campus types
+    char userID[20];
+    char name[MAX_LEN];
+    char instituteName[MAX_LEN];
+    char department[50];
+    CampusType campusType;
     
     // Metadata
     time_t lastUpdated;
     int dataVersion;
+
+    union {
+        CampusGrades grades;            // school, college
+        CampusMedical medical;          // hospital
+        CampusAccommodation hostel;     // hostel
+    };
 } UnifiedCampusData;
 
+// Compact record: what saveUnifiedCampusData writes. A fixed header, then for
+// school/college `count` marks and `count` weights as bytes, then the strings
+// NUL-terminated back to back: userID, name, institute, department and the
+// variant's strings (subjects, or the medical / hostel fields in declaration
+// order). Only the live variant is stored, and no padding, so a record is
+// around 150 bytes where the struct is ~1.4 KB. Integers are host order.
+#define CAMPUS_RECORD_MAGIC   0x31435243u    // "CRC1"
+#define CAMPUS_RECORD_MAX     2048           // bound on any valid record
+
+typedef struct {
+    uint32_t magic;
+    uint16_t length;            // whole record, header included
+    uint8_t campusType;
+    uint8_t count;              // subjects (school/college), else 0
+    int32_t dataVersion;
+    uint32_t reserved;
+    int64_t lastUpdated;
+} CampusRecordHeader;
+
+// Fields of a record in place: every pointer is into the caller's buffer,
+// which must outlive the view. Nothing is copied.
+typedef struct {
+    CampusType campusType;
+    int count;
+    int dataVersion;
+    int64_t lastUpdated;
+    const char *userID;
+    const char *name;
+    const char *instituteName;
+    const char *department;
+    const uint8_t *marks;               // count entries
+    const uint8_t *weights;             // count entries
+    const char *strings[MAX_SUBJECTS];  // subjects, or the variant's fields
+    size_t length;                      // bytes the record occupies
+} CampusRecordView;
+
+// Bytes the record needs, or 0 if `data` cannot be encoded (bad type, count,
+// or a mark / weight outside 0..255)
+size_t campusRecordSize(const UnifiedCampusData *data);
+// Returns bytes written; 0 if it does not fit or cannot be encoded
+size_t campusRecordEncode(const UnifiedCampusData *data, void *out, size_t capacity);
+// Checks bounds, NULs and the tag; `length` may exceed the record
+ErrorCode campusRecordView(const void *bytes, size_t length, CampusRecordView *view);
+ErrorCode campusRecordDecode(const CampusRecordView *view, UnifiedCampusData *data);
+// A data/<id>.data file: a compact record, or the whole-struct layout older
+// versions wrote
+ErrorCode campusFileDecode(const void *bytes, size_t length, UnifiedCampusData *data);
+
 // Campus Configuration Structure
 typedef struct {
     CampusType type;
@@ -51,8 +111,17 @@ typedef struct {
 
 // Helper Functions
 FILE* loadFileForStudent(const char* studentID, const char* mode, const char* campusName);
+// Records are kept in a storage engine (storage_engine.h), by default the log
+// engine under SEGMENT_STORE_DIR; data files written before it are still read,
+// and moved into the engine on first load
 ErrorCode saveUnifiedCampusData(const UnifiedCampusData* data);
 ErrorCode loadUnifiedCampusData(const char* userID, UnifiedCampusData* data);
+// Like saveUnifiedCampusData, but ERROR_ALREADY_EXISTS when the engine has a record
+ErrorCode addUnifiedCampusData(const UnifiedCampusData* data);
+// Takes ownership of `engine` and closes the one in use
+struct StorageEngine;
+void setCampusStorage(struct StorageEngine *engine);
+void closeCampusStore(void);
 CampusConfig getCampusConfig(CampusType type);
 ErrorCode validateCampusData(const UnifiedCampusData* data);
 
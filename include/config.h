@@ -45,7 +45,8 @@ typedef enum {
     ERROR_NETWORK = 7,
     ERROR_PERMISSION = 8,
     ERROR_NOT_FOUND = 9,
-    ERROR_ALREADY_EXISTS = 10
+    ERROR_ALREADY_EXISTS = 10,
+    ERROR_OVERLOADED = 11       // shed by server admission control; retry later
 } ErrorCode;
 
 // Return value constants
@@ -3,30 +3,167 @@
 
 #include "config.h"
 #include "auth.h"
+#include "student.h"
+#include "audit_events.h"
 
 // Database initialization
 ErrorCode initDatabase(void);
 ErrorCode closeDatabase(void);
 
+// Gives the calling thread its own connection (WAL lets readers run side by
+// side); every call below then uses it until closeThreadConnection(). Needs
+// initDatabase() first. Threads without one share the main connection.
+#define DB_THREAD_BUSY_TIMEOUT_MS 5000
+ErrorCode openThreadConnection(void);
+void closeThreadConnection(void);
+
 // User management
+// ERROR_ALREADY_EXISTS when the user ID is taken
 ErrorCode createUser(const Profile *profile);
 ErrorCode getUserByID(const char *userID, Profile *profile);
 ErrorCode updateUser(const Profile *profile);
+// Removes the user with their data, grades and campus record; ERROR_NOT_FOUND if absent
 ErrorCode deleteUser(const char *userID);
 ErrorCode authenticateUser(const char *userID, const char *mobile, const char *passwordHash);
 int searchUserByContact(const char *contact, const char *type, char *foundUserID);
 int isEmailAlreadyRegistered(const char *email);
 int isMobileAlreadyRegistered(const char *mobile);
 
+// Every profile, in no particular order; return 0 from the visitor to stop
+ErrorCode scanProfiles(int (*visit)(const Profile *profile, void *ctx), void *ctx);
+
 // Data management
 ErrorCode saveUserData(const char *userID, const char *dataType, const void *data, size_t dataSize);
 ErrorCode loadUserData(const char *userID, const char *dataType, void *data, size_t *dataSize);
+// Content hash of the stored blob (reportCacheHash); ERROR_NOT_FOUND if there is no row
+ErrorCode getUserDataVersion(const char *userID, const char *dataType, uint64_t *version);
+
+// campus_records: compact campus records (campusRecordEncode) by user ID.
+// loadCampusRecord returns ERROR_MEMORY when capacity is short, with *length
+// set; the scan's record bytes are only valid during the call.
+ErrorCode saveCampusRecord(const char *userID, const void *record, size_t length);
+ErrorCode loadCampusRecord(const char *userID, void *record, size_t capacity, size_t *length);
+ErrorCode deleteCampusRecord(const char *userID);
+ErrorCode scanStoredCampusRecords(int (*visit)(const char *userID, const void *record, size_t length, void *ctx),
+                                  void *ctx);
+
+// Bulk reads: one read transaction for N users, IDs bound DB_BATCH_CHUNK at a time
+#define DB_BATCH_CHUNK 256
+
+typedef struct {
+    int found;              // 0 if the user ID does not exist; the rest is zeroed
+    int hasData;            // campus data row present and of the expected layout
+    Profile profile;
+    union {                 // selected by profile.campusType
+        SchoolMarks school;
+        CollegeMarks college;
+        FieldValues fields; // hospital and hostel
+    } data;
+} UserRecord;
+
+// records[i] answers userIDs[i]; duplicates and unknown IDs are allowed
+ErrorCode getUsersByIDs(const char *const *userIDs, size_t count, UserRecord *records);
+
+// Every user of `type` that has a well-formed campus data row, in no particular order
+ErrorCode scanCampusRecords(CampusType type, void (*visit)(const UserRecord *record, void *ctx), void *ctx);
+
+// Live score statistics per (institute, department, campus type, subject),
+// kept in score_stats by saveUserData and updateUser inside the same
+// transaction as the write. Scores use the rank boards' definitions
+// (percentage; CGPA for college overall) stored as whole 1/STATS_STEPS of
+// the maximum, so running sums stay exact under add/subtract.
+#define STATS_STEPS        10000
+#define STATS_BUCKETS      10        // tenths of the maximum; the last includes 100%
+#define STATS_PASS_PERCENT 50        // grade D and up, CGPA 5.0
+
+typedef struct {
+    long count;
+    float mean;             // native scale
+    float stddev;           // population
+    float passRate;         // % of count at or above STATS_PASS_PERCENT
+    long histogram[STATS_BUCKETS];
+} ScoreStats;
+
+// `department` and `subject` NULL or "" aggregate over all departments / the
+// overall score. One primary key lookup; ERROR_NOT_FOUND when nobody counts.
+ErrorCode getScoreStats(const char *institute, const char *department, CampusType type,
+                        const char *subject, ScoreStats *stats);
+
+// Grading scheme specs (see grading_scheme.h). The next version number for
+// the institute is assigned on insert; scanning visits the latest of each.
+// The table version changes whenever any scheme is added.
+ErrorCode addGradingScheme(const char *institute, const char *spec, int *version);
+ErrorCode scanGradingSchemes(void (*visit)(const char *institute, int version, const char *spec, void *ctx),
+                             void *ctx);
+ErrorCode getGradingSchemesVersion(int64_t *version);
+
+// grade_results: each student's outcome as of the last re-grade
+typedef struct {
+    char userID[20];
+    char institute[MAX_LEN];
+    CampusType campusType;
+    int schemeVersion;      // 0 = built-in scheme
+    float percent;
+    float gpa;
+    char grade[16];
+    int passed;
+} StoredGrade;
+
+// All rows in one transaction (a savepoint inside the caller's)
+ErrorCode saveGradeResults(const StoredGrade *rows, size_t count);
+ErrorCode getStoredGrade(const char *userID, StoredGrade *row);
+
+// User IDs at an institute (NULL = every institute) with the given campus
+// type, in user ID order. *userIDs is malloc'd (free it); *count may be 0.
+ErrorCode listUsersByInstitute(const char *instituteName, CampusType type,
+                               char (**userIDs)[20], size_t *count);
 
 // Security & Audit
-ErrorCode logActivity(const char *userID, const char *action, const char *details);
+ErrorCode logActivity(const char *userID, AuditEvent event, const char *details);
+ErrorCode getAuditEventCounts(long counts[EVENT_COUNT]);
 int getLoginAttempts(const char *userID);
 ErrorCode resetLoginAttempts(const char *userID);
 int incrementLoginAttempts(const char *userID);
+// Expiry (epoch seconds) of a user's account lock, 0 when there is none
+int64_t getAccountLock(const char *userID);
+ErrorCode setAccountLock(const char *userID, int64_t expiry);
+ErrorCode clearAccountLock(const char *userID);
+
+// Legacy file import (migrate.h). Rows are inserted only where the database
+// has nothing for that user yet, so newer data always wins and a repeated
+// import is harmless. With `source`, the checkpoint is saved in the same
+// transaction; *inserted counts the rows actually added.
+typedef enum {
+    IMPORT_PROFILE = 0,
+    IMPORT_CAMPUS_RECORD = 1,       // compact record, into campus_records
+    IMPORT_ACCOUNT_LOCK = 2
+} ImportKind;
+
+typedef struct {
+    ImportKind kind;
+    const char *userID;
+    const Profile *profile;         // IMPORT_PROFILE
+    const void *record;             // IMPORT_CAMPUS_RECORD
+    size_t length;
+    int64_t expiry;                 // IMPORT_ACCOUNT_LOCK
+} ImportRow;
+
+ErrorCode importRows(const ImportRow *rows, size_t count, const char *source, const char *checkpoint,
+                     size_t *inserted);
+// ERROR_NOT_FOUND when the source has never committed a chunk
+ErrorCode getImportCheckpoint(const char *source, char *checkpoint, size_t size);
+
+// The strings dictionary behind intern.h; use that API instead. *committed is
+// set when no write transaction is open on the connection, so the row seen
+// is committed and safe to cache.
+ErrorCode findStringRow(const char *text, int create, uint32_t *id, int *committed);
+ErrorCode loadStringRow(uint32_t id, char *text, size_t size, int *committed);
+
+// PRAGMA data_version of the main connection. It changes whenever another
+// connection commits: a thread's own connection, or another process (prefork
+// workers, batch, migrate). In-memory caches that this process's writes keep
+// current use it to notice everyone else's.
+ErrorCode getDataVersion(int64_t *version);
 
 // Utility functions
 ErrorCode executeQuery(const char *query);
@@ -0,0 +1,60 @@
+#ifndef DB_MAINTENANCE_H
+#define DB_MAINTENANCE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+
+typedef enum {
+    MAINT_CHECKPOINT = 0,       // PASSIVE WAL checkpoint, never blocks readers/writers
+    MAINT_INCREMENTAL_VACUUM,   // PRAGMA incremental_vacuum in bounded page steps
+    MAINT_OPTIMIZE,             // PRAGMA optimize (refresh planner statistics)
+    MAINT_QUICK_CHECK,          // PRAGMA quick_check, one table per run
+    MAINT_JOB_COUNT
+} MaintenanceJob;
+
+typedef struct {
+    unsigned intervalSeconds;   // minimum spacing between runs (0 = disabled)
+    unsigned budgetMillis;      // wall-clock budget per run
+} MaintenanceJobConfig;
+
+typedef struct {
+    const char *dbPath;
+    unsigned tickMillis;        // how often the scheduler wakes up
+    unsigned idleMillis;        // quiet period before a job counts as low-traffic
+    unsigned maxDeferrals;      // run anyway after this many busy ticks
+    unsigned walForcePages;     // checkpoint regardless of traffic above this WAL size
+    unsigned vacuumStepPages;   // pages freed per incremental_vacuum step
+    MaintenanceJobConfig jobs[MAINT_JOB_COUNT];
+} MaintenanceConfig;
+
+typedef struct {
+    unsigned long runs;
+    unsigned long deferred;     // ticks where the job was due but traffic was high
+    unsigned long overBudget;   // runs cut short by the time budget
+    unsigned long failures;     // SQLite errors or quick_check findings
+    uint64_t work;              // frames checkpointed / pages freed / tables checked
+    uint64_t lastMicros;
+    uint64_t maxMicros;
+    uint64_t totalMicros;
+    time_t lastRun;
+} MaintenanceJobStats;
+
+// Background maintenance on a dedicated SQLite connection
+MaintenanceConfig maintenanceDefaultConfig(void);
+ErrorCode maintenanceStart(const MaintenanceConfig *config);
+ErrorCode maintenanceStop(void);
+int maintenanceIsRunning(void);
+
+// Called by database.c on every request so jobs prefer quiet periods
+void maintenanceNoteActivity(void);
+
+// Run one job now on the maintenance thread and wait for it
+ErrorCode maintenanceRunNow(MaintenanceJob job);
+
+void maintenanceGetStats(MaintenanceJobStats stats[MAINT_JOB_COUNT]);
+const char *maintenanceJobName(MaintenanceJob job);
+void maintenancePrintStats(FILE *out);
+
+#endif // DB_MAINTENANCE_H
@@ -0,0 +1,60 @@
+#ifndef GRADE_KERNEL_H
+#define GRADE_KERNEL_H
+
+#include <stddef.h>
+#include "config.h"
+#include "student.h"
+
+// Totals, percentage / CGPA and grade for many students at once. Marks are
+// structure-of-arrays: subject s of student i is marks[s * stride + i], and a
+// subject a student does not have is 0 in both arrays. With GCC or Clang the
+// students are processed GRADE_LANES at a time in vector registers (SSE2,
+// AVX or NEON, whatever the target has); grade thresholds are compared, not
+// branched on. The single-student helpers below run the same kernel, so the
+// CLI, JSON API and reports print exactly what a batch recomputation does.
+
+typedef enum {
+    GRADE_SCALE_PERCENT,    // school: sum(marks) * 100 / sum(full marks)
+    GRADE_SCALE_CGPA        // college: sum(marks * credits) / (sum(credits) * 10)
+} GradeScale;
+
+// Ordered so a bucket is the number of thresholds passed
+typedef enum {
+    GRADE_F, GRADE_D, GRADE_C, GRADE_B, GRADE_A, GRADE_A_PLUS,
+    GRADE_BUCKETS
+} GradeBucket;
+
+typedef struct {
+    GradeScale scale;
+    size_t count;           // students
+    size_t stride;          // distance between two subjects' columns, >= count
+    int subjects;           // rows used, <= MAX_SUBJECTS
+    const int *marks;
+    const int *weights;     // full marks (percent) or credits (CGPA), same layout
+} GradeBatch;
+
+typedef struct {
+    int *total;             // sum of marks, or of marks * credits
+    int *weight;            // sum of full marks, or of credits
+    float *score;           // percentage or CGPA; 0 when the weight is 0
+    unsigned char *grade;   // GradeBucket of the percentage; may be NULL, unused for CGPA
+} GradeResults;
+
+void gradeBatch(const GradeBatch *batch, const GradeResults *out);
+
+typedef struct {
+    int total;
+    int weight;
+    float score;
+    GradeBucket grade;      // GRADE_SCALE_PERCENT only
+} GradeSummary;
+
+// One student through the kernel; `subjects` is clamped to MAX_SUBJECTS
+GradeSummary gradeStudent(GradeScale scale, const int *marks, const int *weights, int subjects);
+GradeSummary gradeSchoolMarks(const SchoolMarks *m);
+GradeSummary gradeCollegeMarks(const CollegeMarks *m);
+
+GradeBucket gradeBucket(float percent);
+const char *gradeName(GradeBucket grade);
+
+#endif // GRADE_KERNEL_H
@@ -0,0 +1,70 @@
+#ifndef GRADING_SCHEME_H
+#define GRADING_SCHEME_H
+
+#include <stdint.h>
+#include "config.h"
+#include "student.h"
+
+// Grading schemes as data. A scheme is a short text spec stored per institute
+// in the grading_schemes table, each change a new version:
+//
+//     A+=90:10 A=80:9 B=70:8 C=60:7 D=50:6 F=0:0 gpa=marks pass=50
+//
+// NAME=MIN[:POINTS] is a grade from MIN percent up (0.01 resolution, one
+// grade must start at 0), gpa=marks keeps CGPA = sum(marks * credits) /
+// (sum(credits) * 10) and gpa=points averages each course's grade points by
+// credits. pass= defaults to the lowest non-zero threshold. A spec is compiled
+// once into a table from every 0.01% step to its grade, so grading is one
+// lookup. Institutes without a scheme use the "" scheme if one is stored, else
+// GRADING_DEFAULT_SPEC (the thresholds grades always had).
+
+#define GRADING_DEFAULT_SPEC "A+=90:10 A=80:9 B=70:8 C=60:7 D=50:6 F=0:0 gpa=marks pass=50"
+#define GRADING_MAX_GRADES   12
+#define GRADING_SPEC_LEN     256
+#define GRADING_STEPS        10000      // lookup entries per 100%
+
+typedef enum {
+    GPA_MARKS,              // credit-weighted marks / 10
+    GPA_POINTS              // credit-weighted grade points
+} GpaFormula;
+
+typedef struct {
+    char institute[MAX_LEN];        // "" for the default
+    int version;                    // 0 = built in
+    uint64_t fingerprint;           // hash of institute, version and spec; changes with any edit
+    char spec[GRADING_SPEC_LEN];
+    int gradeCount;                 // grades best first
+    char names[GRADING_MAX_GRADES][16];
+    float minPercent[GRADING_MAX_GRADES];
+    float points[GRADING_MAX_GRADES];
+    float passPercent;
+    GpaFormula gpa;
+    unsigned char lookup[GRADING_STEPS + 1];    // 0.01% step -> grade index
+} GradingScheme;
+
+typedef struct {
+    float percent;          // school percentage; college credit-weighted mark
+    float gpa;              // college CGPA under the scheme's formula, 0 for school
+    int grade;              // index into names
+    int passed;
+} GradingResult;
+
+// Parses and compiles; ERROR_INVALID_INPUT names nothing, the spec is just refused
+ErrorCode gradingSchemeCompile(const char *institute, int version, const char *spec, GradingScheme *out);
+
+// Latest scheme of the institute (or the default). Loaded from the database on
+// first use and rescanned once any process has added a scheme; the pointer
+// stays valid until gradingSchemesReset().
+const GradingScheme *gradingSchemeFor(const char *institute);
+
+// Validates, stores the next version for the institute and makes it current
+ErrorCode gradingSchemeAdd(const char *institute, const char *spec, int *version);
+
+int gradingSchemeGrade(const GradingScheme *scheme, float percent);
+// `data` is SchoolMarks or CollegeMarks for `type`
+ErrorCode gradingSchemeApply(const GradingScheme *scheme, CampusType type, const void *data,
+                             GradingResult *result);
+
+void gradingSchemesReset(void);
+
+#endif // GRADING_SCHEME_H
@@ -0,0 +1,44 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Interned names: institute, department and subject names are stored once in
+// the `strings` table and referred to by its 32-bit id everywhere else
+// (users columns, marks blobs). 0 is the empty string and never has a row.
+// Rows are never deleted or changed, so an id means the same text for the
+// life of the database.
+//
+// An in-process table caches both directions. Lookups of cached names take a
+// shard read lock (text -> id) or no lock at all (id -> text); only a miss
+// goes to the database. A mapping is cached once its row is known to be
+// committed: a name first seen inside a write transaction is looked up in
+// SQL each time until it is seen again outside one, so a rolled back insert
+// can never leave a stale id behind.
+#define INTERN_TEXT_MAX     256         // bytes, NUL included
+#define INTERN_SHARDS       16
+#define INTERN_PAGE_IDS     4096        // id -> text slots per page
+#define INTERN_PAGES        4096        // ids past INTERN_PAGES * INTERN_PAGE_IDS are not cached
+
+typedef struct {
+    size_t strings;         // cached mappings
+    size_t bytes;           // text held by the cache
+} InternStats;
+
+// Needs initDatabase(). Adds the row on first sight; text longer than
+// INTERN_TEXT_MAX - 1 is ERROR_INVALID_INPUT.
+ErrorCode internString(const char *text, uint32_t *id);
+// Same without adding: ERROR_NOT_FOUND for a name never interned, which no
+// stored row can refer to (equality filters can stop there)
+ErrorCode internFind(const char *text, uint32_t *id);
+// Copies the text of `id` into `text`, truncated to `size` like the columns
+// it replaces. ERROR_NOT_FOUND for an unknown id.
+ErrorCode internText(uint32_t id, char *text, size_t size);
+
+void internGetStats(InternStats *stats);
+// Drops the cache (closeDatabase); no other thread may be using it
+void internReset(void);
+
+#endif // INTERN_H
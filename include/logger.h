@@ -0,0 +1,38 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stddef.h>
+#include "config.h"
+
+// What a caller does when the ring buffer is full
+typedef enum {
+    LOG_POLICY_DROP = 0,    // discard the event and count it
+    LOG_POLICY_BLOCK = 1    // wait until the writer thread frees a slot
+} LogFullPolicy;
+
+typedef struct {
+    const char *path;           // log file (default AUDIT_LOG_FILE)
+    size_t capacity;            // ring slots, rounded up to a power of two
+    size_t maxFileBytes;        // rotate once the file grows past this (0 = never)
+    int maxRotatedFiles;        // keep path.1 .. path.N
+    LogFullPolicy policy;
+} LoggerConfig;
+
+typedef struct {
+    unsigned long long submitted;
+    unsigned long long written;
+    unsigned long long dropped;
+    unsigned long long rotations;
+} LoggerStats;
+
+// Asynchronous file logger: callers push into a lock-free MPSC ring,
+// a single writer thread keeps the file open and drains it.
+LoggerConfig loggerDefaultConfig(void);
+ErrorCode loggerStart(const LoggerConfig *config);
+ErrorCode loggerSubmit(const char *userID, const char *action);
+ErrorCode loggerFlush(void);
+ErrorCode loggerStop(void);
+int loggerIsRunning(void);
+void loggerGetStats(LoggerStats *stats);
+
+#endif // LOGGER_H
@@ -0,0 +1,69 @@
+#ifndef MIGRATE_H
+#define MIGRATE_H
+
+#include <stddef.h>
+#include "config.h"
+
+// Legacy file migration: moves what older versions kept in per-user files
+// into SQLite, and campus data into the campus store.
+//
+//   credentials/<id>.<xx>pfx   whole Profile structs (writeProfile)  -> users
+//   data/<id>.data             campus data, compact or whole-struct  -> the engine
+//                              loadUnifiedCampusData reads (campus_unified.h)
+//   data/lock_<id>.dat         account lock expiry                   -> account_locks
+//   data/<id>_otp.dat          one-time codes: expired ones are swept, live
+//                              ones left for verifyOTP
+//
+// Each source is listed and sorted by file name, then cut into chunks of
+// MIGRATE_CHUNK files. Worker threads read, decode and validate chunks
+// (validateProfile / validateCampusData) in parallel; the calling thread
+// inserts them in order, one transaction per chunk, together with the name of
+// the chunk's last file (a chunk's campus records are stored just before). A
+// run that stops part way resumes after that name; files added later that
+// sort before it are only read with `restart`. Rows and records already there
+// are kept, so newer data is never replaced.
+#define MIGRATE_CHUNK       2048
+#define MIGRATE_MAX_THREADS 64
+
+typedef struct {
+    size_t done;            // files handled this run
+    size_t total;
+    double seconds;
+    double perSecond;
+} MigrateProgress;
+
+typedef struct {
+    int threads;                // 0 = one per online CPU
+    const char *credentialsDir; // NULL = CRED_DIR; with the trailing '/'
+    const char *dataDir;        // NULL = DATA_DIR; likewise
+    int removeMigrated;         // delete files once committed, and expired OTP / lock files
+    int restart;                // ignore the checkpoints and read every file again
+    // Called after each chunk commits, from the calling thread
+    void (*progress)(const MigrateProgress *progress, void *ctx);
+    void *ctx;
+} MigrateOptions;
+
+typedef struct {
+    size_t files;           // legacy files found
+    size_t resumed;         // not read: committed by an earlier run
+    size_t profiles;        // rows added
+    size_t records;
+    size_t locks;
+    size_t present;         // valid, but the database already had the row
+    size_t expired;         // lock and OTP files past their expiry
+    size_t pendingOtp;      // live OTP files, left in place
+    size_t invalid;         // unreadable or failed validation, left in place
+    size_t removed;
+    size_t chunks;
+    int threads;
+    double seconds;
+    double perSecond;       // files per second
+} MigrateStats;
+
+MigrateOptions migrateDefaultOptions(void);
+
+// Needs initDatabase(). ERROR_DATABASE when a chunk fails to commit; the
+// checkpoints keep every chunk before it.
+ErrorCode runLegacyMigration(const MigrateOptions *options, MigrateStats *stats);
+
+#endif // MIGRATE_H
@@ -0,0 +1,65 @@
+#ifndef PDF_WRITER_H
+#define PDF_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "config.h"
+
+// Streaming PDF 1.4 writer. Each page's objects go to the output as soon as
+// the page ends; what stays in memory is the open page's content stream, one
+// leaf of the page tree and a small window of xref offsets. The rest of the
+// xref table and the page tree's leaf list are kept in memory up to
+// PDF_SPILL_MEMORY bytes each, then spilled to temporary files, and copied
+// out at the end, so memory use does not grow with the page count and short
+// documents (single reports) need no temporary files at all.
+//
+// Text uses the standard 14 fonts (no embedding). UTF-8 input is written as
+// WinAnsi; characters outside Latin-1 become '?'.
+
+#define PDF_A4_WIDTH    595.276
+#define PDF_A4_HEIGHT   841.89
+#define PDF_PAGE_GROUP  128         // pages per leaf of the page tree
+#define PDF_XREF_WINDOW 1024        // offsets held back until earlier objects are written
+#define PDF_SPILL_MEMORY (64 * 1024)  // per spill, before it moves to a temporary file
+
+typedef enum {
+    PDF_FONT_HELVETICA = 0,
+    PDF_FONT_HELVETICA_BOLD,
+    PDF_FONT_HELVETICA_OBLIQUE,
+    PDF_FONT_HELVETICA_BOLD_OBLIQUE,
+    PDF_FONT_TIMES_ROMAN,
+    PDF_FONT_TIMES_BOLD,
+    PDF_FONT_TIMES_ITALIC,
+    PDF_FONT_TIMES_BOLD_ITALIC,
+    PDF_FONT_COURIER,
+    PDF_FONT_COURIER_BOLD,
+    PDF_FONT_COURIER_OBLIQUE,
+    PDF_FONT_COURIER_BOLD_OBLIQUE,
+    PDF_FONT_SYMBOL,
+    PDF_FONT_ZAPF_DINGBATS,
+    PDF_FONT_COUNT
+} PdfFont;
+
+typedef struct PdfWriter PdfWriter;
+
+// Starts a document on `out` (left open by the writer; only written
+// sequentially, so a memory stream works); NULL when out of memory
+PdfWriter *pdfWriterOpen(FILE *out);
+
+ErrorCode pdfBeginPage(PdfWriter *w, double width, double height);
+ErrorCode pdfSetFont(PdfWriter *w, PdfFont font, double size);
+ErrorCode pdfText(PdfWriter *w, double x, double y, const char *text);
+ErrorCode pdfEndPage(PdfWriter *w);
+
+// Writes the page tree, catalog, xref and trailer, then frees the writer.
+// With `abandon` set (or after any earlier failure) it only frees it.
+ErrorCode pdfWriterClose(PdfWriter *w, int abandon);
+
+size_t pdfPageCount(const PdfWriter *w);
+uint64_t pdfBytesWritten(const PdfWriter *w);
+
+// Standard 14 base font names ("Helvetica", "Times-Bold", ...)
+const char *pdfFontName(PdfFont font);
+int pdfFontByName(const char *name);    // PdfFont, or -1 when not a standard font
+
+#endif // PDF_WRITER_H
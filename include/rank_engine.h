@@ -0,0 +1,55 @@
+#ifndef RANK_ENGINE_H
+#define RANK_ENGINE_H
+
+#include <stddef.h>
+#include "config.h"
+#include "student.h"
+
+// Merit lists per (institute, campus type, subject). Each board is a Fenwick
+// tree over score buckets plus the members of each bucket, so rank, top-K
+// and percentile queries cost O(log n) (top-K adds O(K)). The boards of an
+// (institute, campus type) are built together on its first query and kept
+// current by storeSchoolMarks, storeCollegeMarks and updateUser. A commit by
+// another connection or process (getDataVersion) drops them all, as does
+// rankReset() (e.g. after a rolled back batch), so the next query rebuilds.
+// A board is about 80 KB; past RANK_MAX_BOARDS the least recently queried
+// institutes are dropped first.
+//
+// Scores are in their native scale: percentage for school, CGPA for college
+// overall, and percentage of the subject's marks for a subject. Buckets are
+// 1/RANK_STEPS of the maximum (0.01% / 0.001 CGPA); equal buckets share a rank.
+
+#define RANK_STEPS       10000
+#define RANK_MAX_BOARDS  256     // about 20 MB
+
+typedef struct {
+    char userID[20];
+    float score;
+    int rank;               // 1 = best; ties share the better rank
+} RankEntry;
+
+// `subject` NULL or "" is the overall board. ERROR_NOT_FOUND when the board
+// is empty or the student is not on it.
+ErrorCode rankOfStudent(const char *institute, CampusType type, const char *subject, const char *userID,
+                        int *rank, int *total, float *score);   // score may be NULL
+// Best first, ties by user ID; *count <= k
+ErrorCode rankTopK(const char *institute, CampusType type, const char *subject, size_t k,
+                   RankEntry *out, size_t *count);
+// Share of the board scoring at or below `score`, 0..100
+ErrorCode rankPercentile(const char *institute, CampusType type, const char *subject, float score,
+                         float *percentile);
+
+typedef struct {
+    size_t institutes;      // loaded (institute, campus type) groups
+    size_t boards;
+    size_t students;
+} RankStats;
+
+void rankGetStats(RankStats *stats);
+
+// Incremental updates (no-ops for institutes no query has loaded)
+void rankNoteMarks(const Profile *p, const void *data);  // data: SchoolMarks or CollegeMarks
+void rankNoteProfile(const Profile *p);
+void rankReset(void);
+
+#endif // RANK_ENGINE_H
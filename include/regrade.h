@@ -0,0 +1,45 @@
+#ifndef REGRADE_H
+#define REGRADE_H
+
+#include <stddef.h>
+#include "config.h"
+
+// Bulk re-grade: every school and college student of an institute (or of all
+// institutes) graded again under their institute's current grading scheme,
+// with the outcome written to grade_results. Workers take chunks of
+// REGRADE_CHUNK students from a shared counter, read each chunk with one
+// getUsersByIDs call on their own connection and write it in one transaction,
+// so a failed chunk leaves no partial rows and the others still land.
+#define REGRADE_CHUNK       256
+#define REGRADE_MAX_THREADS 64
+
+typedef struct {
+    size_t done;            // students processed so far
+    size_t total;
+    double seconds;
+    double perSecond;
+} RegradeProgress;
+
+typedef struct {
+    int threads;            // 0 = one per online CPU
+    // Called after each chunk, one call at a time, from the worker that finished it
+    void (*progress)(const RegradeProgress *progress, void *ctx);
+    void *ctx;
+} RegradeOptions;
+
+typedef struct {
+    size_t students;
+    size_t graded;          // rows written
+    size_t missingData;     // students without marks yet
+    size_t chunks;
+    size_t failedChunks;
+    int threads;
+    double seconds;
+} RegradeStats;
+
+RegradeOptions regradeDefaultOptions(void);
+
+// `institute` NULL re-grades everyone; ERROR_NOT_FOUND when there is nobody to grade
+ErrorCode runRegrade(const char *institute, const RegradeOptions *options, RegradeStats *stats);
+
+#endif // REGRADE_H
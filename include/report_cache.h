@@ -0,0 +1,52 @@
+#ifndef REPORT_CACHE_H
+#define REPORT_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Finished report files keyed by (user ID, report kind, content version).
+// A version is a hash of everything the report shows, so a changed profile
+// or saveUserData() yields a new key and the old file is never served;
+// saveUserData() also drops the user's entries right away. Files live in
+// `dir` as <userID>.<version><kind> and are written through a temporary
+// name and rename(). The least recently used ones are deleted whenever the
+// total exceeds the disk budget. Prefork worker processes each keep their
+// own index over the same directory, but the budget covers the directory:
+// its total size is a count in <dir>/.usage that every process updates
+// under a file lock. A file evicted by another process is simply a miss.
+
+#define REPORT_CACHE_DIR        DATA_DIR "cache/"
+#define REPORT_CACHE_BUDGET     (64ull * 1024 * 1024)
+#define REPORT_CACHE_HASH_SEED  1469598103934665603ULL     // FNV-1a offset basis
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;         // deleted to stay within the budget
+    uint64_t invalidations;     // deleted by reportCacheInvalidate
+    uint64_t bytes;             // files in this process's index
+    uint64_t diskBytes;         // the whole directory, all processes
+    size_t entries;
+} ReportCacheStats;
+
+// Indexes the files already in `dir` (created if missing). A budget of 0
+// disables the cache: gets miss and puts are ignored.
+ErrorCode reportCacheOpen(const char *dir, uint64_t budgetBytes);
+void reportCacheClose(void);
+
+// *data is malloc'd; ERROR_NOT_FOUND on a miss or when the cache is closed
+ErrorCode reportCacheGet(const char *userID, const char *kind, uint64_t version,
+                         unsigned char **data, size_t *length);
+// Replaces any other version of the same (user, kind)
+ErrorCode reportCachePut(const char *userID, const char *kind, uint64_t version,
+                         const void *data, size_t length);
+void reportCacheInvalidate(const char *userID);
+
+void reportCacheGetStats(ReportCacheStats *stats);
+
+// FNV-1a over `data`, continuing from `seed` (REPORT_CACHE_HASH_SEED to start)
+uint64_t reportCacheHash(uint64_t seed, const void *data, size_t length);
+
+#endif // REPORT_CACHE_H
@@ -0,0 +1,36 @@
+#ifndef REPORT_MERGE_H
+#define REPORT_MERGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Merged reports: one PDF with a page per user (a whole class or institute
+// for a print shop). Pages go through the streaming writer (pdf_writer.h)
+// with one shared font object, and users are read DB_BATCH_CHUNK at a time,
+// so memory stays flat however many pages there are. Only the ordering
+// index (user ID and score, 24 bytes per user) grows with the user count.
+// The file is written next to `path` and renamed into place when complete.
+
+typedef enum {
+    REPORT_ORDER_ID = 0,    // by user ID (random serials: a stable order, not registration order)
+    REPORT_ORDER_RANK       // best percentage / CGPA first, ties by user ID
+} ReportOrder;
+
+typedef struct {
+    size_t users;
+    size_t pages;
+    size_t missingData;     // skipped: unknown user or no campus data yet
+    uint64_t bytes;
+    double seconds;
+} MergedReportStats;
+
+// ERROR_NOT_FOUND when none of the users has a report to print
+ErrorCode writeMergedReport(const char (*userIDs)[20], size_t count, ReportOrder order, const char *path,
+                            MergedReportStats *stats);
+
+// Every user of `type` at `instituteName`
+ErrorCode writeInstituteMergedReport(const char *instituteName, CampusType type, ReportOrder order,
+                                     const char *path, MergedReportStats *stats);
+
+#endif // REPORT_MERGE_H
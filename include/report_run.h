@@ -0,0 +1,42 @@
+#ifndef REPORT_RUN_H
+#define REPORT_RUN_H
+
+#include <stddef.h>
+#include "config.h"
+
+// Whole-institute report runs: every user's campus report rendered on a pool
+// of worker threads. Users are split into one contiguous range per worker; a
+// worker that runs dry steals half of the largest range left, so a few slow
+// reports do not hold up the run. Each worker has its own database
+// connection (openThreadConnection) and renders its own document per user.
+// Files are written atomically (temporary file + rename) as
+// <outDir><userID>_<kind>.pdf, the same names exportCampusReport uses.
+#define REPORT_MAX_THREADS 64
+
+typedef struct {
+    int threads;            // 0 = one per online CPU
+    const char *outDir;     // DATA_DIR when NULL; created if missing
+} ReportRunOptions;
+
+typedef struct {
+    size_t users;           // users in the run
+    size_t written;
+    size_t missingData;     // users without campus data yet (no file written)
+    size_t failed;          // profile unreadable or the file could not be written
+    size_t steals;          // ranges taken from another worker
+    int threads;
+    double seconds;         // wall time of the rendering phase
+} ReportRunStats;
+
+ReportRunOptions reportRunDefaultOptions(void);
+
+// Reports for an explicit list of users; SUCCESS unless a report failed
+// (users without data are only counted)
+ErrorCode runReports(const char (*userIDs)[20], size_t count, const ReportRunOptions *options,
+                     ReportRunStats *stats);
+
+// Every user of `type` at `instituteName`; ERROR_NOT_FOUND when there are none
+ErrorCode runInstituteReports(const char *instituteName, CampusType type, const ReportRunOptions *options,
+                              ReportRunStats *stats);
+
+#endif // REPORT_RUN_H
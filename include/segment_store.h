@@ -0,0 +1,67 @@
+#ifndef SEGMENT_STORE_H
+#define SEGMENT_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Log-structured key/value store. Values are appended to large segment files
+// (seg_NNNNNN.log) and an in-memory hash index maps each key to its latest
+// entry. Segments are mmap-ed: writes copy into the active segment's mapping,
+// reads come straight out of the mappings. A put or delete makes the older
+// entry dead; compaction copies the live entries of mostly-dead sealed
+// segments forward and removes those files. Opening rebuilds the index by
+// scanning the segments, dropping a torn tail.
+//
+//   segment : "CAMSEG01" u32 version u32 segment
+//   entry   : u32 magic | u32 checksum | u32 valueLength | u8 flags | u8 keyLength | u16 0
+//             key | value                                  (little endian)
+//
+// One process owns a directory at a time (a lock file enforces it).
+#define SEGMENT_STORE_DIR           DATA_DIR "segments/"
+#define SEGMENT_STORE_SEGMENT_BYTES (64u * 1024u * 1024u)
+#define SEGMENT_STORE_KEY_MAX       32          // key bytes, NUL included
+
+typedef struct SegmentStore SegmentStore;
+
+typedef struct {
+    size_t segmentBytes;        // segment size; 0 = SEGMENT_STORE_SEGMENT_BYTES
+    double compactGarbage;      // compact sealed segments at least this dead; 0 = 0.5
+    int background;             // compact on a background thread
+    int syncWrites;             // msync after every put / delete
+} SegmentStoreOptions;
+
+typedef struct {
+    size_t keys;
+    size_t segments;
+    uint64_t liveBytes;         // entries the index points at, and tombstones
+    uint64_t deadBytes;         // superseded entries awaiting compaction
+    unsigned long compactions;  // segments compacted away since open
+    uint64_t bytesMoved;        // live bytes those compactions copied
+} SegmentStoreStats;
+
+// Sees the value in place, valid only during the call; must not call back
+// into the store
+typedef void (*SegmentValueVisitor)(const void *value, size_t length, void *ctx);
+// Same, for scans; return 0 to stop early
+typedef int (*SegmentEntryVisitor)(const char *key, const void *value, size_t length, void *ctx);
+
+SegmentStoreOptions segmentStoreDefaultOptions(void);
+ErrorCode segmentStoreOpen(const char *dir, const SegmentStoreOptions *options, SegmentStore **store);
+void segmentStoreClose(SegmentStore *store);
+
+ErrorCode segmentStorePut(SegmentStore *store, const char *key, const void *value, size_t length);
+// ERROR_NOT_FOUND for an unknown key; ERROR_MEMORY when capacity is too small
+// (`length` still reports the size)
+ErrorCode segmentStoreGet(SegmentStore *store, const char *key, void *out, size_t capacity, size_t *length);
+// Hands the value to `visit` without copying it
+ErrorCode segmentStoreRead(SegmentStore *store, const char *key, SegmentValueVisitor visit, void *ctx);
+ErrorCode segmentStoreDelete(SegmentStore *store, const char *key);
+// Every live key, in no particular order
+ErrorCode segmentStoreScan(SegmentStore *store, SegmentEntryVisitor visit, void *ctx);
+
+// Compacts every sealed segment over the garbage threshold now
+ErrorCode segmentStoreCompact(SegmentStore *store);
+void segmentStoreGetStats(SegmentStore *store, SegmentStoreStats *stats);
+
+#endif // SEGMENT_STORE_H
@@ -0,0 +1,18 @@
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+// Memory and locks that stay shared with worker processes forked after they
+// are created (prefork server mode). Without fork they act like calloc and
+// ordinary mutexes.
+void *sharedAlloc(size_t bytes);                  // zeroed, never freed; NULL on failure
+int sharedMutexInit(pthread_mutex_t *mutex);      // process-shared and robust
+
+// Returns 1 when the previous owner died holding the lock: the caller owns it
+// again but must treat the data it guards as possibly half-written.
+int sharedMutexLock(pthread_mutex_t *mutex);
+void sharedMutexUnlock(pthread_mutex_t *mutex);
+
+#endif // SHARED_STATE_H
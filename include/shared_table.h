@@ -0,0 +1,54 @@
+#ifndef SHARED_TABLE_H
+#define SHARED_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "shared_state.h"
+
+// Fixed-size records in sharded open-addressing tables, keyed by a string
+// inside each record, in shared memory (shared_state.h) so prefork worker
+// processes see each other's entries. A slot whose key is "" is empty.
+// Each shard has a robust process-shared mutex; a shard whose previous owner
+// died holding it is emptied rather than trusted. Deletion shifts entries
+// back, so probes never need tombstones.
+typedef struct SharedShard SharedShard;
+
+typedef struct {
+    size_t recordSize;
+    size_t keyOffset;                   // NUL-terminated key within the record
+    uint32_t shards;
+    uint32_t slots;                     // per shard, a power of two
+    int (*expired)(const void *record, time_t now);     // may be NULL
+    pthread_mutex_t mapLock;            // guards the first mapping only
+    _Atomic(unsigned char *) memory;
+} SharedTable;
+
+#define SHARED_TABLE_INIT(type, keyField, shardCount, slotCount, expiredFn) \
+    { sizeof(type), offsetof(type, keyField), (shardCount), (slotCount), (expiredFn), \
+      PTHREAD_MUTEX_INITIALIZER, NULL }
+
+// Maps the table if it is not yet (call before forking workers); 0 on failure
+int sharedTableInit(SharedTable *table);
+uint32_t sharedTableHash(const char *key);
+
+// Locks the shard for `hash` (shard s for hash s < shards, to visit them
+// all); NULL if the table could not be mapped. The calls below need the
+// lock and only see that shard's records.
+SharedShard *sharedTableLock(SharedTable *table, uint32_t hash);
+void sharedTableUnlock(SharedShard *shard);
+
+void *sharedTableFind(const SharedTable *table, SharedShard *shard, const char *key, uint32_t hash);
+// Copies `record` in. Expired records are swept first once the shard is 7/8
+// full; 0 if it still is, or if the key is already there.
+int sharedTableInsert(const SharedTable *table, SharedShard *shard, const void *record, uint32_t hash);
+// `record` comes from sharedTableFind and is invalid afterwards
+void sharedTableRemove(const SharedTable *table, SharedShard *shard, void *record);
+
+// Whole-table walks, one shard lock at a time
+int sharedTableCount(SharedTable *table);
+int sharedTableSweep(SharedTable *table, time_t now);      // returns the number removed
+
+#endif // SHARED_TABLE_H
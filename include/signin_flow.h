@@ -0,0 +1,70 @@
+#ifndef SIGNIN_FLOW_H
+#define SIGNIN_FLOW_H
+
+#include <time.h>
+#include "config.h"
+#include "campus_security.h"
+
+// Signin as a resumable state machine:
+//   AWAIT_CREDENTIALS --credentials--> AWAIT_OTP --otp--> DONE (session)
+//                                          |  ^ resend
+//                                          +--+--> FAILED (too many bad OTPs, expired)
+// A flow owns no thread and no heap memory; callers (the interactive menu,
+// the API) feed it events whenever input arrives.
+#define SIGNIN_MAX_CREDENTIAL_FAILURES  3
+#define SIGNIN_MAX_OTP_FAILURES         5       // per flow, across resends
+#define SIGNIN_MAX_RESENDS              3
+#define SIGNIN_LOCK_MINUTES             15
+#define SIGNIN_OTP_SECONDS              300     // matches the OTP file expiry
+#define SIGNIN_TICKET_LEN               32
+
+typedef enum {
+    SIGNIN_AWAIT_CREDENTIALS = 0,
+    SIGNIN_AWAIT_OTP,
+    SIGNIN_DONE,
+    SIGNIN_FAILED
+} SigninState;
+
+// OTP delivery channels, as a bit set
+#define SIGNIN_CHANNEL_SMS   1
+#define SIGNIN_CHANNEL_EMAIL 2
+
+typedef struct {
+    unsigned char state;                // SigninState
+    unsigned char credentialFailures;
+    unsigned char otpFailures;
+    unsigned char resends;
+    unsigned char channels;             // SIGNIN_CHANNEL_* used for the last OTP
+    time_t expiresAt;                   // AWAIT_OTP: when the OTP stops being valid
+    char ticket[SIGNIN_TICKET_LEN + 1]; // handle for flows parked in the pending table
+    char userID[20];
+    char mobile[15];
+    char email[MAX_LEN];
+} SigninFlow;
+
+void signinFlowInit(SigninFlow *flow);
+
+// Each step returns SUCCESS or the reason it did not advance; flow->state
+// says what the flow is waiting for next.
+ErrorCode signinFlowCredentials(SigninFlow *flow, const char *userID, const char *mobile, const char *password);
+ErrorCode signinFlowVerify(SigninFlow *flow, const char *otp, Session *session);
+ErrorCode signinFlowResend(SigninFlow *flow);
+int signinFlowExpired(const SigninFlow *flow, time_t now);
+
+// Pending-login table for transports that cannot keep a flow on their stack:
+// fixed-size slots in sharded open-addressing tables, keyed by ticket, in
+// shared memory so prefork workers can finish each other's logins.
+#define SIGNIN_TABLE_SHARDS     16
+#define SIGNIN_SHARD_SLOTS      4096    // 64K pending logins in total
+
+// signinVerify and signinResend return ERROR_GENERAL when a flow that could
+// continue was dropped because its shard filled up; the ticket is then gone.
+int signinTableInit(void);              // map the table now (before forking workers)
+ErrorCode signinBegin(const char *userID, const char *mobile, const char *password,
+                      char ticket[SIGNIN_TICKET_LEN + 1], int *channels);
+ErrorCode signinVerify(const char *ticket, const char *otp, Session *session);
+ErrorCode signinResend(const char *ticket, int *channels);
+int signinPendingCount(void);
+int signinSweepExpired(time_t now);     // returns the number of flows dropped
+
+#endif // SIGNIN_FLOW_H
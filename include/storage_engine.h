@@ -0,0 +1,67 @@
+#ifndef STORAGE_ENGINE_H
+#define STORAGE_ENGINE_H
+
+#include "config.h"
+#include "auth.h"
+#include "campus_unified.h"
+#include "segment_store.h"
+
+// One interface over the places profiles and campus records can live:
+//
+//   sqlite  the application database: users table and campus_records
+//           (initDatabase() first; closing the engine leaves the database open)
+//   log     two segment stores (segment_store.h): records in `dir`, profiles
+//           in `dir`/profiles
+//   memory  hash table in the process; nothing survives close
+//
+// Every engine takes the same calls with the same results, so a deployment
+// can pick one on measured throughput (src/tests/benchStorage.c) and the
+// conformance suite (src/tests/testStorageEngine.c) holds them to it.
+// Deleting a profile deletes the user's campus record with it. Scans visit in
+// no particular order; visitors return 0 to stop and must not call back into
+// the engine.
+typedef struct StorageEngine StorageEngine;
+
+typedef int (*ProfileVisitor)(const Profile *profile, void *ctx);
+// The view points into the engine's storage and is valid only during the call
+typedef int (*CampusRecordVisitor)(const CampusRecordView *record, void *ctx);
+
+typedef struct {
+    const char *name;
+    int persistent;             // data survives close and reopen
+    ErrorCode (*getProfile)(StorageEngine *engine, const char *userID, Profile *profile);
+    ErrorCode (*putProfile)(StorageEngine *engine, const Profile *profile);
+    ErrorCode (*deleteProfile)(StorageEngine *engine, const char *userID);
+    ErrorCode (*scanProfiles)(StorageEngine *engine, ProfileVisitor visit, void *ctx);
+    ErrorCode (*getRecord)(StorageEngine *engine, const char *userID, UnifiedCampusData *data);
+    ErrorCode (*putRecord)(StorageEngine *engine, const UnifiedCampusData *data);
+    ErrorCode (*deleteRecord)(StorageEngine *engine, const char *userID);
+    ErrorCode (*scanRecords)(StorageEngine *engine, CampusRecordVisitor visit, void *ctx);
+    void (*close)(StorageEngine *engine);
+} StorageEngineOps;
+
+struct StorageEngine {
+    const StorageEngineOps *ops;
+    void *state;
+};
+
+ErrorCode storageOpenSqlite(StorageEngine **engine);
+// `options` NULL takes segmentStoreDefaultOptions()
+ErrorCode storageOpenLog(const char *dir, const SegmentStoreOptions *options, StorageEngine **engine);
+ErrorCode storageOpenMemory(StorageEngine **engine);
+// "sqlite", "log" (in `dir`, SEGMENT_STORE_DIR when NULL) or "memory"
+ErrorCode storageOpenByName(const char *name, const char *dir, StorageEngine **engine);
+void storageClose(StorageEngine *engine);
+
+// Argument checks, then the engine's own call. ERROR_NOT_FOUND for unknown
+// IDs; puts insert or replace.
+ErrorCode storageGetProfile(StorageEngine *engine, const char *userID, Profile *profile);
+ErrorCode storagePutProfile(StorageEngine *engine, const Profile *profile);
+ErrorCode storageDeleteProfile(StorageEngine *engine, const char *userID);
+ErrorCode storageScanProfiles(StorageEngine *engine, ProfileVisitor visit, void *ctx);
+ErrorCode storageGetRecord(StorageEngine *engine, const char *userID, UnifiedCampusData *data);
+ErrorCode storagePutRecord(StorageEngine *engine, const UnifiedCampusData *data);
+ErrorCode storageDeleteRecord(StorageEngine *engine, const char *userID);
+ErrorCode storageScanRecords(StorageEngine *engine, CampusRecordVisitor visit, void *ctx);
+
+#endif // STORAGE_ENGINE_H
@@ -2,6 +2,7 @@
 #define STUDENT_H
 
 #include <stdbool.h>
+#include <time.h>
 #include "config.h"
 #include "auth.h"
 
@@ -41,7 +42,28 @@ typedef struct {
     double monthlyRent;
 } HostelData;
 
-// Campus-specific data management
+// user_data blob layouts as saveUserData takes and loadUserData returns
+// them (marks are stored packed, see intern.h)
+typedef struct {
+    int count;
+    char subjects[MAX_SUBJECTS][MAX_LEN];
+    int marks[MAX_SUBJECTS];
+    int fullMarks[MAX_SUBJECTS];
+} SchoolMarks;
+
+typedef struct {
+    int count;
+    char subjects[MAX_SUBJECTS][MAX_LEN];
+    int marks[MAX_SUBJECTS];
+    int credits[MAX_SUBJECTS];
+} CollegeMarks;
+
+// Hospital and hostel records: free-text value per profile field
+typedef struct {
+    int count;
+    char fields[MAX_SUBJECTS][MAX_LEN];
+    char values[MAX_SUBJECTS][MAX_LEN];
+} FieldValues;
 
 // Campus-specific data management
 void saveSchoolData(const char *studentID);
@@ -54,11 +76,58 @@ void loadCollegeData(const char *studentID);
 void loadHospitalData(const char *patientID);
 void loadHostelData(const char *residentID);
 
+// Non-interactive storage (validated; subject/field names come from the profile)
+const char* campusDataType(CampusType type);
+ErrorCode storeSchoolMarks(const char *studentID, const int *marks, const int *fullMarks, int count);
+ErrorCode storeCollegeMarks(const char *studentID, const int *marks, const int *credits, int count);
+ErrorCode storeFieldValues(const char *userID, CampusType type, const char values[][MAX_LEN], int count);
+
+// One report page as positioned lines of 12 pt Helvetica, shared by single
+// exports and merged reports
+#define REPORT_MAX_LINES (MAX_SUBJECTS + 10)
+
+typedef struct {
+    float x, y;
+    char text[256];
+} ReportLine;
+
+typedef struct {
+    int count;
+    ReportLine lines[REPORT_MAX_LINES];
+} ReportLayout;
+
+// `data` is the campus blob for p->campusType (SchoolMarks, CollegeMarks or FieldValues)
+ErrorCode layoutCampusReport(const Profile *p, const void *data, ReportLayout *layout);
+// Percentage for school, CGPA for college, 0 otherwise
+float campusReportScore(CampusType type, const void *data);
+
 void exportSchoolPDF(const char *studentID);
 void exportCollegePDF(const char *studentID);
 void exportHospitalPDF(const char *patientID);
 void exportHostelPDF(const char *residentID);
 
+// Report for the profile's campus type; pathOut receives the written file
+ErrorCode exportCampusReport(const char *userID, char *pathOut, size_t size);
+
+// Same report for an already loaded profile, written to <dir><userID><suffix>
+// through a temporary file and rename(). Prints nothing and keeps no shared
+// state, so report runs call it from many threads. ERROR_NOT_FOUND when the
+// user has no campus data.
+ErrorCode writeCampusReport(const Profile *p, const char *dir, char *pathOut, size_t size);
+
+// In-memory report for transports that send the file themselves (HTTP): the
+// document is rendered with HPDF_SaveToStream and nothing is written under
+// DATA_DIR. The CLI and the JSON `export` op keep writing files.
+typedef struct {
+    unsigned char *data;        // malloc'd; release with freeExportBuffer()
+    size_t length;
+    char name[64];              // the name the report has on disk
+    const char *contentType;    // "application/pdf" (plain text without HPDF)
+} ExportBuffer;
+
+ErrorCode renderCampusReport(const Profile *p, ExportBuffer *out);
+void freeExportBuffer(ExportBuffer *buffer);
+
 // Profile export functions
 int exportProfilePDF(const char *userID, const char *filename);
 int exportProfileTXT(const char *userID, const char *filename);
@@ -70,8 +139,8 @@ void exportRecoveredProfileTXT(const Profile *p, const char *filename);
 void exportRecoveredProfileCSV(const Profile *p, const char *filename);
 
 // Utilities
-const char* getGrade(float percent);
-void printSummary(int total, int full, CampusType type);
+const char* getDefaultGrade(float percent);     // default scheme; use gradingSchemeFor(institute) for a student
+void printSummary(int total, int full, CampusType type, const char *institute);
 const char* getCampusName(CampusType type);
 
 
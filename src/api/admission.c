@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../../include/api/admission.h"
+
+#define ADMIT_SHORT_ALPHA   0.2     // EWMA weights for the gradient
+#define ADMIT_LONG_ALPHA    0.01
+#define ADMIT_TOLERANCE     1.5     // service time may grow this much before the limit shrinks
+#define ADMIT_SMOOTHING     0.2     // share of each new limit estimate that is applied
+#define ADMIT_RETRY_MIN_MS  100
+#define ADMIT_RETRY_MAX_MS  30000
+
+AdmitClassConfig admissionDefaultConfig(AdmitClass cls, int workers) {
+    AdmitClassConfig c;
+    memset(&c, 0, sizeof(c));
+    if (workers < 1) workers = 1;
+    c.minLimit = 1;
+    c.targetMillis = 5;
+    c.intervalMillis = 100;
+    switch (cls) {
+        case ADMIT_CLASS_FAST:
+            c.maxLimit = workers;
+            c.maxQueue = 4096;
+            c.deadlineMillis = 1000;
+            break;
+        case ADMIT_CLASS_AUTH:
+            c.maxLimit = workers > 1 ? workers - 1 : 1;
+            c.maxQueue = 256;
+            c.deadlineMillis = 2000;
+            c.targetMillis = 20;
+            break;
+        default:
+            c.maxLimit = workers > 2 ? workers / 2 : 1;
+            c.maxQueue = 32;
+            c.deadlineMillis = 5000;
+            c.targetMillis = 100;
+            c.intervalMillis = 1000;
+            break;
+    }
+    return c;
+}
+
+void admissionInit(AdmissionControl *ac, const AdmitClassConfig config[ADMIT_CLASS_COUNT]) {
+    memset(ac, 0, sizeof(*ac));
+    for (int i = 0; i < ADMIT_CLASS_COUNT; i++) {
+        AdmitClassState *s = &ac->classes[i];
+        s->config = config[i];
+        if (s->config.minLimit < 1) s->config.minLimit = 1;
+        if (s->config.maxLimit < s->config.minLimit) s->config.maxLimit = s->config.minLimit;
+        s->limit = s->config.maxLimit;     // start open; latency pulls it down
+    }
+}
+
+int admissionOffer(AdmissionControl *ac, AdmitClass cls) {
+    AdmitClassState *s = &ac->classes[cls];
+    if (s->queued >= s->config.maxQueue) {
+        s->rejected++;
+        return 0;
+    }
+    s->queued++;
+    return 1;
+}
+
+AdmitDecision admissionPoll(AdmissionControl *ac, AdmitClass cls, uint64_t waitedMicros, uint64_t nowMicros) {
+    AdmitClassState *s = &ac->classes[cls];
+    uint64_t target = (uint64_t)s->config.targetMillis * 1000u;
+
+    // A new interval starts on the first poll past the old one; overload means
+    // even the luckiest request in the last interval waited longer than target
+    if (nowMicros >= s->intervalEnd) {
+        s->overloaded = s->intervalEnd != 0 && s->minDelay > target;
+        s->intervalEnd = nowMicros + (uint64_t)s->config.intervalMillis * 1000u;
+        s->minDelay = waitedMicros;
+    } else if (waitedMicros < s->minDelay) {
+        s->minDelay = waitedMicros;
+    }
+
+    uint64_t timeout = s->overloaded ? target : (uint64_t)s->config.deadlineMillis * 1000u;
+    if (waitedMicros > timeout) {
+        s->queued--;
+        s->shed++;
+        return ADMIT_SHED;
+    }
+    if (s->inflight >= (int)s->limit) return ADMIT_WAIT;
+    s->queued--;
+    s->inflight++;
+    s->admitted++;
+    return ADMIT_RUN;
+}
+
+void admissionFinish(AdmissionControl *ac, AdmitClass cls, uint64_t serviceMicros) {
+    AdmitClassState *s = &ac->classes[cls];
+    double sample = (double)serviceMicros;
+    int inflight = s->inflight--;
+    s->completed++;
+    if (s->longMicros == 0.0) s->shortMicros = s->longMicros = sample;
+    s->shortMicros += ADMIT_SHORT_ALPHA * (sample - s->shortMicros);
+    s->longMicros += ADMIT_LONG_ALPHA * (sample - s->longMicros);
+    // After a sustained shift the long average catches up faster
+    if (s->longMicros > 2.0 * s->shortMicros) s->longMicros *= 0.95;
+
+    // An under-used limit says nothing about capacity; only adjust when it was reached
+    if (inflight < s->limit / 2.0) return;
+    double gradient = ADMIT_TOLERANCE * s->longMicros / (s->shortMicros > 1.0 ? s->shortMicros : 1.0);
+    if (gradient > 1.0) gradient = 1.0;
+    if (gradient < 0.5) gradient = 0.5;
+    // Probe upwards only while latency holds; headroom during a slowdown would
+    // cancel most of the backoff at small limits
+    double estimate = s->limit * gradient + (gradient >= 1.0 ? sqrt(s->limit) : 0.0);
+    double limit = s->limit * (1.0 - ADMIT_SMOOTHING) + estimate * ADMIT_SMOOTHING;
+    if (limit < s->config.minLimit) limit = s->config.minLimit;
+    if (limit > s->config.maxLimit) limit = s->config.maxLimit;
+    s->limit = limit;
+}
+
+// Time for the queue ahead to drain at the current limit
+unsigned admissionRetryAfterMillis(const AdmissionControl *ac, AdmitClass cls) {
+    const AdmitClassState *s = &ac->classes[cls];
+    double perRequest = s->shortMicros > 0.0 ? s->shortMicros / 1000.0 : 1.0;
+    double millis = (s->queued + s->inflight + 1) * perRequest / (s->limit > 1.0 ? s->limit : 1.0);
+    if (millis < ADMIT_RETRY_MIN_MS) return ADMIT_RETRY_MIN_MS;
+    if (millis > ADMIT_RETRY_MAX_MS) return ADMIT_RETRY_MAX_MS;
+    return (unsigned)millis;
+}
+
+const char *admissionClassName(AdmitClass cls) {
+    switch (cls) {
+        case ADMIT_CLASS_FAST: return "fast";
+        case ADMIT_CLASS_AUTH: return "auth";
+        case ADMIT_CLASS_EXPORT: return "export";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/api/batch.h"
+#include "../../include/api/json.h"
+#include "../../include/api/ui.h"
+#include "../../include/database.h"
+
+#define BATCH_REF_LEN       32
+#define BATCH_LINE_CHUNK    4096
+
+typedef struct {
+    char name[BATCH_REF_LEN];
+    char userID[20];
+} BatchRef;
+
+typedef struct {
+    FILE *out;
+    const BatchOptions *options;
+    BatchStats *stats;
+    JsonWriter w;
+    BatchRef *refs;             // "$name" -> user ID, bound by signup "as"
+    size_t refCount, refCap;
+    int inGroup;
+    ErrorCode groupError;       // first failure inside the open group
+    unsigned long long groupSucceeded;
+    size_t groupRefs;           // bindings made before the group opened
+    ErrorCode result;
+    int stopped;
+} BatchRun;
+
+static JsonDoc requestDoc, responseDoc;    // batch mode is single-threaded
+
+// One line of any length, newline and CR stripped; 0 at end of input
+static int readLine(FILE *in, char **buf, size_t *cap, size_t *len) {
+    *len = 0;
+    for (;;) {
+        if (*cap - *len < 2) {
+            size_t grown = *cap ? *cap * 2 : BATCH_LINE_CHUNK;
+            char *p = realloc(*buf, grown);
+            if (!p) return 0;
+            *buf = p;
+            *cap = grown;
+        }
+        if (!fgets(*buf + *len, (int)(*cap - *len), in)) break;
+        *len += strlen(*buf + *len);
+        if ((*buf)[*len - 1] == '\n') break;
+    }
+    if (*len == 0 && feof(in)) return 0;
+    while (*len > 0 && ((*buf)[*len - 1] == '\n' || (*buf)[*len - 1] == '\r')) (*buf)[--*len] = '\0';
+    return 1;
+}
+
+static void emit(BatchRun *run) {
+    jwRaw(&run->w, "\n", 1);
+    if (!run->w.failed) fwrite(run->w.data, 1, run->w.length, run->out);
+    jwReset(&run->w);
+}
+
+static void noteFailure(BatchRun *run, ErrorCode rc) {
+    run->stats->failed++;
+    if (run->inGroup && run->groupError == SUCCESS) run->groupError = rc;
+    if (run->result == SUCCESS) run->result = rc;
+    if (run->options->stopOnError) run->stopped = 1;
+}
+
+static const char *findRef(const BatchRun *run, const char *name) {
+    for (size_t i = run->refCount; i-- > 0;) {
+        if (strcmp(run->refs[i].name, name) == 0) return run->refs[i].userID;
+    }
+    return NULL;
+}
+
+static void bindRef(BatchRun *run, const char *name, const char *userID) {
+    if (run->refCount == run->refCap) {
+        size_t grown = run->refCap ? run->refCap * 2 : 64;
+        BatchRef *p = realloc(run->refs, grown * sizeof(BatchRef));
+        if (!p) return;
+        run->refs = p;
+        run->refCap = grown;
+    }
+    BatchRef *ref = &run->refs[run->refCount++];
+    snprintf(ref->name, sizeof(ref->name), "%s", name);
+    snprintf(ref->userID, sizeof(ref->userID), "%s", userID);
+}
+
+// ---- Groups ----
+
+static ErrorCode openGroup(BatchRun *run) {
+    if (executeQuery("SAVEPOINT batch_group;") != SUCCESS) return ERROR_DATABASE;
+    run->inGroup = 1;
+    run->groupError = SUCCESS;
+    run->groupSucceeded = 0;
+    run->groupRefs = run->refCount;
+    return SUCCESS;
+}
+
+// Ends the open group and writes its result line. A commit only sticks when
+// nothing in the group failed and no `failure` reason is given.
+static void closeGroup(BatchRun *run, int commit, const char *failure) {
+    ErrorCode rc = failure ? ERROR_INVALID_INPUT : run->groupError;
+    int keep = commit && rc == SUCCESS;
+    if (keep && executeQuery("RELEASE batch_group;") != SUCCESS) {
+        rc = ERROR_DATABASE;
+        keep = 0;
+    }
+    if (!keep) {
+        executeQuery("ROLLBACK TO batch_group;");
+        executeQuery("RELEASE batch_group;");
+        run->stats->rolledBack += run->groupSucceeded;
+        run->refCount = run->groupRefs;     // users created in the group are gone
+    }
+    run->inGroup = 0;
+    run->stats->groups++;
+
+    jwBeginObject(&run->w);
+    jwKeyString(&run->w, "op", commit ? "commit" : "rollback");
+    jwKeyInt(&run->w, keep ? "applied" : "rolledBack", (long long)run->groupSucceeded);
+    jwKeyBool(&run->w, "ok", keep || !commit);
+    if (commit && !keep) {
+        jwKeyString(&run->w, "error", apiErrorName(rc));
+        jwKeyString(&run->w, "message", failure ? failure : "a request in the group failed; group rolled back");
+        if (run->result == SUCCESS) run->result = rc;
+    }
+    jwEndObject(&run->w);
+    emit(run);
+}
+
+static void controlError(BatchRun *run, const char *op, const char *message) {
+    jwBeginObject(&run->w);
+    jwKeyString(&run->w, "op", op);
+    jwKeyBool(&run->w, "ok", 0);
+    jwKeyString(&run->w, "error", apiErrorName(ERROR_INVALID_INPUT));
+    jwKeyString(&run->w, "message", message);
+    jwEndObject(&run->w);
+    emit(run);
+    noteFailure(run, ERROR_INVALID_INPUT);
+}
+
+// begin / commit / rollback; 0 when `op` is an ordinary request
+static int runControl(BatchRun *run, const char *op) {
+    if (strcmp(op, "begin") == 0) {
+        if (run->options->atomic || run->inGroup) controlError(run, op, "groups do not nest");
+        else if (openGroup(run) != SUCCESS) controlError(run, op, "cannot start a transaction");
+        else {
+            jwBeginObject(&run->w);
+            jwKeyString(&run->w, "op", op);
+            jwKeyBool(&run->w, "ok", 1);
+            jwEndObject(&run->w);
+            emit(run);
+        }
+        return 1;
+    }
+    int commit = strcmp(op, "commit") == 0;
+    if (!commit && strcmp(op, "rollback") != 0) return 0;
+    if (run->options->atomic) controlError(run, op, "the whole script is one group with --atomic");
+    else if (!run->inGroup) controlError(run, op, "no open group");
+    else closeGroup(run, commit, NULL);
+    return 1;
+}
+
+// ---- Requests ----
+
+static void runRequest(BatchRun *run, const char *line, size_t length) {
+    char op[24] = "", user[BATCH_REF_LEN + 1] = "", as[BATCH_REF_LEN] = "";
+    const char *actingUser = NULL;
+    if (jsonParse(&requestDoc, line, length) == SUCCESS && requestDoc.tokens[0].type == JSON_OBJECT) {
+        jsonFindString(&requestDoc, 0, "op", op, sizeof(op));
+        if (runControl(run, op)) return;
+        jsonFindString(&requestDoc, 0, "as", as, sizeof(as));
+        if (jsonFindString(&requestDoc, 0, "user", user, sizeof(user)) == SUCCESS) {
+            actingUser = user[0] == '$' ? findRef(run, user + 1) : user;
+        }
+    }
+
+    run->stats->requests++;
+    ErrorCode rc;
+    if (user[0] == '$' && !actingUser) {
+        rc = ERROR_NOT_FOUND;
+        apiWriteError(line, length, rc, "unknown $user reference", &run->w);
+    } else {
+        rc = apiHandleAsUser(line, length, actingUser, &run->w);
+    }
+
+    if (rc == SUCCESS) {
+        run->stats->succeeded++;
+        if (run->inGroup) run->groupSucceeded++;
+        char userID[20];
+        if (as[0] && strcmp(op, "signup") == 0 &&
+            jsonParse(&responseDoc, run->w.data, run->w.length) == SUCCESS &&
+            jsonFindString(&responseDoc, 0, "userID", userID, sizeof(userID)) == SUCCESS) {
+            bindRef(run, as, userID);
+        }
+    } else {
+        noteFailure(run, rc);
+    }
+    emit(run);
+}
+
+ErrorCode batchRun(FILE *in, FILE *out, const BatchOptions *options, BatchStats *stats) {
+    static const BatchOptions defaults = { 0, 0 };
+    BatchStats ignored;
+    BatchRun run;
+    memset(&run, 0, sizeof(run));
+    run.out = out;
+    run.options = options ? options : &defaults;
+    run.stats = stats ? stats : &ignored;
+    memset(run.stats, 0, sizeof(*run.stats));
+    jwInit(&run.w);
+
+    if (run.options->atomic && openGroup(&run) != SUCCESS) return ERROR_DATABASE;
+
+    char *line = NULL;
+    size_t cap = 0, len;
+    while (!run.stopped && readLine(in, &line, &cap, &len)) {
+        size_t start = 0;
+        while (start < len && (line[start] == ' ' || line[start] == '\t')) start++;
+        if (start == len || line[start] == '#') continue;
+        runRequest(&run, line + start, len - start);
+    }
+
+    // An unfinished group is only complete under --atomic (or cut short by a failure)
+    if (run.inGroup) {
+        int complete = run.options->atomic || run.stopped;
+        closeGroup(&run, 1, complete ? NULL : "missing commit; group rolled back");
+    }
+    fflush(out);
+    free(line);
+    free(run.refs);
+    jwFree(&run.w);
+    return run.result;
+}
@@ -0,0 +1,377 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include "../../include/api/http.h"
+#include "../../include/api/ui.h"
+
+typedef struct {
+    const char *method;
+    const char *path;
+    const char *op;
+    int successStatus;
+    int binary;             // body is the rendered file, not JSON
+} HttpRoute;
+
+// REST-ish mapping onto the operation table in ui.c
+static const HttpRoute routes[] = {
+    { "GET",  "/api/ping",       "ping",       200, 0 },
+    { "POST", "/api/signup",     "signup",     201, 0 },
+    { "POST", "/api/signin",     "signin",     200, 0 },
+    { "POST", "/api/verify-otp", "verify_otp", 200, 0 },
+    { "POST", "/api/resend-otp", "resend_otp", 200, 0 },
+    { "POST", "/api/signout",    "signout",    200, 0 },
+    { "GET",  "/api/profile",    "profile",    200, 0 },
+    { "GET",  "/api/data",       "data_get",   200, 0 },
+    { "PUT",  "/api/data",       "data_put",   200, 0 },
+    { "GET",  "/api/stats",      "stats",      200, 0 },
+    { "POST", "/api/export",     "export",     200, 0 },
+    { "GET",  "/api/report",     "export",     200, 1 },
+};
+
+#define ROUTE_COUNT (sizeof(routes) / sizeof(routes[0]))
+
+// ---- Parser ----
+
+// RFC 9110 token characters
+static int isTokenChar(unsigned char ch) {
+    if (ch >= 'a' && ch <= 'z') return 1;
+    if (ch >= 'A' && ch <= 'Z') return 1;
+    if (ch >= '0' && ch <= '9') return 1;
+    return ch && strchr("!#$%&'*+-.^_`|~", ch) != NULL;
+}
+
+static int equalsIgnoreCase(const char *a, size_t aLen, const char *b) {
+    size_t bLen = strlen(b);
+    return aLen == bLen && strncasecmp(a, b, aLen) == 0;
+}
+
+// Comma-separated header value contains `token` (case-insensitive)
+static int hasToken(const char *value, size_t length, const char *token) {
+    const char *p = value, *end = value + length;
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) p++;
+        const char *start = p;
+        while (p < end && *p != ',') p++;
+        const char *stop = p;
+        while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+        if (equalsIgnoreCase(start, (size_t)(stop - start), token)) return 1;
+    }
+    return 0;
+}
+
+// Next line in [p, end): sets *lineEnd before CR/LF, returns the start of the
+// following line, or NULL when no LF has arrived yet
+static const char *nextLine(const char *p, const char *end, const char **lineEnd) {
+    const char *lf = memchr(p, '\n', (size_t)(end - p));
+    if (!lf) return NULL;
+    *lineEnd = (lf > p && lf[-1] == '\r') ? lf - 1 : lf;
+    return lf + 1;
+}
+
+HttpParseResult httpParseRequest(const char *buf, size_t length, size_t maxBytes, HttpRequest *req) {
+    const char *p = buf, *end = buf + length, *eol;
+    memset(req, 0, sizeof(*req));
+
+    // Tolerate stray blank lines between pipelined requests
+    while (p < end && (*p == '\r' || *p == '\n')) p++;
+
+    const char *next = nextLine(p, end, &eol);
+    if (!next) return length > maxBytes ? HTTP_PARSE_TOO_LARGE : HTTP_PARSE_INCOMPLETE;
+
+    // Request line: METHOD SP target SP HTTP/1.x
+    const char *q = p;
+    while (q < eol && isTokenChar((unsigned char)*q)) q++;
+    if (q == p || q >= eol || *q != ' ') return HTTP_PARSE_BAD_REQUEST;
+    req->method = p;
+    req->methodLen = (size_t)(q - p);
+
+    const char *target = ++q;
+    while (q < eol && *q != ' ') q++;
+    if (q == target || q >= eol || *target != '/') return HTTP_PARSE_BAD_REQUEST;
+    const char *question = memchr(target, '?', (size_t)(q - target));
+    req->path = target;
+    req->pathLen = (size_t)((question ? question : q) - target);
+    if (question) {
+        req->query = question + 1;
+        req->queryLen = (size_t)(q - question - 1);
+    }
+
+    q++;
+    if (eol - q != 8 || memcmp(q, "HTTP/1.", 7) != 0 || q[7] < '0' || q[7] > '9') {
+        return HTTP_PARSE_BAD_REQUEST;
+    }
+    req->minorVersion = q[7] - '0';
+    req->keepAlive = req->minorVersion >= 1;
+
+    int sawLength = 0;
+    int connectionClose = 0, connectionKeepAlive = 0;
+    for (;;) {
+        p = next;
+        next = nextLine(p, end, &eol);
+        if (!next) return (size_t)(end - buf) > maxBytes ? HTTP_PARSE_TOO_LARGE : HTTP_PARSE_INCOMPLETE;
+        if ((size_t)(next - buf) > maxBytes) return HTTP_PARSE_TOO_LARGE;
+        if (eol == p) break;    // blank line ends the head
+
+        // name ":" OWS value OWS -- no whitespace before the colon, no folding
+        q = p;
+        while (q < eol && isTokenChar((unsigned char)*q)) q++;
+        if (q == p || q >= eol || *q != ':') return HTTP_PARSE_BAD_REQUEST;
+        if (req->headerCount == HTTP_MAX_HEADERS) return HTTP_PARSE_TOO_LARGE;
+        HttpHeader *h = &req->headers[req->headerCount++];
+        h->name = p;
+        h->nameLen = (size_t)(q - p);
+        q++;
+        while (q < eol && (*q == ' ' || *q == '\t')) q++;
+        const char *valueEnd = eol;
+        while (valueEnd > q && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) valueEnd--;
+        h->value = q;
+        h->valueLen = (size_t)(valueEnd - q);
+
+        if (equalsIgnoreCase(h->name, h->nameLen, "Content-Length")) {
+            size_t value = 0;
+            if (h->valueLen == 0) return HTTP_PARSE_BAD_REQUEST;
+            for (size_t i = 0; i < h->valueLen; i++) {
+                char ch = h->value[i];
+                if (ch < '0' || ch > '9') return HTTP_PARSE_BAD_REQUEST;
+                if (value > maxBytes) {     // stop before overflowing; the body is too large anyway
+                    req->contentLength = value;
+                    return HTTP_PARSE_TOO_LARGE;
+                }
+                value = value * 10 + (size_t)(ch - '0');
+            }
+            if (sawLength && value != req->contentLength) return HTTP_PARSE_BAD_REQUEST;
+            sawLength = 1;
+            req->contentLength = value;
+        } else if (equalsIgnoreCase(h->name, h->nameLen, "Transfer-Encoding")) {
+            return HTTP_PARSE_UNSUPPORTED;
+        } else if (equalsIgnoreCase(h->name, h->nameLen, "Connection")) {
+            connectionClose |= hasToken(h->value, h->valueLen, "close");
+            connectionKeepAlive |= hasToken(h->value, h->valueLen, "keep-alive");
+        }
+    }
+
+    if (connectionClose) req->keepAlive = 0;
+    else if (connectionKeepAlive) req->keepAlive = 1;
+
+    req->headerBytes = (size_t)(next - buf);
+    if (req->headerBytes + req->contentLength > maxBytes) return HTTP_PARSE_TOO_LARGE;
+    if (length < req->headerBytes + req->contentLength) return HTTP_PARSE_INCOMPLETE;
+    req->body = next;
+    return HTTP_PARSE_OK;
+}
+
+const HttpHeader *httpFindHeader(const HttpRequest *req, const char *name) {
+    for (int i = 0; i < req->headerCount; i++) {
+        if (equalsIgnoreCase(req->headers[i].name, req->headers[i].nameLen, name)) return &req->headers[i];
+    }
+    return NULL;
+}
+
+// ---- Responses ----
+
+int httpStatusForError(ErrorCode code) {
+    switch (code) {
+        case SUCCESS: return 200;
+        case ERROR_INVALID_INPUT: return 400;
+        case ERROR_AUTH_FAILED: return 401;
+        case ERROR_PERMISSION: return 403;
+        case ERROR_NOT_FOUND: return 404;
+        case ERROR_ALREADY_EXISTS: return 409;
+        case ERROR_NETWORK: return 502;
+        case ERROR_OVERLOADED: return 503;
+        default: return 500;
+    }
+}
+
+const char *httpStatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Content Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default: return "Internal Server Error";
+    }
+}
+
+// IMF-fixdate, reformatted at most once a second per thread
+static const char *httpDate(void) {
+    static __thread time_t cachedSecond;
+    static __thread char cached[40];
+    time_t now = time(NULL);
+    if (now != cachedSecond) {
+        struct tm tm;
+#ifdef _WIN32
+        gmtime_s(&tm, &now);
+#else
+        gmtime_r(&now, &tm);
+#endif
+        strftime(cached, sizeof(cached), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        cachedSecond = now;
+    }
+    return cached;
+}
+
+static int formatHead(char *head, size_t size, int status, int keepAlive, int minorVersion,
+                      const char *contentType, size_t bodyLen, const char *extraHeaders) {
+    const char *connection = !keepAlive ? "Connection: close\r\n"
+                           : minorVersion == 0 ? "Connection: keep-alive\r\n" : "";
+    int n = snprintf(head, size,
+                     "HTTP/1.1 %d %s\r\n"
+                     "Date: %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Cache-Control: no-store\r\n"
+                     "%s%s\r\n",
+                     status, httpStatusText(status), httpDate(), contentType, bodyLen,
+                     connection, extraHeaders ? extraHeaders : "");
+    return n < 0 || (size_t)n >= size ? -1 : n;
+}
+
+// The body was streamed from `bodyStart`; now that its length is known, the
+// head is written in front of it (one memmove of the body, no second buffer)
+static void finishResponse(JsonWriter *out, size_t bodyStart, int status, int keepAlive,
+                           int minorVersion, const char *extraHeaders) {
+    char head[512];
+    size_t bodyLen = out->length - bodyStart;
+    int n = formatHead(head, sizeof(head), status, keepAlive, minorVersion, "application/json",
+                       bodyLen, extraHeaders);
+    if (n < 0) {
+        out->failed = 1;
+        return;
+    }
+    jwRaw(out, head, (size_t)n);   // grows the buffer by the head's size
+    if (out->failed) return;
+    memmove(out->data + bodyStart + n, out->data + bodyStart, bodyLen);
+    memcpy(out->data + bodyStart, head, (size_t)n);
+}
+
+static void writeErrorBody(JsonWriter *out, const char *error, const char *message) {
+    jwBeginObject(out);
+    jwKeyBool(out, "ok", 0);
+    jwKeyString(out, "error", error);
+    jwKeyString(out, "message", message);
+    jwEndObject(out);
+}
+
+void httpWriteError(JsonWriter *out, int status, const char *message) {
+    size_t bodyStart = out->length;
+    writeErrorBody(out, status == 404 ? "NOT_FOUND" : "INVALID_INPUT", message);
+    finishResponse(out, bodyStart, status, 0, 1, NULL);
+}
+
+// ---- Routing ----
+
+// NULL when nothing matches; `allow` (optional) collects the methods the path does accept
+static const HttpRoute *findRoute(const HttpRequest *req, char *allow, size_t allowSize) {
+    if (allow) allow[0] = '\0';
+    for (size_t i = 0; i < ROUTE_COUNT; i++) {
+        if (!equalsIgnoreCase(req->path, req->pathLen, routes[i].path)) continue;
+        if (req->methodLen == strlen(routes[i].method) && memcmp(req->method, routes[i].method, req->methodLen) == 0) {
+            return &routes[i];
+        }
+        if (allow) {
+            size_t used = strlen(allow);
+            snprintf(allow + used, allowSize - used, "%s%s", used ? ", " : "", routes[i].method);
+        }
+    }
+    return NULL;
+}
+
+AdmitClass httpRequestClass(const char *request, size_t length) {
+    HttpRequest req;
+    if (httpParseRequest(request, length, length, &req) != HTTP_PARSE_OK) return ADMIT_CLASS_FAST;
+    const HttpRoute *route = findRoute(&req, NULL, 0);
+    return route ? apiOperationClass(route->op) : ADMIT_CLASS_FAST;
+}
+
+void httpWriteOverloaded(const char *request, size_t length, unsigned retryAfterMillis, JsonWriter *out) {
+    HttpRequest req;
+    size_t bodyStart = out->length;
+    int parsed = httpParseRequest(request, length, length, &req) == HTTP_PARSE_OK;
+    char extra[48];
+    snprintf(extra, sizeof(extra), "Retry-After: %u\r\n", (retryAfterMillis + 999) / 1000);
+    jwBeginObject(out);
+    jwKeyBool(out, "ok", 0);
+    jwKeyString(out, "error", apiErrorName(ERROR_OVERLOADED));
+    jwKeyString(out, "message", "server busy, retry later");
+    jwKeyInt(out, "retryAfterMs", retryAfterMillis);
+    jwEndObject(out);
+    finishResponse(out, bodyStart, 503, parsed && req.keepAlive, parsed ? req.minorVersion : 1, extra);
+}
+
+// The rendered report travels as the writer's attachment: only the head is
+// written, and the server sends the document straight from its buffer
+static void sendReport(const HttpRequest *req, const char *token, JsonWriter *out) {
+    size_t bodyStart = out->length;
+    ExportBuffer report;
+    ErrorCode rc = apiRenderReport(token, &report, out);
+    if (rc != SUCCESS) {
+        int status = httpStatusForError(rc);
+        finishResponse(out, bodyStart, status, req->keepAlive, req->minorVersion,
+                       status == 401 ? "WWW-Authenticate: Bearer\r\n" : NULL);
+        return;
+    }
+    char extra[128], head[640];
+    snprintf(extra, sizeof(extra), "Content-Disposition: attachment; filename=\"%s\"\r\n", report.name);
+    int n = formatHead(head, sizeof(head), 200, req->keepAlive, req->minorVersion, report.contentType,
+                       report.length, extra);
+    if (n < 0) {
+        freeExportBuffer(&report);
+        out->failed = 1;
+        return;
+    }
+    jwRaw(out, head, (size_t)n);
+    jwAttach(out, (char*)report.data, report.length);
+}
+
+void httpHandleRequest(const char *request, size_t length, JsonWriter *out) {
+    HttpRequest req;
+    size_t bodyStart = out->length;
+    if (httpParseRequest(request, length, length, &req) != HTTP_PARSE_OK) {
+        httpWriteError(out, 400, "malformed request");
+        return;
+    }
+
+    char allow[64];
+    const HttpRoute *route = findRoute(&req, allow, sizeof(allow));
+
+    if (!route) {
+        char extra[96] = "";
+        int status = allow[0] ? 405 : 404;
+        if (status == 405) snprintf(extra, sizeof(extra), "Allow: %s\r\n", allow);
+        writeErrorBody(out, status == 405 ? "INVALID_INPUT" : "NOT_FOUND",
+                       status == 405 ? "method not allowed" : "no such endpoint");
+        finishResponse(out, bodyStart, status, req.keepAlive, req.minorVersion, extra);
+        return;
+    }
+
+    // Authorization: Bearer <session token>
+    char token[64];
+    const char *tokenArg = NULL;
+    const HttpHeader *auth = httpFindHeader(&req, "Authorization");
+    if (auth && auth->valueLen > 7 && strncasecmp(auth->value, "Bearer ", 7) == 0 &&
+        auth->valueLen - 7 < sizeof(token)) {
+        memcpy(token, auth->value + 7, auth->valueLen - 7);
+        token[auth->valueLen - 7] = '\0';
+        tokenArg = token;
+    }
+
+    if (route->binary) {
+        sendReport(&req, tokenArg, out);
+        return;
+    }
+    ErrorCode rc = apiHandleOperation(route->op, tokenArg, req.body, req.contentLength, out);
+    int status = rc == SUCCESS ? route->successStatus : httpStatusForError(rc);
+    finishResponse(out, bodyStart, status, req.keepAlive, req.minorVersion,
+                   status == 401 ? "WWW-Authenticate: Bearer\r\n" : NULL);
+}
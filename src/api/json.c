@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../../include/api/json.h"
+
+// ---- Reader ----
+
+typedef struct {
+    JsonDoc *doc;
+    size_t pos;
+    int depth;
+} JsonParser;
+
+static void skipSpace(JsonParser *p) {
+    const char *t = p->doc->text;
+    while (p->pos < p->doc->length &&
+           (t[p->pos] == ' ' || t[p->pos] == '\t' || t[p->pos] == '\n' || t[p->pos] == '\r')) {
+        p->pos++;
+    }
+}
+
+static int newToken(JsonParser *p, JsonType type, size_t start) {
+    if (p->doc->count >= JSON_MAX_TOKENS) return -1;
+    int index = p->doc->count++;
+    JsonToken *tok = &p->doc->tokens[index];
+    tok->type = type;
+    tok->start = (int)start;
+    tok->end = (int)start;
+    tok->size = 0;
+    tok->next = index + 1;
+    return index;
+}
+
+static int parseValue(JsonParser *p);
+
+static int parseString(JsonParser *p) {
+    const char *t = p->doc->text;
+    size_t start = ++p->pos;     // past the opening quote
+    while (p->pos < p->doc->length) {
+        char c = t[p->pos];
+        if (c == '"') {
+            int index = newToken(p, JSON_STRING, start);
+            if (index < 0) return -1;
+            p->doc->tokens[index].end = (int)p->pos;
+            p->pos++;
+            return index;
+        }
+        if ((unsigned char)c < 0x20) return -1;
+        if (c == '\\') {
+            if (++p->pos >= p->doc->length) return -1;
+            if (t[p->pos] == 'u') {
+                if (p->pos + 4 >= p->doc->length) return -1;
+                p->pos += 4;
+            } else if (!strchr("\"\\/bfnrt", t[p->pos])) {
+                return -1;
+            }
+        }
+        p->pos++;
+    }
+    return -1;
+}
+
+static int parseLiteral(JsonParser *p) {
+    const char *t = p->doc->text + p->pos;
+    size_t left = p->doc->length - p->pos;
+    JsonType type = JSON_NONE;
+    size_t len = 0;
+    if (left >= 4 && memcmp(t, "true", 4) == 0) { type = JSON_BOOL; len = 4; }
+    else if (left >= 5 && memcmp(t, "false", 5) == 0) { type = JSON_BOOL; len = 5; }
+    else if (left >= 4 && memcmp(t, "null", 4) == 0) { type = JSON_NULL; len = 4; }
+    else {
+        while (len < left && (strchr("+-.eE", t[len]) || (t[len] >= '0' && t[len] <= '9'))) len++;
+        if (len == 0) return -1;
+        type = JSON_NUMBER;
+    }
+    int index = newToken(p, type, p->pos);
+    if (index < 0) return -1;
+    p->pos += len;
+    p->doc->tokens[index].end = (int)p->pos;
+    return index;
+}
+
+static int parseContainer(JsonParser *p, JsonType type) {
+    if (++p->depth > JSON_MAX_DEPTH) return -1;
+    int index = newToken(p, type, p->pos);
+    if (index < 0) return -1;
+    char close = type == JSON_OBJECT ? '}' : ']';
+    p->pos++;
+    skipSpace(p);
+    if (p->pos < p->doc->length && p->doc->text[p->pos] == close) {
+        p->pos++;
+    } else {
+        while (1) {
+            skipSpace(p);
+            if (type == JSON_OBJECT) {
+                if (p->pos >= p->doc->length || p->doc->text[p->pos] != '"') return -1;
+                if (parseString(p) < 0) return -1;
+                skipSpace(p);
+                if (p->pos >= p->doc->length || p->doc->text[p->pos] != ':') return -1;
+                p->pos++;
+            }
+            if (parseValue(p) < 0) return -1;
+            p->doc->tokens[index].size++;
+            skipSpace(p);
+            if (p->pos >= p->doc->length) return -1;
+            char c = p->doc->text[p->pos++];
+            if (c == close) break;
+            if (c != ',') return -1;
+        }
+    }
+    p->doc->tokens[index].end = (int)p->pos;
+    p->doc->tokens[index].next = p->doc->count;
+    p->depth--;
+    return index;
+}
+
+static int parseValue(JsonParser *p) {
+    skipSpace(p);
+    if (p->pos >= p->doc->length) return -1;
+    switch (p->doc->text[p->pos]) {
+        case '{': return parseContainer(p, JSON_OBJECT);
+        case '[': return parseContainer(p, JSON_ARRAY);
+        case '"': return parseString(p);
+        default:  return parseLiteral(p);
+    }
+}
+
+ErrorCode jsonParse(JsonDoc *doc, const char *text, size_t length) {
+    if (!doc || !text) return ERROR_INVALID_INPUT;
+    doc->text = text;
+    doc->length = length;
+    doc->count = 0;
+    JsonParser p = { doc, 0, 0 };
+    if (parseValue(&p) < 0) return ERROR_INVALID_INPUT;
+    skipSpace(&p);
+    return p.pos == length ? SUCCESS : ERROR_INVALID_INPUT;
+}
+
+int jsonTokenEquals(const JsonDoc *doc, int token, const char *literal) {
+    if (token < 0 || token >= doc->count) return 0;
+    const JsonToken *tok = &doc->tokens[token];
+    size_t len = (size_t)(tok->end - tok->start);
+    return strlen(literal) == len && memcmp(doc->text + tok->start, literal, len) == 0;
+}
+
+int jsonFind(const JsonDoc *doc, int object, const char *key) {
+    if (object < 0 || object >= doc->count || doc->tokens[object].type != JSON_OBJECT) return -1;
+    int tok = object + 1;
+    for (int i = 0; i < doc->tokens[object].size; i++) {
+        int value = tok + 1;
+        if (jsonTokenEquals(doc, tok, key)) return value;
+        tok = doc->tokens[value].next;
+    }
+    return -1;
+}
+
+int jsonArrayItem(const JsonDoc *doc, int array, int index) {
+    if (array < 0 || array >= doc->count || doc->tokens[array].type != JSON_ARRAY) return -1;
+    if (index < 0 || index >= doc->tokens[array].size) return -1;
+    int tok = array + 1;
+    for (int i = 0; i < index; i++) tok = doc->tokens[tok].next;
+    return tok;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+ErrorCode jsonGetString(const JsonDoc *doc, int token, char *out, size_t size) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_STRING || size == 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    const char *s = doc->text + doc->tokens[token].start;
+    const char *end = doc->text + doc->tokens[token].end;
+    size_t n = 0;
+    while (s < end) {
+        unsigned cp = (unsigned char)*s++;
+        if (cp == '\\') {
+            char e = *s++;
+            switch (e) {
+                case 'b': cp = '\b'; break;
+                case 'f': cp = '\f'; break;
+                case 'n': cp = '\n'; break;
+                case 'r': cp = '\r'; break;
+                case 't': cp = '\t'; break;
+                case 'u':
+                    cp = 0;
+                    for (int i = 0; i < 4; i++) {
+                        int h = hexValue(*s++);
+                        if (h < 0) return ERROR_INVALID_INPUT;
+                        cp = (cp << 4) | (unsigned)h;
+                    }
+                    break;
+                default: cp = (unsigned char)e; break;
+            }
+            // Encode BMP code points as UTF-8 (surrogate pairs are not needed here)
+            if (cp >= 0x80) {
+                char utf[3];
+                size_t len;
+                if (cp < 0x800) {
+                    utf[0] = (char)(0xC0 | (cp >> 6)); utf[1] = (char)(0x80 | (cp & 0x3F)); len = 2;
+                } else {
+                    utf[0] = (char)(0xE0 | (cp >> 12)); utf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    utf[2] = (char)(0x80 | (cp & 0x3F)); len = 3;
+                }
+                if (n + len >= size) return ERROR_INVALID_INPUT;
+                memcpy(out + n, utf, len);
+                n += len;
+                continue;
+            }
+        }
+        if (n + 1 >= size) return ERROR_INVALID_INPUT;
+        out[n++] = (char)cp;
+    }
+    out[n] = '\0';
+    return SUCCESS;
+}
+
+ErrorCode jsonGetInt(const JsonDoc *doc, int token, int *out) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_NUMBER) return ERROR_INVALID_INPUT;
+    char buf[32];
+    int len = doc->tokens[token].end - doc->tokens[token].start;
+    if (len <= 0 || len >= (int)sizeof(buf)) return ERROR_INVALID_INPUT;
+    memcpy(buf, doc->text + doc->tokens[token].start, (size_t)len);
+    buf[len] = '\0';
+    char *endp;
+    long value = strtol(buf, &endp, 10);
+    if (*endp != '\0' || value < INT_MIN || value > INT_MAX) return ERROR_INVALID_INPUT;
+    *out = (int)value;
+    return SUCCESS;
+}
+
+ErrorCode jsonGetBool(const JsonDoc *doc, int token, int *out) {
+    if (token < 0 || token >= doc->count || doc->tokens[token].type != JSON_BOOL) return ERROR_INVALID_INPUT;
+    *out = doc->text[doc->tokens[token].start] == 't';
+    return SUCCESS;
+}
+
+ErrorCode jsonFindString(const JsonDoc *doc, int object, const char *key, char *out, size_t size) {
+    return jsonGetString(doc, jsonFind(doc, object, key), out, size);
+}
+
+ErrorCode jsonFindInt(const JsonDoc *doc, int object, const char *key, int *out) {
+    return jsonGetInt(doc, jsonFind(doc, object, key), out);
+}
+
+// ---- Writer ----
+
+void jwInit(JsonWriter *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void jwReset(JsonWriter *w) {
+    free(w->attachment);
+    w->attachment = NULL;
+    w->attachmentLength = 0;
+    w->length = 0;
+    w->depth = 0;
+    w->afterKey = 0;
+    w->failed = 0;
+    memset(w->needComma, 0, sizeof(w->needComma));
+}
+
+void jwFree(JsonWriter *w) {
+    free(w->data);
+    free(w->attachment);
+    jwInit(w);
+}
+
+char *jwDetach(JsonWriter *w, size_t *length) {
+    char *data = w->data;
+    if (length) *length = w->length;
+    free(w->attachment);
+    jwInit(w);
+    return data;
+}
+
+void jwAttach(JsonWriter *w, char *data, size_t length) {
+    free(w->attachment);
+    w->attachment = data;
+    w->attachmentLength = data ? length : 0;
+}
+
+char *jwDetachAttachment(JsonWriter *w, size_t *length) {
+    char *data = w->attachment;
+    if (length) *length = w->attachmentLength;
+    w->attachment = NULL;
+    w->attachmentLength = 0;
+    return data;
+}
+
+static int reserve(JsonWriter *w, size_t extra) {
+    if (w->failed) return 0;
+    if (w->length + extra <= w->capacity) return 1;
+    size_t cap = w->capacity ? w->capacity : 256;
+    while (cap < w->length + extra) cap *= 2;
+    char *grown = realloc(w->data, cap);
+    if (!grown) {
+        w->failed = 1;
+        return 0;
+    }
+    w->data = grown;
+    w->capacity = cap;
+    return 1;
+}
+
+void jwRaw(JsonWriter *w, const char *bytes, size_t length) {
+    if (!reserve(w, length)) return;
+    memcpy(w->data + w->length, bytes, length);
+    w->length += length;
+}
+
+static void putChar(JsonWriter *w, char c) {
+    if (!reserve(w, 1)) return;
+    w->data[w->length++] = c;
+}
+
+// Separator before a value: none after a key, ',' between siblings
+static void beforeValue(JsonWriter *w) {
+    if (w->afterKey) {
+        w->afterKey = 0;
+        return;
+    }
+    if (w->needComma[w->depth]) putChar(w, ',');
+    w->needComma[w->depth] = 1;
+}
+
+static void openContainer(JsonWriter *w, char c) {
+    beforeValue(w);
+    putChar(w, c);
+    if (w->depth < JSON_MAX_DEPTH) w->depth++;
+    w->needComma[w->depth] = 0;
+}
+
+static void closeContainer(JsonWriter *w, char c) {
+    if (w->depth > 0) w->depth--;
+    putChar(w, c);
+}
+
+void jwBeginObject(JsonWriter *w) { openContainer(w, '{'); }
+void jwEndObject(JsonWriter *w)   { closeContainer(w, '}'); }
+void jwBeginArray(JsonWriter *w)  { openContainer(w, '['); }
+void jwEndArray(JsonWriter *w)    { closeContainer(w, ']'); }
+
+static void writeEscaped(JsonWriter *w, const char *s, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    putChar(w, '"');
+    size_t run = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        jwRaw(w, s + run, i - run);
+        run = i + 1;
+        char esc[6] = { '\\', 0 };
+        size_t len = 2;
+        switch (c) {
+            case '"':  esc[1] = '"'; break;
+            case '\\': esc[1] = '\\'; break;
+            case '\n': esc[1] = 'n'; break;
+            case '\r': esc[1] = 'r'; break;
+            case '\t': esc[1] = 't'; break;
+            default:
+                esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+                esc[4] = hex[c >> 4]; esc[5] = hex[c & 15];
+                len = 6;
+                break;
+        }
+        jwRaw(w, esc, len);
+    }
+    jwRaw(w, s + run, length - run);
+    putChar(w, '"');
+}
+
+void jwKey(JsonWriter *w, const char *key) {
+    beforeValue(w);
+    writeEscaped(w, key, strlen(key));
+    putChar(w, ':');
+    w->afterKey = 1;
+}
+
+void jwStringN(JsonWriter *w, const char *value, size_t length) {
+    beforeValue(w);
+    writeEscaped(w, value, length);
+}
+
+void jwString(JsonWriter *w, const char *value) {
+    if (!value) {
+        jwNull(w);
+        return;
+    }
+    jwStringN(w, value, strlen(value));
+}
+
+void jwInt(JsonWriter *w, long long value) {
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%lld", value);
+    beforeValue(w);
+    jwRaw(w, buf, (size_t)len);
+}
+
+void jwDouble(JsonWriter *w, double value, int decimals) {
+    char buf[48];
+    int len = snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    beforeValue(w);
+    jwRaw(w, buf, (size_t)len);
+}
+
+void jwRawValue(JsonWriter *w, const char *json, size_t length) {
+    beforeValue(w);
+    jwRaw(w, json, length);
+}
+
+void jwBool(JsonWriter *w, int value) {
+    beforeValue(w);
+    if (value) jwRaw(w, "true", 4);
+    else jwRaw(w, "false", 5);
+}
+
+void jwNull(JsonWriter *w) {
+    beforeValue(w);
+    jwRaw(w, "null", 4);
+}
+
+void jwKeyString(JsonWriter *w, const char *key, const char *value) {
+    jwKey(w, key);
+    jwString(w, value);
+}
+
+void jwKeyInt(JsonWriter *w, const char *key, long long value) {
+    jwKey(w, key);
+    jwInt(w, value);
+}
+
+void jwKeyBool(JsonWriter *w, const char *key, int value) {
+    jwKey(w, key);
+    jwBool(w, value);
+}
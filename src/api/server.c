@@ -0,0 +1,939 @@
+#define _GNU_SOURCE     // accept4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../../include/api/server.h"
+#include "../../include/api/ui.h"
+#include "../../include/api/http.h"
+#include "../../include/campus_security.h"
+#include "../../include/signin_flow.h"
+#include "../../include/shared_state.h"
+
+#define SERVER_DEFAULT_PORT         8470
+#define SERVER_DEFAULT_WORKERS      4
+#define SERVER_DEFAULT_CONNECTIONS  1024
+#define SERVER_DEFAULT_INFLIGHT     64
+#define SERVER_DEFAULT_REQUEST      (64u * 1024u)
+#define SERVER_EPOLL_BATCH          256
+#define SERVER_READ_CHUNK           16384
+#define SERVER_EXIT_STARTUP         3       // worker process could not start; do not respawn
+#define SERVER_RESPAWN_MILLIS       200
+#define SERVER_ADMIT_POLL_MILLIS    10      // recheck queue deadlines while every class is at its limit
+#define SERVER_IOV_MAX              64      // buffers per sendmsg() when flushing a connection
+
+ServerConfig serverDefaultConfig(void) {
+    ServerConfig config;
+    memset(&config, 0, sizeof(config));
+    config.unixPath = NULL;
+    config.host = "127.0.0.1";
+    config.port = SERVER_DEFAULT_PORT;
+    config.workers = SERVER_DEFAULT_WORKERS;
+    config.maxConnections = SERVER_DEFAULT_CONNECTIONS;
+    config.maxInflight = SERVER_DEFAULT_INFLIGHT;
+    config.maxRequestBytes = SERVER_DEFAULT_REQUEST;
+    config.protocol = SERVER_PROTOCOL_NDJSON;
+    config.handler = NULL;
+    return config;
+}
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// A request travelling to a worker, then back as its response
+typedef struct Job {
+    struct Job *next;
+    int fd;
+    unsigned gen;           // connection generation, guards against fd reuse
+    unsigned seq;           // position in the connection's request order
+    AdmitClass cls;
+    uint64_t queuedAt;      // monotonic microseconds
+    char *data;
+    size_t length;
+    char *body;             // response attachment (a rendered report), sent after data
+    size_t bodyLength;
+} Job;
+
+typedef struct {
+    int open;
+    unsigned gen;
+    uint32_t events;        // current epoll interest
+    int peerClosed;         // read side hit EOF
+    int closing;            // protocol error: flush, then close
+    char *in;
+    size_t inLen, inCap;
+    Job *sendHead, *sendTail;   // responses in wire order, sent straight from their buffers
+    size_t outSent;             // bytes of sendHead already on the wire
+    unsigned nextSeq;       // assigned to the next parsed request
+    unsigned sendSeq;       // next response allowed onto the wire
+    int inflight;
+    Job *parked;            // completed out of order, sorted by seq
+} Conn;
+
+// Totals for serverGetStats; in shared memory under prefork so the
+// supervisor sees every worker process
+typedef struct {
+    atomic_ullong accepted, requests, responses, protocolErrors, overloaded;
+    atomic_int openConnections;
+    atomic_int readyProcesses;
+} ServerCounters;
+
+static ServerCounters localCounters;
+
+typedef struct {
+    ServerConfig config;
+    int workerProcess;      // prefork child: the supervisor owns the UNIX socket path
+    int epfd;
+    int listenFd;
+    int wakeFd;             // eventfd: completions and stop requests
+    Conn *conns;            // indexed by fd
+    int connCap;
+
+    pthread_t *workers;
+    int workerCount;
+    pthread_mutex_t jobLock;
+    pthread_cond_t jobCond;
+    Job *queueHead[ADMIT_CLASS_COUNT], *queueTail[ADMIT_CLASS_COUNT];
+    int queuedJobs;
+    AdmissionControl admission;     // guarded by jobLock
+    int shuttingDown;
+
+    pthread_mutex_t doneLock;
+    Job *doneHead, *doneTail;
+
+    atomic_int stopRequested;
+    atomic_int ready;
+    int connCount;          // this process's open connections (event loop only)
+    ServerCounters *counters;
+} Server;
+
+static Server server = {
+    .epfd = -1, .listenFd = -1, .wakeFd = -1, .counters = &localCounters,
+    .jobLock = PTHREAD_MUTEX_INITIALIZER, .jobCond = PTHREAD_COND_INITIALIZER,
+    .doneLock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// ---- Worker pool ----
+
+static uint64_t monotonicMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void writeOverloaded(const char *request, size_t length, unsigned retryAfterMillis, JsonWriter *out) {
+    if (server.config.protocol == SERVER_PROTOCOL_HTTP) {
+        httpWriteOverloaded(request, length, retryAfterMillis, out);
+    } else {
+        apiWriteOverloaded(request, length, retryAfterMillis, out);
+        jwRaw(out, "\n", 1);
+    }
+}
+
+// Next job any class will admit, cheapest class first; caller holds jobLock.
+// A job that waited past its class's queue timeout comes back with *shed set.
+static Job *takeJob(int *shed, unsigned *retryAfter) {
+    uint64_t now = monotonicMicros();
+    for (int cls = 0; cls < ADMIT_CLASS_COUNT; cls++) {
+        Job *job = server.queueHead[cls];
+        if (!job) continue;
+        AdmitDecision decision = admissionPoll(&server.admission, (AdmitClass)cls, now - job->queuedAt, now);
+        if (decision == ADMIT_WAIT) continue;
+        server.queueHead[cls] = job->next;
+        if (!server.queueHead[cls]) server.queueTail[cls] = NULL;
+        server.queuedJobs--;
+        *shed = decision == ADMIT_SHED;
+        if (*shed) *retryAfter = admissionRetryAfterMillis(&server.admission, (AdmitClass)cls);
+        return job;
+    }
+    return NULL;
+}
+
+static void *workerMain(void *arg) {
+    (void)arg;
+    JsonWriter writer;
+    jwInit(&writer);
+
+    for (;;) {
+        int shed = 0;
+        unsigned retryAfter = 0;
+        pthread_mutex_lock(&server.jobLock);
+        Job *job;
+        while (!(job = takeJob(&shed, &retryAfter)) && !server.shuttingDown) {
+            if (server.queuedJobs == 0) {
+                pthread_cond_wait(&server.jobCond, &server.jobLock);
+                continue;
+            }
+            // Work is queued but every class is at its limit: wake for a
+            // finished job or to shed whatever outstays its deadline
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += SERVER_ADMIT_POLL_MILLIS * 1000000L;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&server.jobCond, &server.jobLock, &until);
+        }
+        pthread_mutex_unlock(&server.jobLock);
+        if (!job) break;
+
+        if (shed) {
+            writeOverloaded(job->data, job->length, retryAfter, &writer);
+            atomic_fetch_add(&server.counters->overloaded, 1);
+        } else {
+            uint64_t started = monotonicMicros();
+            server.config.handler(job->data, job->length, &writer);
+            if (server.config.protocol == SERVER_PROTOCOL_NDJSON) jwRaw(&writer, "\n", 1);
+            uint64_t elapsed = monotonicMicros() - started;
+            pthread_mutex_lock(&server.jobLock);
+            admissionFinish(&server.admission, job->cls, elapsed);
+            if (server.queuedJobs > 0) pthread_cond_signal(&server.jobCond);    // a slot opened
+            pthread_mutex_unlock(&server.jobLock);
+        }
+        free(job->data);
+        job->body = jwDetachAttachment(&writer, &job->bodyLength);
+        if (writer.failed) {
+            static const char oomLine[] = "{\"ok\":false,\"error\":\"MEMORY\"}\n";
+            static const char oomHttp[] = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n";
+            const char *oom = server.config.protocol == SERVER_PROTOCOL_HTTP ? oomHttp : oomLine;
+            jwFree(&writer);
+            free(job->body);
+            job->body = NULL;
+            job->bodyLength = 0;
+            job->data = strdup(oom);
+            job->length = job->data ? strlen(oom) : 0;
+        } else {
+            job->data = jwDetach(&writer, &job->length);   // hand the buffer over, no copy
+        }
+        job->next = NULL;
+
+        pthread_mutex_lock(&server.doneLock);
+        int wasEmpty = server.doneHead == NULL;
+        if (server.doneTail) server.doneTail->next = job;
+        else server.doneHead = job;
+        server.doneTail = job;
+        pthread_mutex_unlock(&server.doneLock);
+
+        // One wakeup per batch: the loop drains the whole list
+        if (wasEmpty) {
+            uint64_t one = 1;
+            ssize_t ignored = write(server.wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+    jwFree(&writer);
+    return NULL;
+}
+
+// Returns 0 when the job's class queue is full; *retryAfter is then set
+static int submitJob(Job *job, unsigned *retryAfter) {
+    pthread_mutex_lock(&server.jobLock);
+    if (!admissionOffer(&server.admission, job->cls)) {
+        *retryAfter = admissionRetryAfterMillis(&server.admission, job->cls);
+        pthread_mutex_unlock(&server.jobLock);
+        return 0;
+    }
+    job->queuedAt = monotonicMicros();
+    if (server.queueTail[job->cls]) server.queueTail[job->cls]->next = job;
+    else server.queueHead[job->cls] = job;
+    server.queueTail[job->cls] = job;
+    server.queuedJobs++;
+    pthread_cond_signal(&server.jobCond);
+    pthread_mutex_unlock(&server.jobLock);
+    return 1;
+}
+
+static void freeJob(Job *job) {
+    free(job->data);
+    free(job->body);
+    free(job);
+}
+
+static void freeJobs(Job *job) {
+    while (job) {
+        Job *next = job->next;
+        freeJob(job);
+        job = next;
+    }
+}
+
+// ---- Connections ----
+
+// Read-side events only while we would read: after EOF, or with the pipeline
+// full, a level-triggered EPOLLRDHUP would fire on every wait
+static void updateInterest(int fd, Conn *c) {
+    uint32_t want = 0;
+    if (!c->peerClosed && !c->closing && c->inflight < server.config.maxInflight) want |= EPOLLIN | EPOLLRDHUP;
+    if (c->sendHead) want |= EPOLLOUT;
+    if (want == c->events) return;
+    struct epoll_event ev = { .events = want, .data.fd = fd };
+    epoll_ctl(server.epfd, EPOLL_CTL_MOD, fd, &ev);
+    c->events = want;
+}
+
+static void closeConn(int fd) {
+    Conn *c = &server.conns[fd];
+    if (!c->open) return;
+    epoll_ctl(server.epfd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+    free(c->in);
+    freeJobs(c->sendHead);
+    freeJobs(c->parked);
+    unsigned gen = c->gen;
+    memset(c, 0, sizeof(*c));
+    c->gen = gen + 1;   // in-flight responses for the old connection are dropped
+    server.connCount--;
+    atomic_fetch_sub(&server.counters->openConnections, 1);
+}
+
+static int reserveBuffer(char **buf, size_t *cap, size_t needed) {
+    if (needed <= *cap) return 1;
+    size_t grown = *cap ? *cap : SERVER_READ_CHUNK;
+    while (grown < needed) grown *= 2;
+    char *p = realloc(*buf, grown);
+    if (!p) return 0;
+    *buf = p;
+    *cap = grown;
+    return 1;
+}
+
+// Adds [data + *skip, data + length) to the vector; *skip counts bytes already sent
+static void addSegment(struct iovec *iov, int *count, char *data, size_t length, size_t *skip) {
+    if (*skip >= length) {
+        *skip -= length;
+        return;
+    }
+    iov[*count].iov_base = data + *skip;
+    iov[*count].iov_len = length - *skip;
+    (*count)++;
+    *skip = 0;
+}
+
+// Drops the responses the last send completed
+static void releaseSent(Conn *c) {
+    while (c->sendHead && c->outSent >= c->sendHead->length + c->sendHead->bodyLength) {
+        Job *done = c->sendHead;
+        c->outSent -= done->length + done->bodyLength;
+        c->sendHead = done->next;
+        freeJob(done);
+    }
+    if (!c->sendHead) c->sendTail = NULL;
+}
+
+// Gathers queued responses, heads and attachments alike, into one
+// sendmsg() so nothing is copied into a connection buffer first.
+// Returns 0 when the connection was closed.
+static int flushConn(int fd) {
+    Conn *c = &server.conns[fd];
+    releaseSent(c);     // zero-length responses
+    while (c->sendHead) {
+        struct iovec iov[SERVER_IOV_MAX];
+        int count = 0;
+        size_t skip = c->outSent;
+        for (Job *job = c->sendHead; job && count < SERVER_IOV_MAX - 1; job = job->next) {
+            addSegment(iov, &count, job->data, job->length, &skip);
+            addSegment(iov, &count, job->body, job->bodyLength, &skip);
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)count;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            c->outSent += (size_t)n;
+            releaseSent(c);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            closeConn(fd);
+            return 0;
+        }
+    }
+    if ((c->peerClosed || c->closing) && c->inflight == 0 && !c->sendHead) {
+        closeConn(fd);
+        return 0;
+    }
+    updateInterest(fd, c);
+    return 1;
+}
+
+// Park a finished response and release every response that is now in order
+static void deliver(Conn *c, Job *job) {
+    Job **slot = &c->parked;
+    while (*slot && (*slot)->seq < job->seq) slot = &(*slot)->next;
+    job->next = *slot;
+    *slot = job;
+
+    while (c->parked && c->parked->seq == c->sendSeq) {
+        Job *ready = c->parked;
+        c->parked = ready->next;
+        ready->next = NULL;
+        if (c->sendTail) c->sendTail->next = ready;
+        else c->sendHead = ready;
+        c->sendTail = ready;
+        c->sendSeq++;
+        c->inflight--;
+        atomic_fetch_add(&server.counters->responses, 1);
+    }
+}
+
+// Queue a response written by the loop itself, in sequence with the workers' ones
+static void answerFromLoop(Conn *c, int fd, JsonWriter *w) {
+    Job *job = calloc(1, sizeof(Job));
+    if (!job || w->failed) {
+        free(job);
+        jwFree(w);
+        c->closing = 1;
+        return;
+    }
+    job->fd = fd;
+    job->gen = c->gen;
+    job->seq = c->nextSeq++;
+    job->data = jwDetach(w, &job->length);
+    c->inflight++;
+    deliver(c, job);
+}
+
+// Answer a malformed frame from the loop itself, in sequence, then close
+static void rejectFrame(Conn *c, int fd, int httpStatus, const char *message) {
+    JsonWriter w;
+    jwInit(&w);
+    if (server.config.protocol == SERVER_PROTOCOL_HTTP) {
+        httpWriteError(&w, httpStatus, message);
+    } else {
+        jwBeginObject(&w);
+        jwKeyBool(&w, "ok", 0);
+        jwKeyString(&w, "error", "INVALID_INPUT");
+        jwKeyString(&w, "message", message);
+        jwEndObject(&w);
+        jwRaw(&w, "\n", 1);
+    }
+    atomic_fetch_add(&server.counters->protocolErrors, 1);
+    c->closing = 1;
+    answerFromLoop(c, fd, &w);
+}
+
+typedef enum { FRAME_NEED_MORE, FRAME_READY, FRAME_SKIP, FRAME_REJECTED } FrameStatus;
+
+// Finds the next request frame at `buf`. `consumed` covers everything the
+// frame occupies; [offset, offset + length) is what the handler sees.
+static FrameStatus nextFrame(Conn *c, int fd, const char *buf, size_t avail,
+                             size_t *consumed, size_t *offset, size_t *length) {
+    size_t max = server.config.maxRequestBytes;
+    *offset = 0;
+
+    if (server.config.protocol == SERVER_PROTOCOL_HTTP) {
+        HttpRequest req;
+        switch (httpParseRequest(buf, avail, max, &req)) {
+            case HTTP_PARSE_OK:
+                *consumed = *length = req.headerBytes + req.contentLength;
+                if (!req.keepAlive) c->closing = 1;     // answer this one, read nothing further
+                return FRAME_READY;
+            case HTTP_PARSE_INCOMPLETE:
+                return FRAME_NEED_MORE;
+            case HTTP_PARSE_TOO_LARGE:
+                if (req.contentLength > 0) rejectFrame(c, fd, 413, "request body too large");
+                else rejectFrame(c, fd, 431, "request head too large");
+                return FRAME_REJECTED;
+            case HTTP_PARSE_UNSUPPORTED:
+                rejectFrame(c, fd, 501, "transfer-encoding not supported, send Content-Length");
+                return FRAME_REJECTED;
+            default:
+                rejectFrame(c, fd, 400, "malformed request");
+                return FRAME_REJECTED;
+        }
+    }
+
+    const char *nl = memchr(buf, '\n', avail);
+    if (!nl) {
+        if (avail <= max) return FRAME_NEED_MORE;
+        rejectFrame(c, fd, 413, "request too large");
+        return FRAME_REJECTED;
+    }
+    *consumed = (size_t)(nl - buf) + 1;
+    *length = (size_t)(nl - buf);
+    if (*length > 0 && buf[*length - 1] == '\r') (*length)--;
+    if (*length > max) {        // the whole line arrived in one read
+        rejectFrame(c, fd, 413, "request too large");
+        return FRAME_REJECTED;
+    }
+    return *length == 0 ? FRAME_SKIP : FRAME_READY;
+}
+
+// Hand complete frames to the workers, up to the per-connection in-flight cap
+static void dispatchFrames(int fd) {
+    Conn *c = &server.conns[fd];
+    size_t consumed = 0;
+    while (c->inflight < server.config.maxInflight && !c->closing) {
+        size_t used, offset, length;
+        FrameStatus status = nextFrame(c, fd, c->in + consumed, c->inLen - consumed, &used, &offset, &length);
+        if (status == FRAME_NEED_MORE || status == FRAME_REJECTED) break;
+        const char *start = c->in + consumed + offset;
+        consumed += used;
+        if (status == FRAME_SKIP) continue;
+
+        Job *job = malloc(sizeof(Job));
+        char *copy = malloc(length);
+        if (!job || !copy) {
+            free(job);
+            free(copy);
+            c->closing = 1;
+            break;
+        }
+        memcpy(copy, start, length);
+        atomic_fetch_add(&server.counters->requests, 1);
+        job->next = NULL;
+        job->fd = fd;
+        job->gen = c->gen;
+        job->data = copy;
+        job->length = length;
+        job->body = NULL;
+        job->bodyLength = 0;
+        job->cls = server.config.protocol == SERVER_PROTOCOL_HTTP ? httpRequestClass(copy, length)
+                                                                  : apiRequestClass(copy, length);
+        unsigned retryAfter = 0;
+        job->seq = c->nextSeq++;
+        c->inflight++;
+        if (submitJob(job, &retryAfter)) continue;
+
+        // Class queue full: refuse now, in order, and keep the connection
+        c->nextSeq--;
+        c->inflight--;
+        JsonWriter w;
+        jwInit(&w);
+        writeOverloaded(copy, length, retryAfter, &w);
+        free(copy);
+        free(job);
+        atomic_fetch_add(&server.counters->overloaded, 1);
+        answerFromLoop(c, fd, &w);
+    }
+    if (consumed > 0) {
+        memmove(c->in, c->in + consumed, c->inLen - consumed);
+        c->inLen -= consumed;
+    }
+}
+
+static void handleReadable(int fd) {
+    Conn *c = &server.conns[fd];
+    while (!c->peerClosed && c->inflight < server.config.maxInflight) {
+        if (!reserveBuffer(&c->in, &c->inCap, c->inLen + SERVER_READ_CHUNK)) {
+            closeConn(fd);
+            return;
+        }
+        ssize_t n = recv(fd, c->in + c->inLen, c->inCap - c->inLen, 0);
+        if (n > 0) {
+            c->inLen += (size_t)n;
+            dispatchFrames(fd);
+            if (c->closing) break;
+        } else if (n == 0) {
+            c->peerClosed = 1;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            closeConn(fd);
+            return;
+        }
+    }
+    flushConn(fd);
+}
+
+static void acceptConnections(void) {
+    for (;;) {
+        int fd = accept4(server.listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;     // EAGAIN, or out of descriptors until the next event
+        }
+        if (fd >= server.connCap || server.connCount >= server.config.maxConnections) {
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // harmless failure on UNIX sockets
+
+        Conn *c = &server.conns[fd];
+        unsigned gen = c->gen;
+        memset(c, 0, sizeof(*c));
+        c->gen = gen + 1;
+        c->open = 1;
+        c->events = EPOLLIN | EPOLLRDHUP;
+        struct epoll_event ev = { .events = c->events, .data.fd = fd };
+        if (epoll_ctl(server.epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            c->open = 0;
+            close(fd);
+            continue;
+        }
+        server.connCount++;
+        atomic_fetch_add(&server.counters->accepted, 1);
+        atomic_fetch_add(&server.counters->openConnections, 1);
+    }
+}
+
+static void drainCompletions(void) {
+    uint64_t counter;
+    ssize_t ignored = read(server.wakeFd, &counter, sizeof(counter));
+    (void)ignored;
+
+    pthread_mutex_lock(&server.doneLock);
+    Job *job = server.doneHead;
+    server.doneHead = server.doneTail = NULL;
+    pthread_mutex_unlock(&server.doneLock);
+
+    // Deliver everything first, then flush each touched connection once
+    int touched[SERVER_EPOLL_BATCH];
+    int touchedCount = 0;
+    while (job) {
+        Job *next = job->next;
+        int fd = job->fd;
+        Conn *c = &server.conns[fd];
+        if (!c->open || c->gen != job->gen) {
+            freeJob(job);
+        } else {
+            int resumeReads = c->inflight == server.config.maxInflight;
+            deliver(c, job);    // job now belongs to the connection
+            if (resumeReads) dispatchFrames(fd);
+            int seen = 0;
+            for (int i = 0; i < touchedCount && !seen; i++) seen = touched[i] == fd;
+            if (!seen) {
+                if (touchedCount == SERVER_EPOLL_BATCH) {
+                    flushConn(touched[--touchedCount]);
+                }
+                touched[touchedCount++] = fd;
+            }
+        }
+        job = next;
+    }
+    for (int i = 0; i < touchedCount; i++) {
+        if (server.conns[touched[i]].open) flushConn(touched[i]);
+    }
+}
+
+// ---- Listening socket ----
+
+// reusePort: prefork workers each bind the same TCP port and the kernel spreads connections
+static int openListener(const ServerConfig *config, int reusePort) {
+    int fd;
+    if (config->unixPath) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (strlen(config->unixPath) >= sizeof(addr.sun_path)) return -1;
+        strcpy(addr.sun_path, config->unixPath);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        unlink(config->unixPath);
+        if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        char port[16];
+        struct addrinfo hints, *res = NULL;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        snprintf(port, sizeof(port), "%d", config->port);
+        if (getaddrinfo(config->host, port, &hints, &res) != 0) return -1;
+        fd = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+        if (fd >= 0) {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (reusePort) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+            if (bind(fd, res->ai_addr, res->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(res);
+        if (fd < 0) return -1;
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void shutdownServer(void) {
+    pthread_mutex_lock(&server.jobLock);
+    server.shuttingDown = 1;
+    pthread_cond_broadcast(&server.jobCond);
+    pthread_mutex_unlock(&server.jobLock);
+    for (int i = 0; i < server.workerCount; i++) pthread_join(server.workers[i], NULL);
+    free(server.workers);
+    server.workers = NULL;
+    server.workerCount = 0;
+
+    for (int cls = 0; cls < ADMIT_CLASS_COUNT; cls++) {
+        freeJobs(server.queueHead[cls]);
+        server.queueHead[cls] = server.queueTail[cls] = NULL;
+    }
+    server.queuedJobs = 0;
+    freeJobs(server.doneHead);
+    server.doneHead = server.doneTail = NULL;
+
+    for (int fd = 0; fd < server.connCap; fd++) closeConn(fd);
+    free(server.conns);
+    server.conns = NULL;
+
+    if (server.listenFd >= 0) close(server.listenFd);
+    if (server.config.unixPath && !server.workerProcess) unlink(server.config.unixPath);
+    if (server.wakeFd >= 0) close(server.wakeFd);
+    if (server.epfd >= 0) close(server.epfd);
+    server.listenFd = server.wakeFd = server.epfd = -1;
+    server.shuttingDown = 0;
+    if (atomic_exchange(&server.ready, 0)) atomic_fetch_sub(&server.counters->readyProcesses, 1);
+}
+
+// listenFd >= 0: a listener inherited from the prefork supervisor
+static ErrorCode runEventLoop(int listenFd) {
+    server.connCount = 0;
+
+    // Connection table is indexed by fd; leave headroom for the process's other descriptors
+    server.connCap = server.config.maxConnections + 64;
+    server.conns = calloc((size_t)server.connCap, sizeof(Conn));
+    server.epfd = epoll_create1(EPOLL_CLOEXEC);
+    server.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    server.listenFd = listenFd >= 0 ? listenFd : openListener(&server.config, server.workerProcess);
+    if (!server.conns || server.epfd < 0 || server.wakeFd < 0 || server.listenFd < 0) {
+        fprintf(stderr, "server: cannot listen on %s: %s\n",
+                server.config.unixPath ? server.config.unixPath : server.config.host, strerror(errno));
+        shutdownServer();
+        return ERROR_NETWORK;
+    }
+
+    // A shared listener wakes one worker process per connection, not all of them
+    struct epoll_event ev = { .events = EPOLLIN | (listenFd >= 0 ? EPOLLEXCLUSIVE : 0), .data.fd = server.listenFd };
+    epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.listenFd, &ev);
+    ev.events = EPOLLIN;
+    ev.data.fd = server.wakeFd;
+    epoll_ctl(server.epfd, EPOLL_CTL_ADD, server.wakeFd, &ev);
+
+    server.workers = calloc((size_t)server.config.workers, sizeof(pthread_t));
+    for (int i = 0; server.workers && i < server.config.workers; i++) {
+        if (pthread_create(&server.workers[i], NULL, workerMain, NULL) != 0) break;
+        server.workerCount++;
+    }
+    if (server.workerCount == 0) {
+        shutdownServer();
+        return ERROR_GENERAL;
+    }
+    atomic_store(&server.ready, 1);
+    atomic_fetch_add(&server.counters->readyProcesses, 1);
+
+    struct epoll_event events[SERVER_EPOLL_BATCH];
+    while (!atomic_load(&server.stopRequested)) {
+        int n = epoll_wait(server.epfd, events, SERVER_EPOLL_BATCH, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint32_t what = events[i].events;
+            if (fd == server.listenFd) {
+                acceptConnections();
+            } else if (fd == server.wakeFd) {
+                drainCompletions();
+            } else if (server.conns[fd].open) {
+                if (what & (EPOLLERR | EPOLLHUP)) {
+                    closeConn(fd);
+                    continue;
+                }
+                if (what & (EPOLLIN | EPOLLRDHUP)) {
+                    handleReadable(fd);
+                } else if (what & EPOLLOUT) {
+                    flushConn(fd);
+                }
+            }
+        }
+    }
+
+    shutdownServer();
+    return SUCCESS;
+}
+
+// ---- Prefork supervisor ----
+
+static void onWorkerSignal(int sig) {
+    (void)sig;
+    serverStop();
+}
+
+static pid_t spawnWorkerProcess(int index, int listenFd) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    // Worker process: its own event loop, thread pool and database connection.
+    // The supervisor decides when workers stop, so only its SIGTERM counts.
+    server.workerProcess = 1;
+    signal(SIGINT, SIG_IGN);
+    signal(SIGTERM, onWorkerSignal);
+    ErrorCode rc = server.config.processStart ? server.config.processStart(index) : SUCCESS;
+    if (rc == SUCCESS) rc = runEventLoop(listenFd);
+    if (server.config.processStop) server.config.processStop();
+    _exit(rc == SUCCESS ? 0 : SERVER_EXIT_STARTUP);
+}
+
+static ErrorCode runSupervisor(void) {
+    int count = server.config.processes;
+    // Everything workers share must be mapped before the first fork
+    ServerCounters *counters = (ServerCounters*)sharedAlloc(sizeof(ServerCounters));
+    if (!counters || !sessionStoreInit() || !signinTableInit()) return ERROR_MEMORY;
+    server.counters = counters;
+
+    int listenFd = -1;
+    if (server.config.unixPath) {
+        listenFd = openListener(&server.config, 0);
+        if (listenFd < 0) {
+            fprintf(stderr, "server: cannot listen on %s: %s\n", server.config.unixPath, strerror(errno));
+            server.counters = &localCounters;
+            return ERROR_NETWORK;
+        }
+    }
+
+    pid_t *pids = (pid_t*)calloc((size_t)count, sizeof(pid_t));
+    ErrorCode result = pids ? SUCCESS : ERROR_MEMORY;
+    for (int i = 0; pids && i < count; i++) {
+        pids[i] = spawnWorkerProcess(i, listenFd);
+        if (pids[i] < 0) result = ERROR_GENERAL;
+    }
+
+    struct timespec pause = { 0, 20 * 1000000L };
+    while (result == SUCCESS && !atomic_load(&server.stopRequested)) {
+        if (atomic_load(&counters->readyProcesses) >= count) atomic_store(&server.ready, 1);
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid <= 0) {
+            nanosleep(&pause, NULL);    // a stop signal cuts the sleep short
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            if (pids[i] != pid) continue;
+            pids[i] = 0;
+            if (WIFEXITED(status) && WEXITSTATUS(status) == SERVER_EXIT_STARTUP) {
+                result = ERROR_NETWORK;
+                break;
+            }
+            if (atomic_load(&server.stopRequested)) break;
+            fprintf(stderr, "server: worker %d (pid %d) exited, restarting\n", i, (int)pid);
+            struct timespec backoff = { 0, SERVER_RESPAWN_MILLIS * 1000000L };
+            nanosleep(&backoff, NULL);
+            pids[i] = spawnWorkerProcess(i, listenFd);
+            if (pids[i] < 0) pids[i] = 0;
+        }
+    }
+
+    for (int i = 0; pids && i < count; i++) {
+        if (pids[i] > 0) kill(pids[i], SIGTERM);
+    }
+    for (int i = 0; pids && i < count; i++) {
+        if (pids[i] > 0) waitpid(pids[i], NULL, 0);
+    }
+    free(pids);
+    if (listenFd >= 0) close(listenFd);
+    if (server.config.unixPath) unlink(server.config.unixPath);
+    atomic_store(&server.ready, 0);
+    return result;
+}
+
+ErrorCode serverRun(const ServerConfig *config) {
+    server.config = config ? *config : serverDefaultConfig();
+    if (!server.config.handler) {
+        server.config.handler = server.config.protocol == SERVER_PROTOCOL_HTTP ? httpHandleRequest : apiHandleRequest;
+    }
+    if (server.config.workers < 1) server.config.workers = 1;
+    if (server.config.maxInflight < 1) server.config.maxInflight = 1;
+    if (server.config.maxConnections < 1) server.config.maxConnections = SERVER_DEFAULT_CONNECTIONS;
+    if (server.config.maxRequestBytes == 0) server.config.maxRequestBytes = SERVER_DEFAULT_REQUEST;
+    AdmitClassConfig admission[ADMIT_CLASS_COUNT];
+    for (int cls = 0; cls < ADMIT_CLASS_COUNT; cls++) {
+        admission[cls] = server.config.admission ? server.config.admission[cls]
+                                                 : admissionDefaultConfig((AdmitClass)cls, server.config.workers);
+    }
+    admissionInit(&server.admission, admission);
+    server.config.admission = NULL;     // copied; the caller's array need not outlive serverRun
+
+    atomic_store(&server.stopRequested, 0);
+    server.counters = &localCounters;
+    atomic_store(&localCounters.accepted, 0);
+    atomic_store(&localCounters.requests, 0);
+    atomic_store(&localCounters.responses, 0);
+    atomic_store(&localCounters.protocolErrors, 0);
+    atomic_store(&localCounters.overloaded, 0);
+    atomic_store(&localCounters.openConnections, 0);
+    atomic_store(&localCounters.readyProcesses, 0);
+
+    if (server.config.processes > 1) return runSupervisor();
+    return runEventLoop(-1);
+}
+
+void serverStop(void) {
+    atomic_store(&server.stopRequested, 1);
+    if (server.wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(server.wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+int serverWaitReady(int timeoutMillis) {
+    struct timespec pause = { 0, 1000000L };
+    for (int waited = 0; waited <= timeoutMillis; waited++) {
+        if (atomic_load(&server.ready)) return 1;
+        nanosleep(&pause, NULL);
+    }
+    return atomic_load(&server.ready);
+}
+
+void serverGetStats(ServerStats *stats) {
+    stats->accepted = atomic_load(&server.counters->accepted);
+    stats->requests = atomic_load(&server.counters->requests);
+    stats->responses = atomic_load(&server.counters->responses);
+    stats->protocolErrors = atomic_load(&server.counters->protocolErrors);
+    stats->overloaded = atomic_load(&server.counters->overloaded);
+    stats->openConnections = atomic_load(&server.counters->openConnections);
+}
+
+#else // !__linux__
+
+ErrorCode serverRun(const ServerConfig *config) {
+    (void)config;
+    fprintf(stderr, "server mode requires Linux (epoll)\n");
+    return ERROR_GENERAL;
+}
+
+void serverStop(void) {}
+
+int serverWaitReady(int timeoutMillis) {
+    (void)timeoutMillis;
+    return 0;
+}
+
+void serverGetStats(ServerStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // __linux__
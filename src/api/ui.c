@@ -0,0 +1,599 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "../../include/api/ui.h"
+#include "../../include/auth.h"
+#include "../../include/utils.h"
+#include "../../include/student.h"
+#include "../../include/database.h"
+#include "../../include/grade_kernel.h"
+#include "../../include/rank_engine.h"
+#include "../../include/grading_scheme.h"
+#include "../../include/campus_security.h"
+#include "../../include/signin_flow.h"
+
+typedef struct {
+    const JsonDoc *doc;
+    int root;
+    Session session;        // valid when the op requires one
+    JsonWriter *out;
+    const char *message;    // optional detail for error responses
+} ApiContext;
+
+typedef ErrorCode (*ApiHandler)(ApiContext *ctx);
+
+typedef struct {
+    const char *name;
+    ApiHandler handler;
+    int needsSession;
+    AdmitClass admitClass;
+} ApiOperation;
+
+const char *apiErrorName(ErrorCode code) {
+    switch (code) {
+        case SUCCESS: return "OK";
+        case ERROR_GENERAL: return "GENERAL";
+        case ERROR_AUTH_FAILED: return "AUTH_FAILED";
+        case ERROR_DATABASE: return "DATABASE";
+        case ERROR_FILE_IO: return "FILE_IO";
+        case ERROR_INVALID_INPUT: return "INVALID_INPUT";
+        case ERROR_MEMORY: return "MEMORY";
+        case ERROR_NETWORK: return "NETWORK";
+        case ERROR_PERMISSION: return "PERMISSION";
+        case ERROR_NOT_FOUND: return "NOT_FOUND";
+        case ERROR_ALREADY_EXISTS: return "ALREADY_EXISTS";
+        case ERROR_OVERLOADED: return "OVERLOADED";
+        default: return "UNKNOWN";
+    }
+}
+
+static ErrorCode fail(ApiContext *ctx, ErrorCode code, const char *message) {
+    ctx->message = message;
+    return code;
+}
+
+static CampusType parseCampus(const JsonDoc *doc, int token) {
+    int value = 0;
+    if (jsonGetInt(doc, token, &value) == SUCCESS) {
+        return (value >= CAMPUS_SCHOOL && value <= CAMPUS_HOSTEL) ? (CampusType)value : CAMPUS_NONE;
+    }
+    char name[16];
+    if (jsonGetString(doc, token, name, sizeof(name)) != SUCCESS) return CAMPUS_NONE;
+    for (int type = CAMPUS_SCHOOL; type <= CAMPUS_HOSTEL; type++) {
+        if (strcasecmp(name, getCampusName((CampusType)type)) == 0) return (CampusType)type;
+    }
+    return CAMPUS_NONE;
+}
+
+// Reads an int array of exactly `count` items
+static ErrorCode readIntArray(const JsonDoc *doc, int array, int *out, int count) {
+    if (array < 0 || doc->tokens[array].type != JSON_ARRAY || doc->tokens[array].size != count) {
+        return ERROR_INVALID_INPUT;
+    }
+    int tok = array + 1;
+    for (int i = 0; i < count; i++) {
+        if (jsonGetInt(doc, tok, &out[i]) != SUCCESS) return ERROR_INVALID_INPUT;
+        tok = doc->tokens[tok].next;
+    }
+    return SUCCESS;
+}
+
+static void writeProfile(JsonWriter *w, const Profile *p) {
+    jwKey(w, "profile");
+    jwBeginObject(w);
+    jwKeyString(w, "userID", p->userID);
+    jwKeyString(w, "name", p->name);
+    jwKeyString(w, "campus", getCampusName(p->campusType));
+    jwKeyString(w, "institute", p->instituteName);
+    jwKeyString(w, "department", p->department);
+    jwKeyString(w, "email", p->email);
+    jwKeyString(w, "mobile", p->mobile);
+    jwKey(w, "fields");
+    jwBeginArray(w);
+    for (int i = 0; i < p->dataCount && i < MAX_SUBJECTS; i++) jwString(w, p->dataFields[i]);
+    jwEndArray(w);
+    jwEndObject(w);
+}
+
+// ---- Operations ----
+
+static ErrorCode opPing(ApiContext *ctx) {
+    jwKeyBool(ctx->out, "pong", 1);
+    return SUCCESS;
+}
+
+static ErrorCode opSignup(ApiContext *ctx) {
+    const JsonDoc *doc = ctx->doc;
+    Profile p;
+    char password[MAX_LEN];
+    memset(&p, 0, sizeof(p));
+
+    if (jsonFindString(doc, ctx->root, "name", p.name, sizeof(p.name)) != SUCCESS ||
+        jsonFindString(doc, ctx->root, "institute", p.instituteName, sizeof(p.instituteName)) != SUCCESS ||
+        jsonFindString(doc, ctx->root, "department", p.department, sizeof(p.department)) != SUCCESS ||
+        jsonFindString(doc, ctx->root, "email", p.email, sizeof(p.email)) != SUCCESS ||
+        jsonFindString(doc, ctx->root, "mobile", p.mobile, sizeof(p.mobile)) != SUCCESS ||
+        jsonFindString(doc, ctx->root, "password", password, sizeof(password)) != SUCCESS) {
+        return fail(ctx, ERROR_INVALID_INPUT, "name, institute, department, email, mobile and password are required");
+    }
+    p.campusType = parseCampus(doc, jsonFind(doc, ctx->root, "campus"));
+    if (p.campusType == CAMPUS_NONE) return fail(ctx, ERROR_INVALID_INPUT, "campus must be school, college, hospital or hostel");
+
+    if (p.campusType == CAMPUS_SCHOOL || p.campusType == CAMPUS_COLLEGE) {
+        int fields = jsonFind(doc, ctx->root, "fields");
+        if (fields < 0 || doc->tokens[fields].type != JSON_ARRAY ||
+            doc->tokens[fields].size < 1 || doc->tokens[fields].size > MAX_SUBJECTS) {
+            return fail(ctx, ERROR_INVALID_INPUT, "fields must list 1-10 subjects");
+        }
+        p.dataCount = doc->tokens[fields].size;
+        for (int i = 0; i < p.dataCount; i++) {
+            if (jsonGetString(doc, jsonArrayItem(doc, fields, i), p.dataFields[i], sizeof(p.dataFields[i])) != SUCCESS) {
+                return fail(ctx, ERROR_INVALID_INPUT, "subject names must be strings");
+            }
+        }
+    }
+
+    ErrorCode rc = registerProfile(&p, password);
+    memset(password, 0, sizeof(password));
+    if (rc == ERROR_ALREADY_EXISTS) return fail(ctx, rc, "email or mobile already registered");
+    if (rc == ERROR_INVALID_INPUT) return fail(ctx, rc, "invalid profile, contact details or weak password");
+    if (rc != SUCCESS) return rc;
+
+    jwKeyString(ctx->out, "userID", p.userID);
+    return SUCCESS;
+}
+
+static void writeChannels(JsonWriter *w, int channels) {
+    jwKey(w, "channels");
+    jwBeginArray(w);
+    if (channels & SIGNIN_CHANNEL_SMS) jwString(w, "sms");
+    if (channels & SIGNIN_CHANNEL_EMAIL) jwString(w, "email");
+    jwEndArray(w);
+}
+
+// Step 1 of signin: credentials -> OTP issued, flow parked under a ticket
+static ErrorCode opSignin(ApiContext *ctx) {
+    char userID[20], mobile[15], password[MAX_LEN], ticket[SIGNIN_TICKET_LEN + 1];
+    if (jsonFindString(ctx->doc, ctx->root, "user", userID, sizeof(userID)) != SUCCESS ||
+        jsonFindString(ctx->doc, ctx->root, "mobile", mobile, sizeof(mobile)) != SUCCESS ||
+        jsonFindString(ctx->doc, ctx->root, "password", password, sizeof(password)) != SUCCESS) {
+        return fail(ctx, ERROR_INVALID_INPUT, "user, mobile and password are required");
+    }
+    int channels = 0;
+    ErrorCode rc = signinBegin(userID, mobile, password, ticket, &channels);
+    memset(password, 0, sizeof(password));
+    switch (rc) {
+        case SUCCESS: break;
+        case ERROR_PERMISSION: return fail(ctx, rc, "account temporarily locked");
+        case ERROR_NOT_FOUND:
+        case ERROR_AUTH_FAILED: return fail(ctx, ERROR_AUTH_FAILED, "invalid credentials");
+        case ERROR_NETWORK: return fail(ctx, rc, "OTP delivery failed");
+        default: return fail(ctx, rc, "could not start signin");
+    }
+
+    jwKeyBool(ctx->out, "otpRequired", 1);
+    jwKeyString(ctx->out, "ticket", ticket);
+    writeChannels(ctx->out, channels);
+    return SUCCESS;
+}
+
+// Step 2 of signin: ticket + OTP -> session token
+static ErrorCode opVerifyOtp(ApiContext *ctx) {
+    char ticket[SIGNIN_TICKET_LEN + 8], otp[16];
+    if (jsonFindString(ctx->doc, ctx->root, "ticket", ticket, sizeof(ticket)) != SUCCESS ||
+        jsonFindString(ctx->doc, ctx->root, "otp", otp, sizeof(otp)) != SUCCESS) {
+        return fail(ctx, ERROR_INVALID_INPUT, "ticket and otp are required");
+    }
+    Session session;
+    ErrorCode rc = signinVerify(ticket, otp, &session);
+    if (rc == ERROR_NOT_FOUND) return fail(ctx, rc, "unknown or finished signin");
+    if (rc == ERROR_AUTH_FAILED) return fail(ctx, rc, "invalid or expired OTP");
+    if (rc != SUCCESS) return fail(ctx, rc, "could not create session");
+    jwKeyString(ctx->out, "userID", session.userID);
+    jwKeyString(ctx->out, "token", session.sessionToken);
+    return SUCCESS;
+}
+
+static ErrorCode opResendOtp(ApiContext *ctx) {
+    char ticket[SIGNIN_TICKET_LEN + 8];
+    if (jsonFindString(ctx->doc, ctx->root, "ticket", ticket, sizeof(ticket)) != SUCCESS) {
+        return fail(ctx, ERROR_INVALID_INPUT, "ticket is required");
+    }
+    int channels = 0;
+    ErrorCode rc = signinResend(ticket, &channels);
+    if (rc == ERROR_NOT_FOUND) return fail(ctx, rc, "unknown or finished signin");
+    if (rc == ERROR_PERMISSION) return fail(ctx, rc, "resend limit reached");
+    if (rc != SUCCESS) return fail(ctx, rc, "OTP delivery failed");
+    writeChannels(ctx->out, channels);
+    return SUCCESS;
+}
+
+static ErrorCode opSignout(ApiContext *ctx) {
+    destroySession(ctx->session.sessionToken);
+    return SUCCESS;
+}
+
+static ErrorCode opProfile(ApiContext *ctx) {
+    Profile p;
+    if (!getUserByID(ctx->session.userID, &p)) return fail(ctx, ERROR_NOT_FOUND, "profile not found");
+    writeProfile(ctx->out, &p);
+    return SUCCESS;
+}
+
+static ErrorCode opDataGet(ApiContext *ctx) {
+    Profile p;
+    if (!getUserByID(ctx->session.userID, &p)) return fail(ctx, ERROR_NOT_FOUND, "profile not found");
+    JsonWriter *w = ctx->out;
+    jwKeyString(w, "campus", getCampusName(p.campusType));
+    const GradingScheme *scheme = gradingSchemeFor(p.instituteName);
+
+    if (p.campusType == CAMPUS_SCHOOL) {
+        SchoolMarks data;
+        size_t size = sizeof(data);
+        if (!loadUserData(p.userID, "SCHOOL_DATA", &data, &size)) return fail(ctx, ERROR_NOT_FOUND, "no school data");
+        jwKey(w, "subjects");
+        jwBeginArray(w);
+        for (int i = 0; i < data.count && i < MAX_SUBJECTS; i++) {
+            jwBeginObject(w);
+            jwKeyString(w, "name", data.subjects[i]);
+            jwKeyInt(w, "marks", data.marks[i]);
+            jwKeyInt(w, "fullMarks", data.fullMarks[i]);
+            jwEndObject(w);
+        }
+        jwEndArray(w);
+        GradeSummary g = gradeSchoolMarks(&data);
+        jwKeyInt(w, "total", g.total);
+        jwKeyInt(w, "fullTotal", g.weight);
+        jwKey(w, "percentage");
+        jwDouble(w, g.score, 2);
+        jwKeyString(w, "grade", scheme->names[gradingSchemeGrade(scheme, g.score)]);
+    } else if (p.campusType == CAMPUS_COLLEGE) {
+        CollegeMarks data;
+        size_t size = sizeof(data);
+        if (!loadUserData(p.userID, "COLLEGE_DATA", &data, &size)) return fail(ctx, ERROR_NOT_FOUND, "no college data");
+        jwKey(w, "subjects");
+        jwBeginArray(w);
+        for (int i = 0; i < data.count && i < MAX_SUBJECTS; i++) {
+            jwBeginObject(w);
+            jwKeyString(w, "name", data.subjects[i]);
+            jwKeyInt(w, "marks", data.marks[i]);
+            jwKeyInt(w, "credits", data.credits[i]);
+            jwEndObject(w);
+        }
+        jwEndArray(w);
+        GradingResult result;
+        gradingSchemeApply(scheme, CAMPUS_COLLEGE, &data, &result);
+        jwKey(w, "cgpa");
+        jwDouble(w, result.gpa, 2);
+        jwKeyString(w, "grade", scheme->names[result.grade]);
+    } else {
+        FieldValues data;
+        size_t size = sizeof(data);
+        if (!loadUserData(p.userID, campusDataType(p.campusType), &data, &size)) {
+            return fail(ctx, ERROR_NOT_FOUND, "no data recorded");
+        }
+        jwKey(w, "fields");
+        jwBeginArray(w);
+        for (int i = 0; i < data.count && i < MAX_SUBJECTS; i++) {
+            jwBeginObject(w);
+            jwKeyString(w, "name", data.fields[i]);
+            jwKeyString(w, "value", data.values[i]);
+            jwEndObject(w);
+        }
+        jwEndArray(w);
+        return SUCCESS;
+    }
+
+    // Position on the institute's merit list; only the caller's own standing
+    int rank, total;
+    float score, percentile;
+    if (rankOfStudent(p.instituteName, p.campusType, NULL, p.userID, &rank, &total, &score) == SUCCESS &&
+        rankPercentile(p.instituteName, p.campusType, NULL, score, &percentile) == SUCCESS) {
+        jwKey(w, "rank");
+        jwBeginObject(w);
+        jwKeyInt(w, "position", rank);
+        jwKeyInt(w, "of", total);
+        jwKey(w, "percentile");
+        jwDouble(w, percentile, 2);
+        jwEndObject(w);
+    }
+    return SUCCESS;
+}
+
+// Aggregates for the caller's own institute and campus type; optional
+// "department" and "subject" narrow the row
+static ErrorCode opStats(ApiContext *ctx) {
+    Profile p;
+    if (!getUserByID(ctx->session.userID, &p)) return fail(ctx, ERROR_NOT_FOUND, "profile not found");
+    if (p.campusType != CAMPUS_SCHOOL && p.campusType != CAMPUS_COLLEGE) {
+        return fail(ctx, ERROR_INVALID_INPUT, "statistics cover school and college marks");
+    }
+    char department[MAX_LEN] = "", subject[MAX_LEN] = "";
+    jsonFindString(ctx->doc, ctx->root, "department", department, sizeof(department));
+    jsonFindString(ctx->doc, ctx->root, "subject", subject, sizeof(subject));
+
+    ScoreStats stats;
+    ErrorCode rc = getScoreStats(p.instituteName, department, p.campusType, subject, &stats);
+    if (rc == ERROR_NOT_FOUND) return fail(ctx, rc, "no marks recorded");
+    if (rc != SUCCESS) return rc;
+
+    JsonWriter *w = ctx->out;
+    jwKeyString(w, "institute", p.instituteName);
+    jwKeyInt(w, "count", stats.count);
+    jwKey(w, "mean");
+    jwDouble(w, stats.mean, 2);
+    jwKey(w, "stddev");
+    jwDouble(w, stats.stddev, 2);
+    jwKey(w, "passRate");
+    jwDouble(w, stats.passRate, 2);
+    jwKey(w, "histogram");
+    jwBeginArray(w);
+    for (int h = 0; h < STATS_BUCKETS; h++) jwInt(w, stats.histogram[h]);
+    jwEndArray(w);
+    return SUCCESS;
+}
+
+static ErrorCode opDataPut(ApiContext *ctx) {
+    const JsonDoc *doc = ctx->doc;
+    Profile p;
+    if (!getUserByID(ctx->session.userID, &p)) return fail(ctx, ERROR_NOT_FOUND, "profile not found");
+
+    ErrorCode rc;
+    if (p.campusType == CAMPUS_SCHOOL || p.campusType == CAMPUS_COLLEGE) {
+        int marks[MAX_SUBJECTS], second[MAX_SUBJECTS];
+        const char *secondKey = p.campusType == CAMPUS_SCHOOL ? "fullMarks" : "credits";
+        if (readIntArray(doc, jsonFind(doc, ctx->root, "marks"), marks, p.dataCount) != SUCCESS ||
+            readIntArray(doc, jsonFind(doc, ctx->root, secondKey), second, p.dataCount) != SUCCESS) {
+            return fail(ctx, ERROR_INVALID_INPUT, p.campusType == CAMPUS_SCHOOL
+                        ? "marks and fullMarks need one number per subject"
+                        : "marks and credits need one number per course");
+        }
+        rc = p.campusType == CAMPUS_SCHOOL
+            ? storeSchoolMarks(p.userID, marks, second, p.dataCount)
+            : storeCollegeMarks(p.userID, marks, second, p.dataCount);
+    } else {
+        char values[MAX_SUBJECTS][MAX_LEN];
+        int array = jsonFind(doc, ctx->root, "values");
+        if (array < 0 || doc->tokens[array].type != JSON_ARRAY || doc->tokens[array].size != p.dataCount) {
+            return fail(ctx, ERROR_INVALID_INPUT, "values need one string per field");
+        }
+        for (int i = 0; i < p.dataCount; i++) {
+            if (jsonGetString(doc, jsonArrayItem(doc, array, i), values[i], sizeof(values[i])) != SUCCESS) {
+                return fail(ctx, ERROR_INVALID_INPUT, "values must be strings");
+            }
+        }
+        rc = storeFieldValues(p.userID, p.campusType, (const char (*)[MAX_LEN])values, p.dataCount);
+    }
+    if (rc == ERROR_INVALID_INPUT) return fail(ctx, rc, "values out of range");
+    return rc;
+}
+
+static ErrorCode opExport(ApiContext *ctx) {
+    char kind[16] = "report", format[8] = "pdf", path[200];
+    jsonFindString(ctx->doc, ctx->root, "kind", kind, sizeof(kind));
+    jsonFindString(ctx->doc, ctx->root, "format", format, sizeof(format));
+    const char *userID = ctx->session.userID;
+
+    ErrorCode rc;
+    if (strcmp(kind, "report") == 0) {
+        rc = exportCampusReport(userID, path, sizeof(path));
+    } else if (strcmp(kind, "profile") == 0) {
+        int ok;
+        snprintf(path, sizeof(path), DATA_DIR "%s_profile.%s", userID, format);
+        if (strcmp(format, "pdf") == 0) ok = exportProfilePDF(userID, path);
+        else if (strcmp(format, "txt") == 0) ok = exportProfileTXT(userID, path);
+        else if (strcmp(format, "csv") == 0) ok = exportProfileCSV(userID, path);
+        else return fail(ctx, ERROR_INVALID_INPUT, "format must be pdf, txt or csv");
+        rc = ok ? SUCCESS : ERROR_FILE_IO;
+    } else {
+        return fail(ctx, ERROR_INVALID_INPUT, "kind must be report or profile");
+    }
+    if (rc != SUCCESS) return fail(ctx, rc, "export failed");
+
+    logEvent(userID, "Export via API");
+    jwKeyString(ctx->out, "path", path);
+    return SUCCESS;
+}
+
+static const ApiOperation operations[] = {
+    { "ping",       opPing,      0, ADMIT_CLASS_FAST },
+    { "signup",     opSignup,    0, ADMIT_CLASS_AUTH },
+    { "signin",     opSignin,    0, ADMIT_CLASS_AUTH },
+    { "verify_otp", opVerifyOtp, 0, ADMIT_CLASS_AUTH },
+    { "resend_otp", opResendOtp, 0, ADMIT_CLASS_AUTH },
+    { "signout",    opSignout,   1, ADMIT_CLASS_FAST },
+    { "profile",    opProfile,   1, ADMIT_CLASS_FAST },
+    { "data_get",   opDataGet,   1, ADMIT_CLASS_FAST },
+    { "data_put",   opDataPut,   1, ADMIT_CLASS_FAST },
+    { "stats",      opStats,     1, ADMIT_CLASS_FAST },
+    { "export",     opExport,    1, ADMIT_CLASS_EXPORT },
+};
+
+static const ApiOperation *findOperation(const char *name, size_t length) {
+    for (size_t i = 0; i < sizeof(operations) / sizeof(operations[0]); i++) {
+        if (strlen(operations[i].name) == length && memcmp(operations[i].name, name, length) == 0) {
+            return &operations[i];
+        }
+    }
+    return NULL;
+}
+
+// Runs one operation inside an open response object and writes the
+// trailing "ok"/"error" fields. `token` may be NULL for public ops.
+static ErrorCode dispatch(ApiContext *ctx, const ApiOperation *op, const char *token) {
+    JsonWriter *out = ctx->out;
+    ErrorCode rc;
+    if (!op) {
+        rc = fail(ctx, ERROR_INVALID_INPUT, "unknown op");
+        goto respond;
+    }
+    if (op->needsSession && ctx->session.userID[0] == '\0') {
+        if (!token || !validateSession(token, &ctx->session)) {
+            rc = fail(ctx, ERROR_AUTH_FAILED, "missing or expired session token");
+            goto respond;
+        }
+        updateSessionActivity(token);
+    }
+
+    // Handlers stream their fields straight into the response; a failing
+    // handler's partial output is rolled back before the error is written
+    size_t mark = out->length;
+    int depth = out->depth;
+    unsigned char comma = out->needComma[depth];
+    rc = op->handler(ctx);
+    if (rc != SUCCESS) {
+        out->length = mark;
+        out->depth = depth;
+        out->needComma[depth] = comma;
+        out->afterKey = 0;
+    }
+
+respond:
+    jwKeyBool(out, "ok", rc == SUCCESS);
+    if (rc != SUCCESS) {
+        jwKeyString(out, "error", apiErrorName(rc));
+        if (ctx->message) jwKeyString(out, "message", ctx->message);
+    }
+    return rc;
+}
+
+// Echo the client's correlation id verbatim (number or string)
+static void writeRequestId(const JsonDoc *doc, JsonWriter *out) {
+    int id = jsonFind(doc, 0, "id");
+    if (id >= 0 && (doc->tokens[id].type == JSON_NUMBER || doc->tokens[id].type == JSON_STRING)) {
+        int quote = doc->tokens[id].type == JSON_STRING;
+        jwKey(out, "id");
+        jwRawValue(out, doc->text + doc->tokens[id].start - quote,
+                   (size_t)(doc->tokens[id].end - doc->tokens[id].start + 2 * quote));
+    }
+}
+
+// `actingUser` set: session ops run for that user without a token
+static ErrorCode handleRequest(const char *request, size_t length, const char *actingUser, JsonWriter *out) {
+    static __thread JsonDoc doc;    // ~5 KB of tokens, one per worker thread
+    ApiContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.doc = &doc;
+    ctx.out = out;
+    if (actingUser) snprintf(ctx.session.userID, sizeof(ctx.session.userID), "%s", actingUser);
+
+    jwBeginObject(out);
+    ErrorCode rc = jsonParse(&doc, request, length);
+    if (rc != SUCCESS || doc.tokens[0].type != JSON_OBJECT) {
+        jwKeyBool(out, "ok", 0);
+        jwKeyString(out, "error", apiErrorName(ERROR_INVALID_INPUT));
+        jwKeyString(out, "message", "request must be a JSON object");
+        jwEndObject(out);
+        return ERROR_INVALID_INPUT;
+    }
+
+    writeRequestId(&doc, out);
+
+    const ApiOperation *op = NULL;
+    int opToken = jsonFind(&doc, 0, "op");
+    if (opToken >= 0 && doc.tokens[opToken].type == JSON_STRING) {
+        op = findOperation(doc.text + doc.tokens[opToken].start,
+                           (size_t)(doc.tokens[opToken].end - doc.tokens[opToken].start));
+    }
+    char token[64];
+    int hasToken = jsonFindString(&doc, 0, "token", token, sizeof(token)) == SUCCESS;
+    rc = dispatch(&ctx, op, hasToken ? token : NULL);
+    jwEndObject(out);
+    return rc;
+}
+
+void apiHandleRequest(const char *request, size_t length, JsonWriter *out) {
+    handleRequest(request, length, NULL, out);
+}
+
+ErrorCode apiHandleAsUser(const char *request, size_t length, const char *userID, JsonWriter *out) {
+    return handleRequest(request, length, userID, out);
+}
+
+AdmitClass apiOperationClass(const char *op) {
+    const ApiOperation *operation = op ? findOperation(op, strlen(op)) : NULL;
+    return operation ? operation->admitClass : ADMIT_CLASS_FAST;
+}
+
+AdmitClass apiRequestClass(const char *request, size_t length) {
+    static __thread JsonDoc doc;
+    if (jsonParse(&doc, request, length) != SUCCESS || doc.tokens[0].type != JSON_OBJECT) return ADMIT_CLASS_FAST;
+    int opToken = jsonFind(&doc, 0, "op");
+    if (opToken < 0 || doc.tokens[opToken].type != JSON_STRING) return ADMIT_CLASS_FAST;
+    const ApiOperation *op = findOperation(doc.text + doc.tokens[opToken].start,
+                                           (size_t)(doc.tokens[opToken].end - doc.tokens[opToken].start));
+    return op ? op->admitClass : ADMIT_CLASS_FAST;
+}
+
+// Error response for a request answered without running it; the object is
+// left open for extra fields
+static void beginErrorResponse(const char *request, size_t length, ErrorCode code, const char *message, JsonWriter *out) {
+    static __thread JsonDoc doc;
+    jwBeginObject(out);
+    if (jsonParse(&doc, request, length) == SUCCESS && doc.tokens[0].type == JSON_OBJECT) writeRequestId(&doc, out);
+    jwKeyBool(out, "ok", 0);
+    jwKeyString(out, "error", apiErrorName(code));
+    jwKeyString(out, "message", message);
+}
+
+void apiWriteError(const char *request, size_t length, ErrorCode code, const char *message, JsonWriter *out) {
+    beginErrorResponse(request, length, code, message, out);
+    jwEndObject(out);
+}
+
+void apiWriteOverloaded(const char *request, size_t length, unsigned retryAfterMillis, JsonWriter *out) {
+    beginErrorResponse(request, length, ERROR_OVERLOADED, "server busy, retry later", out);
+    jwKeyInt(out, "retryAfterMs", retryAfterMillis);
+    jwEndObject(out);
+}
+
+ErrorCode apiRenderReport(const char *token, ExportBuffer *report, JsonWriter *out) {
+    Session session;
+    Profile p;
+    const char *message = NULL;
+    ErrorCode rc = SUCCESS;
+    memset(report, 0, sizeof(*report));
+    if (!token || !validateSession(token, &session)) {
+        rc = ERROR_AUTH_FAILED;
+        message = "missing or expired session token";
+    } else {
+        updateSessionActivity(token);
+        if (!getUserByID(session.userID, &p)) rc = ERROR_NOT_FOUND;
+        else rc = renderCampusReport(&p, report);
+        if (rc == SUCCESS) logEvent(session.userID, "Export via API");
+        else message = rc == ERROR_NOT_FOUND ? "no campus data to report" : "export failed";
+    }
+    if (rc != SUCCESS) {
+        jwBeginObject(out);
+        jwKeyBool(out, "ok", 0);
+        jwKeyString(out, "error", apiErrorName(rc));
+        jwKeyString(out, "message", message);
+        jwEndObject(out);
+    }
+    return rc;
+}
+
+ErrorCode apiHandleOperation(const char *op, const char *token, const char *body, size_t length, JsonWriter *out) {
+    static __thread JsonDoc doc;
+    ApiContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.doc = &doc;
+    ctx.out = out;
+
+    jwBeginObject(out);
+    if (length == 0) {
+        body = "{}";
+        length = 2;
+    }
+    if (jsonParse(&doc, body, length) != SUCCESS || doc.tokens[0].type != JSON_OBJECT) {
+        jwKeyBool(out, "ok", 0);
+        jwKeyString(out, "error", apiErrorName(ERROR_INVALID_INPUT));
+        jwKeyString(out, "message", "body must be a JSON object");
+        jwEndObject(out);
+        return ERROR_INVALID_INPUT;
+    }
+    ErrorCode rc = dispatch(&ctx, findOperation(op, strlen(op)), token);
+    jwEndObject(out);
+    return rc;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/audit_events.h"
+
+#define AUDIT_EVENT_EMPTY_SLOT 0xff
+
+_Static_assert(EVENT_COUNT * 2 <= AUDIT_EVENT_HASH_SLOTS, "grow AUDIT_EVENT_HASH_SLOTS");
+_Static_assert(EVENT_COUNT < AUDIT_EVENT_EMPTY_SLOT, "event codes must fit the slot table");
+
+static const char *const eventNames[EVENT_COUNT] = {
+#define AUDIT_EVENT_NAME(name, code) [code] = #name,
+    AUDIT_EVENT_LIST(AUDIT_EVENT_NAME)
+#undef AUDIT_EVENT_NAME
+};
+
+static unsigned char slotTable[AUDIT_EVENT_HASH_SLOTS];
+static uint32_t activeSeed = AUDIT_EVENT_HASH_SEED;
+static pthread_once_t slotTableOnce = PTHREAD_ONCE_INIT;
+
+static uint32_t eventNameHash(const char *s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (const unsigned char *p = (const unsigned char*)s; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+static int tryBuildTable(uint32_t seed) {
+    memset(slotTable, AUDIT_EVENT_EMPTY_SLOT, sizeof(slotTable));
+    for (int code = 0; code < EVENT_COUNT; code++) {
+        uint32_t slot = eventNameHash(eventNames[code], seed) & (AUDIT_EVENT_HASH_SLOTS - 1);
+        if (slotTable[slot] != AUDIT_EVENT_EMPTY_SLOT) return 0;
+        slotTable[slot] = (unsigned char)code;
+    }
+    return 1;
+}
+
+// The compiled-in seed is collision free for the current list; if the list
+// grew without updating it, search for a new one rather than mis-map events
+static void buildSlotTable(void) {
+    uint32_t seed = AUDIT_EVENT_HASH_SEED;
+    while (!tryBuildTable(seed)) seed++;
+    if (seed != AUDIT_EVENT_HASH_SEED) {
+        fprintf(stderr, "audit_events: AUDIT_EVENT_HASH_SEED is stale, using %u\n", seed);
+    }
+    activeSeed = seed;
+}
+
+const char *auditEventName(AuditEvent event) {
+    if ((int)event < 0 || event >= EVENT_COUNT) return eventNames[EVENT_NOTE];
+    return eventNames[event];
+}
+
+AuditEvent auditEventFromName(const char *name) {
+    if (!name) return EVENT_NOTE;
+    pthread_once(&slotTableOnce, buildSlotTable);
+    unsigned char code = slotTable[eventNameHash(name, activeSeed) & (AUDIT_EVENT_HASH_SLOTS - 1)];
+    if (code == AUDIT_EVENT_EMPTY_SLOT || strcmp(eventNames[code], name) != 0) return EVENT_NOTE;
+    return (AuditEvent)code;
+}
+
+int auditEventIsKnownName(const char *name) {
+    return name && (auditEventFromName(name) != EVENT_NOTE || strcmp(name, eventNames[EVENT_NOTE]) == 0);
+}
+
+uint32_t auditEventHashSeed(void) {
+    pthread_once(&slotTableOnce, buildSlotTable);
+    return activeSeed;
+}
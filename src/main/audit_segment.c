@@ -0,0 +1,642 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "../include/audit_segment.h"
+
+/*
+ * Segment file  audit_NNNNNN.seg
+ *   header : "CAMAUDT1" u32 version u32 segment
+ *   record : u64 epochMicros | u64 userHash | u16 eventCode   (fixed, little endian)
+ *            varint len + userID | varint len + details
+ *
+ * Index file    audit_NNNNNN.idx  (one entry per AUDIT_BLOCK_RECORDS records)
+ *   header : "CAMAIDX1" u32 version u32 segment
+ *   entry  : u64 minMicros | u64 maxMicros | u64 offset | u32 length | u32 count | u64 userBloom
+ *
+ * Records after the last index entry form the open block; readers scan it directly.
+ */
+
+#define AUDIT_SEG_MAGIC     "CAMAUDT1"
+#define AUDIT_IDX_MAGIC     "CAMAIDX1"
+#define AUDIT_VERSION       1
+#define AUDIT_HEADER_SIZE   16
+#define AUDIT_ENTRY_SIZE    40
+#define AUDIT_FIXED_SIZE    18
+#define AUDIT_MAX_RECORD    (AUDIT_FIXED_SIZE + 2 + 20 + 2 + AUDIT_DETAILS_LEN)
+
+typedef struct {
+    uint64_t minMicros;
+    uint64_t maxMicros;
+    uint64_t offset;
+    uint32_t length;
+    uint32_t count;
+    uint64_t userBloom;
+} AuditIndexEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int open;
+    char dir[200];
+    uint32_t segmentNo;
+    FILE *seg;
+    FILE *idx;
+    uint64_t segBytes;
+    AuditIndexEntry block;
+} AuditWriter;
+
+static AuditWriter writer = { PTHREAD_MUTEX_INITIALIZER, 0, {0}, 0, NULL, NULL, 0, {0} };
+
+// FNV-1a, 64 bit
+uint64_t auditUserHash(const char *userID) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char*)(userID ? userID : ""); *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t auditNowMicros(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+// Accepts epoch seconds or "YYYY-MM-DD[THH:MM[:SS]]" (UTC)
+ErrorCode auditParseTime(const char *text, uint64_t *micros) {
+    if (!text || !micros) return ERROR_INVALID_INPUT;
+    struct tm tmInfo = {0};
+    int y = 0, mo = 0, d = 0, h = 0, mi = 0, sec = 0;
+    char sep = 0;
+    int fields = sscanf(text, "%d-%d-%d%c%d:%d:%d", &y, &mo, &d, &sep, &h, &mi, &sec);
+    if (fields >= 3) {
+        if (fields > 3 && sep != 'T' && sep != ' ') return ERROR_INVALID_INPUT;
+        tmInfo.tm_year = y - 1900;
+        tmInfo.tm_mon = mo - 1;
+        tmInfo.tm_mday = d;
+        tmInfo.tm_hour = h;
+        tmInfo.tm_min = mi;
+        tmInfo.tm_sec = sec;
+#ifdef _WIN32
+        time_t t = _mkgmtime(&tmInfo);
+#else
+        time_t t = timegm(&tmInfo);
+#endif
+        if (t == (time_t)-1) return ERROR_INVALID_INPUT;
+        *micros = (uint64_t)t * 1000000ULL;
+        return SUCCESS;
+    }
+    char *end = NULL;
+    unsigned long long secs = strtoull(text, &end, 10);
+    if (!end || end == text || *end != '\0') return ERROR_INVALID_INPUT;
+    *micros = (uint64_t)secs * 1000000ULL;
+    return SUCCESS;
+}
+
+static uint64_t bloomBits(uint64_t userHash) {
+    return (1ULL << (userHash & 63)) | (1ULL << ((userHash >> 6) & 63));
+}
+
+static void putU16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void putU32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static void putU64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint16_t getU16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t getU32(const uint8_t *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+static uint64_t getU64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static size_t putVarint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns bytes consumed, 0 when the input is truncated or malformed
+static size_t getVarint(const uint8_t *p, size_t avail, uint32_t *out) {
+    uint32_t v = 0;
+    for (size_t i = 0; i < avail && i < 5; i++) {
+        v |= (uint32_t)(p[i] & 0x7f) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *out = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static size_t encodeRecord(uint8_t *buf, uint64_t micros, uint64_t userHash, uint16_t code,
+                           const char *userID, const char *details) {
+    size_t userLen = strlen(userID);
+    size_t detLen = strlen(details);
+    if (userLen > 19) userLen = 19;
+    if (detLen > AUDIT_DETAILS_LEN - 1) detLen = AUDIT_DETAILS_LEN - 1;
+
+    putU64(buf, micros);
+    putU64(buf + 8, userHash);
+    putU16(buf + 16, code);
+    size_t n = AUDIT_FIXED_SIZE;
+    n += putVarint(buf + n, (uint32_t)userLen);
+    memcpy(buf + n, userID, userLen);
+    n += userLen;
+    n += putVarint(buf + n, (uint32_t)detLen);
+    memcpy(buf + n, details, detLen);
+    return n + detLen;
+}
+
+static size_t decodeRecord(const uint8_t *buf, size_t avail, AuditRecord *rec) {
+    if (avail < AUDIT_FIXED_SIZE) return 0;
+    rec->epochMicros = getU64(buf);
+    rec->userHash = getU64(buf + 8);
+    rec->eventCode = getU16(buf + 16);
+    size_t n = AUDIT_FIXED_SIZE;
+
+    uint32_t len = 0;
+    size_t used = getVarint(buf + n, avail - n, &len);
+    if (!used || len >= sizeof(rec->userID) || n + used + len > avail) return 0;
+    n += used;
+    memcpy(rec->userID, buf + n, len);
+    rec->userID[len] = '\0';
+    n += len;
+
+    used = getVarint(buf + n, avail - n, &len);
+    if (!used || len >= sizeof(rec->details) || n + used + len > avail) return 0;
+    n += used;
+    memcpy(rec->details, buf + n, len);
+    rec->details[len] = '\0';
+    return n + len;
+}
+
+static void encodeEntry(uint8_t *p, const AuditIndexEntry *e) {
+    putU64(p, e->minMicros);
+    putU64(p + 8, e->maxMicros);
+    putU64(p + 16, e->offset);
+    putU32(p + 24, e->length);
+    putU32(p + 28, e->count);
+    putU64(p + 32, e->userBloom);
+}
+
+static void decodeEntry(const uint8_t *p, AuditIndexEntry *e) {
+    e->minMicros = getU64(p);
+    e->maxMicros = getU64(p + 8);
+    e->offset = getU64(p + 16);
+    e->length = getU32(p + 24);
+    e->count = getU32(p + 28);
+    e->userBloom = getU64(p + 32);
+}
+
+static void segmentPath(char *out, size_t size, const char *dir, uint32_t segNo, const char *ext) {
+    snprintf(out, size, "%s/audit_%06u.%s", dir, segNo, ext);
+}
+
+static void writeHeader(FILE *f, const char *magic, uint32_t segNo) {
+    uint8_t header[AUDIT_HEADER_SIZE];
+    memcpy(header, magic, 8);
+    putU32(header + 8, AUDIT_VERSION);
+    putU32(header + 12, segNo);
+    fwrite(header, sizeof(header), 1, f);
+}
+
+static int checkHeader(FILE *f, const char *magic) {
+    uint8_t header[AUDIT_HEADER_SIZE];
+    if (fseek(f, 0, SEEK_SET) != 0) return 0;
+    if (fread(header, sizeof(header), 1, f) != 1) return 0;
+    return memcmp(header, magic, 8) == 0 && getU32(header + 8) == AUDIT_VERSION;
+}
+
+static long fileSize(FILE *f) {
+    if (fseek(f, 0, SEEK_END) != 0) return -1;
+    return ftell(f);
+}
+
+static void truncateFile(FILE *f, long size) {
+    fflush(f);
+#ifdef _WIN32
+    _chsize_s(_fileno(f), size);
+#else
+    if (ftruncate(fileno(f), size) != 0) {
+        fprintf(stderr, "Audit log: truncate failed\n");
+    }
+#endif
+}
+
+// Sorted list of segment numbers present in dir
+static uint32_t *listSegments(const char *dir, size_t *count) {
+    *count = 0;
+    DIR *d = opendir(dir);
+    if (!d) return NULL;
+    size_t cap = 16;
+    uint32_t *segs = (uint32_t*)malloc(cap * sizeof(uint32_t));
+    struct dirent *ent;
+    while (segs && (ent = readdir(d)) != NULL) {
+        unsigned int segNo = 0;
+        char ext[8] = {0};
+        if (sscanf(ent->d_name, "audit_%6u.%3s", &segNo, ext) != 2 || strcmp(ext, "seg") != 0) continue;
+        if (*count == cap) {
+            cap *= 2;
+            uint32_t *grown = (uint32_t*)realloc(segs, cap * sizeof(uint32_t));
+            if (!grown) break;
+            segs = grown;
+        }
+        segs[(*count)++] = segNo;
+    }
+    closedir(d);
+    for (size_t i = 1; i < *count; i++) {
+        uint32_t v = segs[i];
+        size_t j = i;
+        while (j > 0 && segs[j - 1] > v) { segs[j] = segs[j - 1]; j--; }
+        segs[j] = v;
+    }
+    return segs;
+}
+
+// Load the index entries of one segment (returns malloc'ed array)
+static AuditIndexEntry *loadIndex(FILE *idx, size_t *count) {
+    *count = 0;
+    if (!idx || !checkHeader(idx, AUDIT_IDX_MAGIC)) return NULL;
+    long size = fileSize(idx);
+    if (size <= AUDIT_HEADER_SIZE) return NULL;
+    size_t n = (size_t)(size - AUDIT_HEADER_SIZE) / AUDIT_ENTRY_SIZE;
+    AuditIndexEntry *entries = (AuditIndexEntry*)malloc((n ? n : 1) * sizeof(AuditIndexEntry));
+    if (!entries) return NULL;
+    fseek(idx, AUDIT_HEADER_SIZE, SEEK_SET);
+    uint8_t raw[AUDIT_ENTRY_SIZE];
+    for (size_t i = 0; i < n; i++) {
+        if (fread(raw, sizeof(raw), 1, idx) != 1) { n = i; break; }
+        decodeEntry(raw, &entries[i]);
+    }
+    *count = n;
+    return entries;
+}
+
+static void resetBlock(void) {
+    memset(&writer.block, 0, sizeof(writer.block));
+}
+
+static ErrorCode createSegment(uint32_t segNo) {
+    char path[260];
+    segmentPath(path, sizeof(path), writer.dir, segNo, "seg");
+    writer.seg = fopen(path, "w+b");
+    segmentPath(path, sizeof(path), writer.dir, segNo, "idx");
+    writer.idx = fopen(path, "w+b");
+    if (!writer.seg || !writer.idx) return ERROR_FILE_IO;
+    writeHeader(writer.seg, AUDIT_SEG_MAGIC, segNo);
+    writeHeader(writer.idx, AUDIT_IDX_MAGIC, segNo);
+    fflush(writer.seg);
+    fflush(writer.idx);
+    writer.segmentNo = segNo;
+    writer.segBytes = AUDIT_HEADER_SIZE;
+    resetBlock();
+    return SUCCESS;
+}
+
+// Reopen the newest segment for appending; rebuild the open block from its tail
+static ErrorCode resumeSegment(uint32_t segNo) {
+    char path[260];
+    segmentPath(path, sizeof(path), writer.dir, segNo, "seg");
+    writer.seg = fopen(path, "r+b");
+    segmentPath(path, sizeof(path), writer.dir, segNo, "idx");
+    writer.idx = fopen(path, "r+b");
+    if (!writer.seg || !writer.idx ||
+        !checkHeader(writer.seg, AUDIT_SEG_MAGIC) || !checkHeader(writer.idx, AUDIT_IDX_MAGIC)) {
+        return ERROR_FILE_IO;
+    }
+
+    size_t count = 0;
+    AuditIndexEntry *entries = loadIndex(writer.idx, &count);
+    long idxEnd = AUDIT_HEADER_SIZE + (long)count * AUDIT_ENTRY_SIZE;
+    if (fileSize(writer.idx) != idxEnd) truncateFile(writer.idx, idxEnd); // torn entry
+    uint64_t tailStart = count ? entries[count - 1].offset + entries[count - 1].length : AUDIT_HEADER_SIZE;
+    free(entries);
+
+    long segSize = fileSize(writer.seg);
+    if (segSize < (long)tailStart) return ERROR_FILE_IO;
+    size_t tailLen = (size_t)segSize - (size_t)tailStart;
+
+    resetBlock();
+    writer.block.offset = tailStart;
+    if (tailLen > 0) {
+        uint8_t *tail = (uint8_t*)malloc(tailLen);
+        if (!tail) return ERROR_MEMORY;
+        fseek(writer.seg, (long)tailStart, SEEK_SET);
+        size_t got = fread(tail, 1, tailLen, writer.seg);
+        size_t pos = 0;
+        AuditRecord rec;
+        while (pos < got) {
+            size_t used = decodeRecord(tail + pos, got - pos, &rec);
+            if (!used) break;
+            if (writer.block.count == 0 || rec.epochMicros < writer.block.minMicros) writer.block.minMicros = rec.epochMicros;
+            if (rec.epochMicros > writer.block.maxMicros) writer.block.maxMicros = rec.epochMicros;
+            writer.block.userBloom |= bloomBits(rec.userHash);
+            writer.block.length += (uint32_t)used;
+            writer.block.count++;
+            pos += used;
+        }
+        free(tail);
+        if (pos < tailLen) truncateFile(writer.seg, (long)(tailStart + pos)); // torn record
+    }
+    fseek(writer.seg, 0, SEEK_END);
+    fseek(writer.idx, 0, SEEK_END);
+    writer.segmentNo = segNo;
+    writer.segBytes = tailStart + writer.block.length;
+    return SUCCESS;
+}
+
+static void closeBlock(void) {
+    if (writer.block.count == 0) return;
+    uint8_t raw[AUDIT_ENTRY_SIZE];
+    encodeEntry(raw, &writer.block);
+    fwrite(raw, sizeof(raw), 1, writer.idx);
+    fflush(writer.seg);
+    fflush(writer.idx);
+    resetBlock();
+    writer.block.offset = writer.segBytes;
+}
+
+static void closeFiles(void) {
+    if (writer.seg) fclose(writer.seg);
+    if (writer.idx) fclose(writer.idx);
+    writer.seg = NULL;
+    writer.idx = NULL;
+}
+
+ErrorCode auditOpen(const char *dir) {
+    if (!dir) dir = AUDIT_DIR;
+    pthread_mutex_lock(&writer.lock);
+    if (writer.open) {
+        pthread_mutex_unlock(&writer.lock);
+        return SUCCESS;
+    }
+    strncpy(writer.dir, dir, sizeof(writer.dir) - 1);
+    writer.dir[sizeof(writer.dir) - 1] = '\0';
+    size_t len = strlen(writer.dir);
+    if (len > 1 && writer.dir[len - 1] == '/') writer.dir[len - 1] = '\0';
+
+#ifdef _WIN32
+    _mkdir(LOG_DIR);
+    _mkdir(AUDIT_DIR);
+    _mkdir(writer.dir);
+#else
+    mkdir(LOG_DIR, 0700);
+    mkdir(AUDIT_DIR, 0700);
+    mkdir(writer.dir, 0700);
+#endif
+
+    size_t count = 0;
+    uint32_t *segs = listSegments(writer.dir, &count);
+    ErrorCode rc;
+    if (count > 0 && resumeSegment(segs[count - 1]) == SUCCESS) {
+        rc = SUCCESS;
+    } else {
+        closeFiles();
+        rc = createSegment(count > 0 ? segs[count - 1] + 1 : 1);
+    }
+    free(segs);
+
+    if (rc != SUCCESS) {
+        closeFiles();
+    } else {
+        writer.open = 1;
+    }
+    pthread_mutex_unlock(&writer.lock);
+    return rc;
+}
+
+int auditIsOpen(void) {
+    return writer.open;
+}
+
+ErrorCode auditAppend(const char *userID, uint16_t eventCode, const char *details) {
+    uint8_t buf[AUDIT_MAX_RECORD];
+    const char *user = userID ? userID : "UNKNOWN";
+    uint64_t userHash = auditUserHash(user);
+    uint64_t now = auditNowMicros();
+    size_t len = encodeRecord(buf, now, userHash, eventCode, user, details ? details : "");
+
+    pthread_mutex_lock(&writer.lock);
+    if (!writer.open) {
+        pthread_mutex_unlock(&writer.lock);
+        return ERROR_GENERAL;
+    }
+    if (writer.segBytes + len > AUDIT_SEGMENT_MAX_BYTES) {
+        closeBlock();
+        closeFiles();
+        if (createSegment(writer.segmentNo + 1) != SUCCESS) {
+            closeFiles();
+            writer.open = 0;
+            pthread_mutex_unlock(&writer.lock);
+            return ERROR_FILE_IO;
+        }
+    }
+    if (fwrite(buf, len, 1, writer.seg) != 1) {
+        pthread_mutex_unlock(&writer.lock);
+        return ERROR_FILE_IO;
+    }
+
+    AuditIndexEntry *b = &writer.block;
+    if (b->count == 0) {
+        b->offset = writer.segBytes;
+        b->minMicros = now;
+    }
+    if (now < b->minMicros) b->minMicros = now;
+    if (now > b->maxMicros) b->maxMicros = now;
+    b->userBloom |= bloomBits(userHash);
+    b->length += (uint32_t)len;
+    b->count++;
+    writer.segBytes += len;
+    if (b->count >= AUDIT_BLOCK_RECORDS) closeBlock();
+    pthread_mutex_unlock(&writer.lock);
+    return SUCCESS;
+}
+
+// Make the open block visible to readers without closing it
+ErrorCode auditFlush(void) {
+    pthread_mutex_lock(&writer.lock);
+    if (writer.open) {
+        fflush(writer.seg);
+        fflush(writer.idx);
+    }
+    pthread_mutex_unlock(&writer.lock);
+    return SUCCESS;
+}
+
+ErrorCode auditClose(void) {
+    pthread_mutex_lock(&writer.lock);
+    if (writer.open) {
+        closeBlock();
+        closeFiles();
+        writer.open = 0;
+    }
+    pthread_mutex_unlock(&writer.lock);
+    return SUCCESS;
+}
+
+// Decode a byte range of a segment and hand matching records to the visitor.
+// Returns 0 if the visitor asked to stop.
+static int scanRange(FILE *seg, uint64_t offset, size_t length, uint64_t userHash, const char *userID,
+                     uint64_t fromMicros, uint64_t toMicros, AuditVisitor visit, void *ctx,
+                     AuditQueryStats *stats) {
+    if (length == 0) return 1;
+    uint8_t *buf = (uint8_t*)malloc(length);
+    if (!buf) return 1;
+    fseek(seg, (long)offset, SEEK_SET);
+    size_t got = fread(buf, 1, length, seg);
+    size_t pos = 0;
+    int keepGoing = 1;
+    AuditRecord rec;
+    while (keepGoing && pos < got) {
+        size_t used = decodeRecord(buf + pos, got - pos, &rec);
+        if (!used) break;
+        pos += used;
+        if (rec.epochMicros < fromMicros || rec.epochMicros > toMicros) continue;
+        if (userID && (rec.userHash != userHash || strcmp(rec.userID, userID) != 0)) continue;
+        stats->recordsMatched++;
+        keepGoing = visit(&rec, ctx);
+    }
+    free(buf);
+    return keepGoing;
+}
+
+// Scan every segment of one directory; returns 0 once the visitor asked to stop
+static int querySegments(const char *dir, const char *userID, uint64_t userHash, uint64_t userMask,
+                         uint64_t fromMicros, uint64_t toMicros, AuditVisitor visit, void *ctx,
+                         AuditQueryStats *stats) {
+    size_t segCount = 0;
+    uint32_t *segs = listSegments(dir, &segCount);
+    int keepGoing = 1;
+
+    for (size_t s = 0; s < segCount && keepGoing; s++) {
+        char path[260];
+        segmentPath(path, sizeof(path), dir, segs[s], "seg");
+        FILE *seg = fopen(path, "rb");
+        if (!seg) continue;
+        if (!checkHeader(seg, AUDIT_SEG_MAGIC)) {
+            fclose(seg);
+            continue;
+        }
+        segmentPath(path, sizeof(path), dir, segs[s], "idx");
+        FILE *idx = fopen(path, "rb");
+        size_t entryCount = 0;
+        AuditIndexEntry *entries = loadIndex(idx, &entryCount);
+        if (idx) fclose(idx);
+        stats->segmentsScanned++;
+
+        uint64_t tailStart = AUDIT_HEADER_SIZE;
+        for (size_t i = 0; i < entryCount && keepGoing; i++) {
+            AuditIndexEntry *e = &entries[i];
+            tailStart = e->offset + e->length;
+            if (e->maxMicros < fromMicros || e->minMicros > toMicros ||
+                (userMask && (e->userBloom & userMask) != userMask)) {
+                stats->blocksSkipped++;
+                continue;
+            }
+            stats->blocksScanned++;
+            keepGoing = scanRange(seg, e->offset, e->length, userHash, userID,
+                                  fromMicros, toMicros, visit, ctx, stats);
+        }
+        free(entries);
+
+        // Open block that has no index entry yet
+        long size = fileSize(seg);
+        if (keepGoing && size > (long)tailStart) {
+            stats->blocksScanned++;
+            keepGoing = scanRange(seg, tailStart, (size_t)size - (size_t)tailStart, userHash, userID,
+                                  fromMicros, toMicros, visit, ctx, stats);
+        }
+        fclose(seg);
+    }
+    free(segs);
+    return keepGoing;
+}
+
+ErrorCode auditQuery(const char *dir, const char *userID, uint64_t fromMicros, uint64_t toMicros,
+                     AuditVisitor visit, void *ctx, AuditQueryStats *stats) {
+    if (!visit) return ERROR_INVALID_INPUT;
+    if (!dir) dir = AUDIT_DIR;
+    AuditQueryStats local = {0};
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+
+    if (writer.open) auditFlush();
+
+    uint64_t userHash = userID ? auditUserHash(userID) : 0;
+    uint64_t userMask = userID ? bloomBits(userHash) : 0;
+    int keepGoing = querySegments(dir, userID, userHash, userMask, fromMicros, toMicros, visit, ctx, stats);
+
+    // Prefork server workers each write their own worker-N/ subdirectory
+    DIR *d = keepGoing ? opendir(dir) : NULL;
+    struct dirent *ent;
+    while (d && keepGoing && (ent = readdir(d)) != NULL) {
+        if (strncmp(ent->d_name, "worker-", 7) != 0) continue;
+        char sub[260];
+        int written = snprintf(sub, sizeof(sub), "%s/%s", dir, ent->d_name);
+        if (written < 0 || written >= (int)sizeof(sub)) continue;
+        keepGoing = querySegments(sub, userID, userHash, userMask, fromMicros, toMicros, visit, ctx, stats);
+    }
+    if (d) closedir(d);
+    return SUCCESS;
+}
+
+static void writeJsonString(FILE *out, const char *s) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char*)s; *p; p++) {
+        switch (*p) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (*p < 0x20) fprintf(out, "\\u%04x", *p);
+                else fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static int writeNDJSONRecord(const AuditRecord *rec, void *ctx) {
+    FILE *out = (FILE*)ctx;
+    time_t secs = (time_t)(rec->epochMicros / 1000000ULL);
+    struct tm tmInfo;
+    char stamp[32] = "1970-01-01T00:00:00";
+#ifdef _WIN32
+    if (gmtime_s(&tmInfo, &secs) == 0) strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tmInfo);
+#else
+    if (gmtime_r(&secs, &tmInfo)) strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tmInfo);
+#endif
+    fprintf(out, "{\"ts_us\":%llu,\"time\":\"%s.%06uZ\",\"user\":",
+            (unsigned long long)rec->epochMicros, stamp, (unsigned)(rec->epochMicros % 1000000ULL));
+    writeJsonString(out, rec->userID);
+    fputs(",\"event\":", out);
+    writeJsonString(out, auditEventName(rec->eventCode));
+    fprintf(out, ",\"code\":%u,\"details\":", (unsigned)rec->eventCode);
+    writeJsonString(out, rec->details);
+    fputs("}\n", out);
+    return !ferror(out);
+}
+
+ErrorCode auditExportNDJSON(FILE *out, const char *dir, const char *userID,
+                            uint64_t fromMicros, uint64_t toMicros) {
+    if (!out) return ERROR_INVALID_INPUT;
+    return auditQuery(dir, userID, fromMicros, toMicros, writeNDJSONRecord, out, NULL);
+}
@@ -273,8 +273,8 @@ ErrorCode changePassword(const char *userID) {
         return ERROR_INVALID_INPUT;
     }
     hashPassword(newPass, newHash);
-    strncpy(p.passwordHash, newHash, 63);
-    p.passwordHash[63] = '\0';
+    strncpy(p.passwordHash, newHash, sizeof(p.passwordHash) - 1);
+    p.passwordHash[sizeof(p.passwordHash) - 1] = '\0';
     if (!updateUser(&p)) {
         printf("Failed to save updated password.\n");
         logEvent(userID, "Password change failed during update");
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 #ifdef _WIN32
 #include <direct.h>
 #else
@@ -10,6 +11,9 @@
 #include "../include/campus_unified.h"
 #include "../include/utils.h"
 #include "../include/student.h"
+#include "../include/grade_kernel.h"
+#include "../include/storage_engine.h"
+#include "../include/database.h"
 
 // Campus Configuration Mapping
 CampusConfig getCampusConfig(CampusType type) {
@@ -49,38 +53,335 @@ FILE* loadFileForStudent(const char* studentID, const char* mode, const char* ca
     return f;
 }
 
-// Unified Campus Data Save
+// The whole-struct layout data files had before compact records
+typedef struct {
+    char userID[20];
+    char name[MAX_LEN];
+    char instituteName[MAX_LEN];
+    char department[50];
+    CampusType campusType;
+    int subjectCount;
+    char subjects[MAX_SUBJECTS][MAX_LEN];
+    int marks[MAX_SUBJECTS];
+    int fullMarks[MAX_SUBJECTS];
+    int credits[MAX_SUBJECTS];
+    char bloodPressure[20];
+    char temperature[10];
+    char weight[10];
+    char diagnosis[MAX_LEN];
+    char roomNumber[10];
+    char floor[10];
+    char messPlan[50];
+    time_t lastUpdated;
+    int dataVersion;
+} LegacyCampusData;
+
+#define CAMPUS_FILE_MAX (sizeof(LegacyCampusData) > CAMPUS_RECORD_MAX ? sizeof(LegacyCampusData) : CAMPUS_RECORD_MAX)
+
+static int usesGrades(CampusType type) {
+    return type == CAMPUS_SCHOOL || type == CAMPUS_COLLEGE;
+}
+
+// The live variant's strings and their field sizes; returns how many
+static int variantFields(const UnifiedCampusData *data, char **fields, size_t *sizes) {
+    UnifiedCampusData *d = (UnifiedCampusData*)data;
+    switch (data->campusType) {
+        case CAMPUS_SCHOOL:
+        case CAMPUS_COLLEGE: {
+            int count = d->grades.subjectCount;
+            for (int i = 0; i < count; i++) {
+                fields[i] = d->grades.subjects[i];
+                sizes[i] = sizeof(d->grades.subjects[i]);
+            }
+            return count;
+        }
+        case CAMPUS_HOSPITAL:
+            fields[0] = d->medical.bloodPressure;  sizes[0] = sizeof(d->medical.bloodPressure);
+            fields[1] = d->medical.temperature;    sizes[1] = sizeof(d->medical.temperature);
+            fields[2] = d->medical.weight;         sizes[2] = sizeof(d->medical.weight);
+            fields[3] = d->medical.diagnosis;      sizes[3] = sizeof(d->medical.diagnosis);
+            return 4;
+        case CAMPUS_HOSTEL:
+            fields[0] = d->hostel.roomNumber;      sizes[0] = sizeof(d->hostel.roomNumber);
+            fields[1] = d->hostel.floor;           sizes[1] = sizeof(d->hostel.floor);
+            fields[2] = d->hostel.messPlan;        sizes[2] = sizeof(d->hostel.messPlan);
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+static void commonFields(const UnifiedCampusData *data, char **fields, size_t *sizes) {
+    UnifiedCampusData *d = (UnifiedCampusData*)data;
+    fields[0] = d->userID;          sizes[0] = sizeof(d->userID);
+    fields[1] = d->name;            sizes[1] = sizeof(d->name);
+    fields[2] = d->instituteName;   sizes[2] = sizeof(d->instituteName);
+    fields[3] = d->department;      sizes[3] = sizeof(d->department);
+}
+
+// Writes while it fits; returns the size either way
+static size_t putString(unsigned char *out, size_t at, size_t capacity, const char *s, size_t field) {
+    size_t n = strnlen(s, field - 1);
+    if (out && at + n + 1 <= capacity) {
+        memcpy(out + at, s, n);
+        out[at + n] = '\0';
+    }
+    return at + n + 1;
+}
+
+static size_t encodeRecord(const UnifiedCampusData *data, unsigned char *out, size_t capacity) {
+    if (!data || data->campusType <= CAMPUS_NONE || data->campusType >= CAMPUS_AMOUNT) return 0;
+    int count = usesGrades(data->campusType) ? data->grades.subjectCount : 0;
+    if (count < 0 || count > MAX_SUBJECTS) return 0;
+
+    size_t at = sizeof(CampusRecordHeader);
+    for (int i = 0; i < count; i++) {
+        if (data->grades.marks[i] < 0 || data->grades.marks[i] > 255 ||
+            data->grades.weights[i] < 0 || data->grades.weights[i] > 255) {
+            return 0;
+        }
+        if (out && at + 2 * (size_t)count <= capacity) {
+            out[at + i] = (uint8_t)data->grades.marks[i];
+            out[at + count + i] = (uint8_t)data->grades.weights[i];
+        }
+    }
+    at += 2 * (size_t)count;
+
+    char *fields[4 + MAX_SUBJECTS];
+    size_t sizes[4 + MAX_SUBJECTS];
+    commonFields(data, fields, sizes);
+    int n = 4 + variantFields(data, fields + 4, sizes + 4);
+    for (int i = 0; i < n; i++) at = putString(out, at, capacity, fields[i], sizes[i]);
+    if (at > CAMPUS_RECORD_MAX) return 0;
+
+    if (out && at <= capacity) {
+        CampusRecordHeader h;
+        memset(&h, 0, sizeof(h));
+        h.magic = CAMPUS_RECORD_MAGIC;
+        h.length = (uint16_t)at;
+        h.campusType = (uint8_t)data->campusType;
+        h.count = (uint8_t)count;
+        h.dataVersion = data->dataVersion;
+        h.lastUpdated = (int64_t)data->lastUpdated;
+        memcpy(out, &h, sizeof(h));
+    }
+    return at;
+}
+
+size_t campusRecordSize(const UnifiedCampusData *data) {
+    return encodeRecord(data, NULL, 0);
+}
+
+size_t campusRecordEncode(const UnifiedCampusData *data, void *out, size_t capacity) {
+    if (!out) return 0;
+    size_t n = encodeRecord(data, (unsigned char*)out, capacity);
+    return n <= capacity ? n : 0;
+}
+
+ErrorCode campusRecordView(const void *bytes, size_t length, CampusRecordView *view) {
+    if (!bytes || !view || length < sizeof(CampusRecordHeader)) return ERROR_INVALID_INPUT;
+    CampusRecordHeader h;
+    memcpy(&h, bytes, sizeof(h));       // the buffer need not be aligned
+    if (h.magic != CAMPUS_RECORD_MAGIC || h.length < sizeof(h) || h.length > length ||
+        h.length > CAMPUS_RECORD_MAX || h.campusType <= CAMPUS_NONE || h.campusType >= CAMPUS_AMOUNT ||
+        h.count > MAX_SUBJECTS || (!usesGrades((CampusType)h.campusType) && h.count != 0)) {
+        return ERROR_INVALID_INPUT;
+    }
+    memset(view, 0, sizeof(*view));
+    view->campusType = (CampusType)h.campusType;
+    view->count = h.count;
+    view->dataVersion = h.dataVersion;
+    view->lastUpdated = h.lastUpdated;
+    view->length = h.length;
+
+    const unsigned char *p = (const unsigned char*)bytes + sizeof(h);
+    const unsigned char *end = (const unsigned char*)bytes + h.length;
+    if ((size_t)(end - p) < 2 * (size_t)h.count) return ERROR_INVALID_INPUT;
+    view->marks = p;
+    view->weights = p + h.count;
+    p += 2 * (size_t)h.count;
+
+    // Field sizes come from a zeroed struct of the same type: each string must fit its field
+    UnifiedCampusData shape;
+    memset(&shape, 0, sizeof(shape));
+    shape.campusType = view->campusType;
+    shape.grades.subjectCount = h.count;
+    char *fields[4 + MAX_SUBJECTS];
+    size_t sizes[4 + MAX_SUBJECTS];
+    commonFields(&shape, fields, sizes);
+    int n = 4 + variantFields(&shape, fields + 4, sizes + 4);
+    const char *strings[4 + MAX_SUBJECTS];
+    for (int i = 0; i < n; i++) {
+        const unsigned char *nul = memchr(p, '\0', (size_t)(end - p));
+        if (!nul || (size_t)(nul - p) >= sizes[i]) return ERROR_INVALID_INPUT;
+        strings[i] = (const char*)p;
+        p = nul + 1;
+    }
+    if (p != end) return ERROR_INVALID_INPUT;
+
+    view->userID = strings[0];
+    view->name = strings[1];
+    view->instituteName = strings[2];
+    view->department = strings[3];
+    for (int i = 4; i < n; i++) view->strings[i - 4] = strings[i];
+    return SUCCESS;
+}
+
+ErrorCode campusRecordDecode(const CampusRecordView *view, UnifiedCampusData *data) {
+    if (!view || !data) return ERROR_INVALID_INPUT;
+    memset(data, 0, sizeof(*data));
+    data->campusType = view->campusType;
+    data->dataVersion = view->dataVersion;
+    data->lastUpdated = (time_t)view->lastUpdated;
+    if (usesGrades(view->campusType)) {
+        data->grades.subjectCount = view->count;
+        for (int i = 0; i < view->count; i++) {
+            data->grades.marks[i] = view->marks[i];
+            data->grades.weights[i] = view->weights[i];
+        }
+    }
+    char *fields[4 + MAX_SUBJECTS];
+    size_t sizes[4 + MAX_SUBJECTS];
+    commonFields(data, fields, sizes);
+    int n = 4 + variantFields(data, fields + 4, sizes + 4);
+    const char *common[4] = { view->userID, view->name, view->instituteName, view->department };
+    for (int i = 0; i < n; i++) {
+        snprintf(fields[i], sizes[i], "%s", i < 4 ? common[i] : view->strings[i - 4]);
+    }
+    return SUCCESS;
+}
+
+#define COPY_FIXED(dst, src) snprintf(dst, sizeof(dst), "%.*s", (int)sizeof(src) - 1, src)
+
+static ErrorCode decodeLegacy(const LegacyCampusData *old, UnifiedCampusData *data) {
+    if (old->campusType <= CAMPUS_NONE || old->campusType >= CAMPUS_AMOUNT) return ERROR_INVALID_INPUT;
+    memset(data, 0, sizeof(*data));
+    COPY_FIXED(data->userID, old->userID);
+    COPY_FIXED(data->name, old->name);
+    COPY_FIXED(data->instituteName, old->instituteName);
+    COPY_FIXED(data->department, old->department);
+    data->campusType = old->campusType;
+    data->lastUpdated = old->lastUpdated;
+    data->dataVersion = old->dataVersion;
+    if (usesGrades(old->campusType)) {
+        if (old->subjectCount < 0 || old->subjectCount > MAX_SUBJECTS) return ERROR_INVALID_INPUT;
+        data->grades.subjectCount = old->subjectCount;
+        for (int i = 0; i < old->subjectCount; i++) {
+            COPY_FIXED(data->grades.subjects[i], old->subjects[i]);
+            data->grades.marks[i] = old->marks[i];
+            data->grades.weights[i] = old->campusType == CAMPUS_SCHOOL ? old->fullMarks[i] : old->credits[i];
+        }
+    } else if (old->campusType == CAMPUS_HOSPITAL) {
+        COPY_FIXED(data->medical.bloodPressure, old->bloodPressure);
+        COPY_FIXED(data->medical.temperature, old->temperature);
+        COPY_FIXED(data->medical.weight, old->weight);
+        COPY_FIXED(data->medical.diagnosis, old->diagnosis);
+    } else {
+        COPY_FIXED(data->hostel.roomNumber, old->roomNumber);
+        COPY_FIXED(data->hostel.floor, old->floor);
+        COPY_FIXED(data->hostel.messPlan, old->messPlan);
+    }
+    return SUCCESS;
+}
+
+ErrorCode campusFileDecode(const void *bytes, size_t length, UnifiedCampusData *data) {
+    if (!bytes || !data) return ERROR_INVALID_INPUT;
+    uint32_t magic = 0;
+    if (length >= sizeof(magic)) memcpy(&magic, bytes, sizeof(magic));
+    if (magic == CAMPUS_RECORD_MAGIC) {
+        CampusRecordView view;
+        if (campusRecordView(bytes, length, &view) != SUCCESS || view.length != length) return ERROR_INVALID_INPUT;
+        return campusRecordDecode(&view, data);
+    }
+    if (length == sizeof(LegacyCampusData)) {
+        LegacyCampusData old;
+        memcpy(&old, bytes, sizeof(old));
+        return decodeLegacy(&old, data);
+    }
+    return ERROR_INVALID_INPUT;
+}
+
+// Campus records live in a storage engine, keyed by userID: the log engine
+// under SEGMENT_STORE_DIR unless setCampusStorage() chose another. Opened on
+// first use; a failed open is retried on the next call.
+static pthread_mutex_t campusStoreLock = PTHREAD_MUTEX_INITIALIZER;
+static StorageEngine *campusEngine = NULL;
+
+static StorageEngine *campusStore(void) {
+    pthread_mutex_lock(&campusStoreLock);
+    if (!campusEngine && storageOpenLog(SEGMENT_STORE_DIR, NULL, &campusEngine) != SUCCESS) {
+        campusEngine = NULL;
+    }
+    StorageEngine *engine = campusEngine;
+    pthread_mutex_unlock(&campusStoreLock);
+    return engine;
+}
+
+void setCampusStorage(StorageEngine *engine) {
+    pthread_mutex_lock(&campusStoreLock);
+    storageClose(campusEngine);
+    campusEngine = engine;
+    pthread_mutex_unlock(&campusStoreLock);
+}
+
+void closeCampusStore(void) {
+    setCampusStorage(NULL);
+}
+
+// Unified Campus Data Save: only the live variant, as a compact record
 ErrorCode saveUnifiedCampusData(const UnifiedCampusData* data) {
     if (!data) return ERROR_INVALID_INPUT;
     
     CampusConfig config = getCampusConfig(data->campusType);
     if (config.type == CAMPUS_NONE) return ERROR_INVALID_INPUT;
-    
-    FILE *f = loadFileForStudent(data->userID, "wb", NULL);
-    if (!f) return ERROR_FILE_IO;
-    
-    // Save unified data structure
-    size_t written = fwrite(data, sizeof(UnifiedCampusData), 1, f);
-    fclose(f);
-    
-    if (written != 1) return ERROR_FILE_IO;
+    if (data->userID[0] == '\0' || campusRecordSize(data) == 0) return ERROR_INVALID_INPUT;
+
+    StorageEngine *engine = campusStore();
+    if (!engine) {
+        printf("%s data store is unavailable\n", config.errorPrefix);
+        return ERROR_FILE_IO;
+    }
+    if (storagePutRecord(engine, data) != SUCCESS) return ERROR_FILE_IO;
     
     printf("%s data saved successfully\n", config.errorPrefix);
     return SUCCESS;
 }
 
-// Unified Campus Data Load
+// Stores a record only if the engine has none for the user (legacy imports
+// must not replace newer data)
+ErrorCode addUnifiedCampusData(const UnifiedCampusData* data) {
+    if (!data || data->userID[0] == '\0' || campusRecordSize(data) == 0) return ERROR_INVALID_INPUT;
+    StorageEngine *engine = campusStore();
+    if (!engine) return ERROR_FILE_IO;
+
+    UnifiedCampusData existing;
+    ErrorCode rc = storageGetRecord(engine, data->userID, &existing);
+    if (rc == SUCCESS) return ERROR_ALREADY_EXISTS;
+    if (rc != ERROR_NOT_FOUND) return ERROR_FILE_IO;
+    return storagePutRecord(engine, data) == SUCCESS ? SUCCESS : ERROR_FILE_IO;
+}
+
+// Unified Campus Data Load: the engine first, then a data/<id>.data file from
+// before it (compact or old layout), which is copied into the engine
 ErrorCode loadUnifiedCampusData(const char* userID, UnifiedCampusData* data) {
     if (!userID || !data) return ERROR_INVALID_INPUT;
     
+    StorageEngine *engine = campusStore();
+    ErrorCode rc = engine ? storageGetRecord(engine, userID, data) : ERROR_NOT_FOUND;
+    if (rc == SUCCESS) return SUCCESS;
+    if (rc != ERROR_NOT_FOUND) return ERROR_FILE_IO;
+    
     FILE *f = loadFileForStudent(userID, "rb", "campus");
     if (!f) return ERROR_NOT_FOUND;
     
-    size_t read = fread(data, sizeof(UnifiedCampusData), 1, f);
+    unsigned char buffer[CAMPUS_FILE_MAX + 1];
+    size_t length = fread(buffer, 1, sizeof(buffer), f);
     fclose(f);
     
-    if (read != 1) return ERROR_FILE_IO;
-    
+    if (length == 0 || length > CAMPUS_FILE_MAX) return ERROR_FILE_IO;
+    if (campusFileDecode(buffer, length, data) != SUCCESS) return ERROR_FILE_IO;
+
+    if (engine && strcmp(data->userID, userID) == 0) storagePutRecord(engine, data);
     return SUCCESS;
 }
 
@@ -93,23 +394,23 @@ ErrorCode validateCampusData(const UnifiedCampusData* data) {
     
     // Validate based on campus type
     if (config.usesGrades) {
-        if (data->subjectCount <= 0 || data->subjectCount > MAX_SUBJECTS) {
+        if (data->grades.subjectCount <= 0 || data->grades.subjectCount > MAX_SUBJECTS) {
             return ERROR_INVALID_INPUT;
         }
         
-        for (int i = 0; i < data->subjectCount; i++) {
-            if (data->marks[i] < 0 || data->marks[i] > 100) {
+        for (int i = 0; i < data->grades.subjectCount; i++) {
+            if (data->grades.marks[i] < 0 || data->grades.marks[i] > 100) {
                 return ERROR_INVALID_INPUT;
             }
             
             if (config.type == CAMPUS_SCHOOL) {
-                if (data->fullMarks[i] <= 0 || data->fullMarks[i] > 100) {
+                if (data->grades.weights[i] <= 0 || data->grades.weights[i] > 100) {
                     return ERROR_INVALID_INPUT;
                 }
             }
             
             if (config.usesCredits) {
-                if (data->credits[i] <= 0 || data->credits[i] > 10) {
+                if (data->grades.weights[i] <= 0 || data->grades.weights[i] > 10) {
                     return ERROR_INVALID_INPUT;
                 }
             }
@@ -117,13 +418,13 @@ ErrorCode validateCampusData(const UnifiedCampusData* data) {
     }
     
     if (config.usesMedicalData) {
-        if (strlen(data->bloodPressure) == 0 || strlen(data->temperature) == 0) {
+        if (strlen(data->medical.bloodPressure) == 0 || strlen(data->medical.temperature) == 0) {
             return ERROR_INVALID_INPUT;
         }
     }
     
     if (config.usesAccommodation) {
-        if (strlen(data->roomNumber) == 0 || strlen(data->floor) == 0) {
+        if (strlen(data->hostel.roomNumber) == 0 || strlen(data->hostel.floor) == 0) {
             return ERROR_INVALID_INPUT;
         }
     }
@@ -148,31 +449,31 @@ ErrorCode saveCampusData(const char* userID, CampusType campusType) {
     
     if (config.usesGrades) {
         printf("Number of %s: ", config.type == CAMPUS_SCHOOL ? "subjects" : "courses");
-        if (safeGetInt(&data.subjectCount, 1, MAX_SUBJECTS) != SUCCESS) {
+        if (safeGetInt(&data.grades.subjectCount, 1, MAX_SUBJECTS) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
-        for (int i = 0; i < data.subjectCount; i++) {
+        for (int i = 0; i < data.grades.subjectCount; i++) {
             printf("%s %d: ", config.type == CAMPUS_SCHOOL ? "Subject" : "Course", i + 1);
-            if (safeGetString(data.subjects[i], sizeof(data.subjects[i])) != SUCCESS) {
+            if (safeGetString(data.grades.subjects[i], sizeof(data.grades.subjects[i])) != SUCCESS) {
                 return ERROR_INVALID_INPUT;
             }
             
             printf("Marks: ");
-            if (safeGetInt(&data.marks[i], 0, 100) != SUCCESS) {
+            if (safeGetInt(&data.grades.marks[i], 0, 100) != SUCCESS) {
                 return ERROR_INVALID_INPUT;
             }
             
             if (config.type == CAMPUS_SCHOOL) {
                 printf("Full marks: ");
-                if (safeGetInt(&data.fullMarks[i], 1, 100) != SUCCESS) {
+                if (safeGetInt(&data.grades.weights[i], 1, 100) != SUCCESS) {
                     return ERROR_INVALID_INPUT;
                 }
             }
             
             if (config.usesCredits) {
                 printf("Credits: ");
-                if (safeGetInt(&data.credits[i], 1, 10) != SUCCESS) {
+                if (safeGetInt(&data.grades.weights[i], 1, 10) != SUCCESS) {
                     return ERROR_INVALID_INPUT;
                 }
             }
@@ -181,39 +482,39 @@ ErrorCode saveCampusData(const char* userID, CampusType campusType) {
     
     if (config.usesMedicalData) {
         printf("Blood Pressure: ");
-        if (safeGetString(data.bloodPressure, sizeof(data.bloodPressure)) != SUCCESS) {
+        if (safeGetString(data.medical.bloodPressure, sizeof(data.medical.bloodPressure)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
         printf("Temperature: ");
-        if (safeGetString(data.temperature, sizeof(data.temperature)) != SUCCESS) {
+        if (safeGetString(data.medical.temperature, sizeof(data.medical.temperature)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
         printf("Weight: ");
-        if (safeGetString(data.weight, sizeof(data.weight)) != SUCCESS) {
+        if (safeGetString(data.medical.weight, sizeof(data.medical.weight)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
         printf("Diagnosis: ");
-        if (safeGetString(data.diagnosis, sizeof(data.diagnosis)) != SUCCESS) {
+        if (safeGetString(data.medical.diagnosis, sizeof(data.medical.diagnosis)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
     }
     
     if (config.usesAccommodation) {
         printf("Room Number: ");
-        if (safeGetString(data.roomNumber, sizeof(data.roomNumber)) != SUCCESS) {
+        if (safeGetString(data.hostel.roomNumber, sizeof(data.hostel.roomNumber)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
         printf("Floor: ");
-        if (safeGetString(data.floor, sizeof(data.floor)) != SUCCESS) {
+        if (safeGetString(data.hostel.floor, sizeof(data.hostel.floor)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
         
         printf("Mess Plan: ");
-        if (safeGetString(data.messPlan, sizeof(data.messPlan)) != SUCCESS) {
+        if (safeGetString(data.hostel.messPlan, sizeof(data.hostel.messPlan)) != SUCCESS) {
             return ERROR_INVALID_INPUT;
         }
     }
@@ -238,39 +539,35 @@ ErrorCode loadCampusData(const char* userID) {
     printf("\n%s Data for %s:\n", config.errorPrefix, userID);
     
     if (config.usesGrades) {
-        int total = 0, totalFull = 0, totalCredits = 0;
-        
-        for (int i = 0; i < data.subjectCount; i++) {
+        for (int i = 0; i < data.grades.subjectCount; i++) {
             if (config.type == CAMPUS_SCHOOL) {
-                printf("%d. %s - %d/%d\n", i+1, data.subjects[i], data.marks[i], data.fullMarks[i]);
-                total += data.marks[i];
-                totalFull += data.fullMarks[i];
+                printf("%d. %s - %d/%d\n", i+1, data.grades.subjects[i], data.grades.marks[i], data.grades.weights[i]);
             } else if (config.usesCredits) {
-                printf("%d. %s - %d marks (%d credits)\n", i+1, data.subjects[i], data.marks[i], data.credits[i]);
-                total += data.marks[i] * data.credits[i];
-                totalCredits += data.credits[i];
+                printf("%d. %s - %d marks (%d credits)\n", i+1, data.grades.subjects[i], data.grades.marks[i], data.grades.weights[i]);
             }
         }
         
         if (config.type == CAMPUS_SCHOOL) {
-            printSummary(total, totalFull, data.campusType);
+            GradeSummary g = gradeStudent(GRADE_SCALE_PERCENT, data.grades.marks, data.grades.weights, data.grades.subjectCount);
+            Profile p = {0};
+            getUserByID(userID, &p);
+            printSummary(g.total, g.weight, data.campusType, p.instituteName);
         } else if (config.usesCredits) {
-            float cgpa = totalCredits > 0 ? (float)total / (totalCredits * 10.0f) : 0.0f;
-            printf("CGPA: %.2f\n", cgpa);
+            printf("CGPA: %.2f\n", gradeStudent(GRADE_SCALE_CGPA, data.grades.marks, data.grades.weights, data.grades.subjectCount).score);
         }
     }
     
     if (config.usesMedicalData) {
-        printf("Blood Pressure: %s\n", data.bloodPressure);
-        printf("Temperature: %s\n", data.temperature);
-        printf("Weight: %s\n", data.weight);
-        printf("Diagnosis: %s\n", data.diagnosis);
+        printf("Blood Pressure: %s\n", data.medical.bloodPressure);
+        printf("Temperature: %s\n", data.medical.temperature);
+        printf("Weight: %s\n", data.medical.weight);
+        printf("Diagnosis: %s\n", data.medical.diagnosis);
     }
     
     if (config.usesAccommodation) {
-        printf("Room Number: %s\n", data.roomNumber);
-        printf("Floor: %s\n", data.floor);
-        printf("Mess Plan: %s\n", data.messPlan);
+        printf("Room Number: %s\n", data.hostel.roomNumber);
+        printf("Floor: %s\n", data.hostel.floor);
+        printf("Mess Plan: %s\n", data.hostel.messPlan);
     }
     
     return SUCCESS;
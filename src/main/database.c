@@ -2,20 +2,607 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <stddef.h>
 #include "../include/database.h"
 #include "../include/config.h"
 #include "../include/utils.h"
 #include "../include/student.h"
 #include "../include/sqlite3.h"
+#include "../include/audit_segment.h"
+#include "../include/db_maintenance.h"
+#include "../include/report_cache.h"
+#include "../include/rank_engine.h"
+#include "../include/grade_kernel.h"
+#include "../include/grading_scheme.h"
+#include "../include/campus_unified.h"
+#include "../include/intern.h"
 
 static sqlite3 *db = NULL;
 static const char *DB_PATH = "data/campus.db";
 
+// getUsersByIDs statements for 1, 2, 4 ... DB_BATCH_CHUNK IDs, prepared on first use
+#define BATCH_SHAPES 9
+static sqlite3_stmt *batchStmts[BATCH_SHAPES];
+
+// Threads that called openThreadConnection() read and write through their own
+// handle (and statement cache) instead of sharing the main one
+static __thread sqlite3 *threadDb;
+static __thread sqlite3_stmt *threadBatchStmts[BATCH_SHAPES];
+
+static sqlite3 *conn(void) {
+    return threadDb ? threadDb : db;
+}
+
 // Helper to handle sqlite errors
 static void logSqlError(const char *context) {
-    if (db) {
-        printf("[Database Error] %s: %s\n", context, sqlite3_errmsg(db));
+    if (conn()) {
+        printf("[Database Error] %s: %s\n", context, sqlite3_errmsg(conn()));
+    }
+}
+
+// SQL: audit_event_code(action TEXT) -> registry code, 0 for unknown strings
+static void sqlAuditEventCode(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    if (sqlite3_value_type(argv[0]) == SQLITE_INTEGER) {
+        sqlite3_result_int(ctx, sqlite3_value_int(argv[0]));
+        return;
+    }
+    sqlite3_result_int(ctx, auditEventFromName((const char*)sqlite3_value_text(argv[0])));
+}
+
+static int auditActionIsText(void) {
+    sqlite3_stmt *stmt;
+    int isText = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA table_info(audit_log);", -1, &stmt, 0) != SQLITE_OK) return 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *name = (const char*)sqlite3_column_text(stmt, 1);
+        const char *type = (const char*)sqlite3_column_text(stmt, 2);
+        if (name && type && strcmp(name, "action") == 0) {
+            isText = strcmp(type, "TEXT") == 0;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return isText;
+}
+
+// Schema v1: audit_log.action holds an AuditEvent code instead of the action string.
+// Legacy rows are rewritten once; unknown strings become NOTE with the text kept in details.
+static ErrorCode migrateAuditLog(void) {
+    sqlite3_create_function(db, "audit_event_code", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                            NULL, sqlAuditEventCode, NULL, NULL);
+
+    sqlite3_stmt *stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (version < 1 && auditActionIsText()) {
+        const char *sql_rebuild =
+            "BEGIN IMMEDIATE;"
+            "CREATE TABLE audit_log_v1 ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "user_id TEXT, "
+            "action INTEGER NOT NULL DEFAULT 0, "
+            "details TEXT, "
+            "timestamp TEXT);"
+            "INSERT INTO audit_log_v1 (id, user_id, action, details, timestamp) "
+            "SELECT id, user_id, audit_event_code(action), "
+            "CASE WHEN audit_event_code(action) = 0 AND action IS NOT NULL AND action <> 'NOTE' "
+            "THEN action || ': ' || IFNULL(details, '') ELSE details END, "
+            "timestamp FROM audit_log;"
+            "DROP TABLE audit_log;"
+            "ALTER TABLE audit_log_v1 RENAME TO audit_log;"
+            "COMMIT;";
+        char *errMsg = 0;
+        if (sqlite3_exec(db, sql_rebuild, 0, 0, &errMsg) != SQLITE_OK) {
+            printf("SQL Error (audit migration): %s\n", errMsg);
+            sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+            return ERROR_DATABASE;
+        }
+    }
+    if (version < 1) sqlite3_exec(db, "PRAGMA user_version = 1;", 0, 0, NULL);
+
+    sqlite3_exec(db, "CREATE INDEX IF NOT EXISTS idx_audit_action ON audit_log(action);", 0, 0, NULL);
+
+    // Lookup table so ad-hoc SQL can still join codes back to names
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS audit_events (code INTEGER PRIMARY KEY, name TEXT NOT NULL);",
+                 0, 0, NULL);
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO audit_events (code, name) VALUES (?, ?);",
+                           -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_exec(db, "BEGIN;", 0, 0, NULL);
+        for (int code = 0; code < EVENT_COUNT; code++) {
+            sqlite3_bind_int(stmt, 1, code);
+            sqlite3_bind_text(stmt, 2, auditEventName((AuditEvent)code), -1, SQLITE_STATIC);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+        sqlite3_exec(db, "COMMIT;", 0, 0, NULL);
+    }
+    sqlite3_finalize(stmt);
+    return SUCCESS;
+}
+
+static void sqlContentHash(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    const void *blob = sqlite3_value_blob(argv[0]);
+    int bytes = sqlite3_value_bytes(argv[0]);
+    sqlite3_result_int64(ctx, (sqlite3_int64)reportCacheHash(REPORT_CACHE_HASH_SEED, blob, blob ? (size_t)bytes : 0));
+}
+
+static int userDataHasHash(void) {
+    sqlite3_stmt *stmt;
+    int found = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA table_info(user_data);", -1, &stmt, 0) != SQLITE_OK) return 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *name = (const char*)sqlite3_column_text(stmt, 1);
+        if (name && strcmp(name, "content_hash") == 0) found = 1;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+// Schema v2: user_data.content_hash versions each blob for the report cache.
+// Existing rows are hashed once with the same function saveUserData uses.
+static ErrorCode migrateUserDataHash(void) {
+    sqlite3_create_function(db, "content_hash", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                            NULL, sqlContentHash, NULL, NULL);
+
+    sqlite3_stmt *stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    if (version >= 2) return SUCCESS;
+
+    char *errMsg = 0;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, &errMsg) != SQLITE_OK ||
+        (!userDataHasHash() &&
+         sqlite3_exec(db, "ALTER TABLE user_data ADD COLUMN content_hash INTEGER;", 0, 0, &errMsg) != SQLITE_OK) ||
+        sqlite3_exec(db, "UPDATE user_data SET content_hash = content_hash(blob_data) WHERE content_hash IS NULL;"
+                         "PRAGMA user_version = 2;"
+                         "COMMIT;", 0, 0, &errMsg) != SQLITE_OK) {
+        printf("SQL Error (user_data migration): %s\n", errMsg ? errMsg : sqlite3_errmsg(db));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
+// ---- Marks blobs (schema v4) ----
+
+// SchoolMarks and CollegeMarks are ~1 KB structs, nearly all of it subject
+// name buffers. user_data keeps them packed, each subject as its strings.id
+// (intern.h); readers get the whole struct back. Blobs written before v4 are
+// whole structs and read as they are. content_hash is taken over the struct
+// as loadUserData returns it, so the report cache can version by either.
+#define MARKS_BLOB_MAGIC 0x314b4d43u       // "CMK1"
+
+typedef struct {
+    uint32_t subject;
+    int32_t marks;
+    int32_t extra;              // fullMarks or credits
+} PackedMark;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    PackedMark marks[MAX_SUBJECTS];
+} PackedMarks;
+
+// CollegeMarks goes through the SchoolMarks layout, credits in place of fullMarks
+_Static_assert(sizeof(SchoolMarks) == sizeof(CollegeMarks) &&
+               offsetof(SchoolMarks, fullMarks) == offsetof(CollegeMarks, credits),
+               "SchoolMarks and CollegeMarks must share a layout");
+
+static int isMarksType(const char *dataType) {
+    return strcmp(dataType, "SCHOOL_DATA") == 0 || strcmp(dataType, "COLLEGE_DATA") == 0;
+}
+
+// The caller's struct as it will read back: only the first `count` entries,
+// names cut at their NUL. 0 when `data` is not a well-formed marks struct.
+static int normalizeMarks(const void *data, size_t bytes, SchoolMarks *out) {
+    const SchoolMarks *m = (const SchoolMarks*)data;
+    if (!data || bytes != sizeof(SchoolMarks) || m->count < 0 || m->count > MAX_SUBJECTS) return 0;
+    memset(out, 0, sizeof(*out));
+    out->count = m->count;
+    for (int i = 0; i < m->count; i++) {
+        snprintf(out->subjects[i], sizeof(out->subjects[i]), "%.*s", (int)sizeof(m->subjects[i]) - 1, m->subjects[i]);
+        out->marks[i] = m->marks[i];
+        out->fullMarks[i] = m->fullMarks[i];
+    }
+    return 1;
+}
+
+// Bytes of the packed form, 0 when a name could not be interned
+static size_t packMarks(const SchoolMarks *m, PackedMarks *out) {
+    memset(out, 0, sizeof(*out));
+    out->magic = MARKS_BLOB_MAGIC;
+    out->count = (uint32_t)m->count;
+    for (int i = 0; i < m->count; i++) {
+        if (internString(m->subjects[i], &out->marks[i].subject) != SUCCESS) return 0;
+        out->marks[i].marks = m->marks[i];
+        out->marks[i].extra = m->fullMarks[i];
+    }
+    return offsetof(PackedMarks, marks) + (size_t)m->count * sizeof(PackedMark);
+}
+
+// A stored marks blob as its whole struct: packed ones are unpacked into
+// *scratch (and *bytes updated), anything else is returned as stored
+static const void *marksBlob(const void *blob, size_t *bytes, SchoolMarks *scratch) {
+    PackedMarks p;
+    if (!blob || *bytes < offsetof(PackedMarks, marks) || *bytes > sizeof(p)) return blob;
+    memcpy(&p, blob, *bytes);
+    if (p.magic != MARKS_BLOB_MAGIC || p.count > MAX_SUBJECTS ||
+        *bytes != offsetof(PackedMarks, marks) + p.count * sizeof(PackedMark)) {
+        return blob;
+    }
+    memset(scratch, 0, sizeof(*scratch));
+    scratch->count = (int)p.count;
+    for (uint32_t i = 0; i < p.count; i++) {
+        internText(p.marks[i].subject, scratch->subjects[i], sizeof(scratch->subjects[i]));
+        scratch->marks[i] = p.marks[i].marks;
+        scratch->fullMarks[i] = p.marks[i].extra;
+    }
+    *bytes = sizeof(*scratch);
+    return scratch;
+}
+
+// ---- Score statistics (schema v3) ----
+
+typedef struct {
+    const char *subject;    // "" = overall
+    int units;              // 0..STATS_STEPS of the maximum
+} StatsScore;
+
+static int statsUnits(float score, float max) {
+    float steps = score / max * STATS_STEPS;
+    if (!(steps > 0.0f)) return 0;
+    return steps >= STATS_STEPS ? STATS_STEPS : (int)(steps + 0.5f);
+}
+
+// Overall and per-subject scores of a campus blob, as the rank boards define
+// them (repeated subject names count once). Returns how many were filled.
+static int statsScores(CampusType type, const void *data, size_t bytes, StatsScore *out) {
+    int school = type == CAMPUS_SCHOOL;
+    if (!data || (!school && type != CAMPUS_COLLEGE) ||
+        bytes != (school ? sizeof(SchoolMarks) : sizeof(CollegeMarks))) {
+        return 0;
+    }
+    const SchoolMarks *sm = (const SchoolMarks*)data;
+    const CollegeMarks *cm = (const CollegeMarks*)data;
+    GradeSummary overall = school ? gradeSchoolMarks(sm) : gradeCollegeMarks(cm);
+    int n = 0;
+    out[n].subject = "";
+    out[n++].units = statsUnits(overall.score, school ? 100.0f : 10.0f);
+
+    int count = school ? sm->count : cm->count;
+    if (count > MAX_SUBJECTS) count = MAX_SUBJECTS;
+    for (int i = 0; i < count; i++) {
+        const char *subject = school ? sm->subjects[i] : cm->subjects[i];
+        if (subject[0] == '\0' || (school && sm->fullMarks[i] <= 0)) continue;
+        int repeated = 0;
+        for (int j = 1; j < n && !repeated; j++) repeated = strcmp(subject, out[j].subject) == 0;
+        if (repeated) continue;
+        out[n].subject = subject;
+        out[n++].units = statsUnits(school ? sm->marks[i] * 100.0f / sm->fullMarks[i] : (float)cm->marks[i], 100.0f);
+    }
+    return n;
+}
+
+// Adds (sign 1) or removes (sign -1) one student's blob from score_stats, on the
+// department row and the whole-institute row. Other campus types are no-ops.
+static ErrorCode statsApply(const Profile *p, const void *data, size_t bytes, int sign) {
+    StatsScore scores[MAX_SUBJECTS + 1];
+    int n = statsScores(p->campusType, data, bytes, scores);
+    if (n == 0) return SUCCESS;
+
+    const char *sql =
+        "INSERT INTO score_stats (institute, department, campus_type, subject, count, passed, sum, sum_sq, "
+        "h0, h1, h2, h3, h4, h5, h6, h7, h8, h9) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT(institute, department, campus_type, subject) DO UPDATE SET "
+        "count = count + excluded.count, passed = passed + excluded.passed, "
+        "sum = sum + excluded.sum, sum_sq = sum_sq + excluded.sum_sq, "
+        "h0 = h0 + excluded.h0, h1 = h1 + excluded.h1, h2 = h2 + excluded.h2, h3 = h3 + excluded.h3, "
+        "h4 = h4 + excluded.h4, h5 = h5 + excluded.h5, h6 = h6 + excluded.h6, h7 = h7 + excluded.h7, "
+        "h8 = h8 + excluded.h8, h9 = h9 + excluded.h9;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("statsApply");
+        return ERROR_DATABASE;
+    }
+
+    ErrorCode rc = SUCCESS;
+    const char *departments[2] = { "", p->department };
+    int rows = p->department[0] ? 2 : 1;
+    for (int d = 0; d < rows && rc == SUCCESS; d++) {
+        for (int i = 0; i < n && rc == SUCCESS; i++) {
+            sqlite3_int64 units = scores[i].units;
+            int bucket = (int)(units * STATS_BUCKETS / STATS_STEPS);
+            if (bucket >= STATS_BUCKETS) bucket = STATS_BUCKETS - 1;
+            sqlite3_bind_text(stmt, 1, p->instituteName, -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, departments[d], -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 3, (int)p->campusType);
+            sqlite3_bind_text(stmt, 4, scores[i].subject, -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 5, sign);
+            sqlite3_bind_int(stmt, 6, units * 100 >= (sqlite3_int64)STATS_PASS_PERCENT * STATS_STEPS ? sign : 0);
+            sqlite3_bind_int64(stmt, 7, sign * units);
+            sqlite3_bind_int64(stmt, 8, sign * units * units);
+            for (int h = 0; h < STATS_BUCKETS; h++) sqlite3_bind_int(stmt, 9 + h, h == bucket ? sign : 0);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                logSqlError("statsApply");
+                rc = ERROR_DATABASE;
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+// statsApply for the blob currently stored under p's campus type
+static ErrorCode statsApplyStored(const Profile *p, int sign) {
+    const char *dataType = campusDataType(p->campusType);
+    if (p->campusType != CAMPUS_SCHOOL && p->campusType != CAMPUS_COLLEGE) return SUCCESS;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT blob_data FROM user_data WHERE user_id = ? AND data_type = ?;",
+                           -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("statsApplyStored");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, p->userID, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, dataType, -1, SQLITE_STATIC);
+    ErrorCode rc = SUCCESS;
+    int step = sqlite3_step(stmt);
+    if (step == SQLITE_ROW) {
+        SchoolMarks scratch;
+        size_t bytes = (size_t)sqlite3_column_bytes(stmt, 0);
+        const void *blob = marksBlob(sqlite3_column_blob(stmt, 0), &bytes, &scratch);
+        rc = statsApply(p, blob, bytes, sign);
+    } else if (step != SQLITE_DONE) {
+        logSqlError("statsApplyStored");
+        rc = ERROR_DATABASE;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+// A write plus its derived rows (score_stats deltas) commit or roll back together. Inside a
+// caller's transaction that is a savepoint; otherwise BEGIN IMMEDIATE takes
+// the write lock up front so the read-then-write cannot hit a busy upgrade.
+// The db mutex keeps other threads on a shared connection out in between.
+static int writeBegin(void) {
+    if (!conn()) return -1;
+    sqlite3_mutex_enter(sqlite3_db_mutex(conn()));
+    int nested = !sqlite3_get_autocommit(conn());
+    if (sqlite3_exec(conn(), nested ? "SAVEPOINT db_write;" : "BEGIN IMMEDIATE;", NULL, NULL, NULL) != SQLITE_OK) {
+        logSqlError("writeBegin");
+        sqlite3_mutex_leave(sqlite3_db_mutex(conn()));
+        return -1;
+    }
+    return nested;
+}
+
+static void writeEnd(int nested, int commit) {
+    if (nested) {
+        if (!commit) sqlite3_exec(conn(), "ROLLBACK TO db_write;", NULL, NULL, NULL);
+        sqlite3_exec(conn(), "RELEASE db_write;", NULL, NULL, NULL);
+    } else {
+        sqlite3_exec(conn(), commit ? "COMMIT;" : "ROLLBACK;", NULL, NULL, NULL);
+    }
+    sqlite3_mutex_leave(sqlite3_db_mutex(conn()));
+}
+
+static void statsVisit(const UserRecord *record, void *ctx) {
+    size_t bytes = record->profile.campusType == CAMPUS_SCHOOL ? sizeof(SchoolMarks) : sizeof(CollegeMarks);
+    if (statsApply(&record->profile, &record->data, bytes, 1) != SUCCESS) *(ErrorCode*)ctx = ERROR_DATABASE;
+}
+
+// Schema v3: score_stats, filled once from the stored marks
+static ErrorCode migrateScoreStats(void) {
+    sqlite3_stmt *stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    if (version >= 3) return SUCCESS;
+
+    const char *sql_stats =
+        "BEGIN IMMEDIATE;"
+        "CREATE TABLE IF NOT EXISTS score_stats ("
+        "institute TEXT NOT NULL, "
+        "department TEXT NOT NULL, "        // '' = every department
+        "campus_type INTEGER NOT NULL, "
+        "subject TEXT NOT NULL, "           // '' = overall score
+        "count INTEGER NOT NULL, "
+        "passed INTEGER NOT NULL, "
+        "sum INTEGER NOT NULL, "            // in 1/STATS_STEPS of the maximum
+        "sum_sq INTEGER NOT NULL, "
+        "h0 INTEGER NOT NULL, h1 INTEGER NOT NULL, h2 INTEGER NOT NULL, h3 INTEGER NOT NULL, "
+        "h4 INTEGER NOT NULL, h5 INTEGER NOT NULL, h6 INTEGER NOT NULL, h7 INTEGER NOT NULL, "
+        "h8 INTEGER NOT NULL, h9 INTEGER NOT NULL, "
+        "PRIMARY KEY(institute, department, campus_type, subject)"
+        ") WITHOUT ROWID;"
+        "DELETE FROM score_stats;";
+    char *errMsg = 0;
+    if (sqlite3_exec(db, sql_stats, 0, 0, &errMsg) != SQLITE_OK) {
+        printf("SQL Error (score_stats migration): %s\n", errMsg ? errMsg : sqlite3_errmsg(db));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return ERROR_DATABASE;
+    }
+    ErrorCode rc = SUCCESS;
+    if (scanCampusRecords(CAMPUS_SCHOOL, statsVisit, &rc) != SUCCESS ||
+        scanCampusRecords(CAMPUS_COLLEGE, statsVisit, &rc) != SUCCESS || rc != SUCCESS ||
+        sqlite3_exec(db, "PRAGMA user_version = 3; COMMIT;", 0, 0, NULL) != SQLITE_OK) {
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
+// users as of schema v4: institute, department and subject names are
+// strings.id (intern.h), 0 for "", NULL for an unused subject slot
+#define USERS_TABLE_COLUMNS \
+    "user_id TEXT PRIMARY KEY, " \
+    "name TEXT, " \
+    "institute_id INTEGER, " \
+    "department_id INTEGER, " \
+    "campus_type INTEGER, " \
+    "data_count INTEGER, " \
+    "email TEXT, " \
+    "mobile TEXT, " \
+    "password_hash TEXT, " \
+    "field0 INTEGER, field1 INTEGER, field2 INTEGER, field3 INTEGER, field4 INTEGER, " \
+    "field5 INTEGER, field6 INTEGER, field7 INTEGER, field8 INTEGER, field9 INTEGER"
+
+static int usersHasTextNames(void) {
+    sqlite3_stmt *stmt;
+    int found = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA table_info(users);", -1, &stmt, 0) != SQLITE_OK) return 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *name = (const char*)sqlite3_column_text(stmt, 1);
+        if (name && strcmp(name, "institute_name") == 0) found = 1;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+// Rewrites each whole-struct marks blob packed, with its content_hash
+static ErrorCode packStoredMarks(void) {
+    char sql[200];
+    snprintf(sql, sizeof(sql), "SELECT rowid, blob_data FROM user_data "
+             "WHERE data_type IN ('SCHOOL_DATA', 'COLLEGE_DATA') AND length(blob_data) = %zu;", sizeof(SchoolMarks));
+    sqlite3_stmt *select, *update;
+    if (sqlite3_prepare_v2(db, sql, -1, &select, 0) != SQLITE_OK) return ERROR_DATABASE;
+    if (sqlite3_prepare_v2(db, "UPDATE user_data SET blob_data = ?, content_hash = ? WHERE rowid = ?;",
+                           -1, &update, 0) != SQLITE_OK) {
+        sqlite3_finalize(select);
+        return ERROR_DATABASE;
+    }
+    ErrorCode rc = SUCCESS;
+    int step = SQLITE_DONE;
+    while (rc == SUCCESS && (step = sqlite3_step(select)) == SQLITE_ROW) {
+        SchoolMarks marks;
+        PackedMarks packed;
+        size_t bytes;
+        if (!normalizeMarks(sqlite3_column_blob(select, 1), (size_t)sqlite3_column_bytes(select, 1), &marks) ||
+            (bytes = packMarks(&marks, &packed)) == 0) {
+            continue;       // left whole; still readable
+        }
+        sqlite3_bind_blob(update, 1, &packed, (int)bytes, SQLITE_STATIC);
+        sqlite3_bind_int64(update, 2, (sqlite3_int64)reportCacheHash(REPORT_CACHE_HASH_SEED, &marks, sizeof(marks)));
+        sqlite3_bind_int64(update, 3, sqlite3_column_int64(select, 0));
+        if (sqlite3_step(update) != SQLITE_DONE) rc = ERROR_DATABASE;
+        sqlite3_reset(update);
+    }
+    if (rc == SUCCESS && step != SQLITE_DONE) rc = ERROR_DATABASE;
+    sqlite3_finalize(update);
+    sqlite3_finalize(select);
+    return rc;
+}
+
+// Schema v4: users names become strings.id and marks blobs are packed.
+// Earlier migrations run first against the text columns, which
+// readProfileRow still understands.
+static ErrorCode migrateInternedNames(void) {
+    sqlite3_stmt *stmt;
+    int version = 0;
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    if (version >= 4) return SUCCESS;
+
+    char *errMsg = 0;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", 0, 0, &errMsg) != SQLITE_OK) {
+        printf("SQL Error (users migration): %s\n", errMsg ? errMsg : sqlite3_errmsg(db));
+        sqlite3_free(errMsg);
+        return ERROR_DATABASE;
+    }
+
+    ErrorCode rc = SUCCESS;
+    if (usersHasTextNames()) {
+        static const char *const names[] = { "institute_name", "department", "field0", "field1", "field2", "field3",
+                                             "field4", "field5", "field6", "field7", "field8", "field9" };
+        char sql[4096];
+        size_t len = (size_t)snprintf(sql, sizeof(sql), "INSERT OR IGNORE INTO strings (text) SELECT v FROM (");
+        for (size_t i = 0; i < 12; i++) {
+            len += (size_t)snprintf(sql + len, sizeof(sql) - len, "%sSELECT %s AS v FROM users",
+                                    i ? " UNION " : "", names[i]);
+        }
+        len += (size_t)snprintf(sql + len, sizeof(sql) - len,
+                                ") WHERE v IS NOT NULL AND v <> '';"
+                                "CREATE TABLE users_v4 (" USERS_TABLE_COLUMNS ");"
+                                "INSERT INTO users_v4 SELECT user_id, name");
+        for (size_t i = 0; i < 12; i++) {
+            const char *column = names[i];
+            len += (size_t)snprintf(sql + len, sizeof(sql) - len,
+                                    ", CASE WHEN %s IS NULL THEN NULL WHEN %s = '' THEN 0 "
+                                    "ELSE (SELECT id FROM strings WHERE text = %s) END%s",
+                                    column, column, column,
+                                    i == 1 ? ", campus_type, data_count, email, mobile, password_hash" : "");
+        }
+        snprintf(sql + len, sizeof(sql) - len,
+                 " FROM users;"
+                 "DROP TABLE users;"
+                 "ALTER TABLE users_v4 RENAME TO users;");
+        if (sqlite3_exec(db, sql, 0, 0, &errMsg) != SQLITE_OK) rc = ERROR_DATABASE;
+    }
+    if (rc == SUCCESS && packStoredMarks() != SUCCESS) rc = ERROR_DATABASE;
+    if (rc == SUCCESS && sqlite3_exec(db, "PRAGMA user_version = 4; COMMIT;", 0, 0, &errMsg) != SQLITE_OK) {
+        rc = ERROR_DATABASE;
+    }
+    if (rc != SUCCESS) {
+        printf("SQL Error (users migration): %s\n", errMsg ? errMsg : sqlite3_errmsg(db));
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
     }
+    return rc;
+}
+
+ErrorCode getScoreStats(const char *institute, const char *department, CampusType type,
+                        const char *subject, ScoreStats *stats) {
+    maintenanceNoteActivity();
+    if (!institute || !stats) return ERROR_INVALID_INPUT;
+    memset(stats, 0, sizeof(*stats));
+    if (!conn()) return ERROR_DATABASE;
+
+    const char *sql = "SELECT count, passed, sum, sum_sq, h0, h1, h2, h3, h4, h5, h6, h7, h8, h9 "
+                      "FROM score_stats WHERE institute = ? AND department = ? AND campus_type = ? AND subject = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("getScoreStats");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, institute, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, department ? department : "", -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, (int)type);
+    sqlite3_bind_text(stmt, 4, subject ? subject : "", -1, SQLITE_STATIC);
+
+    ErrorCode rc = ERROR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int64(stmt, 0) > 0) {
+        double count = (double)sqlite3_column_int64(stmt, 0);
+        double scale = (type == CAMPUS_COLLEGE && (!subject || !subject[0]) ? 10.0 : 100.0) / STATS_STEPS;
+        double mean = (double)sqlite3_column_int64(stmt, 2) / count;
+        double variance = (double)sqlite3_column_int64(stmt, 3) / count - mean * mean;
+        stats->count = (long)count;
+        stats->mean = (float)(mean * scale);
+        stats->stddev = variance > 0.0 ? (float)(sqrt(variance) * scale) : 0.0f;
+        stats->passRate = (float)(sqlite3_column_int64(stmt, 1) * 100.0 / count);
+        for (int h = 0; h < STATS_BUCKETS; h++) stats->histogram[h] = (long)sqlite3_column_int64(stmt, 4 + h);
+        rc = SUCCESS;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
 }
 
 ErrorCode initDatabase(void) {
@@ -31,6 +618,12 @@ ErrorCode initDatabase(void) {
         printf("Can't open database: %s\n", sqlite3_errmsg(db));
         return ERROR_DATABASE;
     }
+    // Other connections and processes (prefork workers, batch, migrate) write too
+    sqlite3_busy_timeout(db, DB_THREAD_BUSY_TIMEOUT_MS);
+
+    // Free pages are reclaimed in small steps by the maintenance thread.
+    // Only takes effect on a new database (before the first table exists).
+    sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL;", NULL, NULL, NULL);
 
     // Enable WAL mode for concurrency and safety
     sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL);
@@ -38,25 +631,13 @@ ErrorCode initDatabase(void) {
 
     // Create Tables
     const char *sql_users = 
-        "CREATE TABLE IF NOT EXISTS users ("
-        "user_id TEXT PRIMARY KEY, "
-        "name TEXT, "
-        "institute_name TEXT, "
-        "department TEXT, "
-        "campus_type INTEGER, "
-        "data_count INTEGER, "
-        "email TEXT, "
-        "mobile TEXT, "
-        "password_hash TEXT, "
-        "field0 TEXT, field1 TEXT, field2 TEXT, field3 TEXT, field4 TEXT, "
-        "field5 TEXT, field6 TEXT, field7 TEXT, field8 TEXT, field9 TEXT"
-        ");";
+        "CREATE TABLE IF NOT EXISTS users (" USERS_TABLE_COLUMNS ");";
 
     const char *sql_audit = 
         "CREATE TABLE IF NOT EXISTS audit_log ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
         "user_id TEXT, "
-        "action TEXT, "
+        "action INTEGER NOT NULL DEFAULT 0, "   // AuditEvent code, see audit_events.h
         "details TEXT, "
         "timestamp TEXT"
         ");";
@@ -66,6 +647,7 @@ ErrorCode initDatabase(void) {
         "user_id TEXT, "
         "data_type TEXT, "
         "blob_data BLOB, "
+        "content_hash INTEGER, "      // reportCacheHash(blob_data), see migrateUserDataHash
         "PRIMARY KEY(user_id, data_type)"
         ");";
 
@@ -94,10 +676,93 @@ ErrorCode initDatabase(void) {
         ");";
     sqlite3_exec(db, sql_attempts, 0, 0, NULL);
 
+    // Versioned grading scheme specs and the results of the last re-grade
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS grading_schemes ("
+                     "institute TEXT NOT NULL, "        // '' = default for every institute
+                     "version INTEGER NOT NULL, "
+                     "spec TEXT NOT NULL, "
+                     "created TEXT, "
+                     "PRIMARY KEY(institute, version));", 0, 0, NULL);
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS grade_results ("
+                     "user_id TEXT PRIMARY KEY, "
+                     "institute TEXT, "
+                     "campus_type INTEGER, "
+                     "scheme_version INTEGER, "
+                     "percent REAL, "
+                     "gpa REAL, "
+                     "grade TEXT, "
+                     "passed INTEGER, "
+                     "graded_at TEXT);", 0, 0, NULL);
+
+    // Compact campus records (campus_unified.h) when SQLite is the storage engine
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS campus_records ("
+                     "user_id TEXT PRIMARY KEY, "
+                     "record BLOB NOT NULL) WITHOUT ROWID;", 0, 0, NULL);
+
+    // Account locks (previously data/lock_{userID}.dat) and how far each
+    // legacy file import has got (migrate.h)
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS account_locks ("
+                     "user_id TEXT PRIMARY KEY, "
+                     "expiry INTEGER NOT NULL);", 0, 0, NULL);
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS import_checkpoints ("
+                     "source TEXT PRIMARY KEY, "
+                     "last_name TEXT NOT NULL);", 0, 0, NULL);
+
+    // Interned institute, department and subject names (intern.h)
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS strings ("
+                     "id INTEGER PRIMARY KEY, "
+                     "text TEXT NOT NULL UNIQUE);", 0, 0, NULL);
+
+    if (migrateAuditLog() != SUCCESS) {
+        printf("Warning: audit_log migration failed\n");
+    }
+    if (migrateUserDataHash() != SUCCESS) {
+        printf("Warning: user_data migration failed\n");
+    }
+    if (migrateScoreStats() != SUCCESS) {
+        printf("Warning: score_stats migration failed\n");
+    }
+    if (migrateInternedNames() != SUCCESS) {
+        printf("Warning: users migration failed\n");
+    }
+
+    // Whole-institute report runs enumerate users by institute and campus type
+    sqlite3_exec(db, "CREATE INDEX IF NOT EXISTS idx_users_institute ON users(institute_id, campus_type, user_id);",
+                 0, 0, NULL);
+
+    // Checkpoints happen off the request path; the autocheckpoint stays only as a safety net
+    MaintenanceConfig maintenance = maintenanceDefaultConfig();
+    maintenance.dbPath = DB_PATH;
+    if (maintenanceStart(&maintenance) == SUCCESS) {
+        sqlite3_exec(db, "PRAGMA wal_autocheckpoint=10000;", NULL, NULL, NULL);
+    } else {
+        printf("Warning: database maintenance thread unavailable\n");
+    }
+
+    // Binary audit segments sit next to the audit_log table
+    if (auditOpen(AUDIT_DIR) != SUCCESS) {
+        printf("Warning: binary audit log unavailable\n");
+    }
+
+    if (reportCacheOpen(REPORT_CACHE_DIR, REPORT_CACHE_BUDGET) != SUCCESS) {
+        printf("Warning: report cache unavailable\n");
+    }
+
     return SUCCESS;
 }
 
 ErrorCode closeDatabase(void) {
+    maintenanceStop();
+    auditClose();
+    reportCacheClose();
+    rankReset();
+    gradingSchemesReset();
+    closeCampusStore();
+    internReset();
+    for (int i = 0; i < BATCH_SHAPES; i++) {
+        sqlite3_finalize(batchStmts[i]);
+        batchStmts[i] = NULL;
+    }
     if (db) {
         sqlite3_close(db);
         db = NULL;
@@ -105,76 +770,143 @@ ErrorCode closeDatabase(void) {
     return SUCCESS;
 }
 
+ErrorCode openThreadConnection(void) {
+    if (threadDb) return SUCCESS;
+    if (!db) return ERROR_DATABASE;     // the schema comes from initDatabase
+    sqlite3 *handle = NULL;
+    if (sqlite3_open_v2(DB_PATH, &handle, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+        printf("[Database Error] thread connection: %s\n", handle ? sqlite3_errmsg(handle) : "out of memory");
+        sqlite3_close(handle);
+        return ERROR_DATABASE;
+    }
+    sqlite3_busy_timeout(handle, DB_THREAD_BUSY_TIMEOUT_MS);
+    sqlite3_exec(handle, "PRAGMA synchronous=NORMAL;", NULL, NULL, NULL);
+    threadDb = handle;
+    return SUCCESS;
+}
+
+void closeThreadConnection(void) {
+    if (!threadDb) return;
+    for (int i = 0; i < BATCH_SHAPES; i++) {
+        sqlite3_finalize(threadBatchStmts[i]);
+        threadBatchStmts[i] = NULL;
+    }
+    sqlite3_close(threadDb);
+    threadDb = NULL;
+}
+
+// A profile's interned columns
+typedef struct {
+    uint32_t institute;
+    uint32_t department;
+    uint32_t fields[MAX_SUBJECTS];
+} ProfileNames;
+
+static ErrorCode internProfile(const Profile *p, ProfileNames *names) {
+    memset(names, 0, sizeof(*names));
+    ErrorCode rc = internString(p->instituteName, &names->institute);
+    if (rc == SUCCESS) rc = internString(p->department, &names->department);
+    for (int i = 0; i < p->dataCount && i < MAX_SUBJECTS && rc == SUCCESS; i++) {
+        rc = internString(p->dataFields[i], &names->fields[i]);
+    }
+    return rc;
+}
+
+// Institute and department at `nameCol`, `nameCol` + 1; subject slots from
+// `fieldCol`, NULL past dataCount
+static void bindProfileNames(sqlite3_stmt *stmt, int nameCol, int fieldCol, const Profile *p,
+                             const ProfileNames *names) {
+    sqlite3_bind_int64(stmt, nameCol, names->institute);
+    sqlite3_bind_int64(stmt, nameCol + 1, names->department);
+    for (int i = 0; i < MAX_SUBJECTS; i++) {
+        if (i < p->dataCount) {
+            sqlite3_bind_int64(stmt, fieldCol + i, names->fields[i]);
+        } else {
+            sqlite3_bind_null(stmt, fieldCol + i);
+        }
+    }
+}
+
 ErrorCode createUser(const Profile *profile) {
+    maintenanceNoteActivity();
     if (!profile) return ERROR_INVALID_INPUT;
+    ProfileNames names;
+    if (internProfile(profile, &names) != SUCCESS) return ERROR_DATABASE;
 
-    const char *sql = "INSERT INTO users (user_id, name, institute_name, department, campus_type, data_count, email, mobile, password_hash, "
+    const char *sql = "INSERT INTO users (user_id, name, institute_id, department_id, campus_type, data_count, email, mobile, password_hash, "
                       "field0, field1, field2, field3, field4, field5, field6, field7, field8, field9) "
                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
         logSqlError("Prepare createUser");
         return ERROR_DATABASE;
     }
 
     sqlite3_bind_text(stmt, 1, profile->userID, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, profile->name, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, profile->instituteName, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, profile->department, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 5, profile->campusType);
     sqlite3_bind_int(stmt, 6, profile->dataCount);
     sqlite3_bind_text(stmt, 7, profile->email, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 8, profile->mobile, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 9, profile->passwordHash, -1, SQLITE_STATIC);
-
-    for (int i = 0; i < MAX_SUBJECTS; i++) {
-        if (i < profile->dataCount) {
-            sqlite3_bind_text(stmt, 10 + i, profile->dataFields[i], -1, SQLITE_STATIC);
-        } else {
-            sqlite3_bind_null(stmt, 10 + i);
-        }
-    }
+    bindProfileNames(stmt, 3, 10, profile, &names);
 
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
+    if (rc == SQLITE_CONSTRAINT) return ERROR_ALREADY_EXISTS;     // user ID taken
     if (rc != SQLITE_DONE) {
         logSqlError("Step createUser");
-        return ERROR_DATABASE; // Could be duplicate key
+        return ERROR_DATABASE;
     }
 
-    logActivity(profile->userID, "USER_CREATED", "New user registered");
+    logActivity(profile->userID, EVENT_USER_CREATED, "New user registered");
     return SUCCESS;
 }
 
+#define USER_COLUMNS 19   // users: 9 profile columns + field0..field9
+
+// Fills a Profile from the users columns starting at `col` (SELECT * order).
+// Name columns hold strings.id; text is still accepted for the v3 layout,
+// which earlier migrations read before migrateInternedNames converts it.
+static void readProfileRow(sqlite3_stmt *stmt, int col, Profile *profile) {
+    memset(profile, 0, sizeof(Profile));
+    const char *text;
+#define COPY_COLUMN(dst, i) \
+    if ((text = (const char*)sqlite3_column_text(stmt, col + (i))) != NULL) strncpy(dst, text, sizeof(dst) - 1)
+#define NAME_COLUMN(dst, i) \
+    if (sqlite3_column_type(stmt, col + (i)) == SQLITE_INTEGER) \
+        internText((uint32_t)sqlite3_column_int64(stmt, col + (i)), dst, sizeof(dst)); \
+    else COPY_COLUMN(dst, i)
+    COPY_COLUMN(profile->userID, 0);
+    COPY_COLUMN(profile->name, 1);
+    NAME_COLUMN(profile->instituteName, 2);
+    NAME_COLUMN(profile->department, 3);
+    profile->campusType = sqlite3_column_int(stmt, col + 4);
+    profile->dataCount = sqlite3_column_int(stmt, col + 5);
+    COPY_COLUMN(profile->email, 6);
+    COPY_COLUMN(profile->mobile, 7);
+    COPY_COLUMN(profile->passwordHash, 8);
+    for (int i = 0; i < MAX_SUBJECTS; i++) {
+        NAME_COLUMN(profile->dataFields[i], 9 + i);
+    }
+#undef NAME_COLUMN
+#undef COPY_COLUMN
+}
+
 ErrorCode getUserByID(const char *userID, Profile *profile) {
+    maintenanceNoteActivity();
     if (!userID || !profile) return 0; // Return 0 as failure per original interface
 
     const char *sql = "SELECT * FROM users WHERE user_id = ?;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) return 0;
 
     sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        memset(profile, 0, sizeof(Profile));
-        strncpy(profile->userID, (const char*)sqlite3_column_text(stmt, 0), sizeof(profile->userID)-1);
-        strncpy(profile->name, (const char*)sqlite3_column_text(stmt, 1), sizeof(profile->name)-1);
-        strncpy(profile->instituteName, (const char*)sqlite3_column_text(stmt, 2), sizeof(profile->instituteName)-1);
-        strncpy(profile->department, (const char*)sqlite3_column_text(stmt, 3), sizeof(profile->department)-1);
-        profile->campusType = sqlite3_column_int(stmt, 4);
-        profile->dataCount = sqlite3_column_int(stmt, 5);
-        strncpy(profile->email, (const char*)sqlite3_column_text(stmt, 6), sizeof(profile->email)-1);
-        strncpy(profile->mobile, (const char*)sqlite3_column_text(stmt, 7), sizeof(profile->mobile)-1);
-        strncpy(profile->passwordHash, (const char*)sqlite3_column_text(stmt, 8), sizeof(profile->passwordHash)-1);
-
-        for (int i = 0; i < MAX_SUBJECTS; i++) {
-             const char *field = (const char*)sqlite3_column_text(stmt, 9 + i);
-             if (field) {
-                 strncpy(profile->dataFields[i], field, MAX_LEN-1);
-             }
-        }
+        readProfileRow(stmt, 0, profile);
         sqlite3_finalize(stmt);
         return 1; // Success
     }
@@ -183,45 +915,397 @@ ErrorCode getUserByID(const char *userID, Profile *profile) {
     return 0; // Not found
 }
 
+// SELECT for `n` IDs: the VALUES list carries each ID's position so rows map
+// straight back to the caller's array, and the campus blob comes from the same join.
+static sqlite3_stmt *prepareBatch(size_t n) {
+    size_t size = 512 + n * 12;
+    char *sql = (char*)malloc(size);
+    if (!sql) return NULL;
+    size_t len = (size_t)snprintf(sql, size, "WITH ids(pos, id) AS (VALUES ");
+    for (size_t i = 0; i < n; i++) {
+        len += (size_t)snprintf(sql + len, size - len, "%s(%zu,?)", i ? "," : "", i);
+    }
+    snprintf(sql + len, size - len,
+             ") SELECT ids.pos, u.*, d.blob_data FROM ids "
+             "JOIN users u ON u.user_id = ids.id "
+             "LEFT JOIN user_data d ON d.user_id = u.user_id AND d.data_type = "
+             "CASE u.campus_type WHEN %d THEN 'SCHOOL_DATA' WHEN %d THEN 'COLLEGE_DATA' "
+             "WHEN %d THEN 'HOSPITAL_DATA' WHEN %d THEN 'HOSTEL_DATA' END;",
+             CAMPUS_SCHOOL, CAMPUS_COLLEGE, CAMPUS_HOSPITAL, CAMPUS_HOSTEL);
+    sqlite3_stmt *stmt = NULL;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("prepareBatch");
+        stmt = NULL;
+    }
+    free(sql);
+    return stmt;
+}
+
+static void decodeCampusBlob(sqlite3_stmt *stmt, int col, UserRecord *rec) {
+    const void *blob = sqlite3_column_blob(stmt, col);
+    size_t bytes = (size_t)sqlite3_column_bytes(stmt, col);
+    size_t expected;
+    switch (rec->profile.campusType) {
+        case CAMPUS_SCHOOL:   expected = sizeof(SchoolMarks); break;
+        case CAMPUS_COLLEGE:  expected = sizeof(CollegeMarks); break;
+        case CAMPUS_HOSPITAL:
+        case CAMPUS_HOSTEL:   expected = sizeof(FieldValues); break;
+        default: return;
+    }
+    if (expected == sizeof(SchoolMarks)) blob = marksBlob(blob, &bytes, &rec->data.school);
+    if (!blob || bytes != expected) return;
+    if (blob != &rec->data) memcpy(&rec->data, blob, bytes);
+    rec->hasData = 1;
+}
+
+// Smallest cached shape that holds n IDs; unused parameters stay NULL and match nothing
+static sqlite3_stmt *batchStatement(size_t n) {
+    int shape = 0;
+    while (shape < BATCH_SHAPES - 1 && ((size_t)1 << shape) < n) shape++;
+    sqlite3_stmt **cache = threadDb ? threadBatchStmts : batchStmts;
+    if (!cache[shape]) cache[shape] = prepareBatch((size_t)1 << shape);
+    return cache[shape];
+}
+
+ErrorCode getUsersByIDs(const char *const *userIDs, size_t count, UserRecord *records) {
+    maintenanceNoteActivity();
+    if (!userIDs || !records) return ERROR_INVALID_INPUT;
+    memset(records, 0, count * sizeof(UserRecord));
+    if (count == 0) return SUCCESS;
+    if (!conn()) return ERROR_DATABASE;
+
+    // The main connection is shared by every thread; holding its mutex keeps other
+    // callers' statements out of this transaction and guards the statement cache.
+    // A thread's own connection is opened NOMUTEX and has no mutex (a no-op here).
+    sqlite3_mutex *mutex = sqlite3_db_mutex(conn());
+    sqlite3_mutex_enter(mutex);
+    // A single statement is already its own read transaction
+    int explicitTxn = count > DB_BATCH_CHUNK;
+    if (explicitTxn && sqlite3_exec(conn(), "BEGIN;", NULL, NULL, NULL) != SQLITE_OK) {
+        logSqlError("getUsersByIDs");
+        sqlite3_mutex_leave(mutex);
+        return ERROR_DATABASE;
+    }
+
+    ErrorCode rc = SUCCESS;
+    for (size_t base = 0; base < count && rc == SUCCESS; base += DB_BATCH_CHUNK) {
+        size_t n = count - base < DB_BATCH_CHUNK ? count - base : DB_BATCH_CHUNK;
+        sqlite3_stmt *stmt = batchStatement(n);
+        if (!stmt) {
+            rc = ERROR_DATABASE;
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (userIDs[base + i]) sqlite3_bind_text(stmt, (int)i + 1, userIDs[base + i], -1, SQLITE_STATIC);
+        }
+        int step;
+        while ((step = sqlite3_step(stmt)) == SQLITE_ROW) {
+            size_t pos = (size_t)sqlite3_column_int64(stmt, 0);
+            if (pos >= n) continue;
+            UserRecord *rec = &records[base + pos];
+            rec->found = 1;
+            readProfileRow(stmt, 1, &rec->profile);
+            decodeCampusBlob(stmt, 1 + USER_COLUMNS, rec);
+        }
+        if (step != SQLITE_DONE) {
+            logSqlError("getUsersByIDs");
+            rc = ERROR_DATABASE;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    if (explicitTxn) sqlite3_exec(conn(), "COMMIT;", NULL, NULL, NULL);
+    sqlite3_mutex_leave(mutex);
+    return rc;
+}
+
+ErrorCode scanCampusRecords(CampusType type, void (*visit)(const UserRecord *record, void *ctx), void *ctx) {
+    maintenanceNoteActivity();
+    const char *dataType = campusDataType(type);
+    if (!dataType || !visit) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+
+    const char *sql = "SELECT u.*, d.blob_data FROM users u "
+                      "JOIN user_data d ON d.user_id = u.user_id AND d.data_type = ? "
+                      "WHERE u.campus_type = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("scanCampusRecords");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, dataType, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, (int)type);
+
+    UserRecord *rec = (UserRecord*)malloc(sizeof(UserRecord));
+    if (!rec) {
+        sqlite3_finalize(stmt);
+        return ERROR_MEMORY;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        memset(rec, 0, sizeof(*rec));
+        rec->found = 1;
+        readProfileRow(stmt, 0, &rec->profile);
+        decodeCampusBlob(stmt, USER_COLUMNS, rec);
+        if (rec->hasData) visit(rec, ctx);
+    }
+    free(rec);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        logSqlError("scanCampusRecords");
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
+ErrorCode listUsersByInstitute(const char *instituteName, CampusType type,
+                               char (**userIDs)[20], size_t *count) {
+    maintenanceNoteActivity();
+    if (!userIDs || !count) return ERROR_INVALID_INPUT;
+    *userIDs = NULL;
+    *count = 0;
+    if (!conn()) return ERROR_DATABASE;
+
+    // A name that was never interned has no users; the rest compare as integers
+    uint32_t institute = 0;
+    if (instituteName) {
+        ErrorCode found = internFind(instituteName, &institute);
+        if (found != SUCCESS) return found == ERROR_NOT_FOUND ? SUCCESS : found;
+    }
+    const char *sql = "SELECT user_id FROM users WHERE (?1 IS NULL OR institute_id = ?1) AND campus_type = ?2 "
+                      "ORDER BY user_id;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("listUsersByInstitute");
+        return ERROR_DATABASE;
+    }
+    if (instituteName) sqlite3_bind_int64(stmt, 1, institute);
+    sqlite3_bind_int(stmt, 2, (int)type);
+
+    ErrorCode result = SUCCESS;
+    size_t cap = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (*count == cap) {
+            size_t grown = cap ? cap * 2 : 256;
+            char (*p)[20] = realloc(*userIDs, grown * sizeof(**userIDs));
+            if (!p) {
+                result = ERROR_MEMORY;
+                break;
+            }
+            *userIDs = p;
+            cap = grown;
+        }
+        const char *id = (const char*)sqlite3_column_text(stmt, 0);
+        snprintf((*userIDs)[(*count)++], sizeof(**userIDs), "%s", id ? id : "");
+    }
+    if (result == SUCCESS && rc != SQLITE_DONE) {
+        logSqlError("listUsersByInstitute");
+        result = ERROR_DATABASE;
+    }
+    sqlite3_finalize(stmt);
+    if (result != SUCCESS) {
+        free(*userIDs);
+        *userIDs = NULL;
+        *count = 0;
+    }
+    return result;
+}
+
+ErrorCode addGradingScheme(const char *institute, const char *spec, int *version) {
+    maintenanceNoteActivity();
+    if (!institute || !spec || !version) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+
+    const char *sql = "INSERT INTO grading_schemes (institute, version, spec, created) "
+                      "SELECT ?1, COALESCE(MAX(version), 0) + 1, ?2, datetime('now') "
+                      "FROM grading_schemes WHERE institute = ?1 RETURNING version;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("addGradingScheme");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, institute, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, spec, -1, SQLITE_STATIC);
+    ErrorCode rc = ERROR_DATABASE;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *version = sqlite3_column_int(stmt, 0);
+        rc = sqlite3_step(stmt) == SQLITE_DONE ? SUCCESS : ERROR_DATABASE;
+    }
+    if (rc != SUCCESS) logSqlError("addGradingScheme");
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+ErrorCode scanGradingSchemes(void (*visit)(const char *institute, int version, const char *spec, void *ctx),
+                             void *ctx) {
+    if (!visit) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    // A bare column next to MAX() comes from the row holding the maximum
+    const char *sql = "SELECT institute, MAX(version), spec FROM grading_schemes GROUP BY institute;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("scanGradingSchemes");
+        return ERROR_DATABASE;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *institute = (const char*)sqlite3_column_text(stmt, 0);
+        const char *spec = (const char*)sqlite3_column_text(stmt, 2);
+        visit(institute ? institute : "", sqlite3_column_int(stmt, 1), spec ? spec : "", ctx);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        logSqlError("scanGradingSchemes");
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
+ErrorCode getGradingSchemesVersion(int64_t *version) {
+    if (!version) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    // Rows are only ever added, so the last rowid moves with every new version
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT COALESCE(MAX(rowid), 0) FROM grading_schemes;", -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("getGradingSchemesVersion");
+        return ERROR_DATABASE;
+    }
+    ErrorCode rc = ERROR_DATABASE;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *version = sqlite3_column_int64(stmt, 0);
+        rc = SUCCESS;
+    }
+    if (rc != SUCCESS) logSqlError("getGradingSchemesVersion");
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+ErrorCode saveGradeResults(const StoredGrade *rows, size_t count) {
+    maintenanceNoteActivity();
+    if (!rows && count > 0) return ERROR_INVALID_INPUT;
+    if (count == 0) return SUCCESS;
+
+    int nested = writeBegin();
+    if (nested < 0) return ERROR_DATABASE;
+    const char *sql = "REPLACE INTO grade_results (user_id, institute, campus_type, scheme_version, percent, gpa, "
+                      "grade, passed, graded_at) VALUES (?, ?, ?, ?, ?, ?, ?, ?, datetime('now'));";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("saveGradeResults");
+        writeEnd(nested, 0);
+        return ERROR_DATABASE;
+    }
+    ErrorCode rc = SUCCESS;
+    for (size_t i = 0; i < count && rc == SUCCESS; i++) {
+        sqlite3_bind_text(stmt, 1, rows[i].userID, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, rows[i].institute, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 3, (int)rows[i].campusType);
+        sqlite3_bind_int(stmt, 4, rows[i].schemeVersion);
+        sqlite3_bind_double(stmt, 5, rows[i].percent);
+        sqlite3_bind_double(stmt, 6, rows[i].gpa);
+        sqlite3_bind_text(stmt, 7, rows[i].grade, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 8, rows[i].passed);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            logSqlError("saveGradeResults");
+            rc = ERROR_DATABASE;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    writeEnd(nested, rc == SUCCESS);
+    return rc;
+}
+
+ErrorCode getStoredGrade(const char *userID, StoredGrade *row) {
+    if (!userID || !row) return ERROR_INVALID_INPUT;
+    memset(row, 0, sizeof(*row));
+    if (!conn()) return ERROR_DATABASE;
+    const char *sql = "SELECT institute, campus_type, scheme_version, percent, gpa, grade, passed "
+                      "FROM grade_results WHERE user_id = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("getStoredGrade");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    ErrorCode rc = ERROR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *text;
+        snprintf(row->userID, sizeof(row->userID), "%s", userID);
+        if ((text = (const char*)sqlite3_column_text(stmt, 0)) != NULL) {
+            snprintf(row->institute, sizeof(row->institute), "%s", text);
+        }
+        row->campusType = (CampusType)sqlite3_column_int(stmt, 1);
+        row->schemeVersion = sqlite3_column_int(stmt, 2);
+        row->percent = (float)sqlite3_column_double(stmt, 3);
+        row->gpa = (float)sqlite3_column_double(stmt, 4);
+        if ((text = (const char*)sqlite3_column_text(stmt, 5)) != NULL) {
+            snprintf(row->grade, sizeof(row->grade), "%s", text);
+        }
+        row->passed = sqlite3_column_int(stmt, 6);
+        rc = SUCCESS;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
 ErrorCode updateUser(const Profile *profile) {
+    maintenanceNoteActivity();
     if (!profile) return 0;
 
-    const char *sql = "UPDATE users SET name=?, institute_name=?, department=?, campus_type=?, data_count=?, email=?, mobile=?, password_hash=?, "
+    const char *sql = "UPDATE users SET name=?, institute_id=?, department_id=?, campus_type=?, data_count=?, email=?, mobile=?, password_hash=?, "
                       "field0=?, field1=?, field2=?, field3=?, field4=?, field5=?, field6=?, field7=?, field8=?, field9=? "
                       "WHERE user_id=?";
+
+    // Interned before the transaction, so a new name commits on its own and is cached
+    ProfileNames names;
+    if (internProfile(profile, &names) != SUCCESS) return 0;
     
+    // Moving institute, department or campus type moves the stored marks' statistics along
+    int nested = writeBegin();
+    if (nested < 0) return 0;
+    Profile old;
+    int moved = getUserByID(profile->userID, &old) &&
+                (strcmp(old.instituteName, profile->instituteName) != 0 ||
+                 strcmp(old.department, profile->department) != 0 || old.campusType != profile->campusType);
+    if (moved && statsApplyStored(&old, -1) != SUCCESS) {
+        writeEnd(nested, 0);
+        return 0;
+    }
+
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        writeEnd(nested, 0);
+        return 0;
+    }
 
     sqlite3_bind_text(stmt, 1, profile->name, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, profile->instituteName, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, profile->department, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, profile->campusType);
     sqlite3_bind_int(stmt, 5, profile->dataCount);
     sqlite3_bind_text(stmt, 6, profile->email, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 7, profile->mobile, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 8, profile->passwordHash, -1, SQLITE_STATIC);
-
-    for (int i = 0; i < MAX_SUBJECTS; i++) {
-        if (i < profile->dataCount) {
-            sqlite3_bind_text(stmt, 9 + i, profile->dataFields[i], -1, SQLITE_STATIC);
-        } else {
-            sqlite3_bind_null(stmt, 9 + i);
-        }
-    }
+    bindProfileNames(stmt, 2, 9, profile, &names);
     sqlite3_bind_text(stmt, 19, profile->userID, -1, SQLITE_STATIC);
 
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
+    if (rc == SQLITE_DONE && moved && statsApplyStored(profile, 1) != SUCCESS) rc = SQLITE_ERROR;
+    writeEnd(nested, rc == SQLITE_DONE);
 
     if (rc == SQLITE_DONE) {
-        logActivity(profile->userID, "USER_UPDATED", "Profile updated");
+        reportCacheInvalidate(profile->userID);
+        rankNoteProfile(profile);
+        logActivity(profile->userID, EVENT_USER_UPDATED, "Profile updated");
         return 1;
     }
     return 0;
 }
 
 ErrorCode authenticateUser(const char *userID, const char *mobile, const char *passwordHash) {
+    maintenanceNoteActivity();
     Profile profile;
     if (!getUserByID(userID, &profile)) {
         return 0;
@@ -231,34 +1315,69 @@ ErrorCode authenticateUser(const char *userID, const char *mobile, const char *p
     // Note: We should ideally do this in SQL: SELECT 1 FROM users WHERE user_id=? AND mobile=? AND password_hash=?
     if (strcmp(profile.mobile, mobile) == 0 && 
         strcmp(profile.passwordHash, passwordHash) == 0) {
-        logActivity(userID, "LOGIN_SUCCESS", "User authenticated");
+        logActivity(userID, EVENT_LOGIN_SUCCESS, "User authenticated");
         resetLoginAttempts(userID);
         return 1;
     }
     
     incrementLoginAttempts(userID);
-    logActivity(userID, "LOGIN_FAILED", "Authentication failed");
+    logActivity(userID, EVENT_LOGIN_FAILED, "Authentication failed");
     return 0;
 }
 
 // Replaced file blobs with SQLite BLOB storage
 ErrorCode saveUserData(const char *userID, const char *dataType, const void *data, size_t dataSize) {
+    maintenanceNoteActivity();
     if (!userID || !dataType || !data || dataSize == 0) return 0;
 
+    // Marks are stored packed (subject names interned before the transaction);
+    // the hash is over the struct as it reads back
+    SchoolMarks marks;
+    PackedMarks packed;
+    size_t packedSize = 0;
+    if (isMarksType(dataType) && normalizeMarks(data, dataSize, &marks)) {
+        data = &marks;
+        packedSize = packMarks(&marks, &packed);
+    }
+
+    // Marks count toward score_stats while they match the owner's campus type:
+    // the old blob's contribution is taken out and the new one added in the same transaction
+    Profile owner;
+    int counted = (strcmp(dataType, "SCHOOL_DATA") == 0 || strcmp(dataType, "COLLEGE_DATA") == 0) &&
+                  getUserByID(userID, &owner) && strcmp(campusDataType(owner.campusType), dataType) == 0;
+    int nested = 0;
+    if (counted && ((nested = writeBegin()) < 0 || statsApplyStored(&owner, -1) != SUCCESS)) {
+        if (nested >= 0) writeEnd(nested, 0);
+        return 0;
+    }
+
     // Use UPSERT (REPLACE INTO)
-    const char *sql = "REPLACE INTO user_data (user_id, data_type, blob_data) VALUES (?, ?, ?);";
+    const char *sql = "REPLACE INTO user_data (user_id, data_type, blob_data, content_hash) VALUES (?, ?, ?, ?);";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+        if (counted) writeEnd(nested, 0);
+        return 0;
+    }
 
     sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, dataType, -1, SQLITE_STATIC);
-    sqlite3_bind_blob(stmt, 3, data, (int)dataSize, SQLITE_STATIC);
+    if (packedSize) {
+        sqlite3_bind_blob(stmt, 3, &packed, (int)packedSize, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_blob(stmt, 3, data, (int)dataSize, SQLITE_STATIC);
+    }
+    sqlite3_bind_int64(stmt, 4, (sqlite3_int64)reportCacheHash(REPORT_CACHE_HASH_SEED, data, dataSize));
 
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
+    if (counted) {
+        if (rc == SQLITE_DONE && statsApply(&owner, data, dataSize, 1) != SUCCESS) rc = SQLITE_ERROR;
+        writeEnd(nested, rc == SQLITE_DONE);
+    }
 
     if (rc == SQLITE_DONE) {
-        logActivity(userID, "DATA_SAVED", dataType);
+        reportCacheInvalidate(userID);
+        logActivity(userID, EVENT_DATA_SAVED, dataType);
         return 1;
     }
     logSqlError("saveUserData");
@@ -266,18 +1385,21 @@ ErrorCode saveUserData(const char *userID, const char *dataType, const void *dat
 }
 
 ErrorCode loadUserData(const char *userID, const char *dataType, void *data, size_t *dataSize) {
+    maintenanceNoteActivity();
     if (!userID || !dataType || !data || !dataSize) return 0;
 
     const char *sql = "SELECT blob_data FROM user_data WHERE user_id = ? AND data_type = ?;";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) return 0;
 
     sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 2, dataType, -1, SQLITE_STATIC);
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
+        SchoolMarks scratch;
+        size_t bytes = (size_t)sqlite3_column_bytes(stmt, 0);
         const void *blob = sqlite3_column_blob(stmt, 0);
-        int bytes = sqlite3_column_bytes(stmt, 0);
+        if (isMarksType(dataType)) blob = marksBlob(blob, &bytes, &scratch);
         
         if (bytes > 0) {
             // Check if buffer is large enough if we could (we can't really, but we assume caller knows)
@@ -310,18 +1432,198 @@ ErrorCode loadUserData(const char *userID, const char *dataType, void *data, siz
     return 0;
 }
 
-ErrorCode logActivity(const char *userID, const char *action, const char *details) {
-    if (!db) return 0;
+ErrorCode getUserDataVersion(const char *userID, const char *dataType, uint64_t *version) {
+    if (!userID || !dataType || !version) return ERROR_INVALID_INPUT;
+
+    const char *sql = "SELECT content_hash FROM user_data WHERE user_id = ? AND data_type = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) return ERROR_DATABASE;
+
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, dataType, -1, SQLITE_STATIC);
+
+    ErrorCode result = ERROR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        *version = (uint64_t)sqlite3_column_int64(stmt, 0);
+        result = SUCCESS;
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+ErrorCode deleteUser(const char *userID) {
+    maintenanceNoteActivity();
+    if (!userID) return ERROR_INVALID_INPUT;
+
+    // The user's marks leave score_stats with them, in the same transaction
+    int nested = writeBegin();
+    if (nested < 0) return ERROR_DATABASE;
+    Profile old;
+    if (!getUserByID(userID, &old)) {
+        writeEnd(nested, 0);
+        return ERROR_NOT_FOUND;
+    }
+    ErrorCode result = statsApplyStored(&old, -1);
+    static const char *const tables[] = { "user_data", "grade_results", "campus_records", "login_attempts",
+                                          "account_locks", "users" };
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]) && result == SUCCESS; i++) {
+        char sql[80];
+        snprintf(sql, sizeof(sql), "DELETE FROM %s WHERE user_id = ?;", tables[i]);
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) {
+            result = ERROR_DATABASE;
+            break;
+        }
+        sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) != SQLITE_DONE) result = ERROR_DATABASE;
+        sqlite3_finalize(stmt);
+    }
+    writeEnd(nested, result == SUCCESS);
+    if (result != SUCCESS) {
+        logSqlError("deleteUser");
+        return result;
+    }
+
+    reportCacheInvalidate(userID);
+    old.campusType = CAMPUS_NONE;       // filed under no campus type: off the rank boards
+    rankNoteProfile(&old);
+    logActivity(userID, EVENT_USER_DELETED, "User deleted");
+    return SUCCESS;
+}
+
+ErrorCode scanProfiles(int (*visit)(const Profile *profile, void *ctx), void *ctx) {
+    maintenanceNoteActivity();
+    if (!visit) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT * FROM users;", -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("scanProfiles");
+        return ERROR_DATABASE;
+    }
+    int rc;
+    Profile profile;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        readProfileRow(stmt, 0, &profile);
+        if (!visit(&profile, ctx)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? SUCCESS : ERROR_DATABASE;
+}
+
+ErrorCode saveCampusRecord(const char *userID, const void *record, size_t length) {
+    maintenanceNoteActivity();
+    if (!userID || !record || length == 0) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "REPLACE INTO campus_records (user_id, record) VALUES (?, ?);",
+                           -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("saveCampusRecord");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, record, (int)length, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        logSqlError("saveCampusRecord");
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
+ErrorCode loadCampusRecord(const char *userID, void *record, size_t capacity, size_t *length) {
+    maintenanceNoteActivity();
+    if (!userID || (!record && capacity)) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT record FROM campus_records WHERE user_id = ?;", -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("loadCampusRecord");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    ErrorCode result = ERROR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        size_t bytes = (size_t)sqlite3_column_bytes(stmt, 0);
+        if (length) *length = bytes;
+        result = bytes <= capacity ? SUCCESS : ERROR_MEMORY;
+        if (result == SUCCESS && bytes) memcpy(record, sqlite3_column_blob(stmt, 0), bytes);
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+ErrorCode deleteCampusRecord(const char *userID) {
+    maintenanceNoteActivity();
+    if (!userID) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "DELETE FROM campus_records WHERE user_id = ?;", -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("deleteCampusRecord");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) return ERROR_DATABASE;
+    return sqlite3_changes(conn()) > 0 ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+ErrorCode scanStoredCampusRecords(int (*visit)(const char *userID, const void *record, size_t length, void *ctx),
+                                  void *ctx) {
+    maintenanceNoteActivity();
+    if (!visit) return ERROR_INVALID_INPUT;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT user_id, record FROM campus_records;", -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("scanStoredCampusRecords");
+        return ERROR_DATABASE;
+    }
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *id = (const char*)sqlite3_column_text(stmt, 0);
+        const void *record = sqlite3_column_blob(stmt, 1);
+        if (!visit(id ? id : "", record, (size_t)sqlite3_column_bytes(stmt, 1), ctx)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? SUCCESS : ERROR_DATABASE;
+}
+
+ErrorCode logActivity(const char *userID, AuditEvent event, const char *details) {
+    maintenanceNoteActivity();
+    if (!conn()) return 0;
     const char *sql = "INSERT INTO audit_log (user_id, action, details, timestamp) VALUES (?, ?, ?, datetime('now'));";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) return 0;
     
     sqlite3_bind_text(stmt, 1, userID ? userID : "UNKNOWN", -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, action, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, event);
     sqlite3_bind_text(stmt, 3, details, -1, SQLITE_STATIC);
     
     sqlite3_step(stmt);
     sqlite3_finalize(stmt);
+
+    auditAppend(userID, (uint16_t)event, details);
+    return 1;
+}
+
+// counts[code] = number of audit_log rows per event (array of EVENT_COUNT)
+ErrorCode getAuditEventCounts(long counts[EVENT_COUNT]) {
+    memset(counts, 0, sizeof(long) * EVENT_COUNT);
+    if (!conn()) return 0;
+    const char *sql = "SELECT action, COUNT(*) FROM audit_log GROUP BY action;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) != SQLITE_OK) return 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int code = sqlite3_column_int(stmt, 0);
+        if (code >= 0 && code < EVENT_COUNT) counts[code] = (long)sqlite3_column_int64(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
     return 1;
 }
 
@@ -329,7 +1631,7 @@ int getLoginAttempts(const char *userID) {
     const char *sql = "SELECT attempts FROM login_attempts WHERE user_id = ?;";
     sqlite3_stmt *stmt;
     int attempts = 0;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             attempts = sqlite3_column_int(stmt, 0);
@@ -342,7 +1644,7 @@ int getLoginAttempts(const char *userID) {
 ErrorCode resetLoginAttempts(const char *userID) {
     const char *sql = "REPLACE INTO login_attempts (user_id, attempts) VALUES (?, 0);";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
         sqlite3_step(stmt);
     }
@@ -354,7 +1656,7 @@ int incrementLoginAttempts(const char *userID) {
     int attempts = getLoginAttempts(userID) + 1;
     const char *sql = "REPLACE INTO login_attempts (user_id, attempts) VALUES (?, ?);";
     sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
         sqlite3_bind_int(stmt, 2, attempts);
         sqlite3_step(stmt);
@@ -363,18 +1665,260 @@ int incrementLoginAttempts(const char *userID) {
     return attempts;
 }
 
-// Backup logic (SQLite specific)
-// We can use the Online Backup API or just copy the file if we close it/flush it.
-// Simple way: sqlite3_backup_init...
-// For now, simple copy logic still works if WAL is checkpointed, but best to use APIs.
-// Keeping shell copy for simplicity but ensuring WAL checkpoint.
+int64_t getAccountLock(const char *userID) {
+    const char *sql = "SELECT expiry FROM account_locks WHERE user_id = ?;";
+    sqlite3_stmt *stmt;
+    int64_t expiry = 0;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            expiry = sqlite3_column_int64(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return expiry;
+}
+
+ErrorCode setAccountLock(const char *userID, int64_t expiry) {
+    const char *sql = "REPLACE INTO account_locks (user_id, expiry) VALUES (?, ?);";
+    sqlite3_stmt *stmt;
+    int rc = SQLITE_ERROR;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, expiry);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? SUCCESS : ERROR_DATABASE;
+}
+
+ErrorCode clearAccountLock(const char *userID) {
+    const char *sql = "DELETE FROM account_locks WHERE user_id = ?;";
+    sqlite3_stmt *stmt;
+    int rc = SQLITE_ERROR;
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) return ERROR_DATABASE;
+    return sqlite3_changes(conn()) > 0 ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+// Legacy import: INSERT OR IGNORE so a row already in the database (from the
+// app, or an earlier interrupted run) is never overwritten by an older file
+static const char *const importSql[] = {
+    "INSERT OR IGNORE INTO users (user_id, name, institute_id, department_id, campus_type, data_count, email, "
+    "mobile, password_hash, field0, field1, field2, field3, field4, field5, field6, field7, field8, field9) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);",
+    "INSERT OR IGNORE INTO campus_records (user_id, record) VALUES (?, ?);",
+    "INSERT OR IGNORE INTO account_locks (user_id, expiry) VALUES (?, ?);",
+};
+
+static int importRow(sqlite3_stmt *stmt, const ImportRow *row) {
+    sqlite3_bind_text(stmt, 1, row->userID, -1, SQLITE_STATIC);
+    if (row->kind == IMPORT_PROFILE) {
+        const Profile *p = row->profile;
+        ProfileNames names;
+        if (internProfile(p, &names) != SUCCESS) return 0;
+        sqlite3_bind_text(stmt, 2, p->name, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 5, p->campusType);
+        sqlite3_bind_int(stmt, 6, p->dataCount);
+        sqlite3_bind_text(stmt, 7, p->email, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 8, p->mobile, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 9, p->passwordHash, -1, SQLITE_STATIC);
+        bindProfileNames(stmt, 3, 10, p, &names);
+    } else if (row->kind == IMPORT_CAMPUS_RECORD) {
+        sqlite3_bind_blob(stmt, 2, row->record, (int)row->length, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_int64(stmt, 2, row->expiry);
+    }
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return rc == SQLITE_DONE;
+}
+
+ErrorCode importRows(const ImportRow *rows, size_t count, const char *source, const char *checkpoint,
+                     size_t *inserted) {
+    maintenanceNoteActivity();
+    if ((!rows && count > 0) || (source && !checkpoint)) return ERROR_INVALID_INPUT;
+    if (inserted) *inserted = 0;
+
+    // New names commit on their own ahead of the chunk, so inside it every
+    // lookup is a cache hit (best effort: importRow interns again)
+    for (size_t i = 0; i < count; i++) {
+        ProfileNames names;
+        if (rows[i].kind == IMPORT_PROFILE && rows[i].profile) internProfile(rows[i].profile, &names);
+    }
+
+    int nested = writeBegin();
+    if (nested < 0) return ERROR_DATABASE;
+    sqlite3_stmt *stmts[3] = { NULL, NULL, NULL };
+    ErrorCode rc = SUCCESS;
+    for (size_t i = 0; i < count && rc == SUCCESS; i++) {
+        int kind = rows[i].kind;
+        if (kind < IMPORT_PROFILE || kind > IMPORT_ACCOUNT_LOCK) {
+            rc = ERROR_INVALID_INPUT;
+        } else if (!stmts[kind] && sqlite3_prepare_v2(conn(), importSql[kind], -1, &stmts[kind], 0) != SQLITE_OK) {
+            rc = ERROR_DATABASE;
+        } else if (!importRow(stmts[kind], &rows[i])) {
+            rc = ERROR_DATABASE;
+        } else if (inserted) {
+            *inserted += (size_t)sqlite3_changes(conn());
+        }
+    }
+    for (int k = 0; k < 3; k++) sqlite3_finalize(stmts[k]);
+
+    if (rc == SUCCESS && source) {
+        sqlite3_stmt *stmt;
+        rc = ERROR_DATABASE;
+        if (sqlite3_prepare_v2(conn(), "REPLACE INTO import_checkpoints (source, last_name) VALUES (?, ?);",
+                               -1, &stmt, 0) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, source, -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, checkpoint, -1, SQLITE_STATIC);
+            if (sqlite3_step(stmt) == SQLITE_DONE) rc = SUCCESS;
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (rc == ERROR_DATABASE) logSqlError("importRows");
+    writeEnd(nested, rc == SUCCESS);
+    if (rc != SUCCESS && inserted) *inserted = 0;
+    return rc;
+}
+
+ErrorCode getImportCheckpoint(const char *source, char *checkpoint, size_t size) {
+    if (!source || !checkpoint || size == 0) return ERROR_INVALID_INPUT;
+    checkpoint[0] = '\0';
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT last_name FROM import_checkpoints WHERE source = ?;",
+                           -1, &stmt, 0) != SQLITE_OK) {
+        logSqlError("getImportCheckpoint");
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, source, -1, SQLITE_STATIC);
+    ErrorCode rc = ERROR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *text = (const char*)sqlite3_column_text(stmt, 0);
+        snprintf(checkpoint, size, "%s", text ? text : "");
+        rc = SUCCESS;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+static ErrorCode selectStringId(const char *text, uint32_t *id) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(conn(), "SELECT id FROM strings WHERE text = ?;", -1, &stmt, 0) != SQLITE_OK) {
+        return ERROR_DATABASE;
+    }
+    sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    int step = sqlite3_step(stmt);
+    if (step == SQLITE_ROW) *id = (uint32_t)sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    return step == SQLITE_ROW ? SUCCESS : step == SQLITE_DONE ? ERROR_NOT_FOUND : ERROR_DATABASE;
+}
+
+// The db mutex keeps another thread on a shared connection from opening a
+// transaction between the lookup and the check of whether one is open
+ErrorCode findStringRow(const char *text, int create, uint32_t *id, int *committed) {
+    if (!text || !id || !committed) return ERROR_INVALID_INPUT;
+    *committed = 0;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_mutex *mutex = sqlite3_db_mutex(conn());
+    sqlite3_mutex_enter(mutex);
+    ErrorCode rc = selectStringId(text, id);
+    if (rc == ERROR_NOT_FOUND && create) {
+        // OR IGNORE: another connection may have added it since the SELECT
+        sqlite3_stmt *stmt;
+        rc = ERROR_DATABASE;
+        if (sqlite3_prepare_v2(conn(), "INSERT OR IGNORE INTO strings (text) VALUES (?);", -1, &stmt, 0) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+            if (sqlite3_step(stmt) == SQLITE_DONE) rc = selectStringId(text, id);
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (rc == ERROR_DATABASE) logSqlError("findStringRow");
+    *committed = sqlite3_txn_state(conn(), NULL) != SQLITE_TXN_WRITE;
+    sqlite3_mutex_leave(mutex);
+    return rc;
+}
+
+ErrorCode loadStringRow(uint32_t id, char *text, size_t size, int *committed) {
+    if (!text || size == 0 || !committed) return ERROR_INVALID_INPUT;
+    text[0] = '\0';
+    *committed = 0;
+    if (!conn()) return ERROR_DATABASE;
+    sqlite3_mutex *mutex = sqlite3_db_mutex(conn());
+    sqlite3_mutex_enter(mutex);
+    sqlite3_stmt *stmt;
+    ErrorCode rc = ERROR_DATABASE;
+    if (sqlite3_prepare_v2(conn(), "SELECT text FROM strings WHERE id = ?;", -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_int64(stmt, 1, id);
+        int step = sqlite3_step(stmt);
+        if (step == SQLITE_ROW) {
+            const char *value = (const char*)sqlite3_column_text(stmt, 0);
+            snprintf(text, size, "%s", value ? value : "");
+            rc = SUCCESS;
+        } else if (step == SQLITE_DONE) {
+            rc = ERROR_NOT_FOUND;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (rc == ERROR_DATABASE) logSqlError("loadStringRow");
+    *committed = sqlite3_txn_state(conn(), NULL) != SQLITE_TXN_WRITE;
+    sqlite3_mutex_leave(mutex);
+    return rc;
+}
+
+// Always the main connection: values from different connections do not compare
+ErrorCode getDataVersion(int64_t *version) {
+    if (!db || !version) return ERROR_INVALID_INPUT;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "PRAGMA data_version;", -1, &stmt, 0) != SQLITE_OK) return ERROR_DATABASE;
+    ErrorCode rc = ERROR_DATABASE;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *version = sqlite3_column_int64(stmt, 0);
+        rc = SUCCESS;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+// Online backup: copy pages in small steps so writers are never blocked
+// behind a FULL checkpoint, and the WAL content is included as-is.
+ErrorCode executeQuery(const char *query) {
+    if (!conn() || !query) return ERROR_INVALID_INPUT;
+    maintenanceNoteActivity();
+    if (sqlite3_exec(conn(), query, NULL, NULL, NULL) != SQLITE_OK) {
+        logSqlError("executeQuery");
+        return ERROR_DATABASE;
+    }
+    return SUCCESS;
+}
+
 ErrorCode backupDatabase(const char *backupPath) {
-    if (!db) return 0;
-    sqlite3_exec(db, "PRAGMA wal_checkpoint(FULL);", 0, 0, 0);
-    // ... copy command ...
-    char command[300];
-    snprintf(command, sizeof(command), "copy \"%s\" \"%s\"", DB_PATH, backupPath);
-    return system(command) == 0;
+    if (!db || !backupPath) return 0;
+    maintenanceNoteActivity();
+    sqlite3 *dest;
+    if (sqlite3_open(backupPath, &dest) != SQLITE_OK) {
+        sqlite3_close(dest);
+        return 0;
+    }
+    sqlite3_backup *backup = sqlite3_backup_init(dest, "main", db, "main");
+    int rc = SQLITE_ERROR;
+    if (backup) {
+        do {
+            rc = sqlite3_backup_step(backup, 256);
+            if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) sqlite3_sleep(5);
+        } while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED);
+        sqlite3_backup_finish(backup);
+    } else {
+        logSqlError("backup");
+    }
+    sqlite3_close(dest);
+    return rc == SQLITE_DONE;
 }
 
 // Stub implementation for restore (not safe while open)
@@ -386,7 +1930,7 @@ int isEmailAlreadyRegistered(const char *email) {
     const char *sql = "SELECT 1 FROM users WHERE email = ?;";
     sqlite3_stmt *stmt;
     int exists = 0;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, email, -1, SQLITE_STATIC);
         if (sqlite3_step(stmt) == SQLITE_ROW) exists = 1;
     }
@@ -398,7 +1942,7 @@ int isMobileAlreadyRegistered(const char *mobile) {
     const char *sql = "SELECT 1 FROM users WHERE mobile = ?;";
     sqlite3_stmt *stmt;
     int exists = 0;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, mobile, -1, SQLITE_STATIC);
         if (sqlite3_step(stmt) == SQLITE_ROW) exists = 1;
     }
@@ -411,7 +1955,7 @@ int searchUserByContact(const char *contact, const char *type, char *foundUserID
     snprintf(sql, sizeof(sql), "SELECT user_id FROM users WHERE %s = ?;", strcmp(type, "email") == 0 ? "email" : "mobile");
     sqlite3_stmt *stmt;
     int found = 0;
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(conn(), sql, -1, &stmt, 0) == SQLITE_OK) {
         sqlite3_bind_text(stmt, 1, contact, -1, SQLITE_STATIC);
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             strncpy(foundUserID, (const char*)sqlite3_column_text(stmt, 0), 19);
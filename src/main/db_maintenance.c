@@ -0,0 +1,389 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "../include/db_maintenance.h"
+#include "../include/sqlite3.h"
+
+#define MAINT_MAX_TABLES        32
+#define MAINT_BUSY_TIMEOUT_MS   50      // never hold up user requests for long
+#define MAINT_PROGRESS_OPS      1000    // VM steps between budget checks
+
+typedef struct {
+    MaintenanceConfig config;
+    char dbPath[256];
+    sqlite3 *conn;
+    int pageSize;
+    int vacuumEnabled;
+    unsigned quickCheckCursor;
+    uint64_t deadlineMicros;            // budget of the job in progress (0 = none)
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    int running;
+    int stopRequested;
+
+    // Forced runs: callers take a ticket, the thread serves tickets in batches
+    unsigned requestedMask;
+    unsigned long requestTicket;
+    unsigned long servedTicket;
+    ErrorCode forcedResult[MAINT_JOB_COUNT];
+
+    unsigned deferrals[MAINT_JOB_COUNT];
+    uint64_t lastRunMillis[MAINT_JOB_COUNT];
+    MaintenanceJobStats stats[MAINT_JOB_COUNT];
+} Maintenance;
+
+static Maintenance maint = { .lock = PTHREAD_MUTEX_INITIALIZER };
+static atomic_ullong lastActivityMillis;
+
+static const char *const jobNames[MAINT_JOB_COUNT] = {
+    "checkpoint", "incremental_vacuum", "optimize", "quick_check"
+};
+
+static uint64_t monoMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t monoMillis(void) {
+    return monoMicros() / 1000u;
+}
+
+MaintenanceConfig maintenanceDefaultConfig(void) {
+    MaintenanceConfig config;
+    memset(&config, 0, sizeof(config));
+    config.dbPath = "data/campus.db";
+    config.tickMillis = 1000;
+    config.idleMillis = 2000;
+    config.maxDeferrals = 60;
+    config.walForcePages = 1000;
+    config.vacuumStepPages = 64;
+    config.jobs[MAINT_CHECKPOINT] = (MaintenanceJobConfig){ 30, 200 };
+    config.jobs[MAINT_INCREMENTAL_VACUUM] = (MaintenanceJobConfig){ 300, 100 };
+    config.jobs[MAINT_OPTIMIZE] = (MaintenanceJobConfig){ 3600, 500 };
+    config.jobs[MAINT_QUICK_CHECK] = (MaintenanceJobConfig){ 600, 200 };
+    return config;
+}
+
+const char *maintenanceJobName(MaintenanceJob job) {
+    return (job >= 0 && job < MAINT_JOB_COUNT) ? jobNames[job] : "unknown";
+}
+
+void maintenanceNoteActivity(void) {
+    atomic_store_explicit(&lastActivityMillis, monoMillis(), memory_order_relaxed);
+}
+
+// Interrupts the running statement once the job's budget is spent
+static int budgetProgress(void *ctx) {
+    Maintenance *m = (Maintenance*)ctx;
+    return m->deadlineMicros && monoMicros() > m->deadlineMicros;
+}
+
+static int budgetSpent(const Maintenance *m) {
+    return m->deadlineMicros && monoMicros() > m->deadlineMicros;
+}
+
+static int pragmaInt(sqlite3 *conn, const char *sql, int fallback) {
+    sqlite3_stmt *stmt;
+    int value = fallback;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, 0) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) value = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+// WAL frames on disk, without touching the database (header 32 bytes, frame = 24 + page)
+static unsigned walFrames(const Maintenance *m) {
+    char walPath[300];
+    struct stat st;
+    snprintf(walPath, sizeof(walPath), "%s-wal", m->dbPath);
+    if (stat(walPath, &st) != 0 || st.st_size <= 32 || m->pageSize <= 0) return 0;
+    return (unsigned)((st.st_size - 32) / (m->pageSize + 24));
+}
+
+static ErrorCode runCheckpoint(Maintenance *m, uint64_t *work) {
+    int logFrames = 0, copied = 0;
+    int rc = sqlite3_wal_checkpoint_v2(m->conn, NULL, SQLITE_CHECKPOINT_PASSIVE, &logFrames, &copied);
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) return ERROR_DATABASE;
+    if (copied > 0) *work += (uint64_t)copied;
+    return SUCCESS;
+}
+
+static ErrorCode runIncrementalVacuum(Maintenance *m, uint64_t *work) {
+    if (!m->vacuumEnabled) return SUCCESS;
+    char sql[64];
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%u);", m->config.vacuumStepPages);
+    while (!budgetSpent(m)) {
+        int freePages = pragmaInt(m->conn, "PRAGMA freelist_count;", 0);
+        if (freePages <= 0) break;
+        int rc = sqlite3_exec(m->conn, sql, 0, 0, NULL);
+        if (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) break;    // a writer is active, try next time
+        if (rc == SQLITE_INTERRUPT) break;
+        if (rc != SQLITE_OK) return ERROR_DATABASE;
+        int left = pragmaInt(m->conn, "PRAGMA freelist_count;", 0);
+        if (left >= freePages) break;
+        *work += (uint64_t)(freePages - left);
+    }
+    return SUCCESS;
+}
+
+static ErrorCode runOptimize(Maintenance *m, uint64_t *work) {
+    (void)work;
+    int rc = sqlite3_exec(m->conn, "PRAGMA analysis_limit=400; PRAGMA optimize;", 0, 0, NULL);
+    if (rc == SQLITE_OK || rc == SQLITE_INTERRUPT || rc == SQLITE_BUSY) return SUCCESS;
+    return ERROR_DATABASE;
+}
+
+// One table per step, resuming where the previous run stopped
+static ErrorCode runQuickCheck(Maintenance *m, uint64_t *work) {
+    char tables[MAINT_MAX_TABLES][64];
+    int tableCount = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(m->conn,
+            "SELECT name FROM sqlite_schema WHERE type = 'table' ORDER BY name;", -1, &stmt, 0) != SQLITE_OK) {
+        return ERROR_DATABASE;
+    }
+    while (tableCount < MAINT_MAX_TABLES && sqlite3_step(stmt) == SQLITE_ROW) {
+        snprintf(tables[tableCount++], sizeof(tables[0]), "%s", (const char*)sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (tableCount == 0) return SUCCESS;
+
+    ErrorCode result = SUCCESS;
+    for (int checked = 0; checked < tableCount; checked++) {
+        if (checked > 0 && budgetSpent(m)) break;
+        const char *table = tables[m->quickCheckCursor++ % (unsigned)tableCount];
+        char sql[128];
+        snprintf(sql, sizeof(sql), "PRAGMA quick_check(\"%s\");", table);
+        if (sqlite3_prepare_v2(m->conn, sql, -1, &stmt, 0) != SQLITE_OK) return ERROR_DATABASE;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            const char *line = (const char*)sqlite3_column_text(stmt, 0);
+            if (line && strcmp(line, "ok") != 0) {
+                printf("[Maintenance] quick_check(%s): %s\n", table, line);
+                result = ERROR_DATABASE;
+            }
+        }
+        sqlite3_finalize(stmt);
+        if (rc == SQLITE_INTERRUPT) break;
+        (*work)++;
+    }
+    return result;
+}
+
+static ErrorCode runJob(Maintenance *m, MaintenanceJob job) {
+    const MaintenanceJobConfig *jc = &m->config.jobs[job];
+    uint64_t start = monoMicros();
+    uint64_t work = 0;
+    m->deadlineMicros = jc->budgetMillis ? start + (uint64_t)jc->budgetMillis * 1000u : 0;
+
+    ErrorCode result;
+    switch (job) {
+        case MAINT_CHECKPOINT:         result = runCheckpoint(m, &work); break;
+        case MAINT_INCREMENTAL_VACUUM: result = runIncrementalVacuum(m, &work); break;
+        case MAINT_OPTIMIZE:           result = runOptimize(m, &work); break;
+        case MAINT_QUICK_CHECK:        result = runQuickCheck(m, &work); break;
+        default:                       result = ERROR_INVALID_INPUT; break;
+    }
+    int overBudget = budgetSpent(m);
+    m->deadlineMicros = 0;
+    uint64_t elapsed = monoMicros() - start;
+
+    pthread_mutex_lock(&m->lock);
+    MaintenanceJobStats *s = &m->stats[job];
+    s->runs++;
+    s->work += work;
+    s->lastMicros = elapsed;
+    s->totalMicros += elapsed;
+    if (elapsed > s->maxMicros) s->maxMicros = elapsed;
+    if (overBudget) s->overBudget++;
+    if (result != SUCCESS) s->failures++;
+    s->lastRun = time(NULL);
+    pthread_mutex_unlock(&m->lock);
+    return result;
+}
+
+// Low traffic = no database request for idleMillis; a job that has been
+// deferred maxDeferrals times runs anyway so it cannot starve
+static int shouldRun(Maintenance *m, MaintenanceJob job, uint64_t now, int idle) {
+    const MaintenanceJobConfig *jc = &m->config.jobs[job];
+    if (jc->intervalSeconds == 0) return 0;
+    if (now - m->lastRunMillis[job] < (uint64_t)jc->intervalSeconds * 1000u) return 0;
+    if (idle || m->deferrals[job] >= m->config.maxDeferrals) return 1;
+    if (job == MAINT_CHECKPOINT && m->config.walForcePages &&
+        walFrames(m) >= m->config.walForcePages) return 1;
+
+    m->deferrals[job]++;
+    pthread_mutex_lock(&m->lock);
+    m->stats[job].deferred++;
+    pthread_mutex_unlock(&m->lock);
+    return 0;
+}
+
+static void *maintenanceThread(void *arg) {
+    Maintenance *m = (Maintenance*)arg;
+    pthread_mutex_lock(&m->lock);
+    while (!m->stopRequested) {
+        if (!m->requestedMask) {
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_sec += m->config.tickMillis / 1000;
+            until.tv_nsec += (long)(m->config.tickMillis % 1000) * 1000000L;
+            if (until.tv_nsec >= 1000000000L) { until.tv_sec++; until.tv_nsec -= 1000000000L; }
+            pthread_cond_timedwait(&m->wake, &m->lock, &until);
+            if (m->stopRequested) break;
+        }
+        unsigned forced = m->requestedMask;
+        unsigned long ticket = m->requestTicket;
+        m->requestedMask = 0;
+        pthread_mutex_unlock(&m->lock);
+
+        uint64_t now = monoMillis();
+        int idle = now - atomic_load_explicit(&lastActivityMillis, memory_order_relaxed) >= m->config.idleMillis;
+        ErrorCode results[MAINT_JOB_COUNT] = {0};
+        for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+            if (!(forced & (1u << job)) && !shouldRun(m, (MaintenanceJob)job, now, idle)) continue;
+            results[job] = runJob(m, (MaintenanceJob)job);
+            m->deferrals[job] = 0;
+            m->lastRunMillis[job] = monoMillis();
+        }
+
+        pthread_mutex_lock(&m->lock);
+        if (forced) {
+            for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+                if (forced & (1u << job)) m->forcedResult[job] = results[job];
+            }
+            m->servedTicket = ticket;
+            pthread_cond_broadcast(&m->done);
+        }
+    }
+    pthread_mutex_unlock(&m->lock);
+
+    // Leave a short WAL behind for the next start
+    runJob(m, MAINT_CHECKPOINT);
+    return NULL;
+}
+
+ErrorCode maintenanceStart(const MaintenanceConfig *config) {
+    pthread_mutex_lock(&maint.lock);
+    if (maint.running) {
+        pthread_mutex_unlock(&maint.lock);
+        return SUCCESS;
+    }
+    maint.config = config ? *config : maintenanceDefaultConfig();
+    snprintf(maint.dbPath, sizeof(maint.dbPath), "%s", maint.config.dbPath ? maint.config.dbPath : "data/campus.db");
+    maint.config.dbPath = maint.dbPath;
+    if (maint.config.tickMillis == 0) maint.config.tickMillis = 1000;
+    if (maint.config.vacuumStepPages == 0) maint.config.vacuumStepPages = 64;
+
+    if (sqlite3_open_v2(maint.dbPath, &maint.conn, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL) != SQLITE_OK) {
+        printf("[Maintenance] Can't open %s: %s\n", maint.dbPath, maint.conn ? sqlite3_errmsg(maint.conn) : "out of memory");
+        sqlite3_close(maint.conn);
+        maint.conn = NULL;
+        pthread_mutex_unlock(&maint.lock);
+        return ERROR_DATABASE;
+    }
+    sqlite3_busy_timeout(maint.conn, MAINT_BUSY_TIMEOUT_MS);
+    sqlite3_progress_handler(maint.conn, MAINT_PROGRESS_OPS, budgetProgress, &maint);
+    maint.pageSize = pragmaInt(maint.conn, "PRAGMA page_size;", 4096);
+    maint.vacuumEnabled = pragmaInt(maint.conn, "PRAGMA auto_vacuum;", 0) == 2;   // INCREMENTAL
+
+    uint64_t now = monoMillis();
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+        maint.lastRunMillis[job] = now;
+        maint.deferrals[job] = 0;
+    }
+    memset(maint.stats, 0, sizeof(maint.stats));
+    maint.requestedMask = 0;
+    maint.requestTicket = maint.servedTicket = 0;
+    maint.stopRequested = 0;
+    pthread_cond_init(&maint.wake, NULL);
+    pthread_cond_init(&maint.done, NULL);
+    maintenanceNoteActivity();
+
+    if (pthread_create(&maint.thread, NULL, maintenanceThread, &maint) != 0) {
+        sqlite3_close(maint.conn);
+        maint.conn = NULL;
+        pthread_mutex_unlock(&maint.lock);
+        return ERROR_DATABASE;
+    }
+    maint.running = 1;
+    pthread_mutex_unlock(&maint.lock);
+    return SUCCESS;
+}
+
+ErrorCode maintenanceStop(void) {
+    pthread_mutex_lock(&maint.lock);
+    if (!maint.running) {
+        pthread_mutex_unlock(&maint.lock);
+        return SUCCESS;
+    }
+    maint.stopRequested = 1;
+    pthread_cond_signal(&maint.wake);
+    pthread_mutex_unlock(&maint.lock);
+
+    pthread_join(maint.thread, NULL);
+
+    pthread_mutex_lock(&maint.lock);
+    maint.running = 0;
+    pthread_cond_broadcast(&maint.done);    // release RunNow callers that raced the stop
+    sqlite3_close(maint.conn);
+    maint.conn = NULL;
+    pthread_mutex_unlock(&maint.lock);
+    return SUCCESS;
+}
+
+int maintenanceIsRunning(void) {
+    pthread_mutex_lock(&maint.lock);
+    int running = maint.running && !maint.stopRequested;
+    pthread_mutex_unlock(&maint.lock);
+    return running;
+}
+
+ErrorCode maintenanceRunNow(MaintenanceJob job) {
+    if (job < 0 || job >= MAINT_JOB_COUNT) return ERROR_INVALID_INPUT;
+    pthread_mutex_lock(&maint.lock);
+    if (!maint.running || maint.stopRequested) {
+        pthread_mutex_unlock(&maint.lock);
+        return ERROR_DATABASE;
+    }
+    maint.requestedMask |= 1u << job;
+    unsigned long ticket = ++maint.requestTicket;
+    pthread_cond_signal(&maint.wake);
+    while (maint.running && maint.servedTicket < ticket) {
+        pthread_cond_wait(&maint.done, &maint.lock);
+    }
+    ErrorCode result = maint.servedTicket >= ticket ? maint.forcedResult[job] : ERROR_DATABASE;
+    pthread_mutex_unlock(&maint.lock);
+    return result;
+}
+
+void maintenanceGetStats(MaintenanceJobStats stats[MAINT_JOB_COUNT]) {
+    pthread_mutex_lock(&maint.lock);
+    memcpy(stats, maint.stats, sizeof(maint.stats));
+    pthread_mutex_unlock(&maint.lock);
+}
+
+void maintenancePrintStats(FILE *out) {
+    MaintenanceJobStats stats[MAINT_JOB_COUNT];
+    maintenanceGetStats(stats);
+    fprintf(out, "%-20s %6s %8s %6s %6s %10s %10s %10s\n",
+            "job", "runs", "deferred", "budget", "fail", "work", "last_us", "max_us");
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+        const MaintenanceJobStats *s = &stats[job];
+        fprintf(out, "%-20s %6lu %8lu %6lu %6lu %10llu %10llu %10llu\n",
+                jobNames[job], s->runs, s->deferred, s->overBudget, s->failures,
+                (unsigned long long)s->work, (unsigned long long)s->lastMicros,
+                (unsigned long long)s->maxMicros);
+    }
+}
@@ -17,8 +17,8 @@
 int validateProfile(const Profile *p) {
     if (strlen(p->userID) == 0) return 0;
     if (p->dataCount < 0 || p->dataCount > MAX_SUBJECTS) return 0;
-    if (!validateEmail(p->email)) return 0;
-    if (!validateMobile(p->mobile)) return 0;
+    if (validateEmail(p->email) != SUCCESS) return 0;
+    if (validateMobile(p->mobile) != SUCCESS) return 0;
     return 1;
 }
 
@@ -0,0 +1,121 @@
+#include <string.h>
+#include "../include/grade_kernel.h"
+
+static const char *const gradeNames[GRADE_BUCKETS] = { "F", "D", "C", "B", "A", "A+" };
+
+// Lower bound of D, C, B, A and A+
+#define GRADE_T1 50.0f
+#define GRADE_T2 60.0f
+#define GRADE_T3 70.0f
+#define GRADE_T4 80.0f
+#define GRADE_T5 90.0f
+
+GradeBucket gradeBucket(float percent) {
+    return (GradeBucket)((percent >= GRADE_T1) + (percent >= GRADE_T2) + (percent >= GRADE_T3) +
+                         (percent >= GRADE_T4) + (percent >= GRADE_T5));
+}
+
+const char *gradeName(GradeBucket grade) {
+    return (unsigned)grade < GRADE_BUCKETS ? gradeNames[grade] : "?";
+}
+
+// Same float operations as the vector path, one student
+static void gradeOne(const GradeBatch *b, size_t i, const GradeResults *out) {
+    int total = 0, weight = 0;
+    for (int s = 0; s < b->subjects; s++) {
+        int m = b->marks[(size_t)s * b->stride + i], w = b->weights[(size_t)s * b->stride + i];
+        total += b->scale == GRADE_SCALE_CGPA ? m * w : m;
+        weight += w;
+    }
+    float score = 0.0f;
+    if (weight != 0) {
+        score = b->scale == GRADE_SCALE_CGPA ? (float)total / ((float)weight * 10.0f)
+                                             : (float)total * 100.0f / (float)weight;
+    }
+    out->total[i] = total;
+    out->weight[i] = weight;
+    out->score[i] = score;
+    if (out->grade && b->scale == GRADE_SCALE_PERCENT) out->grade[i] = (unsigned char)gradeBucket(score);
+}
+
+#if defined(__GNUC__) && !defined(GRADE_KERNEL_SCALAR)
+// One register's worth: 256-bit with AVX, 128-bit SSE2/NEON otherwise
+#ifdef __AVX__
+#define GRADE_LANES 8
+#else
+#define GRADE_LANES 4
+#endif
+typedef int   GradeInts   __attribute__((vector_size(GRADE_LANES * sizeof(int))));
+typedef float GradeFloats __attribute__((vector_size(GRADE_LANES * sizeof(float))));
+
+static GradeInts loadLanes(const int *p) {
+    GradeInts v;
+    memcpy(&v, p, sizeof(v));      // columns need not be aligned
+    return v;
+}
+
+// Students [i, i + GRADE_LANES)
+static void gradeLanes(const GradeBatch *b, size_t i, const GradeResults *out) {
+    GradeInts total = {0}, weight = {0};
+    if (b->scale == GRADE_SCALE_CGPA) {
+        for (int s = 0; s < b->subjects; s++) {
+            GradeInts w = loadLanes(b->weights + (size_t)s * b->stride + i);
+            total += loadLanes(b->marks + (size_t)s * b->stride + i) * w;
+            weight += w;
+        }
+    } else {
+        for (int s = 0; s < b->subjects; s++) {
+            total += loadLanes(b->marks + (size_t)s * b->stride + i);
+            weight += loadLanes(b->weights + (size_t)s * b->stride + i);
+        }
+    }
+
+    // Lanes with no weight divide by 1 and are masked to 0 afterwards
+    GradeInts empty = weight == 0;
+    GradeFloats num = __builtin_convertvector(total, GradeFloats);
+    GradeFloats den = __builtin_convertvector(weight, GradeFloats);
+    GradeFloats one = (GradeFloats){0} + 1.0f;
+    if (b->scale == GRADE_SCALE_CGPA) den *= 10.0f;
+    else num *= 100.0f;
+    den = (GradeFloats)(((GradeInts)den & ~empty) | ((GradeInts)one & empty));
+    GradeFloats score = (GradeFloats)((GradeInts)(num / den) & ~empty);
+
+    memcpy(out->total + i, &total, sizeof(total));
+    memcpy(out->weight + i, &weight, sizeof(weight));
+    memcpy(out->score + i, &score, sizeof(score));
+    if (out->grade && b->scale == GRADE_SCALE_PERCENT) {
+        // Each comparison is -1 where it holds
+        GradeInts grade = -((score >= GRADE_T1) + (score >= GRADE_T2) + (score >= GRADE_T3) +
+                            (score >= GRADE_T4) + (score >= GRADE_T5));
+        for (int l = 0; l < GRADE_LANES; l++) out->grade[i + l] = (unsigned char)grade[l];
+    }
+}
+#endif
+
+void gradeBatch(const GradeBatch *batch, const GradeResults *out) {
+    if (!batch || !out || batch->count == 0) return;
+    size_t i = 0;
+#ifdef GRADE_LANES
+    for (; i + GRADE_LANES <= batch->count; i += GRADE_LANES) gradeLanes(batch, i, out);
+#endif
+    for (; i < batch->count; i++) gradeOne(batch, i, out);
+}
+
+GradeSummary gradeStudent(GradeScale scale, const int *marks, const int *weights, int subjects) {
+    GradeSummary summary = {0};
+    unsigned char grade = GRADE_F;
+    GradeBatch batch = { scale, 1, 1, subjects < 0 ? 0 : subjects > MAX_SUBJECTS ? MAX_SUBJECTS : subjects,
+                         marks, weights };
+    GradeResults out = { &summary.total, &summary.weight, &summary.score, &grade };
+    gradeBatch(&batch, &out);
+    summary.grade = (GradeBucket)grade;
+    return summary;
+}
+
+GradeSummary gradeSchoolMarks(const SchoolMarks *m) {
+    return gradeStudent(GRADE_SCALE_PERCENT, m->marks, m->fullMarks, m->count);
+}
+
+GradeSummary gradeCollegeMarks(const CollegeMarks *m) {
+    return gradeStudent(GRADE_SCALE_CGPA, m->marks, m->credits, m->count);
+}
@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/grading_scheme.h"
+#include "../include/grade_kernel.h"
+#include "../include/database.h"
+
+// Every compiled scheme stays allocated until reset, so pointers handed out
+// survive a newer version being installed; `current` holds the latest per
+// institute, sorted by name. `dataVersion` and `tableVersion` are what the
+// last scan saw (getDataVersion, getGradingSchemesVersion).
+static struct {
+    pthread_mutex_t lock;
+    int loaded;
+    int64_t dataVersion, tableVersion;
+    int builtInReady;
+    GradingScheme builtIn;
+    GradingScheme **all;
+    size_t allCount, allCap;
+    GradingScheme **current;
+    size_t currentCount;
+} schemes = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t hashBytes(uint64_t h, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static int percentStep(float percent) {
+    double steps = (double)percent * (GRADING_STEPS / 100);    // exact for any float
+    if (!(steps > 0.0)) return 0;
+    return steps >= GRADING_STEPS ? GRADING_STEPS : (int)steps;
+}
+
+static int thresholdStep(float percent) {
+    return (int)(percent * (GRADING_STEPS / 100) + 0.5f);
+}
+
+// NAME=MIN[:POINTS], gpa=marks|points or pass=PERCENT
+static ErrorCode parseToken(char *token, GradingScheme *s, int *passSet) {
+    char *value = strchr(token, '=');
+    if (!value || value == token) return ERROR_INVALID_INPUT;
+    *value++ = '\0';
+    char *end;
+
+    if (strcmp(token, "gpa") == 0) {
+        if (strcmp(value, "marks") == 0) s->gpa = GPA_MARKS;
+        else if (strcmp(value, "points") == 0) s->gpa = GPA_POINTS;
+        else return ERROR_INVALID_INPUT;
+        return SUCCESS;
+    }
+    if (strcmp(token, "pass") == 0) {
+        s->passPercent = strtof(value, &end);
+        if (end == value || *end || s->passPercent < 0.0f || s->passPercent > 100.0f) return ERROR_INVALID_INPUT;
+        *passSet = 1;
+        return SUCCESS;
+    }
+
+    if (s->gradeCount >= GRADING_MAX_GRADES || strlen(token) >= sizeof(s->names[0])) return ERROR_INVALID_INPUT;
+    int g = s->gradeCount;
+    float min = strtof(value, &end), points = 0.0f;
+    if (end == value || min < 0.0f || min > 100.0f) return ERROR_INVALID_INPUT;
+    if (*end == ':') {
+        char *start = end + 1;
+        points = strtof(start, &end);
+        if (end == start || points < 0.0f) return ERROR_INVALID_INPUT;
+    }
+    if (*end) return ERROR_INVALID_INPUT;
+    for (int i = 0; i < g; i++) {
+        if (strcmp(s->names[i], token) == 0 || thresholdStep(s->minPercent[i]) == thresholdStep(min)) {
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    snprintf(s->names[g], sizeof(s->names[g]), "%s", token);
+    s->minPercent[g] = min;
+    s->points[g] = points;
+    s->gradeCount++;
+    return SUCCESS;
+}
+
+ErrorCode gradingSchemeCompile(const char *institute, int version, const char *spec, GradingScheme *out) {
+    if (!institute || !spec || !out || strlen(spec) >= GRADING_SPEC_LEN) return ERROR_INVALID_INPUT;
+    GradingScheme *s = out;
+    memset(s, 0, sizeof(*s));
+    snprintf(s->institute, sizeof(s->institute), "%s", institute);
+    snprintf(s->spec, sizeof(s->spec), "%s", spec);
+    s->version = version;
+    s->gpa = GPA_MARKS;
+
+    char buffer[GRADING_SPEC_LEN], *save = NULL;
+    int passSet = 0;
+    memcpy(buffer, s->spec, sizeof(buffer));
+    for (char *token = strtok_r(buffer, " ,\t\r\n", &save); token; token = strtok_r(NULL, " ,\t\r\n", &save)) {
+        if (parseToken(token, s, &passSet) != SUCCESS) return ERROR_INVALID_INPUT;
+    }
+
+    // Best first; the last grade must cover 0%
+    for (int i = 1; i < s->gradeCount; i++) {
+        for (int j = i; j > 0 && s->minPercent[j] > s->minPercent[j - 1]; j--) {
+            char name[sizeof(s->names[0])];
+            float min = s->minPercent[j], points = s->points[j];
+            memcpy(name, s->names[j], sizeof(name));
+            memcpy(s->names[j], s->names[j - 1], sizeof(name));
+            s->minPercent[j] = s->minPercent[j - 1];
+            s->points[j] = s->points[j - 1];
+            memcpy(s->names[j - 1], name, sizeof(name));
+            s->minPercent[j - 1] = min;
+            s->points[j - 1] = points;
+        }
+    }
+    if (s->gradeCount == 0 || thresholdStep(s->minPercent[s->gradeCount - 1]) != 0) return ERROR_INVALID_INPUT;
+    if (!passSet) s->passPercent = s->gradeCount > 1 ? s->minPercent[s->gradeCount - 2] : 0.0f;
+
+    int g = s->gradeCount - 1;
+    for (int step = 0; step <= GRADING_STEPS; step++) {
+        while (g > 0 && step >= thresholdStep(s->minPercent[g - 1])) g--;
+        s->lookup[step] = (unsigned char)g;
+    }
+
+    uint64_t h = hashBytes(1469598103934665603ULL, s->institute, strlen(s->institute) + 1);
+    h = hashBytes(h, &s->version, sizeof(s->version));
+    s->fingerprint = hashBytes(h, s->spec, strlen(s->spec));
+    return SUCCESS;
+}
+
+int gradingSchemeGrade(const GradingScheme *scheme, float percent) {
+    return scheme->lookup[percentStep(percent)];
+}
+
+ErrorCode gradingSchemeApply(const GradingScheme *scheme, CampusType type, const void *data,
+                             GradingResult *result) {
+    if (!scheme || !data || !result) return ERROR_INVALID_INPUT;
+    memset(result, 0, sizeof(*result));
+    if (type == CAMPUS_SCHOOL) {
+        result->percent = gradeSchoolMarks((const SchoolMarks*)data).score;
+    } else if (type == CAMPUS_COLLEGE) {
+        const CollegeMarks *m = (const CollegeMarks*)data;
+        GradeSummary g = gradeCollegeMarks(m);
+        result->percent = g.weight > 0 ? (float)g.total / (float)g.weight : 0.0f;
+        if (scheme->gpa == GPA_MARKS) {
+            result->gpa = g.score;
+        } else {
+            int count = m->count < 0 ? 0 : m->count > MAX_SUBJECTS ? MAX_SUBJECTS : m->count;
+            float points = 0.0f;
+            int credits = 0;
+            for (int i = 0; i < count; i++) {
+                if (m->credits[i] <= 0) continue;
+                points += scheme->points[gradingSchemeGrade(scheme, (float)m->marks[i])] * (float)m->credits[i];
+                credits += m->credits[i];
+            }
+            result->gpa = credits > 0 ? points / (float)credits : 0.0f;
+        }
+    } else {
+        return ERROR_INVALID_INPUT;
+    }
+    result->grade = gradingSchemeGrade(scheme, result->percent);
+    result->passed = percentStep(result->percent) >= thresholdStep(scheme->passPercent);
+    return SUCCESS;
+}
+
+static GradingScheme **currentSlot(const char *institute, int *found) {
+    size_t lo = 0, hi = schemes.currentCount;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(schemes.current[mid]->institute, institute);
+        if (cmp == 0) {
+            *found = 1;
+            return &schemes.current[mid];
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = 0;
+    return schemes.current ? &schemes.current[lo] : NULL;
+}
+
+// Takes ownership of `s`; an older version than the current one is only kept
+static ErrorCode install(GradingScheme *s) {
+    if (schemes.allCount == schemes.allCap) {
+        size_t cap = schemes.allCap ? schemes.allCap * 2 : 16;
+        GradingScheme **all = realloc(schemes.all, cap * sizeof(*all));
+        GradingScheme **current = realloc(schemes.current, cap * sizeof(*current));
+        if (all) schemes.all = all;
+        if (current) schemes.current = current;
+        if (!all || !current) return ERROR_MEMORY;
+        schemes.allCap = cap;
+    }
+    schemes.all[schemes.allCount++] = s;
+
+    int found;
+    GradingScheme **slot = currentSlot(s->institute, &found);
+    if (found) {
+        if ((*slot)->version < s->version) *slot = s;
+        return SUCCESS;
+    }
+    size_t at = (size_t)(slot - schemes.current);
+    memmove(slot + 1, slot, (schemes.currentCount - at) * sizeof(*slot));
+    *slot = s;
+    schemes.currentCount++;
+    return SUCCESS;
+}
+
+static void visitScheme(const char *institute, int version, const char *spec, void *ctx) {
+    (void)ctx;
+    int found;
+    GradingScheme **slot = currentSlot(institute, &found);
+    if (found && (*slot)->version >= version) return;      // a rescan; already current
+    GradingScheme *s = malloc(sizeof(GradingScheme));
+    if (!s) return;
+    if (gradingSchemeCompile(institute, version, spec, s) != SUCCESS) {
+        printf("Warning: grading scheme %d of '%s' is invalid; ignored\n", version, institute);
+        free(s);
+        return;
+    }
+    if (install(s) != SUCCESS) free(s);
+}
+
+// Rescans when a scheme was added since the last scan, by this process or
+// any other (`campus scheme --set` against a running server). Only a commit
+// by another connection can have added one unseen, so the table is checked
+// only when the data version moves. `force` skips that shortcut. Caller holds
+// the lock.
+static void refresh(int force) {
+    if (!schemes.builtInReady) {
+        gradingSchemeCompile("", 0, GRADING_DEFAULT_SPEC, &schemes.builtIn);
+        schemes.builtInReady = 1;
+    }
+    // Without a database the built-in scheme (or the last scan) is all there is; try again next time
+    int64_t dataVersion, tableVersion;
+    if (getDataVersion(&dataVersion) != SUCCESS) return;
+    if (schemes.loaded && !force && dataVersion == schemes.dataVersion) return;
+    if (getGradingSchemesVersion(&tableVersion) != SUCCESS) return;
+    if (!schemes.loaded || tableVersion != schemes.tableVersion) {
+        if (scanGradingSchemes(visitScheme, NULL) != SUCCESS) return;
+        schemes.loaded = 1;
+        schemes.tableVersion = tableVersion;
+    }
+    schemes.dataVersion = dataVersion;
+}
+
+const GradingScheme *gradingSchemeFor(const char *institute) {
+    pthread_mutex_lock(&schemes.lock);
+    refresh(0);
+    int found = 0;
+    GradingScheme **slot = NULL;
+    if (institute && institute[0]) slot = currentSlot(institute, &found);
+    if (!found) slot = currentSlot("", &found);
+    const GradingScheme *s = found ? *slot : &schemes.builtIn;
+    pthread_mutex_unlock(&schemes.lock);
+    return s;
+}
+
+ErrorCode gradingSchemeAdd(const char *institute, const char *spec, int *version) {
+    if (!institute || !spec) return ERROR_INVALID_INPUT;
+    GradingScheme *s = malloc(sizeof(GradingScheme));
+    if (!s) return ERROR_MEMORY;
+    int stored = 0;
+    ErrorCode rc = gradingSchemeCompile(institute, 0, spec, s);
+    if (rc == SUCCESS) rc = addGradingScheme(institute, s->spec, &stored);
+    if (rc == SUCCESS) rc = gradingSchemeCompile(institute, stored, spec, s);
+    if (rc != SUCCESS) {
+        free(s);
+        return rc;
+    }
+
+    pthread_mutex_lock(&schemes.lock);
+    refresh(1);
+    // Normally the scan has read the new row; install it by hand if not
+    int found;
+    GradingScheme **slot = currentSlot(institute, &found);
+    int installed = !(found && (*slot)->version >= stored) && (rc = install(s)) == SUCCESS;
+    pthread_mutex_unlock(&schemes.lock);
+    if (!installed) free(s);
+    if (version) *version = stored;
+    return rc;
+}
+
+void gradingSchemesReset(void) {
+    pthread_mutex_lock(&schemes.lock);
+    for (size_t i = 0; i < schemes.allCount; i++) free(schemes.all[i]);
+    free(schemes.all);
+    free(schemes.current);
+    schemes.all = schemes.current = NULL;
+    schemes.allCount = schemes.allCap = schemes.currentCount = 0;
+    schemes.loaded = 0;
+    pthread_mutex_unlock(&schemes.lock);
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/intern.h"
+#include "../include/database.h"
+
+typedef struct InternEntry {
+    struct InternEntry *next;
+    uint32_t hash;
+    uint32_t id;
+    size_t length;
+    char text[];
+} InternEntry;
+
+// text -> id: chained hash per shard, growing x2
+typedef struct {
+    pthread_rwlock_t lock;
+    InternEntry **buckets;
+    size_t bucketCount;         // power of two; 0 until the first insert
+    size_t count;
+    size_t bytes;
+} InternShard;
+
+static InternShard shards[INTERN_SHARDS];
+static pthread_once_t shardsOnce = PTHREAD_ONCE_INIT;
+
+// id -> entry: pages are allocated on first use and published with a CAS, so
+// readers never lock. Entries stay put until internReset.
+typedef _Atomic(InternEntry *) InternSlot;
+static _Atomic(InternSlot *) pages[INTERN_PAGES];
+
+static void initShards(void) {
+    for (int i = 0; i < INTERN_SHARDS; i++) pthread_rwlock_init(&shards[i].lock, NULL);
+}
+
+static uint32_t hashText(const char *text, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++) h = (h ^ (unsigned char)text[i]) * 16777619u;
+    return h;
+}
+
+static InternShard *shardOf(uint32_t hash) {
+    return &shards[hash % INTERN_SHARDS];
+}
+
+static size_t bucketOf(const InternShard *s, uint32_t hash) {
+    return (hash / INTERN_SHARDS) & (s->bucketCount - 1);
+}
+
+static InternEntry *findEntry(const InternShard *s, const char *text, size_t length, uint32_t hash) {
+    if (s->bucketCount == 0) return NULL;
+    for (InternEntry *e = s->buckets[bucketOf(s, hash)]; e; e = e->next) {
+        if (e->hash == hash && e->length == length && memcmp(e->text, text, length) == 0) return e;
+    }
+    return NULL;
+}
+
+static int cacheFind(const char *text, size_t length, uint32_t hash, uint32_t *id) {
+    InternShard *s = shardOf(hash);
+    pthread_rwlock_rdlock(&s->lock);
+    InternEntry *e = findEntry(s, text, length, hash);
+    if (e) *id = e->id;
+    pthread_rwlock_unlock(&s->lock);
+    return e != NULL;
+}
+
+static void publish(InternEntry *e) {
+    size_t page = e->id / INTERN_PAGE_IDS;
+    if (page >= INTERN_PAGES) return;
+    InternSlot *slots = atomic_load_explicit(&pages[page], memory_order_acquire);
+    if (!slots) {
+        InternSlot *fresh = (InternSlot*)calloc(INTERN_PAGE_IDS, sizeof(InternSlot));
+        if (!fresh) return;
+        InternSlot *expected = NULL;
+        if (atomic_compare_exchange_strong_explicit(&pages[page], &expected, fresh,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            slots = fresh;
+        } else {
+            free(fresh);
+            slots = expected;
+        }
+    }
+    atomic_store_explicit(&slots[e->id % INTERN_PAGE_IDS], e, memory_order_release);
+}
+
+static int grow(InternShard *s) {
+    size_t count = s->bucketCount ? s->bucketCount * 2 : 64;
+    InternEntry **buckets = (InternEntry**)calloc(count, sizeof(InternEntry*));
+    if (!buckets) return 0;
+    size_t old = s->bucketCount;
+    InternEntry **oldBuckets = s->buckets;
+    s->buckets = buckets;
+    s->bucketCount = count;
+    for (size_t i = 0; i < old; i++) {
+        InternEntry *e = oldBuckets[i];
+        while (e) {
+            InternEntry *next = e->next;
+            size_t b = bucketOf(s, e->hash);
+            e->next = buckets[b];
+            buckets[b] = e;
+            e = next;
+        }
+    }
+    free(oldBuckets);
+    return 1;
+}
+
+// Caches a committed mapping; a failed allocation only costs a later miss
+static void cacheAdd(const char *text, size_t length, uint32_t hash, uint32_t id) {
+    InternShard *s = shardOf(hash);
+    pthread_rwlock_wrlock(&s->lock);
+    if (!findEntry(s, text, length, hash) && (s->count < s->bucketCount || grow(s))) {
+        InternEntry *e = (InternEntry*)malloc(sizeof(InternEntry) + length + 1);
+        if (e) {
+            e->hash = hash;
+            e->id = id;
+            e->length = length;
+            memcpy(e->text, text, length + 1);
+            size_t b = bucketOf(s, hash);
+            e->next = s->buckets[b];
+            s->buckets[b] = e;
+            s->count++;
+            s->bytes += length + 1;
+            publish(e);
+        }
+    }
+    pthread_rwlock_unlock(&s->lock);
+}
+
+static ErrorCode intern(const char *text, int create, uint32_t *id) {
+    if (!text || !id) return ERROR_INVALID_INPUT;
+    size_t length = strlen(text);
+    if (length == 0) {
+        *id = 0;
+        return SUCCESS;
+    }
+    if (length >= INTERN_TEXT_MAX) return create ? ERROR_INVALID_INPUT : ERROR_NOT_FOUND;
+    pthread_once(&shardsOnce, initShards);
+
+    uint32_t hash = hashText(text, length);
+    if (cacheFind(text, length, hash, id)) return SUCCESS;
+    int committed = 0;
+    ErrorCode rc = findStringRow(text, create, id, &committed);
+    if (rc == SUCCESS && committed) cacheAdd(text, length, hash, *id);
+    return rc;
+}
+
+ErrorCode internString(const char *text, uint32_t *id) {
+    return intern(text, 1, id);
+}
+
+ErrorCode internFind(const char *text, uint32_t *id) {
+    return intern(text, 0, id);
+}
+
+ErrorCode internText(uint32_t id, char *text, size_t size) {
+    if (!text || size == 0) return ERROR_INVALID_INPUT;
+    text[0] = '\0';
+    if (id == 0) return SUCCESS;
+    pthread_once(&shardsOnce, initShards);
+
+    if (id / INTERN_PAGE_IDS < INTERN_PAGES) {
+        InternSlot *slots = atomic_load_explicit(&pages[id / INTERN_PAGE_IDS], memory_order_acquire);
+        InternEntry *e = slots ? atomic_load_explicit(&slots[id % INTERN_PAGE_IDS], memory_order_acquire) : NULL;
+        if (e) {
+            snprintf(text, size, "%s", e->text);
+            return SUCCESS;
+        }
+    }
+
+    char row[INTERN_TEXT_MAX];
+    int committed = 0;
+    ErrorCode rc = loadStringRow(id, row, sizeof(row), &committed);
+    if (rc != SUCCESS) return rc;
+    size_t length = strlen(row);
+    if (committed && length > 0) cacheAdd(row, length, hashText(row, length), id);
+    snprintf(text, size, "%s", row);
+    return SUCCESS;
+}
+
+void internGetStats(InternStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    pthread_once(&shardsOnce, initShards);
+    for (int i = 0; i < INTERN_SHARDS; i++) {
+        pthread_rwlock_rdlock(&shards[i].lock);
+        stats->strings += shards[i].count;
+        stats->bytes += shards[i].bytes;
+        pthread_rwlock_unlock(&shards[i].lock);
+    }
+}
+
+void internReset(void) {
+    pthread_once(&shardsOnce, initShards);
+    for (size_t p = 0; p < INTERN_PAGES; p++) {
+        free(atomic_exchange_explicit(&pages[p], NULL, memory_order_acq_rel));
+    }
+    for (int i = 0; i < INTERN_SHARDS; i++) {
+        InternShard *s = &shards[i];
+        pthread_rwlock_wrlock(&s->lock);
+        for (size_t b = 0; b < s->bucketCount; b++) {
+            InternEntry *e = s->buckets[b];
+            while (e) {
+                InternEntry *next = e->next;
+                free(e);
+                e = next;
+            }
+        }
+        free(s->buckets);
+        s->buckets = NULL;
+        s->bucketCount = 0;
+        s->count = 0;
+        s->bytes = 0;
+        pthread_rwlock_unlock(&s->lock);
+    }
+}
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include "../include/logger.h"
+
+#define LOG_USER_LEN            20
+#define LOG_ACTION_LEN          100
+#define LOG_DEFAULT_CAPACITY    4096
+#define LOG_DEFAULT_MAX_BYTES   (8u * 1024u * 1024u)
+#define LOG_DEFAULT_ROTATIONS   5
+#define LOG_IDLE_WAIT_MS        50
+#define LOG_CACHE_LINE          64
+
+// One ring slot. seq == pos means free for the producer claiming pos,
+// seq == pos + 1 means filled and ready for the writer.
+typedef struct {
+    atomic_size_t seq;
+    time_t when;
+    char userID[LOG_USER_LEN];
+    char action[LOG_ACTION_LEN];
+} LogSlot;
+
+typedef struct {
+    LogSlot *slots;
+    size_t mask;
+    LoggerConfig config;
+    char path[256];
+
+    // Producer and consumer cursors live on separate cache lines
+    _Alignas(LOG_CACHE_LINE) atomic_size_t enqueuePos;
+    _Alignas(LOG_CACHE_LINE) atomic_size_t dequeuePos;
+    atomic_size_t flushedPos;
+    atomic_int writerSleeping;
+    atomic_int running;
+    atomic_int producers;       // callers currently inside loggerSubmit
+
+    pthread_t writer;
+    pthread_mutex_t wakeLock;
+    pthread_cond_t wakeCond;
+    pthread_cond_t flushCond;
+
+    // Writer-thread-only state
+    FILE *file;
+    size_t fileBytes;
+    time_t cachedSecond;
+    char cachedStamp[32];
+
+    atomic_ullong submitted;
+    atomic_ullong written;
+    atomic_ullong dropped;
+    atomic_ullong rotations;
+} Logger;
+
+static Logger logger;
+static pthread_mutex_t lifecycleLock = PTHREAD_MUTEX_INITIALIZER;
+
+LoggerConfig loggerDefaultConfig(void) {
+    LoggerConfig config;
+    config.path = AUDIT_LOG_FILE;
+    config.capacity = LOG_DEFAULT_CAPACITY;
+    config.maxFileBytes = LOG_DEFAULT_MAX_BYTES;
+    config.maxRotatedFiles = LOG_DEFAULT_ROTATIONS;
+    config.policy = LOG_POLICY_DROP;
+    return config;
+}
+
+static void ensureParentDir(const char *path) {
+    char dir[256];
+    const char *slash = strrchr(path, '/');
+    if (!slash || slash == path) return;
+    size_t len = (size_t)(slash - path);
+    if (len >= sizeof(dir)) return;
+    memcpy(dir, path, len);
+    dir[len] = '\0';
+#ifdef _WIN32
+    _mkdir(dir);
+#else
+    mkdir(dir, 0700);
+#endif
+}
+
+static void addMillis(struct timespec *ts, long ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+static void wakeWriter(void) {
+    pthread_mutex_lock(&logger.wakeLock);
+    pthread_cond_signal(&logger.wakeCond);
+    pthread_mutex_unlock(&logger.wakeLock);
+}
+
+// Reformat the timestamp only when the second changes (ctime layout,
+// so existing readers of login_audit.log keep working)
+static const char *formatStamp(time_t when) {
+    if (when != logger.cachedSecond || logger.cachedStamp[0] == '\0') {
+        struct tm tmInfo;
+#ifdef _WIN32
+        if (localtime_s(&tmInfo, &when) != 0) {
+#else
+        if (!localtime_r(&when, &tmInfo)) {
+#endif
+            snprintf(logger.cachedStamp, sizeof(logger.cachedStamp), "[time unavailable]");
+        } else {
+            strftime(logger.cachedStamp, sizeof(logger.cachedStamp), "%a %b %e %H:%M:%S %Y", &tmInfo);
+        }
+        logger.cachedSecond = when;
+    }
+    return logger.cachedStamp;
+}
+
+static void openLogFile(void) {
+    logger.file = fopen(logger.path, "a");
+    logger.fileBytes = 0;
+    if (logger.file) {
+        fseek(logger.file, 0, SEEK_END);
+        long size = ftell(logger.file);
+        logger.fileBytes = size > 0 ? (size_t)size : 0;
+    }
+}
+
+static void rotateLogFile(void) {
+    char from[300], to[300];
+    if (logger.file) {
+        fclose(logger.file);
+        logger.file = NULL;
+    }
+    for (int i = logger.config.maxRotatedFiles - 1; i >= 1; i--) {
+        snprintf(from, sizeof(from), "%s.%d", logger.path, i);
+        snprintf(to, sizeof(to), "%s.%d", logger.path, i + 1);
+        remove(to);
+        rename(from, to);
+    }
+    if (logger.config.maxRotatedFiles > 0) {
+        snprintf(to, sizeof(to), "%s.1", logger.path);
+        remove(to);
+        rename(logger.path, to);
+    } else {
+        remove(logger.path);
+    }
+    openLogFile();
+    atomic_fetch_add_explicit(&logger.rotations, 1, memory_order_relaxed);
+}
+
+static void writeSlot(const LogSlot *slot) {
+    if (!logger.file) return;
+    int n = fprintf(logger.file, "%s: %s at %s\n", slot->action, slot->userID, formatStamp(slot->when));
+    if (n > 0) logger.fileBytes += (size_t)n;
+    atomic_fetch_add_explicit(&logger.written, 1, memory_order_relaxed);
+    if (logger.config.maxFileBytes > 0 && logger.fileBytes >= logger.config.maxFileBytes) {
+        rotateLogFile();
+    }
+}
+
+static int slotReady(size_t pos) {
+    LogSlot *slot = &logger.slots[pos & logger.mask];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == pos + 1;
+}
+
+// Drain everything that is currently published; returns number of events written
+static size_t drainRing(void) {
+    size_t pos = atomic_load_explicit(&logger.dequeuePos, memory_order_relaxed);
+    size_t count = 0;
+    while (slotReady(pos)) {
+        LogSlot *slot = &logger.slots[pos & logger.mask];
+        writeSlot(slot);
+        atomic_store_explicit(&slot->seq, pos + logger.mask + 1, memory_order_release);
+        pos++;
+        count++;
+        if (count > logger.mask) break; // let the loop flush under sustained load
+    }
+    atomic_store_explicit(&logger.dequeuePos, pos, memory_order_release);
+    return count;
+}
+
+static void *writerMain(void *arg) {
+    (void)arg;
+    for (;;) {
+        size_t drained = drainRing();
+        if (drained > logger.mask) continue;
+
+        if (logger.file) fflush(logger.file);
+        pthread_mutex_lock(&logger.wakeLock);
+        atomic_store(&logger.flushedPos, atomic_load(&logger.dequeuePos));
+        pthread_cond_broadcast(&logger.flushCond);
+        pthread_mutex_unlock(&logger.wakeLock);
+
+        size_t pos = atomic_load_explicit(&logger.dequeuePos, memory_order_relaxed);
+        if (!atomic_load(&logger.running) &&
+            pos == atomic_load(&logger.enqueuePos)) {
+            break;
+        }
+
+        // Announce sleep before re-checking, producers check the flag after publishing
+        atomic_store(&logger.writerSleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!slotReady(pos) && atomic_load(&logger.running)) {
+            struct timespec deadline;
+            addMillis(&deadline, LOG_IDLE_WAIT_MS);
+            pthread_mutex_lock(&logger.wakeLock);
+            pthread_cond_timedwait(&logger.wakeCond, &logger.wakeLock, &deadline);
+            pthread_mutex_unlock(&logger.wakeLock);
+        }
+        atomic_store(&logger.writerSleeping, 0);
+    }
+    if (logger.file) {
+        fclose(logger.file);
+        logger.file = NULL;
+    }
+    return NULL;
+}
+
+ErrorCode loggerStart(const LoggerConfig *config) {
+    LoggerConfig cfg = config ? *config : loggerDefaultConfig();
+    if (!cfg.path || cfg.capacity < 2) return ERROR_INVALID_INPUT;
+
+    pthread_mutex_lock(&lifecycleLock);
+    if (atomic_load(&logger.running)) {
+        pthread_mutex_unlock(&lifecycleLock);
+        return ERROR_ALREADY_EXISTS;
+    }
+
+    size_t capacity = 2;
+    while (capacity < cfg.capacity) capacity <<= 1;
+
+    LogSlot *slots = (LogSlot*)calloc(capacity, sizeof(LogSlot));
+    if (!slots) {
+        pthread_mutex_unlock(&lifecycleLock);
+        return ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&slots[i].seq, i);
+    }
+
+    logger.slots = slots;
+    logger.mask = capacity - 1;
+    logger.config = cfg;
+    strncpy(logger.path, cfg.path, sizeof(logger.path) - 1);
+    logger.path[sizeof(logger.path) - 1] = '\0';
+    logger.config.path = logger.path;
+    logger.cachedSecond = 0;
+    logger.cachedStamp[0] = '\0';
+    atomic_store(&logger.enqueuePos, 0);
+    atomic_store(&logger.dequeuePos, 0);
+    atomic_store(&logger.flushedPos, 0);
+    atomic_store(&logger.writerSleeping, 0);
+    atomic_store(&logger.submitted, 0);
+    atomic_store(&logger.written, 0);
+    atomic_store(&logger.dropped, 0);
+    atomic_store(&logger.rotations, 0);
+
+    ensureParentDir(logger.path);
+    openLogFile();
+    if (!logger.file) {
+        fprintf(stderr, "Logging failed: cannot open %s\n", logger.path);
+        free(logger.slots);
+        logger.slots = NULL;
+        pthread_mutex_unlock(&lifecycleLock);
+        return ERROR_FILE_IO;
+    }
+
+    pthread_mutex_init(&logger.wakeLock, NULL);
+    pthread_cond_init(&logger.wakeCond, NULL);
+    pthread_cond_init(&logger.flushCond, NULL);
+    atomic_store(&logger.running, 1);
+
+    if (pthread_create(&logger.writer, NULL, writerMain, NULL) != 0) {
+        atomic_store(&logger.running, 0);
+        fclose(logger.file);
+        logger.file = NULL;
+        free(logger.slots);
+        logger.slots = NULL;
+        pthread_mutex_unlock(&lifecycleLock);
+        return ERROR_GENERAL;
+    }
+    pthread_mutex_unlock(&lifecycleLock);
+    return SUCCESS;
+}
+
+int loggerIsRunning(void) {
+    return atomic_load(&logger.running);
+}
+
+ErrorCode loggerSubmit(const char *userID, const char *action) {
+    if (!userID || !action) return ERROR_INVALID_INPUT;
+    atomic_fetch_add(&logger.producers, 1);
+    if (!atomic_load(&logger.running)) {
+        atomic_fetch_sub(&logger.producers, 1);
+        return ERROR_GENERAL;
+    }
+
+    atomic_fetch_add_explicit(&logger.submitted, 1, memory_order_relaxed);
+    size_t pos = atomic_load_explicit(&logger.enqueuePos, memory_order_relaxed);
+    LogSlot *slot;
+    for (;;) {
+        slot = &logger.slots[pos & logger.mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&logger.enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring is full
+            if (logger.config.policy == LOG_POLICY_DROP) {
+                atomic_fetch_add_explicit(&logger.dropped, 1, memory_order_relaxed);
+                atomic_fetch_sub(&logger.producers, 1);
+                return ERROR_GENERAL;
+            }
+            wakeWriter();
+            sched_yield();
+            pos = atomic_load_explicit(&logger.enqueuePos, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&logger.enqueuePos, memory_order_relaxed);
+        }
+    }
+
+    slot->when = time(NULL);
+    strncpy(slot->userID, userID, LOG_USER_LEN - 1);
+    slot->userID[LOG_USER_LEN - 1] = '\0';
+    strncpy(slot->action, action, LOG_ACTION_LEN - 1);
+    slot->action[LOG_ACTION_LEN - 1] = '\0';
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&logger.writerSleeping, memory_order_relaxed)) {
+        wakeWriter();
+    }
+    atomic_fetch_sub(&logger.producers, 1);
+    return SUCCESS;
+}
+
+// Block until everything submitted before this call is on disk (fflush'ed)
+ErrorCode loggerFlush(void) {
+    if (!atomic_load(&logger.running)) return ERROR_GENERAL;
+    size_t target = atomic_load(&logger.enqueuePos);
+    pthread_mutex_lock(&logger.wakeLock);
+    pthread_cond_signal(&logger.wakeCond);
+    while (atomic_load(&logger.flushedPos) < target && atomic_load(&logger.running)) {
+        struct timespec deadline;
+        addMillis(&deadline, LOG_IDLE_WAIT_MS);
+        pthread_cond_timedwait(&logger.flushCond, &logger.wakeLock, &deadline);
+    }
+    pthread_mutex_unlock(&logger.wakeLock);
+    return SUCCESS;
+}
+
+ErrorCode loggerStop(void) {
+    pthread_mutex_lock(&lifecycleLock);
+    if (!atomic_load(&logger.running)) {
+        pthread_mutex_unlock(&lifecycleLock);
+        return SUCCESS;
+    }
+    atomic_store(&logger.running, 0);
+    // Let callers that already passed the running check publish their slot
+    while (atomic_load(&logger.producers) > 0) {
+        wakeWriter();
+        sched_yield();
+    }
+    wakeWriter();
+    pthread_join(logger.writer, NULL);
+
+    pthread_cond_destroy(&logger.flushCond);
+    pthread_cond_destroy(&logger.wakeCond);
+    pthread_mutex_destroy(&logger.wakeLock);
+    free(logger.slots);
+    logger.slots = NULL;
+    pthread_mutex_unlock(&lifecycleLock);
+    return SUCCESS;
+}
+
+void loggerGetStats(LoggerStats *stats) {
+    if (!stats) return;
+    stats->submitted = atomic_load(&logger.submitted);
+    stats->written = atomic_load(&logger.written);
+    stats->dropped = atomic_load(&logger.dropped);
+    stats->rotations = atomic_load(&logger.rotations);
+}
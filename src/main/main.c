@@ -1,4 +1,17 @@
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <ctype.h>
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#else
+#include <unistd.h>
+#endif
 #include "auth.h"
 #include "config.h"
 #include "student.h"
@@ -7,6 +20,15 @@
 #include "fileio.h"
 #include "database.h"
 #include "campus_security.h"
+#include "audit_segment.h"
+#include "db_maintenance.h"
+#include "api/server.h"
+#include "api/batch.h"
+#include "report_run.h"
+#include "report_merge.h"
+#include "grading_scheme.h"
+#include "regrade.h"
+#include "migrate.h"
 #include "hpdf/hpdf.h"
 
 // Function declarations
@@ -21,7 +43,398 @@ void displayMainMenu() {
     printf("Select option: ");
 }
 
-int main() {
+static void printUsage(const char *prog) {
+    printf("Usage: %s                      interactive menu\n", prog);
+    printf("       %s audit [--user ID] [--from TIME] [--to TIME] [--dir DIR]\n", prog);
+    printf("            stream audit events as NDJSON (TIME: epoch seconds or YYYY-MM-DD[THH:MM:SS] UTC)\n");
+    printf("       %s maintain                run every database maintenance job once and print stats\n", prog);
+    printf("       %s serve [--http] [--unix PATH | --host HOST --port N] [--workers N] [--processes N]\n", prog);
+    printf("            serve the JSON API as newline-delimited JSON, or HTTP/1.1 with --http\n");
+    printf("       %s batch [--atomic] [--stop-on-error] FILE|-\n", prog);
+    printf("            run one JSON request per line without prompts; one result line each\n");
+    printf("       %s scheme [--institute NAME] [--set SPEC]\n", prog);
+    printf("            show or replace an institute's grading scheme (\"\" is the default)\n");
+    printf("       %s regrade [--institute NAME] [--threads N]\n", prog);
+    printf("            grade stored marks again under the current schemes into grade_results\n");
+    printf("       %s reports --institute NAME --campus TYPE [--threads N] [--out DIR] [--merged FILE [--order id|rank]]\n", prog);
+    printf("            render every report of an institute, or one merged PDF in user ID or rank order\n");
+    printf("       %s migrate [--threads N] [--remove] [--restart]\n", prog);
+    printf("            import legacy credentials/ and data/ files into the database (resumable)\n");
+}
+
+// audit: read binary audit segments and stream a user/time range as NDJSON
+static int runAuditCommand(int argc, char *argv[]) {
+    const char *user = NULL;
+    const char *dir = AUDIT_DIR;
+    uint64_t from = 0, to = UINT64_MAX;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--user") == 0 && i + 1 < argc) {
+            user = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            if (auditParseTime(argv[++i], &from) != SUCCESS) {
+                fprintf(stderr, "Invalid --from time: %s\n", argv[i]);
+                return ERROR_INVALID_INPUT;
+            }
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            if (auditParseTime(argv[++i], &to) != SUCCESS) {
+                fprintf(stderr, "Invalid --to time: %s\n", argv[i]);
+                return ERROR_INVALID_INPUT;
+            }
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    return auditExportNDJSON(stdout, dir, user, from, to);
+}
+
+// maintain: checkpoint, vacuum, optimize and quick_check now instead of waiting for idle time
+static int runMaintainCommand(void) {
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    ErrorCode result = SUCCESS;
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+        if (maintenanceRunNow((MaintenanceJob)job) != SUCCESS) {
+            fprintf(stderr, "%s failed\n", maintenanceJobName((MaintenanceJob)job));
+            result = ERROR_DATABASE;
+        }
+    }
+    maintenancePrintStats(stdout);
+    closeDatabase();
+    return result;
+}
+
+static void onServeSignal(int sig) {
+    (void)sig;
+    serverStop();
+}
+
+// Prefork worker process: its own SQLite connection and audit segments. The
+// supervisor has already created the schema, so this only opens things.
+static ErrorCode startServeProcess(int index) {
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    char dir[64];
+    snprintf(dir, sizeof(dir), AUDIT_DIR "worker-%d/", index);
+    auditClose();
+    if (auditOpen(dir) != SUCCESS) fprintf(stderr, "Warning: binary audit log unavailable in worker %d\n", index);
+    return SUCCESS;
+}
+
+static void stopServeProcess(void) {
+    closeDatabase();
+}
+
+// serve: headless JSON API (NDJSON or HTTP) until SIGINT/SIGTERM
+static int runServeCommand(int argc, char *argv[]) {
+    ServerConfig config = serverDefaultConfig();
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--unix") == 0 && i + 1 < argc) {
+            config.unixPath = argv[++i];
+        } else if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            config.host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            config.port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--http") == 0) {
+            config.protocol = SERVER_PROTOCOL_HTTP;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            config.workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc) {
+            config.processes = atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (config.port <= 0 || config.port > 65535 || config.workers < 1 || config.processes < 0) {
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+    // Prefork workers open their own connection after the fork. Schema
+    // creation and migrations run once here first, so they do not race.
+    int prefork = config.processes > 1;
+    if (prefork) {
+        if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+        closeDatabase();
+        config.processStart = startServeProcess;
+        config.processStop = stopServeProcess;
+    } else if (initDatabase() != SUCCESS) {
+        return ERROR_DATABASE;
+    }
+
+#ifndef _WIN32
+    signal(SIGPIPE, SIG_IGN);
+#endif
+    signal(SIGINT, onServeSignal);
+    signal(SIGTERM, onServeSignal);
+
+    const char *protocol = config.protocol == SERVER_PROTOCOL_HTTP ? "HTTP" : "NDJSON";
+    if (config.unixPath) fprintf(stderr, "Serving %s on %s", protocol, config.unixPath);
+    else fprintf(stderr, "Serving %s on %s:%d", protocol, config.host, config.port);
+    if (prefork) fprintf(stderr, " with %d worker processes", config.processes);
+    fprintf(stderr, "\n");
+    ErrorCode result = serverRun(&config);
+
+    ServerStats stats;
+    serverGetStats(&stats);
+    fprintf(stderr, "Stopped: %llu connections, %llu requests, %llu protocol errors\n",
+            stats.accepted, stats.requests, stats.protocolErrors);
+    if (!prefork) closeDatabase();
+    return result;
+}
+
+// batch: run a script of API requests (signup, data_put, export, ...) without prompts
+static int runBatchCommand(int argc, char *argv[]) {
+    BatchOptions options = { 0, 0 };
+    const char *path = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--atomic") == 0) {
+            options.atomic = 1;
+        } else if (strcmp(argv[i], "--stop-on-error") == 0) {
+            options.stopOnError = 1;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (!path) {
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return ERROR_FILE_IO;
+    }
+    if (initDatabase() != SUCCESS) {
+        if (in != stdin) fclose(in);
+        return ERROR_DATABASE;
+    }
+
+    // Results own stdout; chatter printed by the core (export notices) goes to stderr
+    fflush(stdout);
+    FILE *out = fdopen(dup(1), "w");
+    if (!out || dup2(2, 1) < 0) {
+        if (out) fclose(out);
+        out = stdout;
+    }
+
+    BatchStats stats;
+    ErrorCode result = batchRun(in, out, &options, &stats);
+    if (out != stdout) fclose(out);
+    fprintf(stderr, "Batch: %llu requests, %llu succeeded, %llu failed, %llu rolled back in %llu groups\n",
+            stats.requests, stats.succeeded, stats.failed, stats.rolledBack, stats.groups);
+    if (in != stdin) fclose(in);
+    closeDatabase();
+    return result;
+}
+
+static CampusType parseCampusName(const char *name) {
+    for (int type = CAMPUS_SCHOOL; type < CAMPUS_AMOUNT; type++) {
+        const char *known = getCampusName((CampusType)type);
+        size_t i = 0;
+        while (known[i] && tolower((unsigned char)name[i]) == tolower((unsigned char)known[i])) i++;
+        if (!known[i] && !name[i]) return (CampusType)type;
+    }
+    return CAMPUS_NONE;
+}
+
+// reports --merged: one PDF for the whole institute, in user ID or rank order
+static int runMergedReport(const char *institute, CampusType type, const char *path, ReportOrder order) {
+    MergedReportStats stats;
+    ErrorCode result = writeInstituteMergedReport(institute, type, order, path, &stats);
+    if (result == ERROR_NOT_FOUND) {
+        fprintf(stderr, "No %s reports to print at %s\n", getCampusName(type), institute);
+    } else if (result != SUCCESS) {
+        fprintf(stderr, "Cannot write %s\n", path);
+    } else {
+        printf("Merged report: %zu pages (%zu users without data), %llu bytes in %.2f s -> %s\n",
+               stats.pages, stats.missingData, (unsigned long long)stats.bytes, stats.seconds, path);
+    }
+    return result;
+}
+
+// reports: render every report of one institute and campus type in parallel
+static int runReportsCommand(int argc, char *argv[]) {
+    ReportRunOptions options = reportRunDefaultOptions();
+    const char *institute = NULL;
+    const char *merged = NULL;
+    ReportOrder order = REPORT_ORDER_ID;
+    CampusType type = CAMPUS_NONE;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--institute") == 0 && i + 1 < argc) {
+            institute = argv[++i];
+        } else if (strcmp(argv[i], "--campus") == 0 && i + 1 < argc) {
+            type = parseCampusName(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            options.outDir = argv[++i];
+        } else if (strcmp(argv[i], "--merged") == 0 && i + 1 < argc) {
+            merged = argv[++i];
+        } else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc && strcmp(argv[i + 1], "id") == 0) {
+            order = REPORT_ORDER_ID;
+            i++;
+        } else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc && strcmp(argv[i + 1], "rank") == 0) {
+            order = REPORT_ORDER_RANK;
+            i++;
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (!institute || type == CAMPUS_NONE || options.threads < 0) {
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    if (merged) {
+        ErrorCode result = runMergedReport(institute, type, merged, order);
+        closeDatabase();
+        return result;
+    }
+
+    ReportRunStats stats;
+    ErrorCode result = runInstituteReports(institute, type, &options, &stats);
+    if (result == ERROR_NOT_FOUND) {
+        fprintf(stderr, "No %s users at %s\n", getCampusName(type), institute);
+    } else {
+        printf("Reports: %zu users, %zu written, %zu without data, %zu failed\n",
+               stats.users, stats.written, stats.missingData, stats.failed);
+        printf("%d threads, %zu steals, %.2f s (%.1f reports/s)\n", stats.threads, stats.steals,
+               stats.seconds, stats.seconds > 0 ? stats.written / stats.seconds : 0.0);
+    }
+    closeDatabase();
+    return result;
+}
+
+// scheme: print the scheme an institute grades with, or store a new version
+static int runSchemeCommand(int argc, char *argv[]) {
+    const char *institute = "";
+    const char *spec = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--institute") == 0 && i + 1 < argc) {
+            institute = argv[++i];
+        } else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            spec = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    ErrorCode result = SUCCESS;
+    if (spec) {
+        int version = 0;
+        result = gradingSchemeAdd(institute, spec, &version);
+        if (result == ERROR_INVALID_INPUT) fprintf(stderr, "Invalid grading scheme: %s\n", spec);
+        else if (result == SUCCESS) printf("Stored version %d; run 'regrade' to update grade_results\n", version);
+    }
+    const GradingScheme *scheme = gradingSchemeFor(institute);
+    printf("%s v%d: %s\n", scheme->institute[0] ? scheme->institute : "(default)", scheme->version, scheme->spec);
+    closeDatabase();
+    return result;
+}
+
+static void printRegradeProgress(const RegradeProgress *progress, void *ctx) {
+    (void)ctx;
+    fprintf(stderr, "\rRegraded %zu / %zu (%.0f students/s)", progress->done, progress->total, progress->perSecond);
+    if (progress->done == progress->total) fprintf(stderr, "\n");
+}
+
+// regrade: recompute grade_results after a scheme change
+static int runRegradeCommand(int argc, char *argv[]) {
+    RegradeOptions options = regradeDefaultOptions();
+    const char *institute = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--institute") == 0 && i + 1 < argc) {
+            institute = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (options.threads < 0) {
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    options.progress = printRegradeProgress;
+
+    RegradeStats stats;
+    ErrorCode result = runRegrade(institute, &options, &stats);
+    if (result == ERROR_NOT_FOUND) {
+        fprintf(stderr, "No school or college students%s%s\n", institute ? " at " : "", institute ? institute : "");
+    } else {
+        printf("Regrade: %zu students, %zu graded, %zu without marks, %zu of %zu chunks failed\n",
+               stats.students, stats.graded, stats.missingData, stats.failedChunks, stats.chunks);
+        printf("%d threads, %.2f s (%.1f students/s)\n", stats.threads, stats.seconds,
+               stats.seconds > 0 ? stats.students / stats.seconds : 0.0);
+    }
+    closeDatabase();
+    return result;
+}
+
+static void printMigrateProgress(const MigrateProgress *progress, void *ctx) {
+    (void)ctx;
+    fprintf(stderr, "\rMigrated %zu / %zu files (%.0f files/s)", progress->done, progress->total, progress->perSecond);
+    if (progress->done == progress->total) fprintf(stderr, "\n");
+}
+
+// migrate: move legacy per-user files into SQLite
+static int runMigrateCommand(int argc, char *argv[]) {
+    MigrateOptions options = migrateDefaultOptions();
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--remove") == 0) {
+            options.removeMigrated = 1;
+        } else if (strcmp(argv[i], "--restart") == 0) {
+            options.restart = 1;
+        } else {
+            printUsage(argv[0]);
+            return ERROR_INVALID_INPUT;
+        }
+    }
+    if (options.threads < 0) {
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+    if (initDatabase() != SUCCESS) return ERROR_DATABASE;
+    options.progress = printMigrateProgress;
+
+    MigrateStats stats;
+    ErrorCode result = runLegacyMigration(&options, &stats);
+    printf("Migrate: %zu files (%zu done by an earlier run): %zu profiles, %zu records, %zu locks added, "
+           "%zu already present\n", stats.files, stats.resumed, stats.profiles, stats.records, stats.locks,
+           stats.present);
+    printf("%zu invalid, %zu expired, %zu live OTPs left, %zu files removed\n", stats.invalid, stats.expired,
+           stats.pendingOtp, stats.removed);
+    printf("%d threads, %zu chunks, %.2f s (%.0f files/s)\n", stats.threads, stats.chunks, stats.seconds,
+           stats.perSecond);
+    if (result != SUCCESS) fprintf(stderr, "Migration stopped; run it again to resume\n");
+    closeDatabase();
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        if (strcmp(argv[1], "audit") == 0) return runAuditCommand(argc, argv);
+        if (strcmp(argv[1], "maintain") == 0) return runMaintainCommand();
+        if (strcmp(argv[1], "serve") == 0) return runServeCommand(argc, argv);
+        if (strcmp(argv[1], "batch") == 0) return runBatchCommand(argc, argv);
+        if (strcmp(argv[1], "reports") == 0) return runReportsCommand(argc, argv);
+        if (strcmp(argv[1], "scheme") == 0) return runSchemeCommand(argc, argv);
+        if (strcmp(argv[1], "regrade") == 0) return runRegradeCommand(argc, argv);
+        if (strcmp(argv[1], "migrate") == 0) return runMigrateCommand(argc, argv);
+        printUsage(argv[0]);
+        return ERROR_INVALID_INPUT;
+    }
+
     // Initialize database
     if (initDatabase() != SUCCESS) {
         printf("Failed to initialize database. Exiting.\n");
@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <dirent.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "../include/migrate.h"
+#include "../include/database.h"
+#include "../include/campus_unified.h"
+#include "../include/fileio.h"
+#include "../include/utils.h"
+
+#define MIGRATE_FILE_MAX 16384          // more than any profile or campus data file
+#define OTP_FILE_SIZE    (6 + sizeof(time_t))
+
+typedef enum {
+    SOURCE_PROFILES,
+    SOURCE_RECORDS,
+    SOURCE_LOCKS,
+    SOURCE_OTP,
+    SOURCE_COUNT
+} MigrateSource;
+
+// Checkpoints are kept per source and directory, as "<source>:<dir>"
+static const char *const sourceNames[SOURCE_COUNT] = { "profiles", "campus_records", "account_locks", "otp" };
+
+typedef struct {
+    char **names;
+    size_t count, capacity;
+} NameList;
+
+// What happened to one file of a chunk
+enum { FILE_INVALID, FILE_ROW, FILE_RECORD, FILE_EXPIRED, FILE_PENDING };
+
+typedef struct {
+    MigrateSource source;
+    size_t first, count;            // slice of the source's sorted names
+    int ready;
+    ImportRow *rows;
+    size_t rowCount;
+    Profile *profiles;
+    UnifiedCampusData *records;
+    char (*userIDs)[20];
+    unsigned char *outcome;         // FILE_* per file
+} MigrateChunk;
+
+typedef struct {
+    const MigrateOptions *options;
+    const char *dirs[SOURCE_COUNT];
+    char keys[SOURCE_COUNT][300];
+    NameList lists[SOURCE_COUNT];
+    MigrateChunk *chunks;
+    size_t chunkCount;
+    time_t now;
+
+    pthread_mutex_t lock;
+    pthread_cond_t readyCond;       // a chunk was decoded
+    pthread_cond_t spaceCond;       // a chunk was committed, or the run stopped
+    size_t nextChunk, committed, window;
+    int stop;
+} MigrateRun;
+
+MigrateOptions migrateDefaultOptions(void) {
+    MigrateOptions options;
+    memset(&options, 0, sizeof(options));
+    return options;
+}
+
+static int onlineCpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return n > MIGRATE_MAX_THREADS ? MIGRATE_MAX_THREADS : (int)n;
+#endif
+    return 4;
+}
+
+static double monotonicSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int hasSuffix(const char *name, const char *suffix) {
+    size_t n = strlen(name), s = strlen(suffix);
+    return n > s && strcmp(name + n - s, suffix) == 0;
+}
+
+// Which legacy source a file name belongs to, or -1
+static int classify(int inCredentials, const char *name) {
+    if (name[0] == '.') return -1;
+    if (inCredentials) {
+        const char *dot = strrchr(name, '.');
+        return dot && dot != name && strlen(dot) == 6 && strcmp(dot + 3, "pfx") == 0 ? SOURCE_PROFILES : -1;
+    }
+    if (strncmp(name, "lock_", 5) == 0 && hasSuffix(name, ".dat")) return SOURCE_LOCKS;
+    if (hasSuffix(name, "_otp.dat")) return SOURCE_OTP;
+    if (hasSuffix(name, SUBJECT_EXT)) return SOURCE_RECORDS;
+    return -1;
+}
+
+static int listAdd(NameList *list, const char *name) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        char **names = realloc(list->names, capacity * sizeof(char*));
+        if (!names) return 0;
+        list->names = names;
+        list->capacity = capacity;
+    }
+    if (!(list->names[list->count] = strdup(name))) return 0;
+    list->count++;
+    return 1;
+}
+
+static int compareNames(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Lists a directory's legacy files (a missing directory has none)
+static ErrorCode scanDir(MigrateRun *run, const char *dir, int inCredentials) {
+    DIR *d = opendir(dir);
+    if (!d) return SUCCESS;
+    struct dirent *ent;
+    ErrorCode rc = SUCCESS;
+    while (rc == SUCCESS && (ent = readdir(d)) != NULL) {
+        int source = classify(inCredentials, ent->d_name);
+        if (source >= 0 && !listAdd(&run->lists[source], ent->d_name)) rc = ERROR_MEMORY;
+    }
+    closedir(d);
+    return rc;
+}
+
+// Reads a whole file into `buffer`; returns its size, or 0 if unreadable / too big
+static size_t readWhole(const char *dir, const char *name, unsigned char *buffer) {
+    char path[512];
+    if (snprintf(path, sizeof(path), "%s%s", dir, name) >= (int)sizeof(path)) return 0;
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t length = fread(buffer, 1, MIGRATE_FILE_MAX + 1, f);
+    fclose(f);
+    return length > MIGRATE_FILE_MAX ? 0 : length;
+}
+
+// `name` minus a prefix and suffix, as a user ID
+static int stemID(const char *name, size_t prefix, size_t suffix, char *userID) {
+    size_t n = strlen(name);
+    if (n <= prefix + suffix || n - prefix - suffix >= 20) return 0;
+    memcpy(userID, name + prefix, n - prefix - suffix);
+    userID[n - prefix - suffix] = '\0';
+    return 1;
+}
+
+#define TERMINATED(field) (memchr((field), '\0', sizeof(field)) != NULL)
+
+static int decodeProfile(const unsigned char *bytes, size_t length, const char *name, Profile *p) {
+    if (length != sizeof(Profile)) return 0;
+    memcpy(p, bytes, sizeof(Profile));
+    if (!TERMINATED(p->userID) || !TERMINATED(p->name) || !TERMINATED(p->instituteName) ||
+        !TERMINATED(p->department) || !TERMINATED(p->email) || !TERMINATED(p->mobile) ||
+        !TERMINATED(p->passwordHash)) {
+        return 0;
+    }
+    if (!validateProfile(p) || p->campusType <= CAMPUS_NONE || p->campusType >= CAMPUS_AMOUNT) return 0;
+    for (int i = 0; i < p->dataCount; i++) {
+        if (!TERMINATED(p->dataFields[i])) return 0;
+    }
+    // The file must be the one writeProfile would have written for this ID
+    char path[150];
+    if (getProfilePath(path, p->userID) != SUCCESS) return 0;
+    return strcmp(path + strlen(CRED_DIR), name) == 0;
+}
+
+static int decodeRecord(const unsigned char *bytes, size_t length, const char *userID, UnifiedCampusData *data) {
+    if (campusFileDecode(bytes, length, data) != SUCCESS) return 0;
+    return strcmp(data->userID, userID) == 0 && validateCampusData(data) == SUCCESS && campusRecordSize(data) > 0;
+}
+
+static int decodeExpiry(const unsigned char *bytes, size_t length, size_t expected, size_t at, time_t *expiry) {
+    if (length != expected) return 0;
+    memcpy(expiry, bytes + at, sizeof(time_t));
+    return 1;
+}
+
+static ErrorCode allocChunk(MigrateChunk *c) {
+    c->rows = calloc(c->count, sizeof(ImportRow));
+    c->userIDs = calloc(c->count, sizeof(*c->userIDs));
+    c->outcome = calloc(c->count, 1);
+    if (c->source == SOURCE_PROFILES) c->profiles = malloc(c->count * sizeof(Profile));
+    if (c->source == SOURCE_RECORDS) c->records = malloc(c->count * sizeof(UnifiedCampusData));
+    int ok = c->rows && c->userIDs && c->outcome &&
+             (c->source != SOURCE_PROFILES || c->profiles) && (c->source != SOURCE_RECORDS || c->records);
+    return ok ? SUCCESS : ERROR_MEMORY;
+}
+
+static void freeChunk(MigrateChunk *c) {
+    free(c->rows);
+    free(c->userIDs);
+    free(c->outcome);
+    free(c->profiles);
+    free(c->records);
+    c->rows = NULL;
+    c->userIDs = NULL;
+    c->outcome = NULL;
+    c->profiles = NULL;
+    c->records = NULL;
+}
+
+// Reads, decodes and validates every file of a chunk into import rows.
+// Invalid files simply produce no row.
+static void decodeChunk(MigrateRun *run, MigrateChunk *c, unsigned char *buffer) {
+    if (allocChunk(c) != SUCCESS) {
+        freeChunk(c);
+        return;                             // committing a NULL chunk fails the run
+    }
+    const char *dir = run->dirs[c->source];
+    char **names = run->lists[c->source].names + c->first;
+    for (size_t i = 0; i < c->count; i++) {
+        size_t length = readWhole(dir, names[i], buffer);
+        ImportRow *row = &c->rows[c->rowCount];
+        char *userID = c->userIDs[i];
+        time_t expiry = 0;
+        c->outcome[i] = FILE_INVALID;
+        if (length == 0) continue;
+
+        switch (c->source) {
+            case SOURCE_PROFILES:
+                if (!decodeProfile(buffer, length, names[i], &c->profiles[i])) break;
+                strcpy(userID, c->profiles[i].userID);
+                row->kind = IMPORT_PROFILE;
+                row->profile = &c->profiles[i];
+                c->outcome[i] = FILE_ROW;
+                break;
+            case SOURCE_RECORDS:
+                // Written through the campus store at commit, not as a row
+                if (!stemID(names[i], 0, strlen(SUBJECT_EXT), userID) ||
+                    !decodeRecord(buffer, length, userID, &c->records[i])) {
+                    break;
+                }
+                c->outcome[i] = FILE_RECORD;
+                break;
+            case SOURCE_LOCKS:
+                if (!stemID(names[i], 5, 4, userID) || !decodeExpiry(buffer, length, sizeof(time_t), 0, &expiry)) break;
+                if (expiry <= run->now) {
+                    c->outcome[i] = FILE_EXPIRED;
+                    break;
+                }
+                row->kind = IMPORT_ACCOUNT_LOCK;
+                row->expiry = (int64_t)expiry;
+                c->outcome[i] = FILE_ROW;
+                break;
+            default:
+                if (!stemID(names[i], 0, 8, userID) || !decodeExpiry(buffer, length, OTP_FILE_SIZE, 6, &expiry)) break;
+                c->outcome[i] = expiry <= run->now ? FILE_EXPIRED : FILE_PENDING;
+                break;
+        }
+        if (c->outcome[i] == FILE_ROW) {
+            row->userID = userID;
+            c->rowCount++;
+        }
+    }
+}
+
+static void *migrateWorkerMain(void *arg) {
+    MigrateRun *run = (MigrateRun*)arg;
+    unsigned char *buffer = malloc(MIGRATE_FILE_MAX + 1);
+    pthread_mutex_lock(&run->lock);
+    while (buffer && !run->stop && run->nextChunk < run->chunkCount) {
+        // Stay a bounded distance ahead of the writer
+        if (run->nextChunk >= run->committed + run->window) {
+            pthread_cond_wait(&run->spaceCond, &run->lock);
+            continue;
+        }
+        MigrateChunk *c = &run->chunks[run->nextChunk++];
+        pthread_mutex_unlock(&run->lock);
+        decodeChunk(run, c, buffer);
+        pthread_mutex_lock(&run->lock);
+        c->ready = 1;
+        pthread_cond_broadcast(&run->readyCond);
+    }
+    pthread_mutex_unlock(&run->lock);
+    free(buffer);
+    return NULL;
+}
+
+static void removeFiles(MigrateRun *run, const MigrateChunk *c, MigrateStats *stats) {
+    char **names = run->lists[c->source].names + c->first;
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->outcome[i] != FILE_ROW && c->outcome[i] != FILE_RECORD && c->outcome[i] != FILE_EXPIRED) continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s%s", run->dirs[c->source], names[i]);
+        if (remove(path) == 0) stats->removed++;
+    }
+}
+
+// Campus records go to the store loadUnifiedCampusData reads, which may not
+// be SQLite; a record it already has is newer and stays
+static ErrorCode addRecords(const MigrateChunk *c, size_t *inserted, size_t *present) {
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->outcome[i] != FILE_RECORD) continue;
+        ErrorCode rc = addUnifiedCampusData(&c->records[i]);
+        if (rc == ERROR_ALREADY_EXISTS) (*present)++;
+        else if (rc == SUCCESS) (*inserted)++;
+        else return rc;
+    }
+    return SUCCESS;
+}
+
+// Inserts one decoded chunk with its checkpoint, then tallies it. Records
+// are stored before the checkpoint commits, so a failed run repeats them and
+// finds them present.
+static ErrorCode commitChunk(MigrateRun *run, MigrateChunk *c, MigrateStats *stats) {
+    if (!c->outcome) return ERROR_MEMORY;
+    const char *last = run->lists[c->source].names[c->first + c->count - 1];
+    size_t inserted = 0, present = 0;
+    ErrorCode rc = c->source == SOURCE_RECORDS ? addRecords(c, &inserted, &present) : SUCCESS;
+    if (rc != SUCCESS) return rc;
+    size_t rowsInserted = 0;
+    rc = importRows(c->rows, c->rowCount, run->keys[c->source], last, &rowsInserted);
+    if (rc != SUCCESS) return rc;
+    inserted += rowsInserted;
+    present += c->rowCount - rowsInserted;
+
+    if (c->source == SOURCE_PROFILES) stats->profiles += inserted;
+    if (c->source == SOURCE_RECORDS) stats->records += inserted;
+    if (c->source == SOURCE_LOCKS) stats->locks += inserted;
+    stats->present += present;
+    for (size_t i = 0; i < c->count; i++) {
+        if (c->outcome[i] == FILE_INVALID) stats->invalid++;
+        if (c->outcome[i] == FILE_EXPIRED) stats->expired++;
+        if (c->outcome[i] == FILE_PENDING) stats->pendingOtp++;
+    }
+    if (run->options->removeMigrated) removeFiles(run, c, stats);
+    return SUCCESS;
+}
+
+// Sorts each source and drops the names an earlier run already committed
+static ErrorCode planChunks(MigrateRun *run, MigrateStats *stats) {
+    size_t chunkCount = 0;
+    for (int s = 0; s < SOURCE_COUNT; s++) {
+        NameList *list = &run->lists[s];
+        stats->files += list->count;
+        if (list->count > 1) qsort(list->names, list->count, sizeof(char*), compareNames);
+
+        char checkpoint[256];
+        ErrorCode rc = ERROR_NOT_FOUND;
+        if (!run->options->restart) rc = getImportCheckpoint(run->keys[s], checkpoint, sizeof(checkpoint));
+        if (rc == ERROR_DATABASE) return rc;
+        size_t skip = 0;
+        while (rc == SUCCESS && skip < list->count && strcmp(list->names[skip], checkpoint) <= 0) skip++;
+        for (size_t i = 0; i < skip; i++) free(list->names[i]);
+        memmove(list->names, list->names + skip, (list->count - skip) * sizeof(char*));
+        list->count -= skip;
+        stats->resumed += skip;
+        chunkCount += (list->count + MIGRATE_CHUNK - 1) / MIGRATE_CHUNK;
+    }
+
+    run->chunks = calloc(chunkCount ? chunkCount : 1, sizeof(MigrateChunk));
+    if (!run->chunks) return ERROR_MEMORY;
+    for (int s = 0; s < SOURCE_COUNT; s++) {
+        for (size_t first = 0; first < run->lists[s].count; first += MIGRATE_CHUNK) {
+            MigrateChunk *c = &run->chunks[run->chunkCount++];
+            c->source = (MigrateSource)s;
+            c->first = first;
+            c->count = run->lists[s].count - first < MIGRATE_CHUNK ? run->lists[s].count - first : MIGRATE_CHUNK;
+        }
+    }
+    return SUCCESS;
+}
+
+static void freeRun(MigrateRun *run) {
+    for (size_t i = 0; i < run->chunkCount; i++) freeChunk(&run->chunks[i]);
+    free(run->chunks);
+    for (int s = 0; s < SOURCE_COUNT; s++) {
+        for (size_t i = 0; i < run->lists[s].count; i++) free(run->lists[s].names[i]);
+        free(run->lists[s].names);
+    }
+}
+
+ErrorCode runLegacyMigration(const MigrateOptions *options, MigrateStats *stats) {
+    MigrateOptions defaults = migrateDefaultOptions();
+    MigrateStats ignored;
+    if (!options) options = &defaults;
+    if (!stats) stats = &ignored;
+    memset(stats, 0, sizeof(*stats));
+    if (options->threads < 0) return ERROR_INVALID_INPUT;
+
+    MigrateRun run;
+    memset(&run, 0, sizeof(run));
+    run.options = options;
+    run.now = time(NULL);
+    const char *credentials = options->credentialsDir ? options->credentialsDir : CRED_DIR;
+    const char *data = options->dataDir ? options->dataDir : DATA_DIR;
+    run.dirs[SOURCE_PROFILES] = credentials;
+    run.dirs[SOURCE_RECORDS] = run.dirs[SOURCE_LOCKS] = run.dirs[SOURCE_OTP] = data;
+    for (int s = 0; s < SOURCE_COUNT; s++) {
+        snprintf(run.keys[s], sizeof(run.keys[s]), "%s:%s", sourceNames[s], run.dirs[s]);
+    }
+
+    double started = monotonicSeconds();
+    ErrorCode rc = scanDir(&run, credentials, 1);
+    if (rc == SUCCESS) rc = scanDir(&run, data, 0);
+    if (rc == SUCCESS) rc = planChunks(&run, stats);
+    if (rc != SUCCESS || run.chunkCount == 0) {
+        freeRun(&run);
+        stats->seconds = monotonicSeconds() - started;
+        return rc;
+    }
+
+    int threads = options->threads > 0 ? options->threads : onlineCpus();
+    if (threads > MIGRATE_MAX_THREADS) threads = MIGRATE_MAX_THREADS;
+    if ((size_t)threads > run.chunkCount) threads = (int)run.chunkCount;
+    run.window = (size_t)threads * 2;
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.readyCond, NULL);
+    pthread_cond_init(&run.spaceCond, NULL);
+    pthread_t tids[MIGRATE_MAX_THREADS];
+    int startedThread[MIGRATE_MAX_THREADS];
+    int running = 0;
+    for (int i = 0; i < threads; i++) {
+        startedThread[i] = pthread_create(&tids[i], NULL, migrateWorkerMain, &run) == 0;
+        running += startedThread[i];
+    }
+    unsigned char *buffer = running == 0 ? malloc(MIGRATE_FILE_MAX + 1) : NULL;
+    if (running == 0 && !buffer) rc = ERROR_MEMORY;
+
+    // The calling thread commits chunks in order, so each checkpoint covers
+    // everything before it
+    size_t filesDone = 0, total = stats->files - stats->resumed;
+    for (size_t i = 0; i < run.chunkCount && rc == SUCCESS; i++) {
+        MigrateChunk *c = &run.chunks[i];
+        if (running == 0) {
+            decodeChunk(&run, c, buffer);      // no threads at all: do it here
+        } else {
+            pthread_mutex_lock(&run.lock);
+            while (!c->ready) pthread_cond_wait(&run.readyCond, &run.lock);
+            pthread_mutex_unlock(&run.lock);
+        }
+        rc = commitChunk(&run, c, stats);
+        freeChunk(c);
+        filesDone += c->count;
+
+        pthread_mutex_lock(&run.lock);
+        run.committed = i + 1;
+        pthread_cond_broadcast(&run.spaceCond);
+        pthread_mutex_unlock(&run.lock);
+        stats->chunks++;
+        if (rc == SUCCESS && options->progress) {
+            MigrateProgress progress;
+            progress.done = filesDone;
+            progress.total = total;
+            progress.seconds = monotonicSeconds() - started;
+            progress.perSecond = progress.seconds > 0 ? filesDone / progress.seconds : 0.0;
+            options->progress(&progress, options->ctx);
+        }
+    }
+
+    pthread_mutex_lock(&run.lock);
+    run.stop = 1;
+    pthread_cond_broadcast(&run.spaceCond);
+    pthread_mutex_unlock(&run.lock);
+    for (int i = 0; i < threads; i++) {
+        if (startedThread[i]) pthread_join(tids[i], NULL);
+    }
+    free(buffer);
+    stats->threads = running > 0 ? running : 1;
+    stats->seconds = monotonicSeconds() - started;
+    stats->perSecond = stats->seconds > 0 ? filesDone / stats->seconds : 0.0;
+
+    if (rc == SUCCESS) {
+        char details[160];
+        snprintf(details, sizeof(details), "Legacy migration: %zu profiles, %zu records, %zu locks added",
+                 stats->profiles, stats->records, stats->locks);
+        logActivity("system", EVENT_NOTE, details);
+    }
+    pthread_cond_destroy(&run.readyCond);
+    pthread_cond_destroy(&run.spaceCond);
+    pthread_mutex_destroy(&run.lock);
+    freeRun(&run);
+    return rc;
+}
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "../include/pdf_writer.h"
+
+// Objects 1 and 2 are the catalog and the page tree root, written last
+#define PDF_CATALOG_OBJ     1
+#define PDF_ROOT_PAGES_OBJ  2
+#define PDF_FIRST_OBJ       3
+#define PDF_CONTENT_CHUNK   4096
+
+// Append-only scratch (xref entries, leaf references) that stays in memory
+// up to PDF_SPILL_MEMORY bytes and only then moves to a temporary file, so
+// small documents never touch the filesystem
+typedef struct {
+    char *mem;
+    size_t length, capacity;
+    FILE *file;
+} Spill;
+
+struct PdfWriter {
+    FILE *out;
+    uint64_t offset;            // bytes written to `out` so far
+    int failed;
+
+    uint32_t nextObj;
+    uint64_t reserved[PDF_FIRST_OBJ];
+    Spill xrefSpill;            // 20-byte xref entries for objects PDF_FIRST_OBJ.., in order
+    uint32_t nextSpill;         // next object whose entry goes to xrefSpill
+    uint64_t window[PDF_XREF_WINDOW];   // offsets written ahead of nextSpill (0 = not yet)
+
+    uint32_t fontObj[PDF_FONT_COUNT];   // 0 until the font is first used
+
+    int inPage;
+    double pageWidth, pageHeight;
+    unsigned pageFonts;         // bit per PdfFont used on the open page
+    int fontSet;
+    char *content;
+    size_t contentLength, contentCap;
+
+    uint32_t leafObj;           // page tree leaf the open group of pages belongs to
+    uint32_t leafKids[PDF_PAGE_GROUP];
+    int leafCount;
+    Spill leafSpill;            // "N 0 R " per leaf, for the root's /Kids
+    size_t leaves;
+    size_t pages;
+};
+
+static const char *const fontNames[PDF_FONT_COUNT] = {
+    "Helvetica", "Helvetica-Bold", "Helvetica-Oblique", "Helvetica-BoldOblique",
+    "Times-Roman", "Times-Bold", "Times-Italic", "Times-BoldItalic",
+    "Courier", "Courier-Bold", "Courier-Oblique", "Courier-BoldOblique",
+    "Symbol", "ZapfDingbats"
+};
+
+const char *pdfFontName(PdfFont font) {
+    return (int)font >= 0 && font < PDF_FONT_COUNT ? fontNames[font] : NULL;
+}
+
+int pdfFontByName(const char *name) {
+    if (!name) return -1;
+    for (int i = 0; i < PDF_FONT_COUNT; i++) {
+        if (strcmp(fontNames[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// ---- Output ----
+
+static void emit(PdfWriter *w, const void *data, size_t length) {
+    if (w->failed) return;
+    if (fwrite(data, 1, length, w->out) != length) w->failed = 1;
+    w->offset += length;
+}
+
+static void emitf(PdfWriter *w, const char *fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= sizeof(buf)) {
+        w->failed = 1;
+        return;
+    }
+    emit(w, buf, (size_t)n);
+}
+
+static void spillWrite(PdfWriter *w, Spill *spill, const char *data, size_t length) {
+    if (!spill->file && spill->length + length > PDF_SPILL_MEMORY) {
+        spill->file = tmpfile();
+        if (!spill->file || fwrite(spill->mem, 1, spill->length, spill->file) != spill->length) {
+            w->failed = 1;
+            return;
+        }
+        free(spill->mem);
+        spill->mem = NULL;
+        spill->length = spill->capacity = 0;
+    }
+    if (spill->file) {
+        if (fwrite(data, 1, length, spill->file) != length) w->failed = 1;
+        return;
+    }
+    if (spill->capacity - spill->length < length) {
+        size_t grown = spill->capacity ? spill->capacity : 1024;
+        while (grown - spill->length < length) grown *= 2;
+        char *p = realloc(spill->mem, grown);
+        if (!p) {
+            w->failed = 1;
+            return;
+        }
+        spill->mem = p;
+        spill->capacity = grown;
+    }
+    memcpy(spill->mem + spill->length, data, length);
+    spill->length += length;
+}
+
+static void spillFree(Spill *spill) {
+    if (spill->file) fclose(spill->file);
+    free(spill->mem);
+}
+
+// Entries are spilled strictly in object order; the window absorbs objects
+// written before a lower-numbered one (a page tree leaf waits for its pages)
+static void recordOffset(PdfWriter *w, uint32_t obj) {
+    if (obj < PDF_FIRST_OBJ) {
+        w->reserved[obj] = w->offset;
+        return;
+    }
+    if (obj - w->nextSpill >= PDF_XREF_WINDOW) {
+        w->failed = 1;
+        return;
+    }
+    w->window[obj % PDF_XREF_WINDOW] = w->offset;
+    while (w->window[w->nextSpill % PDF_XREF_WINDOW]) {
+        char entry[32];
+        snprintf(entry, sizeof(entry), "%010llu 00000 n\r\n",
+                 (unsigned long long)w->window[w->nextSpill % PDF_XREF_WINDOW]);
+        spillWrite(w, &w->xrefSpill, entry, 20);
+        w->window[w->nextSpill % PDF_XREF_WINDOW] = 0;
+        w->nextSpill++;
+    }
+}
+
+static void beginObject(PdfWriter *w, uint32_t obj) {
+    recordOffset(w, obj);
+    emitf(w, "%u 0 obj\n", obj);
+}
+
+// ---- Page content ----
+
+static void contentAppend(PdfWriter *w, const char *data, size_t length) {
+    if (w->contentCap - w->contentLength < length) {
+        size_t grown = w->contentCap ? w->contentCap : PDF_CONTENT_CHUNK;
+        while (grown - w->contentLength < length) grown *= 2;
+        char *p = realloc(w->content, grown);
+        if (!p) {
+            w->failed = 1;
+            return;
+        }
+        w->content = p;
+        w->contentCap = grown;
+    }
+    memcpy(w->content + w->contentLength, data, length);
+    w->contentLength += length;
+}
+
+static void contentf(PdfWriter *w, const char *fmt, ...) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n > 0 && (size_t)n < sizeof(buf)) contentAppend(w, buf, (size_t)n);
+    else w->failed = 1;
+}
+
+// PDF string literal in WinAnsi: Latin-1 code points from their UTF-8 form,
+// everything else outside ASCII as '?'
+static void contentString(PdfWriter *w, const char *text) {
+    char buf[256];
+    size_t n = 0;
+    buf[n++] = '(';
+    for (const unsigned char *s = (const unsigned char*)text; *s; s++) {
+        if (n > sizeof(buf) - 8) {
+            contentAppend(w, buf, n);
+            n = 0;
+        }
+        unsigned c = *s;
+        if (c >= 0x80) {
+            if ((c == 0xC2 || c == 0xC3) && (s[1] & 0xC0) == 0x80) {
+                c = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+                s++;
+            } else {
+                while ((s[1] & 0xC0) == 0x80) s++;    // rest of a longer sequence
+                c = '?';
+            }
+        }
+        if (c == '(' || c == ')' || c == '\\') {
+            buf[n++] = '\\';
+            buf[n++] = (char)c;
+        } else if (c < 0x20 || c >= 0x80) {
+            n += (size_t)snprintf(buf + n, sizeof(buf) - n, "\\%03o", c < 0x20 ? ' ' : c);
+        } else {
+            buf[n++] = (char)c;
+        }
+    }
+    buf[n++] = ')';
+    contentAppend(w, buf, n);
+}
+
+// ---- Page tree ----
+
+static void flushLeaf(PdfWriter *w) {
+    if (w->leafCount == 0) return;
+    beginObject(w, w->leafObj);
+    emitf(w, "<< /Type /Pages /Parent %u 0 R /Count %d /Kids [", PDF_ROOT_PAGES_OBJ, w->leafCount);
+    for (int i = 0; i < w->leafCount; i++) emitf(w, "%u 0 R ", w->leafKids[i]);
+    emitf(w, "] >>\nendobj\n");
+    char ref[24];
+    int n = snprintf(ref, sizeof(ref), "%u 0 R ", w->leafObj);
+    spillWrite(w, &w->leafSpill, ref, (size_t)n);
+    w->leaves++;
+    w->leafCount = 0;
+}
+
+// ---- API ----
+
+PdfWriter *pdfWriterOpen(FILE *out) {
+    if (!out) return NULL;
+    PdfWriter *w = (PdfWriter*)calloc(1, sizeof(PdfWriter));
+    if (!w) return NULL;
+    w->out = out;
+    w->nextObj = PDF_FIRST_OBJ;
+    w->nextSpill = PDF_FIRST_OBJ;
+    emit(w, "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n", 15);
+    return w;
+}
+
+ErrorCode pdfBeginPage(PdfWriter *w, double width, double height) {
+    if (!w || w->inPage || width <= 0 || height <= 0) return ERROR_INVALID_INPUT;
+    if (w->leafCount == 0) w->leafObj = w->nextObj++;
+    w->inPage = 1;
+    w->pageWidth = width;
+    w->pageHeight = height;
+    w->pageFonts = 0;
+    w->fontSet = 0;
+    w->contentLength = 0;
+    return w->failed ? ERROR_FILE_IO : SUCCESS;
+}
+
+ErrorCode pdfSetFont(PdfWriter *w, PdfFont font, double size) {
+    if (!w || !w->inPage || (int)font < 0 || font >= PDF_FONT_COUNT || size <= 0) return ERROR_INVALID_INPUT;
+    if (!w->fontObj[font]) {
+        w->fontObj[font] = w->nextObj++;
+        beginObject(w, w->fontObj[font]);
+        emitf(w, "<< /Type /Font /Subtype /Type1 /BaseFont /%s%s >>\nendobj\n", fontNames[font],
+              font == PDF_FONT_SYMBOL || font == PDF_FONT_ZAPF_DINGBATS ? "" : " /Encoding /WinAnsiEncoding");
+    }
+    w->pageFonts |= 1u << font;
+    w->fontSet = 1;
+    contentf(w, "/F%d %.2f Tf\n", (int)font + 1, size);
+    return w->failed ? ERROR_FILE_IO : SUCCESS;
+}
+
+ErrorCode pdfText(PdfWriter *w, double x, double y, const char *text) {
+    if (!w || !w->inPage || !w->fontSet || !text) return ERROR_INVALID_INPUT;
+    contentf(w, "BT %.2f %.2f Td ", x, y);
+    contentString(w, text);
+    contentAppend(w, " Tj ET\n", 7);
+    return w->failed ? ERROR_FILE_IO : SUCCESS;
+}
+
+ErrorCode pdfEndPage(PdfWriter *w) {
+    if (!w || !w->inPage) return ERROR_INVALID_INPUT;
+    uint32_t contentObj = w->nextObj++;
+    beginObject(w, contentObj);
+    emitf(w, "<< /Length %zu >>\nstream\n", w->contentLength);
+    emit(w, w->content, w->contentLength);
+    emitf(w, "\nendstream\nendobj\n");
+
+    uint32_t pageObj = w->nextObj++;
+    beginObject(w, pageObj);
+    emitf(w, "<< /Type /Page /Parent %u 0 R /MediaBox [0 0 %.2f %.2f] /Resources << /ProcSet [/PDF /Text] /Font <<",
+          w->leafObj, w->pageWidth, w->pageHeight);
+    for (int f = 0; f < PDF_FONT_COUNT; f++) {
+        if (w->pageFonts & (1u << f)) emitf(w, " /F%d %u 0 R", f + 1, w->fontObj[f]);
+    }
+    emitf(w, " >> >> /Contents %u 0 R >>\nendobj\n", contentObj);
+
+    w->inPage = 0;
+    w->pages++;
+    w->leafKids[w->leafCount++] = pageObj;
+    if (w->leafCount == PDF_PAGE_GROUP) flushLeaf(w);
+    return w->failed ? ERROR_FILE_IO : SUCCESS;
+}
+
+static void copySpill(PdfWriter *w, Spill *spill) {
+    if (!spill->file) {
+        emit(w, spill->mem, spill->length);
+        return;
+    }
+    char buf[8192];
+    size_t n;
+    rewind(spill->file);
+    while ((n = fread(buf, 1, sizeof(buf), spill->file)) > 0) emit(w, buf, n);
+    if (ferror(spill->file)) w->failed = 1;
+}
+
+ErrorCode pdfWriterClose(PdfWriter *w, int abandon) {
+    if (!w) return ERROR_INVALID_INPUT;
+    if (!abandon && !w->failed) {
+        if (w->inPage) pdfEndPage(w);
+        flushLeaf(w);
+
+        beginObject(w, PDF_ROOT_PAGES_OBJ);
+        emitf(w, "<< /Type /Pages /Count %zu /Kids [", w->pages);
+        copySpill(w, &w->leafSpill);
+        emitf(w, "] >>\nendobj\n");
+        beginObject(w, PDF_CATALOG_OBJ);
+        emitf(w, "<< /Type /Catalog /Pages %u 0 R >>\nendobj\n", PDF_ROOT_PAGES_OBJ);
+
+        if (w->nextSpill != w->nextObj) w->failed = 1;     // an object was allocated but never written
+        uint64_t xref = w->offset;
+        emitf(w, "xref\n0 %u\n0000000000 65535 f\r\n", w->nextObj);
+        for (int obj = 1; obj < PDF_FIRST_OBJ; obj++) {
+            emitf(w, "%010llu 00000 n\r\n", (unsigned long long)w->reserved[obj]);
+        }
+        copySpill(w, &w->xrefSpill);
+        emitf(w, "trailer\n<< /Size %u /Root %u 0 R >>\nstartxref\n%llu\n%%%%EOF\n",
+              w->nextObj, PDF_CATALOG_OBJ, (unsigned long long)xref);
+        if (fflush(w->out) != 0) w->failed = 1;
+    }
+    ErrorCode rc = abandon ? SUCCESS : w->failed ? ERROR_FILE_IO : SUCCESS;
+    spillFree(&w->xrefSpill);
+    spillFree(&w->leafSpill);
+    free(w->content);
+    free(w);
+    return rc;
+}
+
+size_t pdfPageCount(const PdfWriter *w) {
+    return w ? w->pages : 0;
+}
+
+uint64_t pdfBytesWritten(const PdfWriter *w) {
+    return w ? w->offset : 0;
+}
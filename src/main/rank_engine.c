@@ -0,0 +1,566 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../include/rank_engine.h"
+#include "../include/database.h"
+#include "../include/grade_kernel.h"
+
+#define RANK_BUCKETS     (RANK_STEPS + 1)      // scores 0..max inclusive
+#define RANK_TOP_BIT     8192                  // highest power of two <= RANK_BUCKETS
+#define RANK_MIN_TABLE   64
+
+typedef struct {
+    char userID[20];
+    int bucket;
+    int prev, next;         // same bucket; `next` also links the free list
+} RankMember;
+
+struct RankGroup;
+
+typedef struct RankBoard {
+    struct RankBoard *chain;
+    struct RankBoard *groupNext;
+    struct RankGroup *group;
+    char institute[MAX_LEN];
+    CampusType type;
+    char subject[MAX_LEN];
+    int32_t tree[RANK_BUCKETS + 1];     // Fenwick tree, 1-based
+    int32_t head[RANK_BUCKETS];         // first member per bucket, -1 when empty
+    RankMember *members;
+    int memberCap, memberUsed, freeMember;
+    int total;
+} RankBoard;
+
+typedef struct {
+    RankBoard *board;
+    int member;
+} RankSlot;
+
+// Where one student sits: the overall board and one per subject
+typedef struct RankStudent {
+    struct RankStudent *chain;
+    struct RankStudent *groupPrev, *groupNext;
+    struct RankGroup *group;
+    char userID[20];
+    int slotCount;
+    RankSlot slots[1 + MAX_SUBJECTS];
+} RankStudent;
+
+// The boards of one (institute, campus type), loaded and evicted together
+// because filing a student touches all of them
+typedef struct RankGroup {
+    struct RankGroup *chain;
+    struct RankGroup *newer, *older;    // LRU list
+    char institute[MAX_LEN];
+    CampusType type;
+    RankBoard *boards;
+    RankStudent *students;
+} RankGroup;
+
+static struct {
+    pthread_mutex_t lock;
+    RankGroup **groups;
+    size_t groupBuckets, groupCount;
+    RankGroup *newest, *oldest;
+    RankBoard **boards;
+    size_t boardBuckets, boardCount;
+    RankStudent **students;
+    size_t studentBuckets, studentCount;
+    int versionKnown;
+    int64_t dataVersion;                // getDataVersion() the groups were loaded under
+} ranks = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t hashBytes(uint64_t h, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static uint64_t boardHash(const char *institute, CampusType type, const char *subject) {
+    uint64_t h = hashBytes(1469598103934665603ULL, institute, strlen(institute) + 1);
+    h = hashBytes(h, &type, sizeof(type));
+    return hashBytes(h, subject, strlen(subject));
+}
+
+static uint64_t studentHash(const char *userID) {
+    return hashBytes(1469598103934665603ULL, userID, strlen(userID));
+}
+
+// Doubles a chained table once it holds as many entries as buckets; `hashOf` rehashes an entry
+#define GROW_TABLE(table, buckets, count, Type, hashOf)                         \
+    do {                                                                        \
+        if ((count) < (buckets)) break;                                         \
+        size_t grown = (buckets) ? (buckets) * 2 : RANK_MIN_TABLE;              \
+        Type **fresh = (Type**)calloc(grown, sizeof(Type*));                    \
+        if (!fresh) break;                                                      \
+        for (size_t b = 0; b < (buckets); b++) {                                \
+            Type *e = (table)[b];                                               \
+            while (e) {                                                         \
+                Type *next = e->chain;                                          \
+                size_t slot = hashOf(e) & (grown - 1);                          \
+                e->chain = fresh[slot];                                         \
+                fresh[slot] = e;                                                \
+                e = next;                                                       \
+            }                                                                   \
+        }                                                                       \
+        free(table);                                                            \
+        (table) = fresh;                                                        \
+        (buckets) = grown;                                                      \
+    } while (0)
+
+#define GROUP_HASH(g)   boardHash((g)->institute, (g)->type, "")
+#define BOARD_HASH(b)   boardHash((b)->institute, (b)->type, (b)->subject)
+#define STUDENT_HASH(s) studentHash((s)->userID)
+
+static void fenwickAdd(RankBoard *b, int bucket, int delta) {
+    for (int i = bucket + 1; i <= RANK_BUCKETS; i += i & -i) b->tree[i] += delta;
+}
+
+// Members in buckets 0..bucket
+static int fenwickPrefix(const RankBoard *b, int bucket) {
+    int sum = 0;
+    for (int i = bucket + 1; i > 0; i -= i & -i) sum += b->tree[i];
+    return sum;
+}
+
+// Lowest bucket whose prefix reaches k (1 <= k <= total)
+static int fenwickFind(const RankBoard *b, int k) {
+    int pos = 0;
+    for (int step = RANK_TOP_BIT; step; step >>= 1) {
+        if (pos + step <= RANK_BUCKETS && b->tree[pos + step] < k) {
+            pos += step;
+            k -= b->tree[pos];
+        }
+    }
+    return pos;     // 1-based index pos + 1 is bucket pos
+}
+
+static float scoreMax(CampusType type, const char *subject) {
+    return type == CAMPUS_COLLEGE && subject[0] == '\0' ? 10.0f : 100.0f;
+}
+
+static int toBucket(float score, float max) {
+    float steps = score / max * RANK_STEPS;
+    if (!(steps > 0.0f)) return 0;
+    return steps >= RANK_STEPS ? RANK_STEPS : (int)(steps + 0.5f);
+}
+
+static RankGroup *findGroup(const char *institute, CampusType type) {
+    if (!ranks.groupBuckets) return NULL;
+    RankGroup *g = ranks.groups[boardHash(institute, type, "") & (ranks.groupBuckets - 1)];
+    while (g && (g->type != type || strcmp(g->institute, institute) != 0)) g = g->chain;
+    return g;
+}
+
+static void lruUnlink(RankGroup *g) {
+    if (g->newer) g->newer->older = g->older;
+    else ranks.newest = g->older;
+    if (g->older) g->older->newer = g->newer;
+    else ranks.oldest = g->newer;
+    g->newer = g->older = NULL;
+}
+
+static void lruPushNewest(RankGroup *g) {
+    g->older = ranks.newest;
+    g->newer = NULL;
+    if (ranks.newest) ranks.newest->newer = g;
+    else ranks.oldest = g;
+    ranks.newest = g;
+}
+
+static RankBoard *findBoard(RankGroup *g, const char *subject, int create) {
+    if (!subject) subject = "";
+    if (ranks.boardBuckets) {
+        size_t slot = boardHash(g->institute, g->type, subject) & (ranks.boardBuckets - 1);
+        for (RankBoard *b = ranks.boards[slot]; b; b = b->chain) {
+            if (b->group == g && strcmp(b->subject, subject) == 0) return b;
+        }
+    }
+    if (!create) return NULL;
+    GROW_TABLE(ranks.boards, ranks.boardBuckets, ranks.boardCount, RankBoard, BOARD_HASH);
+    if (!ranks.boardBuckets) return NULL;
+    RankBoard *b = (RankBoard*)calloc(1, sizeof(RankBoard));
+    if (!b) return NULL;
+    snprintf(b->institute, sizeof(b->institute), "%s", g->institute);
+    b->type = g->type;
+    snprintf(b->subject, sizeof(b->subject), "%s", subject);
+    memset(b->head, -1, sizeof(b->head));
+    b->freeMember = -1;
+    size_t slot = BOARD_HASH(b) & (ranks.boardBuckets - 1);
+    b->chain = ranks.boards[slot];
+    ranks.boards[slot] = b;
+    ranks.boardCount++;
+    b->group = g;
+    b->groupNext = g->boards;
+    g->boards = b;
+    return b;
+}
+
+static int addMember(RankBoard *b, const char *userID, int bucket) {
+    int m = b->freeMember;
+    if (m >= 0) {
+        b->freeMember = b->members[m].next;
+    } else {
+        if (b->memberUsed == b->memberCap) {
+            int cap = b->memberCap ? b->memberCap * 2 : 16;
+            RankMember *grown = (RankMember*)realloc(b->members, (size_t)cap * sizeof(RankMember));
+            if (!grown) return -1;
+            b->members = grown;
+            b->memberCap = cap;
+        }
+        m = b->memberUsed++;
+    }
+    RankMember *e = &b->members[m];
+    snprintf(e->userID, sizeof(e->userID), "%s", userID);
+    e->bucket = bucket;
+    e->prev = -1;
+    e->next = b->head[bucket];
+    if (e->next >= 0) b->members[e->next].prev = m;
+    b->head[bucket] = m;
+    fenwickAdd(b, bucket, 1);
+    b->total++;
+    return m;
+}
+
+static void removeMember(RankBoard *b, int m) {
+    RankMember *e = &b->members[m];
+    if (e->prev >= 0) b->members[e->prev].next = e->next;
+    else b->head[e->bucket] = e->next;
+    if (e->next >= 0) b->members[e->next].prev = e->prev;
+    fenwickAdd(b, e->bucket, -1);
+    b->total--;
+    e->next = b->freeMember;
+    b->freeMember = m;
+}
+
+static RankStudent **studentLink(const char *userID) {
+    if (!ranks.studentBuckets) return NULL;
+    RankStudent **link = &ranks.students[studentHash(userID) & (ranks.studentBuckets - 1)];
+    while (*link && strcmp((*link)->userID, userID) != 0) link = &(*link)->chain;
+    return link;
+}
+
+static RankStudent *findStudent(const char *userID) {
+    RankStudent **link = studentLink(userID);
+    return link ? *link : NULL;
+}
+
+static void clearSlots(RankStudent *s) {
+    for (int i = 0; i < s->slotCount; i++) removeMember(s->slots[i].board, s->slots[i].member);
+    s->slotCount = 0;
+}
+
+// Unlinks the student from the student table and its group (the boards are
+// left to the caller)
+static void dropStudent(RankStudent **link) {
+    RankStudent *s = *link;
+    *link = s->chain;
+    if (s->groupPrev) s->groupPrev->groupNext = s->groupNext;
+    else s->group->students = s->groupNext;
+    if (s->groupNext) s->groupNext->groupPrev = s->groupPrev;
+    free(s);
+    ranks.studentCount--;
+}
+
+static void forgetStudent(const char *userID) {
+    RankStudent **link = studentLink(userID);
+    if (!link || !*link) return;
+    clearSlots(*link);
+    dropStudent(link);
+}
+
+static void placeOn(RankStudent *s, const char *subject, float score) {
+    RankBoard *b = findBoard(s->group, subject, 1);
+    if (!b) return;
+    int m = addMember(b, s->userID, toBucket(score, scoreMax(s->group->type, subject)));
+    if (m < 0) return;
+    s->slots[s->slotCount].board = b;
+    s->slots[s->slotCount].member = m;
+    s->slotCount++;
+}
+
+// (Re)places a student on the overall board and one board per subject of
+// `g`, which is p's institute and campus type
+static void fileStudent(RankGroup *g, const Profile *p, const void *data) {
+    RankStudent *s = findStudent(p->userID);
+    if (s && s->group != g) {
+        forgetStudent(p->userID);
+        s = NULL;
+    }
+    if (p->campusType != CAMPUS_SCHOOL && p->campusType != CAMPUS_COLLEGE) return;
+    if (!s) {
+        GROW_TABLE(ranks.students, ranks.studentBuckets, ranks.studentCount, RankStudent, STUDENT_HASH);
+        if (!ranks.studentBuckets || !(s = (RankStudent*)calloc(1, sizeof(RankStudent)))) return;
+        snprintf(s->userID, sizeof(s->userID), "%s", p->userID);
+        RankStudent **head = &ranks.students[studentHash(s->userID) & (ranks.studentBuckets - 1)];
+        s->chain = *head;
+        *head = s;
+        ranks.studentCount++;
+        s->group = g;
+        s->groupNext = g->students;
+        if (g->students) g->students->groupPrev = s;
+        g->students = s;
+    }
+    clearSlots(s);
+
+    int school = p->campusType == CAMPUS_SCHOOL;
+    const SchoolMarks *sm = (const SchoolMarks*)data;
+    const CollegeMarks *cm = (const CollegeMarks*)data;
+    GradeSummary overall = school ? gradeSchoolMarks(sm) : gradeCollegeMarks(cm);
+    placeOn(s, "", overall.score);
+
+    int count = school ? sm->count : cm->count;
+    if (count > MAX_SUBJECTS) count = MAX_SUBJECTS;
+    for (int i = 0; i < count; i++) {
+        const char *subject = school ? sm->subjects[i] : cm->subjects[i];
+        if (subject[0] == '\0') continue;
+        int repeated = 0;
+        for (int j = 0; j < i && !repeated; j++) {
+            repeated = strcmp(subject, school ? sm->subjects[j] : cm->subjects[j]) == 0;
+        }
+        if (repeated) continue;
+        if (school && sm->fullMarks[i] <= 0) continue;
+        float score = school ? sm->marks[i] * 100.0f / sm->fullMarks[i] : (float)cm->marks[i];
+        placeOn(s, subject, score);
+    }
+}
+
+// Frees a group with its boards and students
+static void freeGroup(RankGroup *g) {
+    while (g->students) {
+        RankStudent **link = studentLink(g->students->userID);
+        g->students->slotCount = 0;         // the boards go below
+        dropStudent(link);
+    }
+    while (g->boards) {
+        RankBoard *b = g->boards;
+        g->boards = b->groupNext;
+        RankBoard **link = &ranks.boards[BOARD_HASH(b) & (ranks.boardBuckets - 1)];
+        while (*link != b) link = &(*link)->chain;
+        *link = b->chain;
+        ranks.boardCount--;
+        free(b->members);
+        free(b);
+    }
+    RankGroup **link = &ranks.groups[GROUP_HASH(g) & (ranks.groupBuckets - 1)];
+    while (*link != g) link = &(*link)->chain;
+    *link = g->chain;
+    ranks.groupCount--;
+    lruUnlink(g);
+    free(g);
+}
+
+static void freeAll(void) {
+    while (ranks.oldest) freeGroup(ranks.oldest);
+    free(ranks.groups);
+    free(ranks.boards);
+    free(ranks.students);
+    ranks.groups = NULL;
+    ranks.boards = NULL;
+    ranks.students = NULL;
+    ranks.groupBuckets = ranks.groupCount = 0;
+    ranks.boardBuckets = ranks.boardCount = 0;
+    ranks.studentBuckets = ranks.studentCount = 0;
+}
+
+// Reads one institute's students of `type`, DB_BATCH_CHUNK at a time.
+// Least recently used groups make room. Caller holds the lock.
+static RankGroup *loadGroup(const char *institute, CampusType type, ErrorCode *rc) {
+    GROW_TABLE(ranks.groups, ranks.groupBuckets, ranks.groupCount, RankGroup, GROUP_HASH);
+    RankGroup *g = ranks.groupBuckets ? (RankGroup*)calloc(1, sizeof(RankGroup)) : NULL;
+    if (!g) {
+        *rc = ERROR_MEMORY;
+        return NULL;
+    }
+    snprintf(g->institute, sizeof(g->institute), "%s", institute);
+    g->type = type;
+    RankGroup **head = &ranks.groups[GROUP_HASH(g) & (ranks.groupBuckets - 1)];
+    g->chain = *head;
+    *head = g;
+    ranks.groupCount++;
+    lruPushNewest(g);
+
+    char (*ids)[20] = NULL;
+    size_t count = 0;
+    UserRecord *records = (UserRecord*)malloc(DB_BATCH_CHUNK * sizeof(UserRecord));
+    *rc = records ? listUsersByInstitute(institute, type, &ids, &count) : ERROR_MEMORY;
+    for (size_t first = 0; *rc == SUCCESS && first < count; first += DB_BATCH_CHUNK) {
+        const char *chunk[DB_BATCH_CHUNK];
+        size_t n = count - first < DB_BATCH_CHUNK ? count - first : DB_BATCH_CHUNK;
+        for (size_t i = 0; i < n; i++) chunk[i] = ids[first + i];
+        *rc = getUsersByIDs(chunk, n, records);
+        for (size_t i = 0; *rc == SUCCESS && i < n; i++) {
+            if (records[i].found && records[i].hasData && records[i].profile.campusType == type) {
+                fileStudent(g, &records[i].profile, &records[i].data);
+            }
+        }
+    }
+    free(ids);
+    free(records);
+    if (*rc != SUCCESS) {
+        freeGroup(g);
+        return NULL;
+    }
+    while (ranks.boardCount > RANK_MAX_BOARDS && ranks.oldest != g) freeGroup(ranks.oldest);
+    return g;
+}
+
+// Other connections' commits may have moved anyone: start over. This
+// process's own writes reach the boards through rankNoteMarks/rankNoteProfile
+// and leave the version alone.
+static void dropIfStale(void) {
+    int64_t version;
+    if (getDataVersion(&version) != SUCCESS) return;
+    if (!ranks.versionKnown || version != ranks.dataVersion) freeAll();
+    ranks.dataVersion = version;
+    ranks.versionKnown = 1;
+}
+
+// Loaded, non-empty board or NULL; *rc says why not
+static RankBoard *queryBoard(const char *institute, CampusType type, const char *subject, ErrorCode *rc) {
+    *rc = ERROR_NOT_FOUND;
+    if (type != CAMPUS_SCHOOL && type != CAMPUS_COLLEGE) return NULL;
+    dropIfStale();
+    RankGroup *g = findGroup(institute, type);
+    if (!g && !(g = loadGroup(institute, type, rc))) return NULL;
+    lruUnlink(g);
+    lruPushNewest(g);
+    *rc = SUCCESS;
+    RankBoard *b = findBoard(g, subject, 0);
+    if (!b || b->total == 0) {
+        *rc = ERROR_NOT_FOUND;
+        return NULL;
+    }
+    return b;
+}
+
+ErrorCode rankOfStudent(const char *institute, CampusType type, const char *subject, const char *userID,
+                        int *rank, int *total, float *score) {
+    if (!institute || !userID || !rank || !total) return ERROR_INVALID_INPUT;
+    ErrorCode rc;
+    pthread_mutex_lock(&ranks.lock);
+    RankBoard *b = queryBoard(institute, type, subject, &rc);
+    RankStudent *s = b ? findStudent(userID) : NULL;
+    if (b) rc = ERROR_NOT_FOUND;
+    for (int i = 0; s && i < s->slotCount; i++) {
+        if (s->slots[i].board != b) continue;
+        int bucket = b->members[s->slots[i].member].bucket;
+        *rank = b->total - fenwickPrefix(b, bucket) + 1;
+        *total = b->total;
+        if (score) *score = (float)bucket * scoreMax(type, b->subject) / RANK_STEPS;
+        rc = SUCCESS;
+        break;
+    }
+    pthread_mutex_unlock(&ranks.lock);
+    return rc;
+}
+
+static int byUserID(const void *a, const void *b) {
+    return strcmp(((const RankEntry*)a)->userID, ((const RankEntry*)b)->userID);
+}
+
+ErrorCode rankTopK(const char *institute, CampusType type, const char *subject, size_t k,
+                   RankEntry *out, size_t *count) {
+    if (!institute || !count || (!out && k > 0)) return ERROR_INVALID_INPUT;
+    *count = 0;
+    ErrorCode rc;
+    pthread_mutex_lock(&ranks.lock);
+    RankBoard *b = queryBoard(institute, type, subject, &rc);
+    float max = b ? scoreMax(type, b->subject) : 0.0f;
+    int atOrBelow = b ? b->total : 0;
+    while (b && *count < k && atOrBelow > 0) {
+        // The best bucket not yet listed; its members are sorted by ID and
+        // the tail beyond k dropped
+        int bucket = fenwickFind(b, atOrBelow);
+        int rank = b->total - atOrBelow + 1;
+        size_t first = *count;
+        for (int m = b->head[bucket]; m >= 0; m = b->members[m].next) {
+            RankEntry entry = { "", (float)bucket * max / RANK_STEPS, rank };
+            memcpy(entry.userID, b->members[m].userID, sizeof(entry.userID));
+            if (*count < k) {
+                out[(*count)++] = entry;
+            } else {
+                // Keep the k smallest IDs of a tied bucket that overflows
+                size_t worst = first;
+                for (size_t j = first + 1; j < k; j++) {
+                    if (strcmp(out[j].userID, out[worst].userID) > 0) worst = j;
+                }
+                if (strcmp(entry.userID, out[worst].userID) < 0) out[worst] = entry;
+            }
+            atOrBelow--;
+        }
+        qsort(out + first, *count - first, sizeof(RankEntry), byUserID);
+    }
+    pthread_mutex_unlock(&ranks.lock);
+    return rc;
+}
+
+ErrorCode rankPercentile(const char *institute, CampusType type, const char *subject, float score,
+                         float *percentile) {
+    if (!institute || !percentile) return ERROR_INVALID_INPUT;
+    ErrorCode rc;
+    pthread_mutex_lock(&ranks.lock);
+    RankBoard *b = queryBoard(institute, type, subject, &rc);
+    if (b) {
+        int below = score < 0.0f ? 0 : fenwickPrefix(b, toBucket(score, scoreMax(type, b->subject)));
+        *percentile = below * 100.0f / b->total;
+    }
+    pthread_mutex_unlock(&ranks.lock);
+    return rc;
+}
+
+void rankGetStats(RankStats *stats) {
+    pthread_mutex_lock(&ranks.lock);
+    stats->institutes = ranks.groupCount;
+    stats->boards = ranks.boardCount;
+    stats->students = ranks.studentCount;
+    pthread_mutex_unlock(&ranks.lock);
+}
+
+void rankNoteMarks(const Profile *p, const void *data) {
+    if (!p || !data) return;
+    pthread_mutex_lock(&ranks.lock);
+    RankGroup *g = findGroup(p->instituteName, p->campusType);
+    if (g) fileStudent(g, p, data);
+    else forgetStudent(p->userID);      // it may sit in a loaded group it has left
+    pthread_mutex_unlock(&ranks.lock);
+}
+
+// A moved student is re-filed from the stored marks; other profile edits cost nothing
+void rankNoteProfile(const Profile *p) {
+    if (!p) return;
+    pthread_mutex_lock(&ranks.lock);
+    RankStudent *s = findStudent(p->userID);
+    RankGroup *g = findGroup(p->instituteName, p->campusType);
+    int moved = s ? s->group != g || s->slotCount == 0 : g != NULL;
+    pthread_mutex_unlock(&ranks.lock);
+    if (!moved) return;
+
+    union {
+        SchoolMarks school;
+        CollegeMarks college;
+    } data;
+    size_t size = sizeof(data);
+    const char *dataType = campusDataType(p->campusType);
+    int hasData = (p->campusType == CAMPUS_SCHOOL || p->campusType == CAMPUS_COLLEGE) &&
+                  loadUserData(p->userID, dataType, &data, &size) &&
+                  size == (p->campusType == CAMPUS_SCHOOL ? sizeof(SchoolMarks) : sizeof(CollegeMarks));
+
+    pthread_mutex_lock(&ranks.lock);
+    g = findGroup(p->instituteName, p->campusType);
+    if (g && hasData) fileStudent(g, p, &data);
+    else forgetStudent(p->userID);
+    pthread_mutex_unlock(&ranks.lock);
+}
+
+void rankReset(void) {
+    pthread_mutex_lock(&ranks.lock);
+    freeAll();
+    ranks.versionKnown = 0;
+    pthread_mutex_unlock(&ranks.lock);
+}
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "../include/regrade.h"
+#include "../include/database.h"
+#include "../include/grading_scheme.h"
+
+typedef struct {
+    const char (*userIDs)[20];
+    size_t count, chunks;
+    atomic_size_t nextChunk;
+    const RegradeOptions *options;
+    double started;
+    pthread_mutex_t lock;           // guards the totals below and serializes progress calls
+    size_t done, graded, missingData, failedChunks;
+} RegradeRun;
+
+RegradeOptions regradeDefaultOptions(void) {
+    RegradeOptions options;
+    options.threads = 0;
+    options.progress = NULL;
+    options.ctx = NULL;
+    return options;
+}
+
+static int onlineCpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return n > REGRADE_MAX_THREADS ? REGRADE_MAX_THREADS : (int)n;
+#endif
+    return 4;
+}
+
+static double monotonicSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Grades one chunk into `rows`; returns how many rows were filled
+static size_t gradeChunk(const UserRecord *records, size_t n, StoredGrade *rows, size_t *missing) {
+    size_t filled = 0;
+    for (size_t i = 0; i < n; i++) {
+        const UserRecord *rec = &records[i];
+        if (!rec->found || !rec->hasData) {
+            (*missing)++;
+            continue;
+        }
+        const GradingScheme *scheme = gradingSchemeFor(rec->profile.instituteName);
+        GradingResult result;
+        if (gradingSchemeApply(scheme, rec->profile.campusType, &rec->data, &result) != SUCCESS) {
+            (*missing)++;
+            continue;
+        }
+        StoredGrade *row = &rows[filled++];
+        memset(row, 0, sizeof(*row));
+        snprintf(row->userID, sizeof(row->userID), "%s", rec->profile.userID);
+        snprintf(row->institute, sizeof(row->institute), "%s", rec->profile.instituteName);
+        row->campusType = rec->profile.campusType;
+        row->schemeVersion = scheme->version;
+        row->percent = result.percent;
+        row->gpa = result.gpa;
+        snprintf(row->grade, sizeof(row->grade), "%s", scheme->names[result.grade]);
+        row->passed = result.passed;
+    }
+    return filled;
+}
+
+static void *regradeWorkerMain(void *arg) {
+    RegradeRun *run = (RegradeRun*)arg;
+    int ownConnection = openThreadConnection() == SUCCESS;
+    UserRecord *records = malloc(sizeof(UserRecord) * REGRADE_CHUNK);
+    StoredGrade *rows = malloc(sizeof(StoredGrade) * REGRADE_CHUNK);
+    const char *ids[REGRADE_CHUNK];
+
+    size_t chunk;
+    while (records && rows && (chunk = atomic_fetch_add(&run->nextChunk, 1)) < run->chunks) {
+        size_t base = chunk * REGRADE_CHUNK;
+        size_t n = run->count - base < REGRADE_CHUNK ? run->count - base : REGRADE_CHUNK;
+        for (size_t i = 0; i < n; i++) ids[i] = run->userIDs[base + i];
+
+        size_t missing = 0, filled = 0;
+        int failed = getUsersByIDs(ids, n, records) != SUCCESS;
+        if (!failed) {
+            filled = gradeChunk(records, n, rows, &missing);
+            failed = saveGradeResults(rows, filled) != SUCCESS;
+        }
+
+        pthread_mutex_lock(&run->lock);
+        run->done += n;
+        if (failed) {
+            run->failedChunks++;
+        } else {
+            run->graded += filled;
+            run->missingData += missing;
+        }
+        if (run->options->progress) {
+            RegradeProgress progress;
+            progress.done = run->done;
+            progress.total = run->count;
+            progress.seconds = monotonicSeconds() - run->started;
+            progress.perSecond = progress.seconds > 0 ? run->done / progress.seconds : 0.0;
+            run->options->progress(&progress, run->options->ctx);
+        }
+        pthread_mutex_unlock(&run->lock);
+    }
+    free(records);
+    free(rows);
+    if (ownConnection) closeThreadConnection();
+    return NULL;
+}
+
+// School then college IDs of the institute (or everyone)
+static ErrorCode listStudents(const char *institute, char (**userIDs)[20], size_t *count) {
+    char (*school)[20] = NULL, (*college)[20] = NULL;
+    size_t schoolCount = 0, collegeCount = 0;
+    ErrorCode rc = listUsersByInstitute(institute, CAMPUS_SCHOOL, &school, &schoolCount);
+    if (rc == SUCCESS) rc = listUsersByInstitute(institute, CAMPUS_COLLEGE, &college, &collegeCount);
+    if (rc == SUCCESS && collegeCount > 0) {
+        char (*all)[20] = realloc(school, (schoolCount + collegeCount) * sizeof(*all));
+        if (all) {
+            memcpy(all + schoolCount, college, collegeCount * sizeof(*all));
+            school = all;
+        } else {
+            rc = ERROR_MEMORY;
+        }
+    }
+    free(college);
+    if (rc != SUCCESS) {
+        free(school);
+        return rc;
+    }
+    *userIDs = school;
+    *count = schoolCount + collegeCount;
+    return SUCCESS;
+}
+
+ErrorCode runRegrade(const char *institute, const RegradeOptions *options, RegradeStats *stats) {
+    RegradeOptions defaults = regradeDefaultOptions();
+    RegradeStats ignored;
+    if (!options) options = &defaults;
+    if (!stats) stats = &ignored;
+    memset(stats, 0, sizeof(*stats));
+
+    char (*userIDs)[20] = NULL;
+    size_t count = 0;
+    ErrorCode rc = listStudents(institute, &userIDs, &count);
+    if (rc != SUCCESS) return rc;
+    if (count == 0) {
+        free(userIDs);
+        return ERROR_NOT_FOUND;
+    }
+
+    RegradeRun run;
+    memset(&run, 0, sizeof(run));
+    run.userIDs = (const char (*)[20])userIDs;
+    run.count = count;
+    run.chunks = (count + REGRADE_CHUNK - 1) / REGRADE_CHUNK;
+    atomic_init(&run.nextChunk, 0);
+    run.options = options;
+    pthread_mutex_init(&run.lock, NULL);
+
+    int threads = options->threads > 0 ? options->threads : onlineCpus();
+    if (threads > REGRADE_MAX_THREADS) threads = REGRADE_MAX_THREADS;
+    if ((size_t)threads > run.chunks) threads = (int)run.chunks;
+    pthread_t tids[REGRADE_MAX_THREADS];
+    int started[REGRADE_MAX_THREADS];
+
+    run.started = monotonicSeconds();
+    int running = 0;
+    for (int i = 0; i < threads; i++) {
+        started[i] = pthread_create(&tids[i], NULL, regradeWorkerMain, &run) == 0;
+        running += started[i];
+    }
+    if (running == 0) regradeWorkerMain(&run);     // no threads at all: do it here
+    for (int i = 0; i < threads; i++) {
+        if (started[i]) pthread_join(tids[i], NULL);
+    }
+    stats->seconds = monotonicSeconds() - run.started;
+
+    stats->students = count;
+    stats->graded = run.graded;
+    stats->missingData = run.missingData;
+    stats->chunks = run.chunks;
+    stats->failedChunks = run.failedChunks;
+    stats->threads = running > 0 ? running : 1;
+    pthread_mutex_destroy(&run.lock);
+    free(userIDs);
+    return run.failedChunks == 0 ? SUCCESS : ERROR_DATABASE;
+}
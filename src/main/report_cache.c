@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#define getpid _getpid
+#define utime _utime
+#else
+#include <utime.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "../include/report_cache.h"
+
+#define CACHE_KIND_LEN      32
+#define CACHE_MIN_BUCKETS   256
+#define CACHE_USAGE_FILE    ".usage"
+#define CACHE_TMP_STALE     60          // seconds before a temporary file counts as abandoned
+
+typedef struct CacheEntry {
+    struct CacheEntry *chain;           // same bucket (buckets are keyed by user ID)
+    struct CacheEntry *newer, *older;   // LRU list
+    char userID[20];
+    char kind[CACHE_KIND_LEN];
+    uint64_t version;
+    uint64_t size;
+    int64_t used;                       // modification time in ns, only for ordering a scan
+} CacheEntry;
+
+static struct {
+    pthread_mutex_t lock;
+    int open;
+    char dir[200];
+    uint64_t budget;
+    CacheEntry **buckets;
+    size_t bucketCount;                 // power of two
+    CacheEntry *newest, *oldest;
+    unsigned tmpSeq;
+    int usageFd;                        // shared byte count of the directory, -1 if unavailable
+    uint64_t disk;                      // that count, valid between diskBegin and diskEnd
+    ReportCacheStats stats;
+} cache = { .lock = PTHREAD_MUTEX_INITIALIZER, .usageFd = -1 };
+
+uint64_t reportCacheHash(uint64_t seed, const void *data, size_t length) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        seed ^= p[i];
+        seed *= 1099511628211ULL;
+    }
+    return seed;
+}
+
+// Names become file names: no separators, no dots in the user ID
+static int validKey(const char *userID, const char *kind) {
+    if (!userID || !kind || !userID[0] || kind[0] != '_') return 0;
+    if (strlen(userID) >= sizeof(((CacheEntry*)0)->userID) || strlen(kind) >= CACHE_KIND_LEN) return 0;
+    if (strpbrk(userID, "./\\") || strpbrk(kind, "/\\")) return 0;
+    return 1;
+}
+
+static void entryPath(const CacheEntry *e, char *path, size_t size) {
+    snprintf(path, size, "%s%s.%016llx%s", cache.dir, e->userID, (unsigned long long)e->version, e->kind);
+}
+
+static CacheEntry **bucketOf(const char *userID) {
+    uint64_t h = reportCacheHash(REPORT_CACHE_HASH_SEED, userID, strlen(userID));
+    return &cache.buckets[h & (cache.bucketCount - 1)];
+}
+
+static CacheEntry *findEntry(const char *userID, const char *kind) {
+    for (CacheEntry *e = *bucketOf(userID); e; e = e->chain) {
+        if (strcmp(e->userID, userID) == 0 && strcmp(e->kind, kind) == 0) return e;
+    }
+    return NULL;
+}
+
+static void lruUnlink(CacheEntry *e) {
+    if (e->newer) e->newer->older = e->older;
+    else cache.newest = e->older;
+    if (e->older) e->older->newer = e->newer;
+    else cache.oldest = e->newer;
+    e->newer = e->older = NULL;
+}
+
+static void lruPushNewest(CacheEntry *e) {
+    e->older = cache.newest;
+    e->newer = NULL;
+    if (cache.newest) cache.newest->newer = e;
+    else cache.oldest = e;
+    cache.newest = e;
+}
+
+static void growBuckets(void) {
+    size_t count = cache.bucketCount * 2;
+    CacheEntry **buckets = (CacheEntry**)calloc(count, sizeof(CacheEntry*));
+    if (!buckets) return;   // longer chains, still correct
+    CacheEntry **old = cache.buckets;
+    size_t oldCount = cache.bucketCount;
+    cache.buckets = buckets;
+    cache.bucketCount = count;
+    for (size_t i = 0; i < oldCount; i++) {
+        CacheEntry *e = old[i];
+        while (e) {
+            CacheEntry *next = e->chain;
+            CacheEntry **slot = bucketOf(e->userID);
+            e->chain = *slot;
+            *slot = e;
+            e = next;
+        }
+    }
+    free(old);
+}
+
+static void insertEntry(CacheEntry *e) {
+    if (cache.stats.entries >= cache.bucketCount) growBuckets();
+    CacheEntry **slot = bucketOf(e->userID);
+    e->chain = *slot;
+    *slot = e;
+    lruPushNewest(e);
+    cache.stats.entries++;
+    cache.stats.bytes += e->size;
+}
+
+static void removeEntry(CacheEntry *e, int deleteFile) {
+    for (CacheEntry **slot = bucketOf(e->userID); *slot; slot = &(*slot)->chain) {
+        if (*slot == e) {
+            *slot = e->chain;
+            break;
+        }
+    }
+    lruUnlink(e);
+    cache.stats.entries--;
+    cache.stats.bytes -= e->size;
+    if (deleteFile) {
+        char path[320];
+        entryPath(e, path, sizeof(path));
+        // Another process may have deleted it already; it counted the bytes then
+        if (remove(path) == 0) cache.disk -= e->size < cache.disk ? e->size : cache.disk;
+    }
+    free(e);
+}
+
+// Every process using the directory shares its total size through the
+// usage file: read and locked here, written back and unlocked in diskEnd().
+// Without the file (Windows, or it cannot be opened) the count is this
+// process's own index. Call with cache.lock held.
+static void diskBegin(void) {
+    cache.disk = cache.stats.bytes;
+#ifndef _WIN32
+    uint64_t count;
+    if (cache.usageFd >= 0 && flock(cache.usageFd, LOCK_EX) == 0 &&
+        pread(cache.usageFd, &count, sizeof(count), 0) == (ssize_t)sizeof(count)) {
+        cache.disk = count;
+    }
+#endif
+}
+
+static void diskEnd(void) {
+#ifndef _WIN32
+    if (cache.usageFd < 0) return;
+    if (pwrite(cache.usageFd, &cache.disk, sizeof(cache.disk), 0) != (ssize_t)sizeof(cache.disk)) {
+        ftruncate(cache.usageFd, 0);    // unreadable: the next diskBegin falls back
+    }
+    flock(cache.usageFd, LOCK_UN);
+#endif
+}
+
+static void scanDirectory(void);
+
+static void evictToBudget(void) {
+    // Bytes outside this index belong to other processes: pick their files
+    // up from the directory (by last use), which also corrects the count
+    if (cache.disk > cache.budget && cache.disk > cache.stats.bytes) scanDirectory();
+    while (cache.disk > cache.budget && cache.oldest) {
+        removeEntry(cache.oldest, 1);
+        cache.stats.evictions++;
+    }
+}
+
+static int byUse(const void *a, const void *b) {
+    int64_t x = (*(CacheEntry* const*)a)->used, y = (*(CacheEntry* const*)b)->used;
+    return x < y ? -1 : x > y;
+}
+
+// Rebuilds the index from the directory, oldest file first, and sets the
+// shared count to what it found; abandoned temporary files and superseded
+// versions are deleted
+static void scanDirectory(void) {
+    while (cache.oldest) removeEntry(cache.oldest, 0);
+    DIR *d = opendir(cache.dir);
+    if (!d) return;
+    time_t now = time(NULL);
+    size_t count = 0, cap = 64;
+    CacheEntry **found = (CacheEntry**)malloc(cap * sizeof(CacheEntry*));
+    struct dirent *ent;
+    char path[320];
+    while (found && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        int written = snprintf(path, sizeof(path), "%s%s", cache.dir, ent->d_name);
+        if (written < 0 || written >= (int)sizeof(path)) continue;     // not a name we write
+        struct stat st;
+        if (strstr(ent->d_name, ".tmp.")) {
+            // Another process may still be writing it
+            if (stat(path, &st) == 0 && now - st.st_mtime > CACHE_TMP_STALE) remove(path);
+            continue;
+        }
+        CacheEntry *e = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+        unsigned long long version;
+        if (!e || sscanf(ent->d_name, "%19[^.].%16llx%31s", e->userID, &version, e->kind) != 3 ||
+            !validKey(e->userID, e->kind) || stat(path, &st) != 0) {
+            free(e);
+            continue;
+        }
+        e->version = version;
+        e->size = (uint64_t)st.st_size;
+#ifdef _WIN32
+        e->used = (int64_t)st.st_mtime * 1000000000;
+#else
+        e->used = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        if (count == cap) {
+            CacheEntry **grown = (CacheEntry**)realloc(found, cap * 2 * sizeof(CacheEntry*));
+            if (!grown) {
+                free(e);
+                break;
+            }
+            found = grown;
+            cap *= 2;
+        }
+        found[count++] = e;
+    }
+    closedir(d);
+    if (!found) return;
+    qsort(found, count, sizeof(CacheEntry*), byUse);
+    for (size_t i = 0; i < count; i++) {
+        CacheEntry *older = findEntry(found[i]->userID, found[i]->kind);
+        if (older) removeEntry(older, 1);
+        insertEntry(found[i]);
+    }
+    free(found);
+    cache.disk = cache.stats.bytes;
+}
+
+ErrorCode reportCacheOpen(const char *dir, uint64_t budgetBytes) {
+    if (!dir || strlen(dir) + 1 >= sizeof(cache.dir)) return ERROR_INVALID_INPUT;
+    reportCacheClose();
+    pthread_mutex_lock(&cache.lock);
+    snprintf(cache.dir, sizeof(cache.dir), "%s", dir);
+    size_t len = strlen(cache.dir);
+    if (len > 0 && cache.dir[len - 1] != '/') strcat(cache.dir, "/");
+#ifdef _WIN32
+    _mkdir(cache.dir);
+#else
+    mkdir(cache.dir, 0700);
+#endif
+    cache.buckets = (CacheEntry**)calloc(CACHE_MIN_BUCKETS, sizeof(CacheEntry*));
+    if (!cache.buckets) {
+        pthread_mutex_unlock(&cache.lock);
+        return ERROR_MEMORY;
+    }
+    cache.bucketCount = CACHE_MIN_BUCKETS;
+    cache.budget = budgetBytes;
+    memset(&cache.stats, 0, sizeof(cache.stats));
+    cache.open = 1;
+#ifndef _WIN32
+    char path[320];
+    snprintf(path, sizeof(path), "%s%s", cache.dir, CACHE_USAGE_FILE);
+    cache.usageFd = open(path, O_RDWR | O_CREAT, 0600);
+#endif
+    diskBegin();
+    scanDirectory();
+    evictToBudget();
+    diskEnd();
+    pthread_mutex_unlock(&cache.lock);
+    return SUCCESS;
+}
+
+void reportCacheClose(void) {
+    pthread_mutex_lock(&cache.lock);
+    while (cache.oldest) removeEntry(cache.oldest, 0);
+    free(cache.buckets);
+    cache.buckets = NULL;
+    cache.bucketCount = 0;
+    cache.open = 0;
+#ifndef _WIN32
+    if (cache.usageFd >= 0) close(cache.usageFd);
+#endif
+    cache.usageFd = -1;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+ErrorCode reportCacheGet(const char *userID, const char *kind, uint64_t version,
+                         unsigned char **data, size_t *length) {
+    if (!data || !length || !validKey(userID, kind)) return ERROR_INVALID_INPUT;
+    *data = NULL;
+    *length = 0;
+    char path[320];
+    pthread_mutex_lock(&cache.lock);
+    CacheEntry *e = cache.open && cache.budget > 0 ? findEntry(userID, kind) : NULL;
+    if (!e || e->version != version) {
+        cache.stats.misses++;
+        pthread_mutex_unlock(&cache.lock);
+        return ERROR_NOT_FOUND;
+    }
+    lruUnlink(e);
+    lruPushNewest(e);
+    entryPath(e, path, sizeof(path));
+    size_t size = (size_t)e->size;
+    pthread_mutex_unlock(&cache.lock);
+
+    // Read outside the lock; the file may have been evicted meanwhile
+    FILE *f = fopen(path, "rb");
+    unsigned char *bytes = f ? (unsigned char*)malloc(size ? size : 1) : NULL;
+    int ok = bytes && fread(bytes, 1, size, f) == size && fgetc(f) == EOF;
+    if (f) fclose(f);
+
+    pthread_mutex_lock(&cache.lock);
+    if (ok) {
+        cache.stats.hits++;
+        utime(path, NULL);      // the last use, for other processes' scans
+    } else {
+        cache.stats.misses++;
+        e = cache.open ? findEntry(userID, kind) : NULL;
+        if (e && e->version == version) {
+            diskBegin();
+            removeEntry(e, 1);
+            diskEnd();
+        }
+    }
+    pthread_mutex_unlock(&cache.lock);
+    if (!ok) {
+        free(bytes);
+        return ERROR_NOT_FOUND;
+    }
+    *data = bytes;
+    *length = size;
+    return SUCCESS;
+}
+
+ErrorCode reportCachePut(const char *userID, const char *kind, uint64_t version,
+                         const void *data, size_t length) {
+    if (!data || !validKey(userID, kind)) return ERROR_INVALID_INPUT;
+    CacheEntry *e = (CacheEntry*)calloc(1, sizeof(CacheEntry));
+    if (!e) return ERROR_MEMORY;
+    snprintf(e->userID, sizeof(e->userID), "%s", userID);
+    snprintf(e->kind, sizeof(e->kind), "%s", kind);
+    e->version = version;
+    e->size = length;
+
+    char path[320], tmp[352];
+    pthread_mutex_lock(&cache.lock);
+    if (!cache.open || length > cache.budget) {
+        pthread_mutex_unlock(&cache.lock);
+        free(e);
+        return SUCCESS;     // disabled, or could never fit
+    }
+    entryPath(e, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d.%u", path, (int)getpid(), cache.tmpSeq++);
+    pthread_mutex_unlock(&cache.lock);
+
+    FILE *f = fopen(tmp, "wb");
+    int ok = f && fwrite(data, 1, length, f) == length;
+    if (f && fclose(f) != 0) ok = 0;
+    if (!ok) {
+        remove(tmp);
+        free(e);
+        return ERROR_FILE_IO;
+    }
+
+    pthread_mutex_lock(&cache.lock);
+    CacheEntry *current = cache.open ? findEntry(userID, kind) : NULL;
+    if (!cache.open || (current && current->version == version)) {
+        remove(tmp);        // closed meanwhile, or another thread stored it first
+        free(e);
+        pthread_mutex_unlock(&cache.lock);
+        return SUCCESS;
+    }
+    diskBegin();
+    // Another process may have stored the same version; rename() replaces it
+    struct stat st;
+    uint64_t replaced = stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (rename(tmp, path) != 0) {
+        diskEnd();
+        remove(tmp);
+        free(e);
+        pthread_mutex_unlock(&cache.lock);
+        return ERROR_FILE_IO;
+    }
+    cache.disk = cache.disk - (replaced < cache.disk ? replaced : cache.disk) + length;
+    if (current) removeEntry(current, 1);
+    insertEntry(e);
+    cache.stats.stores++;
+    evictToBudget();
+    diskEnd();
+    pthread_mutex_unlock(&cache.lock);
+    return SUCCESS;
+}
+
+void reportCacheInvalidate(const char *userID) {
+    if (!userID) return;
+    pthread_mutex_lock(&cache.lock);
+    if (cache.open) {
+        diskBegin();
+        CacheEntry *e = *bucketOf(userID);
+        while (e) {
+            CacheEntry *next = e->chain;
+            if (strcmp(e->userID, userID) == 0) {
+                removeEntry(e, 1);
+                cache.stats.invalidations++;
+            }
+            e = next;
+        }
+        diskEnd();
+    }
+    pthread_mutex_unlock(&cache.lock);
+}
+
+void reportCacheGetStats(ReportCacheStats *stats) {
+    if (!stats) return;
+    pthread_mutex_lock(&cache.lock);
+    *stats = cache.stats;
+    if (cache.open) {
+        diskBegin();
+        stats->diskBytes = cache.disk;
+        diskEnd();
+    }
+    pthread_mutex_unlock(&cache.lock);
+}
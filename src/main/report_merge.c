@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/report_merge.h"
+#include "../include/database.h"
+#include "../include/pdf_writer.h"
+#include "../include/grade_kernel.h"
+
+#define MERGE_OUTPUT_BUFFER (256 * 1024)
+
+typedef struct {
+    char userID[20];
+    float score;        // rank key; -1 without campus data
+} MergeEntry;
+
+static double monotonicSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int byUserID(const void *a, const void *b) {
+    return strcmp(((const MergeEntry*)a)->userID, ((const MergeEntry*)b)->userID);
+}
+
+static int byRank(const void *a, const void *b) {
+    const MergeEntry *x = (const MergeEntry*)a, *y = (const MergeEntry*)b;
+    if (x->score != y->score) return x->score > y->score ? -1 : 1;
+    return strcmp(x->userID, y->userID);
+}
+
+// The users of entries[0..n) in one bulk read (n <= DB_BATCH_CHUNK)
+static ErrorCode readChunk(const MergeEntry *entries, size_t n, UserRecord *records) {
+    const char *ids[DB_BATCH_CHUNK];
+    for (size_t i = 0; i < n; i++) ids[i] = entries[i].userID;
+    return getUsersByIDs(ids, n, records);
+}
+
+// One chunk's marks transposed for the grade kernel (grade_kernel.h)
+typedef struct {
+    int marks[MAX_SUBJECTS][DB_BATCH_CHUNK];
+    int weights[MAX_SUBJECTS][DB_BATCH_CHUNK];
+    int total[DB_BATCH_CHUNK];
+    int weight[DB_BATCH_CHUNK];
+    float score[DB_BATCH_CHUNK];
+    size_t slot[DB_BATCH_CHUNK];    // record index of each column
+} ScoreColumns;
+
+// Scores the chunk's users of one campus type in a single kernel call
+static void scoreCampus(ScoreColumns *c, const UserRecord *records, size_t n, CampusType type, MergeEntry *entries) {
+    size_t k = 0;
+    int subjects = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!records[i].found || !records[i].hasData || records[i].profile.campusType != type) continue;
+        const int *marks = type == CAMPUS_SCHOOL ? records[i].data.school.marks : records[i].data.college.marks;
+        const int *weights = type == CAMPUS_SCHOOL ? records[i].data.school.fullMarks : records[i].data.college.credits;
+        int count = type == CAMPUS_SCHOOL ? records[i].data.school.count : records[i].data.college.count;
+        if (count < 0) count = 0;
+        if (count > MAX_SUBJECTS) count = MAX_SUBJECTS;
+        for (int s = 0; s < MAX_SUBJECTS; s++) {
+            c->marks[s][k] = s < count ? marks[s] : 0;
+            c->weights[s][k] = s < count ? weights[s] : 0;
+        }
+        if (count > subjects) subjects = count;
+        c->slot[k++] = i;
+    }
+    if (k == 0) return;
+    GradeBatch batch = { type == CAMPUS_SCHOOL ? GRADE_SCALE_PERCENT : GRADE_SCALE_CGPA, k, DB_BATCH_CHUNK,
+                         subjects, &c->marks[0][0], &c->weights[0][0] };
+    GradeResults out = { c->total, c->weight, c->score, NULL };
+    gradeBatch(&batch, &out);
+    for (size_t j = 0; j < k; j++) entries[c->slot[j]].score = c->score[j];
+}
+
+static ErrorCode scoreEntries(MergeEntry *entries, size_t count, UserRecord *records) {
+    ScoreColumns *columns = malloc(sizeof(ScoreColumns));
+    if (!columns) return ERROR_MEMORY;
+    for (size_t start = 0; start < count; start += DB_BATCH_CHUNK) {
+        size_t n = count - start < DB_BATCH_CHUNK ? count - start : DB_BATCH_CHUNK;
+        ErrorCode rc = readChunk(entries + start, n, records);
+        if (rc != SUCCESS) {
+            free(columns);
+            return rc;
+        }
+        // Hospital and hostel users with data rank at 0, users without at -1
+        for (size_t i = 0; i < n; i++) entries[start + i].score = records[i].found && records[i].hasData ? 0.0f : -1.0f;
+        scoreCampus(columns, records, n, CAMPUS_SCHOOL, entries + start);
+        scoreCampus(columns, records, n, CAMPUS_COLLEGE, entries + start);
+    }
+    free(columns);
+    return SUCCESS;
+}
+
+static ErrorCode writePages(PdfWriter *pdf, const MergeEntry *entries, size_t count, UserRecord *records,
+                            MergedReportStats *stats) {
+    ReportLayout layout;
+    for (size_t start = 0; start < count; start += DB_BATCH_CHUNK) {
+        size_t n = count - start < DB_BATCH_CHUNK ? count - start : DB_BATCH_CHUNK;
+        ErrorCode rc = readChunk(entries + start, n, records);
+        if (rc != SUCCESS) return rc;
+        for (size_t i = 0; i < n; i++) {
+            if (!records[i].found || !records[i].hasData ||
+                layoutCampusReport(&records[i].profile, &records[i].data, &layout) != SUCCESS) {
+                stats->missingData++;
+                continue;
+            }
+            rc = pdfBeginPage(pdf, PDF_A4_WIDTH, PDF_A4_HEIGHT);
+            if (rc == SUCCESS) rc = pdfSetFont(pdf, PDF_FONT_HELVETICA, 12);
+            for (int l = 0; rc == SUCCESS && l < layout.count; l++) {
+                rc = pdfText(pdf, layout.lines[l].x, layout.lines[l].y, layout.lines[l].text);
+            }
+            if (rc == SUCCESS) rc = pdfEndPage(pdf);
+            if (rc != SUCCESS) return rc;
+        }
+    }
+    return SUCCESS;
+}
+
+ErrorCode writeMergedReport(const char (*userIDs)[20], size_t count, ReportOrder order, const char *path,
+                            MergedReportStats *stats) {
+    MergedReportStats ignored;
+    if (!stats) stats = &ignored;
+    memset(stats, 0, sizeof(*stats));
+    if (!path || (!userIDs && count > 0)) return ERROR_INVALID_INPUT;
+    stats->users = count;
+    if (count == 0) return ERROR_NOT_FOUND;
+    double started = monotonicSeconds();
+
+    MergeEntry *entries = malloc(count * sizeof(MergeEntry));
+    UserRecord *records = malloc(DB_BATCH_CHUNK * sizeof(UserRecord));
+    if (!entries || !records) {
+        free(entries);
+        free(records);
+        return ERROR_MEMORY;
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(entries[i].userID, sizeof(entries[i].userID), "%s", userIDs[i]);
+        entries[i].score = 0.0f;
+    }
+    ErrorCode rc = SUCCESS;
+    if (order == REPORT_ORDER_RANK) rc = scoreEntries(entries, count, records);
+    if (rc == SUCCESS) qsort(entries, count, sizeof(MergeEntry), order == REPORT_ORDER_RANK ? byRank : byUserID);
+
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *out = rc == SUCCESS ? fopen(tmp, "wb") : NULL;
+    if (rc == SUCCESS && !out) rc = ERROR_FILE_IO;
+    PdfWriter *pdf = NULL;
+    if (out) {
+        setvbuf(out, NULL, _IOFBF, MERGE_OUTPUT_BUFFER);
+        pdf = pdfWriterOpen(out);
+        if (!pdf) rc = ERROR_MEMORY;
+    }
+    if (pdf) {
+        rc = writePages(pdf, entries, count, records, stats);
+        stats->pages = pdfPageCount(pdf);
+        if (rc == SUCCESS && stats->pages == 0) rc = ERROR_NOT_FOUND;
+        ErrorCode closed = pdfWriterClose(pdf, rc != SUCCESS);
+        if (rc == SUCCESS) rc = closed;
+    }
+    if (out) {
+        stats->bytes = (uint64_t)ftell(out);
+        if (fclose(out) != 0 && rc == SUCCESS) rc = ERROR_FILE_IO;
+        if (rc == SUCCESS) {
+#ifdef _WIN32
+            remove(path);
+#endif
+            if (rename(tmp, path) != 0) rc = ERROR_FILE_IO;
+        }
+        if (rc != SUCCESS) remove(tmp);
+    }
+    free(entries);
+    free(records);
+    stats->seconds = monotonicSeconds() - started;
+    return rc;
+}
+
+ErrorCode writeInstituteMergedReport(const char *instituteName, CampusType type, ReportOrder order,
+                                     const char *path, MergedReportStats *stats) {
+    char (*userIDs)[20] = NULL;
+    size_t count = 0;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    ErrorCode rc = listUsersByInstitute(instituteName, type, &userIDs, &count);
+    if (rc != SUCCESS) return rc;
+    rc = writeMergedReport((const char (*)[20])userIDs, count, order, path, stats);
+    free(userIDs);
+    return rc;
+}
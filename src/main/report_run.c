@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+#include "../include/report_run.h"
+#include "../include/database.h"
+#include "../include/student.h"
+
+// One worker's share of the user list: the owner takes from `next`, a thief
+// takes the back half
+typedef struct {
+    pthread_mutex_t lock;
+    size_t next, end;
+} ReportRange;
+
+typedef struct ReportRun ReportRun;
+
+typedef struct {
+    ReportRun *run;
+    int index;
+    size_t written, missingData, failed, steals;
+} ReportWorker;
+
+struct ReportRun {
+    const char (*userIDs)[20];
+    char dir[256];
+    int threads;
+    ReportRange *ranges;
+    ReportWorker *workers;
+};
+
+ReportRunOptions reportRunDefaultOptions(void) {
+    ReportRunOptions options;
+    options.threads = 0;
+    options.outDir = NULL;
+    return options;
+}
+
+static int onlineCpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return n > REPORT_MAX_THREADS ? REPORT_MAX_THREADS : (int)n;
+#endif
+    return 4;
+}
+
+static double monotonicSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int takeOwn(ReportRange *range, size_t *task) {
+    pthread_mutex_lock(&range->lock);
+    int found = range->next < range->end;
+    if (found) *task = range->next++;
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+// Moves the back half of the fullest other range into the worker's own (empty)
+// range and hands out its first task. Only owners add to a range, so a worker
+// that finds nothing may stop: whatever is left will be run by its owner.
+static int steal(ReportWorker *self, size_t *task) {
+    ReportRun *run = self->run;
+    for (;;) {
+        int victim = -1;
+        size_t most = 0;
+        for (int i = 0; i < run->threads; i++) {
+            if (i == self->index) continue;
+            pthread_mutex_lock(&run->ranges[i].lock);
+            size_t left = run->ranges[i].end - run->ranges[i].next;
+            pthread_mutex_unlock(&run->ranges[i].lock);
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim < 0) return 0;
+
+        ReportRange *from = &run->ranges[victim];
+        pthread_mutex_lock(&from->lock);
+        size_t left = from->end - from->next;
+        size_t take = (left + 1) / 2;
+        size_t start = from->end - take, end = from->end;
+        from->end = start;
+        pthread_mutex_unlock(&from->lock);
+        if (take == 0) continue;    // drained since the scan; look again
+
+        ReportRange *own = &run->ranges[self->index];
+        pthread_mutex_lock(&own->lock);
+        own->next = start + 1;
+        own->end = end;
+        pthread_mutex_unlock(&own->lock);
+        self->steals++;
+        *task = start;
+        return 1;
+    }
+}
+
+static void renderOne(ReportWorker *self, const char *userID) {
+    Profile p = {0};
+    char path[512];
+    if (!getUserByID(userID, &p)) {
+        self->failed++;
+        return;
+    }
+    ErrorCode rc = writeCampusReport(&p, self->run->dir, path, sizeof(path));
+    if (rc == SUCCESS) self->written++;
+    else if (rc == ERROR_NOT_FOUND) self->missingData++;
+    else self->failed++;
+}
+
+static void *reportWorkerMain(void *arg) {
+    ReportWorker *self = (ReportWorker*)arg;
+    // Without a connection of its own the worker still runs, on the shared one
+    int ownConnection = openThreadConnection() == SUCCESS;
+    size_t task;
+    while (takeOwn(&self->run->ranges[self->index], &task) || steal(self, &task)) {
+        renderOne(self, self->run->userIDs[task]);
+    }
+    if (ownConnection) closeThreadConnection();
+    return NULL;
+}
+
+static void ensureDir(const char *dir) {
+    struct stat st;
+    if (stat(dir, &st) == 0) return;
+#ifdef _WIN32
+    _mkdir(dir);
+#else
+    mkdir(dir, 0700);
+#endif
+}
+
+ErrorCode runReports(const char (*userIDs)[20], size_t count, const ReportRunOptions *options,
+                     ReportRunStats *stats) {
+    ReportRunOptions defaults = reportRunDefaultOptions();
+    ReportRunStats ignored;
+    if (!options) options = &defaults;
+    if (!stats) stats = &ignored;
+    memset(stats, 0, sizeof(*stats));
+    if (!userIDs && count > 0) return ERROR_INVALID_INPUT;
+    stats->users = count;
+    if (count == 0) return SUCCESS;
+
+    ReportRun run;
+    memset(&run, 0, sizeof(run));
+    run.userIDs = userIDs;
+    const char *dir = options->outDir ? options->outDir : DATA_DIR;
+    size_t len = strlen(dir);
+    if (len == 0 || len + 2 > sizeof(run.dir)) return ERROR_INVALID_INPUT;
+    snprintf(run.dir, sizeof(run.dir), "%s%s", dir, dir[len - 1] == '/' ? "" : "/");
+    ensureDir(dir);
+
+    int threads = options->threads > 0 ? options->threads : onlineCpus();
+    if (threads > REPORT_MAX_THREADS) threads = REPORT_MAX_THREADS;
+    if ((size_t)threads > count) threads = (int)count;
+    run.threads = threads;
+    run.ranges = calloc((size_t)threads, sizeof(ReportRange));
+    run.workers = calloc((size_t)threads, sizeof(ReportWorker));
+    pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+    if (!run.ranges || !run.workers || !tids) {
+        free(run.ranges);
+        free(run.workers);
+        free(tids);
+        return ERROR_MEMORY;
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&run.ranges[i].lock, NULL);
+        run.ranges[i].next = count * (size_t)i / (size_t)threads;
+        run.ranges[i].end = count * (size_t)(i + 1) / (size_t)threads;
+        run.workers[i].run = &run;
+        run.workers[i].index = i;
+    }
+
+    // A worker that fails to start leaves its range to be stolen by the others
+    double started = monotonicSeconds();
+    int running = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&tids[i], NULL, reportWorkerMain, &run.workers[i]) == 0) running++;
+        else tids[i] = pthread_self();
+    }
+    if (running == 0) reportWorkerMain(&run.workers[0]);   // no threads at all: do it here
+    for (int i = 0; i < threads; i++) {
+        if (!pthread_equal(tids[i], pthread_self())) pthread_join(tids[i], NULL);
+    }
+    stats->seconds = monotonicSeconds() - started;
+
+    stats->threads = running > 0 ? running : 1;
+    for (int i = 0; i < threads; i++) {
+        stats->written += run.workers[i].written;
+        stats->missingData += run.workers[i].missingData;
+        stats->failed += run.workers[i].failed;
+        stats->steals += run.workers[i].steals;
+        pthread_mutex_destroy(&run.ranges[i].lock);
+    }
+    free(run.ranges);
+    free(run.workers);
+    free(tids);
+    return stats->failed == 0 ? SUCCESS : ERROR_FILE_IO;
+}
+
+ErrorCode runInstituteReports(const char *instituteName, CampusType type, const ReportRunOptions *options,
+                              ReportRunStats *stats) {
+    char (*userIDs)[20] = NULL;
+    size_t count = 0;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    ErrorCode rc = listUsersByInstitute(instituteName, type, &userIDs, &count);
+    if (rc != SUCCESS) return rc;
+    if (count == 0) {
+        free(userIDs);
+        return ERROR_NOT_FOUND;
+    }
+    rc = runReports((const char (*)[20])userIDs, count, options, stats);
+    free(userIDs);
+    return rc;
+}
@@ -4,24 +4,34 @@
 #include <string.h>
 #include <time.h>
 #include <stddef.h>
+#include <stdint.h>
 #ifdef _WIN32
 #include <direct.h>
 #else
 #include <sys/stat.h>
 #endif
 #include <ctype.h>
+#include <pthread.h>
 #include "../include/campus_security.h"
 #include "../include/database.h"
 #include "../include/sha256.h"
+#include "../include/shared_table.h"
 
-#define ACCOUNT_LOCK_FILE_PREFIX "data/lock_"
-#define MAX_SESSIONS 100
 #define SESSION_TIMEOUT 1800
 #define MAX_LOGIN_ATTEMPTS 3
 #define ACCOUNT_LOCK_DURATION 900
 
-static Session activeSessions[MAX_SESSIONS];
-static int sessionCount = 0;
+// Sessions live in shared memory so every server worker thread and every
+// prefork worker process can validate any token
+#define SESSION_SHARDS      64
+#define SESSION_SHARD_SLOTS 1024    // 64K sessions; pages are touched as shards fill
+
+static int sessionExpired(const void *record, time_t now) {
+    return now - ((const Session*)record)->lastActivity > SESSION_TIMEOUT;
+}
+
+static SharedTable sessions = SHARED_TABLE_INIT(Session, sessionToken, SESSION_SHARDS, SESSION_SHARD_SLOTS,
+                                                sessionExpired);
 
 // Sanitize userID to prevent path traversal
 static int sanitizeUserID(const char *userID, char *sanitized, size_t size) {
@@ -40,20 +50,16 @@ static int sanitizeUserID(const char *userID, char *sanitized, size_t size) {
     return 1;
 }
 
+// Locks live in account_locks; `campus migrate` imports old lock files
 int isAccountLocked(const char *userID) {
     char sanitized[64];
     if (!sanitizeUserID(userID, sanitized, sizeof(sanitized))) return 0;
-    char filename[256];
-    snprintf(filename, sizeof(filename), ACCOUNT_LOCK_FILE_PREFIX "%s.dat", sanitized);
-    FILE *f = fopen(filename, "rb");
-    if (!f) return 0;
-    time_t expiry = 0;
-    fread(&expiry, sizeof(time_t), 1, f);
-    fclose(f);
+    int64_t expiry = getAccountLock(sanitized);
+    if (expiry == 0) return 0;
     if (time(0) < expiry) {
         return 1;
     } else {
-        remove(filename);
+        clearAccountLock(sanitized);
         return 0;
     }
 }
@@ -61,25 +67,17 @@ int isAccountLocked(const char *userID) {
 int lockAccount(const char *userID, int durationMinutes) {
     char sanitized[64];
     if (!sanitizeUserID(userID, sanitized, sizeof(sanitized))) return 0;
-    char filename[256];
-    snprintf(filename, sizeof(filename), ACCOUNT_LOCK_FILE_PREFIX "%s.dat", sanitized);
-    FILE *f = fopen(filename, "wb");
-    if (!f) return 0;
-    time_t expiry = time(0) + durationMinutes * 60;
-    fwrite(&expiry, sizeof(time_t), 1, f);
-    fclose(f);
-    logSecurityEvent(userID, "ACCOUNT_LOCKED", "Account locked due to failed attempts");
+    int64_t expiry = (int64_t)time(0) + durationMinutes * 60;
+    if (setAccountLock(sanitized, expiry) != SUCCESS) return 0;
+    logSecurityEvent(userID, EVENT_ACCOUNT_LOCKED, "Account locked due to failed attempts");
     return 1;
 }
 
 int unlockAccount(const char *userID) {
     char sanitized[64];
     if (!sanitizeUserID(userID, sanitized, sizeof(sanitized))) return 0;
-    char filename[256];
-    snprintf(filename, sizeof(filename), ACCOUNT_LOCK_FILE_PREFIX "%s.dat", sanitized);
-    int res = remove(filename);
-    if (res == 0) {
-        logSecurityEvent(userID, "ACCOUNT_UNLOCKED", "Account unlocked manually");
+    if (clearAccountLock(sanitized) == SUCCESS) {
+        logSecurityEvent(userID, EVENT_ACCOUNT_UNLOCKED, "Account unlocked manually");
         return 1;
     }
     return 0;
@@ -139,7 +137,7 @@ int generateOTP(const char *userID, char *otp) {
     fwrite(&expiry, sizeof(time_t), 1, f);
     fclose(f);
     
-    logSecurityEvent(userID, "OTP_GENERATED", "OTP generated for authentication");
+    logSecurityEvent(userID, EVENT_OTP_GENERATED, "OTP generated for authentication");
     return 1;
 }
 
@@ -161,17 +159,17 @@ int verifyOTP(const char *userID, const char *otp) {
     
     if (time(NULL) > expiry) {
         remove(filename);
-        logSecurityEvent(userID, "OTP_EXPIRED", "OTP verification failed - expired");
+        logSecurityEvent(userID, EVENT_OTP_EXPIRED, "OTP verification failed - expired");
         return 0;
     }
     
     if (strcmp(storedOTP, otp) == 0) {
         remove(filename);
-        logSecurityEvent(userID, "OTP_VERIFIED", "OTP verification successful");
+        logSecurityEvent(userID, EVENT_OTP_VERIFIED, "OTP verification successful");
         return 1;
     }
     
-    logSecurityEvent(userID, "OTP_INVALID", "OTP verification failed - invalid code");
+    logSecurityEvent(userID, EVENT_OTP_INVALID, "OTP verification failed - invalid code");
     return 0;
 }
 
@@ -194,86 +192,129 @@ int sendOTPEmail(const char *email, const char *otp) {
         fprintf(f, "[%s] EMAIL -> %s | OTP=****** | TTL=5m\n", timeStr ? timeStr : "Unknown", email ? email : "UNKNOWN");
         fclose(f);
     }
-    logSecurityEvent(email, "OTP_EMAIL_DISPATCHED", "OTP sent via Email channel");
+    logSecurityEvent(email, EVENT_OTP_EMAIL_DISPATCHED, "OTP sent via Email channel");
     printf("OTP sent to your email.\n");
     return 1;
 }
 
-int createSession(const char *userID, AuthLevel level, Session *session) {
-    if (sessionCount >= MAX_SESSIONS) {
-        cleanupExpiredSessions();
-        if (sessionCount >= MAX_SESSIONS) return 0;
+int randomBytes(void *out, size_t size) {
+    unsigned char *bytes = (unsigned char*)out;
+#ifdef _WIN32
+    for (size_t i = 0; i < size; i += 4) {
+        unsigned int r;
+        if (rand_s(&r) != 0) return 0;
+        memcpy(bytes + i, &r, size - i < 4 ? size - i : 4);
     }
-    
-    Session *newSession = &activeSessions[sessionCount++];
-    strncpy(newSession->userID, userID, 19);
-    newSession->userID[19] = '\0';
-    
-    srand((unsigned int)time(NULL));
-    snprintf(newSession->sessionToken, 64, "%s_%lld_%d", userID, (long long)time(NULL), rand());
-    
-    newSession->loginTime = time(NULL);
-    newSession->lastActivity = time(NULL);
-    newSession->authLevel = level;
-    newSession->isActive = 1;
-    
-    *session = *newSession;
-    logSecurityEvent(userID, "SESSION_CREATED", "New session created");
+#else
+    FILE *urnd = fopen("/dev/urandom", "rb");
+    if (!urnd) return 0;
+    size_t got = fread(bytes, 1, size, urnd);
+    fclose(urnd);
+    if (got != size) return 0;
+#endif
+    return 1;
+}
+
+// 128-bit token from the OS RNG, hex encoded
+int generateRandomToken(char *out, size_t size) {
+    unsigned char bytes[16];
+    if (!randomBytes(bytes, sizeof(bytes))) return 0;
+    static const char hex[] = "0123456789abcdef";
+    if (size < sizeof(bytes) * 2 + 1) return 0;
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        out[i * 2] = hex[bytes[i] >> 4];
+        out[i * 2 + 1] = hex[bytes[i] & 15];
+    }
+    out[sizeof(bytes) * 2] = '\0';
+    return 1;
+}
+
+int sessionStoreInit(void) {
+    return sharedTableInit(&sessions);
+}
+
+int createSession(const char *userID, AuthLevel level, Session *session) {
+    Session fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    if (!userID || !session || !generateRandomToken(fresh.sessionToken, sizeof(fresh.sessionToken))) return 0;
+    snprintf(fresh.userID, sizeof(fresh.userID), "%s", userID);
+    fresh.loginTime = time(NULL);
+    fresh.lastActivity = fresh.loginTime;
+    fresh.authLevel = level;
+    fresh.isActive = 1;
+
+    uint32_t hash = sharedTableHash(fresh.sessionToken);
+    SharedShard *shard = sharedTableLock(&sessions, hash);
+    if (!shard) return 0;
+    int stored = sharedTableInsert(&sessions, shard, &fresh, hash);
+    sharedTableUnlock(shard);
+    if (!stored) return 0;
+    *session = fresh;
+
+    logSecurityEvent(userID, EVENT_SESSION_CREATED, "New session created");
     return 1;
 }
 
 int validateSession(const char *sessionToken, Session *session) {
-    for (int i = 0; i < sessionCount; i++) {
-        if (activeSessions[i].isActive && 
-            strcmp(activeSessions[i].sessionToken, sessionToken) == 0) {
-            
-            if (time(NULL) - activeSessions[i].lastActivity > SESSION_TIMEOUT) {
-                activeSessions[i].isActive = 0;
-                logSecurityEvent(activeSessions[i].userID, "SESSION_EXPIRED", "Session expired");
-                return 0;
-            }
-            
-            *session = activeSessions[i];
-            return 1;
+    if (!sessionToken || !*sessionToken) return 0;
+    char expiredUser[20] = {0};
+    int valid = 0;
+
+    uint32_t hash = sharedTableHash(sessionToken);
+    SharedShard *shard = sharedTableLock(&sessions, hash);
+    if (!shard) return 0;
+    Session *s = (Session*)sharedTableFind(&sessions, shard, sessionToken, hash);
+    if (s) {
+        if (sessionExpired(s, time(NULL))) {
+            memcpy(expiredUser, s->userID, sizeof(expiredUser));
+            sharedTableRemove(&sessions, shard, s);
+        } else {
+            if (session) *session = *s;
+            valid = 1;
         }
     }
-    return 0;
+    sharedTableUnlock(shard);
+
+    if (expiredUser[0]) logSecurityEvent(expiredUser, EVENT_SESSION_EXPIRED, "Session expired");
+    return valid;
 }
 
 int updateSessionActivity(const char *sessionToken) {
-    for (int i = 0; i < sessionCount; i++) {
-        if (activeSessions[i].isActive && 
-            strcmp(activeSessions[i].sessionToken, sessionToken) == 0) {
-            activeSessions[i].lastActivity = time(NULL);
-            return 1;
-        }
-    }
-    return 0;
+    if (!sessionToken || !*sessionToken) return 0;
+    uint32_t hash = sharedTableHash(sessionToken);
+    SharedShard *shard = sharedTableLock(&sessions, hash);
+    if (!shard) return 0;
+    Session *s = (Session*)sharedTableFind(&sessions, shard, sessionToken, hash);
+    if (s) s->lastActivity = time(NULL);
+    sharedTableUnlock(shard);
+    return s != NULL;
 }
 
 int destroySession(const char *sessionToken) {
-    for (int i = 0; i < sessionCount; i++) {
-        if (strcmp(activeSessions[i].sessionToken, sessionToken) == 0) {
-            activeSessions[i].isActive = 0;
-            logSecurityEvent(activeSessions[i].userID, "SESSION_DESTROYED", "Session terminated");
-            return 1;
-        }
+    if (!sessionToken || !*sessionToken) return 0;
+    char userID[20] = {0};
+    uint32_t hash = sharedTableHash(sessionToken);
+    SharedShard *shard = sharedTableLock(&sessions, hash);
+    if (!shard) return 0;
+    Session *s = (Session*)sharedTableFind(&sessions, shard, sessionToken, hash);
+    int found = s != NULL;
+    if (found) {
+        memcpy(userID, s->userID, sizeof(userID));
+        sharedTableRemove(&sessions, shard, s);
     }
-    return 0;
+    sharedTableUnlock(shard);
+
+    if (!found) return 0;
+    logSecurityEvent(userID, EVENT_SESSION_DESTROYED, "Session terminated");
+    return 1;
 }
 
 int cleanupExpiredSessions(void) {
-    int cleaned = 0;
-    time_t now = time(NULL);
-    
-    for (int i = 0; i < sessionCount; i++) {
-        if (activeSessions[i].isActive && 
-            (now - activeSessions[i].lastActivity > SESSION_TIMEOUT)) {
-            activeSessions[i].isActive = 0;
-            cleaned++;
-        }
-    }
-    return cleaned;
+    return sharedTableSweep(&sessions, time(NULL));
+}
+
+static int activeSessionCount(void) {
+    return sharedTableCount(&sessions);
 }
 
 void encryptData(const char *data, char *encrypted, const char *key) {
@@ -304,7 +345,7 @@ void generateSecureHash(const char *input, char *hash) {
     hash[64] = '\0';
 }
 
-int logSecurityEvent(const char *userID, const char *event, const char *details) {
+int logSecurityEvent(const char *userID, AuditEvent event, const char *details) {
     return logActivity(userID, event, details);
 }
 
@@ -316,7 +357,15 @@ int generateSecurityReport(const char *reportPath) {
     time_t now = time(NULL);
     char *timeStr = ctime(&now);
     fprintf(report, "Generated: %s\n", timeStr ? timeStr : "Unknown time");
-    fprintf(report, "Active Sessions: %d\n", sessionCount);
+    fprintf(report, "Active Sessions: %d\n", activeSessionCount());
+
+    long counts[EVENT_COUNT];
+    if (getAuditEventCounts(counts)) {
+        fprintf(report, "\nAudit Events:\n");
+        for (int code = 0; code < EVENT_COUNT; code++) {
+            if (counts[code]) fprintf(report, "  %-22s %ld\n", auditEventName((AuditEvent)code), counts[code]);
+        }
+    }
     
     fclose(report);
     return 1;
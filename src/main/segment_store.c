@@ -0,0 +1,867 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <dirent.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "../include/segment_store.h"
+
+#define SEG_MAGIC           "CAMSEG01"
+#define SEG_VERSION         1
+#define SEG_HEADER_SIZE     16
+#define ENTRY_MAGIC         0x45474553u     // "SEGE"
+#define ENTRY_HEADER_SIZE   16
+#define ENTRY_TOMBSTONE     0x01
+#define DEFAULT_GARBAGE     0.5
+#define COMPACT_TICK_MILLIS 1000
+
+typedef struct {
+    uint32_t id;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+    unsigned char *map;
+    size_t mapped;          // bytes mapped; the active segment is mapped whole
+    size_t used;            // header plus entries written
+    uint64_t live;          // bytes of entries the index points at, and tombstones
+} Segment;
+
+// Empty when key[0] is NUL
+typedef struct {
+    uint64_t hash;
+    char key[SEGMENT_STORE_KEY_MAX];
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t length;        // whole entry
+} IndexSlot;
+
+typedef struct {
+    uint32_t checksum;
+    uint32_t valueLength;
+    uint8_t flags;
+    uint8_t keyLength;
+    const char *key;
+    const unsigned char *value;
+    size_t length;          // whole entry
+} Entry;
+
+struct SegmentStore {
+    char dir[200];
+    SegmentStoreOptions options;
+#ifdef _WIN32
+    HANDLE lockFile;
+#else
+    int lockFd;
+#endif
+    // Lock order: compactLock, appendLock, lock
+    pthread_rwlock_t lock;          // index, segment list, mappings and counters
+    pthread_mutex_t appendLock;     // one writer at a time appends to the active segment
+    pthread_mutex_t compactLock;    // one compaction pass at a time
+    IndexSlot *slots;
+    size_t slotCap, keys;
+    Segment *segments;              // ascending id; the last one is active
+    size_t segmentCount, segmentCap;
+    uint64_t liveBytes, deadBytes;
+    unsigned long compactions;
+    uint64_t bytesMoved;
+
+    pthread_t compactor;
+    int compactorRunning;
+    pthread_mutex_t wakeLock;
+    pthread_cond_t wake;
+    int stopRequested;
+};
+
+static void putU32(unsigned char *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i)); }
+static uint32_t getU32(const unsigned char *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t keyHash(const char *key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char*)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// FNV-1a, 32 bit, over the entry after its magic and checksum
+static uint32_t entryChecksum(const unsigned char *entry, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 8; i < length; i++) {
+        h ^= entry[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void segmentPath(char *out, size_t size, const char *dir, uint32_t id) {
+    snprintf(out, size, "%s/seg_%06u.log", dir, id);
+}
+
+// ---- platform: files and mappings ----
+
+#ifdef _WIN32
+static int openSegmentFile(Segment *s, const char *path, int create) {
+    s->mapping = NULL;
+    s->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                          create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    return s->file != INVALID_HANDLE_VALUE;
+}
+
+static long long segmentFileSize(Segment *s) {
+    LARGE_INTEGER size;
+    return GetFileSizeEx(s->file, &size) ? (long long)size.QuadPart : -1;
+}
+
+static int resizeSegmentFile(Segment *s, size_t size) {
+    LARGE_INTEGER at;
+    at.QuadPart = (LONGLONG)size;
+    return SetFilePointerEx(s->file, at, NULL, FILE_BEGIN) && SetEndOfFile(s->file);
+}
+
+static int mapSegment(Segment *s, size_t size, int writable) {
+    s->mapping = CreateFileMappingA(s->file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (!s->mapping) return 0;
+    s->map = (unsigned char*)MapViewOfFile(s->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if (!s->map) {
+        CloseHandle(s->mapping);
+        s->mapping = NULL;
+        return 0;
+    }
+    s->mapped = size;
+    return 1;
+}
+
+static void unmapSegment(Segment *s) {
+    if (s->map) UnmapViewOfFile(s->map);
+    if (s->mapping) CloseHandle(s->mapping);
+    s->map = NULL;
+    s->mapping = NULL;
+    s->mapped = 0;
+}
+
+static void syncSegment(Segment *s, size_t from, size_t to) {
+    FlushViewOfFile(s->map + from, to - from);
+    FlushFileBuffers(s->file);
+}
+
+static void closeSegmentFile(Segment *s) {
+    CloseHandle(s->file);
+    s->file = INVALID_HANDLE_VALUE;
+}
+#else
+static int openSegmentFile(Segment *s, const char *path, int create) {
+    s->fd = open(path, O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0600);
+    return s->fd >= 0;
+}
+
+static long long segmentFileSize(Segment *s) {
+    struct stat st;
+    return fstat(s->fd, &st) == 0 ? (long long)st.st_size : -1;
+}
+
+static int resizeSegmentFile(Segment *s, size_t size) {
+    return ftruncate(s->fd, (off_t)size) == 0;
+}
+
+static int mapSegment(Segment *s, size_t size, int writable) {
+    void *map = mmap(NULL, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, s->fd, 0);
+    if (map == MAP_FAILED) return 0;
+    s->map = (unsigned char*)map;
+    s->mapped = size;
+    return 1;
+}
+
+static void unmapSegment(Segment *s) {
+    if (s->map) munmap(s->map, s->mapped);
+    s->map = NULL;
+    s->mapped = 0;
+}
+
+static void syncSegment(Segment *s, size_t from, size_t to) {
+    long page = sysconf(_SC_PAGESIZE);
+    size_t start = page > 0 ? from - from % (size_t)page : 0;
+    msync(s->map + start, to - start, MS_SYNC);
+}
+
+static void closeSegmentFile(Segment *s) {
+    close(s->fd);
+    s->fd = -1;
+}
+#endif
+
+static int lockDirectory(SegmentStore *st) {
+    char path[260];
+    snprintf(path, sizeof(path), "%s/LOCK", st->dir);
+#ifdef _WIN32
+    st->lockFile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return st->lockFile != INVALID_HANDLE_VALUE;
+#else
+    st->lockFd = open(path, O_RDWR | O_CREAT, 0600);
+    if (st->lockFd < 0) return 0;
+    if (flock(st->lockFd, LOCK_EX | LOCK_NB) != 0) {
+        close(st->lockFd);
+        st->lockFd = -1;
+        return 0;
+    }
+    return 1;
+#endif
+}
+
+static void unlockDirectory(SegmentStore *st) {
+#ifdef _WIN32
+    if (st->lockFile != INVALID_HANDLE_VALUE) CloseHandle(st->lockFile);
+    st->lockFile = INVALID_HANDLE_VALUE;
+#else
+    if (st->lockFd >= 0) close(st->lockFd);
+    st->lockFd = -1;
+#endif
+}
+
+// ---- entries ----
+
+// Parses the entry at `offset`; 0 when it is missing, torn or corrupt
+static int parseEntry(const unsigned char *base, size_t limit, size_t offset, Entry *e) {
+    if (offset + ENTRY_HEADER_SIZE > limit) return 0;
+    const unsigned char *p = base + offset;
+    if (getU32(p) != ENTRY_MAGIC) return 0;
+    e->checksum = getU32(p + 4);
+    e->valueLength = getU32(p + 8);
+    e->flags = p[12];
+    e->keyLength = p[13];
+    if (e->keyLength == 0 || e->keyLength >= SEGMENT_STORE_KEY_MAX) return 0;
+    if (e->keyLength > limit - offset - ENTRY_HEADER_SIZE ||
+        e->valueLength > limit - offset - ENTRY_HEADER_SIZE - e->keyLength) {
+        return 0;
+    }
+    e->length = ENTRY_HEADER_SIZE + e->keyLength + (size_t)e->valueLength;
+    if (memchr(p + ENTRY_HEADER_SIZE, '\0', e->keyLength)) return 0;
+    if (entryChecksum(p, e->length) != e->checksum) return 0;
+    e->key = (const char*)p + ENTRY_HEADER_SIZE;
+    e->value = p + ENTRY_HEADER_SIZE + e->keyLength;
+    return 1;
+}
+
+static size_t writeEntry(unsigned char *p, const char *key, size_t keyLength, const void *value,
+                         size_t valueLength, uint8_t flags) {
+    size_t length = ENTRY_HEADER_SIZE + keyLength + valueLength;
+    putU32(p, ENTRY_MAGIC);
+    putU32(p + 8, (uint32_t)valueLength);
+    p[12] = flags;
+    p[13] = (unsigned char)keyLength;
+    p[14] = p[15] = 0;
+    memcpy(p + ENTRY_HEADER_SIZE, key, keyLength);
+    if (valueLength) memcpy(p + ENTRY_HEADER_SIZE + keyLength, value, valueLength);
+    putU32(p + 4, entryChecksum(p, length));
+    return length;
+}
+
+// ---- index ----
+
+static IndexSlot *findSlot(SegmentStore *st, const char *key, uint64_t hash) {
+    if (st->slotCap == 0) return NULL;
+    size_t mask = st->slotCap - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        IndexSlot *slot = &st->slots[i];
+        if (!slot->key[0]) return NULL;
+        if (slot->hash == hash && strcmp(slot->key, key) == 0) return slot;
+    }
+}
+
+static int growIndex(SegmentStore *st) {
+    size_t cap = st->slotCap ? st->slotCap * 2 : 1024;
+    IndexSlot *slots = calloc(cap, sizeof(IndexSlot));
+    if (!slots) return 0;
+    for (size_t i = 0; i < st->slotCap; i++) {
+        IndexSlot *old = &st->slots[i];
+        if (!old->key[0]) continue;
+        size_t j = (size_t)old->hash & (cap - 1);
+        while (slots[j].key[0]) j = (j + 1) & (cap - 1);
+        slots[j] = *old;
+    }
+    free(st->slots);
+    st->slots = slots;
+    st->slotCap = cap;
+    return 1;
+}
+
+// Existing slot for the key, or a fresh one; NULL when out of memory
+static IndexSlot *claimSlot(SegmentStore *st, const char *key, uint64_t hash) {
+    IndexSlot *slot = findSlot(st, key, hash);
+    if (slot) return slot;
+    if ((st->keys + 1) * 10 > st->slotCap * 7 && !growIndex(st)) return NULL;
+    size_t mask = st->slotCap - 1, i = (size_t)hash & mask;
+    while (st->slots[i].key[0]) i = (i + 1) & mask;
+    slot = &st->slots[i];
+    slot->hash = hash;
+    snprintf(slot->key, sizeof(slot->key), "%s", key);
+    slot->length = 0;
+    st->keys++;
+    return slot;
+}
+
+// Backward-shift deletion keeps probe runs unbroken without tombstones
+static void removeSlot(SegmentStore *st, IndexSlot *slot) {
+    size_t mask = st->slotCap - 1;
+    size_t hole = (size_t)(slot - st->slots);
+    for (size_t i = (hole + 1) & mask; st->slots[i].key[0]; i = (i + 1) & mask) {
+        size_t home = (size_t)st->slots[i].hash & mask;
+        // Move it back unless its home lies cyclically in (hole, i]
+        int stays = hole <= i ? (home > hole && home <= i) : (home > hole || home <= i);
+        if (stays) continue;
+        st->slots[hole] = st->slots[i];
+        hole = i;
+    }
+    memset(&st->slots[hole], 0, sizeof(IndexSlot));
+    st->keys--;
+}
+
+static Segment *findSegment(SegmentStore *st, uint32_t id) {
+    size_t lo = 0, hi = st->segmentCount;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (st->segments[mid].id == id) return &st->segments[mid];
+        if (st->segments[mid].id < id) lo = mid + 1;
+        else hi = mid;
+    }
+    return NULL;
+}
+
+// The entry the slot pointed at is dead now
+static void retire(SegmentStore *st, const IndexSlot *slot) {
+    if (slot->length == 0) return;
+    Segment *old = findSegment(st, slot->segment);
+    if (old) old->live -= slot->length;
+    st->liveBytes -= slot->length;
+    st->deadBytes += slot->length;
+}
+
+// Caller holds the write lock. A put points the index at the entry, a
+// tombstone drops the key; tombstones stay live until compacted away.
+static int applyEntry(SegmentStore *st, Segment *seg, const Entry *e, uint32_t offset) {
+    char key[SEGMENT_STORE_KEY_MAX];
+    memcpy(key, e->key, e->keyLength);
+    key[e->keyLength] = '\0';
+    uint64_t hash = keyHash(key);
+    if (e->flags & ENTRY_TOMBSTONE) {
+        IndexSlot *slot = findSlot(st, key, hash);
+        if (slot) {
+            retire(st, slot);
+            removeSlot(st, slot);
+        }
+        seg->live += e->length;
+        st->liveBytes += e->length;
+        return 1;
+    }
+    IndexSlot *slot = claimSlot(st, key, hash);
+    if (!slot) return 0;
+    retire(st, slot);
+    seg->live += e->length;
+    st->liveBytes += e->length;
+    slot->segment = seg->id;
+    slot->offset = offset;
+    slot->length = (uint32_t)e->length;
+    return 1;
+}
+
+// ---- segments ----
+
+static Segment *addSegment(SegmentStore *st) {
+    if (st->segmentCount == st->segmentCap) {
+        size_t cap = st->segmentCap ? st->segmentCap * 2 : 8;
+        Segment *grown = realloc(st->segments, cap * sizeof(Segment));
+        if (!grown) return NULL;
+        st->segments = grown;
+        st->segmentCap = cap;
+    }
+    Segment *s = &st->segments[st->segmentCount];
+    memset(s, 0, sizeof(*s));
+    return s;
+}
+
+// A new active segment, mapped whole; caller holds the write lock
+static ErrorCode createSegment(SegmentStore *st, uint32_t id) {
+    Segment *s = addSegment(st);
+    if (!s) return ERROR_MEMORY;
+    s->id = id;
+    char path[260];
+    segmentPath(path, sizeof(path), st->dir, id);
+    if (!openSegmentFile(s, path, 1)) return ERROR_FILE_IO;
+    if (!resizeSegmentFile(s, st->options.segmentBytes) || !mapSegment(s, st->options.segmentBytes, 1)) {
+        closeSegmentFile(s);
+        remove(path);
+        return ERROR_FILE_IO;
+    }
+    memcpy(s->map, SEG_MAGIC, 8);
+    putU32(s->map + 8, SEG_VERSION);
+    putU32(s->map + 12, id);
+    s->used = SEG_HEADER_SIZE;
+    st->segmentCount++;
+    return SUCCESS;
+}
+
+// Maps the active segment read-only and trims it to its entries; caller
+// holds the write lock. If the new mapping fails the old one stays.
+static void sealSegment(SegmentStore *st, Segment *s) {
+    if (st->options.syncWrites) syncSegment(s, 0, s->used);
+    Segment sealed = *s;
+    if (!mapSegment(&sealed, s->used, 0)) return;
+    unmapSegment(s);
+    *s = sealed;
+    resizeSegmentFile(s, s->used);
+}
+
+static void dropSegment(SegmentStore *st, Segment *s) {
+    char path[260];
+    segmentPath(path, sizeof(path), st->dir, s->id);
+    unmapSegment(s);
+    closeSegmentFile(s);
+    remove(path);
+    size_t at = (size_t)(s - st->segments);
+    memmove(s, s + 1, (st->segmentCount - at - 1) * sizeof(Segment));
+    st->segmentCount--;
+}
+
+// Sorted ids of the segment files in dir
+static uint32_t *listSegments(const char *dir, size_t *count) {
+    *count = 0;
+    DIR *d = opendir(dir);
+    if (!d) return NULL;
+    size_t cap = 16;
+    uint32_t *ids = malloc(cap * sizeof(uint32_t));
+    struct dirent *ent;
+    while (ids && (ent = readdir(d)) != NULL) {
+        unsigned int id = 0;
+        char ext[8] = {0};
+        if (sscanf(ent->d_name, "seg_%6u.%3s", &id, ext) != 2 || strcmp(ext, "log") != 0) continue;
+        if (*count == cap) {
+            cap *= 2;
+            uint32_t *grown = realloc(ids, cap * sizeof(uint32_t));
+            if (!grown) break;
+            ids = grown;
+        }
+        ids[(*count)++] = id;
+    }
+    closedir(d);
+    for (size_t i = 1; i < *count; i++) {
+        uint32_t v = ids[i];
+        size_t j = i;
+        while (j > 0 && ids[j - 1] > v) { ids[j] = ids[j - 1]; j--; }
+        ids[j] = v;
+    }
+    return ids;
+}
+
+// Maps one existing segment and replays it into the index; the last one
+// becomes the active segment, with anything past its valid entries cleared
+static ErrorCode recoverSegment(SegmentStore *st, uint32_t id, int active) {
+    Segment *s = addSegment(st);
+    if (!s) return ERROR_MEMORY;
+    s->id = id;
+    char path[260];
+    segmentPath(path, sizeof(path), st->dir, id);
+    if (!openSegmentFile(s, path, 0)) return ERROR_FILE_IO;
+    long long size = segmentFileSize(s);
+    size_t mapSize = size > 0 ? (size_t)size : 0;
+    if (active && mapSize < st->options.segmentBytes) {
+        mapSize = st->options.segmentBytes;
+        if (!resizeSegmentFile(s, mapSize)) {
+            closeSegmentFile(s);
+            return ERROR_FILE_IO;
+        }
+    }
+    if (mapSize < SEG_HEADER_SIZE || !mapSegment(s, mapSize, active)) {
+        closeSegmentFile(s);
+        return ERROR_FILE_IO;
+    }
+    if (memcmp(s->map, SEG_MAGIC, 8) != 0 || getU32(s->map + 8) != SEG_VERSION) {
+        unmapSegment(s);
+        closeSegmentFile(s);
+        return ERROR_FILE_IO;
+    }
+
+    // Counted before the replay so superseded entries within it are retired
+    st->segmentCount++;
+    size_t limit = size > 0 ? (size_t)size : 0, offset = SEG_HEADER_SIZE;
+    Entry e;
+    while (parseEntry(s->map, limit, offset, &e)) {
+        if (!applyEntry(st, s, &e, (uint32_t)offset)) return ERROR_MEMORY;
+        offset += e.length;
+    }
+    s->used = offset;
+    if (active && limit > offset) {
+        memset(s->map + offset, 0, limit - offset);     // torn tail
+    }
+    st->deadBytes += s->used - SEG_HEADER_SIZE - s->live;
+    return SUCCESS;
+}
+
+// ---- writes ----
+
+static int overGarbage(const SegmentStore *st, const Segment *s) {
+    size_t entries = s->used - SEG_HEADER_SIZE;
+    return entries > 0 && (double)(entries - s->live) >= st->options.compactGarbage * (double)entries;
+}
+
+static void wakeCompactor(SegmentStore *st) {
+    if (!st->compactorRunning) return;
+    pthread_mutex_lock(&st->wakeLock);
+    pthread_cond_signal(&st->wake);
+    pthread_mutex_unlock(&st->wakeLock);
+}
+
+// Appends and applies one entry. Caller holds appendLock, which is what lets
+// the bytes be copied into the active mapping without the index lock: readers
+// only follow the index, and only appendLock holders change the segment list.
+static ErrorCode appendEntry(SegmentStore *st, const char *key, size_t keyLength, const void *value,
+                             size_t valueLength, uint8_t flags, int *sealedGarbage) {
+    size_t length = ENTRY_HEADER_SIZE + keyLength + valueLength;
+    if (length > st->options.segmentBytes - SEG_HEADER_SIZE) return ERROR_INVALID_INPUT;
+
+    Segment *active = &st->segments[st->segmentCount - 1];
+    if (active->used + length > active->mapped) {
+        pthread_rwlock_wrlock(&st->lock);
+        sealSegment(st, active);
+        ErrorCode rc = createSegment(st, active->id + 1);
+        pthread_rwlock_unlock(&st->lock);
+        if (rc != SUCCESS) return rc;
+        active = &st->segments[st->segmentCount - 1];
+    }
+
+    size_t offset = active->used;
+    writeEntry(active->map + offset, key, keyLength, value, valueLength, flags);
+    if (st->options.syncWrites) syncSegment(active, offset, offset + length);
+
+    Entry e;
+    e.flags = flags;
+    e.keyLength = (uint8_t)keyLength;
+    e.key = (const char*)active->map + offset + ENTRY_HEADER_SIZE;
+    e.length = length;
+    pthread_rwlock_wrlock(&st->lock);
+    char name[SEGMENT_STORE_KEY_MAX];
+    memcpy(name, key, keyLength);
+    name[keyLength] = '\0';
+    IndexSlot *old = findSlot(st, name, keyHash(name));
+    Segment *oldSegment = old && old->length ? findSegment(st, old->segment) : NULL;
+    int ok = applyEntry(st, active, &e, (uint32_t)offset);
+    if (ok) active->used += length;
+    int garbage = oldSegment && oldSegment != active && overGarbage(st, oldSegment);
+    pthread_rwlock_unlock(&st->lock);
+    if (!ok) return ERROR_MEMORY;
+    if (sealedGarbage) *sealedGarbage = garbage;
+    return SUCCESS;
+}
+
+static ErrorCode writeKey(SegmentStore *st, const char *key, const void *value, size_t length, uint8_t flags) {
+    size_t keyLength = key ? strlen(key) : 0;
+    if (!st || keyLength == 0 || keyLength >= SEGMENT_STORE_KEY_MAX || (length && !value)) return ERROR_INVALID_INPUT;
+    int garbage = 0;
+    pthread_mutex_lock(&st->appendLock);
+    ErrorCode rc = appendEntry(st, key, keyLength, value, length, flags, &garbage);
+    pthread_mutex_unlock(&st->appendLock);
+    if (garbage) wakeCompactor(st);
+    return rc;
+}
+
+ErrorCode segmentStorePut(SegmentStore *store, const char *key, const void *value, size_t length) {
+    return writeKey(store, key, value, length, 0);
+}
+
+ErrorCode segmentStoreDelete(SegmentStore *store, const char *key) {
+    if (!store || !key) return ERROR_INVALID_INPUT;
+    pthread_rwlock_rdlock(&store->lock);
+    int present = findSlot(store, key, keyHash(key)) != NULL;
+    pthread_rwlock_unlock(&store->lock);
+    if (!present) return ERROR_NOT_FOUND;
+    return writeKey(store, key, NULL, 0, ENTRY_TOMBSTONE);
+}
+
+// ---- reads ----
+
+ErrorCode segmentStoreRead(SegmentStore *store, const char *key, SegmentValueVisitor visit, void *ctx) {
+    if (!store || !key || !visit) return ERROR_INVALID_INPUT;
+    pthread_rwlock_rdlock(&store->lock);
+    IndexSlot *slot = findSlot(store, key, keyHash(key));
+    Segment *s = slot ? findSegment(store, slot->segment) : NULL;
+    if (!s) {
+        pthread_rwlock_unlock(&store->lock);
+        return ERROR_NOT_FOUND;
+    }
+    size_t keyLength = strlen(slot->key);
+    size_t valueLength = slot->length - ENTRY_HEADER_SIZE - keyLength;
+    visit(s->map + slot->offset + ENTRY_HEADER_SIZE + keyLength, valueLength, ctx);
+    pthread_rwlock_unlock(&store->lock);
+    return SUCCESS;
+}
+
+ErrorCode segmentStoreScan(SegmentStore *store, SegmentEntryVisitor visit, void *ctx) {
+    if (!store || !visit) return ERROR_INVALID_INPUT;
+    pthread_rwlock_rdlock(&store->lock);
+    for (size_t i = 0; i < store->slotCap; i++) {
+        const IndexSlot *slot = &store->slots[i];
+        Segment *s = slot->key[0] ? findSegment(store, slot->segment) : NULL;
+        if (!s) continue;
+        size_t keyLength = strlen(slot->key);
+        if (!visit(slot->key, s->map + slot->offset + ENTRY_HEADER_SIZE + keyLength,
+                   slot->length - ENTRY_HEADER_SIZE - keyLength, ctx)) {
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&store->lock);
+    return SUCCESS;
+}
+
+typedef struct {
+    void *out;
+    size_t capacity;
+    size_t length;
+} CopyOut;
+
+static void copyValue(const void *value, size_t length, void *ctx) {
+    CopyOut *copy = (CopyOut*)ctx;
+    copy->length = length;
+    if (length <= copy->capacity && length) memcpy(copy->out, value, length);
+}
+
+ErrorCode segmentStoreGet(SegmentStore *store, const char *key, void *out, size_t capacity, size_t *length) {
+    if (!out && capacity) return ERROR_INVALID_INPUT;
+    CopyOut copy = { out, capacity, 0 };
+    ErrorCode rc = segmentStoreRead(store, key, copyValue, &copy);
+    if (rc != SUCCESS) return rc;
+    if (length) *length = copy.length;
+    return copy.length <= capacity ? SUCCESS : ERROR_MEMORY;
+}
+
+void segmentStoreGetStats(SegmentStore *store, SegmentStoreStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!store) return;
+    pthread_rwlock_rdlock(&store->lock);
+    stats->keys = store->keys;
+    stats->segments = store->segmentCount;
+    stats->liveBytes = store->liveBytes;
+    stats->deadBytes = store->deadBytes;
+    stats->compactions = store->compactions;
+    stats->bytesMoved = store->bytesMoved;
+    pthread_rwlock_unlock(&store->lock);
+}
+
+// ---- compaction ----
+
+// Oldest sealed segment over the garbage threshold; 0 when there is none
+static uint32_t compactionCandidate(SegmentStore *st) {
+    uint32_t id = 0;
+    pthread_rwlock_rdlock(&st->lock);
+    for (size_t i = 0; i + 1 < st->segmentCount && !id; i++) {
+        if (overGarbage(st, &st->segments[i])) id = st->segments[i].id;
+    }
+    pthread_rwlock_unlock(&st->lock);
+    return id;
+}
+
+// Copies the segment's live entries to the active segment, then deletes it.
+// Only compaction removes or remaps a sealed segment, so its mapping stays
+// put while the entries are walked. A tombstone is carried forward only while
+// an older segment could still hold the key it deleted.
+static void compactSegment(SegmentStore *st, uint32_t id) {
+    pthread_rwlock_rdlock(&st->lock);
+    Segment *s = findSegment(st, id);
+    const unsigned char *map = s ? s->map : NULL;
+    size_t used = s ? s->used : 0;
+    pthread_rwlock_unlock(&st->lock);
+    if (!map) return;
+
+    size_t offset = SEG_HEADER_SIZE;
+    Entry e;
+    while (parseEntry(map, used, offset, &e)) {
+        char key[SEGMENT_STORE_KEY_MAX];
+        memcpy(key, e.key, e.keyLength);
+        key[e.keyLength] = '\0';
+
+        pthread_mutex_lock(&st->appendLock);
+        pthread_rwlock_rdlock(&st->lock);
+        IndexSlot *slot = findSlot(st, key, keyHash(key));
+        int keep;
+        if (e.flags & ENTRY_TOMBSTONE) {
+            keep = !slot && st->segments[0].id < id;
+        } else {
+            keep = slot && slot->segment == id && slot->offset == offset;
+        }
+        pthread_rwlock_unlock(&st->lock);
+        if (keep && appendEntry(st, e.key, e.keyLength, e.value, e.valueLength, e.flags, NULL) == SUCCESS) {
+            pthread_rwlock_wrlock(&st->lock);
+            st->bytesMoved += e.length;
+            pthread_rwlock_unlock(&st->lock);
+        }
+        pthread_mutex_unlock(&st->appendLock);
+        offset += e.length;
+    }
+
+    pthread_mutex_lock(&st->appendLock);
+    pthread_rwlock_wrlock(&st->lock);
+    s = findSegment(st, id);
+    if (s) {
+        // Entries that stayed live here (a failed copy) keep the segment
+        int pinned = 0;
+        for (size_t i = 0; i < st->slotCap && !pinned; i++) {
+            pinned = st->slots[i].key[0] && st->slots[i].segment == id;
+        }
+        if (!pinned) {
+            st->liveBytes -= s->live;                               // tombstones dropped here
+            st->deadBytes -= s->used - SEG_HEADER_SIZE - s->live;
+            dropSegment(st, s);
+            st->compactions++;
+        }
+    }
+    pthread_rwlock_unlock(&st->lock);
+    pthread_mutex_unlock(&st->appendLock);
+}
+
+ErrorCode segmentStoreCompact(SegmentStore *store) {
+    if (!store) return ERROR_INVALID_INPUT;
+    pthread_mutex_lock(&store->compactLock);
+    uint32_t id, last = 0;
+    while ((id = compactionCandidate(store)) != 0 && id != last) {
+        compactSegment(store, id);
+        last = id;              // a segment that could not be dropped is not retried in this pass
+    }
+    pthread_mutex_unlock(&store->compactLock);
+    return SUCCESS;
+}
+
+static void *compactorMain(void *arg) {
+    SegmentStore *st = (SegmentStore*)arg;
+    pthread_mutex_lock(&st->wakeLock);
+    while (!st->stopRequested) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += COMPACT_TICK_MILLIS / 1000;
+        pthread_cond_timedwait(&st->wake, &st->wakeLock, &until);
+        if (st->stopRequested) break;
+        pthread_mutex_unlock(&st->wakeLock);
+        if (compactionCandidate(st)) segmentStoreCompact(st);
+        pthread_mutex_lock(&st->wakeLock);
+    }
+    pthread_mutex_unlock(&st->wakeLock);
+    return NULL;
+}
+
+// ---- open / close ----
+
+SegmentStoreOptions segmentStoreDefaultOptions(void) {
+    SegmentStoreOptions options;
+    options.segmentBytes = SEGMENT_STORE_SEGMENT_BYTES;
+    options.compactGarbage = DEFAULT_GARBAGE;
+    options.background = 1;
+    options.syncWrites = 0;
+    return options;
+}
+
+static void releaseStore(SegmentStore *st) {
+    for (size_t i = 0; i < st->segmentCount; i++) {
+        Segment *s = &st->segments[i];
+        if (st->options.syncWrites && s->map) syncSegment(s, 0, s->used);
+        unmapSegment(s);
+        if (i + 1 == st->segmentCount) resizeSegmentFile(s, s->used);     // drop the unused tail
+        closeSegmentFile(s);
+    }
+    unlockDirectory(st);
+    pthread_rwlock_destroy(&st->lock);
+    pthread_mutex_destroy(&st->appendLock);
+    pthread_mutex_destroy(&st->compactLock);
+    pthread_mutex_destroy(&st->wakeLock);
+    pthread_cond_destroy(&st->wake);
+    free(st->segments);
+    free(st->slots);
+    free(st);
+}
+
+ErrorCode segmentStoreOpen(const char *dir, const SegmentStoreOptions *options, SegmentStore **store) {
+    if (!store) return ERROR_INVALID_INPUT;
+    *store = NULL;
+    SegmentStore *st = calloc(1, sizeof(SegmentStore));
+    if (!st) return ERROR_MEMORY;
+    st->options = options ? *options : segmentStoreDefaultOptions();
+    if (st->options.segmentBytes == 0) st->options.segmentBytes = SEGMENT_STORE_SEGMENT_BYTES;
+    if (st->options.segmentBytes < 4096) st->options.segmentBytes = 4096;
+    if (st->options.segmentBytes > UINT32_MAX) st->options.segmentBytes = UINT32_MAX;
+    if (st->options.compactGarbage <= 0.0 || st->options.compactGarbage > 1.0) st->options.compactGarbage = DEFAULT_GARBAGE;
+    snprintf(st->dir, sizeof(st->dir), "%s", dir ? dir : SEGMENT_STORE_DIR);
+    size_t len = strlen(st->dir);
+    if (len > 1 && st->dir[len - 1] == '/') st->dir[len - 1] = '\0';
+#ifdef _WIN32
+    st->lockFile = INVALID_HANDLE_VALUE;
+    _mkdir(DATA_DIR);
+    _mkdir(st->dir);
+#else
+    st->lockFd = -1;
+    mkdir(DATA_DIR, 0700);
+    mkdir(st->dir, 0700);
+#endif
+    pthread_rwlock_init(&st->lock, NULL);
+    pthread_mutex_init(&st->appendLock, NULL);
+    pthread_mutex_init(&st->compactLock, NULL);
+    pthread_mutex_init(&st->wakeLock, NULL);
+    pthread_cond_init(&st->wake, NULL);
+
+    if (!lockDirectory(st)) {
+        releaseStore(st);
+        return ERROR_FILE_IO;
+    }
+    size_t count = 0;
+    uint32_t *ids = listSegments(st->dir, &count);
+    ErrorCode rc = SUCCESS;
+    for (size_t i = 0; i < count && rc == SUCCESS; i++) {
+        rc = recoverSegment(st, ids[i], i + 1 == count);
+        if (rc == ERROR_FILE_IO) {
+            fprintf(stderr, "Segment store: segment %u is unreadable; skipped\n", ids[i]);
+            rc = SUCCESS;
+        }
+    }
+    uint32_t next = count ? ids[count - 1] + 1 : 1;
+    free(ids);
+    // No segments yet, or the last one was unreadable: start a fresh one
+    if (rc == SUCCESS && (st->segmentCount == 0 || st->segments[st->segmentCount - 1].id != next - 1)) {
+        rc = createSegment(st, next);
+    }
+    if (rc != SUCCESS) {
+        releaseStore(st);
+        return rc;
+    }
+
+    if (st->options.background) {
+        st->compactorRunning = pthread_create(&st->compactor, NULL, compactorMain, st) == 0;
+    }
+    *store = st;
+    return SUCCESS;
+}
+
+void segmentStoreClose(SegmentStore *store) {
+    if (!store) return;
+    if (store->compactorRunning) {
+        pthread_mutex_lock(&store->wakeLock);
+        store->stopRequested = 1;
+        pthread_cond_signal(&store->wake);
+        pthread_mutex_unlock(&store->wakeLock);
+        pthread_join(store->compactor, NULL);
+        store->compactorRunning = 0;
+    }
+    releaseStore(store);
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "../include/shared_state.h"
+
+void *sharedAlloc(size_t bytes) {
+#ifdef _WIN32
+    return calloc(1, bytes);
+#else
+    // Anonymous pages are zero-filled and only backed once touched
+    void *mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return mem == MAP_FAILED ? NULL : mem;
+#endif
+}
+
+int sharedMutexInit(pthread_mutex_t *mutex) {
+#ifdef _WIN32
+    return pthread_mutex_init(mutex, NULL) == 0;
+#else
+    pthread_mutexattr_t attr;
+    if (pthread_mutexattr_init(&attr) != 0) return 0;
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    int ok = pthread_mutex_init(mutex, &attr) == 0;
+    pthread_mutexattr_destroy(&attr);
+    return ok;
+#endif
+}
+
+int sharedMutexLock(pthread_mutex_t *mutex) {
+    int rc = pthread_mutex_lock(mutex);
+#ifndef _WIN32
+    if (rc == EOWNERDEAD) {
+        // A worker process died inside the critical section
+        pthread_mutex_consistent(mutex);
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+void sharedMutexUnlock(pthread_mutex_t *mutex) {
+    pthread_mutex_unlock(mutex);
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/shared_table.h"
+
+#define SHARD_ALIGN 64      // shards start on their own cache line
+
+struct SharedShard {
+    pthread_mutex_t lock;
+    int count;
+};
+
+static size_t headerBytes(void) {
+    return (sizeof(struct SharedShard) + SHARD_ALIGN - 1) / SHARD_ALIGN * SHARD_ALIGN;
+}
+
+static size_t shardBytes(const SharedTable *t) {
+    size_t bytes = headerBytes() + (size_t)t->slots * t->recordSize;
+    return (bytes + SHARD_ALIGN - 1) / SHARD_ALIGN * SHARD_ALIGN;
+}
+
+static unsigned char *slotAt(const SharedTable *t, SharedShard *shard, uint32_t i) {
+    return (unsigned char*)shard + headerBytes() + (size_t)i * t->recordSize;
+}
+
+static const char *keyOf(const SharedTable *t, const unsigned char *record) {
+    return (const char*)record + t->keyOffset;
+}
+
+static uint32_t homeSlot(const SharedTable *t, uint32_t hash) {
+    return (hash / t->shards) & (t->slots - 1);
+}
+
+int sharedTableInit(SharedTable *t) {
+    if (atomic_load_explicit(&t->memory, memory_order_acquire)) return 1;
+    pthread_mutex_lock(&t->mapLock);
+    unsigned char *memory = atomic_load_explicit(&t->memory, memory_order_relaxed);
+    if (!memory) {
+        memory = (unsigned char*)sharedAlloc((size_t)t->shards * shardBytes(t));
+        if (memory) {
+            for (uint32_t s = 0; s < t->shards; s++) {
+                sharedMutexInit(&((SharedShard*)(memory + s * shardBytes(t)))->lock);
+            }
+            atomic_store_explicit(&t->memory, memory, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&t->mapLock);
+    return memory != NULL;
+}
+
+uint32_t sharedTableHash(const char *key) {
+    uint32_t h = 2166136261u;
+    for (const char *p = key; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    return h;
+}
+
+SharedShard *sharedTableLock(SharedTable *t, uint32_t hash) {
+    if (!sharedTableInit(t)) return NULL;
+    unsigned char *memory = atomic_load_explicit(&t->memory, memory_order_acquire);
+    SharedShard *shard = (SharedShard*)(memory + (hash % t->shards) * shardBytes(t));
+    if (sharedMutexLock(&shard->lock)) {
+        // The owner died mid-update; drop the shard rather than trust it
+        memset(slotAt(t, shard, 0), 0, (size_t)t->slots * t->recordSize);
+        shard->count = 0;
+    }
+    return shard;
+}
+
+void sharedTableUnlock(SharedShard *shard) {
+    sharedMutexUnlock(&shard->lock);
+}
+
+void *sharedTableFind(const SharedTable *t, SharedShard *shard, const char *key, uint32_t hash) {
+    for (uint32_t i = homeSlot(t, hash), n = 0; n < t->slots; i = (i + 1) & (t->slots - 1), n++) {
+        unsigned char *record = slotAt(t, shard, i);
+        if (!keyOf(t, record)[0]) return NULL;
+        if (strcmp(keyOf(t, record), key) == 0) return record;
+    }
+    return NULL;
+}
+
+static void removeAt(const SharedTable *t, SharedShard *shard, uint32_t i) {
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & (t->slots - 1);
+        unsigned char *next = slotAt(t, shard, j);
+        if (!keyOf(t, next)[0]) break;
+        uint32_t home = homeSlot(t, sharedTableHash(keyOf(t, next)));
+        int between = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!between) {
+            memcpy(slotAt(t, shard, i), next, t->recordSize);
+            i = j;
+        }
+    }
+    memset(slotAt(t, shard, i), 0, t->recordSize);
+    shard->count--;
+}
+
+void sharedTableRemove(const SharedTable *t, SharedShard *shard, void *record) {
+    size_t offset = (size_t)((unsigned char*)record - slotAt(t, shard, 0));
+    removeAt(t, shard, (uint32_t)(offset / t->recordSize));
+}
+
+static int sweepShard(const SharedTable *t, SharedShard *shard, time_t now) {
+    int removed = 0;
+    if (!t->expired) return 0;
+    for (uint32_t i = 0; i < t->slots; i++) {
+        // removeAt may shift a later entry into i, so re-check the same index
+        while (keyOf(t, slotAt(t, shard, i))[0] && t->expired(slotAt(t, shard, i), now)) {
+            removeAt(t, shard, i);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+int sharedTableInsert(const SharedTable *t, SharedShard *shard, const void *record, uint32_t hash) {
+    const char *key = keyOf(t, (const unsigned char*)record);
+    // Keep the load factor under 7/8 so probes stay short
+    uint32_t limit = t->slots / 8 * 7;
+    if ((uint32_t)shard->count >= limit) sweepShard(t, shard, time(NULL));
+    if ((uint32_t)shard->count >= limit || !key[0] || sharedTableFind(t, shard, key, hash)) return 0;
+    uint32_t i = homeSlot(t, hash);
+    while (keyOf(t, slotAt(t, shard, i))[0]) i = (i + 1) & (t->slots - 1);
+    memcpy(slotAt(t, shard, i), record, t->recordSize);
+    shard->count++;
+    return 1;
+}
+
+int sharedTableCount(SharedTable *t) {
+    int total = 0;
+    for (uint32_t s = 0; s < t->shards; s++) {
+        SharedShard *shard = sharedTableLock(t, s);
+        if (!shard) return total;
+        total += shard->count;
+        sharedTableUnlock(shard);
+    }
+    return total;
+}
+
+int sharedTableSweep(SharedTable *t, time_t now) {
+    int removed = 0;
+    for (uint32_t s = 0; s < t->shards; s++) {
+        SharedShard *shard = sharedTableLock(t, s);
+        if (!shard) return removed;
+        removed += sweepShard(t, shard, now);
+        sharedTableUnlock(shard);
+    }
+    return removed;
+}
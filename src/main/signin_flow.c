@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../include/signin_flow.h"
+#include "../include/auth.h"
+#include "../include/database.h"
+#include "../include/shared_table.h"
+
+void signinFlowInit(SigninFlow *flow) {
+    memset(flow, 0, sizeof(*flow));
+    flow->state = SIGNIN_AWAIT_CREDENTIALS;
+}
+
+int signinFlowExpired(const SigninFlow *flow, time_t now) {
+    return flow->state == SIGNIN_AWAIT_OTP && now > flow->expiresAt;
+}
+
+// Generate an OTP and push it out on every channel; ERROR_NETWORK if none worked
+static ErrorCode issueOTP(SigninFlow *flow) {
+    char otp[7];
+    if (!generateOTP(flow->userID, otp)) return ERROR_GENERAL;
+    flow->channels = 0;
+    if (sendOTPSMS(flow->mobile, otp)) flow->channels |= SIGNIN_CHANNEL_SMS;
+    if (sendOTPEmail(flow->email, otp)) flow->channels |= SIGNIN_CHANNEL_EMAIL;
+    memset(otp, 0, sizeof(otp));
+    if (!flow->channels) return ERROR_NETWORK;
+    flow->expiresAt = time(NULL) + SIGNIN_OTP_SECONDS;
+    return SUCCESS;
+}
+
+ErrorCode signinFlowCredentials(SigninFlow *flow, const char *userID, const char *mobile, const char *password) {
+    if (flow->state != SIGNIN_AWAIT_CREDENTIALS) return ERROR_INVALID_INPUT;
+    if (!userID || !mobile || !password || !*userID) return ERROR_INVALID_INPUT;
+    if (isAccountLocked(userID)) return ERROR_PERMISSION;
+
+    Profile p;
+    if (!getUserByID(userID, &p)) return ERROR_NOT_FOUND;
+
+    char hashed[MAX_LEN];
+    hashPassword(password, hashed);
+    if (!authenticateUser(userID, mobile, hashed)) {
+        // authenticateUser already counted the failure in login_attempts
+        flow->credentialFailures++;
+        if (flow->credentialFailures >= SIGNIN_MAX_CREDENTIAL_FAILURES ||
+            getLoginAttempts(userID) >= SIGNIN_MAX_CREDENTIAL_FAILURES) {
+            lockAccount(userID, SIGNIN_LOCK_MINUTES);
+            resetLoginAttempts(userID);
+            flow->state = SIGNIN_FAILED;
+        }
+        return ERROR_AUTH_FAILED;
+    }
+
+    snprintf(flow->userID, sizeof(flow->userID), "%s", p.userID);
+    snprintf(flow->mobile, sizeof(flow->mobile), "%s", mobile);
+    snprintf(flow->email, sizeof(flow->email), "%s", p.email);
+    ErrorCode rc = issueOTP(flow);
+    if (rc != SUCCESS) {
+        flow->state = SIGNIN_FAILED;
+        return rc;
+    }
+    flow->state = SIGNIN_AWAIT_OTP;
+    return SUCCESS;
+}
+
+ErrorCode signinFlowVerify(SigninFlow *flow, const char *otp, Session *session) {
+    if (flow->state != SIGNIN_AWAIT_OTP) return ERROR_INVALID_INPUT;
+    if (signinFlowExpired(flow, time(NULL))) {
+        flow->state = SIGNIN_FAILED;
+        return ERROR_AUTH_FAILED;
+    }
+    if (!otp || !verifyOTP(flow->userID, otp)) {
+        if (++flow->otpFailures >= SIGNIN_MAX_OTP_FAILURES) flow->state = SIGNIN_FAILED;
+        return ERROR_AUTH_FAILED;
+    }
+    if (!createSession(flow->userID, AUTH_LEVEL_BASIC, session)) {
+        flow->state = SIGNIN_FAILED;
+        return ERROR_GENERAL;
+    }
+    flow->state = SIGNIN_DONE;
+    return SUCCESS;
+}
+
+ErrorCode signinFlowResend(SigninFlow *flow) {
+    if (flow->state != SIGNIN_AWAIT_OTP) return ERROR_INVALID_INPUT;
+    if (flow->resends >= SIGNIN_MAX_RESENDS) return ERROR_PERMISSION;
+    flow->resends++;
+    // otpFailures carries over: a new code is not a new set of guesses
+    ErrorCode rc = issueOTP(flow);
+    if (rc != SUCCESS) flow->state = SIGNIN_FAILED;
+    return rc;
+}
+
+// ---- Pending-login table ----
+
+static int flowExpired(const void *record, time_t now) {
+    return signinFlowExpired((const SigninFlow*)record, now);
+}
+
+// In shared memory so prefork workers see each other's flows
+static SharedTable pending = SHARED_TABLE_INIT(SigninFlow, ticket, SIGNIN_TABLE_SHARDS, SIGNIN_SHARD_SLOTS,
+                                               flowExpired);
+
+int signinTableInit(void) {
+    return sharedTableInit(&pending);
+}
+
+static ErrorCode parkFlow(SigninFlow *flow) {
+    for (int tries = 0; tries < 4; tries++) {
+        if (!generateRandomToken(flow->ticket, sizeof(flow->ticket))) return ERROR_GENERAL;
+        uint32_t hash = sharedTableHash(flow->ticket);
+        SharedShard *shard = sharedTableLock(&pending, hash);
+        if (!shard) return ERROR_MEMORY;
+        int stored = sharedTableInsert(&pending, shard, flow, hash);
+        sharedTableUnlock(shard);
+        if (stored) return SUCCESS;
+        // Full, or the ticket is taken: another shard may have room
+    }
+    return ERROR_GENERAL;
+}
+
+ErrorCode signinBegin(const char *userID, const char *mobile, const char *password,
+                      char ticket[SIGNIN_TICKET_LEN + 1], int *channels) {
+    SigninFlow flow;
+    signinFlowInit(&flow);
+    // Credential checks and OTP delivery run before any table lock is taken
+    ErrorCode rc = signinFlowCredentials(&flow, userID, mobile, password);
+    if (rc != SUCCESS) return rc;
+    rc = parkFlow(&flow);
+    if (rc != SUCCESS) return rc;
+    memcpy(ticket, flow.ticket, SIGNIN_TICKET_LEN + 1);
+    if (channels) *channels = flow.channels;
+    return SUCCESS;
+}
+
+// Moves a parked flow out of the table for one step; the slot is released
+// so no lock is held across database work or OTP delivery.
+static ErrorCode takeFlow(const char *ticket, SigninFlow *flow) {
+    if (!ticket || strlen(ticket) != SIGNIN_TICKET_LEN) return ERROR_NOT_FOUND;
+    uint32_t hash = sharedTableHash(ticket);
+    SharedShard *shard = sharedTableLock(&pending, hash);
+    if (!shard) return ERROR_NOT_FOUND;
+    SigninFlow *parked = (SigninFlow*)sharedTableFind(&pending, shard, ticket, hash);
+    int found = parked != NULL;
+    if (found) {
+        *flow = *parked;
+        sharedTableRemove(&pending, shard, parked);
+    }
+    sharedTableUnlock(shard);
+    if (!found) return ERROR_NOT_FOUND;
+    if (signinFlowExpired(flow, time(NULL))) return ERROR_AUTH_FAILED;
+    return SUCCESS;
+}
+
+// Puts a flow back under its original ticket if it can still make progress.
+// The shard is unlocked while the flow is out, so a new signin may have taken
+// the slot takeFlow freed; the flow is then lost and the user must start over.
+static ErrorCode returnFlow(SigninFlow *flow) {
+    if (flow->state != SIGNIN_AWAIT_OTP) return SUCCESS;
+    uint32_t hash = sharedTableHash(flow->ticket);
+    SharedShard *shard = sharedTableLock(&pending, hash);
+    if (!shard) return ERROR_GENERAL;
+    int stored = sharedTableInsert(&pending, shard, flow, hash);
+    sharedTableUnlock(shard);
+    return stored ? SUCCESS : ERROR_GENERAL;
+}
+
+ErrorCode signinVerify(const char *ticket, const char *otp, Session *session) {
+    SigninFlow flow;
+    ErrorCode rc = takeFlow(ticket, &flow);
+    if (rc != SUCCESS) return rc;
+    rc = signinFlowVerify(&flow, otp, session);
+    if (returnFlow(&flow) != SUCCESS) return ERROR_GENERAL;
+    return rc;
+}
+
+ErrorCode signinResend(const char *ticket, int *channels) {
+    SigninFlow flow;
+    ErrorCode rc = takeFlow(ticket, &flow);
+    if (rc != SUCCESS) return rc;
+    rc = signinFlowResend(&flow);
+    if (channels) *channels = flow.channels;
+    if (returnFlow(&flow) != SUCCESS) return ERROR_GENERAL;
+    return rc;
+}
+
+int signinPendingCount(void) {
+    return sharedTableCount(&pending);
+}
+
+int signinSweepExpired(time_t now) {
+    return sharedTableSweep(&pending, now);
+}
@@ -12,7 +12,59 @@
 #include "../include/database.h"
 #include "../include/campus_security.h"
 
+#define USER_ID_ATTEMPTS 20
 
+// Hospital and hostel profiles carry a fixed field list
+static void applyFixedFields(Profile *p) {
+    static const char *hospital[] = { "Blood Pressure", "Temperature", "Weight", "Diagnosis" };
+    static const char *hostel[] = { "Room Number", "Floor", "Mess Plan" };
+    const char **fields = NULL;
+    int count = 0;
+    if (p->campusType == CAMPUS_HOSPITAL) { fields = hospital; count = 4; }
+    if (p->campusType == CAMPUS_HOSTEL) { fields = hostel; count = 3; }
+    if (!fields) return;
+    memset(p->dataFields, 0, sizeof(p->dataFields));
+    for (int i = 0; i < count; i++) {
+        strncpy(p->dataFields[i], fields[i], sizeof(p->dataFields[i]) - 1);
+    }
+    p->dataCount = count;
+}
+
+// Non-interactive registration: validates the filled-in profile, hashes the
+// password, assigns a free user ID and stores the user
+ErrorCode registerProfile(Profile *p, const char *password) {
+    if (!p || !password) return ERROR_INVALID_INPUT;
+    if (p->name[0] == '\0' || p->instituteName[0] == '\0' || p->department[0] == '\0') return ERROR_INVALID_INPUT;
+    if (p->campusType < CAMPUS_SCHOOL || p->campusType > CAMPUS_HOSTEL) return ERROR_INVALID_INPUT;
+
+    applyFixedFields(p);
+    if (p->dataCount < 1 || p->dataCount > MAX_SUBJECTS) return ERROR_INVALID_INPUT;
+    for (int i = 0; i < p->dataCount; i++) {
+        if (p->dataFields[i][0] == '\0') return ERROR_INVALID_INPUT;
+        for (int j = i + 1; j < p->dataCount; j++) {
+            if (strcmp(p->dataFields[i], p->dataFields[j]) == 0) return ERROR_INVALID_INPUT;
+        }
+    }
+
+    if (isValidEmail(p->email) != SUCCESS || isValidMobile(p->mobile) != SUCCESS) return ERROR_INVALID_INPUT;
+    if (checkPasswordStrength(password) < 3) return ERROR_INVALID_INPUT;
+    if (isEmailAlreadyRegistered(p->email) || isMobileAlreadyRegistered(p->mobile)) return ERROR_ALREADY_EXISTS;
+
+    hashPassword(password, p->passwordHash);
+
+    // IDs are institute initials + a random serial. The primary key catches a
+    // collision, even with a signup in another process, and we draw again.
+    ErrorCode rc = ERROR_ALREADY_EXISTS;
+    for (int attempt = 0; rc == ERROR_ALREADY_EXISTS && attempt < USER_ID_ATTEMPTS; attempt++) {
+        generateUserID(p);
+        if (p->userID[0] == '\0') return ERROR_GENERAL;
+        rc = createUser(p);
+    }
+    if (rc != SUCCESS) return rc == ERROR_ALREADY_EXISTS ? ERROR_ALREADY_EXISTS : ERROR_DATABASE;
+
+    logActivity(p->userID, EVENT_USER_REGISTERED, "New user registration completed");
+    return SUCCESS;
+}
 
 ErrorCode signup() {
     Profile p = {0};
@@ -189,16 +241,11 @@ ErrorCode signup() {
         printf("Password is too weak. Please try again.\n");
         printf("Requirements: 8+ chars, uppercase, lowercase, digit, special char\n");
     } while (1);
-    hashPassword(password, p.passwordHash);
-    generateUserID(&p);
-
-    if (createUser(&p) != SUCCESS) {
+    if (registerProfile(&p, password) != SUCCESS) {
         printf("Registration failed\n");
         return ERROR_DATABASE;
     }
 
-    logActivity(p.userID, "USER_REGISTERED", "New user registration completed");
-
     FILE *userFile = fopen(USER_STATE_FILE, "w");
     if (userFile) {
         fprintf(userFile, "%s\n", p.userID);
@@ -0,0 +1,585 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../include/storage_engine.h"
+#include "../include/database.h"
+
+#define PROFILE_RECORD_VERSION 1
+#define PROFILE_RECORD_MAX     2048
+
+static int validUserID(const char *userID) {
+    return userID && userID[0] && strlen(userID) < sizeof(((Profile*)0)->userID);
+}
+
+// ---- dispatch ----
+
+ErrorCode storageGetProfile(StorageEngine *engine, const char *userID, Profile *profile) {
+    if (!engine || !validUserID(userID) || !profile) return ERROR_INVALID_INPUT;
+    return engine->ops->getProfile(engine, userID, profile);
+}
+
+ErrorCode storagePutProfile(StorageEngine *engine, const Profile *profile) {
+    if (!engine || !profile || !validUserID(profile->userID) ||
+        profile->dataCount < 0 || profile->dataCount > MAX_SUBJECTS) {
+        return ERROR_INVALID_INPUT;
+    }
+    return engine->ops->putProfile(engine, profile);
+}
+
+ErrorCode storageDeleteProfile(StorageEngine *engine, const char *userID) {
+    if (!engine || !validUserID(userID)) return ERROR_INVALID_INPUT;
+    return engine->ops->deleteProfile(engine, userID);
+}
+
+ErrorCode storageScanProfiles(StorageEngine *engine, ProfileVisitor visit, void *ctx) {
+    if (!engine || !visit) return ERROR_INVALID_INPUT;
+    return engine->ops->scanProfiles(engine, visit, ctx);
+}
+
+ErrorCode storageGetRecord(StorageEngine *engine, const char *userID, UnifiedCampusData *data) {
+    if (!engine || !validUserID(userID) || !data) return ERROR_INVALID_INPUT;
+    return engine->ops->getRecord(engine, userID, data);
+}
+
+ErrorCode storagePutRecord(StorageEngine *engine, const UnifiedCampusData *data) {
+    if (!engine || !data || !validUserID(data->userID) || campusRecordSize(data) == 0) return ERROR_INVALID_INPUT;
+    return engine->ops->putRecord(engine, data);
+}
+
+ErrorCode storageDeleteRecord(StorageEngine *engine, const char *userID) {
+    if (!engine || !validUserID(userID)) return ERROR_INVALID_INPUT;
+    return engine->ops->deleteRecord(engine, userID);
+}
+
+ErrorCode storageScanRecords(StorageEngine *engine, CampusRecordVisitor visit, void *ctx) {
+    if (!engine || !visit) return ERROR_INVALID_INPUT;
+    return engine->ops->scanRecords(engine, visit, ctx);
+}
+
+void storageClose(StorageEngine *engine) {
+    if (engine) engine->ops->close(engine);
+}
+
+ErrorCode storageOpenByName(const char *name, const char *dir, StorageEngine **engine) {
+    if (!name || !engine) return ERROR_INVALID_INPUT;
+    if (strcmp(name, "sqlite") == 0) return storageOpenSqlite(engine);
+    if (strcmp(name, "log") == 0) return storageOpenLog(dir ? dir : SEGMENT_STORE_DIR, NULL, engine);
+    if (strcmp(name, "memory") == 0) return storageOpenMemory(engine);
+    return ERROR_INVALID_INPUT;
+}
+
+static StorageEngine *newEngine(const StorageEngineOps *ops, void *state) {
+    StorageEngine *engine = malloc(sizeof(StorageEngine));
+    if (!engine) return NULL;
+    engine->ops = ops;
+    engine->state = state;
+    return engine;
+}
+
+// Decodes a stored compact record into `data`
+static ErrorCode decodeRecord(const void *bytes, size_t length, UnifiedCampusData *data) {
+    CampusRecordView view;
+    if (campusRecordView(bytes, length, &view) != SUCCESS || view.length != length) return ERROR_FILE_IO;
+    return campusRecordDecode(&view, data);
+}
+
+static int visitRecord(const void *bytes, size_t length, CampusRecordVisitor visit, void *ctx) {
+    CampusRecordView view;
+    if (campusRecordView(bytes, length, &view) != SUCCESS) return 1;     // skip what does not parse
+    return visit(&view, ctx);
+}
+
+// ---- sqlite: the application database ----
+
+static ErrorCode sqliteGetProfile(StorageEngine *engine, const char *userID, Profile *profile) {
+    (void)engine;
+    return getUserByID(userID, profile) ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+static ErrorCode sqlitePutProfile(StorageEngine *engine, const Profile *profile) {
+    (void)engine;
+    Profile existing;
+    if (getUserByID(profile->userID, &existing)) return updateUser(profile) ? SUCCESS : ERROR_DATABASE;
+    return createUser(profile);
+}
+
+static ErrorCode sqliteDeleteProfile(StorageEngine *engine, const char *userID) {
+    (void)engine;
+    return deleteUser(userID);
+}
+
+static ErrorCode sqliteScanProfiles(StorageEngine *engine, ProfileVisitor visit, void *ctx) {
+    (void)engine;
+    return scanProfiles(visit, ctx);
+}
+
+static ErrorCode sqliteGetRecord(StorageEngine *engine, const char *userID, UnifiedCampusData *data) {
+    (void)engine;
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t length = 0;
+    ErrorCode rc = loadCampusRecord(userID, record, sizeof(record), &length);
+    if (rc != SUCCESS) return rc == ERROR_MEMORY ? ERROR_FILE_IO : rc;
+    return decodeRecord(record, length, data);
+}
+
+static ErrorCode sqlitePutRecord(StorageEngine *engine, const UnifiedCampusData *data) {
+    (void)engine;
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t length = campusRecordEncode(data, record, sizeof(record));
+    if (length == 0) return ERROR_INVALID_INPUT;
+    return saveCampusRecord(data->userID, record, length);
+}
+
+static ErrorCode sqliteDeleteRecord(StorageEngine *engine, const char *userID) {
+    (void)engine;
+    return deleteCampusRecord(userID);
+}
+
+typedef struct {
+    CampusRecordVisitor visit;
+    void *ctx;
+} RecordScan;
+
+static int sqliteRecordRow(const char *userID, const void *record, size_t length, void *ctx) {
+    (void)userID;
+    RecordScan *scan = (RecordScan*)ctx;
+    return visitRecord(record, length, scan->visit, scan->ctx);
+}
+
+static ErrorCode sqliteScanRecords(StorageEngine *engine, CampusRecordVisitor visit, void *ctx) {
+    (void)engine;
+    RecordScan scan = { visit, ctx };
+    return scanStoredCampusRecords(sqliteRecordRow, &scan);
+}
+
+static void sqliteClose(StorageEngine *engine) {
+    free(engine);
+}
+
+static const StorageEngineOps sqliteOps = {
+    "sqlite", 1,
+    sqliteGetProfile, sqlitePutProfile, sqliteDeleteProfile, sqliteScanProfiles,
+    sqliteGetRecord, sqlitePutRecord, sqliteDeleteRecord, sqliteScanRecords,
+    sqliteClose
+};
+
+ErrorCode storageOpenSqlite(StorageEngine **engine) {
+    if (!engine) return ERROR_INVALID_INPUT;
+    *engine = newEngine(&sqliteOps, NULL);
+    return *engine ? SUCCESS : ERROR_MEMORY;
+}
+
+// ---- log: segment stores ----
+
+// Profiles in the log store, packed like campus records:
+//   u8 version | u8 campusType | u8 dataCount | u8 0
+//   userID, name, institute, department, email, mobile, passwordHash,
+//   dataFields[dataCount]                      NUL-terminated, back to back
+static size_t putField(unsigned char *out, size_t at, const char *s, size_t field) {
+    size_t n = strnlen(s, field - 1);
+    if (at + n + 1 > PROFILE_RECORD_MAX) return PROFILE_RECORD_MAX + 1;
+    memcpy(out + at, s, n);
+    out[at + n] = '\0';
+    return at + n + 1;
+}
+
+static size_t profileEncode(const Profile *p, unsigned char *out) {
+    out[0] = PROFILE_RECORD_VERSION;
+    out[1] = (unsigned char)p->campusType;
+    out[2] = (unsigned char)p->dataCount;
+    out[3] = 0;
+    size_t at = 4;
+    at = putField(out, at, p->userID, sizeof(p->userID));
+    at = putField(out, at, p->name, sizeof(p->name));
+    at = putField(out, at, p->instituteName, sizeof(p->instituteName));
+    at = putField(out, at, p->department, sizeof(p->department));
+    at = putField(out, at, p->email, sizeof(p->email));
+    at = putField(out, at, p->mobile, sizeof(p->mobile));
+    at = putField(out, at, p->passwordHash, sizeof(p->passwordHash));
+    for (int i = 0; i < p->dataCount && at <= PROFILE_RECORD_MAX; i++) {
+        at = putField(out, at, p->dataFields[i], sizeof(p->dataFields[i]));
+    }
+    return at <= PROFILE_RECORD_MAX ? at : 0;
+}
+
+static int takeField(const unsigned char **p, const unsigned char *end, char *dst, size_t field) {
+    const unsigned char *nul = memchr(*p, '\0', (size_t)(end - *p));
+    if (!nul || (size_t)(nul - *p) >= field) return 0;
+    memcpy(dst, *p, (size_t)(nul - *p) + 1);
+    *p = nul + 1;
+    return 1;
+}
+
+static ErrorCode profileDecode(const void *bytes, size_t length, Profile *p) {
+    const unsigned char *in = (const unsigned char*)bytes, *end = in + length;
+    if (length < 4 || in[0] != PROFILE_RECORD_VERSION || in[2] > MAX_SUBJECTS) return ERROR_FILE_IO;
+    memset(p, 0, sizeof(*p));
+    p->campusType = (CampusType)in[1];
+    p->dataCount = in[2];
+    const unsigned char *at = in + 4;
+    int ok = takeField(&at, end, p->userID, sizeof(p->userID)) &&
+             takeField(&at, end, p->name, sizeof(p->name)) &&
+             takeField(&at, end, p->instituteName, sizeof(p->instituteName)) &&
+             takeField(&at, end, p->department, sizeof(p->department)) &&
+             takeField(&at, end, p->email, sizeof(p->email)) &&
+             takeField(&at, end, p->mobile, sizeof(p->mobile)) &&
+             takeField(&at, end, p->passwordHash, sizeof(p->passwordHash));
+    for (int i = 0; ok && i < p->dataCount; i++) ok = takeField(&at, end, p->dataFields[i], sizeof(p->dataFields[i]));
+    return ok && at == end ? SUCCESS : ERROR_FILE_IO;
+}
+
+typedef struct {
+    SegmentStore *records;
+    SegmentStore *profiles;
+} LogState;
+
+typedef struct {
+    void *out;
+    ErrorCode rc;
+} LogRead;
+
+static void readProfileValue(const void *value, size_t length, void *ctx) {
+    LogRead *read = (LogRead*)ctx;
+    read->rc = profileDecode(value, length, (Profile*)read->out);
+}
+
+static void readRecordValue(const void *value, size_t length, void *ctx) {
+    LogRead *read = (LogRead*)ctx;
+    read->rc = decodeRecord(value, length, (UnifiedCampusData*)read->out);
+}
+
+static ErrorCode logGetProfile(StorageEngine *engine, const char *userID, Profile *profile) {
+    LogState *state = (LogState*)engine->state;
+    LogRead read = { profile, ERROR_NOT_FOUND };
+    ErrorCode rc = segmentStoreRead(state->profiles, userID, readProfileValue, &read);
+    return rc == SUCCESS ? read.rc : rc;
+}
+
+static ErrorCode logPutProfile(StorageEngine *engine, const Profile *profile) {
+    LogState *state = (LogState*)engine->state;
+    unsigned char bytes[PROFILE_RECORD_MAX];
+    size_t length = profileEncode(profile, bytes);
+    if (length == 0) return ERROR_INVALID_INPUT;
+    return segmentStorePut(state->profiles, profile->userID, bytes, length);
+}
+
+static ErrorCode logDeleteProfile(StorageEngine *engine, const char *userID) {
+    LogState *state = (LogState*)engine->state;
+    ErrorCode rc = segmentStoreDelete(state->profiles, userID);
+    if (rc != SUCCESS) return rc;
+    rc = segmentStoreDelete(state->records, userID);
+    return rc == ERROR_NOT_FOUND ? SUCCESS : rc;
+}
+
+typedef struct {
+    ProfileVisitor visit;
+    void *ctx;
+} ProfileScan;
+
+static int logProfileEntry(const char *key, const void *value, size_t length, void *ctx) {
+    (void)key;
+    ProfileScan *scan = (ProfileScan*)ctx;
+    Profile profile;
+    if (profileDecode(value, length, &profile) != SUCCESS) return 1;
+    return scan->visit(&profile, scan->ctx);
+}
+
+static ErrorCode logScanProfiles(StorageEngine *engine, ProfileVisitor visit, void *ctx) {
+    LogState *state = (LogState*)engine->state;
+    ProfileScan scan = { visit, ctx };
+    return segmentStoreScan(state->profiles, logProfileEntry, &scan);
+}
+
+static ErrorCode logGetRecord(StorageEngine *engine, const char *userID, UnifiedCampusData *data) {
+    LogState *state = (LogState*)engine->state;
+    LogRead read = { data, ERROR_NOT_FOUND };
+    ErrorCode rc = segmentStoreRead(state->records, userID, readRecordValue, &read);
+    return rc == SUCCESS ? read.rc : rc;
+}
+
+static ErrorCode logPutRecord(StorageEngine *engine, const UnifiedCampusData *data) {
+    LogState *state = (LogState*)engine->state;
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t length = campusRecordEncode(data, record, sizeof(record));
+    if (length == 0) return ERROR_INVALID_INPUT;
+    return segmentStorePut(state->records, data->userID, record, length);
+}
+
+static ErrorCode logDeleteRecord(StorageEngine *engine, const char *userID) {
+    LogState *state = (LogState*)engine->state;
+    return segmentStoreDelete(state->records, userID);
+}
+
+static int logRecordEntry(const char *key, const void *value, size_t length, void *ctx) {
+    (void)key;
+    RecordScan *scan = (RecordScan*)ctx;
+    return visitRecord(value, length, scan->visit, scan->ctx);
+}
+
+static ErrorCode logScanRecords(StorageEngine *engine, CampusRecordVisitor visit, void *ctx) {
+    LogState *state = (LogState*)engine->state;
+    RecordScan scan = { visit, ctx };
+    return segmentStoreScan(state->records, logRecordEntry, &scan);
+}
+
+static void logClose(StorageEngine *engine) {
+    LogState *state = (LogState*)engine->state;
+    segmentStoreClose(state->records);
+    segmentStoreClose(state->profiles);
+    free(state);
+    free(engine);
+}
+
+static const StorageEngineOps logOps = {
+    "log", 1,
+    logGetProfile, logPutProfile, logDeleteProfile, logScanProfiles,
+    logGetRecord, logPutRecord, logDeleteRecord, logScanRecords,
+    logClose
+};
+
+ErrorCode storageOpenLog(const char *dir, const SegmentStoreOptions *options, StorageEngine **engine) {
+    if (!dir || !engine) return ERROR_INVALID_INPUT;
+    *engine = NULL;
+    LogState *state = calloc(1, sizeof(LogState));
+    if (!state) return ERROR_MEMORY;
+    char profileDir[260];
+    snprintf(profileDir, sizeof(profileDir), "%s/profiles", dir);
+    ErrorCode rc = segmentStoreOpen(dir, options, &state->records);
+    if (rc == SUCCESS) rc = segmentStoreOpen(profileDir, options, &state->profiles);
+    if (rc == SUCCESS && !(*engine = newEngine(&logOps, state))) rc = ERROR_MEMORY;
+    if (rc != SUCCESS) {
+        segmentStoreClose(state->records);
+        segmentStoreClose(state->profiles);
+        free(state);
+    }
+    return rc;
+}
+
+// ---- memory ----
+
+typedef struct MemoryEntry {
+    struct MemoryEntry *next;
+    char userID[20];
+    int hasProfile;
+    Profile profile;
+    unsigned char *record;          // compact record, NULL when none
+    size_t recordLength;
+} MemoryEntry;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    MemoryEntry **buckets;
+    size_t bucketCount;             // power of two
+    size_t entries;
+} MemoryState;
+
+static size_t memoryBucket(const MemoryState *state, const char *userID) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char*)userID; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return (size_t)h & (state->bucketCount - 1);
+}
+
+static MemoryEntry *memoryFind(const MemoryState *state, const char *userID) {
+    for (MemoryEntry *e = state->buckets[memoryBucket(state, userID)]; e; e = e->next) {
+        if (strcmp(e->userID, userID) == 0) return e;
+    }
+    return NULL;
+}
+
+static void memoryGrow(MemoryState *state) {
+    size_t count = state->bucketCount * 2;
+    MemoryEntry **buckets = calloc(count, sizeof(MemoryEntry*));
+    if (!buckets) return;                   // longer chains, still correct
+    MemoryState grown = *state;
+    grown.buckets = buckets;
+    grown.bucketCount = count;
+    for (size_t i = 0; i < state->bucketCount; i++) {
+        MemoryEntry *e = state->buckets[i];
+        while (e) {
+            MemoryEntry *next = e->next;
+            size_t b = memoryBucket(&grown, e->userID);
+            e->next = buckets[b];
+            buckets[b] = e;
+            e = next;
+        }
+    }
+    free(state->buckets);
+    state->buckets = buckets;
+    state->bucketCount = count;
+}
+
+// Caller holds the write lock
+static MemoryEntry *memoryClaim(MemoryState *state, const char *userID) {
+    MemoryEntry *e = memoryFind(state, userID);
+    if (e) return e;
+    if (state->entries >= state->bucketCount) memoryGrow(state);
+    e = calloc(1, sizeof(MemoryEntry));
+    if (!e) return NULL;
+    snprintf(e->userID, sizeof(e->userID), "%s", userID);
+    size_t b = memoryBucket(state, userID);
+    e->next = state->buckets[b];
+    state->buckets[b] = e;
+    state->entries++;
+    return e;
+}
+
+// Unlinks an entry holding neither a profile nor a record
+static void memoryTrim(MemoryState *state, MemoryEntry *entry) {
+    if (entry->hasProfile || entry->record) return;
+    MemoryEntry **link = &state->buckets[memoryBucket(state, entry->userID)];
+    while (*link && *link != entry) link = &(*link)->next;
+    if (*link) *link = entry->next;
+    free(entry);
+    state->entries--;
+}
+
+static ErrorCode memoryGetProfile(StorageEngine *engine, const char *userID, Profile *profile) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_rdlock(&state->lock);
+    MemoryEntry *e = memoryFind(state, userID);
+    int found = e && e->hasProfile;
+    if (found) *profile = e->profile;
+    pthread_rwlock_unlock(&state->lock);
+    return found ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+static ErrorCode memoryPutProfile(StorageEngine *engine, const Profile *profile) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_wrlock(&state->lock);
+    MemoryEntry *e = memoryClaim(state, profile->userID);
+    if (e) {
+        e->profile = *profile;
+        e->hasProfile = 1;
+    }
+    pthread_rwlock_unlock(&state->lock);
+    return e ? SUCCESS : ERROR_MEMORY;
+}
+
+static ErrorCode memoryDeleteProfile(StorageEngine *engine, const char *userID) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_wrlock(&state->lock);
+    MemoryEntry *e = memoryFind(state, userID);
+    int found = e && e->hasProfile;
+    if (found) {
+        e->hasProfile = 0;
+        free(e->record);
+        e->record = NULL;
+        e->recordLength = 0;
+        memoryTrim(state, e);
+    }
+    pthread_rwlock_unlock(&state->lock);
+    return found ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+static ErrorCode memoryScanProfiles(StorageEngine *engine, ProfileVisitor visit, void *ctx) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_rdlock(&state->lock);
+    int more = 1;
+    for (size_t i = 0; i < state->bucketCount && more; i++) {
+        for (MemoryEntry *e = state->buckets[i]; e && more; e = e->next) {
+            if (e->hasProfile) more = visit(&e->profile, ctx);
+        }
+    }
+    pthread_rwlock_unlock(&state->lock);
+    return SUCCESS;
+}
+
+static ErrorCode memoryGetRecord(StorageEngine *engine, const char *userID, UnifiedCampusData *data) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_rdlock(&state->lock);
+    MemoryEntry *e = memoryFind(state, userID);
+    ErrorCode rc = e && e->record ? decodeRecord(e->record, e->recordLength, data) : ERROR_NOT_FOUND;
+    pthread_rwlock_unlock(&state->lock);
+    return rc;
+}
+
+static ErrorCode memoryPutRecord(StorageEngine *engine, const UnifiedCampusData *data) {
+    MemoryState *state = (MemoryState*)engine->state;
+    size_t length = campusRecordSize(data);
+    unsigned char *record = length ? malloc(length) : NULL;
+    if (!record) return length ? ERROR_MEMORY : ERROR_INVALID_INPUT;
+    campusRecordEncode(data, record, length);
+
+    pthread_rwlock_wrlock(&state->lock);
+    MemoryEntry *e = memoryClaim(state, data->userID);
+    if (e) {
+        free(e->record);
+        e->record = record;
+        e->recordLength = length;
+    }
+    pthread_rwlock_unlock(&state->lock);
+    if (!e) free(record);
+    return e ? SUCCESS : ERROR_MEMORY;
+}
+
+static ErrorCode memoryDeleteRecord(StorageEngine *engine, const char *userID) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_wrlock(&state->lock);
+    MemoryEntry *e = memoryFind(state, userID);
+    int found = e && e->record;
+    if (found) {
+        free(e->record);
+        e->record = NULL;
+        e->recordLength = 0;
+        memoryTrim(state, e);
+    }
+    pthread_rwlock_unlock(&state->lock);
+    return found ? SUCCESS : ERROR_NOT_FOUND;
+}
+
+static ErrorCode memoryScanRecords(StorageEngine *engine, CampusRecordVisitor visit, void *ctx) {
+    MemoryState *state = (MemoryState*)engine->state;
+    pthread_rwlock_rdlock(&state->lock);
+    int more = 1;
+    for (size_t i = 0; i < state->bucketCount && more; i++) {
+        for (MemoryEntry *e = state->buckets[i]; e && more; e = e->next) {
+            if (e->record) more = visitRecord(e->record, e->recordLength, visit, ctx);
+        }
+    }
+    pthread_rwlock_unlock(&state->lock);
+    return SUCCESS;
+}
+
+static void memoryClose(StorageEngine *engine) {
+    MemoryState *state = (MemoryState*)engine->state;
+    for (size_t i = 0; i < state->bucketCount; i++) {
+        MemoryEntry *e = state->buckets[i];
+        while (e) {
+            MemoryEntry *next = e->next;
+            free(e->record);
+            free(e);
+            e = next;
+        }
+    }
+    pthread_rwlock_destroy(&state->lock);
+    free(state->buckets);
+    free(state);
+    free(engine);
+}
+
+static const StorageEngineOps memoryOps = {
+    "memory", 0,
+    memoryGetProfile, memoryPutProfile, memoryDeleteProfile, memoryScanProfiles,
+    memoryGetRecord, memoryPutRecord, memoryDeleteRecord, memoryScanRecords,
+    memoryClose
+};
+
+ErrorCode storageOpenMemory(StorageEngine **engine) {
+    if (!engine) return ERROR_INVALID_INPUT;
+    *engine = NULL;
+    MemoryState *state = calloc(1, sizeof(MemoryState));
+    if (!state) return ERROR_MEMORY;
+    state->bucketCount = 1024;
+    state->buckets = calloc(state->bucketCount, sizeof(MemoryEntry*));
+    if (!state->buckets || !(*engine = newEngine(&memoryOps, state))) {
+        free(state->buckets);
+        free(state);
+        return ERROR_MEMORY;
+    }
+    pthread_rwlock_init(&state->lock, NULL);
+    return SUCCESS;
+}
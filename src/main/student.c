@@ -1,10 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdarg.h>
 #ifdef _WIN32
 #include <direct.h>
+#include <process.h>
+#define getpid _getpid
 #else
-#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include "../include/student.h"
 #include "../include/auth.h"
@@ -19,6 +24,10 @@
 #include "../include/hpdf/hpdf.h"
 #include "../include/ui.h"
 #include"../include/database.h"
+#include "../include/report_cache.h"
+#include "../include/grade_kernel.h"
+#include "../include/rank_engine.h"
+#include "../include/grading_scheme.h"
 
 const char* getCampusName(CampusType type) {
     switch(type) {
@@ -30,25 +39,95 @@ const char* getCampusName(CampusType type) {
     }
 }
 
-const char* getGrade(float percent) {
-    if (percent >= 90.0f) return "A+";
-    else if (percent >= 80.0f) return "A";
-    else if (percent >= 70.0f) return "B";
-    else if (percent >= 60.0f) return "C";
-    else if (percent >= 50.0f) return "D";
-    else return "F";
+// Grade under the default scheme only, ignoring any institute's own
+const char* getDefaultGrade(float percent) {
+    const GradingScheme *scheme = gradingSchemeFor(NULL);
+    return scheme->names[gradingSchemeGrade(scheme, percent)];
 }
 
-void printSummary(int total, int full, CampusType type) {
-    float percentage = (full == 0) ? 0.0f : (total * 100.0f / full);
+void printSummary(int total, int full, CampusType type, const char *institute) {
+    float percentage = gradeStudent(GRADE_SCALE_PERCENT, &total, &full, 1).score;
     printf("Total: %d / %d\n", total, full);
     printf("Percentage: %.2f%%\n", percentage);
     if (type == CAMPUS_SCHOOL || type == CAMPUS_COLLEGE) {
-        printf("Grade: %s\n", getGrade(percentage));
+        const GradingScheme *scheme = gradingSchemeFor(institute);
+        printf("Grade: %s\n", scheme->names[gradingSchemeGrade(scheme, percentage)]);
+    }
+}
+
+
+
+const char* campusDataType(CampusType type) {
+    switch(type) {
+        case CAMPUS_SCHOOL: return "SCHOOL_DATA";
+        case CAMPUS_COLLEGE: return "COLLEGE_DATA";
+        case CAMPUS_HOSPITAL: return "HOSPITAL_DATA";
+        case CAMPUS_HOSTEL: return "HOSTEL_DATA";
+        default: return NULL;
+    }
+}
+
+static ErrorCode loadProfileFor(const char *userID, CampusType expected, Profile *p) {
+    if (!userID) return ERROR_INVALID_INPUT;
+    if (!getUserByID(userID, p)) return ERROR_NOT_FOUND;
+    if (p->campusType != expected) return ERROR_INVALID_INPUT;
+    return SUCCESS;
+}
+
+ErrorCode storeSchoolMarks(const char *studentID, const int *marks, const int *fullMarks, int count) {
+    Profile p = {0};
+    ErrorCode rc = loadProfileFor(studentID, CAMPUS_SCHOOL, &p);
+    if (rc != SUCCESS) return rc;
+    if (!marks || !fullMarks || count != p.dataCount) return ERROR_INVALID_INPUT;
+
+    SchoolMarks data = {0};
+    data.count = p.dataCount;
+    memcpy(data.subjects, p.dataFields, sizeof(data.subjects));
+    for (int i = 0; i < count; i++) {
+        if (marks[i] < 0 || marks[i] > 100 || fullMarks[i] < 1 || fullMarks[i] > 100) return ERROR_INVALID_INPUT;
+        data.marks[i] = marks[i];
+        data.fullMarks[i] = fullMarks[i];
+    }
+    if (!saveUserData(studentID, "SCHOOL_DATA", &data, sizeof(data))) return ERROR_DATABASE;
+    rankNoteMarks(&p, &data);
+    return SUCCESS;
+}
+
+ErrorCode storeCollegeMarks(const char *studentID, const int *marks, const int *credits, int count) {
+    Profile p = {0};
+    ErrorCode rc = loadProfileFor(studentID, CAMPUS_COLLEGE, &p);
+    if (rc != SUCCESS) return rc;
+    if (!marks || !credits || count != p.dataCount) return ERROR_INVALID_INPUT;
+
+    CollegeMarks data = {0};
+    data.count = p.dataCount;
+    memcpy(data.subjects, p.dataFields, sizeof(data.subjects));
+    for (int i = 0; i < count; i++) {
+        if (marks[i] < 0 || marks[i] > 100 || credits[i] < 1 || credits[i] > 10) return ERROR_INVALID_INPUT;
+        data.marks[i] = marks[i];
+        data.credits[i] = credits[i];
     }
+    if (!saveUserData(studentID, "COLLEGE_DATA", &data, sizeof(data))) return ERROR_DATABASE;
+    rankNoteMarks(&p, &data);
+    return SUCCESS;
 }
 
+ErrorCode storeFieldValues(const char *userID, CampusType type, const char values[][MAX_LEN], int count) {
+    if (type != CAMPUS_HOSPITAL && type != CAMPUS_HOSTEL) return ERROR_INVALID_INPUT;
+    Profile p = {0};
+    ErrorCode rc = loadProfileFor(userID, type, &p);
+    if (rc != SUCCESS) return rc;
+    if (!values || count != p.dataCount) return ERROR_INVALID_INPUT;
 
+    FieldValues data = {0};
+    data.count = p.dataCount;
+    memcpy(data.fields, p.dataFields, sizeof(data.fields));
+    for (int i = 0; i < count; i++) {
+        if (values[i][0] == '\0') return ERROR_INVALID_INPUT;
+        strncpy(data.values[i], values[i], MAX_LEN - 1);
+    }
+    return saveUserData(userID, campusDataType(type), &data, sizeof(data)) ? SUCCESS : ERROR_DATABASE;
+}
 
 // School Data Management
 void saveSchoolData(const char *studentID) {
@@ -73,20 +152,7 @@ void saveSchoolData(const char *studentID) {
         }
     }
     
-    // Pack data
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int fullMarks[MAX_SUBJECTS];
-    } data;
-    
-    data.count = p.dataCount;
-    memcpy(data.subjects, p.dataFields, sizeof(data.subjects));
-    memcpy(data.marks, marks, sizeof(marks));
-    memcpy(data.fullMarks, fullMarks, sizeof(fullMarks));
-    
-    if (saveUserData(studentID, "SCHOOL_DATA", &data, sizeof(data))) {
+    if (storeSchoolMarks(studentID, marks, fullMarks, p.dataCount) == SUCCESS) {
         printf("School marks saved to database.\n");
     } else {
         printf("Failed to save data.\n");
@@ -94,12 +160,7 @@ void saveSchoolData(const char *studentID) {
 }
 
 void loadSchoolData(const char *studentID) {
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int fullMarks[MAX_SUBJECTS];
-    } data;
+    SchoolMarks data;
     size_t size = sizeof(data);
     
     if (!loadUserData(studentID, "SCHOOL_DATA", &data, &size)) {
@@ -107,13 +168,18 @@ void loadSchoolData(const char *studentID) {
         return;
     }
     
-    int total = 0, totalFull = 0;
     for (int i = 0; i < data.count; i++) {
         printf("%d. %s - %d/%d\n", i+1, data.subjects[i], data.marks[i], data.fullMarks[i]);
-        total += data.marks[i];
-        totalFull += data.fullMarks[i];
     }
-    printSummary(total, totalFull, CAMPUS_SCHOOL);
+    Profile p = {0};
+    getUserByID(studentID, &p);
+    const GradingScheme *scheme = gradingSchemeFor(p.instituteName);
+    GradeSummary g = gradeSchoolMarks(&data);
+    GradingResult result;
+    gradingSchemeApply(scheme, CAMPUS_SCHOOL, &data, &result);
+    printf("Total: %d / %d\n", g.total, g.weight);
+    printf("Percentage: %.2f%%\n", result.percent);
+    printf("Grade: %s\n", scheme->names[result.grade]);
 }
 
 // College Data Management
@@ -139,19 +205,7 @@ void saveCollegeData(const char *studentID) {
         }
     }
     
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int credits[MAX_SUBJECTS];
-    } data;
-    
-    data.count = p.dataCount;
-    memcpy(data.subjects, p.dataFields, sizeof(data.subjects));
-    memcpy(data.marks, marks, sizeof(marks));
-    memcpy(data.credits, credits, sizeof(credits));
-    
-    if (saveUserData(studentID, "COLLEGE_DATA", &data, sizeof(data))) {
+    if (storeCollegeMarks(studentID, marks, credits, p.dataCount) == SUCCESS) {
         printf("College marks saved to database.\n");
     } else {
         printf("Failed to save data.\n");
@@ -159,12 +213,7 @@ void saveCollegeData(const char *studentID) {
 }
 
 void loadCollegeData(const char *studentID) {
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int credits[MAX_SUBJECTS];
-    } data;
+    CollegeMarks data;
     size_t size = sizeof(data);
     
     if (!loadUserData(studentID, "COLLEGE_DATA", &data, &size)) {
@@ -172,23 +221,25 @@ void loadCollegeData(const char *studentID) {
         return;
     }
     
-    int totalMarks = 0, totalCredits = 0;
     for (int i = 0; i < data.count; i++) {
         printf("%d. %s - %d marks (%d credits)\n", i+1, data.subjects[i], data.marks[i], data.credits[i]);
-        totalMarks += data.marks[i] * data.credits[i];
-        totalCredits += data.credits[i];
     }
-    float cgpa = totalCredits > 0 ? (float)totalMarks / (totalCredits * 10.0f) : 0.0f;
-    printf("CGPA: %.2f\n", cgpa);
+    Profile p = {0};
+    getUserByID(studentID, &p);
+    const GradingScheme *scheme = gradingSchemeFor(p.instituteName);
+    GradingResult result;
+    gradingSchemeApply(scheme, CAMPUS_COLLEGE, &data, &result);
+    printf("CGPA: %.2f\n", result.gpa);
+    printf("Grade: %s\n", scheme->names[result.grade]);
 }
 
-// Hospital Data Management
-void saveHospitalData(const char *patientID) {
+// Hospital and hostel records share one prompt loop
+static void saveFieldValues(const char *userID, CampusType type, const char *heading, const char *saved) {
     Profile p = {0};
-    if (!getUserByID(patientID, &p)) { printf("Cannot load profile\n"); return; }
+    if (!getUserByID(userID, &p)) { printf("Cannot load profile\n"); return; }
     
     char values[MAX_SUBJECTS][MAX_LEN] = {0};
-    printf("\nEnter medical data:\n");
+    printf("\n%s\n", heading);
     for (int i = 0; i < p.dataCount; i++) {
         while (1) {
             printf("%s: ", p.dataFields[i]);
@@ -197,425 +248,202 @@ void saveHospitalData(const char *patientID) {
         }
     }
     
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
-    
-    data.count = p.dataCount;
-    memcpy(data.fields, p.dataFields, sizeof(data.fields));
-    memcpy(data.values, values, sizeof(data.values));
-    
-    if (saveUserData(patientID, "HOSPITAL_DATA", &data, sizeof(data))) {
-        printf("Medical data saved to database.\n");
+    if (storeFieldValues(userID, type, (const char (*)[MAX_LEN])values, p.dataCount) == SUCCESS) {
+        printf("%s\n", saved);
     } else { printf("Failed to save data.\n"); }
 }
 
-void loadHospitalData(const char *patientID) {
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
+static void loadFieldValues(const char *userID, CampusType type, const char *missing) {
+    FieldValues data;
     size_t size = sizeof(data);
     
-    if (!loadUserData(patientID, "HOSPITAL_DATA", &data, &size)) {
-        printf("No medical data found\n");
+    if (!loadUserData(userID, campusDataType(type), &data, &size)) {
+        printf("%s\n", missing);
         return;
     }
-    
     for (int i = 0; i < data.count; i++) {
         printf("%s: %s\n", data.fields[i], data.values[i]);
     }
 }
 
+// Hospital Data Management
+void saveHospitalData(const char *patientID) {
+    saveFieldValues(patientID, CAMPUS_HOSPITAL, "Enter medical data:", "Medical data saved to database.");
+}
+
+void loadHospitalData(const char *patientID) {
+    loadFieldValues(patientID, CAMPUS_HOSPITAL, "No medical data found");
+}
+
 void saveHostelData(const char *residentID) {
-    Profile p = {0};
-    if (!getUserByID(residentID, &p)) { printf("Cannot load profile\n"); return; }
-    
-    char values[MAX_SUBJECTS][MAX_LEN] = {0};
-    printf("\nEnter hostel data:\n");
-    for (int i = 0; i < p.dataCount; i++) {
-        while (1) {
-            printf("%s: ", p.dataFields[i]);
-            if (safeGetString(values[i], sizeof(values[i])) == SUCCESS && strlen(values[i]) > 0) break;
-            printf("Invalid input.\n");
-        }
-    }
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
-    
-    data.count = p.dataCount;
-    memcpy(data.fields, p.dataFields, sizeof(data.fields));
-    memcpy(data.values, values, sizeof(data.values));
-    
-    if (saveUserData(residentID, "HOSTEL_DATA", &data, sizeof(data))) {
-        printf("Hostel data saved to database.\n");
-    } else { printf("Failed to save data.\n"); }
+    saveFieldValues(residentID, CAMPUS_HOSTEL, "Enter hostel data:", "Hostel data saved to database.");
 }
 
 void loadHostelData(const char *residentID) {
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
-    size_t size = sizeof(data);
-    
-    if (!loadUserData(residentID, "HOSTEL_DATA", &data, &size)) {
-        printf("No hostel data found\n");
-        return;
-    }
-    for (int i = 0; i < data.count; i++) {
-        printf("%s: %s\n", data.fields[i], data.values[i]);
+    loadFieldValues(residentID, CAMPUS_HOSTEL, "No hostel data found");
+}
+
+// Report layout, shared by single PDF exports and merged reports
+float campusReportScore(CampusType type, const void *data) {
+    if (type == CAMPUS_SCHOOL) return gradeSchoolMarks((const SchoolMarks*)data).score;
+    if (type == CAMPUS_COLLEGE) return gradeCollegeMarks((const CollegeMarks*)data).score;
+    return 0.0f;
+}
+
+static void addLine(ReportLayout *layout, float x, float *y, float advance, const char *fmt, ...) {
+    if (layout->count >= REPORT_MAX_LINES) return;
+    ReportLine *line = &layout->lines[layout->count++];
+    line->x = x;
+    line->y = *y;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line->text, sizeof(line->text), fmt, ap);
+    va_end(ap);
+    *y -= advance;
+}
+
+ErrorCode layoutCampusReport(const Profile *p, const void *data, ReportLayout *layout) {
+    if (!p || !data || !layout) return ERROR_INVALID_INPUT;
+    layout->count = 0;
+    float y = 800;
+
+    if (p->campusType == CAMPUS_SCHOOL) {
+        const SchoolMarks *m = (const SchoolMarks*)data;
+        int count = m->count < MAX_SUBJECTS ? m->count : MAX_SUBJECTS;
+        GradeSummary g = gradeSchoolMarks(m);
+        const GradingScheme *scheme = gradingSchemeFor(p->instituteName);
+        addLine(layout, 200, &y, 30, "School Report Card");
+        addLine(layout, 50, &y, 20, "Name: %s", p->name);
+        addLine(layout, 50, &y, 20, "School: %s", p->instituteName);
+        addLine(layout, 50, &y, 30, "Department: %s", p->department);
+        addLine(layout, 50, &y, 20, "Subject                Marks   Full Marks");
+        for (int i = 0; i < count; i++) {
+            addLine(layout, 50, &y, 20, "%-20s %5d   %5d", m->subjects[i], m->marks[i], m->fullMarks[i]);
+        }
+        y -= 10;
+        addLine(layout, 50, &y, 20, "Total: %d / %d", g.total, g.weight);
+        addLine(layout, 50, &y, 20, "Percentage: %.2f%%", g.score);
+        addLine(layout, 50, &y, 20, "Grade: %s", scheme->names[gradingSchemeGrade(scheme, g.score)]);
+    } else if (p->campusType == CAMPUS_COLLEGE) {
+        const CollegeMarks *m = (const CollegeMarks*)data;
+        int count = m->count < MAX_SUBJECTS ? m->count : MAX_SUBJECTS;
+        GradeSummary g = gradeCollegeMarks(m);
+        const GradingScheme *scheme = gradingSchemeFor(p->instituteName);
+        GradingResult result;
+        gradingSchemeApply(scheme, CAMPUS_COLLEGE, m, &result);
+        addLine(layout, 200, &y, 30, "College Transcript");
+        addLine(layout, 50, &y, 20, "Name: %s", p->name);
+        addLine(layout, 50, &y, 20, "College: %s", p->instituteName);
+        addLine(layout, 50, &y, 30, "Department: %s", p->department);
+        addLine(layout, 50, &y, 20, "Course                 Marks   Credits");
+        for (int i = 0; i < count; i++) {
+            addLine(layout, 50, &y, 20, "%-20s %5d   %5d", m->subjects[i], m->marks[i], m->credits[i]);
+        }
+        y -= 10;
+        addLine(layout, 50, &y, 20, "Total Credits: %d", g.weight);
+        addLine(layout, 50, &y, 20, "CGPA: %.2f", result.gpa);
+        addLine(layout, 50, &y, 20, "Grade: %s", scheme->names[result.grade]);
+    } else if (p->campusType == CAMPUS_HOSPITAL || p->campusType == CAMPUS_HOSTEL) {
+        // Hospital and hostel reports list the profile's fields with their values
+        const FieldValues *v = (const FieldValues*)data;
+        int count = v->count < MAX_SUBJECTS ? v->count : MAX_SUBJECTS;
+        int hospital = p->campusType == CAMPUS_HOSPITAL;
+        addLine(layout, 200, &y, 30, hospital ? "Medical Report" : "Hostel Accommodation Report");
+        addLine(layout, 50, &y, 20, "%s: %s", hospital ? "Patient" : "Resident", p->name);
+        addLine(layout, 50, &y, 20, "%s: %s", hospital ? "Hospital" : "Hostel", p->instituteName);
+        addLine(layout, 50, &y, 30, "Department: %s", p->department);
+        addLine(layout, 50, &y, 20, hospital ? "Medical Data:" : "Accommodation Details:");
+        for (int i = 0; i < count; i++) {
+            addLine(layout, 50, &y, 20, "%s: %s", v->fields[i], v->values[i]);
+        }
+    } else {
+        return ERROR_INVALID_INPUT;
     }
+    return SUCCESS;
 }
 
 // PDF Export Functions
 #ifndef HPDF_DISABLED
-void exportSchoolPDF(const char *studentID) {
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int fullMarks[MAX_SUBJECTS];
-    } data;
-    size_t size = sizeof(data);
-    
-    if (!loadUserData(studentID, "SCHOOL_DATA", &data, &size)) {
-        printf("No school data found for PDF export\n");
-        return;
-    }
-    
-    int count = data.count;
-    // Unpack data for local usage if needed, or use directly
-    // Using direct access from data struct for cleaner code
-    int total = 0, totalFull = 0;
-    for(int i=0; i<count; i++) {
-        total += data.marks[i];
-        totalFull += data.fullMarks[i];
-    }
-    
-    Profile p = {0};
-    if (!getUserByID(studentID, &p)) {
-        printf("Cannot load profile for PDF\n");
-        return;
-    }
-
-    float percentage = (totalFull == 0) ? 0.0f : (total * 100.0f / totalFull);
-    const char *grade = getGrade(percentage);
-    
+// One document per call and nothing printed, so report runs can call it from
+// several threads
+static HPDF_Doc buildReport(const ReportLayout *layout) {
     HPDF_Doc pdf = HPDF_New(NULL, NULL);
-    if (!pdf) {
-        printf("Failed to create PDF\n");
-        return;
-    }
+    if (!pdf) return NULL;
     
     HPDF_Page page = HPDF_AddPage(pdf);
     HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
     HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
     HPDF_Page_SetFontAndSize(page, font, 12);
     
-    float y = 800;
-    char buffer[256];
-    
     HPDF_Page_BeginText(page);
-    HPDF_Page_TextOut(page, 200, y, "School Report Card");
-    y -= 30;
-    
-    snprintf(buffer, sizeof(buffer), "Name: %s", p.name);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "School: %s", p.instituteName);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Department: %s", p.department);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 30;
-    
-    HPDF_Page_TextOut(page, 50, y, "Subject                Marks   Full Marks");
-    y -= 20;
-    
-    for (int i = 0; i < count; i++) {
-        snprintf(buffer, sizeof(buffer), "%-20s %5d   %5d", data.subjects[i], data.marks[i], data.fullMarks[i]);
-        HPDF_Page_TextOut(page, 50, y, buffer);
-        y -= 20;
+    for (int i = 0; i < layout->count; i++) {
+        HPDF_Page_TextOut(page, layout->lines[i].x, layout->lines[i].y, layout->lines[i].text);
     }
-    
-    y -= 10;
-    snprintf(buffer, sizeof(buffer), "Total: %d / %d", total, totalFull);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Percentage: %.2f%%", percentage);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Grade: %s", grade);
-    HPDF_Page_TextOut(page, 50, y, buffer);
     HPDF_Page_EndText(page);
-    
-    char outfile[150];
-    snprintf(outfile, sizeof(outfile), DATA_DIR "%s_school_report.pdf", studentID);
-    // Ensure data directory exists
-#ifdef _WIN32
-    _mkdir("data");
-#else
-    mkdir("data", 0700);
-#endif
-    HPDF_SaveToFile(pdf, outfile);
-    HPDF_Free(pdf);
-    
-    logEvent(studentID, "School PDF exported");
-    printf("School report PDF exported to %s\n", outfile);
+    return pdf;
 }
 
-void exportCollegePDF(const char *studentID) {
-    struct {
-        int count;
-        char subjects[MAX_SUBJECTS][MAX_LEN];
-        int marks[MAX_SUBJECTS];
-        int credits[MAX_SUBJECTS];
-    } data;
-    size_t size = sizeof(data);
-    
-    if (!loadUserData(studentID, "COLLEGE_DATA", &data, &size)) {
-        printf("No college data found for PDF export\n");
-        return;
+// Rendered to memory and copied out of the HPDF stream
+static ErrorCode renderReport(const ReportLayout *layout, ExportBuffer *out) {
+    HPDF_Doc pdf = buildReport(layout);
+    if (!pdf) return ERROR_MEMORY;
+    ErrorCode rc = HPDF_SaveToStream(pdf) == HPDF_OK ? SUCCESS : ERROR_MEMORY;
+    HPDF_UINT32 size = rc == SUCCESS ? HPDF_GetStreamSize(pdf) : 0;
+    unsigned char *data = rc == SUCCESS ? malloc(size ? size : 1) : NULL;
+    if (rc == SUCCESS && !data) rc = ERROR_MEMORY;
+    if (rc == SUCCESS) {
+        HPDF_STATUS status = HPDF_ReadFromStream(pdf, data, &size);
+        if (status != HPDF_OK && status != HPDF_STREAM_EOF) rc = ERROR_GENERAL;
     }
-    
-    int count = data.count;
-    int totalMarks = 0, totalCredits = 0;
-    for(int i=0; i<count; i++) {
-        totalMarks += data.marks[i] * data.credits[i];
-        totalCredits += data.credits[i];
+    HPDF_Free(pdf);
+    if (rc != SUCCESS) {
+        free(data);
+        return rc;
     }
-    
+    out->data = data;
+    out->length = size;
+    return SUCCESS;
+}
+
+// Interactive export into DATA_DIR, with the messages the menus print
+static void exportReport(const char *userID, CampusType type, const char *noData, const char *done) {
     Profile p = {0};
-    if (!getUserByID(studentID, &p)) {
+    if (!getUserByID(userID, &p)) {
         printf("Cannot load profile for PDF\n");
         return;
     }
-    
-    float cgpa = totalCredits > 0 ? (float)totalMarks / (totalCredits * 10.0f) : 0.0f;
-    
-    HPDF_Doc pdf = HPDF_New(NULL, NULL);
-    if (!pdf) {
-        printf("Failed to create PDF\n");
-        return;
-    }
-    
-    HPDF_Page page = HPDF_AddPage(pdf);
-    HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
-    HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
-    HPDF_Page_SetFontAndSize(page, font, 12);
-    
-    float y = 800;
-    char buffer[256];
-    
-    HPDF_Page_BeginText(page);
-    HPDF_Page_TextOut(page, 200, y, "College Transcript");
-    y -= 30;
-    
-    snprintf(buffer, sizeof(buffer), "Name: %s", p.name);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "College: %s", p.instituteName);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Department: %s", p.department);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 30;
-    
-    HPDF_Page_TextOut(page, 50, y, "Course                 Marks   Credits");
-    y -= 20;
-    
-    for (int i = 0; i < count; i++) {
-        snprintf(buffer, sizeof(buffer), "%-20s %5d   %5d", data.subjects[i], data.marks[i], data.credits[i]);
-        HPDF_Page_TextOut(page, 50, y, buffer);
-        y -= 20;
-    }
-    
-    y -= 10;
-    snprintf(buffer, sizeof(buffer), "Total Credits: %d", totalCredits);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "CGPA: %.2f", cgpa);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    HPDF_Page_EndText(page);
-    
-    char outfile[150];
-    snprintf(outfile, sizeof(outfile), DATA_DIR "%s_college_transcript.pdf", studentID);
+    p.campusType = type;
     // Ensure data directory exists
 #ifdef _WIN32
     _mkdir("data");
 #else
     mkdir("data", 0700);
 #endif
-    HPDF_SaveToFile(pdf, outfile);
-    HPDF_Free(pdf);
-    
-    logEvent(studentID, "College PDF exported");
-    printf("College transcript PDF exported to %s\n", outfile);
+    char outfile[150];
+    ErrorCode rc = writeCampusReport(&p, DATA_DIR, outfile, sizeof(outfile));
+    if (rc == ERROR_NOT_FOUND) printf("%s\n", noData);
+    else if (rc != SUCCESS) printf("Failed to create PDF\n");
+    else printf("%s %s\n", done, outfile);
+}
+
+void exportSchoolPDF(const char *studentID) {
+    exportReport(studentID, CAMPUS_SCHOOL, "No school data found for PDF export",
+                 "School report PDF exported to");
+}
+
+void exportCollegePDF(const char *studentID) {
+    exportReport(studentID, CAMPUS_COLLEGE, "No college data found for PDF export",
+                 "College transcript PDF exported to");
 }
 
 void exportHospitalPDF(const char *patientID) {
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
-    size_t size = sizeof(data);
-    
-    if (!loadUserData(patientID, "HOSPITAL_DATA", &data, &size)) {
-        printf("No medical data found for PDF export\n");
-        return;
-    }
-    int count = data.count;
-    
-    Profile p = {0};
-    if (!getUserByID(patientID, &p)) {
-        printf("Cannot load profile for PDF\n");
-        return;
-    }
-    
-    HPDF_Doc pdf = HPDF_New(NULL, NULL);
-    if (!pdf) {
-        printf("Failed to create PDF\n");
-        return;
-    }
-    
-    HPDF_Page page = HPDF_AddPage(pdf);
-    HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
-    HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
-    HPDF_Page_SetFontAndSize(page, font, 12);
-    
-    float y = 800;
-    char buffer[256];
-    
-    HPDF_Page_BeginText(page);
-    HPDF_Page_TextOut(page, 200, y, "Medical Report");
-    y -= 30;
-    
-    snprintf(buffer, sizeof(buffer), "Patient: %s", p.name);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Hospital: %s", p.instituteName);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Department: %s", p.department);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 30;
-    
-    HPDF_Page_TextOut(page, 50, y, "Medical Data:");
-    y -= 20;
-    
-    for (int i = 0; i < count; i++) {
-        snprintf(buffer, sizeof(buffer), "%s: %s", data.fields[i], data.values[i]);
-        HPDF_Page_TextOut(page, 50, y, buffer);
-        y -= 20;
-    }
-    HPDF_Page_EndText(page);
-    
-    char outfile[150];
-    snprintf(outfile, sizeof(outfile), DATA_DIR "%s_medical_report.pdf", patientID);
-    // Ensure data directory exists
-#ifdef _WIN32
-    _mkdir("data");
-#else
-    mkdir("data", 0700);
-#endif
-    HPDF_SaveToFile(pdf, outfile);
-    HPDF_Free(pdf);
-    
-    logEvent(patientID, "Medical PDF exported");
-    printf("Medical report PDF exported to %s\n", outfile);
+    exportReport(patientID, CAMPUS_HOSPITAL, "No medical data found for PDF export",
+                 "Medical report PDF exported to");
 }
 
 void exportHostelPDF(const char *residentID) {
-    struct {
-        int count;
-        char fields[MAX_SUBJECTS][MAX_LEN];
-        char values[MAX_SUBJECTS][MAX_LEN];
-    } data;
-    size_t size = sizeof(data);
-    
-    if (!loadUserData(residentID, "HOSTEL_DATA", &data, &size)) {
-        printf("No hostel data found for PDF export\n");
-        return;
-    }
-    int count = data.count;
-    
-    Profile p = {0};
-    if (!getUserByID(residentID, &p)) {
-        printf("Cannot load profile for PDF\n");
-        return;
-    }
-    
-    HPDF_Doc pdf = HPDF_New(NULL, NULL);
-    if (!pdf) {
-        printf("Failed to create PDF\n");
-        return;
-    }
-    
-    HPDF_Page page = HPDF_AddPage(pdf);
-    HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
-    HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
-    HPDF_Page_SetFontAndSize(page, font, 12);
-    
-    float y = 800;
-    char buffer[256];
-    
-    HPDF_Page_BeginText(page);
-    HPDF_Page_TextOut(page, 200, y, "Hostel Accommodation Report");
-    y -= 30;
-    
-    snprintf(buffer, sizeof(buffer), "Resident: %s", p.name);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Hostel: %s", p.instituteName);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 20;
-    
-    snprintf(buffer, sizeof(buffer), "Department: %s", p.department);
-    HPDF_Page_TextOut(page, 50, y, buffer);
-    y -= 30;
-    
-    HPDF_Page_TextOut(page, 50, y, "Accommodation Details:");
-    y -= 20;
-    
-    for (int i = 0; i < count; i++) {
-        snprintf(buffer, sizeof(buffer), "%s: %s", data.fields[i], data.values[i]);
-        HPDF_Page_TextOut(page, 50, y, buffer);
-        y -= 20;
-    }
-    HPDF_Page_EndText(page);
-    
-    char outfile[150];
-    snprintf(outfile, sizeof(outfile), DATA_DIR "%s_hostel_report.pdf", residentID);
-    // Ensure data directory exists
-#ifdef _WIN32
-    _mkdir("data");
-#else
-    mkdir("data", 0700);
-#endif
-    HPDF_SaveToFile(pdf, outfile);
-    HPDF_Free(pdf);
-    
-    logEvent(residentID, "Hostel PDF exported");
-    printf("Hostel report PDF exported to %s\n", outfile);
+    exportReport(residentID, CAMPUS_HOSTEL, "No hostel data found for PDF export",
+                 "Hostel report PDF exported to");
 }
 
 int exportProfilePDF(const char *userID, const char *filename) {
@@ -820,6 +648,22 @@ void ensure_data_dir(void) {
 #endif
 }
 
+static ErrorCode renderReport(const ReportLayout *layout, ExportBuffer *out) {
+    size_t length = 0;
+    for (int i = 0; i < layout->count; i++) length += strlen(layout->lines[i].text) + 1;
+    unsigned char *data = malloc(length ? length : 1);
+    if (!data) return ERROR_MEMORY;
+    out->data = data;
+    out->length = length;
+    for (int i = 0; i < layout->count; i++) {
+        size_t n = strlen(layout->lines[i].text);
+        memcpy(data, layout->lines[i].text, n);
+        data[n] = '\n';
+        data += n + 1;
+    }
+    return SUCCESS;
+}
+
 void exportSchoolPDF(const char *studentID) {
     ensure_data_dir();
     char out[256];
@@ -936,3 +780,144 @@ int exportProfileCSV(const char *userID, const char *filename) {
 }
 
 #endif // HPDF_DISABLED
+
+#ifndef HPDF_DISABLED
+#define REPORT_EXT ".pdf"
+#define REPORT_CONTENT_TYPE "application/pdf"
+#else
+#define REPORT_EXT ".txt"
+#define REPORT_CONTENT_TYPE "text/plain; charset=utf-8"
+#endif
+
+static const struct {
+    const char *suffix;
+    const char *logMessage;
+} campusReports[CAMPUS_AMOUNT] = {
+    [CAMPUS_SCHOOL]   = { "_school_report",      "School PDF exported" },
+    [CAMPUS_COLLEGE]  = { "_college_transcript", "College PDF exported" },
+    [CAMPUS_HOSPITAL] = { "_medical_report",     "Medical PDF exported" },
+    [CAMPUS_HOSTEL]   = { "_hostel_report",      "Hostel PDF exported" },
+};
+
+// Bump when the page layout changes so cached reports are not reused
+#define REPORT_LAYOUT_REVISION 2
+
+static atomic_uint reportSequence;
+
+// Cache version of a report: the campus data's content hash plus every
+// profile field the page shows, the grading scheme and the layout revision
+static uint64_t reportVersion(const Profile *p, uint64_t dataVersion) {
+    const int revision = REPORT_LAYOUT_REVISION;
+    const uint64_t scheme = gradingSchemeFor(p->instituteName)->fingerprint;
+    uint64_t h = reportCacheHash(REPORT_CACHE_HASH_SEED, &dataVersion, sizeof(dataVersion));
+    h = reportCacheHash(h, p->name, strlen(p->name) + 1);
+    h = reportCacheHash(h, p->instituteName, strlen(p->instituteName) + 1);
+    h = reportCacheHash(h, p->department, strlen(p->department) + 1);
+    h = reportCacheHash(h, &p->campusType, sizeof(p->campusType));
+    h = reportCacheHash(h, &scheme, sizeof(scheme));
+    return reportCacheHash(h, &revision, sizeof(revision));
+}
+
+// The profile's campus data laid out as a report page (caller frees). The
+// version is taken from the blob actually loaded, so a concurrent save can
+// never file new bytes under the old key.
+static ErrorCode prepareReport(const Profile *p, ReportLayout **layoutOut, uint64_t *version) {
+    union {
+        SchoolMarks school;
+        CollegeMarks college;
+        FieldValues fields;
+    } data;
+    size_t dataSize = sizeof(data);
+    if (!loadUserData(p->userID, campusDataType(p->campusType), &data, &dataSize)) return ERROR_NOT_FOUND;
+    *version = reportVersion(p, reportCacheHash(REPORT_CACHE_HASH_SEED, &data, dataSize));
+    ReportLayout *layout = malloc(sizeof(ReportLayout));
+    if (!layout) return ERROR_MEMORY;
+    ErrorCode rc = layoutCampusReport(p, &data, layout);
+    if (rc != SUCCESS) {
+        free(layout);
+        return rc;
+    }
+    *layoutOut = layout;
+    return SUCCESS;
+}
+
+// Report bytes from the cache when the stored version still matches,
+// otherwise rendered and stored for the next request
+static ErrorCode reportBytes(const Profile *p, ExportBuffer *out) {
+    char kind[48];
+    snprintf(kind, sizeof(kind), "%s" REPORT_EXT, campusReports[p->campusType].suffix);
+    uint64_t dataVersion;
+    if (getUserDataVersion(p->userID, campusDataType(p->campusType), &dataVersion) == SUCCESS &&
+        reportCacheGet(p->userID, kind, reportVersion(p, dataVersion), &out->data, &out->length) == SUCCESS) {
+        return SUCCESS;
+    }
+
+    ReportLayout *layout = NULL;
+    uint64_t version = 0;
+    ErrorCode rc = prepareReport(p, &layout, &version);
+    if (rc != SUCCESS) return rc;
+    rc = renderReport(layout, out);
+    free(layout);
+    if (rc != SUCCESS) return rc;
+    reportCachePut(p->userID, kind, version, out->data, out->length);   // best effort
+    return SUCCESS;
+}
+
+ErrorCode writeCampusReport(const Profile *p, const char *dir, char *pathOut, size_t size) {
+    if (!p || !dir || !pathOut) return ERROR_INVALID_INPUT;
+    if (p->campusType <= CAMPUS_NONE || p->campusType >= CAMPUS_AMOUNT) return ERROR_INVALID_INPUT;
+    int written = snprintf(pathOut, size, "%s%s%s" REPORT_EXT, dir, p->userID, campusReports[p->campusType].suffix);
+    if (written < 0 || (size_t)written >= size) return ERROR_INVALID_INPUT;
+
+    ExportBuffer report = {0};
+    ErrorCode rc = reportBytes(p, &report);
+    if (rc != SUCCESS) return rc;
+
+    // Write beside the target and rename over it: readers see the old report
+    // or the new one, never a half-written file
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d.%u", pathOut, (int)getpid(), atomic_fetch_add(&reportSequence, 1));
+    FILE *f = fopen(tmp, "wb");
+    rc = f && fwrite(report.data, 1, report.length, f) == report.length ? SUCCESS : ERROR_FILE_IO;
+    if (f && fclose(f) != 0) rc = ERROR_FILE_IO;
+    freeExportBuffer(&report);
+    if (rc == SUCCESS) {
+#ifdef _WIN32
+        remove(pathOut);    // rename() does not replace on Windows
+#endif
+        if (rename(tmp, pathOut) != 0) rc = ERROR_FILE_IO;
+    }
+    if (rc != SUCCESS) {
+        remove(tmp);
+        return rc;
+    }
+    logEvent(p->userID, campusReports[p->campusType].logMessage);
+    return SUCCESS;
+}
+
+ErrorCode renderCampusReport(const Profile *p, ExportBuffer *out) {
+    if (!out) return ERROR_INVALID_INPUT;
+    memset(out, 0, sizeof(*out));
+    if (!p || p->campusType <= CAMPUS_NONE || p->campusType >= CAMPUS_AMOUNT) return ERROR_INVALID_INPUT;
+    snprintf(out->name, sizeof(out->name), "%s%s" REPORT_EXT, p->userID, campusReports[p->campusType].suffix);
+    out->contentType = REPORT_CONTENT_TYPE;
+
+    ErrorCode rc = reportBytes(p, out);
+    if (rc != SUCCESS) return rc;
+    logEvent(p->userID, campusReports[p->campusType].logMessage);
+    return SUCCESS;
+}
+
+void freeExportBuffer(ExportBuffer *buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+}
+
+ErrorCode exportCampusReport(const char *userID, char *pathOut, size_t size) {
+    Profile p = {0};
+    if (!userID || !pathOut) return ERROR_INVALID_INPUT;
+    if (!getUserByID(userID, &p)) return ERROR_NOT_FOUND;
+    return writeCampusReport(&p, DATA_DIR, pathOut, size);
+}
@@ -3,15 +3,21 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
 #ifdef _WIN32
 #include <direct.h>
+#else
+#include <sys/stat.h>
 #endif
 #include "../include/utils.h"
+#include "../include/logger.h"
+#include "../include/audit_segment.h"
 #include "../include/config.h"
 #include "../include/student.h"
 #include "../include/ui.h"
 #include "../include/fileio.h"
 #include "../include/auth.h"
+#include "../include/campus_security.h"
 #include "../include/hpdf/hpdf.h"
 
 // Helper: build extension from studentID initials
@@ -38,32 +44,55 @@ ErrorCode getProfilePath(char *path, const char *userID) {
     return SUCCESS;
 }
 
-// Logging function
-ErrorCode logEvent(const char *userID, const char *action) {
-    if (!userID || !action) return ERROR_INVALID_INPUT;
+// Synchronous fallback used when the background logger cannot start
+static ErrorCode writeEventSync(const char *userID, const char *action) {
 #ifdef _WIN32
     _mkdir("logs");
 #else
     mkdir("logs", 0700);
 #endif
-    FILE *log = fopen(LOG_DIR "login_audit.log", "a");
+    FILE *log = fopen(AUDIT_LOG_FILE, "a");
     if (!log) {
-        fprintf(stderr, "Logging failed for %s [%s]\n", action ? action : "UNKNOWN", userID ? userID : "UNKNOWN");
+        fprintf(stderr, "Logging failed for %s [%s]\n", action, userID);
         return ERROR_FILE_IO;
     }
     time_t now = time(NULL);
     char *timeStr = ctime(&now);
     if (timeStr) {
-        fprintf(log, "%s: %s at %s", action ? action : "UNKNOWN_ACTION", 
-                userID ? userID : "UNKNOWN_USER", timeStr);
+        fprintf(log, "%s: %s at %s", action, userID, timeStr);
     } else {
-        fprintf(log, "%s: %s at [time unavailable]\n", 
-                action ? action : "UNKNOWN_ACTION", userID ? userID : "UNKNOWN_USER");
+        fprintf(log, "%s: %s at [time unavailable]\n", action, userID);
     }
     fclose(log);
     return SUCCESS;
 }
 
+static pthread_once_t loggerOnce = PTHREAD_ONCE_INIT;
+
+static void stopDefaultLogger(void) {
+    loggerStop();
+}
+
+static void startDefaultLogger(void) {
+    LoggerConfig config = loggerDefaultConfig();
+    if (loggerStart(&config) == SUCCESS) {
+        atexit(stopDefaultLogger); // drain pending events on exit()
+    }
+}
+
+// Logging function: hands the event to the asynchronous ring-buffer logger
+ErrorCode logEvent(const char *userID, const char *action) {
+    if (!userID || !action) return ERROR_INVALID_INPUT;
+    if (auditIsOpen()) {
+        auditAppend(userID, 0, action);
+    }
+    pthread_once(&loggerOnce, startDefaultLogger);
+    if (loggerIsRunning()) {
+        return loggerSubmit(userID, action);
+    }
+    return writeEventSync(userID, action);
+}
+
 // Optional utility: sanitize filename (for backups etc.)
 ErrorCode sanitizeFilename(char *str) {
     if (!str) return ERROR_INVALID_INPUT;
@@ -135,7 +164,13 @@ void generateUserID(Profile *p) {
     }
     initials[2] = '\0';
     
-    int serial = rand() % 900 + 100;
+    // Not rand(): prefork workers inherit the same state and would pick the same serials
+    unsigned int r;
+    if (!randomBytes(&r, sizeof(r))) {
+        p->userID[0] = '\0';
+        return;
+    }
+    int serial = (int)(r % 900) + 100;
     int written = snprintf(p->userID, sizeof(p->userID), "%s25%d", initials, serial);
     if (written < 0 || written >= (int)sizeof(p->userID)) {
         p->userID[0] = '\0';
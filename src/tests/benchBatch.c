@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/database.h"
+#include "testHelpers.h"
+
+// Bulk read benchmark: per-record cost of getUserByID + loadUserData compared
+// with getUsersByIDs at batch sizes 1, 100 and 10,000.
+
+#define BENCH_USERS 10000
+
+static char ids[BENCH_USERS][20];
+static const char *idList[BENCH_USERS];
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Users bk00000..bk09999 with school marks; created once, reused by later runs
+static int seedUsers(void) {
+    for (int i = 0; i < BENCH_USERS; i++) {
+        snprintf(ids[i], sizeof(ids[i]), "bk%05d", i);
+        idList[i] = ids[i];
+    }
+    Profile p;
+    if (getUserByID(ids[BENCH_USERS - 1], &p)) return 1;
+
+    if (executeQuery("BEGIN;") != SUCCESS) return 0;
+    for (int i = 0; i < BENCH_USERS; i++) {
+        testProfile(&p, ids[i], "Bench School", "Load", CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Bench Student %d", i);
+        testNumberedSubjects(&p, 5);
+        testMobile(&p, '9', i);
+        if (createUser(&p) != SUCCESS) return 0;
+
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = p.dataCount;
+        for (int s = 0; s < m.count; s++) {
+            strcpy(m.subjects[s], p.dataFields[s]);
+            m.marks[s] = (i + s * 7) % 100;
+            m.fullMarks[s] = 100;
+        }
+        if (!saveUserData(ids[i], "SCHOOL_DATA", &m, sizeof(m))) return 0;
+    }
+    return executeQuery("COMMIT;") == SUCCESS;
+}
+
+static void runSingle(void) {
+    Profile p;
+    SchoolMarks m;
+    long checksum = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < BENCH_USERS; i++) {
+        size_t size = sizeof(m);
+        if (getUserByID(idList[i], &p) && loadUserData(idList[i], "SCHOOL_DATA", &m, &size)) {
+            checksum += m.marks[0];
+        }
+    }
+    double elapsed = nowSeconds() - start;
+    printf("single reads      : %8.2f us/record (checksum %ld)\n", elapsed * 1e6 / BENCH_USERS, checksum);
+}
+
+static void runBatch(size_t batch) {
+    UserRecord *recs = (UserRecord*)malloc(batch * sizeof(UserRecord));
+    long checksum = 0;
+    double start = nowSeconds();
+    for (size_t base = 0; base < BENCH_USERS; base += batch) {
+        size_t n = BENCH_USERS - base < batch ? BENCH_USERS - base : batch;
+        if (getUsersByIDs(idList + base, n, recs) != SUCCESS) break;
+        for (size_t i = 0; i < n; i++) {
+            if (recs[i].hasData) checksum += recs[i].data.school.marks[0];
+        }
+    }
+    double elapsed = nowSeconds() - start;
+    printf("batch of %-9zu: %8.2f us/record (checksum %ld)\n", batch, elapsed * 1e6 / BENCH_USERS, checksum);
+    free(recs);
+}
+
+int main(void) {
+    if (initDatabase() != SUCCESS) return 1;
+    printf("==== Bulk Read Benchmark (%d users) ====\n", BENCH_USERS);
+    if (!seedUsers()) {
+        printf("❌ could not seed benchmark users\n");
+        closeDatabase();
+        return 1;
+    }
+    runSingle();
+    size_t batches[] = { 1, 100, 10000 };
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) runBatch(batches[i]);
+    closeDatabase();
+    return 0;
+}
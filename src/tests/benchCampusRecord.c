@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/campus_unified.h"
+
+// Compact record benchmark: 100,000 synthetic records of mixed campus types,
+// held and written as fixed UnifiedCampusData structs compared with compact
+// records packed back to back. Reports memory, file bytes and write / read /
+// scan time for both.
+
+#define BENCH_RECORDS 100000
+#define BENCH_FILE    "bench_campus_records.tmp"
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Roughly the mix and field lengths real data files have
+static void synthesize(UnifiedCampusData *d, int i) {
+    static const CampusType types[] = { CAMPUS_SCHOOL, CAMPUS_SCHOOL, CAMPUS_COLLEGE, CAMPUS_COLLEGE,
+                                        CAMPUS_HOSPITAL, CAMPUS_HOSTEL };
+    memset(d, 0, sizeof(*d));
+    snprintf(d->userID, sizeof(d->userID), "bc%010d", i);
+    snprintf(d->name, sizeof(d->name), "Synthetic Student %d", i);
+    snprintf(d->instituteName, sizeof(d->instituteName), "Institute %d", i % 40);
+    snprintf(d->department, sizeof(d->department), "Department %d", i % 7);
+    d->campusType = types[i % 6];
+    d->lastUpdated = 1700000000 + i;
+    d->dataVersion = 1;
+    if (d->campusType == CAMPUS_SCHOOL || d->campusType == CAMPUS_COLLEGE) {
+        d->grades.subjectCount = 5 + i % 4;
+        for (int s = 0; s < d->grades.subjectCount; s++) {
+            snprintf(d->grades.subjects[s], sizeof(d->grades.subjects[s]), "Subject %d", s);
+            d->grades.marks[s] = (i + s * 13) % 101;
+            d->grades.weights[s] = d->campusType == CAMPUS_SCHOOL ? 100 : 2 + s % 3;
+        }
+    } else if (d->campusType == CAMPUS_HOSPITAL) {
+        strcpy(d->medical.bloodPressure, "120/80");
+        strcpy(d->medical.temperature, "98.4");
+        strcpy(d->medical.weight, "64");
+        strcpy(d->medical.diagnosis, "Routine check-up");
+    } else {
+        snprintf(d->hostel.roomNumber, sizeof(d->hostel.roomNumber), "R-%d", i % 500);
+        snprintf(d->hostel.floor, sizeof(d->hostel.floor), "%d", i % 5);
+        strcpy(d->hostel.messPlan, "Standard");
+    }
+}
+
+static double writeFile(const void *bytes, size_t length) {
+    double t = nowSeconds();
+    FILE *f = fopen(BENCH_FILE, "wb");
+    if (!f || fwrite(bytes, 1, length, f) != length) {
+        if (f) fclose(f);
+        return -1.0;
+    }
+    fflush(f);
+    fclose(f);
+    return nowSeconds() - t;
+}
+
+static double readFile(void *bytes, size_t length) {
+    double t = nowSeconds();
+    FILE *f = fopen(BENCH_FILE, "rb");
+    if (!f || fread(bytes, 1, length, f) != length) {
+        if (f) fclose(f);
+        return -1.0;
+    }
+    fclose(f);
+    return nowSeconds() - t;
+}
+
+int main() {
+    UnifiedCampusData *structs = malloc(sizeof(UnifiedCampusData) * BENCH_RECORDS);
+    unsigned char *packed = malloc((size_t)CAMPUS_RECORD_MAX * BENCH_RECORDS);
+    if (!structs || !packed) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < BENCH_RECORDS; i++) synthesize(&structs[i], i);
+
+    double t = nowSeconds();
+    size_t packedBytes = 0;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        size_t n = campusRecordEncode(&structs[i], packed + packedBytes, CAMPUS_RECORD_MAX);
+        if (n == 0) {
+            printf("Record %d did not encode\n", i);
+            return 1;
+        }
+        packedBytes += n;
+    }
+    double encodeSeconds = nowSeconds() - t;
+    size_t structBytes = sizeof(UnifiedCampusData) * BENCH_RECORDS;
+
+    printf("Campus records: %d synthetic records\n", BENCH_RECORDS);
+    printf("%-10s %12s %10s %10s %10s\n", "layout", "bytes", "B/record", "write ms", "read ms");
+
+    double structWrite = writeFile(structs, structBytes);
+    double structRead = readFile(structs, structBytes);
+    double packedWrite = writeFile(packed, packedBytes);
+    double packedRead = readFile(packed, packedBytes);
+    remove(BENCH_FILE);
+    if (structWrite < 0 || structRead < 0 || packedWrite < 0 || packedRead < 0) {
+        printf("File I/O failed\n");
+        return 1;
+    }
+    printf("%-10s %12zu %10zu %10.2f %10.2f\n", "struct", structBytes, sizeof(UnifiedCampusData),
+           structWrite * 1e3, structRead * 1e3);
+    printf("%-10s %12zu %10.1f %10.2f %10.2f\n", "compact", packedBytes, (double)packedBytes / BENCH_RECORDS,
+           packedWrite * 1e3, packedRead * 1e3);
+    printf("Compact is %.1f%% of the struct size; encoding took %.2f ms\n",
+           100.0 * (double)packedBytes / (double)structBytes, encodeSeconds * 1e3);
+
+    // Walking the packed records through views touches only their bytes
+    t = nowSeconds();
+    long markSum = 0;
+    size_t at = 0;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        CampusRecordView view;
+        if (campusRecordView(packed + at, packedBytes - at, &view) != SUCCESS) {
+            printf("Record %d did not parse\n", i);
+            return 1;
+        }
+        for (int s = 0; s < view.count; s++) markSum += view.marks[s];
+        at += view.length;
+    }
+    double viewSeconds = nowSeconds() - t;
+
+    t = nowSeconds();
+    long structSum = 0;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        const UnifiedCampusData *d = &structs[i];
+        if (d->campusType != CAMPUS_SCHOOL && d->campusType != CAMPUS_COLLEGE) continue;
+        for (int s = 0; s < d->grades.subjectCount; s++) structSum += d->grades.marks[s];
+    }
+    double structSeconds = nowSeconds() - t;
+    printf("Mark scan: views %.2f ms, structs %.2f ms (sums %s)\n", viewSeconds * 1e3, structSeconds * 1e3,
+           markSum == structSum ? "match" : "DIFFER");
+
+    free(structs);
+    free(packed);
+    return markSum == structSum ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../include/grade_kernel.h"
+
+// Grade kernel benchmark: one million students with six subjects, batch
+// kernel against the old one-student-at-a-time loop
+#define BENCH_STUDENTS 1000000
+#define BENCH_SUBJECTS 6
+#define BENCH_ROUNDS 20
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void) {
+    int *marks = malloc(sizeof(int) * MAX_SUBJECTS * BENCH_STUDENTS);
+    int *weights = malloc(sizeof(int) * MAX_SUBJECTS * BENCH_STUDENTS);
+    int *total = malloc(sizeof(int) * BENCH_STUDENTS);
+    int *weight = malloc(sizeof(int) * BENCH_STUDENTS);
+    float *score = malloc(sizeof(float) * BENCH_STUDENTS);
+    unsigned char *grade = malloc(BENCH_STUDENTS);
+    if (!marks || !weights || !total || !weight || !score || !grade) return 1;
+    for (size_t i = 0; i < (size_t)MAX_SUBJECTS * BENCH_STUDENTS; i++) {
+        marks[i] = (int)(i * 37 % 101);
+        weights[i] = 100;
+    }
+    printf("==== Grade Kernel Benchmark ====\n");
+
+    double start = now();
+    volatile float sink = 0.0f;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < BENCH_STUDENTS; i++) {
+            int t = 0, f = 0;
+            for (int s = 0; s < BENCH_SUBJECTS; s++) {
+                t += marks[(size_t)s * BENCH_STUDENTS + i];
+                f += weights[(size_t)s * BENCH_STUDENTS + i];
+            }
+            float p = f == 0 ? 0.0f : t * 100.0f / f;
+            grade[i] = p >= 90.0f ? 5 : p >= 80.0f ? 4 : p >= 70.0f ? 3 : p >= 60.0f ? 2 : p >= 50.0f ? 1 : 0;
+            sink += p;
+        }
+    }
+    double scalar = now() - start;
+
+    GradeBatch batch = { GRADE_SCALE_PERCENT, BENCH_STUDENTS, BENCH_STUDENTS, BENCH_SUBJECTS, marks, weights };
+    GradeResults out = { total, weight, score, grade };
+    start = now();
+    for (int r = 0; r < BENCH_ROUNDS; r++) gradeBatch(&batch, &out);
+    double batched = now() - start;
+
+    double n = (double)BENCH_STUDENTS * BENCH_ROUNDS;
+    printf("scalar loop:  %8.1f M students/s\n", n / scalar / 1e6);
+    printf("batch kernel: %8.1f M students/s  (%.1fx)\n", n / batched / 1e6, scalar / batched);
+    free(marks);
+    free(weights);
+    free(total);
+    free(weight);
+    free(score);
+    free(grade);
+    return 0;
+}
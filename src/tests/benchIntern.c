@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/intern.h"
+#include "../include/sqlite3.h"
+#include "testHelpers.h"
+
+// Interned names benchmark: N school students across 40 institutes, each with
+// five subjects of marks. Reports the stored size of the marks blobs against
+// the whole struct, the institute filter (listUsersByInstitute) per second,
+// and cached intern lookups per second from 1 and T threads. The students
+// are deleted at the end; their names stay in the strings table.
+//
+//   benchIntern [users] [threads]          default 20000, 4
+
+#define BENCH_USERS      20000
+#define BENCH_THREADS    4
+#define BENCH_INSTITUTES 40
+#define BENCH_LOOKUPS    1000000
+
+static char prefix[8];  // "ib" plus five pid digits
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void institute(char *out, size_t size, int i) {
+    snprintf(out, size, "Bench Institute %s %d", prefix, i % BENCH_INSTITUTES);
+}
+
+static int seed(int users) {
+    int failures = 0;
+    executeQuery("BEGIN;");
+    for (int i = 0; i < users; i++) {
+        Profile p;
+        char id[20], inst[MAX_LEN], dept[50];
+        snprintf(id, sizeof(id), "%s%06d", prefix, i);
+        institute(inst, sizeof(inst), i);
+        snprintf(dept, sizeof(dept), "Department %d", i % 7);
+        testProfile(&p, id, inst, dept, CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Bench Student %d", i);
+        testNumberedSubjects(&p, 5);
+        snprintf(p.mobile, sizeof(p.mobile), "7%s%04d", prefix + 2, i % 10000);
+        strcpy(p.passwordHash, "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");   // full-size hash, as signup stores
+        failures += createUser(&p) != SUCCESS;
+
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = 5;
+        for (int s = 0; s < 5; s++) {
+            strcpy(m.subjects[s], p.dataFields[s]);
+            m.marks[s] = (i + s * 13) % 101;
+            m.fullMarks[s] = 100;
+        }
+        failures += !saveUserData(p.userID, "SCHOOL_DATA", &m, sizeof(m));
+    }
+    executeQuery("COMMIT;");
+    return failures;
+}
+
+static double averageBlobBytes(void) {
+    sqlite3 *raw;
+    sqlite3_stmt *stmt;
+    double bytes = 0.0;
+    char pattern[20];
+    snprintf(pattern, sizeof(pattern), "%s%%", prefix);
+    if (sqlite3_open("data/campus.db", &raw) != SQLITE_OK) return 0.0;
+    if (sqlite3_prepare_v2(raw, "SELECT avg(length(blob_data)) FROM user_data WHERE user_id LIKE ?;",
+                           -1, &stmt, 0) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_STATIC);
+        if (sqlite3_step(stmt) == SQLITE_ROW) bytes = sqlite3_column_double(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+    return bytes;
+}
+
+static void *lookupWorker(void *arg) {
+    long *failures = (long*)arg;
+    char name[64];
+    for (long i = 0; i < BENCH_LOOKUPS; i++) {
+        uint32_t id;
+        institute(name, sizeof(name), (int)i);
+        *failures += internFind(name, &id) != SUCCESS;
+    }
+    return NULL;
+}
+
+static double lookups(int threads, long *failures) {
+    pthread_t workers[64];
+    long counts[64] = {0};
+    double t = nowSeconds();
+    for (int i = 0; i < threads; i++) pthread_create(&workers[i], NULL, lookupWorker, &counts[i]);
+    for (int i = 0; i < threads; i++) pthread_join(workers[i], NULL);
+    double seconds = nowSeconds() - t;
+    for (int i = 0; i < threads; i++) *failures += counts[i];
+    return (double)threads * BENCH_LOOKUPS / seconds;
+}
+
+int main(int argc, char **argv) {
+    int users = argc > 1 ? atoi(argv[1]) : BENCH_USERS;
+    int threads = argc > 2 ? atoi(argv[2]) : BENCH_THREADS;
+    if (users <= 0) users = BENCH_USERS;
+    if (threads <= 0 || threads > 64) threads = BENCH_THREADS;
+    snprintf(prefix, sizeof(prefix), "ib%05u", (unsigned)getpid() % 100000u);
+    if (initDatabase() != SUCCESS) {
+        printf("Database unavailable\n");
+        return 1;
+    }
+
+    printf("Interned names: %d users, %d institutes\n", users, BENCH_INSTITUTES);
+    long failures = seed(users);
+    printf("marks blob        %10.0f bytes (whole struct %zu)\n", averageBlobBytes(), sizeof(SchoolMarks));
+
+    double t = nowSeconds();
+    size_t listed = 0;
+    for (int i = 0; i < BENCH_INSTITUTES; i++) {
+        char name[64];
+        char (*ids)[20] = NULL;
+        size_t count = 0;
+        institute(name, sizeof(name), i);
+        failures += listUsersByInstitute(name, CAMPUS_SCHOOL, &ids, &count) != SUCCESS;
+        listed += count;
+        free(ids);
+    }
+    double list = nowSeconds() - t;
+    failures += listed != (size_t)users;
+    printf("institute filter  %10.0f queries/s (%.0f rows/s)\n", BENCH_INSTITUTES / list, listed / list);
+
+    printf("intern lookups    %10.0f /s on 1 thread\n", lookups(1, &failures));
+    printf("intern lookups    %10.0f /s on %d threads\n", lookups(threads, &failures), threads);
+    InternStats stats;
+    internGetStats(&stats);
+    printf("intern cache      %10zu names, %zu bytes\n", stats.strings, stats.bytes);
+
+    executeQuery("BEGIN;");
+    for (int i = 0; i < users; i++) {
+        char id[20];
+        snprintf(id, sizeof(id), "%s%06d", prefix, i);
+        failures += deleteUser(id) != SUCCESS;
+    }
+    executeQuery("COMMIT;");
+    closeDatabase();
+    if (failures) printf("FAILED (%ld)\n", failures);
+    return failures != 0;
+}
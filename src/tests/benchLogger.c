@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../include/logger.h"
+
+// Logger benchmark: events/second and per-call latency of the asynchronous
+// logger compared with the old open/append/close per event.
+
+#define BENCH_LOG_PATH  "bench_logger.log"
+#define BENCH_EVENTS    200000
+#define BENCH_SYNC_EVENTS 20000
+
+typedef struct {
+    int events;
+    double *latencies;
+} BenchWorker;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, size_t n, double p) {
+    if (n == 0) return 0.0;
+    size_t idx = (size_t)(p * (double)(n - 1));
+    return sorted[idx];
+}
+
+static void *benchWorker(void *arg) {
+    BenchWorker *w = (BenchWorker*)arg;
+    for (int i = 0; i < w->events; i++) {
+        double start = nowSeconds();
+        loggerSubmit("bl25001", "Viewed profile");
+        w->latencies[i] = nowSeconds() - start;
+    }
+    return NULL;
+}
+
+static void syncAppend(const char *userID, const char *action) {
+    FILE *log = fopen(BENCH_LOG_PATH, "a");
+    if (!log) return;
+    time_t now = time(NULL);
+    fprintf(log, "%s: %s at %s", action, userID, ctime(&now));
+    fclose(log);
+}
+
+static void runAsync(int threads, LogFullPolicy policy) {
+    remove(BENCH_LOG_PATH);
+    LoggerConfig config = loggerDefaultConfig();
+    config.path = BENCH_LOG_PATH;
+    config.maxFileBytes = 0;
+    config.policy = policy;
+    if (loggerStart(&config) != SUCCESS) {
+        printf("❌ logger failed to start\n");
+        return;
+    }
+
+    int perThread = BENCH_EVENTS / threads;
+    size_t total = (size_t)perThread * (size_t)threads;
+    double *latencies = (double*)malloc(total * sizeof(double));
+    BenchWorker *workers = (BenchWorker*)calloc((size_t)threads, sizeof(BenchWorker));
+    pthread_t *tids = (pthread_t*)calloc((size_t)threads, sizeof(pthread_t));
+
+    double start = nowSeconds();
+    for (int t = 0; t < threads; t++) {
+        workers[t].events = perThread;
+        workers[t].latencies = latencies + (size_t)t * (size_t)perThread;
+        pthread_create(&tids[t], NULL, benchWorker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    double submitted = nowSeconds() - start;
+    loggerFlush();
+    double drained = nowSeconds() - start;
+
+    LoggerStats stats;
+    loggerGetStats(&stats);
+    loggerStop();
+
+    qsort(latencies, total, sizeof(double), compareDouble);
+    printf("%-5s %2d threads: %10.0f events/s submitted, %10.0f events/s on disk, "
+           "p50 %6.2f us, p99 %7.2f us, max %8.2f us, dropped %llu\n",
+           policy == LOG_POLICY_BLOCK ? "block" : "drop", threads,
+           (double)total / submitted, (double)stats.written / drained,
+           percentile(latencies, total, 0.50) * 1e6,
+           percentile(latencies, total, 0.99) * 1e6,
+           latencies[total - 1] * 1e6, stats.dropped);
+
+    free(tids);
+    free(workers);
+    free(latencies);
+}
+
+static void runSync(void) {
+    remove(BENCH_LOG_PATH);
+    double *latencies = (double*)malloc(BENCH_SYNC_EVENTS * sizeof(double));
+    double start = nowSeconds();
+    for (int i = 0; i < BENCH_SYNC_EVENTS; i++) {
+        double t0 = nowSeconds();
+        syncAppend("bl25001", "Viewed profile");
+        latencies[i] = nowSeconds() - t0;
+    }
+    double elapsed = nowSeconds() - start;
+    qsort(latencies, BENCH_SYNC_EVENTS, sizeof(double), compareDouble);
+    printf("sync   1 thread : %10.0f events/s, p50 %6.2f us, p99 %7.2f us (legacy fopen/fclose per event)\n",
+           BENCH_SYNC_EVENTS / elapsed,
+           percentile(latencies, BENCH_SYNC_EVENTS, 0.50) * 1e6,
+           percentile(latencies, BENCH_SYNC_EVENTS, 0.99) * 1e6);
+    free(latencies);
+}
+
+int main() {
+    printf("==== Logger Benchmark ====\n");
+    runSync();
+    int threadCounts[] = {1, 2, 4, 8};
+    for (size_t i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); i++) {
+        runAsync(threadCounts[i], LOG_POLICY_BLOCK);
+        runAsync(threadCounts[i], LOG_POLICY_DROP);
+    }
+    remove(BENCH_LOG_PATH);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "../include/database.h"
+#include "../include/report_merge.h"
+#include "testHelpers.h"
+
+// Merged report benchmark: pages/second, output size and peak resident memory
+// for 1,000, 10,000 and 50,000 pages. Peak RSS should stay flat as pages grow.
+
+#define BENCH_USERS 50000
+#define BENCH_OUT DATA_DIR "bench_merged.pdf"
+
+static char ids[BENCH_USERS][20];
+
+static long peakRssKb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Users bm00000..bm49999 with school marks; created once, reused by later runs
+static int seedUsers(void) {
+    for (int i = 0; i < BENCH_USERS; i++) snprintf(ids[i], sizeof(ids[i]), "bm%05d", i);
+    Profile p;
+    if (getUserByID(ids[BENCH_USERS - 1], &p)) return 1;
+
+    if (executeQuery("BEGIN;") != SUCCESS) return 0;
+    for (int i = 0; i < BENCH_USERS; i++) {
+        testProfile(&p, ids[i], "Bench Merge School", "Load", CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Merged Student %d", i);
+        testNumberedSubjects(&p, 6);
+        testMobile(&p, '4', i);
+        if (createUser(&p) != SUCCESS) return 0;
+
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = p.dataCount;
+        for (int s = 0; s < m.count; s++) {
+            strcpy(m.subjects[s], p.dataFields[s]);
+            m.marks[s] = (i * 31 + s * 7) % 100;
+            m.fullMarks[s] = 100;
+        }
+        if (!saveUserData(ids[i], "SCHOOL_DATA", &m, sizeof(m))) return 0;
+    }
+    return executeQuery("COMMIT;") == SUCCESS;
+}
+
+int main(void) {
+    if (initDatabase() != SUCCESS) return 1;
+    printf("==== Merged Report Benchmark ====\n");
+    if (!seedUsers()) {
+        printf("❌ could not seed benchmark users\n");
+        closeDatabase();
+        return 1;
+    }
+    printf("peak RSS before: %ld KB\n", peakRssKb());
+
+    size_t sizes[] = { 1000, 10000, 50000 };
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        for (int order = REPORT_ORDER_ID; order <= REPORT_ORDER_RANK; order++) {
+            MergedReportStats stats;
+            if (writeMergedReport((const char (*)[20])ids, sizes[k], (ReportOrder)order, BENCH_OUT, &stats) != SUCCESS) {
+                printf("❌ merged report of %zu pages failed\n", sizes[k]);
+                closeDatabase();
+                return 1;
+            }
+            printf("%6zu pages (%s): %8.1f pages/s  %7.2f MB  %6.2f s  peak RSS %ld KB\n",
+                   stats.pages, order == REPORT_ORDER_RANK ? "rank" : "id",
+                   stats.seconds > 0 ? stats.pages / stats.seconds : 0.0,
+                   stats.bytes / (1024.0 * 1024.0), stats.seconds, peakRssKb());
+        }
+    }
+    remove(BENCH_OUT);
+    closeDatabase();
+    return 0;
+}
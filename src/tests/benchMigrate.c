@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/database.h"
+#include "../include/campus_unified.h"
+#include "../include/utils.h"
+#include "../include/migrate.h"
+#include "testHelpers.h"
+
+// Legacy migration benchmark: a synthetic installation of N users, each with
+// a credentials/*.pfx profile and a data/<id>.data record (2N files),
+// migrated into data/campus.db and the campus store. Reports files per second
+// at 1 thread and at the default thread count; the second run uses `restart`,
+// so it reads every file again and finds the rows present. Rows and records
+// are left in place.
+//
+//   benchMigrate [users]                   default 100000 (200,000 files)
+
+#define BENCH_USERS 100000
+
+static char root[64], credDir[96], dataDir[96], prefix[8];
+
+static void removeTree(const char *path) {
+    DIR *d = opendir(path);
+    struct dirent *ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        if (remove(child) != 0) removeTree(child);
+    }
+    if (d) closedir(d);
+    rmdir(path);
+}
+
+static int writeFile(const char *dir, const char *name, const void *bytes, size_t length) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    int ok = fwrite(bytes, 1, length, f) == length;
+    fclose(f);
+    return ok;
+}
+
+static int synthesize(int i) {
+    Profile p;
+    char id[20], inst[MAX_LEN];
+    snprintf(id, sizeof(id), "%s%07d", prefix, i);
+    snprintf(inst, sizeof(inst), "Institute %d", i % 40);
+    testProfile(&p, id, inst, "Science", CAMPUS_SCHOOL);
+    snprintf(p.name, sizeof(p.name), "Legacy Student %d", i);
+    testNumberedSubjects(&p, 5);
+    testMobile(&p, '9', i);
+    strcpy(p.passwordHash, "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");   // full-size hash, as signup stores
+    char path[150];
+    if (getProfilePath(path, p.userID) != SUCCESS) return 0;
+    if (!writeFile(credDir, path + strlen(CRED_DIR), &p, sizeof(p))) return 0;
+
+    UnifiedCampusData d;
+    memset(&d, 0, sizeof(d));
+    strcpy(d.userID, p.userID);
+    strcpy(d.name, p.name);
+    strcpy(d.instituteName, p.instituteName);
+    strcpy(d.department, p.department);
+    d.campusType = CAMPUS_SCHOOL;
+    d.lastUpdated = 1600000000 + i;
+    d.grades.subjectCount = 5;
+    for (int s = 0; s < 5; s++) {
+        strcpy(d.grades.subjects[s], p.dataFields[s]);
+        d.grades.marks[s] = (i + s * 13) % 101;
+        d.grades.weights[s] = 100;
+    }
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t length = campusRecordEncode(&d, record, sizeof(record));
+    char name[64];
+    snprintf(name, sizeof(name), "%s.data", d.userID);
+    return length > 0 && writeFile(dataDir, name, record, length);
+}
+
+static int run(int threads, int restart, int users) {
+    MigrateOptions options = migrateDefaultOptions();
+    options.threads = threads;
+    options.restart = restart;
+    options.credentialsDir = credDir;
+    options.dataDir = dataDir;
+    MigrateStats stats;
+    ErrorCode rc = runLegacyMigration(&options, &stats);
+    printf("%-8d %10zu %10zu %10zu %10.2f %12.0f %s\n", stats.threads, stats.files, stats.profiles + stats.records,
+           stats.present, stats.seconds, stats.perSecond,
+           rc == SUCCESS && stats.invalid == 0 && stats.files == 2 * (size_t)users ? "" : "FAILED");
+    return rc != SUCCESS || stats.invalid != 0;
+}
+
+int main(int argc, char **argv) {
+    int users = argc > 1 ? atoi(argv[1]) : BENCH_USERS;
+    if (users <= 0) users = BENCH_USERS;
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(prefix, sizeof(prefix), "bm%05u", tag);
+    snprintf(root, sizeof(root), DATA_DIR "bench_migrate_%u", tag);
+    snprintf(credDir, sizeof(credDir), "%s/credentials/", root);
+    snprintf(dataDir, sizeof(dataDir), "%s/data/", root);
+    if (initDatabase() != SUCCESS) {
+        printf("Database unavailable\n");
+        return 1;
+    }
+    mkdir(root, 0700);
+    mkdir(credDir, 0700);
+    mkdir(dataDir, 0700);
+
+    printf("Legacy migration: %d users, %d files\n", users, 2 * users);
+    for (int i = 0; i < users; i++) {
+        if (!synthesize(i)) {
+            printf("Could not write legacy files\n");
+            removeTree(root);
+            return 1;
+        }
+    }
+    printf("%-8s %10s %10s %10s %10s %12s\n", "threads", "files", "added", "present", "seconds", "files/s");
+    int failed = run(1, 0, users);
+    failed |= run(0, 1, users);
+
+    closeDatabase();
+    removeTree(root);
+    return failed;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/report_run.h"
+#include "testHelpers.h"
+
+// Whole-institute report benchmark: reports/second for 1, 2, 4 ... threads up
+// to the number of online CPUs (or argv[1]), over the same 2,000 school users.
+
+#define BENCH_USERS 2000
+#define BENCH_INSTITUTE "Bench Report School"
+#define BENCH_OUT_DIR DATA_DIR "bench_reports/"
+
+// Users br00000..br01999 with school marks; created once, reused by later runs
+static int seedUsers(void) {
+    Profile p;
+    if (getUserByID("br01999", &p)) return 1;
+
+    if (executeQuery("BEGIN;") != SUCCESS) return 0;
+    for (int i = 0; i < BENCH_USERS; i++) {
+        char id[20];
+        snprintf(id, sizeof(id), "br%05d", i);
+        testProfile(&p, id, BENCH_INSTITUTE, "Load", CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Report Student %d", i);
+        testNumberedSubjects(&p, 8);
+        testMobile(&p, '8', i);
+        if (createUser(&p) != SUCCESS) return 0;
+
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = p.dataCount;
+        for (int s = 0; s < m.count; s++) {
+            strcpy(m.subjects[s], p.dataFields[s]);
+            m.marks[s] = (i + s * 7) % 100;
+            m.fullMarks[s] = 100;
+        }
+        if (!saveUserData(p.userID, "SCHOOL_DATA", &m, sizeof(m))) return 0;
+    }
+    return executeQuery("COMMIT;") == SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int maxThreads = argc > 1 ? atoi(argv[1]) : (int)(cpus > 0 ? cpus : 4);
+    if (maxThreads < 1) maxThreads = 1;
+    if (maxThreads > REPORT_MAX_THREADS) maxThreads = REPORT_MAX_THREADS;
+
+    if (initDatabase() != SUCCESS) return 1;
+    printf("==== Report Run Benchmark (%d users, %ld CPUs) ====\n", BENCH_USERS, cpus);
+    if (!seedUsers()) {
+        printf("❌ could not seed benchmark users\n");
+        closeDatabase();
+        return 1;
+    }
+
+    ReportRunOptions options = reportRunDefaultOptions();
+    options.outDir = BENCH_OUT_DIR;
+    ReportRunStats stats;
+    runInstituteReports(BENCH_INSTITUTE, CAMPUS_SCHOOL, &options, &stats);    // warm the page cache
+
+    double base = 0;
+    for (int threads = 1;; threads = threads * 2 > maxThreads && threads < maxThreads ? maxThreads : threads * 2) {
+        options.threads = threads;
+        if (runInstituteReports(BENCH_INSTITUTE, CAMPUS_SCHOOL, &options, &stats) != SUCCESS) {
+            printf("❌ run with %d threads failed (%zu failures)\n", threads, stats.failed);
+            break;
+        }
+        double rate = stats.seconds > 0 ? stats.written / stats.seconds : 0.0;
+        if (threads == 1) base = rate;
+        printf("%3d threads: %9.1f reports/s  speedup %5.2fx  steals %zu\n",
+               threads, rate, base > 0 ? rate / base : 0.0, stats.steals);
+        if (threads >= maxThreads) break;
+    }
+    closeDatabase();
+    return 0;
+}
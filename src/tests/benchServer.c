@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/un.h>
+#include "../include/database.h"
+#include "../include/api/server.h"
+
+// Server benchmark: requests/second and round-trip latency percentiles for
+// N client connections, each keeping `depth` requests pipelined.
+// Usage: benchServer [--unix PATH | --processes N]
+//   default: in-process server; --processes: forked prefork server with N workers
+
+#define BENCH_SOCKET    "bench_server.sock"
+#define BENCH_SECONDS   3.0
+#define BENCH_MAX_DEPTH 32
+
+typedef struct {
+    const char *path;
+    const char *request;    // one line, including '\n'
+    int depth;
+    double deadline;
+    double *latencies;
+    size_t capacity;
+    size_t count;
+} BenchClient;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, size_t n, double p) {
+    if (n == 0) return 0.0;
+    size_t idx = (size_t)(p * (double)(n - 1));
+    return sorted[idx];
+}
+
+static int connectTo(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int sendAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) return 0;
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// Single request/response for setup; response copied into `line`
+static int roundTrip(int fd, const char *request, char *line, size_t size) {
+    if (!sendAll(fd, request, strlen(request))) return 0;
+    size_t len = 0;
+    while (len + 1 < size) {
+        ssize_t n = read(fd, line + len, 1);
+        if (n <= 0) return 0;
+        if (line[len] == '\n') break;
+        len++;
+    }
+    line[len] = '\0';
+    return 1;
+}
+
+static void *clientMain(void *arg) {
+    BenchClient *c = (BenchClient*)arg;
+    int fd = connectTo(c->path);
+    if (fd < 0) return NULL;
+    size_t reqLen = strlen(c->request);
+    double sentAt[BENCH_MAX_DEPTH];
+    int head = 0, outstanding = 0;
+    char buf[65536];
+
+    while (c->count < c->capacity) {
+        double now = nowSeconds();
+        // Keep the pipe full until the deadline, then drain
+        while (outstanding < c->depth && now < c->deadline) {
+            if (!sendAll(fd, c->request, reqLen)) goto done;
+            sentAt[(head + outstanding) % BENCH_MAX_DEPTH] = now;
+            outstanding++;
+        }
+        if (outstanding == 0) break;
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        now = nowSeconds();
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != '\n') continue;
+            if (c->count < c->capacity) c->latencies[c->count++] = now - sentAt[head];
+            head = (head + 1) % BENCH_MAX_DEPTH;
+            outstanding--;
+        }
+    }
+done:
+    close(fd);
+    return NULL;
+}
+
+static void runLoad(const char *path, const char *label, const char *request, int clients, int depth) {
+    BenchClient *workers = (BenchClient*)calloc((size_t)clients, sizeof(BenchClient));
+    pthread_t *tids = (pthread_t*)calloc((size_t)clients, sizeof(pthread_t));
+    double start = nowSeconds();
+    for (int t = 0; t < clients; t++) {
+        workers[t].path = path;
+        workers[t].request = request;
+        workers[t].depth = depth;
+        workers[t].deadline = start + BENCH_SECONDS;
+        workers[t].capacity = 2000000;
+        workers[t].latencies = (double*)malloc(workers[t].capacity * sizeof(double));
+        pthread_create(&tids[t], NULL, clientMain, &workers[t]);
+    }
+    size_t total = 0;
+    for (int t = 0; t < clients; t++) {
+        pthread_join(tids[t], NULL);
+        total += workers[t].count;
+    }
+    double elapsed = nowSeconds() - start;
+
+    double *all = (double*)malloc((total ? total : 1) * sizeof(double));
+    size_t k = 0;
+    for (int t = 0; t < clients; t++) {
+        memcpy(all + k, workers[t].latencies, workers[t].count * sizeof(double));
+        k += workers[t].count;
+        free(workers[t].latencies);
+    }
+    qsort(all, total, sizeof(double), compareDouble);
+    printf("%-8s %3d conns x depth %2d: %9.0f req/s, p50 %7.1f us, p90 %7.1f us, p99 %8.1f us, p99.9 %8.1f us\n",
+           label, clients, depth, (double)total / elapsed,
+           percentile(all, total, 0.50) * 1e6, percentile(all, total, 0.90) * 1e6,
+           percentile(all, total, 0.99) * 1e6, percentile(all, total, 0.999) * 1e6);
+    free(all);
+    free(tids);
+    free(workers);
+}
+
+// signup -> signin -> OTP from the data dir -> session token
+static int createSessionToken(const char *path, char *token, size_t size) {
+    char line[4096], req[1024], userID[32] = "", ticket[64] = "", otp[7] = "";
+    unsigned tag = (unsigned)getpid() % 100000u;
+    int fd = connectTo(path);
+    if (fd < 0) return 0;
+
+    snprintf(req, sizeof(req),
+             "{\"op\":\"signup\",\"campus\":\"school\",\"name\":\"Bench User\",\"institute\":\"Bench School\","
+             "\"department\":\"Load\",\"fields\":[\"Math\"],\"email\":\"bench%u@example.com\","
+             "\"mobile\":\"8%09u\",\"password\":\"Bench!Pass1\"}\n", tag, tag * 3u);
+    const char *p;
+    if (!roundTrip(fd, req, line, sizeof(line)) || !(p = strstr(line, "\"userID\":\""))) goto fail;
+    sscanf(p + 10, "%31[^\"]", userID);
+
+    snprintf(req, sizeof(req), "{\"op\":\"signin\",\"user\":\"%s\",\"mobile\":\"8%09u\",\"password\":\"Bench!Pass1\"}\n",
+             userID, tag * 3u);
+    if (!roundTrip(fd, req, line, sizeof(line)) || !(p = strstr(line, "\"ticket\":\""))) goto fail;
+    sscanf(p + 10, "%63[^\"]", ticket);
+
+    snprintf(req, sizeof(req), "data/%s_otp.dat", userID);
+    FILE *f = fopen(req, "rb");
+    if (!f || fread(otp, 1, 6, f) != 6) {
+        if (f) fclose(f);
+        goto fail;
+    }
+    fclose(f);
+
+    snprintf(req, sizeof(req), "{\"op\":\"verify_otp\",\"ticket\":\"%s\",\"otp\":\"%s\"}\n", ticket, otp);
+    if (!roundTrip(fd, req, line, sizeof(line)) || !(p = strstr(line, "\"token\":\""))) goto fail;
+    snprintf(token, size, "%.*s", 32, p + 9);
+    close(fd);
+    return 1;
+fail:
+    close(fd);
+    return 0;
+}
+
+static void *serverMain(void *arg) {
+    serverRun((const ServerConfig*)arg);
+    return NULL;
+}
+
+static ErrorCode startPreforkWorker(int index) {
+    (void)index;
+    return initDatabase();
+}
+
+static void stopPreforkWorker(void) {
+    closeDatabase();
+}
+
+static void onStopSignal(int sig) {
+    (void)sig;
+    serverStop();
+}
+
+// Prefork supervisor in a child process; returns its pid once the socket accepts
+static pid_t startPrefork(int processes) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        ServerConfig config = serverDefaultConfig();
+        config.unixPath = BENCH_SOCKET;
+        config.processes = processes;
+        config.processStart = startPreforkWorker;
+        config.processStop = stopPreforkWorker;
+        // The schema is created once before any fork; with 1 process it serves in place
+        if (initDatabase() != SUCCESS) exit(1);
+        if (processes > 1) closeDatabase();
+        signal(SIGTERM, onStopSignal);
+        exit(serverRun(&config) == SUCCESS ? 0 : 1);
+    }
+    for (int i = 0; pid > 0 && i < 300; i++) {
+        int fd = connectTo(BENCH_SOCKET);
+        if (fd >= 0) {
+            close(fd);
+            return pid;
+        }
+        usleep(10000);
+    }
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = BENCH_SOCKET;
+    int inProcess = 1, processes = 0;
+    pid_t supervisor = -1;
+    if (argc == 3 && strcmp(argv[1], "--unix") == 0) {
+        path = argv[2];
+        inProcess = 0;
+    } else if (argc == 3 && strcmp(argv[1], "--processes") == 0) {
+        processes = atoi(argv[2]);
+        inProcess = 0;
+        unlink(BENCH_SOCKET);
+        if (processes < 1 || (supervisor = startPrefork(processes)) < 0) {
+            printf("❌ prefork server failed to start\n");
+            return 1;
+        }
+    }
+
+    static ServerConfig config;
+    pthread_t serverThread;
+    if (inProcess) {
+        if (initDatabase() != SUCCESS) return 1;
+        config = serverDefaultConfig();
+        config.unixPath = BENCH_SOCKET;
+        pthread_create(&serverThread, NULL, serverMain, &config);
+        if (!serverWaitReady(2000)) {
+            printf("❌ server failed to start\n");
+            return 1;
+        }
+    }
+
+    if (processes) printf("==== Server Benchmark (%s, %d processes) ====\n", path, processes);
+    else printf("==== Server Benchmark (%s) ====\n", path);
+    static const char ping[] = "{\"op\":\"ping\"}\n";
+    int shapes[][2] = { {1, 1}, {1, 16}, {8, 1}, {8, 16}, {64, 4} };
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        runLoad(path, "ping", ping, shapes[i][0], shapes[i][1]);
+    }
+
+    char token[64], profile[128];
+    if (createSessionToken(path, token, sizeof(token))) {
+        snprintf(profile, sizeof(profile), "{\"op\":\"profile\",\"token\":\"%s\"}\n", token);
+        for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+            runLoad(path, "profile", profile, shapes[i][0], shapes[i][1]);
+        }
+    } else {
+        printf("profile: skipped (could not establish a session)\n");
+    }
+
+    if (supervisor > 0) {
+        kill(supervisor, SIGTERM);
+        waitpid(supervisor, NULL, 0);
+    }
+    if (inProcess) {
+        ServerStats stats;
+        serverGetStats(&stats);
+        serverStop();
+        pthread_join(serverThread, NULL);
+        closeDatabase();
+        printf("server: %llu connections, %llu requests, %llu responses\n",
+               stats.accepted, stats.requests, stats.responses);
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/storage_engine.h"
+#include "testHelpers.h"
+
+// Storage engine benchmark: the same workload on every engine. N users get a
+// profile and a campus record, then are read back, scanned and deleted.
+// Reports operations per second for each phase, so a deployment can choose an
+// engine on numbers rather than guesses. The sqlite engine runs against the
+// application database (data/campus.db); its rows are removed at the end.
+//
+//   benchStorage [users] [engine ...]       default 20000, all engines
+
+#define BENCH_USERS 20000
+#define BENCH_DIR   DATA_DIR "bench_storage"
+
+static char prefix[8];  // "sb" plus five pid digits
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void removeTree(const char *path) {
+    DIR *d = opendir(path);
+    struct dirent *ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        if (remove(child) != 0) removeTree(child);
+    }
+    if (d) closedir(d);
+    rmdir(path);
+}
+
+static void synthesize(int i, Profile *p, UnifiedCampusData *d) {
+    char id[20], inst[MAX_LEN], dept[50];
+    snprintf(id, sizeof(id), "%s%06d", prefix, i);
+    snprintf(inst, sizeof(inst), "Bench Institute %d", i % 40);
+    snprintf(dept, sizeof(dept), "Department %d", i % 7);
+    testProfile(p, id, inst, dept, CAMPUS_SCHOOL);
+    snprintf(p->name, sizeof(p->name), "Bench Student %d", i);
+    testNumberedSubjects(p, 5);
+    snprintf(p->mobile, sizeof(p->mobile), "8%s%04d", prefix + 2, i % 10000);
+    strcpy(p->passwordHash, "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");   // full-size hash, as signup stores
+
+    memset(d, 0, sizeof(*d));
+    strcpy(d->userID, p->userID);
+    strcpy(d->name, p->name);
+    strcpy(d->instituteName, p->instituteName);
+    strcpy(d->department, p->department);
+    d->campusType = CAMPUS_SCHOOL;
+    d->lastUpdated = 1700000000 + i;
+    d->dataVersion = 1;
+    d->grades.subjectCount = 5;
+    for (int s = 0; s < 5; s++) {
+        strcpy(d->grades.subjects[s], p->dataFields[s]);
+        d->grades.marks[s] = (i + s * 13) % 101;
+        d->grades.weights[s] = 100;
+    }
+}
+
+static int countProfile(const Profile *p, void *ctx) {
+    if (strncmp(p->userID, prefix, strlen(prefix)) == 0) (*(long*)ctx)++;
+    return 1;
+}
+
+static int sumMarks(const CampusRecordView *view, void *ctx) {
+    for (int s = 0; s < view->count; s++) *(long*)ctx += view->marks[s];
+    return 1;
+}
+
+static int runEngine(const char *name, int users) {
+    StorageEngine *engine;
+    removeTree(BENCH_DIR);
+    if (storageOpenByName(name, BENCH_DIR, &engine) != SUCCESS) {
+        printf("%-8s could not open\n", name);
+        return 1;
+    }
+    int sqlite = strcmp(name, "sqlite") == 0;
+    Profile p;
+    UnifiedCampusData d;
+    int failures = 0;
+
+    // One transaction for the sqlite writes, as a bulk load would use
+    double t = nowSeconds();
+    if (sqlite) executeQuery("BEGIN;");
+    for (int i = 0; i < users; i++) {
+        synthesize(i, &p, &d);
+        failures += storagePutProfile(engine, &p) != SUCCESS;
+        failures += storagePutRecord(engine, &d) != SUCCESS;
+    }
+    if (sqlite) executeQuery("COMMIT;");
+    double put = nowSeconds() - t;
+
+    t = nowSeconds();
+    for (int i = 0; i < users; i++) {
+        char id[20];
+        snprintf(id, sizeof(id), "%s%06d", prefix, (int)((i * 7919L) % users));
+        failures += storageGetProfile(engine, id, &p) != SUCCESS;
+        failures += storageGetRecord(engine, id, &d) != SUCCESS;
+    }
+    double get = nowSeconds() - t;
+
+    t = nowSeconds();
+    long profiles = 0, marks = 0;
+    storageScanProfiles(engine, countProfile, &profiles);
+    storageScanRecords(engine, sumMarks, &marks);
+    double scan = nowSeconds() - t;
+    failures += profiles != users;
+
+    t = nowSeconds();
+    if (sqlite) executeQuery("BEGIN;");
+    for (int i = 0; i < users; i++) {
+        char id[20];
+        snprintf(id, sizeof(id), "%s%06d", prefix, i);
+        failures += storageDeleteProfile(engine, id) != SUCCESS;
+    }
+    if (sqlite) executeQuery("COMMIT;");
+    double del = nowSeconds() - t;
+
+    storageClose(engine);
+    removeTree(BENCH_DIR);
+    printf("%-8s %12.0f %12.0f %12.0f %12.0f %s\n", name, 2.0 * users / put, 2.0 * users / get,
+           2.0 * users / scan, users / del, failures ? "FAILED" : "");
+    return failures != 0;
+}
+
+int main(int argc, char **argv) {
+    int users = argc > 1 ? atoi(argv[1]) : BENCH_USERS;
+    if (users <= 0) users = BENCH_USERS;
+    snprintf(prefix, sizeof(prefix), "sb%05u", (unsigned)getpid() % 100000u);
+    if (initDatabase() != SUCCESS) {
+        printf("Database unavailable\n");
+        return 1;
+    }
+
+    printf("Storage engines: %d users, profile + campus record each (ops/s)\n", users);
+    printf("%-8s %12s %12s %12s %12s\n", "engine", "put", "get", "scan", "delete");
+    const char *all[] = { "memory", "log", "sqlite" };
+    int failed = 0;
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) failed |= runEngine(argv[i], users);
+    } else {
+        for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) failed |= runEngine(all[i], users);
+    }
+    closeDatabase();
+    return failed;
+}
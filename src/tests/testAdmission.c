@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/api/admission.h"
+#include "../include/api/server.h"
+#include "../include/api/http.h"
+#include "../include/api/ui.h"
+
+#define TEST_SOCKET "test_admission.sock"
+
+static AdmitClassConfig testConfig(int maxLimit, int maxQueue) {
+    AdmitClassConfig c = admissionDefaultConfig(ADMIT_CLASS_FAST, 4);
+    c.maxLimit = maxLimit;
+    c.maxQueue = maxQueue;
+    c.deadlineMillis = 1000;
+    c.targetMillis = 5;
+    c.intervalMillis = 100;
+    return c;
+}
+
+static void initAll(AdmissionControl *ac, AdmitClassConfig c) {
+    AdmitClassConfig all[ADMIT_CLASS_COUNT] = { c, c, c };
+    admissionInit(ac, all);
+}
+
+// Admit and finish `n` requests that each took `micros`, all in flight together
+static void runBatch(AdmissionControl *ac, int n, uint64_t micros, uint64_t *now) {
+    for (int i = 0; i < n; i++) {
+        assert(admissionOffer(ac, ADMIT_CLASS_FAST));
+        assert(admissionPoll(ac, ADMIT_CLASS_FAST, 0, *now) == ADMIT_RUN);
+    }
+    for (int i = 0; i < n; i++) admissionFinish(ac, ADMIT_CLASS_FAST, micros);
+    *now += micros;
+}
+
+void test_queue_bound_and_deadline() {
+    AdmissionControl ac;
+    initAll(&ac, testConfig(1, 2));
+    assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    assert(!admissionOffer(&ac, ADMIT_CLASS_FAST));     // queue full: rejected at once
+    assert(ac.classes[ADMIT_CLASS_FAST].rejected == 1);
+
+    uint64_t now = 1000000;
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 0, now) == ADMIT_RUN);
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 500, now) == ADMIT_WAIT);   // limit 1 reached
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 1000001, now) == ADMIT_SHED);
+    assert(ac.classes[ADMIT_CLASS_FAST].queued == 0 && ac.classes[ADMIT_CLASS_FAST].shed == 1);
+    admissionFinish(&ac, ADMIT_CLASS_FAST, 100);
+    assert(ac.classes[ADMIT_CLASS_FAST].inflight == 0);
+
+    // Classes are independent
+    assert(admissionOffer(&ac, ADMIT_CLASS_EXPORT));
+    assert(admissionPoll(&ac, ADMIT_CLASS_EXPORT, 0, now) == ADMIT_RUN);
+    assert(ac.classes[ADMIT_CLASS_FAST].inflight == 0);
+    printf("✅ Queue bound and deadline: PASS\n");
+}
+
+void test_codel_standing_queue() {
+    AdmissionControl ac;
+    initAll(&ac, testConfig(4, 100));
+    uint64_t now = 1000000;
+
+    // A whole interval where even the shortest wait is above target
+    for (int i = 0; i < 10; i++) {
+        assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+        assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 20000, now) == ADMIT_RUN);
+        admissionFinish(&ac, ADMIT_CLASS_FAST, 1000);
+        now += 11000;
+    }
+    // The next interval starts overloaded: the timeout drops to the target
+    assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 20000, now) == ADMIT_SHED);
+    assert(ac.classes[ADMIT_CLASS_FAST].overloaded);
+    assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 1000, now) == ADMIT_RUN);
+    admissionFinish(&ac, ADMIT_CLASS_FAST, 1000);
+
+    // Once the queue drains below target the full deadline applies again
+    now += 101000;
+    assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    assert(admissionPoll(&ac, ADMIT_CLASS_FAST, 20000, now) == ADMIT_RUN);
+    assert(!ac.classes[ADMIT_CLASS_FAST].overloaded);
+    printf("✅ CoDel sheds only under a standing queue: PASS\n");
+}
+
+void test_gradient_limit() {
+    AdmissionControl ac;
+    initAll(&ac, testConfig(16, 1000));
+    uint64_t now = 1000000;
+    AdmitClassState *s = &ac.classes[ADMIT_CLASS_FAST];
+
+    for (int i = 0; i < 50; i++) runBatch(&ac, (int)s->limit, 1000, &now);
+    assert(s->limit == 16.0);       // steady latency: stays open
+
+    // Latency quadruples: the limit backs off until the long average catches up
+    double lowered = s->limit;
+    for (int i = 0; i < 20; i++) {
+        runBatch(&ac, (int)s->limit, 4000, &now);
+        if (s->limit < lowered) lowered = s->limit;
+    }
+    assert(lowered < 8.0);
+    assert(lowered >= s->config.minLimit);
+
+    // Latency recovers: the limit climbs back
+    for (int i = 0; i < 200; i++) runBatch(&ac, (int)s->limit, 1000, &now);
+    assert(s->limit > lowered * 1.5);
+
+    // Retry hint is bounded and grows with the backlog
+    unsigned idle = admissionRetryAfterMillis(&ac, ADMIT_CLASS_FAST);
+    for (int i = 0; i < 900; i++) assert(admissionOffer(&ac, ADMIT_CLASS_FAST));
+    s->shortMicros = 50000;
+    unsigned busy = admissionRetryAfterMillis(&ac, ADMIT_CLASS_FAST);
+    assert(idle >= 100 && busy > idle && busy <= 30000);
+    printf("✅ Gradient limit: %.1f under slowdown, %.1f after recovery: PASS\n", lowered, s->limit);
+}
+
+void test_overloaded_responses() {
+    JsonWriter w;
+    jwInit(&w);
+    static const char req[] = "{\"id\":7,\"op\":\"export\"}";
+    apiWriteOverloaded(req, strlen(req), 1500, &w);
+    jwRaw(&w, "", 1);
+    assert(strstr(w.data, "\"id\":7,"));
+    assert(strstr(w.data, "\"error\":\"OVERLOADED\""));
+    assert(strstr(w.data, "\"retryAfterMs\":1500"));
+    assert(apiRequestClass(req, strlen(req)) == ADMIT_CLASS_EXPORT);
+    assert(apiRequestClass("{\"op\":\"signin\"}", 15) == ADMIT_CLASS_AUTH);
+    assert(apiRequestClass("nonsense", 8) == ADMIT_CLASS_FAST);
+
+    jwReset(&w);
+    static const char http[] = "POST /api/export HTTP/1.1\r\nContent-Length: 0\r\n\r\n";
+    assert(httpRequestClass(http, strlen(http)) == ADMIT_CLASS_EXPORT);
+    httpWriteOverloaded(http, strlen(http), 1500, &w);
+    jwRaw(&w, "", 1);
+    assert(strncmp(w.data, "HTTP/1.1 503 ", 13) == 0);
+    assert(strstr(w.data, "Retry-After: 2\r\n"));
+    assert(!strstr(w.data, "Connection: close"));
+    assert(strstr(w.data, "\"error\":\"OVERLOADED\""));
+    jwFree(&w);
+    printf("✅ OVERLOADED responses: PASS\n");
+}
+
+// ---- Server integration ----
+
+static void slowHandler(const char *request, size_t length, JsonWriter *out) {
+    char text[256];
+    snprintf(text, sizeof(text), "%.*s", (int)length, request);
+    if (strstr(text, "\"export\"")) usleep(100000);
+    jwBeginObject(out);
+    jwKeyBool(out, "ok", 1);
+    jwEndObject(out);
+}
+
+static void *runServer(void *arg) {
+    assert(serverRun((ServerConfig*)arg) == SUCCESS);
+    return NULL;
+}
+
+static int connectClient(void) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, TEST_SOCKET);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    return fd;
+}
+
+// Reads `count` newline-terminated responses into `buf`
+static void readLines(int fd, char *buf, size_t size, int count) {
+    size_t len = 0;
+    int lines = 0;
+    while (lines < count) {
+        assert(len + 1 < size);
+        ssize_t n = read(fd, buf + len, size - len - 1);
+        assert(n > 0);
+        for (ssize_t i = 0; i < n; i++) lines += buf[len + (size_t)i] == '\n';
+        len += (size_t)n;
+    }
+    buf[len] = '\0';
+}
+
+static double nowMillis(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+void test_server_sheds_exports() {
+    static AdmitClassConfig admission[ADMIT_CLASS_COUNT];
+    for (int cls = 0; cls < ADMIT_CLASS_COUNT; cls++) admission[cls] = admissionDefaultConfig((AdmitClass)cls, 4);
+    admission[ADMIT_CLASS_EXPORT].maxLimit = 1;
+    admission[ADMIT_CLASS_EXPORT].maxQueue = 2;
+
+    static ServerConfig config;
+    config = serverDefaultConfig();
+    config.unixPath = TEST_SOCKET;
+    config.workers = 4;
+    config.handler = slowHandler;
+    config.admission = admission;
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, runServer, &config) == 0);
+    assert(serverWaitReady(2000));
+
+    // Ten exports at once: two queue (plus one more if a worker already took
+    // the first), the rest are refused in order
+    int exporter = connectClient();
+    static char batch[1024];
+    size_t len = 0;
+    for (int i = 0; i < 10; i++) {
+        len += (size_t)snprintf(batch + len, sizeof(batch) - len, "{\"id\":%d,\"op\":\"export\"}\n", i);
+    }
+    assert(write(exporter, batch, len) == (ssize_t)len);
+    usleep(20000);
+
+    // Pings are not stuck behind the exports
+    int pinger = connectClient();
+    char line[4096];
+    double start = nowMillis();
+    for (int i = 0; i < 20; i++) {
+        assert(write(pinger, "{\"op\":\"ping\"}\n", 14) == 14);
+        readLines(pinger, line, sizeof(line), 1);
+        assert(strstr(line, "\"ok\":true"));
+    }
+    double pingMillis = nowMillis() - start;
+    assert(pingMillis < 100.0);
+
+    static char replies[8192];
+    readLines(exporter, replies, sizeof(replies), 10);
+    int ok = 0, refused = 0;
+    for (char *p = replies; (p = strstr(p, "\"ok\":")); p += 5) ok += strncmp(p, "\"ok\":true", 9) == 0;
+    for (char *p = replies; (p = strstr(p, "OVERLOADED")); p++) refused++;
+    assert((ok == 2 || ok == 3) && ok + refused == 10);
+    assert(strstr(replies, "{\"id\":9,\"ok\":false,\"error\":\"OVERLOADED\""));
+    assert(strstr(replies, "\"retryAfterMs\":"));
+
+    // The connection survives a refusal
+    assert(write(exporter, "{\"op\":\"ping\"}\n", 14) == 14);
+    readLines(exporter, line, sizeof(line), 1);
+    assert(strstr(line, "\"ok\":true"));
+
+    ServerStats stats;
+    serverGetStats(&stats);
+    assert(stats.overloaded == (unsigned long long)refused && stats.protocolErrors == 0);
+    close(exporter);
+    close(pinger);
+    serverStop();
+    pthread_join(thread, NULL);
+    printf("✅ Server sheds exports, 20 pings in %.1f ms: PASS\n", pingMillis);
+}
+
+int main() {
+    test_queue_bound_and_deadline();
+    test_codel_standing_queue();
+    test_gradient_limit();
+    test_overloaded_responses();
+    test_server_sheds_exports();
+    printf("✅ All admission tests passed\n");
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/audit_events.h"
+
+void test_names_round_trip() {
+    for (int code = 0; code < EVENT_COUNT; code++) {
+        const char *name = auditEventName((AuditEvent)code);
+        assert(name && *name);
+        assert(auditEventFromName(name) == (AuditEvent)code);
+        assert(auditEventIsKnownName(name));
+    }
+    assert(strcmp(auditEventName(EVENT_LOGIN_SUCCESS), "LOGIN_SUCCESS") == 0);
+    assert(strcmp(auditEventName((AuditEvent)999), "NOTE") == 0);
+    printf("✅ audit event round trip: PASS (%d events)\n", EVENT_COUNT);
+}
+
+void test_unknown_names() {
+    assert(auditEventFromName(NULL) == EVENT_NOTE);
+    assert(auditEventFromName("") == EVENT_NOTE);
+    assert(auditEventFromName("LOGIN_SUCCES") == EVENT_NOTE);
+    assert(auditEventFromName("login_success") == EVENT_NOTE);
+    assert(!auditEventIsKnownName("PASSWORD_CHANGED"));
+    printf("✅ audit event unknown names: PASS\n");
+}
+
+void test_seed_is_perfect() {
+    // A stale seed still works (runtime search) but should be updated in audit_events.h
+    assert(auditEventHashSeed() == AUDIT_EVENT_HASH_SEED);
+    printf("✅ audit event perfect hash seed: PASS\n");
+}
+
+int main() {
+    printf("==== Audit Event Registry Tests ====\n");
+    test_names_round_trip();
+    test_unknown_names();
+    test_seed_is_perfect();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdint.h>
+#include "../include/audit_segment.h"
+
+#define TEST_AUDIT_DIR  "test_audit"
+#define TEST_USERS      10
+#define TEST_RECORDS    1000
+
+typedef struct {
+    int count;
+    uint64_t minSeen;
+    uint64_t maxSeen;
+} CountCtx;
+
+static int countVisitor(const AuditRecord *rec, void *ctx) {
+    CountCtx *c = (CountCtx*)ctx;
+    if (c->count == 0 || rec->epochMicros < c->minSeen) c->minSeen = rec->epochMicros;
+    if (rec->epochMicros > c->maxSeen) c->maxSeen = rec->epochMicros;
+    c->count++;
+    return 1;
+}
+
+static void cleanDir(void) {
+    char path[128];
+    for (int i = 1; i < 10; i++) {
+        snprintf(path, sizeof(path), TEST_AUDIT_DIR "/audit_%06d.seg", i);
+        remove(path);
+        snprintf(path, sizeof(path), TEST_AUDIT_DIR "/audit_%06d.idx", i);
+        remove(path);
+    }
+}
+
+static uint64_t stamps[TEST_RECORDS];
+
+void test_append_and_query_by_user() {
+    cleanDir();
+    assert(auditOpen(TEST_AUDIT_DIR) == SUCCESS);
+    char user[20];
+    for (int i = 0; i < TEST_RECORDS; i++) {
+        snprintf(user, sizeof(user), "au25%03d", i % TEST_USERS);
+        stamps[i] = auditNowMicros();
+        assert(auditAppend(user, EVENT_LOGIN_SUCCESS, "User authenticated") == SUCCESS);
+    }
+
+    CountCtx ctx = {0};
+    AuditQueryStats stats;
+    assert(auditQuery(TEST_AUDIT_DIR, "au25003", 0, UINT64_MAX, countVisitor, &ctx, &stats) == SUCCESS);
+    assert(ctx.count == TEST_RECORDS / TEST_USERS);
+    printf("✅ audit query by user: PASS (%d records, %lu blocks scanned)\n", ctx.count, stats.blocksScanned);
+}
+
+void test_time_range_skips_blocks() {
+    // Second half of the records only
+    uint64_t from = stamps[TEST_RECORDS / 2];
+    CountCtx ctx = {0};
+    AuditQueryStats stats;
+    assert(auditQuery(TEST_AUDIT_DIR, NULL, from, UINT64_MAX, countVisitor, &ctx, &stats) == SUCCESS);
+    assert(ctx.count >= TEST_RECORDS / 2);
+    assert(ctx.minSeen >= from);
+    assert(stats.blocksSkipped > 0);
+    printf("✅ audit time range: PASS (%d records, %lu blocks skipped)\n", ctx.count, stats.blocksSkipped);
+}
+
+void test_reopen_resumes_open_block() {
+    assert(auditClose() == SUCCESS);
+    assert(auditOpen(TEST_AUDIT_DIR) == SUCCESS);
+    assert(auditAppend("au25999", EVENT_DATA_SAVED, "SCHOOL_DATA") == SUCCESS);
+    assert(auditClose() == SUCCESS);
+
+    CountCtx all = {0};
+    assert(auditQuery(TEST_AUDIT_DIR, NULL, 0, UINT64_MAX, countVisitor, &all, NULL) == SUCCESS);
+    assert(all.count == TEST_RECORDS + 1);
+
+    CountCtx one = {0};
+    assert(auditQuery(TEST_AUDIT_DIR, "au25999", 0, UINT64_MAX, countVisitor, &one, NULL) == SUCCESS);
+    assert(one.count == 1);
+    printf("✅ audit reopen: PASS (%d records total)\n", all.count);
+}
+
+void test_ndjson_export() {
+    FILE *out = tmpfile();
+    assert(out);
+    assert(auditExportNDJSON(out, TEST_AUDIT_DIR, "au25999", 0, UINT64_MAX) == SUCCESS);
+    rewind(out);
+    char line[512] = {0};
+    assert(fgets(line, sizeof(line), out));
+    assert(strstr(line, "\"user\":\"au25999\""));
+    assert(strstr(line, "\"event\":\"DATA_SAVED\""));
+    assert(strstr(line, "\"details\":\"SCHOOL_DATA\""));
+    fclose(out);
+    printf("✅ audit NDJSON export: PASS\n");
+    cleanDir();
+}
+
+int main() {
+    printf("==== Audit Segment Tests ====\n");
+    test_append_and_query_by_user();
+    test_time_range_skips_blocks();
+    test_reopen_resumes_open_block();
+    test_ndjson_export();
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/api/batch.h"
+
+static unsigned tag;
+static char output[1 << 16];
+
+// Runs `script` and leaves the result lines in `output`
+static ErrorCode runScript(const char *script, const BatchOptions *options, BatchStats *stats) {
+    FILE *in = tmpfile(), *out = tmpfile();
+    assert(in && out);
+    fputs(script, in);
+    rewind(in);
+    ErrorCode rc = batchRun(in, out, options, stats);
+    rewind(out);
+    size_t n = fread(output, 1, sizeof(output) - 1, out);
+    output[n] = '\0';
+    fclose(in);
+    fclose(out);
+    return rc;
+}
+
+static int countLines(const char *text) {
+    int lines = 0;
+    for (; *text; text++) lines += *text == '\n';
+    return lines;
+}
+
+// Pulls line `index` (0-based) of `output` into `line`
+static void outputLine(int index, char *line, size_t size) {
+    const char *p = output;
+    for (int i = 0; i < index; i++) {
+        p = strchr(p, '\n');
+        assert(p);
+        p++;
+    }
+    size_t len = strcspn(p, "\n");
+    assert(len < size);
+    memcpy(line, p, len);
+    line[len] = '\0';
+}
+
+static void signupLine(char *buf, size_t size, const char *as, unsigned n) {
+    snprintf(buf, size,
+             "{\"id\":\"%s\",\"op\":\"signup\",\"as\":\"%s\",\"campus\":\"school\",\"name\":\"Batch %s\","
+             "\"institute\":\"Batch School\",\"department\":\"Term 1\",\"fields\":[\"Math\",\"Physics\"],"
+             "\"email\":\"batch%u_%u@example.com\",\"mobile\":\"7%09u\",\"password\":\"Batch!Pass1\"}\n",
+             as, as, as, tag, n, tag * 10u + n);
+}
+
+void test_script() {
+    char script[4096], line[1024];
+    size_t len = 0;
+    len += (size_t)snprintf(script + len, sizeof(script) - len, "# term load\n\n");
+    signupLine(script + len, sizeof(script) - len, "alice", 1);
+    len += strlen(script + len);
+    len += (size_t)snprintf(script + len, sizeof(script) - len,
+        "{\"id\":2,\"op\":\"data_put\",\"user\":\"$alice\",\"marks\":[70,90],\"fullMarks\":[100,100]}\n"
+        "{\"id\":3,\"op\":\"data_get\",\"user\":\"$alice\"}\r\n"
+        "   {\"id\":4,\"op\":\"data_put\",\"user\":\"$bob\",\"marks\":[1,2],\"fullMarks\":[100,100]}\n"
+        "{\"id\":5,\"op\":\"profile\"}\n"
+        "{\"id\":6,\"op\":\"export\",\"user\":\"$alice\",\"kind\":\"profile\",\"format\":\"csv\"}\n");
+
+    BatchStats stats;
+    assert(runScript(script, NULL, &stats) == ERROR_NOT_FOUND);    // first failure wins
+    assert(countLines(output) == 6);
+    outputLine(0, line, sizeof(line));
+    assert(strstr(line, "{\"id\":\"alice\",\"userID\":\"") == line && strstr(line, "\"ok\":true"));
+    outputLine(1, line, sizeof(line));
+    assert(strcmp(line, "{\"id\":2,\"ok\":true}") == 0);
+    outputLine(2, line, sizeof(line));
+    assert(strstr(line, "\"total\":160"));
+    outputLine(3, line, sizeof(line));
+    assert(strstr(line, "{\"id\":4,\"ok\":false,\"error\":\"NOT_FOUND\"") == line);
+    outputLine(4, line, sizeof(line));
+    assert(strstr(line, "\"error\":\"AUTH_FAILED\""));      // no user, no token
+    outputLine(5, line, sizeof(line));
+    assert(strstr(line, "\"path\":") && strstr(line, "\"ok\":true"));
+    assert(stats.requests == 6 && stats.succeeded == 4 && stats.failed == 2 && stats.groups == 0);
+    printf("✅ Batch script with $user references: PASS\n");
+}
+
+void test_groups() {
+    char script[4096], line[1024];
+    size_t len = 0;
+    BatchStats stats;
+
+    // A failure inside the group rolls back the signup and the marks with it
+    len += (size_t)snprintf(script + len, sizeof(script) - len, "{\"op\":\"begin\"}\n");
+    signupLine(script + len, sizeof(script) - len, "carol", 2);
+    len += strlen(script + len);
+    len += (size_t)snprintf(script + len, sizeof(script) - len,
+        "{\"op\":\"data_put\",\"user\":\"$carol\",\"marks\":[50,60],\"fullMarks\":[100,100]}\n"
+        "{\"op\":\"data_put\",\"user\":\"$carol\",\"marks\":[500,60],\"fullMarks\":[100,100]}\n"
+        "{\"op\":\"commit\"}\n"
+        "{\"op\":\"data_get\",\"user\":\"$carol\"}\n");
+    assert(runScript(script, NULL, &stats) == ERROR_INVALID_INPUT);
+    assert(countLines(output) == 6);
+    outputLine(0, line, sizeof(line));
+    assert(strcmp(line, "{\"op\":\"begin\",\"ok\":true}") == 0);
+    outputLine(4, line, sizeof(line));
+    assert(strstr(line, "{\"op\":\"commit\",\"rolledBack\":2,\"ok\":false,\"error\":\"INVALID_INPUT\"") == line);
+    outputLine(5, line, sizeof(line));
+    assert(strstr(line, "\"error\":\"NOT_FOUND\""));        // binding went with the group
+    assert(stats.rolledBack == 2 && stats.groups == 1);
+    char email[64];
+    snprintf(email, sizeof(email), "batch%u_2@example.com", tag);
+    assert(!isEmailAlreadyRegistered(email));
+
+    // The same group without the bad row commits
+    len = 0;
+    len += (size_t)snprintf(script + len, sizeof(script) - len, "{\"op\":\"begin\"}\n");
+    signupLine(script + len, sizeof(script) - len, "carol", 2);
+    len += strlen(script + len);
+    len += (size_t)snprintf(script + len, sizeof(script) - len,
+        "{\"op\":\"data_put\",\"user\":\"$carol\",\"marks\":[50,60],\"fullMarks\":[100,100]}\n"
+        "{\"op\":\"commit\"}\n"
+        "{\"op\":\"data_get\",\"user\":\"$carol\"}\n"
+        "{\"op\":\"commit\"}\n");
+    assert(runScript(script, NULL, &stats) == ERROR_INVALID_INPUT);     // stray commit
+    outputLine(3, line, sizeof(line));
+    assert(strcmp(line, "{\"op\":\"commit\",\"applied\":2,\"ok\":true}") == 0);
+    outputLine(4, line, sizeof(line));
+    assert(strstr(line, "\"total\":110"));
+    outputLine(5, line, sizeof(line));
+    assert(strstr(line, "no open group"));
+    assert(isEmailAlreadyRegistered(email));
+
+    // Explicit rollback, and a group left open at the end
+    assert(runScript("{\"op\":\"begin\"}\n{\"op\":\"ping\"}\n{\"op\":\"rollback\"}\n"
+                     "{\"op\":\"begin\"}\n{\"op\":\"ping\"}\n", NULL, &stats) == ERROR_INVALID_INPUT);
+    outputLine(2, line, sizeof(line));
+    assert(strcmp(line, "{\"op\":\"rollback\",\"rolledBack\":1,\"ok\":true}") == 0);
+    outputLine(5, line, sizeof(line));
+    assert(strstr(line, "missing commit"));
+    printf("✅ Transaction groups: PASS\n");
+}
+
+void test_options() {
+    char script[4096], line[1024];
+    BatchOptions options = { 1, 0 };
+    BatchStats stats;
+    size_t len = 0;
+
+    // --atomic: one bad line undoes the whole script
+    signupLine(script, sizeof(script), "dave", 3);
+    len = strlen(script);
+    snprintf(script + len, sizeof(script) - len, "{\"op\":\"nope\"}\n{\"op\":\"ping\"}\n");
+    assert(runScript(script, &options, &stats) == ERROR_INVALID_INPUT);
+    assert(countLines(output) == 4);
+    outputLine(3, line, sizeof(line));
+    assert(strstr(line, "{\"op\":\"commit\",\"rolledBack\":2,\"ok\":false") == line);
+    char email[64];
+    snprintf(email, sizeof(email), "batch%u_3@example.com", tag);
+    assert(!isEmailAlreadyRegistered(email));
+    assert(runScript("{\"op\":\"begin\"}\n", &options, &stats) == ERROR_INVALID_INPUT);
+
+    // --stop-on-error: nothing after the first failure runs
+    options.atomic = 0;
+    options.stopOnError = 1;
+    assert(runScript("{\"op\":\"ping\"}\n{\"op\":\"nope\"}\n{\"op\":\"ping\"}\n", &options, &stats) == ERROR_INVALID_INPUT);
+    assert(countLines(output) == 2 && stats.requests == 2);
+    assert(runScript("{\"op\":\"begin\"}\n{\"op\":\"ping\"}\n{\"op\":\"nope\"}\n{\"op\":\"ping\"}\n",
+                     &options, &stats) == ERROR_INVALID_INPUT);
+    assert(countLines(output) == 4);
+    outputLine(3, line, sizeof(line));
+    assert(strstr(line, "{\"op\":\"commit\",\"rolledBack\":1,\"ok\":false") == line);
+    printf("✅ --atomic and --stop-on-error: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    tag = (unsigned)getpid() % 100000u;
+    test_script();
+    test_groups();
+    test_options();
+    closeDatabase();
+    printf("✅ All batch tests passed\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "testHelpers.h"
+
+#define TEST_USERS 600      // spans several DB_BATCH_CHUNK statements
+
+static char ids[TEST_USERS][20];
+
+static void seedUsers(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_USERS; i++) {
+        Profile p;
+        snprintf(ids[i], sizeof(ids[i]), "tb%05u%04d", tag, i);
+        testProfile(&p, ids[i], "Batch Institute", "Bulk", (CampusType)(CAMPUS_SCHOOL + i % 4));
+        snprintf(p.name, sizeof(p.name), "Batch %d", i);
+        testSubjects(&p, 2, "First", "Second");
+        testMobile(&p, '7', i);
+        assert(createUser(&p) == SUCCESS);
+
+        if (i % 5 == 4) continue;   // some users have no campus data yet
+        if (p.campusType == CAMPUS_SCHOOL) {
+            SchoolMarks m;
+            memset(&m, 0, sizeof(m));
+            m.count = 2;
+            m.marks[0] = i % 100;
+            m.fullMarks[0] = 100;
+            assert(saveUserData(ids[i], "SCHOOL_DATA", &m, sizeof(m)));
+        } else if (p.campusType == CAMPUS_COLLEGE) {
+            CollegeMarks m;
+            memset(&m, 0, sizeof(m));
+            m.count = 2;
+            m.credits[1] = i;
+            assert(saveUserData(ids[i], "COLLEGE_DATA", &m, sizeof(m)));
+        } else {
+            FieldValues v;
+            memset(&v, 0, sizeof(v));
+            v.count = 1;
+            snprintf(v.values[0], sizeof(v.values[0]), "value %d", i);
+            assert(saveUserData(ids[i], campusDataType(p.campusType), &v, sizeof(v)));
+        }
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+void test_batch_matches_single_reads() {
+    const char *req[TEST_USERS];
+    for (int i = 0; i < TEST_USERS; i++) req[i] = ids[TEST_USERS - 1 - i];    // reverse order
+    UserRecord *recs = (UserRecord*)malloc(TEST_USERS * sizeof(UserRecord));
+    assert(getUsersByIDs(req, TEST_USERS, recs) == SUCCESS);
+
+    for (int k = 0; k < TEST_USERS; k++) {
+        int i = TEST_USERS - 1 - k;
+        Profile p;
+        assert(recs[k].found);
+        assert(getUserByID(ids[i], &p));
+        assert(memcmp(&p, &recs[k].profile, sizeof(Profile)) == 0);
+        assert(recs[k].hasData == (i % 5 != 4));
+        if (!recs[k].hasData) continue;
+        if (p.campusType == CAMPUS_SCHOOL) assert(recs[k].data.school.marks[0] == i % 100);
+        else if (p.campusType == CAMPUS_COLLEGE) assert(recs[k].data.college.credits[1] == i);
+        else {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "value %d", i);
+            assert(strcmp(recs[k].data.fields.values[0], expected) == 0);
+        }
+    }
+    free(recs);
+    printf("✅ Batch read matches single reads (%d users): PASS\n", TEST_USERS);
+}
+
+void test_unknown_and_duplicate_ids() {
+    const char *req[] = { ids[0], "no-such-user", ids[0], NULL, ids[1] };
+    UserRecord recs[5];
+    assert(getUsersByIDs(req, 5, recs) == SUCCESS);
+    assert(recs[0].found && recs[2].found && recs[4].found);
+    assert(!recs[1].found && !recs[3].found && !recs[1].hasData);
+    assert(strcmp(recs[2].profile.userID, ids[0]) == 0);
+    assert(strcmp(recs[4].profile.userID, ids[1]) == 0);
+    assert(getUsersByIDs(req, 0, recs) == SUCCESS);
+    assert(getUsersByIDs(NULL, 1, recs) == ERROR_INVALID_INPUT);
+    printf("✅ Unknown and duplicate IDs: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    seedUsers();
+    test_batch_matches_single_reads();
+    test_unknown_and_duplicate_ids();
+    closeDatabase();
+    printf("✅ All batch read tests passed\n");
+    return 0;
+}
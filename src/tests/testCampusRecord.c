@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/campus_unified.h"
+
+static UnifiedCampusData sample(CampusType type) {
+    UnifiedCampusData d;
+    memset(&d, 0, sizeof(d));
+    strcpy(d.userID, "cr0000000001");
+    strcpy(d.name, "Record Test");
+    strcpy(d.instituteName, "Record Institute");
+    strcpy(d.department, "Storage");
+    d.campusType = type;
+    d.lastUpdated = 1700000000;
+    d.dataVersion = 3;
+    if (type == CAMPUS_SCHOOL || type == CAMPUS_COLLEGE) {
+        d.grades.subjectCount = MAX_SUBJECTS;
+        for (int i = 0; i < MAX_SUBJECTS; i++) {
+            snprintf(d.grades.subjects[i], sizeof(d.grades.subjects[i]), "Subject %d", i);
+            d.grades.marks[i] = i * 11 % 101;
+            d.grades.weights[i] = type == CAMPUS_SCHOOL ? 100 : 1 + i % 4;
+        }
+    } else if (type == CAMPUS_HOSPITAL) {
+        strcpy(d.medical.bloodPressure, "120/80");
+        strcpy(d.medical.temperature, "98.6");
+        strcpy(d.medical.weight, "70");
+        strcpy(d.medical.diagnosis, "Healthy");
+    } else {
+        strcpy(d.hostel.roomNumber, "B-204");
+        strcpy(d.hostel.floor, "2");
+        strcpy(d.hostel.messPlan, "Veg");
+    }
+    return d;
+}
+
+static int sameData(const UnifiedCampusData *a, const UnifiedCampusData *b) {
+    if (strcmp(a->userID, b->userID) || strcmp(a->name, b->name) || strcmp(a->instituteName, b->instituteName) ||
+        strcmp(a->department, b->department) || a->campusType != b->campusType ||
+        a->lastUpdated != b->lastUpdated || a->dataVersion != b->dataVersion) {
+        return 0;
+    }
+    switch (a->campusType) {
+        case CAMPUS_SCHOOL:
+        case CAMPUS_COLLEGE:
+            if (a->grades.subjectCount != b->grades.subjectCount) return 0;
+            for (int i = 0; i < a->grades.subjectCount; i++) {
+                if (strcmp(a->grades.subjects[i], b->grades.subjects[i]) ||
+                    a->grades.marks[i] != b->grades.marks[i] || a->grades.weights[i] != b->grades.weights[i]) {
+                    return 0;
+                }
+            }
+            return 1;
+        case CAMPUS_HOSPITAL:
+            return !strcmp(a->medical.bloodPressure, b->medical.bloodPressure) &&
+                   !strcmp(a->medical.temperature, b->medical.temperature) &&
+                   !strcmp(a->medical.weight, b->medical.weight) &&
+                   !strcmp(a->medical.diagnosis, b->medical.diagnosis);
+        default:
+            return !strcmp(a->hostel.roomNumber, b->hostel.roomNumber) &&
+                   !strcmp(a->hostel.floor, b->hostel.floor) &&
+                   !strcmp(a->hostel.messPlan, b->hostel.messPlan);
+    }
+}
+
+void test_round_trip() {
+    for (CampusType type = CAMPUS_SCHOOL; type < CAMPUS_AMOUNT; type++) {
+        UnifiedCampusData in = sample(type), out;
+        unsigned char buffer[CAMPUS_RECORD_MAX];
+        size_t n = campusRecordEncode(&in, buffer, sizeof(buffer));
+        assert(n > 0 && n == campusRecordSize(&in) && n < sizeof(UnifiedCampusData) / 2);
+        CampusRecordView view;
+        assert(campusRecordView(buffer, n, &view) == SUCCESS && view.length == n);
+        assert(campusRecordDecode(&view, &out) == SUCCESS && sameData(&in, &out));
+
+        // A buffer one byte short is refused rather than overrun
+        assert(campusRecordEncode(&in, buffer, n - 1) == 0);
+    }
+    printf("✅ Compact records round-trip every campus type: PASS\n");
+}
+
+void test_view_in_place() {
+    UnifiedCampusData in = sample(CAMPUS_COLLEGE);
+    unsigned char buffer[CAMPUS_RECORD_MAX + 1];
+    // Odd offset: views must not assume alignment
+    size_t n = campusRecordEncode(&in, buffer + 1, CAMPUS_RECORD_MAX);
+    CampusRecordView view;
+    assert(campusRecordView(buffer + 1, n, &view) == SUCCESS);
+    const char *lo = (const char*)buffer + 1, *hi = lo + n;
+    const char *pointers[] = { view.userID, view.name, view.instituteName, view.department,
+                               (const char*)view.marks, (const char*)view.weights, view.strings[0],
+                               view.strings[MAX_SUBJECTS - 1] };
+    for (size_t i = 0; i < sizeof(pointers) / sizeof(pointers[0]); i++) {
+        assert(pointers[i] >= lo && pointers[i] < hi);
+    }
+    assert(strcmp(view.instituteName, "Record Institute") == 0 && view.count == MAX_SUBJECTS);
+    assert(view.marks[3] == 33 && view.weights[3] == 4 && strcmp(view.strings[9], "Subject 9") == 0);
+    printf("✅ Views point into the record: PASS\n");
+}
+
+void test_rejects_bad_input() {
+    UnifiedCampusData in = sample(CAMPUS_SCHOOL), out;
+    unsigned char buffer[CAMPUS_RECORD_MAX];
+    size_t n = campusRecordEncode(&in, buffer, sizeof(buffer));
+    CampusRecordView view;
+    for (size_t cut = 0; cut < n; cut++) assert(campusRecordView(buffer, cut, &view) == ERROR_INVALID_INPUT);
+
+    unsigned char bad[CAMPUS_RECORD_MAX];
+    memcpy(bad, buffer, n);
+    bad[0] ^= 0xff;                                     // magic
+    assert(campusRecordView(bad, n, &view) == ERROR_INVALID_INPUT);
+    memcpy(bad, buffer, n);
+    bad[offsetof(CampusRecordHeader, campusType)] = CAMPUS_AMOUNT;
+    assert(campusRecordView(bad, n, &view) == ERROR_INVALID_INPUT);
+    memcpy(bad, buffer, n);
+    bad[offsetof(CampusRecordHeader, campusType)] = CAMPUS_HOSTEL;      // hostel has no marks
+    assert(campusRecordView(bad, n, &view) == ERROR_INVALID_INPUT);
+    memcpy(bad, buffer, n);
+    bad[n - 1] = 'x';                                   // last string unterminated
+    assert(campusRecordView(bad, n, &view) == ERROR_INVALID_INPUT);
+    memcpy(bad, buffer, n);
+    memset(bad + sizeof(CampusRecordHeader) + 2 * MAX_SUBJECTS, 'u', 25);  // userID longer than its field
+    assert(campusRecordView(bad, n, &view) == ERROR_INVALID_INPUT);
+    assert(campusFileDecode(buffer, n - 1, &out) == ERROR_INVALID_INPUT);
+    assert(campusFileDecode("garbage", 7, &out) == ERROR_INVALID_INPUT);
+
+    in.grades.marks[0] = 300;                           // does not fit a byte
+    assert(campusRecordSize(&in) == 0);
+    in = sample(CAMPUS_NONE);
+    assert(campusRecordSize(&in) == 0);
+    printf("✅ Truncated and corrupt records are rejected: PASS\n");
+}
+
+// Files written before compact records are still read
+void test_legacy_file() {
+    struct {
+        char userID[20];
+        char name[MAX_LEN];
+        char instituteName[MAX_LEN];
+        char department[50];
+        CampusType campusType;
+        int subjectCount;
+        char subjects[MAX_SUBJECTS][MAX_LEN];
+        int marks[MAX_SUBJECTS];
+        int fullMarks[MAX_SUBJECTS];
+        int credits[MAX_SUBJECTS];
+        char bloodPressure[20];
+        char temperature[10];
+        char weight[10];
+        char diagnosis[MAX_LEN];
+        char roomNumber[10];
+        char floor[10];
+        char messPlan[50];
+        time_t lastUpdated;
+        int dataVersion;
+    } old;
+    memset(&old, 0, sizeof(old));
+    strcpy(old.userID, "cr0000000002");
+    strcpy(old.name, "Old File");
+    strcpy(old.instituteName, "Old Institute");
+    old.campusType = CAMPUS_COLLEGE;
+    old.subjectCount = 2;
+    strcpy(old.subjects[0], "Physics");
+    strcpy(old.subjects[1], "Chemistry");
+    old.marks[0] = 81;
+    old.marks[1] = 64;
+    old.credits[0] = 4;
+    old.credits[1] = 3;
+    old.fullMarks[0] = old.fullMarks[1] = 100;          // ignored for college
+    old.lastUpdated = 1600000000;
+    old.dataVersion = 1;
+
+    UnifiedCampusData out;
+    assert(campusFileDecode(&old, sizeof(old), &out) == SUCCESS);
+    assert(out.campusType == CAMPUS_COLLEGE && out.grades.subjectCount == 2);
+    assert(strcmp(out.grades.subjects[1], "Chemistry") == 0 && out.grades.marks[0] == 81);
+    assert(out.grades.weights[0] == 4 && out.grades.weights[1] == 3 && out.lastUpdated == 1600000000);
+
+    old.campusType = CAMPUS_SCHOOL;
+    assert(campusFileDecode(&old, sizeof(old), &out) == SUCCESS && out.grades.weights[1] == 100);
+    old.campusType = CAMPUS_HOSPITAL;
+    strcpy(old.bloodPressure, "110/70");
+    assert(campusFileDecode(&old, sizeof(old), &out) == SUCCESS && strcmp(out.medical.bloodPressure, "110/70") == 0);
+    printf("✅ Whole-struct files still load: PASS\n");
+}
+
+void test_save_load() {
+    UnifiedCampusData in = sample(CAMPUS_HOSPITAL), out;
+    snprintf(in.userID, sizeof(in.userID), "cr%010u", (unsigned)getpid());
+    assert(saveUnifiedCampusData(&in) == SUCCESS);
+    assert(loadUnifiedCampusData(in.userID, &out) == SUCCESS && sameData(&in, &out));
+
+    // A per-user file from before the segment store is read and moved into it
+    UnifiedCampusData old = sample(CAMPUS_HOSTEL);
+    snprintf(old.userID, sizeof(old.userID), "co%010u", (unsigned)getpid());
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t n = campusRecordEncode(&old, record, sizeof(record));
+    char path[64];
+    snprintf(path, sizeof(path), DATA_DIR "%s.data", old.userID);
+    FILE *f = fopen(path, "wb");
+    assert(f && fwrite(record, n, 1, f) == 1);
+    fclose(f);
+    assert(loadUnifiedCampusData(old.userID, &out) == SUCCESS && sameData(&old, &out));
+    remove(path);
+    assert(loadUnifiedCampusData(old.userID, &out) == SUCCESS && sameData(&old, &out));
+
+    // And everything survives a reopen
+    closeCampusStore();
+    assert(loadUnifiedCampusData(in.userID, &out) == SUCCESS && sameData(&in, &out));
+    closeCampusStore();
+    printf("✅ Campus data saves to and loads from the store: PASS\n");
+}
+
+int main() {
+    test_round_trip();
+    test_view_in_place();
+    test_rejects_bad_input();
+    test_legacy_file();
+    test_save_load();
+    printf("✅ All campus record tests passed\n");
+    return 0;
+}
@@ -179,7 +179,7 @@ void testSchoolDataEntry() {
         }
         
         double percentage = (totalFull > 0) ? (totalMarks * 100.0 / totalFull) : 0.0;
-        const char *grade = getGrade(percentage);
+        const char *grade = getDefaultGrade(percentage);
         
         printf("\nResults:\n");
         printf("  Total Marks: %d/%d\n", totalMarks, totalFull);
@@ -282,7 +282,7 @@ void testDataValidation() {
     int testMarks[] = {0, 1, 49, 50, 99, 100};
     printf("School Marks Validation:\n");
     for (int i = 0; i < 6; i++) {
-        const char *grade = getGrade((double)testMarks[i]);
+        const char *grade = getDefaultGrade((double)testMarks[i]);
         printf("  Marks %d: Grade %s %s\n", testMarks[i], grade,
                testMarks[i] >= 0 && testMarks[i] <= 100 ? "✅" : "❌");
     }
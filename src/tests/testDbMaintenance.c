@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/db_maintenance.h"
+#include "../include/sqlite3.h"
+
+#define TEST_DB "test_maintenance.db"
+
+static sqlite3 *db;
+
+static int pragmaInt(const char *sql) {
+    sqlite3_stmt *stmt;
+    int value = -1;
+    assert(sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK);
+    if (sqlite3_step(stmt) == SQLITE_ROW) value = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+static void removeDb(void) {
+    remove(TEST_DB);
+    remove(TEST_DB "-wal");
+    remove(TEST_DB "-shm");
+}
+
+static void setupDb(void) {
+    removeDb();
+    assert(sqlite3_open(TEST_DB, &db) == SQLITE_OK);
+    sqlite3_exec(db, "PRAGMA auto_vacuum=INCREMENTAL; PRAGMA journal_mode=WAL; PRAGMA wal_autocheckpoint=0;", 0, 0, NULL);
+    assert(sqlite3_exec(db, "CREATE TABLE blobs (id INTEGER PRIMARY KEY, body BLOB);", 0, 0, NULL) == SQLITE_OK);
+    sqlite3_exec(db, "BEGIN;", 0, 0, NULL);
+    for (int i = 0; i < 500; i++) {
+        sqlite3_exec(db, "INSERT INTO blobs (body) VALUES (zeroblob(4000));", 0, 0, NULL);
+    }
+    sqlite3_exec(db, "COMMIT;", 0, 0, NULL);
+    sqlite3_exec(db, "DELETE FROM blobs WHERE id % 2 = 0;", 0, 0, NULL);
+}
+
+static MaintenanceConfig testConfig(void) {
+    MaintenanceConfig config = maintenanceDefaultConfig();
+    config.dbPath = TEST_DB;
+    config.tickMillis = 20;
+    config.walForcePages = 0;
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) config.jobs[job].intervalSeconds = 0;
+    return config;
+}
+
+void test_forced_jobs() {
+    setupDb();
+    int freeBefore = pragmaInt("PRAGMA freelist_count;");
+    assert(freeBefore > 0);
+
+    MaintenanceConfig config = testConfig();
+    assert(maintenanceStart(&config) == SUCCESS);
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) {
+        assert(maintenanceRunNow((MaintenanceJob)job) == SUCCESS);
+    }
+
+    MaintenanceJobStats stats[MAINT_JOB_COUNT];
+    maintenanceGetStats(stats);
+    for (int job = 0; job < MAINT_JOB_COUNT; job++) assert(stats[job].runs == 1);
+    assert(stats[MAINT_CHECKPOINT].work > 0);
+    assert(stats[MAINT_INCREMENTAL_VACUUM].work > 0);
+    assert(stats[MAINT_QUICK_CHECK].failures == 0);
+    assert(pragmaInt("PRAGMA freelist_count;") < freeBefore);
+    assert(maintenanceStop() == SUCCESS);
+    printf("✅ maintenance forced jobs: PASS (%llu frames checkpointed, %llu pages freed)\n",
+           (unsigned long long)stats[MAINT_CHECKPOINT].work,
+           (unsigned long long)stats[MAINT_INCREMENTAL_VACUUM].work);
+}
+
+void test_budget_stops_vacuum() {
+    sqlite3_exec(db, "BEGIN;", 0, 0, NULL);
+    for (int i = 0; i < 2000; i++) {
+        sqlite3_exec(db, "INSERT INTO blobs (body) VALUES (zeroblob(4000));", 0, 0, NULL);
+    }
+    sqlite3_exec(db, "COMMIT;", 0, 0, NULL);
+    sqlite3_exec(db, "DELETE FROM blobs;", 0, 0, NULL);
+
+    MaintenanceConfig config = testConfig();
+    config.vacuumStepPages = 1;
+    config.jobs[MAINT_INCREMENTAL_VACUUM].budgetMillis = 1;
+    assert(maintenanceStart(&config) == SUCCESS);
+    assert(maintenanceRunNow(MAINT_INCREMENTAL_VACUUM) == SUCCESS);
+    MaintenanceJobStats stats[MAINT_JOB_COUNT];
+    maintenanceGetStats(stats);
+    assert(stats[MAINT_INCREMENTAL_VACUUM].overBudget == 1);
+    assert(pragmaInt("PRAGMA freelist_count;") > 0);
+    assert(maintenanceStop() == SUCCESS);
+    printf("✅ maintenance time budget: PASS (%llu pages freed in %llu us)\n",
+           (unsigned long long)stats[MAINT_INCREMENTAL_VACUUM].work,
+           (unsigned long long)stats[MAINT_INCREMENTAL_VACUUM].lastMicros);
+}
+
+void test_defers_while_busy() {
+    MaintenanceConfig config = testConfig();
+    config.idleMillis = 60000;
+    config.maxDeferrals = 1000;
+    config.jobs[MAINT_OPTIMIZE].intervalSeconds = 1;
+    assert(maintenanceStart(&config) == SUCCESS);
+    for (int i = 0; i < 15; i++) {
+        maintenanceNoteActivity();
+        usleep(100 * 1000);
+    }
+    MaintenanceJobStats stats[MAINT_JOB_COUNT];
+    maintenanceGetStats(stats);
+    assert(stats[MAINT_OPTIMIZE].runs == 0);
+    assert(stats[MAINT_OPTIMIZE].deferred > 0);
+    assert(maintenanceStop() == SUCCESS);
+    printf("✅ maintenance defers under traffic: PASS (%lu deferrals)\n", stats[MAINT_OPTIMIZE].deferred);
+}
+
+int main() {
+    printf("==== Database Maintenance Tests ====\n");
+    test_forced_jobs();
+    test_budget_stops_vacuum();
+    test_defers_while_busy();
+    sqlite3_close(db);
+    removeDb();
+    return 0;
+}
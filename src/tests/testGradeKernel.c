@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/grade_kernel.h"
+#include "../include/student.h"
+
+#define STUDENTS 1003       // not a multiple of any lane count: exercises the tail
+
+// The formulas the per-student code used before the kernel
+static float referencePercent(int total, int full) {
+    return (full == 0) ? 0.0f : (total * 100.0f / full);
+}
+
+static float referenceCgpa(int totalMarks, int totalCredits) {
+    return totalCredits > 0 ? (float)totalMarks / (totalCredits * 10.0f) : 0.0f;
+}
+
+static const char *referenceGrade(float percent) {
+    if (percent >= 90.0f) return "A+";
+    else if (percent >= 80.0f) return "A";
+    else if (percent >= 70.0f) return "B";
+    else if (percent >= 60.0f) return "C";
+    else if (percent >= 50.0f) return "D";
+    else return "F";
+}
+
+void test_grade_buckets() {
+    float edges[] = { -1.0f, 0.0f, 49.99f, 50.0f, 59.99f, 60.0f, 69.99f, 70.0f, 79.99f, 80.0f,
+                      89.99f, 90.0f, 100.0f, 250.0f };
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        assert(strcmp(getDefaultGrade(edges[i]), referenceGrade(edges[i])) == 0);
+        assert(strcmp(gradeName(gradeBucket(edges[i])), referenceGrade(edges[i])) == 0);
+    }
+    assert(gradeBucket(95.0f) == GRADE_A_PLUS && gradeBucket(10.0f) == GRADE_F);
+    printf("✅ Branchless grade thresholds: PASS\n");
+}
+
+// Vector lanes and scalar tail both match the old per-student results exactly
+void test_batch_matches_scalar() {
+    static int marks[MAX_SUBJECTS * STUDENTS], weights[MAX_SUBJECTS * STUDENTS];
+    static int total[STUDENTS], weight[STUDENTS];
+    static float score[STUDENTS];
+    static unsigned char grade[STUDENTS];
+    srand(42);
+
+    for (int scale = GRADE_SCALE_PERCENT; scale <= GRADE_SCALE_CGPA; scale++) {
+        for (int i = 0; i < STUDENTS; i++) {
+            int count = i % 7 == 0 ? 0 : rand() % (MAX_SUBJECTS + 1);
+            for (int s = 0; s < MAX_SUBJECTS; s++) {
+                marks[s * STUDENTS + i] = s < count ? rand() % 101 : 0;
+                weights[s * STUDENTS + i] = s < count ? (scale == GRADE_SCALE_CGPA ? 1 + rand() % 10 : 100) : 0;
+            }
+        }
+        GradeBatch batch = { (GradeScale)scale, STUDENTS, STUDENTS, MAX_SUBJECTS, marks, weights };
+        GradeResults out = { total, weight, score, grade };
+        gradeBatch(&batch, &out);
+
+        for (int i = 0; i < STUDENTS; i++) {
+            int t = 0, w = 0;
+            for (int s = 0; s < MAX_SUBJECTS; s++) {
+                int m = marks[s * STUDENTS + i], c = weights[s * STUDENTS + i];
+                t += scale == GRADE_SCALE_CGPA ? m * c : m;
+                w += c;
+            }
+            assert(total[i] == t && weight[i] == w);
+            float expected = scale == GRADE_SCALE_CGPA ? referenceCgpa(t, w) : referencePercent(t, w);
+            assert(memcmp(&score[i], &expected, sizeof(float)) == 0);
+            if (scale == GRADE_SCALE_PERCENT) assert(strcmp(gradeName(grade[i]), referenceGrade(expected)) == 0);
+        }
+    }
+    printf("✅ Batch kernel matches per-student results: PASS\n");
+}
+
+// A stride wider than the count, as merged reports use for partial chunks
+void test_stride_and_helpers() {
+    int marks[MAX_SUBJECTS][16] = {{0}}, weights[MAX_SUBJECTS][16] = {{0}};
+    int total[5], weight[5];
+    float score[5];
+    SchoolMarks school = {0};
+    school.count = 3;
+    for (int s = 0; s < 3; s++) {
+        school.marks[s] = 60 + s * 10;
+        school.fullMarks[s] = 100;
+        for (int i = 0; i < 5; i++) {
+            marks[s][i] = school.marks[s];
+            weights[s][i] = school.fullMarks[s];
+        }
+    }
+    GradeBatch batch = { GRADE_SCALE_PERCENT, 5, 16, 3, &marks[0][0], &weights[0][0] };
+    gradeBatch(&batch, &(GradeResults){ total, weight, score, NULL });
+
+    GradeSummary g = gradeSchoolMarks(&school);
+    assert(g.total == 210 && g.weight == 300 && g.grade == GRADE_B);
+    for (int i = 0; i < 5; i++) assert(total[i] == 210 && score[i] == g.score);
+    assert(campusReportScore(CAMPUS_SCHOOL, &school) == g.score);
+
+    CollegeMarks college = {0};
+    college.count = 2;
+    college.marks[0] = 80;
+    college.credits[0] = 4;
+    college.marks[1] = 60;
+    college.credits[1] = 2;
+    GradeSummary c = gradeCollegeMarks(&college);
+    assert(c.total == 440 && c.weight == 6);
+    assert(c.score == referenceCgpa(440, 6) && campusReportScore(CAMPUS_COLLEGE, &college) == c.score);
+
+    college.count = 0;
+    assert(gradeCollegeMarks(&college).score == 0.0f);
+    printf("✅ Strided batches and single-student helpers: PASS\n");
+}
+
+int main() {
+    test_grade_buckets();
+    test_batch_matches_scalar();
+    test_stride_and_helpers();
+    printf("✅ All grade kernel tests passed\n");
+    return 0;
+}
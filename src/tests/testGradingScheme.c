@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/grade_kernel.h"
+#include "../include/grading_scheme.h"
+#include "../include/regrade.h"
+#include "../include/sqlite3.h"
+#include "testHelpers.h"
+
+#define TEST_STUDENTS 600       // a few REGRADE_CHUNKs plus a partial one
+#define NO_MARKS 7              // the last few never store marks
+
+static char institute[64];
+static int marks[TEST_STUDENTS][2];
+
+// The built-in scheme grades exactly like the kernel's thresholds did
+void test_default_matches_kernel() {
+    GradingScheme s;
+    assert(gradingSchemeCompile("", 0, GRADING_DEFAULT_SPEC, &s) == SUCCESS);
+    assert(s.gradeCount == 6 && strcmp(s.names[0], "A+") == 0 && s.passPercent == 50.0f);
+    for (int step = -100; step <= 10100; step++) {
+        float percent = step / 100.0f;
+        float around[3] = { nextafterf(percent, -1000.0f), percent, nextafterf(percent, 1000.0f) };
+        for (int k = 0; k < 3; k++) {
+            assert(strcmp(s.names[gradingSchemeGrade(&s, around[k])], gradeName(gradeBucket(around[k]))) == 0);
+        }
+    }
+    assert(strcmp(getDefaultGrade(89.99f), "A") == 0 && strcmp(getDefaultGrade(90.0f), "A+") == 0);
+    printf("✅ Built-in scheme matches the kernel thresholds: PASS\n");
+}
+
+void test_parse() {
+    GradingScheme s;
+    const char *bad[] = {
+        "A=50 B=40",                    // nothing covers 0%
+        "A=50 A=0",                     // repeated name
+        "A=50 B=50.001 F=0",            // same 0.01% step
+        "A=50 F=0 gpa=median",
+        "A=50 F=0 pass=120",
+        "A=50:-1 F=0",
+        "VeryLongGradeName=50 F=0",
+        "A=fifty F=0",
+        "A=50 F=0 junk",
+        "",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        assert(gradingSchemeCompile("X", 1, bad[i], &s) == ERROR_INVALID_INPUT);
+    }
+
+    // Order in the spec does not matter; pass defaults to the lowest threshold
+    assert(gradingSchemeCompile("X", 1, "F=0 B=60.5,A=85", &s) == SUCCESS);
+    assert(s.gradeCount == 3 && strcmp(s.names[0], "A") == 0 && strcmp(s.names[2], "F") == 0);
+    assert(s.passPercent == 60.5f);
+    assert(strcmp(s.names[gradingSchemeGrade(&s, 60.49f)], "F") == 0);
+    assert(strcmp(s.names[gradingSchemeGrade(&s, 60.5f)], "B") == 0);
+    assert(strcmp(s.names[gradingSchemeGrade(&s, 100.0f)], "A") == 0);
+
+    GradingScheme t;
+    assert(gradingSchemeCompile("X", 2, "F=0 B=60.5,A=85", &t) == SUCCESS && t.fingerprint != s.fingerprint);
+    printf("✅ Scheme specs and validation: PASS\n");
+}
+
+void test_gpa_points() {
+    GradingScheme s;
+    assert(gradingSchemeCompile("X", 1, "O=90:10 A=75:8 B=60:6 F=0:0 gpa=points pass=40", &s) == SUCCESS);
+    CollegeMarks m = {0};
+    m.count = 2;
+    m.marks[0] = 95;
+    m.credits[0] = 4;
+    m.marks[1] = 70;
+    m.credits[1] = 2;
+    GradingResult r;
+    assert(gradingSchemeApply(&s, CAMPUS_COLLEGE, &m, &r) == SUCCESS);
+    assert(fabsf(r.gpa - 52.0f / 6.0f) < 1e-5f);                 // (10*4 + 6*2) / 6
+    assert(fabsf(r.percent - 520.0f / 6.0f) < 1e-4f && strcmp(s.names[r.grade], "A") == 0 && r.passed);
+
+    // gpa=marks is the kernel's CGPA
+    GradingScheme d;
+    assert(gradingSchemeCompile("", 0, GRADING_DEFAULT_SPEC, &d) == SUCCESS);
+    assert(gradingSchemeApply(&d, CAMPUS_COLLEGE, &m, &r) == SUCCESS && r.gpa == gradeCollegeMarks(&m).score);
+    assert(gradingSchemeApply(&d, CAMPUS_HOSTEL, &m, &r) == ERROR_INVALID_INPUT);
+    printf("✅ Grade-point GPA: PASS\n");
+}
+
+void test_versions() {
+    int version;
+    assert(gradingSchemeAdd(institute, "P=40 F=0", &version) == SUCCESS && version == 1);
+    assert(gradingSchemeAdd(institute, "Distinction=75 Pass=35 Fail=0", &version) == SUCCESS && version == 2);
+    assert(gradingSchemeAdd(institute, "nonsense", &version) == ERROR_INVALID_INPUT);
+    const GradingScheme *s = gradingSchemeFor(institute);
+    assert(s->version == 2 && strcmp(s->institute, institute) == 0 && s->passPercent == 35.0f);
+    assert(gradingSchemeFor("Somewhere Else")->version == 0);
+
+    // Read back from the database after a reset
+    gradingSchemesReset();
+    s = gradingSchemeFor(institute);
+    assert(s->version == 2 && strcmp(s->names[0], "Distinction") == 0);
+    printf("✅ Versioned schemes per institute: PASS\n");
+}
+
+static void seed(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    srand(tag);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_STUDENTS; i++) {
+        Profile p;
+        char id[20];
+        snprintf(id, sizeof(id), "gs%05u%04d", tag, i);
+        testProfile(&p, id, institute, "Board", CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Graded %d", i);
+        testSubjects(&p, 2, "Math", "Art");
+        testMobile(&p, '5', (int)tag * 1000 + i);
+        assert(createUser(&p) == SUCCESS);
+        if (i >= TEST_STUDENTS - NO_MARKS) continue;
+        marks[i][0] = rand() % 101;
+        marks[i][1] = rand() % 101;
+        int full[2] = { 100, 100 };
+        assert(storeSchoolMarks(p.userID, marks[i], full, 2) == SUCCESS);
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+typedef struct {
+    int calls;
+    size_t lastDone;
+} ProgressLog;
+
+static void onProgress(const RegradeProgress *progress, void *ctx) {
+    ProgressLog *log = (ProgressLog*)ctx;
+    assert(progress->done > log->lastDone && progress->done <= progress->total && progress->total == TEST_STUDENTS);
+    log->lastDone = progress->done;
+    log->calls++;
+}
+
+static void checkStored(int expectedVersion) {
+    const GradingScheme *s = gradingSchemeFor(institute);
+    unsigned tag = (unsigned)getpid() % 100000u;
+    for (int i = 0; i < TEST_STUDENTS; i++) {
+        char id[20];
+        snprintf(id, sizeof(id), "gs%05u%04d", tag, i);
+        StoredGrade row;
+        if (i >= TEST_STUDENTS - NO_MARKS) {
+            assert(getStoredGrade(id, &row) == ERROR_NOT_FOUND);
+            continue;
+        }
+        assert(getStoredGrade(id, &row) == SUCCESS);
+        float percent = (marks[i][0] + marks[i][1]) / 2.0f;
+        assert(row.schemeVersion == expectedVersion && row.campusType == CAMPUS_SCHOOL);
+        assert(fabsf(row.percent - percent) < 1e-4f);
+        assert(strcmp(row.grade, s->names[gradingSchemeGrade(s, percent)]) == 0);
+        assert(row.passed == (percent >= s->passPercent));
+    }
+}
+
+void test_regrade() {
+    seed();
+    RegradeOptions options = regradeDefaultOptions();
+    ProgressLog log = {0};
+    options.threads = 4;
+    options.progress = onProgress;
+    options.ctx = &log;
+    RegradeStats stats;
+    assert(runRegrade(institute, &options, &stats) == SUCCESS);
+    assert(stats.students == TEST_STUDENTS && stats.graded == TEST_STUDENTS - NO_MARKS);
+    assert(stats.missingData == NO_MARKS && stats.failedChunks == 0);
+    assert(stats.chunks == (TEST_STUDENTS + REGRADE_CHUNK - 1) / REGRADE_CHUNK && log.calls == (int)stats.chunks);
+    assert(log.lastDone == TEST_STUDENTS);
+    checkStored(2);
+
+    // A scheme change followed by a re-grade rewrites every stored result
+    int version;
+    assert(gradingSchemeAdd(institute, "Top=60:4 Low=0:0 pass=60", &version) == SUCCESS && version == 3);
+    assert(runRegrade(institute, NULL, &stats) == SUCCESS && stats.graded == TEST_STUDENTS - NO_MARKS);
+    checkStored(3);
+    assert(runRegrade("Nowhere At All", NULL, &stats) == ERROR_NOT_FOUND);
+    printf("✅ Parallel re-grade into grade_results: PASS\n");
+}
+
+// Reports print the institute's grade names
+void test_report_uses_scheme() {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    Profile p;
+    char id[20];
+    snprintf(id, sizeof(id), "gs%05u%04d", tag, 0);
+    assert(getUserByID(id, &p));
+    SchoolMarks data;
+    size_t size = sizeof(data);
+    assert(loadUserData(id, "SCHOOL_DATA", &data, &size));
+    ReportLayout layout;
+    assert(layoutCampusReport(&p, &data, &layout) == SUCCESS);
+    const char *expected = (marks[0][0] + marks[0][1]) / 2.0f >= 60.0f ? "Grade: Top" : "Grade: Low";
+    int seen = 0;
+    for (int i = 0; i < layout.count; i++) seen |= strcmp(layout.lines[i].text, expected) == 0;
+    assert(seen);
+
+    // The dashboard agrees with the report card
+    char printed[4096];
+    FILE *out = tmpfile();
+    int saved = dup(STDOUT_FILENO);
+    assert(out && saved >= 0);
+    fflush(stdout);
+    dup2(fileno(out), STDOUT_FILENO);
+    loadSchoolData(id);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    rewind(out);
+    size_t n = fread(printed, 1, sizeof(printed) - 1, out);
+    printed[n] = '\0';
+    fclose(out);
+    assert(strstr(printed, expected) != NULL);
+    printf("✅ Reports grade with the institute's scheme: PASS\n");
+}
+
+// A scheme stored by another process (`campus scheme --set` next to a running
+// server) is picked up on the next lookup
+void test_added_elsewhere() {
+    const GradingScheme *before = gradingSchemeFor(institute);
+    assert(before->version == 3);
+    sqlite3 *raw;
+    sqlite3_stmt *stmt;
+    assert(sqlite3_open("data/campus.db", &raw) == SQLITE_OK);
+    sqlite3_busy_timeout(raw, 5000);
+    assert(sqlite3_prepare_v2(raw, "INSERT INTO grading_schemes (institute, version, spec) VALUES (?, 4, 'Gold=50:4 Rest=0:0');",
+                              -1, &stmt, 0) == SQLITE_OK);
+    sqlite3_bind_text(stmt, 1, institute, -1, SQLITE_STATIC);
+    assert(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+
+    const GradingScheme *after = gradingSchemeFor(institute);
+    assert(after->version == 4 && strcmp(after->names[0], "Gold") == 0);
+    assert(after->fingerprint != before->fingerprint && before->version == 3);
+    assert(gradingSchemeFor(institute) == after);
+    printf("✅ Schemes added by another process: PASS\n");
+}
+
+int main() {
+    snprintf(institute, sizeof(institute), "Scheme School %u", (unsigned)getpid() % 100000u);
+    assert(initDatabase() == SUCCESS);
+    test_default_matches_kernel();
+    test_parse();
+    test_gpa_points();
+    test_versions();
+    test_regrade();
+    test_report_uses_scheme();
+    test_added_elsewhere();
+    closeDatabase();
+    printf("✅ All grading scheme tests passed\n");
+    return 0;
+}
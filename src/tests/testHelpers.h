@@ -0,0 +1,63 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/database.h"
+
+// Fixtures shared by the test and bench programs. Each of them is its own
+// executable, so everything here is static inline.
+
+// A user with the fields every fixture sets; the email follows the ID so it
+// stays unique. Callers add a name, subjects and a mobile as they need.
+static inline void testProfile(Profile *p, const char *userID, const char *institute,
+                               const char *department, CampusType type) {
+    memset(p, 0, sizeof(*p));
+    snprintf(p->userID, sizeof(p->userID), "%.*s", (int)sizeof(p->userID) - 1, userID);
+    snprintf(p->instituteName, sizeof(p->instituteName), "%s", institute);
+    snprintf(p->department, sizeof(p->department), "%s", department);
+    p->campusType = type;
+    snprintf(p->email, sizeof(p->email), "%s@example.com", p->userID);
+    strcpy(p->passwordHash, "x");
+}
+
+// testSubjects(&p, 2, "Math", "Art")
+static inline void testSubjects(Profile *p, int count, ...) {
+    va_list names;
+    va_start(names, count);
+    p->dataCount = count;
+    for (int s = 0; s < count; s++) snprintf(p->dataFields[s], sizeof(p->dataFields[s]), "%s", va_arg(names, const char *));
+    va_end(names);
+}
+
+// "Subject 0" .. "Subject <count - 1>"
+static inline void testNumberedSubjects(Profile *p, int count) {
+    p->dataCount = count;
+    for (int s = 0; s < count; s++) snprintf(p->dataFields[s], sizeof(p->dataFields[s]), "Subject %d", s);
+}
+
+// Ten digits: a leading digit per test, then a serial
+static inline void testMobile(Profile *p, char lead, int serial) {
+    snprintf(p->mobile, sizeof(p->mobile), "%c%09d", lead, serial);
+}
+
+// A student taking Math and Art, as the rank and stats tests use
+static inline void testCreateStudent(const char *userID, const char *institute, const char *department,
+                                     CampusType type, char lead, int serial) {
+    Profile p;
+    testProfile(&p, userID, institute, department, type);
+    snprintf(p.name, sizeof(p.name), "Student %s", userID);
+    testSubjects(&p, 2, "Math", "Art");
+    testMobile(&p, lead, serial);
+    assert(createUser(&p) == SUCCESS);
+}
+
+// Math and Art marks out of 100
+static inline void testStoreMarks(const char *userID, int math, int art) {
+    int marks[2] = { math, art }, full[2] = { 100, 100 };
+    assert(storeSchoolMarks(userID, marks, full, 2) == SUCCESS);
+}
+
+#endif // TEST_HELPERS_H
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include "../include/hpdf/hpdf.h"
+
+static HPDF_STATUS lastError;
+
+static void onError(HPDF_STATUS error_no, HPDF_STATUS detail_no, void *user_data) {
+    (void)detail_no;
+    lastError = error_no;
+    (*(int*)user_data)++;
+}
+
+static char *readFile(const char *path, size_t *length) {
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char *data = malloc((size_t)size + 1);
+    assert(data && fread(data, 1, (size_t)size, f) == (size_t)size);
+    data[size] = '\0';
+    fclose(f);
+    *length = (size_t)size;
+    return data;
+}
+
+static size_t countOf(const char *data, size_t length, const char *needle) {
+    size_t n = 0, len = strlen(needle);
+    for (size_t i = 0; i + len <= length; i++) n += memcmp(data + i, needle, len) == 0;
+    return n;
+}
+
+void test_real_pdf() {
+    const char *path = "data/test_hpdf_native.pdf";
+    int errors = 0;
+    HPDF_Doc pdf = HPDF_New(onError, &errors);
+    assert(pdf);
+
+    for (int i = 0; i < 3; i++) {
+        HPDF_Page page = HPDF_AddPage(pdf);
+        assert(page);
+        assert(HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT) == HPDF_OK);
+        // The same font handle is returned every time and owned by the document
+        HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", NULL);
+        assert(font && font == HPDF_GetFont(pdf, "Helvetica", NULL));
+        assert(HPDF_Page_SetFontAndSize(page, font, 12) == HPDF_OK);
+        assert(HPDF_Page_BeginText(page) == HPDF_OK);
+        assert(HPDF_Page_TextOut(page, 50, 800, "Name: (Test) \\ Student") == HPDF_OK);
+        assert(HPDF_Page_TextOut(page, 50, 780, "Caf\xC3\xA9") == HPDF_OK);
+        assert(HPDF_Page_EndText(page) == HPDF_OK);
+    }
+    HPDF_Page wide = HPDF_AddPage(pdf);
+    assert(HPDF_Page_SetSize(wide, HPDF_PAGE_SIZE_LETTER, HPDF_PAGE_LANDSCAPE) == HPDF_OK);
+    assert(HPDF_Page_GetWidth(wide) == 792 && HPDF_Page_GetHeight(wide) == 612);
+    assert(HPDF_Page_SetFontAndSize(wide, HPDF_GetFont(pdf, "Courier-Bold", NULL), 10) == HPDF_OK);
+    assert(HPDF_Page_BeginText(wide) == HPDF_OK);
+    assert(HPDF_Page_TextOut(wide, 40, 500, "Landscape") == HPDF_OK);
+    assert(HPDF_Page_EndText(wide) == HPDF_OK);
+    assert(errors == 0);
+
+    assert(HPDF_SaveToFile(pdf, path) == HPDF_OK);
+    HPDF_Free(pdf);
+
+    size_t length;
+    char *data = readFile(path, &length);
+    assert(memcmp(data, "%PDF-1.4\n", 9) == 0);
+    assert(memcmp(data + length - 6, "%%EOF\n", 6) == 0);
+    const char *startxref = strstr(data + length - 40, "startxref\n");
+    assert(startxref);
+    size_t xref = strtoul(startxref + 10, NULL, 10);
+    assert(memcmp(data + xref, "xref\n0 ", 7) == 0);
+    assert(countOf(data, length, "/Type /Page ") == 4);
+    assert(countOf(data, length, "/Type /Font ") == 2);
+    assert(countOf(data, length, "/MediaBox [0 0 595.28 841.89]") == 3);
+    assert(countOf(data, length, "/MediaBox [0 0 792.00 612.00]") == 1);
+    assert(strstr(data, "(Name: \\(Test\\) \\\\ Student) Tj"));
+    assert(strstr(data, "(Caf\\351) Tj"));
+    free(data);
+    remove(path);
+    printf("✅ Native HPDF writes a real PDF: PASS\n");
+}
+
+void test_errors() {
+    int errors = 0;
+    HPDF_Doc pdf = HPDF_New(onError, &errors);
+    HPDF_Page page = HPDF_AddPage(pdf);
+
+    assert(HPDF_GetFont(pdf, "Comic Sans", NULL) == NULL);
+    assert(lastError == HPDF_INVALID_FONT_NAME && HPDF_GetError(pdf) == HPDF_INVALID_FONT_NAME);
+    HPDF_ResetError(pdf);
+    assert(HPDF_GetError(pdf) == HPDF_OK);
+
+    assert(HPDF_Page_TextOut(page, 0, 0, "outside text object") == HPDF_PAGE_INVALID_GMODE);
+    assert(HPDF_Page_BeginText(page) == HPDF_OK);
+    assert(HPDF_Page_TextOut(page, 0, 0, "no font") == HPDF_PAGE_FONT_NOT_FOUND);
+    assert(HPDF_Page_SetFontAndSize(page, NULL, 12) == HPDF_PAGE_INVALID_FONT);
+    assert(HPDF_Page_SetFontAndSize(page, HPDF_GetFont(pdf, "Times-Roman", NULL), 0) == HPDF_PAGE_INVALID_FONT_SIZE);
+    assert(HPDF_Page_EndText(page) == HPDF_OK);
+    assert(HPDF_SaveToFile(pdf, "no_such_dir/x.pdf") == HPDF_FILE_OPEN_ERROR);
+    assert(errors == 6);
+    HPDF_Free(pdf);
+    printf("✅ Native HPDF error handling: PASS\n");
+}
+
+// SaveToStream renders the same bytes as SaveToFile, read back in pieces
+void test_stream() {
+    const char *path = "data/test_hpdf_stream.pdf";
+    HPDF_Doc pdf = HPDF_New(NULL, NULL);
+    HPDF_Page page = HPDF_AddPage(pdf);
+    HPDF_Page_SetFontAndSize(page, HPDF_GetFont(pdf, "Times-Roman", NULL), 11);
+    HPDF_Page_BeginText(page);
+    HPDF_Page_TextOut(page, 72, 720, "In memory");
+    HPDF_Page_EndText(page);
+
+    HPDF_BYTE chunk[100];
+    HPDF_UINT32 size = sizeof(chunk);
+    assert(HPDF_GetStreamSize(pdf) == 0);
+    assert(HPDF_ReadFromStream(pdf, chunk, &size) == HPDF_INVALID_OPERATION);
+    assert(HPDF_SaveToStream(pdf) == HPDF_OK);
+    assert(HPDF_SaveToFile(pdf, path) == HPDF_OK);
+    size_t fileLength;
+    char *file = readFile(path, &fileLength);
+    assert(HPDF_GetStreamSize(pdf) == fileLength);
+
+    char *memory = malloc(fileLength);
+    size_t got = 0;
+    HPDF_STATUS status;
+    do {
+        size = sizeof(chunk);
+        status = HPDF_ReadFromStream(pdf, chunk, &size);
+        assert(status == HPDF_OK || status == HPDF_STREAM_EOF);
+        assert(got + size <= fileLength);
+        memcpy(memory + got, chunk, size);
+        got += size;
+    } while (status == HPDF_OK);
+    assert(got == fileLength && memcmp(memory, file, fileLength) == 0);
+
+    assert(HPDF_ResetStream(pdf) == HPDF_OK);
+    size = 9;
+    assert(HPDF_ReadFromStream(pdf, chunk, &size) == HPDF_OK && size == 9);
+    assert(memcmp(chunk, "%PDF-1.4\n", 9) == 0);
+    HPDF_Free(pdf);
+    free(memory);
+    free(file);
+    remove(path);
+    printf("✅ Native HPDF memory stream: PASS\n");
+}
+
+// Many lines on one page: appends are amortised, not quadratic
+void test_large_page() {
+    const char *path = "data/test_hpdf_large.pdf";
+    HPDF_Doc pdf = HPDF_New(NULL, NULL);
+    HPDF_Page page = HPDF_AddPage(pdf);
+    HPDF_Page_SetFontAndSize(page, HPDF_GetFont(pdf, "Helvetica", NULL), 8);
+    HPDF_Page_BeginText(page);
+    char line[64];
+    for (int i = 0; i < 200000; i++) {
+        snprintf(line, sizeof(line), "Line %d", i);
+        assert(HPDF_Page_TextOut(page, 10, (HPDF_REAL)(i % 800), line) == HPDF_OK);
+    }
+    HPDF_Page_EndText(page);
+    assert(HPDF_SaveToFile(pdf, path) == HPDF_OK);
+    HPDF_Free(pdf);
+
+    size_t length;
+    char *data = readFile(path, &length);
+    assert(strstr(data, "(Line 199999) Tj"));
+    free(data);
+    remove(path);
+    printf("✅ Native HPDF large page: PASS\n");
+}
+
+int main() {
+    // The documents are written under data/, which a fresh checkout lacks
+#ifdef _WIN32
+    _mkdir("data");
+#else
+    mkdir("data", 0700);
+#endif
+    test_real_pdf();
+    test_errors();
+    test_stream();
+    test_large_page();
+    printf("✅ All native HPDF tests passed\n");
+    return 0;
+}
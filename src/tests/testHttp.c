@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/database.h"
+#include "../include/api/http.h"
+#include "../include/api/server.h"
+
+#define TEST_SOCKET "test_http.sock"
+
+static pthread_t serverThread;
+
+static HttpParseResult parse(const char *text, HttpRequest *req) {
+    return httpParseRequest(text, strlen(text), 4096, req);
+}
+
+void test_parse_request() {
+    HttpRequest req;
+    const char *text = "POST /api/signin?x=1 HTTP/1.1\r\nHost: a\r\nContent-Length: 2\r\n"
+                       "Authorization:  Bearer abc  \r\n\r\n{}GET /next HTTP/1.1\r\n";
+    assert(parse(text, &req) == HTTP_PARSE_OK);
+    assert(req.methodLen == 4 && memcmp(req.method, "POST", 4) == 0);
+    assert(req.pathLen == 11 && memcmp(req.path, "/api/signin", 11) == 0);
+    assert(req.queryLen == 3 && memcmp(req.query, "x=1", 3) == 0);
+    assert(req.minorVersion == 1 && req.keepAlive);
+    assert(req.headerCount == 3);
+    const HttpHeader *auth = httpFindHeader(&req, "authorization");
+    assert(auth && auth->valueLen == 10 && memcmp(auth->value, "Bearer abc", 10) == 0);
+    assert(req.contentLength == 2 && memcmp(req.body, "{}", 2) == 0);
+    // The parser points into the caller's buffer and stops at the frame boundary
+    assert(req.body >= text && req.body < text + strlen(text));
+    assert(memcmp(text + req.headerBytes + req.contentLength, "GET /next", 9) == 0);
+    printf("✅ HTTP request parse: PASS\n");
+}
+
+void test_parse_edge_cases() {
+    HttpRequest req;
+    assert(parse("GET /api/ping HTTP/1.1\r\nHost: a\r\n", &req) == HTTP_PARSE_INCOMPLETE);
+    assert(parse("POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nab", &req) == HTTP_PARSE_INCOMPLETE);
+    assert(parse("GET /a HTTP/1.0\r\n\r\n", &req) == HTTP_PARSE_OK && !req.keepAlive);
+    assert(parse("GET /a HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", &req) == HTTP_PARSE_OK && req.keepAlive);
+    assert(parse("GET /a HTTP/1.1\r\nConnection: upgrade, close\r\n\r\n", &req) == HTTP_PARSE_OK && !req.keepAlive);
+    assert(parse("GET /a HTTP/1.1\nHost: bare-lf\n\n", &req) == HTTP_PARSE_OK);
+
+    assert(parse("GET /a HTTP/2.0\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("GET a HTTP/1.1\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("GET /a HTTP/1.1\r\nBad Header: x\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("GET /a HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("POST /a HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("POST /a HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", &req) == HTTP_PARSE_BAD_REQUEST);
+    assert(parse("POST /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", &req) == HTTP_PARSE_UNSUPPORTED);
+
+    assert(parse("POST /a HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n", &req) == HTTP_PARSE_TOO_LARGE);
+    assert(req.contentLength > 0);
+    static char head[8192];
+    strcpy(head, "GET /a HTTP/1.1\r\nX-Big: ");
+    memset(head + strlen(head), 'a', 5000);
+    assert(parse(head, &req) == HTTP_PARSE_TOO_LARGE && req.contentLength == 0);
+    printf("✅ HTTP parse edge cases: PASS\n");
+}
+
+static void *runServer(void *arg) {
+    assert(serverRun((const ServerConfig*)arg) == SUCCESS);
+    return NULL;
+}
+
+static int connectClient(void) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, TEST_SOCKET);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    return fd;
+}
+
+static void sendAll(int fd, const char *text) {
+    size_t len = strlen(text), sent = 0;
+    while (sent < len) {
+        ssize_t n = write(fd, text + sent, len - sent);
+        assert(n > 0);
+        sent += (size_t)n;
+    }
+}
+
+// Reads until EOF (the server closes after Connection: close)
+static size_t readAll(int fd, char *buf, size_t size) {
+    size_t len = 0;
+    ssize_t n;
+    while (len + 1 < size && (n = read(fd, buf + len, size - 1 - len)) > 0) len += (size_t)n;
+    buf[len] = '\0';
+    return len;
+}
+
+static int countOf(const char *haystack, const char *needle) {
+    int count = 0;
+    for (const char *p = strstr(haystack, needle); p; p = strstr(p + 1, needle)) count++;
+    return count;
+}
+
+void test_keepalive_pipelining() {
+    char buf[16384];
+    int fd = connectClient();
+    // Three requests in one write; the last asks the server to close
+    sendAll(fd, "GET /api/ping HTTP/1.1\r\nHost: t\r\n\r\n"
+                "GET /api/nowhere HTTP/1.1\r\nHost: t\r\n\r\n"
+                "POST /api/ping HTTP/1.1\r\nHost: t\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+
+    char *first = strstr(buf, "HTTP/1.1 200 OK\r\n");
+    char *second = strstr(buf, "HTTP/1.1 404 Not Found\r\n");
+    char *third = strstr(buf, "HTTP/1.1 405 Method Not Allowed\r\n");
+    assert(first == buf && second > first && third > second);
+    assert(strstr(first, "Content-Length: 23\r\n"));
+    assert(strstr(first, "{\"pong\":true,\"ok\":true}"));
+    assert(strstr(third, "Allow: GET\r\n"));
+    assert(strstr(third, "Connection: close\r\n"));
+    assert(countOf(buf, "HTTP/1.1 ") == 3);
+    printf("✅ HTTP keep-alive pipelining: PASS\n");
+}
+
+void test_api_over_http() {
+    char buf[16384], req[2048], body[1024], userID[32], ticket[64], token[64], otp[7];
+    unsigned tag = (unsigned)getpid() % 100000u;
+
+    snprintf(body, sizeof(body),
+             "{\"campus\":\"college\",\"name\":\"Http Test\",\"institute\":\"Test College\","
+             "\"department\":\"CS\",\"fields\":[\"Algorithms\"],\"email\":\"http%u@example.com\","
+             "\"mobile\":\"7%09u\",\"password\":\"Str0ng!Pass\"}", tag, tag * 11u);
+    snprintf(req, sizeof(req), "POST /api/signup HTTP/1.1\r\nHost: t\r\nContent-Type: application/json\r\n"
+             "Content-Length: %zu\r\nConnection: close\r\n\r\n%s", strlen(body), body);
+    int fd = connectClient();
+    sendAll(fd, req);
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 201 Created\r\n", 22) == 0);
+    const char *p = strstr(buf, "\"userID\":\"");
+    assert(p);
+    sscanf(p + 10, "%31[^\"]", userID);
+
+    snprintf(body, sizeof(body), "{\"user\":\"%s\",\"mobile\":\"7%09u\",\"password\":\"Str0ng!Pass\"}", userID, tag * 11u);
+    snprintf(req, sizeof(req), "POST /api/signin HTTP/1.1\r\nHost: t\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s",
+             strlen(body), body);
+    fd = connectClient();
+    sendAll(fd, req);
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    p = strstr(buf, "\"ticket\":\"");
+    assert(p);
+    sscanf(p + 10, "%63[^\"]", ticket);
+
+    snprintf(req, sizeof(req), "data/%s_otp.dat", userID);
+    FILE *f = fopen(req, "rb");
+    assert(f && fread(otp, 1, 6, f) == 6);
+    fclose(f);
+    otp[6] = '\0';
+    snprintf(body, sizeof(body), "{\"ticket\":\"%s\",\"otp\":\"%s\"}", ticket, otp);
+    snprintf(req, sizeof(req), "POST /api/verify-otp HTTP/1.1\r\nHost: t\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s",
+             strlen(body), body);
+    fd = connectClient();
+    sendAll(fd, req);
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    p = strstr(buf, "\"token\":\"");
+    assert(p);
+    snprintf(token, sizeof(token), "%.32s", p + 9);
+
+    // Authenticated requests pipelined on one connection; the report is
+    // rendered in memory and sent between two JSON responses
+    snprintf(body, sizeof(body), "{\"marks\":[75],\"credits\":[4]}");
+    snprintf(req, sizeof(req),
+             "PUT /api/data HTTP/1.1\r\nHost: t\r\nAuthorization: Bearer %s\r\nContent-Length: %zu\r\n\r\n%s"
+             "GET /api/report HTTP/1.1\r\nHost: t\r\nAuthorization: Bearer %s\r\n\r\n"
+             "GET /api/data HTTP/1.1\r\nHost: t\r\nAuthorization: Bearer %s\r\n\r\n"
+             "GET /api/profile HTTP/1.1\r\nHost: t\r\nAuthorization: Bearer nope\r\nConnection: close\r\n\r\n",
+             token, strlen(body), body, token, token);
+    fd = connectClient();
+    sendAll(fd, req);
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    char *report = strstr(buf, "Content-Type: application/pdf\r\n");
+    assert(report);
+    char disposition[128];
+    snprintf(disposition, sizeof(disposition),
+             "Content-Disposition: attachment; filename=\"%s_college_transcript.pdf\"\r\n", userID);
+    assert(strstr(report, disposition));
+    size_t reportLength = strtoul(strstr(report, "Content-Length: ") + 16, NULL, 10);
+    char *pdf = strstr(report, "\r\n\r\n") + 4;
+    assert(memcmp(pdf, "%PDF-1.4\n", 9) == 0);
+    assert(memcmp(pdf + reportLength - 6, "%%EOF\n", 6) == 0);
+    assert(strstr(pdf, "(CGPA: 7.50"));
+    char *data = pdf + reportLength;
+    assert(strncmp(data, "HTTP/1.1 200 OK\r\n", 17) == 0 && strstr(data, "\"cgpa\":7.50"));
+    char *unauthorized = strstr(data, "HTTP/1.1 401 Unauthorized\r\n");
+    assert(unauthorized && strstr(unauthorized, "WWW-Authenticate: Bearer\r\n"));
+    snprintf(req, sizeof(req), "data/%s_college_transcript.pdf", userID);
+    assert(access(req, F_OK) != 0);     // nothing written to the data directory
+    printf("✅ API over HTTP: PASS\n");
+}
+
+void test_protocol_errors() {
+    char buf[4096];
+    int fd = connectClient();
+    sendAll(fd, "GARBAGE\r\n\r\nGET /api/ping HTTP/1.1\r\n\r\n");
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 400 Bad Request\r\n", 26) == 0);
+    assert(countOf(buf, "HTTP/1.1 ") == 1);     // nothing after a rejected frame
+
+    fd = connectClient();
+    sendAll(fd, "POST /api/signup HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 501 Not Implemented\r\n", 30) == 0);
+
+    fd = connectClient();
+    sendAll(fd, "POST /api/signup HTTP/1.1\r\nContent-Length: 999999\r\n\r\n");
+    readAll(fd, buf, sizeof(buf));
+    close(fd);
+    assert(strncmp(buf, "HTTP/1.1 413 Content Too Large\r\n", 32) == 0);
+    printf("✅ HTTP protocol errors: PASS\n");
+}
+
+int main() {
+    test_parse_request();
+    test_parse_edge_cases();
+
+    assert(initDatabase() == SUCCESS);
+    static ServerConfig config;
+    config = serverDefaultConfig();
+    config.protocol = SERVER_PROTOCOL_HTTP;
+    config.unixPath = TEST_SOCKET;
+    config.workers = 2;
+    assert(pthread_create(&serverThread, NULL, runServer, &config) == 0);
+    assert(serverWaitReady(2000));
+
+    test_keepalive_pipelining();
+    test_api_over_http();
+    test_protocol_errors();
+
+    serverStop();
+    pthread_join(serverThread, NULL);
+    closeDatabase();
+    printf("✅ All HTTP tests passed\n");
+    return 0;
+}
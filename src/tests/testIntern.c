@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/intern.h"
+#include "../include/report_cache.h"
+#include "../include/sqlite3.h"
+#include "testHelpers.h"
+
+#define TEST_DB      "data/campus.db"
+#define TEST_THREADS 8
+#define TEST_NAMES   300
+
+static char tag[12];
+
+static void name(char *out, size_t size, const char *kind, int i) {
+    snprintf(out, size, "%s %s %d", kind, tag, i);
+}
+
+static uint32_t idOf(const char *text) {
+    uint32_t id = 0;
+    assert(internString(text, &id) == SUCCESS);
+    return id;
+}
+
+static void test_basics(void) {
+    char physics[64], text[INTERN_TEXT_MAX];
+    name(physics, sizeof(physics), "Physics", 0);
+    uint32_t id = idOf(physics);
+    assert(id != 0 && idOf(physics) == id);
+    assert(internText(id, text, sizeof(text)) == SUCCESS && strcmp(text, physics) == 0);
+
+    uint32_t found = 0;
+    assert(internFind(physics, &found) == SUCCESS && found == id);
+    assert(idOf("") == 0 && internText(0, text, sizeof(text)) == SUCCESS && text[0] == '\0');
+
+    char unseen[64];
+    name(unseen, sizeof(unseen), "Never Interned", 0);
+    assert(internFind(unseen, &found) == ERROR_NOT_FOUND);
+    assert(internText(0x7fffffffu, text, sizeof(text)) == ERROR_NOT_FOUND);
+
+    char tooLong[INTERN_TEXT_MAX + 1];
+    memset(tooLong, 'x', INTERN_TEXT_MAX);
+    tooLong[INTERN_TEXT_MAX] = '\0';
+    assert(internString(tooLong, &found) == ERROR_INVALID_INPUT);
+
+    // Truncated to the caller's buffer like the columns it replaces
+    char small[8];
+    assert(internText(id, small, sizeof(small)) == SUCCESS && strncmp(small, physics, 7) == 0 && small[7] == '\0');
+    printf("✅ Intern, find and resolve: PASS\n");
+}
+
+// A name first added inside a transaction that rolls back must not leave a
+// cached id behind: the next name may be given the same id
+static void test_rollback(void) {
+    char doomed[64], next[64], text[INTERN_TEXT_MAX];
+    name(doomed, sizeof(doomed), "Rolled Back", 0);
+    name(next, sizeof(next), "Committed", 0);
+    InternStats before, after;
+    internGetStats(&before);
+
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    uint32_t id = idOf(doomed);
+    assert(idOf(doomed) == id);
+    assert(internText(id, text, sizeof(text)) == SUCCESS && strcmp(text, doomed) == 0);
+    internGetStats(&after);
+    assert(after.strings == before.strings);
+    assert(executeQuery("ROLLBACK;") == SUCCESS);
+
+    uint32_t found;
+    assert(internFind(doomed, &found) == ERROR_NOT_FOUND);
+    uint32_t reused = idOf(next);
+    assert(internText(reused, text, sizeof(text)) == SUCCESS && strcmp(text, next) == 0);
+    internGetStats(&after);
+    assert(after.strings == before.strings + 1);
+    printf("✅ Rolled back names are never cached: PASS\n");
+}
+
+typedef struct {
+    int index;
+    uint32_t ids[TEST_NAMES];
+    int failures;
+} Worker;
+
+// Even workers intern through their own connection (as report and re-grade
+// workers do); odd ones share the main connection and only find and resolve,
+// racing the writers for the same names
+static void *internWorker(void *arg) {
+    Worker *w = (Worker*)arg;
+    int writer = w->index % 2 == 0;
+    if (writer && openThreadConnection() != SUCCESS) {
+        w->failures++;
+        return NULL;
+    }
+    for (int round = 0; round < 3; round++) {
+        for (int k = 0; k < TEST_NAMES; k++) {
+            int i = (k * 7 + w->index * 31) % TEST_NAMES;
+            char text[64], back[INTERN_TEXT_MAX];
+            name(text, sizeof(text), "Subject", i);
+            uint32_t id = 0;
+            ErrorCode rc = writer ? internString(text, &id) : internFind(text, &id);
+            if (rc == ERROR_NOT_FOUND && !writer) continue;
+            if (rc != SUCCESS || id == 0 || (w->ids[i] && id != w->ids[i])) w->failures++;
+            w->ids[i] = id;
+            if (internText(id, back, sizeof(back)) != SUCCESS || strcmp(back, text) != 0) w->failures++;
+        }
+    }
+    if (writer) closeThreadConnection();
+    return NULL;
+}
+
+static void test_concurrent(void) {
+    pthread_t threads[TEST_THREADS];
+    static Worker workers[TEST_THREADS];
+    for (int t = 0; t < TEST_THREADS; t++) {
+        workers[t].index = t;
+        assert(pthread_create(&threads[t], NULL, internWorker, &workers[t]) == 0);
+    }
+    for (int t = 0; t < TEST_THREADS; t++) pthread_join(threads[t], NULL);
+    for (int t = 0; t < TEST_THREADS; t++) {
+        assert(workers[t].failures == 0);
+        for (int i = 0; i < TEST_NAMES; i++) {
+            assert(workers[t].ids[i] == workers[0].ids[i] || (t % 2 == 1 && workers[t].ids[i] == 0));
+        }
+    }
+    for (int i = 0; i < TEST_NAMES; i++) {
+        for (int j = 0; j < i; j++) assert(workers[0].ids[i] != workers[0].ids[j]);
+    }
+    printf("✅ %d threads agree on %d ids: PASS\n", TEST_THREADS, TEST_NAMES);
+}
+
+static void makeProfile(Profile *p, const char *userID) {
+    char institute[MAX_LEN];
+    name(institute, sizeof(institute), "Institute", 1);
+    testProfile(p, userID, institute, "", CAMPUS_SCHOOL);
+    strcpy(p->name, "Interned Student");
+    p->dataCount = 3;
+    name(p->dataFields[0], sizeof(p->dataFields[0]), "Subject", 1);
+    name(p->dataFields[1], sizeof(p->dataFields[1]), "Subject", 2);
+    name(p->dataFields[2], sizeof(p->dataFields[2]), "Subject", 1);
+    testMobile(p, '5', (int)(getpid() % 1000000000));
+}
+
+static void makeMarks(SchoolMarks *m, const Profile *p) {
+    memset(m, 0, sizeof(*m));
+    m->count = 3;
+    for (int i = 0; i < 3; i++) {
+        strcpy(m->subjects[i], p->dataFields[i]);
+        m->marks[i] = 60 + i * 10;
+        m->fullMarks[i] = 100;
+    }
+}
+
+// typeof and length of stored columns, straight from the file
+static void storedShape(const char *userID, char *instituteType, size_t size, int *blobBytes) {
+    sqlite3 *raw;
+    sqlite3_stmt *stmt;
+    assert(sqlite3_open(TEST_DB, &raw) == SQLITE_OK);
+    assert(sqlite3_prepare_v2(raw, "SELECT typeof(u.institute_id), length(d.blob_data) FROM users u "
+                                   "JOIN user_data d ON d.user_id = u.user_id WHERE u.user_id = ?;",
+                              -1, &stmt, 0) == SQLITE_OK);
+    sqlite3_bind_text(stmt, 1, userID, -1, SQLITE_STATIC);
+    assert(sqlite3_step(stmt) == SQLITE_ROW);
+    snprintf(instituteType, size, "%s", (const char*)sqlite3_column_text(stmt, 0));
+    *blobBytes = sqlite3_column_int(stmt, 1);
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+}
+
+static void expectMarks(const char *userID, const SchoolMarks *expected) {
+    SchoolMarks loaded;
+    size_t size = sizeof(loaded);
+    assert(loadUserData(userID, "SCHOOL_DATA", &loaded, &size));
+    assert(size == sizeof(SchoolMarks) && memcmp(&loaded, expected, sizeof(loaded)) == 0);
+    uint64_t version;
+    assert(getUserDataVersion(userID, "SCHOOL_DATA", &version) == SUCCESS);
+    assert(version == reportCacheHash(REPORT_CACHE_HASH_SEED, &loaded, sizeof(loaded)));
+}
+
+static void test_profile_rows(const char *userID) {
+    Profile p, back;
+    makeProfile(&p, userID);
+    assert(createUser(&p) == SUCCESS);
+    assert(getUserByID(userID, &back));
+    assert(memcmp(&p, &back, sizeof(p)) == 0);
+
+    SchoolMarks m;
+    makeMarks(&m, &p);
+    assert(saveUserData(userID, "SCHOOL_DATA", &m, sizeof(m)));
+    expectMarks(userID, &m);
+
+    char type[16];
+    int bytes;
+    storedShape(userID, type, sizeof(type), &bytes);
+    assert(strcmp(type, "integer") == 0 && bytes > 0 && (size_t)bytes < sizeof(SchoolMarks) / 8);
+
+    // The institute filter compares ids; an unknown name matches nobody
+    char (*ids)[20] = NULL;
+    size_t count = 0;
+    assert(listUsersByInstitute(p.instituteName, CAMPUS_SCHOOL, &ids, &count) == SUCCESS);
+    assert(count == 1 && strcmp(ids[0], userID) == 0);
+    free(ids);
+    char unseen[64];
+    name(unseen, sizeof(unseen), "Nowhere Institute", 0);
+    assert(listUsersByInstitute(unseen, CAMPUS_SCHOOL, &ids, &count) == SUCCESS && count == 0);
+    free(ids);
+
+    name(p.department, sizeof(p.department), "Department", 1);
+    assert(updateUser(&p));
+    assert(getUserByID(userID, &back) && memcmp(&p, &back, sizeof(p)) == 0);
+    printf("✅ Profiles and marks store ids (%d byte blob): PASS\n", bytes);
+}
+
+// A v3 database (names as text, whole-struct blobs) is converted on open
+// and reads back the same
+static void test_migration(const char *userID) {
+    Profile before, after;
+    assert(getUserByID(userID, &before));
+    SchoolMarks m;
+    makeMarks(&m, &before);
+    closeDatabase();
+
+    sqlite3 *raw;
+    assert(sqlite3_open(TEST_DB, &raw) == SQLITE_OK);
+    char sql[4096];
+    size_t len = (size_t)snprintf(sql, sizeof(sql),
+        "BEGIN;"
+        "CREATE TABLE users_v3 (user_id TEXT PRIMARY KEY, name TEXT, institute_name TEXT, department TEXT, "
+        "campus_type INTEGER, data_count INTEGER, email TEXT, mobile TEXT, password_hash TEXT, "
+        "field0 TEXT, field1 TEXT, field2 TEXT, field3 TEXT, field4 TEXT, "
+        "field5 TEXT, field6 TEXT, field7 TEXT, field8 TEXT, field9 TEXT);"
+        "INSERT INTO users_v3 SELECT user_id, name");
+    const char *columns[] = { "institute_id", "department_id", "field0", "field1", "field2", "field3",
+                              "field4", "field5", "field6", "field7", "field8", "field9" };
+    for (int i = 0; i < 12; i++) {
+        len += (size_t)snprintf(sql + len, sizeof(sql) - len,
+                                ", CASE WHEN %s = 0 THEN '' ELSE (SELECT text FROM strings WHERE id = %s) END%s",
+                                columns[i], columns[i],
+                                i == 1 ? ", campus_type, data_count, email, mobile, password_hash" : "");
+    }
+    snprintf(sql + len, sizeof(sql) - len,
+             " FROM users; DROP TABLE users; ALTER TABLE users_v3 RENAME TO users;"
+             "PRAGMA user_version = 3; COMMIT;");
+    assert(sqlite3_exec(raw, sql, 0, 0, NULL) == SQLITE_OK);
+    sqlite3_stmt *stmt;
+    assert(sqlite3_prepare_v2(raw, "UPDATE user_data SET blob_data = ? WHERE user_id = ? AND data_type = 'SCHOOL_DATA';",
+                              -1, &stmt, 0) == SQLITE_OK);
+    sqlite3_bind_blob(stmt, 1, &m, sizeof(m), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, userID, -1, SQLITE_STATIC);
+    assert(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+
+    assert(initDatabase() == SUCCESS);
+    assert(getUserByID(userID, &after) && memcmp(&before, &after, sizeof(before)) == 0);
+    expectMarks(userID, &m);
+    char type[16];
+    int bytes;
+    storedShape(userID, type, sizeof(type), &bytes);
+    assert(strcmp(type, "integer") == 0 && (size_t)bytes < sizeof(SchoolMarks) / 8);
+
+    // Ids survive the restart: the cache starts empty and is filled from the table
+    uint32_t id;
+    assert(internFind(before.instituteName, &id) == SUCCESS);
+    char text[INTERN_TEXT_MAX];
+    assert(internText(id, text, sizeof(text)) == SUCCESS && strcmp(text, before.instituteName) == 0);
+    printf("✅ v4 migration of text names and whole blobs: PASS\n");
+}
+
+int main() {
+    snprintf(tag, sizeof(tag), "it%05u", (unsigned)getpid() % 100000u);
+    char userID[20];
+    snprintf(userID, sizeof(userID), "%s_u", tag);
+    assert(initDatabase() == SUCCESS);
+    test_basics();
+    test_rollback();
+    test_concurrent();
+    test_profile_rows(userID);
+    test_migration(userID);
+    // Deletes are audited under their own code
+    long before[EVENT_COUNT], after[EVENT_COUNT];
+    assert(getAuditEventCounts(before));
+    assert(deleteUser(userID) == SUCCESS);
+    assert(getAuditEventCounts(after));
+    assert(after[EVENT_USER_DELETED] == before[EVENT_USER_DELETED] + 1 && after[EVENT_NOTE] == before[EVENT_NOTE]);
+    closeDatabase();
+    printf("✅ All intern tests passed\n");
+    return 0;
+}
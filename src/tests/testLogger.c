@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "../include/logger.h"
+
+#define TEST_LOG_PATH   "test_logger.log"
+#define TEST_THREADS    4
+#define TEST_EVENTS     5000
+
+static int countLines(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int lines = 0, c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+static void removeLogs(void) {
+    char name[64];
+    remove(TEST_LOG_PATH);
+    for (int i = 1; i <= 5; i++) {
+        snprintf(name, sizeof(name), TEST_LOG_PATH ".%d", i);
+        remove(name);
+    }
+}
+
+static void *producer(void *arg) {
+    int id = *(int*)arg;
+    char user[20];
+    snprintf(user, sizeof(user), "tl25%03d", id);
+    for (int i = 0; i < TEST_EVENTS; i++) {
+        loggerSubmit(user, "Viewed profile");
+    }
+    return NULL;
+}
+
+void test_block_policy_keeps_every_event() {
+    removeLogs();
+    LoggerConfig config = loggerDefaultConfig();
+    config.path = TEST_LOG_PATH;
+    config.capacity = 64;           // small ring so producers hit the full path
+    config.maxFileBytes = 0;
+    config.policy = LOG_POLICY_BLOCK;
+    assert(loggerStart(&config) == SUCCESS);
+
+    pthread_t threads[TEST_THREADS];
+    int ids[TEST_THREADS];
+    for (int i = 0; i < TEST_THREADS; i++) {
+        ids[i] = i;
+        pthread_create(&threads[i], NULL, producer, &ids[i]);
+    }
+    for (int i = 0; i < TEST_THREADS; i++) pthread_join(threads[i], NULL);
+    loggerFlush();
+
+    LoggerStats stats;
+    loggerGetStats(&stats);
+    assert(loggerStop() == SUCCESS);
+
+    assert(stats.dropped == 0);
+    assert(stats.written == (unsigned long long)TEST_THREADS * TEST_EVENTS);
+    assert(countLines(TEST_LOG_PATH) == TEST_THREADS * TEST_EVENTS);
+    printf("✅ logger block policy: PASS (%llu events)\n", stats.written);
+}
+
+void test_drop_policy_accounts_for_every_event() {
+    removeLogs();
+    LoggerConfig config = loggerDefaultConfig();
+    config.path = TEST_LOG_PATH;
+    config.capacity = 8;
+    config.maxFileBytes = 0;
+    config.policy = LOG_POLICY_DROP;
+    assert(loggerStart(&config) == SUCCESS);
+
+    for (int i = 0; i < 20000; i++) {
+        loggerSubmit("tl25000", "Burst");
+    }
+    loggerFlush();
+
+    LoggerStats stats;
+    loggerGetStats(&stats);
+    assert(loggerStop() == SUCCESS);
+
+    assert(stats.submitted == 20000);
+    assert(stats.written + stats.dropped == stats.submitted);
+    assert(countLines(TEST_LOG_PATH) == (int)stats.written);
+    printf("✅ logger drop policy: PASS (%llu written, %llu dropped)\n", stats.written, stats.dropped);
+}
+
+void test_size_based_rotation() {
+    removeLogs();
+    LoggerConfig config = loggerDefaultConfig();
+    config.path = TEST_LOG_PATH;
+    config.maxFileBytes = 4096;
+    config.maxRotatedFiles = 2;
+    config.policy = LOG_POLICY_BLOCK;
+    assert(loggerStart(&config) == SUCCESS);
+
+    for (int i = 0; i < 1000; i++) {
+        loggerSubmit("tl25001", "Rotation check");
+    }
+    loggerFlush();
+
+    LoggerStats stats;
+    loggerGetStats(&stats);
+    assert(loggerStop() == SUCCESS);
+
+    FILE *rotated = fopen(TEST_LOG_PATH ".1", "r");
+    FILE *pruned = fopen(TEST_LOG_PATH ".3", "r");
+    assert(stats.rotations > 0);
+    assert(rotated != NULL);
+    assert(pruned == NULL);
+    fclose(rotated);
+    printf("✅ logger rotation: PASS (%llu rotations)\n", stats.rotations);
+    removeLogs();
+}
+
+int main() {
+    printf("==== Logger Tests ====\n");
+    test_block_policy_keeps_every_event();
+    test_drop_policy_accounts_for_every_event();
+    test_size_based_rotation();
+    return 0;
+}
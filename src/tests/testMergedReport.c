@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/pdf_writer.h"
+#include "../include/report_merge.h"
+#include "testHelpers.h"
+
+#define TEST_USERS 300      // more than two page tree leaves
+
+static char ids[TEST_USERS][20];
+static char institute[64];
+
+static char *readFile(const char *path, size_t *length) {
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char *data = malloc((size_t)size + 1);
+    assert(data && fread(data, 1, (size_t)size, f) == (size_t)size);
+    data[size] = '\0';
+    fclose(f);
+    *length = (size_t)size;
+    return data;
+}
+
+static size_t countOf(const char *data, size_t length, const char *needle) {
+    size_t n = 0, len = strlen(needle);
+    for (size_t i = 0; i + len <= length; i++) n += memcmp(data + i, needle, len) == 0;
+    return n;
+}
+
+// Checks the trailer, that every xref entry points at its "N 0 obj" and
+// returns the number of objects
+static unsigned checkStructure(const char *pdf, size_t length) {
+    assert(memcmp(pdf, "%PDF-1.4\n", 9) == 0);
+    assert(length > 6 && memcmp(pdf + length - 6, "%%EOF\n", 6) == 0);
+    const char *startxref = strstr(pdf + length - 40, "startxref\n");
+    assert(startxref);
+    size_t xref = strtoul(startxref + 10, NULL, 10);
+    assert(xref < length && memcmp(pdf + xref, "xref\n0 ", 7) == 0);
+    unsigned objects = (unsigned)strtoul(pdf + xref + 7, NULL, 10);
+    const char *entry = strchr(pdf + xref + 5, '\n') + 1;
+    assert(memcmp(entry, "0000000000 65535 f\r\n", 20) == 0);
+    for (unsigned obj = 1; obj < objects; obj++) {
+        entry += 20;
+        assert(entry[17] == 'n' && entry[18] == '\r' && entry[19] == '\n');
+        size_t offset = strtoul(entry, NULL, 10);
+        char expect[32];
+        int n = snprintf(expect, sizeof(expect), "%u 0 obj\n", obj);
+        assert(offset < length && memcmp(pdf + offset, expect, (size_t)n) == 0);
+    }
+    char trailer[64];
+    snprintf(trailer, sizeof(trailer), "trailer\n<< /Size %u /Root 1 0 R >>", objects);
+    assert(strstr(entry + 20, trailer) == entry + 20);
+    return objects;
+}
+
+void test_writer() {
+    const char *path = "data/test_writer.pdf";
+    FILE *out = fopen(path, "wb");
+    PdfWriter *w = pdfWriterOpen(out);
+    assert(w);
+    assert(pdfText(w, 0, 0, "no page") == ERROR_INVALID_INPUT);
+    for (int i = 0; i < PDF_PAGE_GROUP + 3; i++) {
+        assert(pdfBeginPage(w, PDF_A4_WIDTH, PDF_A4_HEIGHT) == SUCCESS);
+        assert(pdfText(w, 50, 700, "no font") == ERROR_INVALID_INPUT);
+        assert(pdfSetFont(w, i % 2 ? PDF_FONT_TIMES_BOLD : PDF_FONT_HELVETICA, 12) == SUCCESS);
+        assert(pdfText(w, 50, 700, "Caf\xC3\xA9 (A+) \\ \xE2\x82\xAC") == SUCCESS);
+        assert(pdfEndPage(w) == SUCCESS);
+    }
+    assert(pdfPageCount(w) == PDF_PAGE_GROUP + 3);
+    assert(pdfWriterClose(w, 0) == SUCCESS);
+    fclose(out);
+
+    size_t length;
+    char *pdf = readFile(path, &length);
+    // 2 leaves + pages + 2 fonts + catalog, root and object 0
+    assert(checkStructure(pdf, length) == 3 + 2 + 2 * (PDF_PAGE_GROUP + 3) + 2);
+    assert(strstr(pdf, "(Caf\\351 \\(A+\\) \\\\ ?) Tj"));
+    assert(countOf(pdf, length, "/BaseFont /Helvetica ") == 1);
+    assert(countOf(pdf, length, "/BaseFont /Times-Bold ") == 1);
+    assert(strstr(pdf, "<< /Type /Pages /Count 131 /Kids ["));
+    assert(countOf(pdf, length, "/Type /Pages /Parent 2 0 R /Count 128 ") == 1);
+    assert(countOf(pdf, length, "/Type /Pages /Parent 2 0 R /Count 3 ") == 1);
+    assert(pdfFontByName("Courier-BoldOblique") == PDF_FONT_COURIER_BOLD_OBLIQUE);
+    assert(pdfFontByName("Arial") == -1);
+    free(pdf);
+    remove(path);
+    printf("✅ Streaming PDF writer: PASS\n");
+}
+
+// School users whose percentage falls as the index rises; every 7th has no marks
+static void seedUsers(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(institute, sizeof(institute), "Merge School %u", tag);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_USERS; i++) {
+        Profile p;
+        // IDs run opposite to rank so the two orders differ
+        snprintf(ids[i], sizeof(ids[i]), "mr%05u%04d", tag, TEST_USERS - i);
+        testProfile(&p, ids[i], institute, "Grade 10", CAMPUS_SCHOOL);
+        snprintf(p.name, sizeof(p.name), "Student %d", i);
+        testSubjects(&p, 1, "Math");
+        testMobile(&p, '5', i);
+        assert(createUser(&p) == SUCCESS);
+        if (i % 7 == 6) continue;
+
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = 1;
+        strcpy(m.subjects[0], "Math");
+        m.marks[0] = 1000 - i;
+        m.fullMarks[0] = 1000;
+        assert(saveUserData(p.userID, "SCHOOL_DATA", &m, sizeof(m)));
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+// Percentages of the pages in file order
+static int pagePercentages(const char *pdf, float *out, int max) {
+    int n = 0;
+    for (const char *p = pdf; n < max && (p = strstr(p, "(Percentage: ")) != NULL; p++) {
+        out[n++] = strtof(p + 13, NULL);
+    }
+    return n;
+}
+
+void test_merged_orders() {
+    const char *path = "data/test_merged.pdf";
+    int expected = TEST_USERS - TEST_USERS / 7;
+    MergedReportStats stats;
+    size_t length;
+    static float pct[TEST_USERS];
+
+    assert(writeInstituteMergedReport(institute, CAMPUS_SCHOOL, REPORT_ORDER_RANK, path, &stats) == SUCCESS);
+    assert(stats.users == TEST_USERS && stats.pages == (size_t)expected);
+    assert(stats.missingData == TEST_USERS / 7);
+    char *pdf = readFile(path, &length);
+    assert(stats.bytes == length);
+    checkStructure(pdf, length);
+    assert(countOf(pdf, length, "/Type /Page ") == (size_t)expected);
+    assert(countOf(pdf, length, "/Type /Font ") == 1);         // shared by every page
+    assert(pagePercentages(pdf, pct, TEST_USERS) == expected);
+    for (int i = 1; i < expected; i++) assert(pct[i] < pct[i - 1]);
+    free(pdf);
+
+    // User ID order: here the lowest percentage comes first
+    assert(writeInstituteMergedReport(institute, CAMPUS_SCHOOL, REPORT_ORDER_ID, path, &stats) == SUCCESS);
+    pdf = readFile(path, &length);
+    checkStructure(pdf, length);
+    assert(pagePercentages(pdf, pct, TEST_USERS) == expected);
+    for (int i = 1; i < expected; i++) assert(pct[i] > pct[i - 1]);
+    free(pdf);
+
+    // Nothing printable: no file
+    remove(path);
+    char none[2][20] = { "missing-1", "" };
+    strcpy(none[1], ids[6]);
+    assert(writeMergedReport((const char (*)[20])none, 2, REPORT_ORDER_ID, path, &stats) == ERROR_NOT_FOUND);
+    assert(stats.missingData == 2 && access(path, F_OK) != 0);
+    assert(writeInstituteMergedReport("No Such School", CAMPUS_SCHOOL, REPORT_ORDER_ID, path, &stats) == ERROR_NOT_FOUND);
+    printf("✅ Merged report in rank and user ID order: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    test_writer();
+    seedUsers();
+    test_merged_orders();
+    closeDatabase();
+    printf("✅ All merged report tests passed\n");
+    return 0;
+}
@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/database.h"
+#include "../include/campus_unified.h"
+#include "../include/campus_security.h"
+#include "../include/fileio.h"
+#include "../include/utils.h"
+#include "../include/migrate.h"
+#include "testHelpers.h"
+
+#define PROFILES 3000           // a chunk and a partial one
+#define RECORDS  500
+
+static char root[64], credDir[96], dataDir[96], prefix[8];
+
+static void removeTree(const char *path) {
+    DIR *d = opendir(path);
+    struct dirent *ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        if (remove(child) != 0) removeTree(child);
+    }
+    if (d) closedir(d);
+    rmdir(path);
+}
+
+static void writeFile(const char *dir, const char *name, const void *bytes, size_t length) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    assert(f && fwrite(bytes, 1, length, f) == length);
+    fclose(f);
+}
+
+static int fileExists(const char *dir, const char *name) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static Profile profile(int i) {
+    Profile p;
+    char id[20];
+    snprintf(id, sizeof(id), "%s%05d", prefix, i);
+    testProfile(&p, id, "Legacy Institute", "Archive", CAMPUS_COLLEGE);
+    snprintf(p.name, sizeof(p.name), "Legacy User %d", i);
+    testSubjects(&p, 2, "Physics", "Chemistry");
+    testMobile(&p, '9', i);
+    return p;
+}
+
+// What writeProfile put in credentials/
+static void writeLegacyProfile(const Profile *p) {
+    char path[150];
+    assert(getProfilePath(path, p->userID) == SUCCESS);
+    writeFile(credDir, path + strlen(CRED_DIR), p, sizeof(*p));
+}
+
+static void writeLegacyRecord(int i) {
+    UnifiedCampusData d;
+    memset(&d, 0, sizeof(d));
+    snprintf(d.userID, sizeof(d.userID), "%s%05d", prefix, i);
+    strcpy(d.name, "Legacy User");
+    d.campusType = CAMPUS_SCHOOL;
+    d.lastUpdated = 1600000000 + i;
+    d.grades.subjectCount = 2;
+    strcpy(d.grades.subjects[0], "Math");
+    strcpy(d.grades.subjects[1], "Art");
+    d.grades.marks[0] = i % 101;
+    d.grades.marks[1] = 50;
+    d.grades.weights[0] = d.grades.weights[1] = 100;
+    unsigned char record[CAMPUS_RECORD_MAX];
+    size_t length = campusRecordEncode(&d, record, sizeof(record));
+    char name[64];
+    snprintf(name, sizeof(name), "%s.data", d.userID);
+    writeFile(dataDir, name, record, length);
+}
+
+static void writeExpiryFile(const char *name, const char *otp, time_t expiry) {
+    unsigned char bytes[6 + sizeof(time_t)];
+    size_t at = 0;
+    if (otp) {
+        memcpy(bytes, otp, 6);
+        at = 6;
+    }
+    memcpy(bytes + at, &expiry, sizeof(expiry));
+    writeFile(dataDir, name, bytes, at + sizeof(expiry));
+}
+
+static void seed(void) {
+    for (int i = 0; i < PROFILES; i++) {
+        Profile p = profile(i);
+        writeLegacyProfile(&p);
+    }
+    for (int i = 0; i < RECORDS; i++) writeLegacyRecord(i);
+
+    // Files that must be rejected and left alone
+    Profile bad = profile(90000);
+    strcpy(bad.email, "not-an-email");
+    writeLegacyProfile(&bad);
+    bad = profile(90001);
+    strcpy(bad.mobile, "12345");
+    writeLegacyProfile(&bad);
+    bad = profile(90002);
+    writeFile(credDir, "someone-else.xxpfx", &bad, sizeof(bad));      // name does not match the ID
+    writeFile(credDir, "short.shpfx", &bad, sizeof(bad) / 2);
+    writeFile(dataDir, "garbage.data", "not a record at all", 19);
+    char name[64];
+    snprintf(name, sizeof(name), "%s%05d.data", prefix, 90003);        // record under another user's name
+    char from[128];
+    snprintf(from, sizeof(from), "%s%s%05d.data", dataDir, prefix, 1);
+    FILE *src = fopen(from, "rb");
+    unsigned char bytes[CAMPUS_RECORD_MAX];
+    size_t length = fread(bytes, 1, sizeof(bytes), src);
+    fclose(src);
+    writeFile(dataDir, name, bytes, length);
+    writeFile(dataDir, "lock_broken.dat", "x", 1);
+
+    // Two live locks, one expired; one live OTP, one expired
+    time_t now = time(NULL);
+    snprintf(name, sizeof(name), "lock_%s%05d.dat", prefix, 0);
+    writeExpiryFile(name, NULL, now + 600);
+    snprintf(name, sizeof(name), "lock_%s%05d.dat", prefix, 1);
+    writeExpiryFile(name, NULL, now + 900);
+    snprintf(name, sizeof(name), "lock_%s%05d.dat", prefix, 2);
+    writeExpiryFile(name, NULL, now - 60);
+    snprintf(name, sizeof(name), "%s%05d_otp.dat", prefix, 3);
+    writeExpiryFile(name, "123456", now + 300);
+    snprintf(name, sizeof(name), "%s%05d_otp.dat", prefix, 4);
+    writeExpiryFile(name, "654321", now - 300);
+
+    // Not a legacy file at all
+    writeFile(dataDir, "notes.txt", "x", 1);
+}
+
+// Profiles and bad profiles, records and bad records, locks, OTPs
+#define FILES (PROFILES + 4 + RECORDS + 2 + 4 + 2)
+
+static MigrateOptions options(void) {
+    MigrateOptions o = migrateDefaultOptions();
+    o.threads = 4;
+    o.credentialsDir = credDir;
+    o.dataDir = dataDir;
+    return o;
+}
+
+typedef struct {
+    int calls;
+    size_t lastDone;
+} ProgressLog;
+
+static void onProgress(const MigrateProgress *progress, void *ctx) {
+    ProgressLog *log = (ProgressLog*)ctx;
+    assert(progress->done > log->lastDone && progress->done <= progress->total);
+    log->lastDone = progress->done;
+    log->calls++;
+}
+
+void test_validate_profile() {
+    Profile p = profile(1);
+    assert(validateProfile(&p));
+    strcpy(p.email, "nope");
+    assert(!validateProfile(&p));
+    p = profile(1);
+    p.dataCount = MAX_SUBJECTS + 1;
+    assert(!validateProfile(&p));
+    printf("✅ validateProfile accepts valid profiles: PASS\n");
+}
+
+void test_migrate() {
+    MigrateOptions o = options();
+    o.restart = 1;                  // a reused pid may have left checkpoints for these directories
+    ProgressLog log = {0};
+    o.progress = onProgress;
+    o.ctx = &log;
+    MigrateStats stats;
+    assert(runLegacyMigration(&o, &stats) == SUCCESS);
+    assert(stats.files == FILES && stats.resumed == 0);
+    assert(stats.profiles == PROFILES && stats.records == RECORDS && stats.locks == 2);
+    assert(stats.present == 0 && stats.expired == 2 && stats.pendingOtp == 1);
+    assert(stats.invalid == 4 + 2 + 1 && stats.removed == 0);
+    assert(stats.chunks == 2 + 1 + 1 + 1 && log.calls == (int)stats.chunks && log.lastDone == FILES);
+    assert(stats.perSecond > 0);
+
+    for (int i = 0; i < PROFILES; i += 97) {
+        Profile want = profile(i), got;
+        assert(getUserByID(want.userID, &got));
+        assert(strcmp(got.email, want.email) == 0 && got.dataCount == 2 && strcmp(got.dataFields[1], "Chemistry") == 0);
+    }
+    char id[20];
+    snprintf(id, sizeof(id), "%s%05d", prefix, 90000);
+    Profile p;
+    assert(!getUserByID(id, &p));
+
+    // Records land where the app reads them
+    UnifiedCampusData data;
+    snprintf(id, sizeof(id), "%s%05d", prefix, 42);
+    assert(loadUnifiedCampusData(id, &data) == SUCCESS);
+    assert(data.grades.marks[0] == 42 && strcmp(data.userID, id) == 0);
+    snprintf(id, sizeof(id), "%s%05d", prefix, 90003);
+    assert(loadUnifiedCampusData(id, &data) == ERROR_NOT_FOUND);
+
+    // Imported locks are the ones sign-in checks
+    snprintf(id, sizeof(id), "%s%05d", prefix, 0);
+    assert(isAccountLocked(id));
+    snprintf(id, sizeof(id), "%s%05d", prefix, 2);
+    assert(!isAccountLocked(id) && getAccountLock(id) == 0);
+    printf("✅ Parallel migration of legacy files: PASS\n");
+}
+
+void test_resume() {
+    // Everything is behind the checkpoints now
+    MigrateOptions o = options();
+    MigrateStats stats;
+    assert(runLegacyMigration(&o, &stats) == SUCCESS);
+    assert(stats.files == FILES && stats.resumed == FILES && stats.chunks == 0 && stats.profiles == 0);
+
+    // New files sorting after the checkpoint are picked up on their own
+    for (int i = 0; i < 10; i++) {
+        Profile p = profile(i);
+        snprintf(p.userID, sizeof(p.userID), "zz%s%02d", prefix + 2, i);
+        writeLegacyProfile(&p);
+    }
+    assert(runLegacyMigration(&o, &stats) == SUCCESS);
+    assert(stats.resumed == FILES && stats.profiles == 10 && stats.chunks == 1);
+
+    // A restart reads everything again and keeps what the database has,
+    // including changes made since the first import
+    Profile changed = profile(5);
+    strcpy(changed.name, "Renamed Since");
+    assert(updateUser(&changed));
+    o.restart = 1;
+    assert(runLegacyMigration(&o, &stats) == SUCCESS);
+    assert(stats.resumed == 0 && stats.profiles == 0 && stats.records == 0);
+    assert(stats.present == PROFILES + 10 + RECORDS + 2 && stats.expired == 2);
+    Profile got;
+    assert(getUserByID(changed.userID, &got) && strcmp(got.name, "Renamed Since") == 0);
+    printf("✅ Resumable, and never overwrites newer rows: PASS\n");
+}
+
+void test_remove() {
+    MigrateOptions o = options();
+    o.restart = 1;
+    o.removeMigrated = 1;
+    MigrateStats stats;
+    assert(runLegacyMigration(&o, &stats) == SUCCESS);
+    assert(stats.present == PROFILES + 10 + RECORDS + 2 && stats.removed == stats.present + stats.expired);
+
+    // Left: invalid files, the live OTP and what is not a legacy file
+    char name[64];
+    snprintf(name, sizeof(name), "%s%05d_otp.dat", prefix, 3);
+    assert(fileExists(dataDir, name));
+    assert(fileExists(dataDir, "garbage.data") && fileExists(dataDir, "notes.txt"));
+    assert(fileExists(credDir, "short.shpfx"));
+    snprintf(name, sizeof(name), "%s%05d_otp.dat", prefix, 4);
+    assert(!fileExists(dataDir, name));
+    snprintf(name, sizeof(name), "%s%05d.data", prefix, 7);
+    assert(!fileExists(dataDir, name));
+
+    // The store is the only copy now, and it survives a reopen
+    closeCampusStore();
+    UnifiedCampusData data;
+    char id[20];
+    snprintf(id, sizeof(id), "%s%05d", prefix, 7);
+    assert(loadUnifiedCampusData(id, &data) == SUCCESS && data.grades.marks[0] == 7);
+    printf("✅ Migrated and expired files removed on request: PASS\n");
+}
+
+int main() {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(prefix, sizeof(prefix), "mg%05u", tag);
+    snprintf(root, sizeof(root), DATA_DIR "migtest_%u", tag);
+    snprintf(credDir, sizeof(credDir), "%s/credentials/", root);
+    snprintf(dataDir, sizeof(dataDir), "%s/data/", root);
+    assert(initDatabase() == SUCCESS);
+    mkdir(root, 0700);
+    mkdir(credDir, 0700);
+    mkdir(dataDir, 0700);
+    seed();
+
+    test_validate_profile();
+    test_migrate();
+    test_resume();
+    test_remove();
+    closeDatabase();
+    removeTree(root);
+    printf("✅ All migration tests passed\n");
+    return 0;
+}
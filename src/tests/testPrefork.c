@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/database.h"
+#include "../include/api/server.h"
+
+#define TEST_PROCESSES 4
+#define TEST_CLIENTS   16
+#define TEST_SIGNUPS   25       // per client process
+
+static int port;
+static pid_t supervisor;
+
+static ErrorCode startWorker(int index) {
+    (void)index;
+    return initDatabase();
+}
+
+static void stopWorker(void) {
+    closeDatabase();
+}
+
+static void onSignal(int sig) {
+    (void)sig;
+    serverStop();
+}
+
+static void runSupervisor(void) {
+    ServerConfig config = serverDefaultConfig();
+    config.port = port;
+    config.workers = 2;
+    config.processes = TEST_PROCESSES;
+    config.processStart = startWorker;
+    config.processStop = stopWorker;
+    signal(SIGTERM, onSignal);
+    // As `serve --processes`: the schema exists before any worker starts
+    if (initDatabase() != SUCCESS) exit(1);
+    closeDatabase();
+    exit(serverRun(&config) == SUCCESS ? 0 : 1);
+}
+
+static int connectClient(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// One request line, one response line (no pipelining here, so no read-ahead)
+static void request(int fd, const char *req, char *line, size_t size) {
+    size_t len = strlen(req);
+    assert(write(fd, req, len) == (ssize_t)len);
+    assert(write(fd, "\n", 1) == 1);
+    size_t got = 0;
+    while (got + 1 < size) {
+        assert(read(fd, line + got, 1) == 1);
+        if (line[got] == '\n') break;
+        got++;
+    }
+    line[got] = '\0';
+}
+
+static void requestOnce(const char *req, char *line, size_t size) {
+    int fd = connectClient();
+    assert(fd >= 0);
+    request(fd, req, line, size);
+    close(fd);
+}
+
+static void field(const char *json, const char *key, char *out, size_t size) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    const char *p = strstr(json, pattern);
+    assert(p);
+    p += strlen(pattern);
+    size_t i = 0;
+    while (*p && *p != '"' && i + 1 < size) out[i++] = *p++;
+    out[i] = '\0';
+}
+
+static void readOTP(const char *userID, char otp[7]) {
+    char path[128];
+    snprintf(path, sizeof(path), "data/%s_otp.dat", userID);
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    assert(fread(otp, 1, 6, f) == 6);
+    otp[6] = '\0';
+    fclose(f);
+}
+
+static int profileOk(const char *token) {
+    char req[256], line[8192];
+    snprintf(req, sizeof(req), "{\"op\":\"profile\",\"token\":\"%s\"}", token);
+    requestOnce(req, line, sizeof(line));
+    return strstr(line, "\"ok\":true") != NULL;
+}
+
+// Each step runs on a fresh connection, so SO_REUSEPORT spreads them over workers
+void test_shared_sessions(char token[64]) {
+    char line[8192], req[1024], userID[32], ticket[64], otp[7];
+    unsigned tag = (unsigned)getpid() % 100000u;
+
+    snprintf(req, sizeof(req),
+             "{\"op\":\"signup\",\"campus\":\"school\",\"name\":\"Prefork Test\","
+             "\"institute\":\"Test School\",\"department\":\"Science\",\"fields\":[\"Math\"],"
+             "\"email\":\"pf%u@example.com\",\"mobile\":\"8%09u\",\"password\":\"Str0ng!Pass\"}",
+             tag, tag * 11u);
+    requestOnce(req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+    field(line, "userID", userID, sizeof(userID));
+
+    snprintf(req, sizeof(req), "{\"op\":\"signin\",\"user\":\"%s\",\"mobile\":\"8%09u\",\"password\":\"Str0ng!Pass\"}",
+             userID, tag * 11u);
+    requestOnce(req, line, sizeof(line));
+    field(line, "ticket", ticket, sizeof(ticket));
+
+    readOTP(userID, otp);
+    snprintf(req, sizeof(req), "{\"op\":\"verify_otp\",\"ticket\":\"%s\",\"otp\":\"%s\"}", ticket, otp);
+    requestOnce(req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+    field(line, "token", token, 64);
+
+    for (int i = 0; i < TEST_CLIENTS; i++) assert(profileOk(token));
+    printf("✅ Sessions and signins shared across %d worker processes: PASS\n", TEST_PROCESSES);
+}
+
+// Kill one worker outright; the supervisor replaces it and sessions survive
+void test_worker_respawn(const char *token) {
+    char path[64], buf[256];
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/children", (int)supervisor, (int)supervisor);
+    FILE *f = fopen(path, "r");
+    int victim = 0;
+    if (f) {
+        if (fgets(buf, sizeof(buf), f)) victim = atoi(buf);
+        fclose(f);
+    }
+    if (victim <= 0) {
+        printf("⚠️  Worker respawn: skipped (no /proc children list)\n");
+        return;
+    }
+    assert(kill(victim, SIGKILL) == 0);
+    struct timespec pause = { 0, 400 * 1000000L };
+    nanosleep(&pause, NULL);
+
+    int workers = 0;
+    f = fopen(path, "r");
+    assert(f);
+    if (fgets(buf, sizeof(buf), f)) {
+        for (char *p = strtok(buf, " \n"); p; p = strtok(NULL, " \n")) {
+            assert(atoi(p) != victim);
+            workers++;
+        }
+    }
+    fclose(f);
+    assert(workers == TEST_PROCESSES);
+    for (int i = 0; i < TEST_CLIENTS; i++) assert(profileOk(token));
+    printf("✅ Worker respawn keeps sessions: PASS\n");
+}
+
+// Signups from several client processes at once all land, with distinct IDs
+void test_concurrent_signups(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    pid_t clients[TEST_CLIENTS / 2];
+    for (int c = 0; c < TEST_CLIENTS / 2; c++) {
+        clients[c] = fork();
+        assert(clients[c] >= 0);
+        if (clients[c] > 0) continue;
+        int failed = 0;
+        for (int i = 0; i < TEST_SIGNUPS; i++) {
+            char req[1024], line[8192];
+            // One institute per run, so the IDs compete for the same serials
+            snprintf(req, sizeof(req),
+                     "{\"op\":\"signup\",\"campus\":\"school\",\"name\":\"Crowd %d\","
+                     "\"institute\":\"%c%c Crowd School\",\"department\":\"Arts\",\"fields\":[\"Art\"],"
+                     "\"email\":\"cs%u.%d.%d@example.com\",\"mobile\":\"7%05u%02d%02d\",\"password\":\"Str0ng!Pass\"}",
+                     i, 'a' + tag % 26, 'a' + tag / 26 % 26, tag, c, i, tag, c, i);
+            requestOnce(req, line, sizeof(line));
+            failed += strstr(line, "\"ok\":true") == NULL;
+        }
+        _exit(failed);
+    }
+    int failed = 0;
+    for (int c = 0; c < TEST_CLIENTS / 2; c++) {
+        int status;
+        assert(waitpid(clients[c], &status, 0) == clients[c] && WIFEXITED(status));
+        failed += WEXITSTATUS(status);
+    }
+    assert(failed == 0);
+    printf("✅ %d concurrent signups across worker processes: PASS\n", TEST_CLIENTS / 2 * TEST_SIGNUPS);
+}
+
+void test_signout_everywhere(const char *token) {
+    char req[256], line[1024];
+    snprintf(req, sizeof(req), "{\"op\":\"signout\",\"token\":\"%s\"}", token);
+    requestOnce(req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+    for (int i = 0; i < TEST_CLIENTS; i++) assert(!profileOk(token));
+    printf("✅ Signout visible in every worker: PASS\n");
+}
+
+int main() {
+    port = 20000 + (int)(getpid() % 20000);
+    supervisor = fork();
+    assert(supervisor >= 0);
+    if (supervisor == 0) runSupervisor();
+
+    int fd = -1;
+    for (int i = 0; i < 300 && fd < 0; i++) {
+        fd = connectClient();
+        if (fd < 0) {
+            struct timespec pause = { 0, 10 * 1000000L };
+            nanosleep(&pause, NULL);
+        }
+    }
+    assert(fd >= 0);
+    close(fd);
+
+    char token[64];
+    test_shared_sessions(token);
+    test_worker_respawn(token);
+    test_signout_everywhere(token);
+    test_concurrent_signups();
+
+    int status = 0;
+    kill(supervisor, SIGTERM);
+    assert(waitpid(supervisor, &status, 0) == supervisor);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    printf("✅ All prefork tests passed\n");
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/rank_engine.h"
+#include "../include/sqlite3.h"
+#include "testHelpers.h"
+
+#define TEST_STUDENTS 200
+
+static char institute[64], otherInstitute[64];
+static char ids[TEST_STUDENTS][20];
+static int math[TEST_STUDENTS], art[TEST_STUDENTS];
+
+static void createStudent(const char *userID, const char *inst, CampusType type, int i) {
+    testCreateStudent(userID, inst, "Merit", type, '7', (int)(getpid() % 100000) * 1000 + i);
+}
+
+static void storeMarks(int i) {
+    testStoreMarks(ids[i], math[i], art[i]);
+}
+
+// Brute force: 1 + students with a strictly better total
+static int expectedRank(int i, int subject) {
+    int rank = 1;
+    for (int j = 0; j < TEST_STUDENTS; j++) {
+        int mine = subject == 0 ? math[i] + art[i] : subject == 1 ? math[i] : art[i];
+        int theirs = subject == 0 ? math[j] + art[j] : subject == 1 ? math[j] : art[j];
+        rank += theirs > mine;
+    }
+    return rank;
+}
+
+static void seed(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(institute, sizeof(institute), "Rank School %u", tag);
+    snprintf(otherInstitute, sizeof(otherInstitute), "Other Rank School %u", tag);
+    srand(tag);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_STUDENTS; i++) {
+        snprintf(ids[i], sizeof(ids[i]), "rk%05u%04d", tag, i);
+        createStudent(ids[i], institute, CAMPUS_SCHOOL, i);
+        math[i] = rand() % 101;
+        art[i] = i < 10 ? 100 - math[i] : rand() % 101;    // a block of ties at 50%
+        storeMarks(i);
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+static void checkAll(void) {
+    const char *subjects[] = { NULL, "Math", "Art" };
+    for (int s = 0; s < 3; s++) {
+        for (int i = 0; i < TEST_STUDENTS; i++) {
+            int rank, total;
+            float score;
+            assert(rankOfStudent(institute, CAMPUS_SCHOOL, subjects[s], ids[i], &rank, &total, &score) == SUCCESS);
+            assert(total == TEST_STUDENTS && rank == expectedRank(i, s));
+        }
+    }
+}
+
+// Built from the database on the first query, answers match a brute-force count
+void test_build_and_rank() {
+    rankReset();
+    checkAll();
+    int rank, total;
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, "Chemistry", ids[0], &rank, &total, NULL) == ERROR_NOT_FOUND);
+    assert(rankOfStudent(institute, CAMPUS_COLLEGE, NULL, ids[0], &rank, &total, NULL) == ERROR_NOT_FOUND);
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, "nobody", &rank, &total, NULL) == ERROR_NOT_FOUND);
+    printf("✅ Ranks built from stored marks: PASS\n");
+}
+
+// Top K is best first, ties share a rank and are ordered by ID
+void test_top_k() {
+    RankEntry top[TEST_STUDENTS];
+    size_t count;
+    assert(rankTopK(institute, CAMPUS_SCHOOL, NULL, TEST_STUDENTS + 5, top, &count) == SUCCESS);
+    assert(count == TEST_STUDENTS);
+    for (size_t i = 0; i < count; i++) {
+        int idx = atoi(top[i].userID + strlen(top[i].userID) - 4);
+        assert(top[i].rank == expectedRank(idx, 0));
+        assert(top[i].score == (math[idx] + art[idx]) / 2.0f);
+        if (i > 0) {
+            assert(top[i].score <= top[i - 1].score);
+            if (top[i].score == top[i - 1].score) {
+                assert(top[i].rank == top[i - 1].rank && strcmp(top[i - 1].userID, top[i].userID) < 0);
+            }
+        }
+    }
+
+    // Cutting through a tied bucket keeps the smallest IDs
+    RankEntry some[TEST_STUDENTS];
+    size_t k = 1;
+    while (top[k].score != top[k - 1].score) k++;   // the ten students at 50% tie for sure
+    assert(rankTopK(institute, CAMPUS_SCHOOL, NULL, k, some, &count) == SUCCESS && count == k);
+    for (size_t i = 0; i < k; i++) assert(strcmp(some[i].userID, top[i].userID) == 0);
+    assert(rankTopK(institute, CAMPUS_SCHOOL, NULL, 0, NULL, &count) == SUCCESS && count == 0);
+    printf("✅ Top K with ties: PASS\n");
+}
+
+void test_percentile() {
+    float pct;
+    assert(rankPercentile(institute, CAMPUS_SCHOOL, NULL, 100.0f, &pct) == SUCCESS && pct == 100.0f);
+    assert(rankPercentile(institute, CAMPUS_SCHOOL, "Math", -1.0f, &pct) == SUCCESS && pct == 0.0f);
+    int atOrBelow = 0;
+    for (int i = 0; i < TEST_STUDENTS; i++) atOrBelow += math[i] <= 40;
+    assert(rankPercentile(institute, CAMPUS_SCHOOL, "Math", 40.0f, &pct) == SUCCESS);
+    assert(pct == atOrBelow * 100.0f / TEST_STUDENTS);
+    assert(rankPercentile(otherInstitute, CAMPUS_SCHOOL, NULL, 50.0f, &pct) == ERROR_NOT_FOUND);
+    printf("✅ Percentile of a score: PASS\n");
+}
+
+// Saves and profile moves update the boards without a rebuild
+void test_incremental() {
+    math[5] = 100;
+    art[5] = 100;
+    storeMarks(5);
+    math[6] = 0;
+    art[6] = 0;
+    storeMarks(6);
+    checkAll();
+    RankEntry top[1];
+    size_t count;
+    assert(rankTopK(institute, CAMPUS_SCHOOL, "Art", 1, top, &count) == SUCCESS && count == 1 && top[0].score == 100.0f);
+
+    // Moving a student to another institute takes the stored marks along
+    Profile p;
+    assert(getUserByID(ids[7], &p));
+    strcpy(p.instituteName, otherInstitute);
+    assert(updateUser(&p));
+    int rank, total;
+    assert(rankOfStudent(otherInstitute, CAMPUS_SCHOOL, NULL, ids[7], &rank, &total, NULL) == SUCCESS);
+    assert(rank == 1 && total == 1);
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, ids[0], &rank, &total, NULL) == SUCCESS);
+    assert(total == TEST_STUDENTS - 1);
+    strcpy(p.instituteName, institute);
+    assert(updateUser(&p));
+    checkAll();
+    printf("✅ Incremental updates: PASS\n");
+}
+
+// College boards rank CGPA overall and course marks per subject
+void test_college() {
+    char a[20], b[20];
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(a, sizeof(a), "rc%05uA", tag);
+    snprintf(b, sizeof(b), "rc%05uB", tag);
+    createStudent(a, institute, CAMPUS_COLLEGE, 900);
+    createStudent(b, institute, CAMPUS_COLLEGE, 901);
+    int marksA[2] = { 90, 50 }, creditsA[2] = { 4, 1 };     // CGPA 8.2
+    int marksB[2] = { 60, 95 }, creditsB[2] = { 2, 3 };     // CGPA 8.1
+    assert(storeCollegeMarks(a, marksA, creditsA, 2) == SUCCESS);
+    assert(storeCollegeMarks(b, marksB, creditsB, 2) == SUCCESS);
+
+    int rank, total;
+    float score;
+    assert(rankOfStudent(institute, CAMPUS_COLLEGE, NULL, a, &rank, &total, &score) == SUCCESS);
+    assert(rank == 1 && total == 2 && score > 8.19f && score < 8.21f);
+    assert(rankOfStudent(institute, CAMPUS_COLLEGE, "Art", a, &rank, &total, NULL) == SUCCESS && rank == 2);
+    float pct;
+    assert(rankPercentile(institute, CAMPUS_COLLEGE, NULL, 8.15f, &pct) == SUCCESS && pct == 50.0f);
+
+    // A rebuild from the database gives the same answers as the live updates
+    rankReset();
+    assert(rankOfStudent(institute, CAMPUS_COLLEGE, NULL, b, &rank, &total, NULL) == SUCCESS && rank == 2);
+    checkAll();
+    printf("✅ College CGPA boards: PASS\n");
+}
+
+// A commit through another connection is seen on the next query
+void test_other_connection() {
+    int rank, total;
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, ids[0], &rank, &total, NULL) == SUCCESS);
+    assert(total == TEST_STUDENTS);
+
+    sqlite3 *raw;
+    sqlite3_stmt *stmt;
+    assert(sqlite3_open("data/campus.db", &raw) == SQLITE_OK);
+    sqlite3_busy_timeout(raw, 5000);
+    assert(sqlite3_prepare_v2(raw, "DELETE FROM user_data WHERE user_id = ?;", -1, &stmt, 0) == SQLITE_OK);
+    sqlite3_bind_text(stmt, 1, ids[9], -1, SQLITE_STATIC);
+    assert(sqlite3_step(stmt) == SQLITE_DONE);
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, ids[9], &rank, &total, NULL) == ERROR_NOT_FOUND);
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, ids[0], &rank, &total, NULL) == SUCCESS);
+    assert(total == TEST_STUDENTS - 1);
+    storeMarks(9);
+    checkAll();
+    printf("✅ Commits by other connections: PASS\n");
+}
+
+// Past RANK_MAX_BOARDS the least recently queried institutes are dropped
+void test_board_cap() {
+    int institutes = RANK_MAX_BOARDS / 3 + 10;     // overall, Math and Art each
+    char (*names)[64] = malloc((size_t)institutes * sizeof(*names));
+    unsigned tag = (unsigned)getpid() % 100000u;
+    assert(names);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < institutes; i++) {
+        char id[20];
+        snprintf(names[i], sizeof(names[i]), "Capped School %u %d", tag, i);
+        snprintf(id, sizeof(id), "rx%05u%04d", tag, i);
+        createStudent(id, names[i], CAMPUS_SCHOOL, 1000 + i);
+        int marks[2] = { i % 101, 50 }, full[2] = { 100, 100 };
+        assert(storeSchoolMarks(id, marks, full, 2) == SUCCESS);
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+
+    int rank, total;
+    assert(rankOfStudent(institute, CAMPUS_SCHOOL, NULL, ids[0], &rank, &total, NULL) == SUCCESS);
+    for (int i = 0; i < institutes; i++) {
+        RankEntry top[1];
+        size_t count;
+        assert(rankTopK(names[i], CAMPUS_SCHOOL, "Math", 1, top, &count) == SUCCESS && count == 1);
+        assert(top[0].score == (float)(i % 101));
+    }
+    RankStats stats;
+    rankGetStats(&stats);
+    assert(stats.boards <= RANK_MAX_BOARDS && stats.institutes < (size_t)institutes);
+
+    // The first institute queried was the first to go; it is rebuilt on demand
+    checkAll();
+    RankEntry top[1];
+    size_t count;
+    assert(rankTopK(names[0], CAMPUS_SCHOOL, NULL, 1, top, &count) == SUCCESS && count == 1);
+    rankGetStats(&stats);
+    assert(stats.boards <= RANK_MAX_BOARDS);
+    free(names);
+    printf("✅ Board cap evicts whole institutes: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    seed();
+    test_build_and_rank();
+    test_top_k();
+    test_percentile();
+    test_incremental();
+    test_college();
+    test_other_connection();
+    test_board_cap();
+    closeDatabase();
+    printf("✅ All rank engine tests passed\n");
+    return 0;
+}
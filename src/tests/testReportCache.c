@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <utime.h>
+#include <time.h>
+#include "../include/database.h"
+#include "../include/report_cache.h"
+#include "testHelpers.h"
+
+static char userID[20];
+static char cacheDir[64];
+
+static void seedUser(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(userID, sizeof(userID), "rc%05u", tag);
+    snprintf(cacheDir, sizeof(cacheDir), "data/cache_test_%u/", tag);
+
+    Profile p;
+    testProfile(&p, userID, "Cache School", "Grade 7", CAMPUS_SCHOOL);
+    strcpy(p.name, "Cached Student");
+    testSubjects(&p, 2, "Math", "Art");
+    testMobile(&p, '5', (int)tag);
+    assert(createUser(&p) == SUCCESS);
+}
+
+static void saveMarks(int math) {
+    SchoolMarks m;
+    memset(&m, 0, sizeof(m));
+    m.count = 2;
+    strcpy(m.subjects[0], "Math");
+    strcpy(m.subjects[1], "Art");
+    m.marks[0] = math;
+    m.marks[1] = 70;
+    m.fullMarks[0] = m.fullMarks[1] = 100;
+    assert(saveUserData(userID, "SCHOOL_DATA", &m, sizeof(m)));
+}
+
+static void render(ExportBuffer *out) {
+    Profile p;
+    assert(getUserByID(userID, &p));
+    assert(renderCampusReport(&p, out) == SUCCESS);
+    assert(out->length > 0);
+}
+
+static int contains(const ExportBuffer *b, const char *text) {
+    size_t len = strlen(text);
+    for (size_t i = 0; i + len <= b->length; i++) {
+        if (memcmp(b->data + i, text, len) == 0) return 1;
+    }
+    return 0;
+}
+
+static int cacheFiles(void) {
+    DIR *dir = opendir(cacheDir);
+    assert(dir);
+    int files = 0;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) files += e->d_name[0] != '.';
+    closedir(dir);
+    return files;
+}
+
+static void clearDir(void) {
+    DIR *dir = opendir(cacheDir);
+    if (!dir) return;
+    struct dirent *e;
+    char path[320];
+    while ((e = readdir(dir)) != NULL) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        snprintf(path, sizeof(path), "%s%s", cacheDir, e->d_name);
+        remove(path);
+    }
+    closedir(dir);
+    rmdir(cacheDir);
+}
+
+// The second request is served from the cache with identical bytes
+void test_hit() {
+    ReportCacheStats stats;
+    ExportBuffer first, second;
+    render(&first);
+    reportCacheGetStats(&stats);
+    assert(stats.misses == 1 && stats.stores == 1 && stats.hits == 0 && stats.entries == 1);
+    assert(stats.bytes == first.length && cacheFiles() == 1);
+
+    render(&second);
+    reportCacheGetStats(&stats);
+    assert(stats.hits == 1 && stats.stores == 1);
+    assert(second.length == first.length && memcmp(second.data, first.data, first.length) == 0);
+
+    // The file export goes through the same cache
+    Profile p;
+    char path[256];
+    assert(getUserByID(userID, &p));
+    assert(writeCampusReport(&p, cacheDir, path, sizeof(path)) == SUCCESS);
+    reportCacheGetStats(&stats);
+    assert(stats.hits == 2);
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    unsigned char *file = malloc(first.length + 1);
+    assert(fread(file, 1, first.length + 1, f) == first.length);
+    fclose(f);
+    assert(memcmp(file, first.data, first.length) == 0);
+    free(file);
+    remove(path);
+
+    freeExportBuffer(&first);
+    freeExportBuffer(&second);
+    printf("✅ Report cache hit: PASS\n");
+}
+
+// saveUserData drops the cached file; the next report shows the new marks
+void test_invalidate_on_save() {
+    ReportCacheStats before, after;
+    ExportBuffer report;
+    reportCacheGetStats(&before);
+    saveMarks(42);
+    reportCacheGetStats(&after);
+    assert(after.invalidations == before.invalidations + 1 && after.entries == 0 && cacheFiles() == 0);
+
+    uint64_t version;
+    assert(getUserDataVersion(userID, "SCHOOL_DATA", &version) == SUCCESS);
+    assert(getUserDataVersion(userID, "COLLEGE_DATA", &version) == ERROR_NOT_FOUND);
+
+    render(&report);
+    reportCacheGetStats(&after);
+    assert(after.misses == before.misses + 1 && after.stores == before.stores + 1);
+    assert(contains(&report, "42"));
+    freeExportBuffer(&report);
+    printf("✅ Report cache invalidated by saveUserData: PASS\n");
+}
+
+// A profile field on the page changes the version even without a save
+void test_profile_change() {
+    ReportCacheStats before, after;
+    ExportBuffer report;
+    Profile p;
+    assert(getUserByID(userID, &p));
+    strcpy(p.name, "Renamed Student");
+    reportCacheGetStats(&before);
+    render(&report);
+    freeExportBuffer(&report);
+    assert(renderCampusReport(&p, &report) == SUCCESS);     // not yet saved
+    reportCacheGetStats(&after);
+    assert(after.hits == before.hits + 1 && after.misses == before.misses + 1);
+    assert(contains(&report, "Renamed Student"));
+    assert(after.entries == 1 && cacheFiles() == 1);        // replaced, not added
+    freeExportBuffer(&report);
+    printf("✅ Report cache keyed on profile fields: PASS\n");
+}
+
+// Least recently used entries go first once the budget is exceeded
+void test_budget() {
+    char data[1000];
+    memset(data, 'x', sizeof(data));
+    assert(reportCacheOpen(cacheDir, 3500) == SUCCESS);
+    assert(reportCachePut("u1", "_a.pdf", 1, data, sizeof(data)) == SUCCESS);
+    assert(reportCachePut("u2", "_a.pdf", 1, data, sizeof(data)) == SUCCESS);
+    assert(reportCachePut("u3", "_a.pdf", 1, data, sizeof(data)) == SUCCESS);
+
+    unsigned char *got;
+    size_t length;
+    assert(reportCacheGet("u1", "_a.pdf", 1, &got, &length) == SUCCESS && length == sizeof(data));
+    free(got);
+    assert(reportCachePut("u4", "_a.pdf", 1, data, sizeof(data)) == SUCCESS);
+
+    ReportCacheStats stats;
+    reportCacheGetStats(&stats);
+    assert(stats.evictions == 1 && stats.entries == 3 && stats.bytes <= 3500);
+    assert(reportCacheGet("u2", "_a.pdf", 1, &got, &length) == ERROR_NOT_FOUND);
+    assert(reportCacheGet("u1", "_a.pdf", 1, &got, &length) == SUCCESS);
+    free(got);
+    assert(reportCacheGet("u1", "_a.pdf", 2, &got, &length) == ERROR_NOT_FOUND);
+
+    // Bigger than the whole budget: not stored; bad keys rejected
+    char big[4000] = {0};
+    assert(reportCachePut("u5", "_a.pdf", 1, big, sizeof(big)) == SUCCESS);
+    assert(reportCacheGet("u5", "_a.pdf", 1, &got, &length) == ERROR_NOT_FOUND);
+    assert(reportCachePut("../u", "_a.pdf", 1, data, 1) == ERROR_INVALID_INPUT);
+    assert(reportCachePut("u6", "a/b", 1, data, 1) == ERROR_INVALID_INPUT);
+    assert(cacheFiles() == 3);
+    printf("✅ Report cache disk budget: PASS\n");
+}
+
+// Reopening indexes the files already on disk and drops abandoned leftovers
+void test_reopen() {
+    char path[320];
+    snprintf(path, sizeof(path), "%su9.00000000000000ff_a.pdf.tmp.1.0", cacheDir);
+    FILE *f = fopen(path, "wb");
+    assert(f && fputs("partial", f) >= 0 && fclose(f) == 0);
+    struct utimbuf abandoned = { time(NULL) - 3600, time(NULL) - 3600 };    // a fresh one may still be in use
+    assert(utime(path, &abandoned) == 0);
+
+    reportCacheClose();
+    assert(reportCacheOpen(cacheDir, 3500) == SUCCESS);
+    ReportCacheStats stats;
+    reportCacheGetStats(&stats);
+    assert(stats.entries == 3 && stats.bytes == 3000 && cacheFiles() == 3);
+
+    unsigned char *got;
+    size_t length;
+    assert(reportCacheGet("u4", "_a.pdf", 1, &got, &length) == SUCCESS && length == 1000 && got[999] == 'x');
+    free(got);
+    reportCacheInvalidate("u4");
+    assert(reportCacheGet("u4", "_a.pdf", 1, &got, &length) == ERROR_NOT_FOUND);
+
+    // A budget of 0 turns the cache off
+    assert(reportCacheOpen(cacheDir, 0) == SUCCESS);
+    assert(reportCacheGet("u1", "_a.pdf", 1, &got, &length) == ERROR_NOT_FOUND);
+    reportCacheClose();
+    printf("✅ Report cache reopen: PASS\n");
+}
+
+// Two processes on one directory share a single budget
+void test_shared_budget() {
+    char data[1000];
+    memset(data, 'y', sizeof(data));
+    assert(reportCacheOpen(cacheDir, 3500) == SUCCESS);
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        // Its own index, as a prefork worker has
+        int ok = reportCacheOpen(cacheDir, 3500) == SUCCESS &&
+                 reportCachePut("c1", "_a.pdf", 1, data, sizeof(data)) == SUCCESS &&
+                 reportCachePut("c2", "_a.pdf", 1, data, sizeof(data)) == SUCCESS &&
+                 reportCachePut("c3", "_a.pdf", 1, data, sizeof(data)) == SUCCESS;
+        reportCacheClose();
+        _exit(ok ? 0 : 1);
+    }
+    int status;
+    assert(waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    ReportCacheStats stats;
+    reportCacheGetStats(&stats);
+    assert(stats.entries == 0 && stats.diskBytes == 3000);
+    assert(reportCachePut("p1", "_a.pdf", 1, data, sizeof(data)) == SUCCESS);
+    reportCacheGetStats(&stats);
+    assert(stats.evictions == 1 && stats.diskBytes == 3000 && cacheFiles() == 3);
+
+    unsigned char *got;
+    size_t length;
+    assert(reportCacheGet("p1", "_a.pdf", 1, &got, &length) == SUCCESS);
+    free(got);
+    assert(reportCacheGet("c1", "_a.pdf", 1, &got, &length) == ERROR_NOT_FOUND);
+    assert(reportCacheGet("c3", "_a.pdf", 1, &got, &length) == SUCCESS);
+    free(got);
+    reportCacheClose();
+    printf("✅ Report cache budget shared across processes: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    seedUser();
+    saveMarks(88);
+    clearDir();
+    assert(reportCacheOpen(cacheDir, REPORT_CACHE_BUDGET) == SUCCESS);
+
+    test_hit();
+    test_invalidate_on_save();
+    test_profile_change();
+    reportCacheClose();
+    clearDir();
+    test_budget();
+    test_reopen();
+    clearDir();
+    test_shared_budget();
+
+    clearDir();
+    closeDatabase();
+    printf("✅ All report cache tests passed\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "../include/database.h"
+#include "../include/report_run.h"
+#include "testHelpers.h"
+
+#define TEST_USERS 120
+
+static char ids[TEST_USERS][20];
+static char institute[64];
+static char outDir[64];
+
+// School users at one institute; every 10th has no marks yet. Two college
+// users at the same institute must not be picked up by a school run.
+static void seedUsers(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(institute, sizeof(institute), "Report School %u", tag);
+    snprintf(outDir, sizeof(outDir), "data/reports_%u/", tag);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_USERS + 2; i++) {
+        Profile p;
+        char id[20];
+        snprintf(id, sizeof(id), "rr%05u%04d", tag, i);
+        testProfile(&p, id, institute, "Grade 9", i < TEST_USERS ? CAMPUS_SCHOOL : CAMPUS_COLLEGE);
+        snprintf(p.name, sizeof(p.name), "Student %d", i);
+        testSubjects(&p, 2, "Math", "Physics");
+        testMobile(&p, '6', i);
+        assert(createUser(&p) == SUCCESS);
+        if (i >= TEST_USERS) continue;
+        strcpy(ids[i], p.userID);
+
+        if (i % 10 == 9) continue;
+        SchoolMarks m;
+        memset(&m, 0, sizeof(m));
+        m.count = 2;
+        strcpy(m.subjects[0], "Math");
+        strcpy(m.subjects[1], "Physics");
+        m.marks[0] = i % 100;
+        m.marks[1] = 50;
+        m.fullMarks[0] = m.fullMarks[1] = 100;
+        assert(saveUserData(p.userID, "SCHOOL_DATA", &m, sizeof(m)));
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+static int reportExists(const char *userID) {
+    char path[256];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s%.19s_school_report.pdf", outDir, userID);  // IDs fit Profile.userID
+    return stat(path, &st) == 0 && st.st_size > 0;
+}
+
+// Reports and nothing else: no temporary files left behind
+static int countFiles(void) {
+    DIR *dir = opendir(outDir);
+    assert(dir);
+    int files = 0;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        assert(strstr(e->d_name, ".tmp") == NULL);
+        files++;
+    }
+    closedir(dir);
+    return files;
+}
+
+void test_list_users() {
+    char (*list)[20] = NULL;
+    size_t count = 0;
+    assert(listUsersByInstitute(institute, CAMPUS_SCHOOL, &list, &count) == SUCCESS);
+    assert(count == TEST_USERS);
+    for (size_t i = 0; i < count; i++) assert(strcmp(list[i], ids[i]) == 0);     // user ID order
+    free(list);
+    assert(listUsersByInstitute(institute, CAMPUS_COLLEGE, &list, &count) == SUCCESS && count == 2);
+    free(list);
+    assert(listUsersByInstitute("No Such Institute", CAMPUS_SCHOOL, &list, &count) == SUCCESS);
+    assert(count == 0 && list == NULL);
+    printf("✅ Users listed by institute and campus: PASS\n");
+}
+
+void test_institute_run() {
+    ReportRunOptions options = reportRunDefaultOptions();
+    options.threads = 4;
+    options.outDir = outDir;
+    ReportRunStats stats;
+    assert(runInstituteReports(institute, CAMPUS_SCHOOL, &options, &stats) == SUCCESS);
+    assert(stats.users == TEST_USERS && stats.threads == 4);
+    assert(stats.written == TEST_USERS - TEST_USERS / 10);
+    assert(stats.missingData == TEST_USERS / 10 && stats.failed == 0);
+    for (int i = 0; i < TEST_USERS; i++) assert(reportExists(ids[i]) == (i % 10 != 9));
+    assert(countFiles() == (int)stats.written);
+
+    // A second run replaces the files in place
+    options.threads = 16;
+    assert(runInstituteReports(institute, CAMPUS_SCHOOL, &options, &stats) == SUCCESS);
+    assert(stats.written == TEST_USERS - TEST_USERS / 10);
+    assert(countFiles() == (int)stats.written);
+
+    assert(runInstituteReports("No Such Institute", CAMPUS_SCHOOL, &options, &stats) == ERROR_NOT_FOUND);
+    printf("✅ Whole-institute report run: PASS\n");
+}
+
+void test_thread_counts() {
+    ReportRunOptions options = reportRunDefaultOptions();
+    options.outDir = outDir;
+    ReportRunStats stats;
+    int counts[] = { 1, 3, 7, 200 };
+    for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+        options.threads = counts[k];
+        assert(runReports((const char (*)[20])ids, 5, &options, &stats) == SUCCESS);
+        assert(stats.written == 5 && stats.threads == (counts[k] < 5 ? counts[k] : 5));
+    }
+    // Unknown users fail without stopping the rest
+    char mixed[3][20] = { "", "missing-user", "" };
+    strcpy(mixed[0], ids[0]);
+    strcpy(mixed[2], ids[1]);
+    options.threads = 2;
+    assert(runReports((const char (*)[20])mixed, 3, &options, &stats) == ERROR_FILE_IO);
+    assert(stats.written == 2 && stats.failed == 1);
+    assert(runReports(NULL, 0, &options, &stats) == SUCCESS && stats.users == 0);
+    printf("✅ Thread counts and failures: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    seedUsers();
+    test_list_users();
+    test_institute_run();
+    test_thread_counts();
+    closeDatabase();
+    printf("✅ All report run tests passed\n");
+    return 0;
+}
@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "../include/segment_store.h"
+
+#define WRITERS       4
+#define READERS       4
+#define THREAD_KEYS   64
+#define THREAD_ROUNDS 400
+
+static char dir[64];
+
+static void removeDir(void) {
+    DIR *d = opendir(dir);
+    struct dirent *ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        remove(path);
+    }
+    if (d) closedir(d);
+    rmdir(dir);
+}
+
+static SegmentStoreOptions smallSegments(int background) {
+    SegmentStoreOptions options = segmentStoreDefaultOptions();
+    options.segmentBytes = 4096;
+    options.background = background;
+    return options;
+}
+
+static void getString(SegmentStore *st, const char *key, char *out, size_t size) {
+    size_t length = 0;
+    assert(segmentStoreGet(st, key, out, size - 1, &length) == SUCCESS);
+    out[length] = '\0';
+}
+
+void test_basic() {
+    SegmentStore *st;
+    assert(segmentStoreOpen(dir, NULL, &st) == SUCCESS);
+    assert(segmentStorePut(st, "alpha", "one", 3) == SUCCESS);
+    assert(segmentStorePut(st, "beta", "two", 3) == SUCCESS);
+    assert(segmentStorePut(st, "alpha", "uno", 3) == SUCCESS);
+    char value[32];
+    getString(st, "alpha", value, sizeof(value));
+    assert(strcmp(value, "uno") == 0);
+
+    size_t length = 0;
+    assert(segmentStoreGet(st, "beta", value, 2, &length) == ERROR_MEMORY && length == 3);
+    assert(segmentStoreGet(st, "gamma", value, sizeof(value), &length) == ERROR_NOT_FOUND);
+    assert(segmentStoreDelete(st, "beta") == SUCCESS);
+    assert(segmentStoreDelete(st, "beta") == ERROR_NOT_FOUND);
+    assert(segmentStoreGet(st, "beta", value, sizeof(value), &length) == ERROR_NOT_FOUND);
+    assert(segmentStorePut(st, "", "x", 1) == ERROR_INVALID_INPUT);
+    assert(segmentStorePut(st, "a-key-that-is-far-too-long-to-index", "x", 1) == ERROR_INVALID_INPUT);
+
+    // One process per directory
+    SegmentStore *second;
+    assert(segmentStoreOpen(dir, NULL, &second) == ERROR_FILE_IO);
+
+    SegmentStoreStats stats;
+    segmentStoreGetStats(st, &stats);
+    assert(stats.keys == 1 && stats.segments == 1 && stats.deadBytes > 0);
+    segmentStoreClose(st);
+
+    assert(segmentStoreOpen(dir, NULL, &st) == SUCCESS);
+    getString(st, "alpha", value, sizeof(value));
+    assert(strcmp(value, "uno") == 0);
+    assert(segmentStoreGet(st, "beta", value, sizeof(value), &length) == ERROR_NOT_FOUND);
+    segmentStoreGetStats(st, &stats);
+    assert(stats.keys == 1);
+    segmentStoreClose(st);
+    printf("✅ Put, get, delete and reopen: PASS\n");
+}
+
+// A write cut short leaves a tail that reopening drops
+void test_torn_tail() {
+    SegmentStore *st;
+    assert(segmentStoreOpen(dir, NULL, &st) == SUCCESS);
+    assert(segmentStorePut(st, "torn", "whole value", 11) == SUCCESS);
+    segmentStoreClose(st);
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/seg_000001.log", dir);
+    FILE *f = fopen(path, "r+b");
+    assert(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, size - 1, SEEK_SET);
+    fputc('!', f);                                      // last value byte: checksum no longer matches
+    fseek(f, 0, SEEK_END);
+    fwrite("SEGE\0\0garbage", 13, 1, f);
+    fclose(f);
+
+    assert(segmentStoreOpen(dir, NULL, &st) == SUCCESS);
+    char value[32];
+    size_t length;
+    assert(segmentStoreGet(st, "torn", value, sizeof(value), &length) == ERROR_NOT_FOUND);
+    getString(st, "alpha", value, sizeof(value));
+    assert(strcmp(value, "uno") == 0);
+    // Appends carry on from the last good entry
+    assert(segmentStorePut(st, "torn", "again", 5) == SUCCESS);
+    segmentStoreClose(st);
+    assert(segmentStoreOpen(dir, NULL, &st) == SUCCESS);
+    getString(st, "torn", value, sizeof(value));
+    assert(strcmp(value, "again") == 0);
+    segmentStoreClose(st);
+    printf("✅ Torn tails are dropped on open: PASS\n");
+}
+
+void test_compaction() {
+    removeDir();
+    SegmentStoreOptions options = smallSegments(0);
+    SegmentStore *st;
+    assert(segmentStoreOpen(dir, &options, &st) == SUCCESS);
+    char key[16], value[128];
+    assert(segmentStorePut(st, "stay", "written once", 12) == SUCCESS);    // must be copied forward
+    for (int round = 0; round < 20; round++) {
+        for (int k = 0; k < 20; k++) {
+            snprintf(key, sizeof(key), "k%02d", k);
+            int n = snprintf(value, sizeof(value), "value of %s in round %d", key, round);
+            assert(segmentStorePut(st, key, value, (size_t)n) == SUCCESS);
+        }
+    }
+    assert(segmentStorePut(st, "gone", "soon deleted", 12) == SUCCESS);
+    for (int k = 0; k < 20; k++) {                      // push "gone" into a sealed segment
+        snprintf(key, sizeof(key), "k%02d", k);
+        int n = snprintf(value, sizeof(value), "value of %s in round %d", key, 20);
+        assert(segmentStorePut(st, key, value, (size_t)n) == SUCCESS);
+    }
+    assert(segmentStoreDelete(st, "gone") == SUCCESS);
+
+    SegmentStoreStats before, after;
+    segmentStoreGetStats(st, &before);
+    assert(before.segments > 4 && before.deadBytes > before.liveBytes);
+    assert(segmentStoreCompact(st) == SUCCESS);
+    segmentStoreGetStats(st, &after);
+    assert(after.segments < before.segments && after.compactions > 0 && after.keys == 21);
+    assert(after.deadBytes < before.deadBytes && after.bytesMoved > 0);
+
+    for (int k = 0; k < 20; k++) {
+        snprintf(key, sizeof(key), "k%02d", k);
+        char expected[128];
+        snprintf(expected, sizeof(expected), "value of %s in round %d", key, 20);
+        getString(st, key, value, sizeof(value));
+        assert(strcmp(value, expected) == 0);
+    }
+    getString(st, "stay", value, sizeof(value));
+    assert(strcmp(value, "written once") == 0);
+    segmentStoreClose(st);
+
+    // Compacted files and carried-forward tombstones replay to the same state
+    assert(segmentStoreOpen(dir, &options, &st) == SUCCESS);
+    size_t length;
+    assert(segmentStoreGet(st, "gone", value, sizeof(value), &length) == ERROR_NOT_FOUND);
+    getString(st, "k07", value, sizeof(value));
+    assert(strcmp(value, "value of k07 in round 20") == 0);
+    SegmentStoreStats reopened;
+    segmentStoreGetStats(st, &reopened);
+    assert(reopened.keys == 21 && reopened.segments == after.segments);
+    segmentStoreClose(st);
+    printf("✅ Compaction drops superseded entries: PASS\n");
+}
+
+typedef struct {
+    SegmentStore *store;
+    int id;
+} Worker;
+
+// Values are "<key>:<round>" so any read can be checked against its key
+static void *writerMain(void *arg) {
+    Worker *w = (Worker*)arg;
+    char key[16], value[64];
+    for (int round = 0; round < THREAD_ROUNDS; round++) {
+        for (int k = 0; k < THREAD_KEYS; k += 8) {
+            snprintf(key, sizeof(key), "w%d-%02d", w->id, (k + round) % THREAD_KEYS);
+            int n = snprintf(value, sizeof(value), "%s:%d", key, round);
+            assert(segmentStorePut(w->store, key, value, (size_t)n) == SUCCESS);
+        }
+    }
+    for (int k = 0; k < THREAD_KEYS; k++) {
+        snprintf(key, sizeof(key), "w%d-%02d", w->id, k);
+        int n = snprintf(value, sizeof(value), "%s:final", key);
+        assert(segmentStorePut(w->store, key, value, (size_t)n) == SUCCESS);
+    }
+    return NULL;
+}
+
+static void *readerMain(void *arg) {
+    Worker *w = (Worker*)arg;
+    char key[16], value[64];
+    for (int i = 0; i < THREAD_ROUNDS * 8; i++) {
+        snprintf(key, sizeof(key), "w%d-%02d", i % WRITERS, (i * 7 + w->id) % THREAD_KEYS);
+        size_t length = 0;
+        ErrorCode rc = segmentStoreGet(w->store, key, value, sizeof(value) - 1, &length);
+        assert(rc == SUCCESS || rc == ERROR_NOT_FOUND);
+        if (rc != SUCCESS) continue;
+        value[length] = '\0';
+        size_t keyLength = strlen(key);
+        assert(strncmp(value, key, keyLength) == 0 && value[keyLength] == ':');
+    }
+    return NULL;
+}
+
+void test_concurrent() {
+    removeDir();
+    SegmentStoreOptions options = smallSegments(1);
+    options.segmentBytes = 16384;
+    SegmentStore *st;
+    assert(segmentStoreOpen(dir, &options, &st) == SUCCESS);
+    pthread_t threads[WRITERS + READERS];
+    Worker workers[WRITERS + READERS];
+    for (int i = 0; i < WRITERS + READERS; i++) {
+        workers[i].store = st;
+        workers[i].id = i < WRITERS ? i : i - WRITERS;
+        assert(pthread_create(&threads[i], NULL, i < WRITERS ? writerMain : readerMain, &workers[i]) == 0);
+    }
+    for (int i = 0; i < WRITERS + READERS; i++) pthread_join(threads[i], NULL);
+    segmentStoreCompact(st);
+
+    SegmentStoreStats stats;
+    segmentStoreGetStats(st, &stats);
+    assert(stats.keys == WRITERS * THREAD_KEYS && stats.compactions > 0);
+    segmentStoreClose(st);
+
+    assert(segmentStoreOpen(dir, &options, &st) == SUCCESS);
+    for (int w = 0; w < WRITERS; w++) {
+        for (int k = 0; k < THREAD_KEYS; k++) {
+            char key[16], value[64], expected[64];
+            snprintf(key, sizeof(key), "w%d-%02d", w, k);
+            snprintf(expected, sizeof(expected), "%s:final", key);
+            getString(st, key, value, sizeof(value));
+            assert(strcmp(value, expected) == 0);
+        }
+    }
+    segmentStoreClose(st);
+    printf("✅ Concurrent writers, readers and background compaction: PASS\n");
+}
+
+int main() {
+    snprintf(dir, sizeof(dir), DATA_DIR "segtest_%u", (unsigned)getpid());
+    test_basic();
+    test_torn_tail();
+    test_compaction();
+    test_concurrent();
+    removeDir();
+    printf("✅ All segment store tests passed\n");
+    return 0;
+}
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/database.h"
+#include "../include/api/server.h"
+
+#define TEST_SOCKET "test_server.sock"
+
+static pthread_t serverThread;
+static char buffered[1 << 16];
+static size_t bufferedLen;
+
+static void *runServer(void *arg) {
+    ServerConfig *config = arg;
+    assert(serverRun(config) == SUCCESS);
+    return NULL;
+}
+
+static int connectClient(void) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, TEST_SOCKET);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    bufferedLen = 0;
+    return fd;
+}
+
+static void sendAll(int fd, const char *text) {
+    size_t len = strlen(text), sent = 0;
+    while (sent < len) {
+        ssize_t n = write(fd, text + sent, len - sent);
+        assert(n > 0);
+        sent += (size_t)n;
+    }
+}
+
+// Reads one response line (without '\n'); returns 0 on EOF
+static int readLine(int fd, char *line, size_t size) {
+    for (;;) {
+        char *nl = memchr(buffered, '\n', bufferedLen);
+        if (nl) {
+            size_t len = (size_t)(nl - buffered);
+            assert(len < size);
+            memcpy(line, buffered, len);
+            line[len] = '\0';
+            memmove(buffered, nl + 1, bufferedLen - len - 1);
+            bufferedLen -= len + 1;
+            return 1;
+        }
+        ssize_t n = read(fd, buffered + bufferedLen, sizeof(buffered) - bufferedLen);
+        if (n <= 0) return 0;
+        bufferedLen += (size_t)n;
+    }
+}
+
+static void request(int fd, const char *req, char *line, size_t size) {
+    sendAll(fd, req);
+    sendAll(fd, "\n");
+    assert(readLine(fd, line, size));
+}
+
+// Pulls "key":"value" out of a flat response
+static void field(const char *json, const char *key, char *out, size_t size) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    const char *p = strstr(json, pattern);
+    assert(p);
+    p += strlen(pattern);
+    size_t i = 0;
+    while (*p && *p != '"' && i + 1 < size) out[i++] = *p++;
+    out[i] = '\0';
+}
+
+static void readOTP(const char *userID, char otp[7]) {
+    char path[128];
+    snprintf(path, sizeof(path), "data/%s_otp.dat", userID);
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    assert(fread(otp, 1, 6, f) == 6);
+    otp[6] = '\0';
+    fclose(f);
+}
+
+void test_session_flow(void) {
+    char line[8192], req[1024], userID[32], ticket[64], token[64], otp[7];
+    int fd = connectClient();
+    unsigned tag = (unsigned)getpid() % 100000u;
+
+    snprintf(req, sizeof(req),
+             "{\"id\":1,\"op\":\"signup\",\"campus\":\"school\",\"name\":\"Server Test\","
+             "\"institute\":\"Test School\",\"department\":\"Science\",\"fields\":[\"Math\",\"Physics\"],"
+             "\"email\":\"srv%u@example.com\",\"mobile\":\"9%09u\",\"password\":\"Str0ng!Pass\"}",
+             tag, tag * 7u);
+    request(fd, req, line, sizeof(line));
+    assert(strncmp(line, "{\"id\":1,", 8) == 0);
+    assert(strstr(line, "\"ok\":true"));
+    field(line, "userID", userID, sizeof(userID));
+
+    snprintf(req, sizeof(req), "{\"op\":\"signin\",\"user\":\"%s\",\"mobile\":\"9%09u\",\"password\":\"Str0ng!Pass\"}",
+             userID, tag * 7u);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"otpRequired\":true"));
+    field(line, "ticket", ticket, sizeof(ticket));
+
+    readOTP(userID, otp);
+    snprintf(req, sizeof(req), "{\"op\":\"verify_otp\",\"ticket\":\"%s\",\"otp\":\"%s\"}", ticket, otp);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+    field(line, "token", token, sizeof(token));
+    assert(strlen(token) == 32);
+
+    snprintf(req, sizeof(req), "{\"op\":\"profile\",\"token\":\"%s\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"name\":\"Server Test\""));
+
+    snprintf(req, sizeof(req), "{\"op\":\"data_put\",\"token\":\"%s\",\"marks\":[80,90],\"fullMarks\":[100,100]}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+
+    snprintf(req, sizeof(req), "{\"op\":\"data_get\",\"token\":\"%s\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"total\":170"));
+    assert(strstr(line, "\"percentage\":85.00"));
+    assert(strstr(line, "\"rank\":{\"position\":"));
+
+    snprintf(req, sizeof(req), "{\"op\":\"stats\",\"token\":\"%s\",\"subject\":\"Math\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true") && strstr(line, "\"histogram\":["));
+
+    snprintf(req, sizeof(req), "{\"op\":\"data_put\",\"token\":\"%s\",\"marks\":[180,90],\"fullMarks\":[100,100]}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"error\":\"INVALID_INPUT\""));
+
+    snprintf(req, sizeof(req), "{\"op\":\"export\",\"token\":\"%s\",\"kind\":\"profile\",\"format\":\"csv\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"path\":"));
+
+    snprintf(req, sizeof(req), "{\"op\":\"signout\",\"token\":\"%s\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":true"));
+    snprintf(req, sizeof(req), "{\"op\":\"profile\",\"token\":\"%s\"}", token);
+    request(fd, req, line, sizeof(line));
+    assert(strstr(line, "\"ok\":false"));
+
+    close(fd);
+    printf("✅ Session flow over socket: PASS\n");
+}
+
+void test_pipelining_order(void) {
+    char line[256], expect[64];
+    int fd = connectClient();
+
+    // One write, many requests: responses must come back in request order
+    static char batch[200 * 40];
+    size_t len = 0;
+    for (int i = 0; i < 200; i++) {
+        len += (size_t)snprintf(batch + len, sizeof(batch) - len, "{\"id\":%d,\"op\":\"ping\"}\n", i);
+    }
+    sendAll(fd, batch);
+    for (int i = 0; i < 200; i++) {
+        assert(readLine(fd, line, sizeof(line)));
+        snprintf(expect, sizeof(expect), "{\"id\":%d,\"pong\":true,\"ok\":true}", i);
+        assert(strcmp(line, expect) == 0);
+    }
+    close(fd);
+    printf("✅ Pipelined responses in order: PASS\n");
+}
+
+void test_protocol_errors(void) {
+    char line[256];
+    int fd = connectClient();
+
+    request(fd, "{not json", line, sizeof(line));
+    assert(strstr(line, "\"ok\":false"));
+    request(fd, "{\"op\":\"nope\"}", line, sizeof(line));
+    assert(strstr(line, "\"ok\":false"));
+    request(fd, "{\"op\":\"profile\"}", line, sizeof(line));
+    assert(strstr(line, "\"ok\":false"));
+
+    // Blank lines are ignored, CRLF is accepted
+    sendAll(fd, "\n\r\n{\"id\":\"x\",\"op\":\"ping\"}\r\n");
+    assert(readLine(fd, line, sizeof(line)));
+    assert(strcmp(line, "{\"id\":\"x\",\"pong\":true,\"ok\":true}") == 0);
+    close(fd);
+
+    // An oversized line gets one error and the connection is closed
+    fd = connectClient();
+    static char huge[8192];
+    memset(huge, 'a', sizeof(huge));
+    for (int i = 0; i < 4; i++) assert(write(fd, huge, sizeof(huge)) == (ssize_t)sizeof(huge));
+    assert(readLine(fd, line, sizeof(line)));
+    assert(strstr(line, "request too large"));
+    assert(!readLine(fd, line, sizeof(line)));
+    close(fd);
+
+    // So does one whose newline comes in the same read as the rest of it
+    fd = connectClient();
+    static char longLine[16 * 1024 + 100];
+    memset(longLine, 'a', sizeof(longLine) - 1);
+    longLine[sizeof(longLine) - 1] = '\n';
+    assert(write(fd, longLine, sizeof(longLine)) == (ssize_t)sizeof(longLine));
+    assert(readLine(fd, line, sizeof(line)));
+    assert(strstr(line, "request too large"));
+    assert(!readLine(fd, line, sizeof(line)));
+    close(fd);
+
+    ServerStats stats;
+    serverGetStats(&stats);
+    assert(stats.protocolErrors == 2);
+    printf("✅ Protocol errors: PASS\n");
+}
+
+// A client that has stopped sending and is slow to read its responses must
+// not make the event loop spin while the output waits
+void test_half_close(void) {
+    enum { COUNT = 20000 };
+    static char batch[COUNT * 32];
+    char line[256], expect[64];
+    size_t len = 0;
+    for (int i = 0; i < COUNT; i++) {
+        len += (size_t)snprintf(batch + len, sizeof(batch) - len, "{\"id\":%d,\"op\":\"ping\"}\n", i);
+    }
+    int fd = connectClient();
+    sendAll(fd, batch);
+    assert(shutdown(fd, SHUT_WR) == 0);
+
+    // Let the pings finish, then measure what the idle wait costs
+    struct timespec settle = { 0, 200 * 1000000L }, wait = { 0, 300 * 1000000L }, before, after;
+    nanosleep(&settle, NULL);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &before);
+    nanosleep(&wait, NULL);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &after);
+    double busy = (double)(after.tv_sec - before.tv_sec) + (double)(after.tv_nsec - before.tv_nsec) / 1e9;
+
+    for (int i = 0; i < COUNT; i++) {
+        assert(readLine(fd, line, sizeof(line)));
+        snprintf(expect, sizeof(expect), "{\"id\":%d,\"pong\":true,\"ok\":true}", i);
+        assert(strcmp(line, expect) == 0);
+    }
+    assert(!readLine(fd, line, sizeof(line)));     // closed once everything is out
+    close(fd);
+    assert(busy < 0.1);
+    printf("✅ Half-closed client with pending output: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+
+    static ServerConfig config;
+    config = serverDefaultConfig();
+    config.unixPath = TEST_SOCKET;
+    config.workers = 3;
+    config.maxInflight = 8;     // small, so the pipelining test exercises backpressure
+    config.maxRequestBytes = 16 * 1024;
+    assert(pthread_create(&serverThread, NULL, runServer, &config) == 0);
+    assert(serverWaitReady(2000));
+
+    test_session_flow();
+    test_pipelining_order();
+    test_protocol_errors();
+    test_half_close();
+
+    serverStop();
+    pthread_join(serverThread, NULL);
+    assert(access(TEST_SOCKET, F_OK) != 0);
+    closeDatabase();
+    printf("✅ All server tests passed\n");
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../include/auth.h"
+#include "../include/database.h"
+#include "../include/signin_flow.h"
+
+#define TEST_PASSWORD "Flow!Pass9"
+
+static char userID[20];
+static char mobile[15];
+
+static void registerTestUser(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    Profile p;
+    memset(&p, 0, sizeof(p));
+    strcpy(p.name, "Flow Tester");
+    strcpy(p.instituteName, "Flow Hostel");
+    strcpy(p.department, "Block A");
+    p.campusType = CAMPUS_HOSTEL;
+    snprintf(p.email, sizeof(p.email), "flow%u@example.com", tag);
+    snprintf(mobile, sizeof(mobile), "6%09u", tag * 13u);
+    strcpy(p.mobile, mobile);
+    assert(registerProfile(&p, TEST_PASSWORD) == SUCCESS);
+    strcpy(userID, p.userID);
+}
+
+static void readOTP(char otp[7]) {
+    char path[128];
+    snprintf(path, sizeof(path), "data/%s_otp.dat", userID);
+    FILE *f = fopen(path, "rb");
+    assert(f);
+    assert(fread(otp, 1, 6, f) == 6);
+    otp[6] = '\0';
+    fclose(f);
+}
+
+void test_state_machine() {
+    SigninFlow flow;
+    Session session;
+    char otp[7];
+    signinFlowInit(&flow);
+    assert(flow.state == SIGNIN_AWAIT_CREDENTIALS);
+
+    assert(signinFlowCredentials(&flow, userID, mobile, "wrong") == ERROR_AUTH_FAILED);
+    assert(flow.state == SIGNIN_AWAIT_CREDENTIALS && flow.credentialFailures == 1);
+    assert(signinFlowVerify(&flow, "123456", &session) == ERROR_INVALID_INPUT);   // out of order
+
+    assert(signinFlowCredentials(&flow, userID, mobile, TEST_PASSWORD) == SUCCESS);
+    assert(flow.state == SIGNIN_AWAIT_OTP);
+    assert(flow.channels & SIGNIN_CHANNEL_EMAIL);
+    assert(getLoginAttempts(userID) == 0);
+
+    readOTP(otp);
+    assert(signinFlowVerify(&flow, "000000", &session) == ERROR_AUTH_FAILED);
+    assert(flow.state == SIGNIN_AWAIT_OTP);
+    assert(signinFlowVerify(&flow, otp, &session) == SUCCESS);
+    assert(flow.state == SIGNIN_DONE);
+    Session check;
+    assert(validateSession(session.sessionToken, &check) && strcmp(check.userID, userID) == 0);
+    destroySession(session.sessionToken);
+    printf("✅ Signin state transitions: PASS\n");
+}
+
+void test_limits_and_expiry() {
+    SigninFlow flow;
+    Session session;
+
+    signinFlowInit(&flow);
+    assert(signinFlowCredentials(&flow, userID, mobile, TEST_PASSWORD) == SUCCESS);
+    for (int i = 0; i < SIGNIN_MAX_RESENDS; i++) assert(signinFlowResend(&flow) == SUCCESS);
+    assert(signinFlowResend(&flow) == ERROR_PERMISSION);
+    assert(flow.state == SIGNIN_AWAIT_OTP);
+    for (int i = 0; i < SIGNIN_MAX_OTP_FAILURES; i++) {
+        assert(signinFlowVerify(&flow, "000000", &session) == ERROR_AUTH_FAILED);
+    }
+    assert(flow.state == SIGNIN_FAILED);
+
+    // A resend does not reset the count of wrong codes
+    signinFlowInit(&flow);
+    assert(signinFlowCredentials(&flow, userID, mobile, TEST_PASSWORD) == SUCCESS);
+    for (int i = 0; i < SIGNIN_MAX_OTP_FAILURES - 1; i++) {
+        assert(signinFlowVerify(&flow, "000000", &session) == ERROR_AUTH_FAILED);
+    }
+    assert(signinFlowResend(&flow) == SUCCESS);
+    assert(signinFlowVerify(&flow, "000000", &session) == ERROR_AUTH_FAILED);
+    assert(flow.state == SIGNIN_FAILED);
+
+    signinFlowInit(&flow);
+    assert(signinFlowCredentials(&flow, userID, mobile, TEST_PASSWORD) == SUCCESS);
+    flow.expiresAt = time(NULL) - 1;
+    assert(signinFlowExpired(&flow, time(NULL)));
+    assert(signinFlowVerify(&flow, "000000", &session) == ERROR_AUTH_FAILED);
+    assert(flow.state == SIGNIN_FAILED);
+
+    // Three bad passwords lock the account
+    signinFlowInit(&flow);
+    for (int i = 0; i < SIGNIN_MAX_CREDENTIAL_FAILURES; i++) {
+        assert(signinFlowCredentials(&flow, userID, mobile, "wrong") == ERROR_AUTH_FAILED);
+    }
+    assert(flow.state == SIGNIN_FAILED);
+    assert(isAccountLocked(userID));
+    signinFlowInit(&flow);
+    assert(signinFlowCredentials(&flow, userID, mobile, TEST_PASSWORD) == ERROR_PERMISSION);
+    unlockAccount(userID);
+    printf("✅ Signin limits and expiry: PASS\n");
+}
+
+void test_pending_table() {
+    char ticket[SIGNIN_TICKET_LEN + 1], otp[7];
+    int channels = 0;
+    Session session;
+    int before = signinPendingCount();
+
+    assert(signinBegin(userID, mobile, TEST_PASSWORD, ticket, &channels) == SUCCESS);
+    assert(strlen(ticket) == SIGNIN_TICKET_LEN && (channels & SIGNIN_CHANNEL_EMAIL));
+    assert(signinPendingCount() == before + 1);
+    char rejected[SIGNIN_TICKET_LEN + 1];
+    assert(signinBegin(userID, mobile, "wrong", rejected, NULL) == ERROR_AUTH_FAILED);
+    assert(signinPendingCount() == before + 1);     // failed credentials park nothing
+
+    // A wrong OTP keeps the flow parked; the right one finishes and frees it
+    char fresh[SIGNIN_TICKET_LEN + 1];
+    assert(signinBegin(userID, mobile, TEST_PASSWORD, fresh, NULL) == SUCCESS);
+    readOTP(otp);
+    assert(signinVerify(fresh, "000000", &session) == ERROR_AUTH_FAILED);
+    assert(signinResend(fresh, &channels) == SUCCESS);
+    readOTP(otp);
+    assert(signinVerify(fresh, otp, &session) == SUCCESS);
+    assert(signinVerify(fresh, otp, &session) == ERROR_NOT_FOUND);
+    assert(signinVerify("not-a-ticket", otp, &session) == ERROR_NOT_FOUND);
+    destroySession(session.sessionToken);
+    printf("✅ Pending signin table: PASS\n");
+}
+
+void test_many_pending() {
+    enum { FLOWS = 2000 };
+    static char tickets[FLOWS][SIGNIN_TICKET_LEN + 1];
+    int before = signinPendingCount();
+    for (int i = 0; i < FLOWS; i++) {
+        assert(signinBegin(userID, mobile, TEST_PASSWORD, tickets[i], NULL) == SUCCESS);
+    }
+    assert(signinPendingCount() == before + FLOWS);
+    for (int i = 1; i < FLOWS; i++) assert(strcmp(tickets[i], tickets[i - 1]) != 0);
+
+    // Every pending login is one fixed-size slot, no thread and no heap block
+    assert(sizeof(SigninFlow) <= 256);
+    assert(signinSweepExpired(time(NULL) + SIGNIN_OTP_SECONDS + 1) >= FLOWS);
+    assert(signinPendingCount() == 0);
+    printf("✅ %d pending signins, %zu bytes each: PASS\n", FLOWS, sizeof(SigninFlow));
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    registerTestUser();
+    test_state_machine();
+    test_limits_and_expiry();
+    test_pending_table();
+    test_many_pending();
+    closeDatabase();
+    printf("✅ All signin flow tests passed\n");
+    return 0;
+}
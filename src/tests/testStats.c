@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "testHelpers.h"
+
+#define TEST_STUDENTS 120
+
+static char institute[64];
+static char ids[TEST_STUDENTS][20];
+static int math[TEST_STUDENTS], art[TEST_STUDENTS];
+static const char *departments[2] = { "North", "South" };
+
+static void createStudent(const char *userID, const char *department, CampusType type, int i) {
+    testCreateStudent(userID, institute, department, type, '6', (int)(getpid() % 100000) * 1000 + i);
+}
+
+static void storeMarks(int i) {
+    testStoreMarks(ids[i], math[i], art[i]);
+}
+
+static int inDepartment(int i, int d) {
+    return d < 0 || i % 2 == d;
+}
+
+// Brute force over the arrays: d = -1 is the whole institute, subject 0 overall
+static void expectStats(int d, int subject) {
+    long count = 0, passed = 0, hist[STATS_BUCKETS] = {0};
+    double sum = 0.0, sumSq = 0.0;
+    for (int i = 0; i < TEST_STUDENTS; i++) {
+        if (!inDepartment(i, d)) continue;
+        double score = subject == 0 ? (math[i] + art[i]) / 2.0 : subject == 1 ? math[i] : art[i];
+        count++;
+        passed += score >= STATS_PASS_PERCENT;
+        sum += score;
+        sumSq += score * score;
+        hist[score >= 100.0 ? STATS_BUCKETS - 1 : (int)(score / 10.0)]++;
+    }
+    ScoreStats s;
+    const char *names[] = { NULL, "Math", "Art" };
+    assert(getScoreStats(institute, d < 0 ? NULL : departments[d], CAMPUS_SCHOOL, names[subject], &s) == SUCCESS);
+    double mean = sum / count;
+    assert(s.count == count);
+    assert(fabs(s.mean - mean) < 0.01);
+    assert(fabs(s.stddev - sqrt(sumSq / count - mean * mean)) < 0.01);
+    assert(fabs(s.passRate - passed * 100.0 / count) < 0.01);
+    for (int h = 0; h < STATS_BUCKETS; h++) assert(s.histogram[h] == hist[h]);
+}
+
+static void checkAll(void) {
+    for (int d = -1; d < 2; d++) {
+        for (int subject = 0; subject < 3; subject++) expectStats(d, subject);
+    }
+}
+
+static void seed(void) {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(institute, sizeof(institute), "Stats School %u", tag);
+    srand(tag);
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    for (int i = 0; i < TEST_STUDENTS; i++) {
+        snprintf(ids[i], sizeof(ids[i]), "st%05u%04d", tag, i);
+        createStudent(ids[i], departments[i % 2], CAMPUS_SCHOOL, i);
+        math[i] = rand() % 101;
+        art[i] = i == 0 ? 100 : rand() % 101;     // a perfect score lands in the last bucket
+        storeMarks(i);
+    }
+    assert(executeQuery("COMMIT;") == SUCCESS);
+}
+
+void test_aggregates() {
+    checkAll();
+    ScoreStats s;
+    assert(getScoreStats(institute, NULL, CAMPUS_SCHOOL, "Chemistry", &s) == ERROR_NOT_FOUND);
+    assert(getScoreStats(institute, "East", CAMPUS_SCHOOL, NULL, &s) == ERROR_NOT_FOUND);
+    assert(getScoreStats(institute, NULL, CAMPUS_COLLEGE, NULL, &s) == ERROR_NOT_FOUND);
+    printf("✅ Aggregates match a full scan: PASS\n");
+}
+
+// Re-saving replaces the old contribution instead of adding a second one
+void test_resave_and_move() {
+    math[3] = 12;
+    art[3] = 99;
+    storeMarks(3);
+    storeMarks(4);
+    checkAll();
+
+    // A department move carries the marks from one row to the other
+    Profile p;
+    assert(getUserByID(ids[5], &p));
+    strcpy(p.department, departments[0]);
+    assert(updateUser(&p));
+    ScoreStats north, south;
+    assert(getScoreStats(institute, departments[0], CAMPUS_SCHOOL, NULL, &north) == SUCCESS);
+    assert(getScoreStats(institute, departments[1], CAMPUS_SCHOOL, NULL, &south) == SUCCESS);
+    assert(north.count == TEST_STUDENTS / 2 + 1 && south.count == TEST_STUDENTS / 2 - 1);
+    strcpy(p.department, departments[1]);
+    assert(updateUser(&p));
+    checkAll();
+    printf("✅ Deltas on re-save and profile moves: PASS\n");
+}
+
+// The aggregates live in the caller's transaction and roll back with the data
+void test_rollback() {
+    assert(executeQuery("BEGIN;") == SUCCESS);
+    int marks[2] = { 0, 0 }, full[2] = { 100, 100 };
+    assert(storeSchoolMarks(ids[8], marks, full, 2) == SUCCESS);
+    assert(executeQuery("ROLLBACK;") == SUCCESS);
+    checkAll();
+    printf("✅ Rolled back saves leave no trace: PASS\n");
+}
+
+void test_college_and_migration() {
+    char a[20];
+    snprintf(a, sizeof(a), "sc%05uA", (unsigned)getpid() % 100000u);
+    createStudent(a, "North", CAMPUS_COLLEGE, 900);
+    int marks[2] = { 90, 50 }, credits[2] = { 4, 1 };      // CGPA 8.2
+    assert(storeCollegeMarks(a, marks, credits, 2) == SUCCESS);
+    ScoreStats s;
+    assert(getScoreStats(institute, NULL, CAMPUS_COLLEGE, NULL, &s) == SUCCESS);
+    assert(s.count == 1 && fabs(s.mean - 8.2) < 0.001 && s.passRate == 100.0f && s.histogram[8] == 1);
+    assert(getScoreStats(institute, "North", CAMPUS_COLLEGE, "Art", &s) == SUCCESS && s.histogram[5] == 1);
+
+    // Rebuilding from the stored marks gives the same table
+    assert(executeQuery("DROP TABLE score_stats; PRAGMA user_version = 2;") == SUCCESS);
+    closeDatabase();
+    assert(initDatabase() == SUCCESS);
+    checkAll();
+    assert(getScoreStats(institute, NULL, CAMPUS_COLLEGE, NULL, &s) == SUCCESS && s.count == 1);
+    printf("✅ College CGPA and the v3 migration: PASS\n");
+}
+
+int main() {
+    assert(initDatabase() == SUCCESS);
+    seed();
+    test_aggregates();
+    test_resave_and_move();
+    test_rollback();
+    test_college_and_migration();
+    closeDatabase();
+    printf("✅ All score statistics tests passed\n");
+    return 0;
+}
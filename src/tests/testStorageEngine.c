@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "../include/database.h"
+#include "../include/storage_engine.h"
+#include "testHelpers.h"
+
+#define USERS 200
+
+static char dir[64];
+static char prefix[12];
+
+static void removeTree(const char *path) {
+    DIR *d = opendir(path);
+    struct dirent *ent;
+    while (d && (ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char child[512];
+        snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+        if (remove(child) != 0) removeTree(child);
+    }
+    if (d) closedir(d);
+    rmdir(path);
+}
+
+static Profile profile(int i) {
+    Profile p;
+    char id[20], inst[MAX_LEN];
+    snprintf(id, sizeof(id), "%s%04d", prefix, i);
+    snprintf(inst, sizeof(inst), "Engine Institute %s", prefix);
+    testProfile(&p, id, inst, "Storage", i % 2 ? CAMPUS_COLLEGE : CAMPUS_SCHOOL);
+    snprintf(p.name, sizeof(p.name), "Engine User %d", i);
+    testSubjects(&p, 2, "Math", "Physics");
+    snprintf(p.mobile, sizeof(p.mobile), "7%s%03d", prefix + 2, i % 1000);
+    return p;
+}
+
+static UnifiedCampusData record(int i, int version) {
+    UnifiedCampusData d;
+    memset(&d, 0, sizeof(d));
+    snprintf(d.userID, sizeof(d.userID), "%s%04d", prefix, i);
+    snprintf(d.name, sizeof(d.name), "Engine User %d", i);
+    strcpy(d.instituteName, "Engine Institute");
+    strcpy(d.department, "Storage");
+    d.dataVersion = version;
+    d.lastUpdated = 1700000000 + i;
+    if (i % 3 == 0) {
+        d.campusType = CAMPUS_HOSTEL;
+        snprintf(d.hostel.roomNumber, sizeof(d.hostel.roomNumber), "R-%d", i);
+        strcpy(d.hostel.floor, "3");
+        strcpy(d.hostel.messPlan, "Veg");
+    } else {
+        d.campusType = CAMPUS_SCHOOL;
+        d.grades.subjectCount = 3;
+        for (int k = 0; k < 3; k++) {
+            snprintf(d.grades.subjects[k], sizeof(d.grades.subjects[k]), "Subject %d", k);
+            d.grades.marks[k] = (i + k * 7 + version) % 101;
+            d.grades.weights[k] = 100;
+        }
+    }
+    return d;
+}
+
+static int sameProfile(const Profile *a, const Profile *b) {
+    if (strcmp(a->userID, b->userID) || strcmp(a->name, b->name) || strcmp(a->instituteName, b->instituteName) ||
+        strcmp(a->department, b->department) || strcmp(a->email, b->email) || strcmp(a->mobile, b->mobile) ||
+        strcmp(a->passwordHash, b->passwordHash) || a->campusType != b->campusType || a->dataCount != b->dataCount) {
+        return 0;
+    }
+    for (int i = 0; i < a->dataCount; i++) {
+        if (strcmp(a->dataFields[i], b->dataFields[i])) return 0;
+    }
+    return 1;
+}
+
+static int sameRecord(const UnifiedCampusData *a, const UnifiedCampusData *b) {
+    if (strcmp(a->userID, b->userID) || strcmp(a->name, b->name) || a->campusType != b->campusType ||
+        a->dataVersion != b->dataVersion || a->lastUpdated != b->lastUpdated) {
+        return 0;
+    }
+    if (a->campusType == CAMPUS_HOSTEL) return strcmp(a->hostel.roomNumber, b->hostel.roomNumber) == 0;
+    for (int k = 0; k < a->grades.subjectCount; k++) {
+        if (a->grades.marks[k] != b->grades.marks[k] || strcmp(a->grades.subjects[k], b->grades.subjects[k])) return 0;
+    }
+    return a->grades.subjectCount == b->grades.subjectCount;
+}
+
+typedef struct {
+    int seen;
+    int stopAfter;              // 0 = never
+} ScanCount;
+
+// Other users may share the sqlite database; count only this run's
+static int countProfile(const Profile *p, void *ctx) {
+    ScanCount *count = (ScanCount*)ctx;
+    if (strncmp(p->userID, prefix, strlen(prefix)) == 0) count->seen++;
+    return !(count->stopAfter && count->seen >= count->stopAfter);
+}
+
+static int countRecord(const CampusRecordView *view, void *ctx) {
+    ScanCount *count = (ScanCount*)ctx;
+    if (strncmp(view->userID, prefix, strlen(prefix)) == 0) count->seen++;
+    return !(count->stopAfter && count->seen >= count->stopAfter);
+}
+
+static int scanProfilesCount(StorageEngine *engine) {
+    ScanCount count = {0};
+    assert(storageScanProfiles(engine, countProfile, &count) == SUCCESS);
+    return count.seen;
+}
+
+static int scanRecordsCount(StorageEngine *engine) {
+    ScanCount count = {0};
+    assert(storageScanRecords(engine, countRecord, &count) == SUCCESS);
+    return count.seen;
+}
+
+static void checkContents(StorageEngine *engine, int version) {
+    for (int i = 0; i < USERS; i++) {
+        Profile want = profile(i), got;
+        char id[20];
+        snprintf(id, sizeof(id), "%s%04d", prefix, i);
+        if (i % 10 == 0) {
+            assert(storageGetProfile(engine, id, &got) == ERROR_NOT_FOUND);
+            continue;
+        }
+        assert(storageGetProfile(engine, id, &got) == SUCCESS && sameProfile(&want, &got));
+        UnifiedCampusData wantData = record(i, version), gotData;
+        assert(storageGetRecord(engine, id, &gotData) == SUCCESS && sameRecord(&wantData, &gotData));
+    }
+    assert(scanProfilesCount(engine) == USERS - USERS / 10);
+    assert(scanRecordsCount(engine) == USERS - USERS / 10);
+}
+
+// The same calls give the same results on every engine
+static void conformance(const char *name) {
+    StorageEngine *engine;
+    assert(storageOpenByName(name, dir, &engine) == SUCCESS);
+    assert(strcmp(engine->ops->name, name) == 0);
+
+    for (int i = 0; i < USERS; i++) {
+        Profile p = profile(i);
+        UnifiedCampusData d = record(i, 1);
+        assert(storagePutProfile(engine, &p) == SUCCESS);
+        assert(storagePutRecord(engine, &d) == SUCCESS);
+    }
+    // Puts replace
+    for (int i = 0; i < USERS; i++) {
+        Profile p = profile(i);
+        UnifiedCampusData d = record(i, 2);
+        assert(storagePutProfile(engine, &p) == SUCCESS);
+        assert(storagePutRecord(engine, &d) == SUCCESS);
+    }
+    assert(scanProfilesCount(engine) == USERS && scanRecordsCount(engine) == USERS);
+
+    // Deleting a profile takes the record with it
+    for (int i = 0; i < USERS; i += 10) {
+        char id[20];
+        snprintf(id, sizeof(id), "%s%04d", prefix, i);
+        assert(storageDeleteProfile(engine, id) == SUCCESS);
+        assert(storageDeleteProfile(engine, id) == ERROR_NOT_FOUND);
+        UnifiedCampusData d;
+        assert(storageGetRecord(engine, id, &d) == ERROR_NOT_FOUND);
+        assert(storageDeleteRecord(engine, id) == ERROR_NOT_FOUND);
+    }
+    checkContents(engine, 2);
+
+    // A record goes on its own; the profile stays
+    char id[20];
+    snprintf(id, sizeof(id), "%s%04d", prefix, 1);
+    UnifiedCampusData d = record(1, 2);
+    Profile p;
+    assert(storageDeleteRecord(engine, id) == SUCCESS);
+    assert(storageGetRecord(engine, id, &d) == ERROR_NOT_FOUND);
+    assert(storageGetProfile(engine, id, &p) == SUCCESS);
+    d = record(1, 2);
+    assert(storagePutRecord(engine, &d) == SUCCESS);
+
+    // Early stop
+    ScanCount stop = { 0, 5 };
+    assert(storageScanProfiles(engine, countProfile, &stop) == SUCCESS && stop.seen == 5);
+    stop.seen = 0;
+    assert(storageScanRecords(engine, countRecord, &stop) == SUCCESS && stop.seen == 5);
+
+    // Bad input is refused before the engine sees it
+    Profile bad = profile(0);
+    bad.dataCount = MAX_SUBJECTS + 1;
+    assert(storagePutProfile(engine, &bad) == ERROR_INVALID_INPUT);
+    assert(storageGetProfile(engine, "", &p) == ERROR_INVALID_INPUT);
+    assert(storageGetProfile(engine, "an-id-longer-than-the-field", &p) == ERROR_INVALID_INPUT);
+    UnifiedCampusData none = record(2, 2);
+    none.campusType = CAMPUS_NONE;
+    assert(storagePutRecord(engine, &none) == ERROR_INVALID_INPUT);
+    assert(storageScanRecords(engine, NULL, NULL) == ERROR_INVALID_INPUT);
+
+    int persistent = engine->ops->persistent;
+    storageClose(engine);
+    if (persistent) {
+        assert(storageOpenByName(name, dir, &engine) == SUCCESS);
+        checkContents(engine, 2);
+        for (int i = 1; i < USERS; i++) {
+            snprintf(id, sizeof(id), "%s%04d", prefix, i);
+            if (i % 10) assert(storageDeleteProfile(engine, id) == SUCCESS);
+        }
+        assert(scanProfilesCount(engine) == 0 && scanRecordsCount(engine) == 0);
+        storageClose(engine);
+    }
+    printf("✅ Storage engine conformance (%s): PASS\n", name);
+}
+
+void test_unknown_engine() {
+    StorageEngine *engine = NULL;
+    assert(storageOpenByName("paper", dir, &engine) == ERROR_INVALID_INPUT && engine == NULL);
+    printf("✅ Unknown engine names are refused: PASS\n");
+}
+
+// saveUnifiedCampusData / loadUnifiedCampusData go through whichever engine
+// is installed
+void test_campus_storage() {
+    StorageEngine *engine;
+    assert(storageOpenMemory(&engine) == SUCCESS);
+    setCampusStorage(engine);
+    UnifiedCampusData d = record(7, 4), back;
+    assert(saveUnifiedCampusData(&d) == SUCCESS);
+    assert(storageGetRecord(engine, d.userID, &back) == SUCCESS && sameRecord(&d, &back));
+    assert(loadUnifiedCampusData(d.userID, &back) == SUCCESS && sameRecord(&d, &back));
+    closeCampusStore();
+    printf("✅ Campus data uses the installed engine: PASS\n");
+}
+
+int main() {
+    unsigned tag = (unsigned)getpid() % 100000u;
+    snprintf(dir, sizeof(dir), DATA_DIR "enginetest_%u", tag);
+    snprintf(prefix, sizeof(prefix), "se%05u", tag);
+    assert(initDatabase() == SUCCESS);
+    conformance("memory");
+    conformance("log");
+    conformance("sqlite");
+    test_unknown_engine();
+    test_campus_storage();
+    closeDatabase();
+    removeTree(dir);
+    printf("✅ All storage engine tests passed\n");
+    return 0;
+}
@@ -14,12 +14,12 @@ typedef struct {
 } Profile;
 
 void test_getGrade() {
-    assert(strcmp(getGrade(95.0f), "A+ 🌟") == 0);
-    assert(strcmp(getGrade(85.0f), "A") == 0);
-    assert(strcmp(getGrade(75.0f), "B") == 0);
-    assert(strcmp(getGrade(65.0f), "C") == 0);
-    assert(strcmp(getGrade(55.0f), "D") == 0);
-    assert(strcmp(getGrade(45.0f), "F ❌") == 0);
+    assert(strcmp(getDefaultGrade(95.0f), "A+ 🌟") == 0);
+    assert(strcmp(getDefaultGrade(85.0f), "A") == 0);
+    assert(strcmp(getDefaultGrade(75.0f), "B") == 0);
+    assert(strcmp(getDefaultGrade(65.0f), "C") == 0);
+    assert(strcmp(getDefaultGrade(55.0f), "D") == 0);
+    assert(strcmp(getDefaultGrade(45.0f), "F ❌") == 0);
     printf("test_getGrade passed.\n");
 }
 
@@ -0,0 +1,362 @@
+// Native implementation of the HPDF_* subset the exports use, on top of the
+// streaming writer in pdf_writer.c. Produces real PDF 1.4 with the standard
+// 14 fonts; no libharu needed. Pages record their text operations in
+// length-tracked buffers and are replayed into the writer by HPDF_SaveToFile,
+// or by HPDF_SaveToStream into a document-owned memory buffer.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../include/hpdf/hpdf.h"
+#include "../../include/pdf_writer.h"
+
+#define NATIVE_OUTPUT_BUFFER (64 * 1024)
+
+typedef enum { OP_FONT, OP_TEXT } NativeOpKind;
+
+typedef struct {
+    NativeOpKind kind;
+    int font;
+    HPDF_REAL a, b;             // font size, or text position
+    size_t text;                // offset into the page's text pool
+} NativeOp;
+
+typedef struct NativeDoc NativeDoc;
+
+typedef struct {
+    NativeDoc *doc;
+    HPDF_REAL width, height;
+    int inText;
+    NativeOp *ops;
+    size_t opCount, opCap;
+    char *text;
+    size_t textLength, textCap;
+} NativePage;
+
+typedef struct {
+    NativeDoc *doc;
+    int font;                   // PdfFont
+} NativeFont;
+
+struct NativeDoc {
+    HPDF_Error_Handler errorFn;
+    void *userData;
+    HPDF_STATUS error;
+    NativePage **pages;
+    size_t pageCount, pageCap;
+    NativeFont fonts[PDF_FONT_COUNT];
+    char *stream;               // HPDF_SaveToStream output
+    size_t streamLength, streamRead;
+};
+
+static const HPDF_REAL pageSizes[HPDF_PAGE_SIZE_EOF][2] = {
+    [HPDF_PAGE_SIZE_LETTER]    = { 612, 792 },
+    [HPDF_PAGE_SIZE_LEGAL]     = { 612, 1008 },
+    [HPDF_PAGE_SIZE_A3]        = { 841.89f, 1190.551f },
+    [HPDF_PAGE_SIZE_A4]        = { 595.276f, 841.89f },
+    [HPDF_PAGE_SIZE_A5]        = { 419.528f, 595.276f },
+    [HPDF_PAGE_SIZE_B4]        = { 708.661f, 1000.63f },
+    [HPDF_PAGE_SIZE_B5]        = { 498.898f, 708.661f },
+    [HPDF_PAGE_SIZE_EXECUTIVE] = { 522, 756 },
+    [HPDF_PAGE_SIZE_US4x6]     = { 288, 432 },
+    [HPDF_PAGE_SIZE_US4x8]     = { 288, 576 },
+    [HPDF_PAGE_SIZE_US5x7]     = { 360, 504 },
+    [HPDF_PAGE_SIZE_COMM10]    = { 297, 684 },
+};
+
+static HPDF_STATUS raise(NativeDoc *doc, HPDF_STATUS code) {
+    if (!doc) return code;
+    doc->error = code;
+    if (doc->errorFn) doc->errorFn(code, 0, doc->userData);
+    return code;
+}
+
+static int grow(void **buf, size_t *cap, size_t need, size_t unit) {
+    if (*cap >= need) return 1;
+    size_t grown = *cap ? *cap : 16;
+    while (grown < need) grown *= 2;
+    void *p = realloc(*buf, grown * unit);
+    if (!p) return 0;
+    *buf = p;
+    *cap = grown;
+    return 1;
+}
+
+static HPDF_STATUS addOp(NativePage *page, NativeOpKind kind, int font, HPDF_REAL a, HPDF_REAL b, const char *text) {
+    if (!grow((void**)&page->ops, &page->opCap, page->opCount + 1, sizeof(NativeOp))) {
+        return raise(page->doc, HPDF_FAILED_TO_ALLOC_MEM);
+    }
+    NativeOp *op = &page->ops[page->opCount];
+    op->kind = kind;
+    op->font = font;
+    op->a = a;
+    op->b = b;
+    op->text = page->textLength;
+    if (text) {
+        size_t length = strlen(text) + 1;
+        if (!grow((void**)&page->text, &page->textCap, page->textLength + length, 1)) {
+            return raise(page->doc, HPDF_FAILED_TO_ALLOC_MEM);
+        }
+        memcpy(page->text + page->textLength, text, length);
+        page->textLength += length;
+    }
+    page->opCount++;
+    return HPDF_OK;
+}
+
+const char *HPDF_GetVersion(void) { return "native-1.0"; }
+
+HPDF_Doc HPDF_New(HPDF_Error_Handler user_error_fn, void *user_data) {
+    NativeDoc *doc = (NativeDoc*)calloc(1, sizeof(NativeDoc));
+    if (!doc) {
+        if (user_error_fn) user_error_fn(HPDF_FAILED_TO_ALLOC_MEM, 0, user_data);
+        return NULL;
+    }
+    doc->errorFn = user_error_fn;
+    doc->userData = user_data;
+    for (int i = 0; i < PDF_FONT_COUNT; i++) {
+        doc->fonts[i].doc = doc;
+        doc->fonts[i].font = i;
+    }
+    return (HPDF_Doc)doc;
+}
+
+void HPDF_Free(HPDF_Doc pdf) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return;
+    for (size_t i = 0; i < doc->pageCount; i++) {
+        free(doc->pages[i]->ops);
+        free(doc->pages[i]->text);
+        free(doc->pages[i]);
+    }
+    free(doc->pages);
+    free(doc->stream);
+    free(doc);
+}
+
+HPDF_STATUS HPDF_GetError(HPDF_Doc pdf) {
+    return pdf ? ((NativeDoc*)pdf)->error : HPDF_INVALID_DOCUMENT;
+}
+
+void HPDF_ResetError(HPDF_Doc pdf) {
+    if (pdf) ((NativeDoc*)pdf)->error = HPDF_OK;
+}
+
+HPDF_Page HPDF_AddPage(HPDF_Doc pdf) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return NULL;
+    NativePage *page = (NativePage*)calloc(1, sizeof(NativePage));
+    if (!page || !grow((void**)&doc->pages, &doc->pageCap, doc->pageCount + 1, sizeof(NativePage*))) {
+        free(page);
+        raise(doc, HPDF_FAILED_TO_ALLOC_MEM);
+        return NULL;
+    }
+    page->doc = doc;
+    page->width = pageSizes[HPDF_PAGE_SIZE_A4][0];
+    page->height = pageSizes[HPDF_PAGE_SIZE_A4][1];
+    doc->pages[doc->pageCount++] = page;
+    return (HPDF_Page)page;
+}
+
+HPDF_STATUS HPDF_Page_SetSize(HPDF_Page page, HPDF_PageSizes size, HPDF_PageDirection direction) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if ((int)size < 0 || size >= HPDF_PAGE_SIZE_EOF) return raise(p->doc, HPDF_PAGE_INVALID_SIZE);
+    int landscape = direction == HPDF_PAGE_LANDSCAPE;
+    p->width = pageSizes[size][landscape];
+    p->height = pageSizes[size][!landscape];
+    return HPDF_OK;
+}
+
+HPDF_STATUS HPDF_Page_SetWidth(HPDF_Page page, HPDF_REAL value) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (value < 3 || value > 14400) return raise(p->doc, HPDF_PAGE_OUT_OF_RANGE);
+    p->width = value;
+    return HPDF_OK;
+}
+
+HPDF_STATUS HPDF_Page_SetHeight(HPDF_Page page, HPDF_REAL value) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (value < 3 || value > 14400) return raise(p->doc, HPDF_PAGE_OUT_OF_RANGE);
+    p->height = value;
+    return HPDF_OK;
+}
+
+HPDF_REAL HPDF_Page_GetWidth(HPDF_Page page) {
+    return page ? ((NativePage*)page)->width : 0;
+}
+
+HPDF_REAL HPDF_Page_GetHeight(HPDF_Page page) {
+    return page ? ((NativePage*)page)->height : 0;
+}
+
+// Standard 14 fonts only; the encoding argument is ignored (text is WinAnsi)
+HPDF_Font HPDF_GetFont(HPDF_Doc pdf, const char *font_name, const char *encoding_name) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    (void)encoding_name;
+    if (!doc) return NULL;
+    int font = pdfFontByName(font_name);
+    if (font < 0) {
+        raise(doc, HPDF_INVALID_FONT_NAME);
+        return NULL;
+    }
+    return (HPDF_Font)&doc->fonts[font];
+}
+
+HPDF_STATUS HPDF_Page_SetFontAndSize(HPDF_Page page, HPDF_Font font, HPDF_REAL size) {
+    NativePage *p = (NativePage*)page;
+    NativeFont *f = (NativeFont*)font;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (!f || f->doc != p->doc) return raise(p->doc, HPDF_PAGE_INVALID_FONT);
+    if (size <= 0 || size > HPDF_MAX_FONTSIZE) return raise(p->doc, HPDF_PAGE_INVALID_FONT_SIZE);
+    return addOp(p, OP_FONT, f->font, size, 0, NULL);
+}
+
+HPDF_STATUS HPDF_Page_BeginText(HPDF_Page page) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (p->inText) return raise(p->doc, HPDF_PAGE_INVALID_GMODE);
+    p->inText = 1;
+    return HPDF_OK;
+}
+
+HPDF_STATUS HPDF_Page_EndText(HPDF_Page page) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (!p->inText) return raise(p->doc, HPDF_PAGE_INVALID_GMODE);
+    p->inText = 0;
+    return HPDF_OK;
+}
+
+HPDF_STATUS HPDF_Page_TextOut(HPDF_Page page, HPDF_REAL xpos, HPDF_REAL ypos, const char *text) {
+    NativePage *p = (NativePage*)page;
+    if (!p) return HPDF_INVALID_PAGE;
+    if (!p->inText) return raise(p->doc, HPDF_PAGE_INVALID_GMODE);
+    if (!text) return HPDF_OK;
+    size_t i = p->opCount;
+    while (i > 0 && p->ops[i - 1].kind != OP_FONT) i--;
+    if (i == 0) return raise(p->doc, HPDF_PAGE_FONT_NOT_FOUND);
+    return addOp(p, OP_TEXT, 0, xpos, ypos, text);
+}
+
+static ErrorCode replayPage(PdfWriter *w, const NativePage *page) {
+    ErrorCode rc = pdfBeginPage(w, page->width, page->height);
+    for (size_t i = 0; rc == SUCCESS && i < page->opCount; i++) {
+        const NativeOp *op = &page->ops[i];
+        if (op->kind == OP_FONT) rc = pdfSetFont(w, (PdfFont)op->font, op->a);
+        else rc = pdfText(w, op->a, op->b, page->text + op->text);
+    }
+    if (rc == SUCCESS) rc = pdfEndPage(w);
+    return rc;
+}
+
+// Writes every page to `f`; the caller closes it
+static ErrorCode render(const NativeDoc *doc, FILE *f) {
+    PdfWriter *w = pdfWriterOpen(f);
+    ErrorCode rc = w ? SUCCESS : ERROR_MEMORY;
+    for (size_t i = 0; rc == SUCCESS && i < doc->pageCount; i++) rc = replayPage(w, doc->pages[i]);
+    if (w) {
+        ErrorCode closed = pdfWriterClose(w, rc != SUCCESS);
+        if (rc == SUCCESS) rc = closed;
+    }
+    return rc;
+}
+
+HPDF_STATUS HPDF_SaveToFile(HPDF_Doc pdf, const char *file_name) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return HPDF_INVALID_DOCUMENT;
+    if (!file_name) return raise(doc, HPDF_INVALID_PARAMETER);
+    FILE *f = fopen(file_name, "wb");
+    if (!f) return raise(doc, HPDF_FILE_OPEN_ERROR);
+    setvbuf(f, NULL, _IOFBF, NATIVE_OUTPUT_BUFFER);
+    ErrorCode rc = render(doc, f);
+    if (fclose(f) != 0 && rc == SUCCESS) rc = ERROR_FILE_IO;
+    if (rc != SUCCESS) {
+        remove(file_name);
+        return raise(doc, rc == ERROR_MEMORY ? HPDF_FAILED_TO_ALLOC_MEM : HPDF_FILE_IO_ERROR);
+    }
+    return HPDF_OK;
+}
+
+// Renders into memory owned by the document; read it back with
+// HPDF_ReadFromStream or HPDF_GetContents
+HPDF_STATUS HPDF_SaveToStream(HPDF_Doc pdf) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return HPDF_INVALID_DOCUMENT;
+    free(doc->stream);
+    doc->stream = NULL;
+    doc->streamLength = doc->streamRead = 0;
+
+    char *data = NULL;
+    size_t length = 0;
+    ErrorCode rc;
+#ifdef _WIN32
+    // No memory streams: render to an anonymous temporary file and load it
+    FILE *f = tmpfile();
+    if (!f) return raise(doc, HPDF_FILE_IO_ERROR);
+    rc = render(doc, f);
+    long size = rc == SUCCESS ? ftell(f) : -1;
+    if (rc == SUCCESS && size < 0) rc = ERROR_FILE_IO;
+    if (rc == SUCCESS) {
+        length = (size_t)size;
+        data = (char*)malloc(length ? length : 1);
+        rewind(f);
+        if (!data) rc = ERROR_MEMORY;
+        else if (fread(data, 1, length, f) != length) rc = ERROR_FILE_IO;
+    }
+    fclose(f);
+#else
+    FILE *f = open_memstream(&data, &length);
+    if (!f) return raise(doc, HPDF_FAILED_TO_ALLOC_MEM);
+    rc = render(doc, f);
+    if (fclose(f) != 0 && rc == SUCCESS) rc = ERROR_MEMORY;   // buffer is final only after fclose
+#endif
+    if (rc != SUCCESS) {
+        free(data);
+        return raise(doc, rc == ERROR_MEMORY ? HPDF_FAILED_TO_ALLOC_MEM : HPDF_FILE_IO_ERROR);
+    }
+    doc->stream = data;
+    doc->streamLength = length;
+    return HPDF_OK;
+}
+
+HPDF_UINT32 HPDF_GetStreamSize(HPDF_Doc pdf) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    return doc && doc->stream ? (HPDF_UINT32)doc->streamLength : 0;
+}
+
+// Copies up to *size bytes from the read position; *size receives the count.
+// HPDF_STREAM_EOF once the end is reached, as libharu does.
+HPDF_STATUS HPDF_ReadFromStream(HPDF_Doc pdf, HPDF_BYTE *buf, HPDF_UINT32 *size) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return HPDF_INVALID_DOCUMENT;
+    if (!buf || !size) return raise(doc, HPDF_INVALID_PARAMETER);
+    if (!doc->stream) return raise(doc, HPDF_INVALID_OPERATION);
+    size_t left = doc->streamLength - doc->streamRead;
+    size_t n = *size < left ? *size : left;
+    memcpy(buf, doc->stream + doc->streamRead, n);
+    doc->streamRead += n;
+    *size = (HPDF_UINT32)n;
+    return doc->streamRead == doc->streamLength ? HPDF_STREAM_EOF : HPDF_OK;
+}
+
+HPDF_STATUS HPDF_ResetStream(HPDF_Doc pdf) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return HPDF_INVALID_DOCUMENT;
+    if (!doc->stream) return raise(doc, HPDF_INVALID_OPERATION);
+    doc->streamRead = 0;
+    return HPDF_OK;
+}
+
+// Whole stream from the start; *size is the buffer size in, bytes copied out
+HPDF_STATUS HPDF_GetContents(HPDF_Doc pdf, HPDF_BYTE *buf, HPDF_UINT32 *size) {
+    NativeDoc *doc = (NativeDoc*)pdf;
+    if (!doc) return HPDF_INVALID_DOCUMENT;
+    if (!buf || !size) return raise(doc, HPDF_INVALID_PARAMETER);
+    if (!doc->stream && HPDF_SaveToStream(pdf) != HPDF_OK) return doc->error;
+    size_t n = *size < doc->streamLength ? *size : doc->streamLength;
+    memcpy(buf, doc->stream, n);
+    *size = (HPDF_UINT32)n;
+    return HPDF_OK;
+}